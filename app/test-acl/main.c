@@ -69,6 +69,8 @@
 #define	OPT_ITER_NUM		"iter"
 #define	OPT_VERBOSE		"verbose"
 #define	OPT_IPV6		"ipv6"
+#define	OPT_BLD_THREADS		"bldthreads"
+#define	OPT_DELTA_NUM		"deltanum"
 
 #define	TRACE_DEFAULT_NUM	0x10000
 #define	TRACE_STEP_MAX		0x1000
@@ -101,6 +103,15 @@ static const struct acl_alg acl_alg[] = {
 		.name = "avx2",
 		.alg = RTE_ACL_CLASSIFY_AVX2,
 	},
+	{
+		.name = "avx512",
+		.alg = RTE_ACL_CLASSIFY_AVX512,
+	},
+	{
+		/* run all the methods supported, one after another. */
+		.name = "all",
+		.alg = RTE_ACL_CLASSIFY_NUM,
+	},
 };
 
 static struct {
@@ -117,6 +128,8 @@ static struct {
 	uint32_t            iter_num;
 	uint32_t            verbose;
 	uint32_t            ipv6;
+	uint32_t            bld_threads;
+	uint32_t            delta_num;
 	struct acl_alg      alg;
 	uint32_t            used_traces;
 	void               *traces;
@@ -718,8 +731,13 @@ parse_cb_ipv4_rule(char *str, struct acl_rule *v)
 
 typedef int (*parse_5tuple)(char *text, struct acl_rule *rule);
 
+/*
+ * Add the first *base_num* rules of the file into the context,
+ * save the remaining ones into *delta*.
+ */
 static int
-add_cb_rules(FILE *f, struct rte_acl_ctx *ctx)
+add_cb_rules(FILE *f, struct rte_acl_ctx *ctx, uint32_t base_num,
+	struct acl_rule *delta)
 {
 	int rc;
 	uint32_t n;
@@ -743,6 +761,11 @@ add_cb_rules(FILE *f, struct rte_acl_ctx *ctx)
 		v.data.priority = RTE_ACL_MAX_PRIORITY - n;
 		v.data.userdata = n;
 
+		if (n > base_num) {
+			delta[n - base_num - 1] = v;
+			continue;
+		}
+
 		rc = rte_acl_add_rules(ctx, (struct rte_acl_rule *)&v, 1);
 		if (rc != 0) {
 			RTE_LOG(ERR, TESTACL, "line %u: failed to add rules "
@@ -755,12 +778,27 @@ add_cb_rules(FILE *f, struct rte_acl_ctx *ctx)
 	return 0;
 }
 
+static uint32_t
+count_lines(FILE *f)
+{
+	uint32_t n;
+
+	for (n = 0; fgets(line, sizeof(line), f) != NULL; n++)
+		;
+	rewind(f);
+	return n;
+}
+
 static void
 acx_init(void)
 {
 	int ret;
 	FILE *f;
+	uint32_t num;
+	uint64_t tm;
+	struct acl_rule *delta;
 	struct rte_acl_config cfg;
+	struct rte_acl_build_stats stats;
 
 	memset(&cfg, 0, sizeof(cfg));
 
@@ -774,6 +812,7 @@ acx_init(void)
 	}
 	cfg.num_categories = config.bld_categories;
 	cfg.max_size = config.max_size;
+	cfg.num_threads = config.bld_threads;
 
 	/* setup ACL creation parameters. */
 	prm.rule_size = RTE_ACL_RULE_SZ(cfg.num_fields);
@@ -784,7 +823,8 @@ acx_init(void)
 		rte_exit(rte_errno, "failed to create ACL context\n");
 
 	/* set default classify method for this context. */
-	if (config.alg.alg != RTE_ACL_CLASSIFY_DEFAULT) {
+	if (config.alg.alg != RTE_ACL_CLASSIFY_DEFAULT &&
+			config.alg.alg != RTE_ACL_CLASSIFY_NUM) {
 		ret = rte_acl_set_ctx_classify(config.acx, config.alg.alg);
 		if (ret != 0)
 			rte_exit(ret, "failed to setup %s method "
@@ -797,23 +837,67 @@ acx_init(void)
 		rte_exit(-EINVAL, "failed to open file %s\n",
 			config.rule_file);
 
-	ret = add_cb_rules(f, config.acx);
+	/* the last delta_num rules of the file are added after the build. */
+	num = count_lines(f);
+	if (config.delta_num >= num)
+		rte_exit(-EINVAL, "%s=%u should be less then "
+			"the number of rules: %u\n",
+			OPT_DELTA_NUM, config.delta_num, num);
+
+	delta = calloc(config.delta_num + 1, sizeof(*delta));
+	if (delta == NULL)
+		rte_exit(-ENOMEM, "failed to allocate %u delta rules\n",
+			config.delta_num);
+
+	ret = add_cb_rules(f, config.acx, num - config.delta_num, delta);
 	if (ret != 0)
 		rte_exit(ret, "failed to add rules into ACL context\n");
 
 	fclose(f);
 
 	/* perform build. */
+	tm = rte_rdtsc();
 	ret = rte_acl_build(config.acx, &cfg);
+	tm = rte_rdtsc() - tm;
 
 	dump_verbose(DUMP_NONE, stdout,
-		"rte_acl_build(%u) finished with %d\n",
-		config.bld_categories, ret);
+		"rte_acl_build(%u) finished with %d, "
+		"%u rules, %" PRIu64 " cycles\n",
+		config.bld_categories, ret, num - config.delta_num, tm);
+
+	if (ret != 0) {
+		rte_acl_dump(config.acx);
+		rte_exit(ret, "failed to build search context\n");
+	}
+
+	/* add the delta rules to the built context. */
+	if (config.delta_num != 0) {
+		tm = rte_rdtsc();
+		ret = rte_acl_add_delta_rules(config.acx,
+			(struct rte_acl_rule *)delta, config.delta_num);
+		tm = rte_rdtsc() - tm;
+
+		dump_verbose(DUMP_NONE, stdout,
+			"rte_acl_add_delta_rules(%u) finished with %d, "
+			"%" PRIu64 " cycles\n",
+			config.delta_num, ret, tm);
+
+		if (ret != 0)
+			rte_exit(ret, "failed to add delta rules\n");
+	}
+
+	free(delta);
 
 	rte_acl_dump(config.acx);
 
-	if (ret != 0)
-		rte_exit(ret, "failed to build search context\n");
+	rte_acl_get_build_stats(config.acx, &stats);
+	dump_verbose(DUMP_NONE, stdout,
+		"build stats: threads=%u, tries=%u, nodes=%u, "
+		"delta tries=%u, delta rules=%u, "
+		"temporary memory peak=%zu, runtime memory=%zu\n",
+		stats.num_threads, stats.num_tries, stats.num_nodes,
+		stats.num_delta_tries, stats.num_delta_rules,
+		stats.temp_mem_peak, stats.runtime_mem);
 }
 
 static uint32_t
@@ -877,13 +961,58 @@ search_ip5tuples(__attribute__((unused)) void *arg)
 	tm = rte_rdtsc() - start;
 	dump_verbose(DUMP_NONE, stdout,
 		"%s  @lcore %u: %" PRIu32 " iterations, %" PRIu64 " pkts, %"
-		PRIu32 " categories, %" PRIu64 " cycles, %#Lf cycles/pkt\n",
+		PRIu32 " categories, %" PRIu64 " cycles, %#Lf cycles/pkt, "
+		"%#Lf pkts/sec\n",
 		__func__, lcore, i, pkt, config.run_categories,
-		tm, (long double)tm / pkt);
+		tm, (long double)tm / pkt,
+		(long double)pkt * rte_get_tsc_hz() / tm);
 
 	return 0;
 }
 
+static void
+search_all_lcores(void)
+{
+	uint32_t lcore;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore)
+		 rte_eal_remote_launch(search_ip5tuples, NULL, lcore);
+
+	search_ip5tuples(NULL);
+
+	rte_eal_mp_wait_lcore();
+}
+
+/*
+ * Run the same traces with each classify method this CPU supports,
+ * to compare their rates.
+ */
+static void
+search_all_algs(void)
+{
+	int ret;
+	uint32_t i;
+
+	for (i = 0; i != RTE_DIM(acl_alg); i++) {
+
+		if (acl_alg[i].alg == RTE_ACL_CLASSIFY_NUM)
+			continue;
+
+		ret = rte_acl_set_ctx_classify(config.acx, acl_alg[i].alg);
+		if (ret != 0) {
+			dump_verbose(DUMP_NONE, stdout,
+				"%s: %s method is not supported, error code: "
+				"%d\n", __func__, acl_alg[i].name, ret);
+			continue;
+		}
+
+		config.alg = acl_alg[i];
+		dump_verbose(DUMP_NONE, stdout, "%s: %s method:\n",
+			__func__, acl_alg[i].name);
+		search_all_lcores();
+	}
+}
+
 static unsigned long
 get_ulong_opt(const char *opt, const char *name, size_t min, size_t max)
 {
@@ -955,7 +1084,11 @@ print_usage(const char *prgname)
 		"[--" OPT_ITER_NUM "=<number of iterations to perform>]\n"
 		"[--" OPT_VERBOSE "=<verbose level>]\n"
 		"[--" OPT_SEARCH_ALG "=%s]\n"
-		"[--" OPT_IPV6 "=<IPv6 rules and trace files>]\n",
+		"[--" OPT_IPV6 "=<IPv6 rules and trace files>]\n"
+		"[--" OPT_BLD_THREADS
+			"=<number of threads to build ACL context with>]\n"
+		"[--" OPT_DELTA_NUM
+			"=<number of last rules to add after the build>]\n",
 		prgname, RTE_ACL_RESULTS_MULTIPLIER,
 		(uint32_t)RTE_ACL_MAX_CATEGORIES,
 		buf);
@@ -978,6 +1111,8 @@ dump_config(FILE *f)
 	fprintf(f, "%s:%u(%s)\n", OPT_SEARCH_ALG, config.alg.alg,
 		config.alg.name);
 	fprintf(f, "%s:%u\n", OPT_IPV6, config.ipv6);
+	fprintf(f, "%s:%u\n", OPT_BLD_THREADS, config.bld_threads);
+	fprintf(f, "%s:%u\n", OPT_DELTA_NUM, config.delta_num);
 }
 
 static void
@@ -1007,6 +1142,8 @@ get_input_opts(int argc, char **argv)
 		{OPT_VERBOSE, 1, 0, 0},
 		{OPT_SEARCH_ALG, 1, 0, 0},
 		{OPT_IPV6, 0, 0, 0},
+		{OPT_BLD_THREADS, 1, 0, 0},
+		{OPT_DELTA_NUM, 1, 0, 0},
 		{NULL, 0, 0, 0}
 	};
 
@@ -1056,6 +1193,13 @@ get_input_opts(int argc, char **argv)
 			get_alg_opt(optarg, lgopts[opt_idx].name);
 		} else if (strcmp(lgopts[opt_idx].name, OPT_IPV6) == 0) {
 			config.ipv6 = 1;
+		} else if (strcmp(lgopts[opt_idx].name,
+				OPT_BLD_THREADS) == 0) {
+			config.bld_threads = get_ulong_opt(optarg,
+				lgopts[opt_idx].name, 0, RTE_MAX_LCORE);
+		} else if (strcmp(lgopts[opt_idx].name, OPT_DELTA_NUM) == 0) {
+			config.delta_num = get_ulong_opt(optarg,
+				lgopts[opt_idx].name, 0, RTE_ACL_MAX_INDEX);
 		}
 	}
 	config.trace_sz = config.ipv6 ? sizeof(struct ipv6_5tuple) :
@@ -1067,7 +1211,6 @@ int
 main(int argc, char **argv)
 {
 	int ret;
-	uint32_t lcore;
 
 	ret = rte_eal_init(argc, argv);
 	if (ret < 0)
@@ -1087,12 +1230,10 @@ main(int argc, char **argv)
 	if (config.trace_file != NULL)
 		tracef_init();
 
-	RTE_LCORE_FOREACH_SLAVE(lcore)
-		 rte_eal_remote_launch(search_ip5tuples, NULL, lcore);
-
-	search_ip5tuples(NULL);
-
-	rte_eal_mp_wait_lcore();
+	if (config.alg.alg == RTE_ACL_CLASSIFY_NUM)
+		search_all_algs();
+	else
+		search_all_lcores();
 
 	rte_acl_free(config.acx);
 	return 0;
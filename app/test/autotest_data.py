@@ -463,6 +463,31 @@ non_parallel_test_group_list = [
                 },
 	]
 },
+{
+	"Prefix":	"lpm_perf",
+	"Memory" :	all_sockets(512),
+	"Tests" :
+	[
+		{
+		 "Name" :	"LPM full table performance autotest",
+		 "Command" : 	"lpm_full_table_perf_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"LPM concurrency autotest",
+		 "Command" : 	"lpm_concurrency_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+		{
+		 "Name" :	"LPM6 concurrency autotest",
+		 "Command" : 	"lpm6_concurrency_autotest",
+		 "Func" :	default_autotest,
+		 "Report" :	None,
+		},
+	]
+},
 {
 	"Prefix":	"timer_perf",
 	"Memory" :	all_sockets(512),
@@ -231,6 +231,7 @@ test_classify(void)
 {
 	struct rte_acl_ctx *acx;
 	int i, ret;
+	uint32_t alg;
 
 	acx = rte_acl_create(&acl_param);
 	if (acx == NULL) {
@@ -254,12 +255,23 @@ test_classify(void)
 			break;
 		}
 
-		ret = test_classify_run(acx);
-		if (ret != 0) {
-			printf("Line %i, iter: %d: %s failed!\n",
-				__LINE__, i, __func__);
-			break;
+		/* run all the classify methods available on this cpu. */
+		for (alg = RTE_ACL_CLASSIFY_SCALAR;
+				alg != RTE_ACL_CLASSIFY_NUM; alg++) {
+			ret = rte_acl_set_ctx_classify(acx, alg);
+			if (ret == -ENOTSUP)
+				continue;
+			if (ret == 0)
+				ret = test_classify_run(acx);
+			if (ret != 0) {
+				printf("Line %i, iter: %d, alg: %d: "
+					"%s failed!\n",
+					__LINE__, i, alg, __func__);
+				break;
+			}
 		}
+		if (ret != 0)
+			break;
 
 		/* reset rules and make sure that classify still works ok. */
 		rte_acl_reset_rules(acx);
@@ -915,6 +927,425 @@ test_misc(void)
 	return 0;
 }
 
+/*
+ * Generated rule set, used to check parallel and incremental builds
+ * against a linear search over the same rules.
+ */
+#define	TEST_BLD_RULES		1024
+#define	TEST_BLD_TRACES		4096
+#define	TEST_BLD_DELTA		64
+#define	TEST_BLD_THREADS	4
+
+struct ipv4_5tuple {
+	uint8_t  proto;
+	uint32_t ip_src;
+	uint32_t ip_dst;
+	uint16_t port_src;
+	uint16_t port_dst;
+};
+
+enum {
+	TEST_BLD_PROTO,
+	TEST_BLD_SRC,
+	TEST_BLD_DST,
+	TEST_BLD_SRCP,
+	TEST_BLD_DSTP,
+	TEST_BLD_NUM_FIELDS
+};
+
+static const struct rte_acl_field_def test_bld_defs[TEST_BLD_NUM_FIELDS] = {
+	{
+		.type = RTE_ACL_FIELD_TYPE_BITMASK,
+		.size = sizeof(uint8_t),
+		.field_index = TEST_BLD_PROTO,
+		.input_index = RTE_ACL_IPV4VLAN_PROTO,
+		.offset = offsetof(struct ipv4_5tuple, proto),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_MASK,
+		.size = sizeof(uint32_t),
+		.field_index = TEST_BLD_SRC,
+		.input_index = RTE_ACL_IPV4VLAN_SRC,
+		.offset = offsetof(struct ipv4_5tuple, ip_src),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_MASK,
+		.size = sizeof(uint32_t),
+		.field_index = TEST_BLD_DST,
+		.input_index = RTE_ACL_IPV4VLAN_DST,
+		.offset = offsetof(struct ipv4_5tuple, ip_dst),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_RANGE,
+		.size = sizeof(uint16_t),
+		.field_index = TEST_BLD_SRCP,
+		.input_index = RTE_ACL_IPV4VLAN_PORTS,
+		.offset = offsetof(struct ipv4_5tuple, port_src),
+	},
+	{
+		.type = RTE_ACL_FIELD_TYPE_RANGE,
+		.size = sizeof(uint16_t),
+		.field_index = TEST_BLD_DSTP,
+		.input_index = RTE_ACL_IPV4VLAN_PORTS,
+		.offset = offsetof(struct ipv4_5tuple, port_dst),
+	},
+};
+
+RTE_ACL_RULE_DEF(test_bld_rule, TEST_BLD_NUM_FIELDS);
+
+static struct test_bld_rule test_bld_rules[TEST_BLD_RULES];
+static struct ipv4_5tuple test_bld_traces[TEST_BLD_TRACES];
+static uint32_t test_bld_expected[TEST_BLD_TRACES];
+
+/* the same sequence on every run */
+static uint32_t
+test_bld_rand(void)
+{
+	static uint32_t seed = 0x2545f491;
+
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+static uint32_t
+test_bld_prefix(uint32_t len)
+{
+	return (len == 0) ? 0 : (uint32_t)(UINT32_MAX << (32 - len));
+}
+
+static int
+test_bld_match(const struct test_bld_rule *r, const struct ipv4_5tuple *t)
+{
+	uint32_t src, dst, m;
+	uint16_t sp, dp;
+
+	src = rte_be_to_cpu_32(t->ip_src);
+	dst = rte_be_to_cpu_32(t->ip_dst);
+	sp = rte_be_to_cpu_16(t->port_src);
+	dp = rte_be_to_cpu_16(t->port_dst);
+
+	m = r->field[TEST_BLD_PROTO].mask_range.u8;
+	if ((t->proto & m) != (r->field[TEST_BLD_PROTO].value.u8 & m))
+		return 0;
+	m = test_bld_prefix(r->field[TEST_BLD_SRC].mask_range.u32);
+	if ((src & m) != (r->field[TEST_BLD_SRC].value.u32 & m))
+		return 0;
+	m = test_bld_prefix(r->field[TEST_BLD_DST].mask_range.u32);
+	if ((dst & m) != (r->field[TEST_BLD_DST].value.u32 & m))
+		return 0;
+	if (sp < r->field[TEST_BLD_SRCP].value.u16 ||
+			sp > r->field[TEST_BLD_SRCP].mask_range.u16)
+		return 0;
+	if (dp < r->field[TEST_BLD_DSTP].value.u16 ||
+			dp > r->field[TEST_BLD_DSTP].mask_range.u16)
+		return 0;
+	return 1;
+}
+
+/* results of a linear search over the first num rules. */
+static void
+test_bld_calc_expected(uint32_t num)
+{
+	uint32_t i, j;
+	int32_t prio;
+
+	for (i = 0; i != RTE_DIM(test_bld_traces); i++) {
+		test_bld_expected[i] = 0;
+		prio = INT32_MIN;
+		for (j = 0; j != num; j++) {
+			if (test_bld_rules[j].data.priority > prio &&
+					test_bld_match(test_bld_rules + j,
+					test_bld_traces + i)) {
+				prio = test_bld_rules[j].data.priority;
+				test_bld_expected[i] =
+					test_bld_rules[j].data.userdata;
+			}
+		}
+	}
+}
+
+static void
+test_bld_gen(void)
+{
+	uint32_t i, lo;
+	struct test_bld_rule *r;
+	struct ipv4_5tuple *t;
+
+	memset(test_bld_rules, 0, sizeof(test_bld_rules));
+
+	for (i = 0; i != RTE_DIM(test_bld_rules); i++) {
+		r = test_bld_rules + i;
+		r->data.category_mask = 1;
+		/* unique priorities, so the expected match is well defined */
+		r->data.priority = (i * 7919) % RTE_DIM(test_bld_rules) + 1;
+		r->data.userdata = i + 1;
+
+		if (test_bld_rand() % 2 == 0) {
+			r->field[TEST_BLD_PROTO].value.u8 =
+				(test_bld_rand() % 2 == 0) ? IPPROTO_TCP :
+				IPPROTO_UDP;
+			r->field[TEST_BLD_PROTO].mask_range.u8 = UINT8_MAX;
+		}
+
+		r->field[TEST_BLD_SRC].value.u32 = IPv4(10, 0, 0, 0) |
+			(test_bld_rand() & 0xffff00);
+		r->field[TEST_BLD_SRC].mask_range.u32 =
+			8 + test_bld_rand() % 17;
+		r->field[TEST_BLD_DST].value.u32 = IPv4(192, 168, 0, 0) |
+			(test_bld_rand() & 0xffff);
+		r->field[TEST_BLD_DST].mask_range.u32 =
+			16 + test_bld_rand() % 17;
+
+		lo = test_bld_rand() % 1024;
+		r->field[TEST_BLD_SRCP].value.u16 = lo;
+		r->field[TEST_BLD_SRCP].mask_range.u16 =
+			lo + test_bld_rand() % 2048;
+		if (test_bld_rand() % 2 == 0) {
+			r->field[TEST_BLD_DSTP].mask_range.u16 = UINT16_MAX;
+		} else {
+			lo = test_bld_rand() % 1024;
+			r->field[TEST_BLD_DSTP].value.u16 = lo;
+			r->field[TEST_BLD_DSTP].mask_range.u16 =
+				lo + test_bld_rand() % 64;
+		}
+	}
+
+	/* most traces hit (at least) the rule they are derived from. */
+	for (i = 0; i != RTE_DIM(test_bld_traces); i++) {
+		t = test_bld_traces + i;
+		r = test_bld_rules + test_bld_rand() % RTE_DIM(test_bld_rules);
+
+		t->proto = (test_bld_rand() % 2 == 0) ? IPPROTO_TCP :
+			IPPROTO_UDP;
+		t->ip_src = rte_cpu_to_be_32(r->field[TEST_BLD_SRC].value.u32 |
+			(test_bld_rand() & 0xff));
+		t->ip_dst = rte_cpu_to_be_32(r->field[TEST_BLD_DST].value.u32 ^
+			(test_bld_rand() & 0x3));
+		t->port_src = rte_cpu_to_be_16(
+			r->field[TEST_BLD_SRCP].value.u16 +
+			test_bld_rand() % 16);
+		t->port_dst = rte_cpu_to_be_16(
+			r->field[TEST_BLD_DSTP].value.u16 +
+			test_bld_rand() % 16);
+	}
+}
+
+static int
+test_bld_check(struct rte_acl_ctx *acx, const char *name)
+{
+	int ret;
+	uint32_t alg, i, j, k, n;
+	uint32_t results[RTE_DIM(test_bld_traces)];
+	const uint8_t *data[RTE_DIM(test_bld_traces)];
+	/* bursts of different sizes, to run all the code paths */
+	static const uint32_t burst[] = {
+		1, 3, 7, 8, 15, 16, 31, 32, 64, 100,
+	};
+
+	for (i = 0; i != RTE_DIM(test_bld_traces); i++)
+		data[i] = (const uint8_t *)(test_bld_traces + i);
+
+	for (alg = RTE_ACL_CLASSIFY_SCALAR; alg != RTE_ACL_CLASSIFY_NUM;
+			alg++) {
+
+		ret = rte_acl_set_ctx_classify(acx, alg);
+		if (ret == -ENOTSUP)
+			continue;
+		if (ret != 0) {
+			printf("Line %i: %s: set classify(alg=%u) failed: "
+				"%d\n", __LINE__, name, alg, ret);
+			return -1;
+		}
+
+		/* all traces at once, then in bursts */
+		for (k = 0; k != 2; k++) {
+			memset(results, 0, sizeof(results));
+			for (i = 0, j = 0; i != RTE_DIM(data); i += n, j++) {
+				n = (k == 0) ? RTE_DIM(data) :
+					burst[j % RTE_DIM(burst)];
+				n = RTE_MIN(n, RTE_DIM(data) - i);
+				ret = rte_acl_classify(acx, data + i,
+					results + i, n, 1);
+				if (ret != 0) {
+					printf("Line %i: %s: classify(alg=%u) "
+						"failed: %d\n",
+						__LINE__, name, alg, ret);
+					return -1;
+				}
+			}
+
+			for (i = 0; i != RTE_DIM(results); i++) {
+				if (results[i] != test_bld_expected[i]) {
+					printf("Line %i: %s: alg=%u, "
+						"trace %u: expected %u, "
+						"got %u\n",
+						__LINE__, name, alg, i,
+						test_bld_expected[i],
+						results[i]);
+					return -1;
+				}
+			}
+		}
+	}
+
+	return 0;
+}
+
+static struct rte_acl_ctx *
+test_bld_create(const struct rte_acl_rule *rules, uint32_t num,
+	uint32_t num_threads)
+{
+	int ret;
+	struct rte_acl_ctx *acx;
+	struct rte_acl_param prm;
+	struct rte_acl_config cfg;
+
+	prm = acl_param;
+	prm.name = "acl_bld";
+	prm.rule_size = RTE_ACL_RULE_SZ(TEST_BLD_NUM_FIELDS);
+	prm.max_rule_num = RTE_DIM(test_bld_rules) +
+		RTE_ACL_MAX_CATEGORIES * 2;
+
+	acx = rte_acl_create(&prm);
+	if (acx == NULL) {
+		printf("Line %i: Error creating ACL context!\n", __LINE__);
+		return NULL;
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.num_categories = 1;
+	cfg.num_fields = RTE_DIM(test_bld_defs);
+	memcpy(cfg.defs, test_bld_defs, sizeof(test_bld_defs));
+	cfg.num_threads = num_threads;
+
+	ret = rte_acl_add_rules(acx, rules, num);
+	if (ret == 0)
+		ret = rte_acl_build(acx, &cfg);
+	if (ret != 0) {
+		printf("Line %i: Error building ACL context: %d\n",
+			__LINE__, ret);
+		rte_acl_free(acx);
+		return NULL;
+	}
+
+	return acx;
+}
+
+/*
+ * Test parallel and incremental builds: both have to classify the
+ * same way as a sequential build of the same rules.
+ */
+static int
+test_build(void)
+{
+	int ret;
+	uint32_t i, n;
+	struct rte_acl_ctx *acx;
+	struct rte_acl_build_stats stats;
+	const struct rte_acl_rule *rules;
+
+	rules = (const struct rte_acl_rule *)test_bld_rules;
+	test_bld_gen();
+	test_bld_calc_expected(RTE_DIM(test_bld_rules));
+
+	/* sequential build */
+	acx = test_bld_create(rules, RTE_DIM(test_bld_rules), 0);
+	if (acx == NULL)
+		return -1;
+	ret = test_bld_check(acx, "sequential build");
+	rte_acl_get_build_stats(acx, &stats);
+	rte_acl_free(acx);
+	if (ret != 0)
+		return -1;
+	if (stats.num_threads != 1 || stats.num_tries == 0 ||
+			stats.temp_mem_peak == 0 || stats.runtime_mem == 0) {
+		printf("Line %i: invalid build stats\n", __LINE__);
+		return -1;
+	}
+
+	/* parallel build */
+	acx = test_bld_create(rules, RTE_DIM(test_bld_rules),
+		TEST_BLD_THREADS);
+	if (acx == NULL)
+		return -1;
+	ret = test_bld_check(acx, "parallel build");
+	rte_acl_get_build_stats(acx, &stats);
+	rte_acl_free(acx);
+	if (ret != 0)
+		return -1;
+	printf("%s: parallel build with %u threads, %u tries, "
+		"temporary memory peak: %zu, runtime memory: %zu\n",
+		__func__, stats.num_threads, stats.num_tries,
+		stats.temp_mem_peak, stats.runtime_mem);
+
+	/* base build, then the last rules added as deltas */
+	n = RTE_DIM(test_bld_rules) - TEST_BLD_DELTA;
+	acx = test_bld_create(rules, n, 0);
+	if (acx == NULL)
+		return -1;
+
+	ret = rte_acl_add_delta_rules(NULL, rules, 1);
+	if (ret != -EINVAL) {
+		printf("Line %i: delta to NULL context returned %d\n",
+			__LINE__, ret);
+		goto err;
+	}
+	ret = rte_acl_add_delta_rules(acx, rules + n, 0);
+	if (ret != -EINVAL) {
+		printf("Line %i: empty delta returned %d\n", __LINE__, ret);
+		goto err;
+	}
+
+	for (i = 0; i != 2; i++) {
+		ret = rte_acl_add_delta_rules(acx,
+			(const struct rte_acl_rule *)(test_bld_rules + n),
+			TEST_BLD_DELTA / 2);
+		if (ret != 0) {
+			printf("Line %i: adding delta rules failed: %d\n",
+				__LINE__, ret);
+			goto err;
+		}
+		n += TEST_BLD_DELTA / 2;
+		test_bld_calc_expected(n);
+		ret = test_bld_check(acx, "delta build");
+		if (ret != 0)
+			goto err;
+	}
+
+	rte_acl_get_build_stats(acx, &stats);
+	if (stats.num_delta_rules != TEST_BLD_DELTA ||
+			stats.num_delta_tries < 2) {
+		printf("Line %i: invalid delta stats\n", __LINE__);
+		goto err;
+	}
+
+	/* all tries are used: the next delta should be rejected */
+	for (i = 0; i != RTE_ACL_MAX_CATEGORIES * 2; i++) {
+		ret = rte_acl_add_delta_rules(acx,
+			(const struct rte_acl_rule *)(test_bld_rules + i), 1);
+		if (ret != 0)
+			break;
+	}
+	if (ret != -ENOSPC) {
+		printf("Line %i: delta with no free trie returned %d\n",
+			__LINE__, ret);
+		goto err;
+	}
+
+	/* rules of the rejected delta are not in the context */
+	ret = test_bld_check(acx, "delta build");
+	if (ret != 0)
+		goto err;
+
+	rte_acl_free(acx);
+	return 0;
+err:
+	rte_acl_free(acx);
+	return -1;
+}
+
 static int
 test_acl(void)
 {
@@ -930,6 +1361,8 @@ test_acl(void)
 		return -1;
 	if (test_classify() < 0)
 		return -1;
+	if (test_build() < 0)
+		return -1;
 
 	return 0;
 }
@@ -500,6 +500,376 @@ quit_workers(struct rte_distributor *d, struct rte_mempool *p)
 	worker_idx = 0;
 }
 
+/*** Tests of the burst mode ***/
+
+#define NUM_FLOWS 32
+
+static volatile uint32_t flow_seqn[NUM_FLOWS];
+static volatile unsigned order_errors;
+
+/* burst mode worker which returns the packets it gets, and checks that the
+ * packets of each flow, given by hash.usr, are seen in sequence number order
+ */
+static int
+handle_work_burst(void *arg)
+{
+	struct rte_mbuf *pkts[RTE_DISTRIB_BURST_SIZE];
+	struct rte_distributor *d = arg;
+	unsigned id = __sync_fetch_and_add(&worker_idx, 1);
+	int i, num;
+
+	num = rte_distributor_get_pkt_burst(d, id, pkts, NULL, 0);
+	while (!quit) {
+		for (i = 0; i < num; i++) {
+			unsigned flow = pkts[i]->hash.usr % NUM_FLOWS;
+
+			if (pkts[i]->seqn < flow_seqn[flow])
+				order_errors++;
+			flow_seqn[flow] = pkts[i]->seqn;
+		}
+		worker_stats[id].handled_packets += num;
+		num = rte_distributor_get_pkt_burst(d, id, pkts, pkts, num);
+	}
+	worker_stats[id].handled_packets += num;
+	rte_distributor_return_pkt_burst(d, id, pkts, num);
+	return 0;
+}
+
+/* prepares packets for the burst tests, with sequence numbers following the
+ * packet order and (tag_mask + 1) flows */
+static void
+set_burst_pkts(struct rte_mbuf **bufs, unsigned num, uint32_t tag_mask)
+{
+	unsigned i;
+
+	for (i = 0; i < num; i++) {
+		bufs[i]->hash.usr = (i & tag_mask) + 1;
+		bufs[i]->seqn = i;
+	}
+	memset((void *)(uintptr_t)flow_seqn, 0, sizeof(flow_seqn));
+	order_errors = 0;
+}
+
+/* same tests as sanity_test() for a distributor in burst mode, which in
+ * addition checks that the order of the packets of a flow is preserved.
+ */
+static int
+sanity_test_burst(struct rte_distributor *d, struct rte_mempool *p)
+{
+	struct rte_mbuf *bufs[BURST];
+	struct rte_mbuf *many_bufs[BIG_BATCH], *return_bufs[BIG_BATCH];
+	unsigned num_returned = 0;
+	unsigned i, j, num_workers_used;
+
+	printf("=== Burst distributor sanity tests ===\n");
+	clear_packet_count();
+	if (rte_mempool_get_bulk(p, (void *)bufs, BURST) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		return -1;
+	}
+
+	/* all packets of the same flow go to a single worker, in order */
+	set_burst_pkts(bufs, BURST, 0);
+	rte_distributor_process(d, bufs, BURST);
+	rte_distributor_flush(d);
+	if (total_packet_count() != BURST || order_errors != 0) {
+		printf("Line %d: Error, expected %u packets in order, got %u "
+				"with %u out of order\n", __LINE__, BURST,
+				total_packet_count(), order_errors);
+		return -1;
+	}
+	for (i = 0; i < rte_lcore_count() - 1; i++)
+		printf("Worker %u handled %u packets\n", i,
+				worker_stats[i].handled_packets);
+	for (i = 0; i < rte_lcore_count() - 1; i++)
+		if (worker_stats[i].handled_packets != 0 &&
+				worker_stats[i].handled_packets != BURST)
+			return -1;
+	printf("Burst sanity test with all zero hashes done.\n");
+
+	/* two flows are shared by two workers */
+	if (rte_lcore_count() >= 3) {
+		clear_packet_count();
+		set_burst_pkts(bufs, BURST, 1);
+		rte_distributor_process(d, bufs, BURST);
+		rte_distributor_flush(d);
+		if (total_packet_count() != BURST || order_errors != 0) {
+			printf("Line %d: Error, expected %u packets in order, "
+					"got %u with %u out of order\n",
+					__LINE__, BURST, total_packet_count(),
+					order_errors);
+			return -1;
+		}
+
+		num_workers_used = 0;
+		for (i = 0; i < rte_lcore_count() - 1; i++) {
+			printf("Worker %u handled %u packets\n", i,
+					worker_stats[i].handled_packets);
+			if (worker_stats[i].handled_packets == 0)
+				continue;
+			if (worker_stats[i].handled_packets % (BURST / 2) != 0)
+				return -1;
+			num_workers_used++;
+		}
+		if (num_workers_used == 0)
+			return -1;
+		printf("Burst sanity test with two hash values done\n");
+	}
+
+	rte_mempool_put_bulk(p, (void *)bufs, BURST);
+
+	/* many flows interleaved: check that all the packets made it back and
+	 * that the order within each flow was kept */
+	clear_packet_count();
+	rte_distributor_flush(d);
+	rte_distributor_clear_returns(d);
+	if (rte_mempool_get_bulk(p, (void *)many_bufs, BIG_BATCH) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		return -1;
+	}
+	set_burst_pkts(many_bufs, BIG_BATCH, NUM_FLOWS - 1);
+
+	for (i = 0; i < BIG_BATCH/BURST; i++) {
+		rte_distributor_process(d, &many_bufs[i*BURST], BURST);
+		num_returned += rte_distributor_returned_pkts(d,
+				&return_bufs[num_returned],
+				BIG_BATCH - num_returned);
+	}
+	rte_distributor_flush(d);
+	num_returned += rte_distributor_returned_pkts(d,
+			&return_bufs[num_returned], BIG_BATCH - num_returned);
+
+	if (num_returned != BIG_BATCH || order_errors != 0) {
+		printf("line %d: %u packets returned out of %u sent, "
+				"%u out of order\n", __LINE__, num_returned,
+				BIG_BATCH, order_errors);
+		return -1;
+	}
+	for (i = 0; i < BIG_BATCH; i++) {
+		struct rte_mbuf *src = many_bufs[i];
+		for (j = 0; j < BIG_BATCH; j++)
+			if (return_bufs[j] == src)
+				break;
+
+		if (j == BIG_BATCH) {
+			printf("Error: could not find source packet #%u\n", i);
+			return -1;
+		}
+	}
+	printf("Burst sanity test of returned packets done\n");
+
+	rte_mempool_put_bulk(p, (void *)many_bufs, BIG_BATCH);
+
+	printf("\n");
+	return 0;
+}
+
+/* burst mode version of handle_work_with_free_mbufs() */
+static int
+handle_work_burst_with_free_mbufs(void *arg)
+{
+	struct rte_mbuf *pkts[RTE_DISTRIB_BURST_SIZE];
+	struct rte_distributor *d = arg;
+	unsigned id = __sync_fetch_and_add(&worker_idx, 1);
+	int i, num;
+
+	num = rte_distributor_get_pkt_burst(d, id, pkts, NULL, 0);
+	while (!quit) {
+		worker_stats[id].handled_packets += num;
+		for (i = 0; i < num; i++)
+			rte_pktmbuf_free(pkts[i]);
+		num = rte_distributor_get_pkt_burst(d, id, pkts, NULL, 0);
+	}
+	worker_stats[id].handled_packets += num;
+	rte_distributor_return_pkt_burst(d, id, pkts, num);
+	return 0;
+}
+
+/* burst mode version of handle_work_for_shutdown_test() */
+static int
+handle_work_burst_for_shutdown_test(void *arg)
+{
+	struct rte_mbuf *pkts[RTE_DISTRIB_BURST_SIZE];
+	struct rte_distributor *d = arg;
+	const unsigned id = __sync_fetch_and_add(&worker_idx, 1);
+	int i, num, quitting;
+
+	num = rte_distributor_get_pkt_burst(d, id, pkts, NULL, 0);
+	/* wait for quit single globally, or for worker zero, wait
+	 * for zero_quit */
+	while (!(quitting = quit) && !(id == 0 && zero_quit)) {
+		worker_stats[id].handled_packets += num;
+		for (i = 0; i < num; i++)
+			rte_pktmbuf_free(pkts[i]);
+		num = rte_distributor_get_pkt_burst(d, id, pkts, NULL, 0);
+	}
+	worker_stats[id].handled_packets += num;
+	rte_distributor_return_pkt_burst(d, id, pkts, num);
+
+	/* unless it already got its packet from quit_workers_burst() */
+	if (id == 0 && !quitting) {
+		/* for worker zero, allow it to restart to pick up last packet
+		 * when all workers are shutting down.
+		 */
+		while (zero_quit)
+			usleep(100);
+		num = rte_distributor_get_pkt_burst(d, id, pkts, NULL, 0);
+		while (!quit) {
+			worker_stats[id].handled_packets += num;
+			for (i = 0; i < num; i++)
+				rte_pktmbuf_free(pkts[i]);
+			num = rte_distributor_get_pkt_burst(d, id, pkts,
+					NULL, 0);
+		}
+		worker_stats[id].handled_packets += num;
+		rte_distributor_return_pkt_burst(d, id, pkts, num);
+	}
+	return 0;
+}
+
+/* burst mode version of sanity_test_with_worker_shutdown(): the packets
+ * queued to worker zero when it shuts down must be handled by the others.
+ */
+static int
+sanity_test_burst_with_worker_shutdown(struct rte_distributor *d,
+		struct rte_mempool *p)
+{
+	struct rte_mbuf *bufs[BURST];
+	unsigned i;
+
+	printf("=== Burst sanity test of worker shutdown ===\n");
+
+	clear_packet_count();
+	if (rte_mempool_get_bulk(p, (void *)bufs, BURST) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		return -1;
+	}
+	for (i = 0; i < BURST; i++)
+		bufs[i]->hash.usr = 0;
+	rte_distributor_process(d, bufs, BURST);
+
+	if (rte_mempool_get_bulk(p, (void *)bufs, BURST) != 0) {
+		printf("line %d: Error getting mbufs from pool\n", __LINE__);
+		return -1;
+	}
+	for (i = 0; i < BURST; i++)
+		bufs[i]->hash.usr = 0;
+
+	/* get worker zero to quit */
+	zero_quit = 1;
+	rte_distributor_process(d, bufs, BURST);
+
+	rte_distributor_flush(d);
+	if (total_packet_count() != BURST * 2) {
+		printf("Line %d: Error, not all packets flushed. "
+				"Expected %u, got %u\n",
+				__LINE__, BURST * 2, total_packet_count());
+		return -1;
+	}
+
+	for (i = 0; i < rte_lcore_count() - 1; i++)
+		printf("Worker %u handled %u packets\n", i,
+				worker_stats[i].handled_packets);
+
+	printf("Burst sanity test with worker shutdown passed\n\n");
+	return 0;
+}
+
+/* Ensures that all burst mode worker functions terminate. Packets are sent
+ * one at a time, as a worker takes all the packets queued to it at once. */
+static void
+quit_workers_burst(struct rte_distributor *d, struct rte_mempool *p)
+{
+	const unsigned num_workers = rte_lcore_count() - 1;
+	struct rte_mbuf *buf;
+	unsigned i;
+
+	zero_quit = 0;
+	quit = 1;
+	for (i = 0; i < num_workers; i++) {
+		while (rte_mempool_get(p, (void *)&buf) != 0)
+			rte_distributor_process(d, NULL, 0);
+		buf->hash.usr = i << 1;
+		rte_distributor_process(d, &buf, 1);
+		rte_distributor_flush(d);
+		rte_mempool_put(p, buf);
+	}
+	rte_distributor_clear_returns(d);
+	rte_eal_mp_wait_lcore();
+	quit = 0;
+	worker_idx = 0;
+}
+
+/* the burst worker APIs refuse to return more than RTE_DISTRIB_BURST_SIZE
+ * packets at a time, as they would not fit in the worker cache line */
+static int
+test_error_distributor_burst_size(struct rte_distributor *d)
+{
+	struct rte_mbuf *pkts[RTE_DISTRIB_BURST_SIZE + 1];
+	const unsigned num = RTE_DIM(pkts);
+
+	memset(pkts, 0, sizeof(pkts));
+	if (rte_distributor_request_pkt_burst(d, 0, pkts, num) != -EINVAL) {
+		printf("ERROR: No error on request_pkt_burst() with too many packets\n");
+		return -1;
+	}
+	if (rte_distributor_get_pkt_burst(d, 0, pkts, pkts, num) != -EINVAL) {
+		printf("ERROR: No error on get_pkt_burst() with too many packets\n");
+		return -1;
+	}
+	if (rte_distributor_return_pkt_burst(d, 0, pkts, num) != -EINVAL) {
+		printf("ERROR: No error on return_pkt_burst() with too many packets\n");
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_distributor_burst(struct rte_mempool *p)
+{
+	static struct rte_distributor *d;
+
+	if (d == NULL) {
+		d = rte_distributor_create_burst("Test_dist_burst",
+				rte_socket_id(), rte_lcore_count() - 1);
+		if (d == NULL) {
+			printf("Error creating burst distributor\n");
+			return -1;
+		}
+	} else {
+		rte_distributor_flush(d);
+		rte_distributor_clear_returns(d);
+	}
+
+	if (test_error_distributor_burst_size(d) < 0)
+		return -1;
+
+	rte_eal_mp_remote_launch(handle_work_burst, d, SKIP_MASTER);
+	if (sanity_test_burst(d, p) < 0)
+		goto err;
+	quit_workers_burst(d, p);
+
+	rte_eal_mp_remote_launch(handle_work_burst_with_free_mbufs, d,
+			SKIP_MASTER);
+	if (sanity_test_with_mbuf_alloc(d, p) < 0)
+		goto err;
+	quit_workers_burst(d, p);
+
+	if (rte_lcore_count() > 2) {
+		rte_eal_mp_remote_launch(handle_work_burst_for_shutdown_test, d,
+				SKIP_MASTER);
+		if (sanity_test_burst_with_worker_shutdown(d, p) < 0)
+			goto err;
+		quit_workers_burst(d, p);
+	}
+
+	return 0;
+
+err:
+	quit_workers_burst(d, p);
+	return -1;
+}
+
 #define MBUF_DATA_SIZE (2048 + RTE_PKTMBUF_HEADROOM)
 
 static int
@@ -569,7 +939,7 @@ test_distributor(void)
 		return -1;
 	}
 
-	return 0;
+	return test_distributor_burst(p);
 
 err:
 	quit_workers(d, p);
@@ -141,12 +141,32 @@ handle_work(void *arg)
 	return 0;
 }
 
+/* burst mode version of handle_work() */
+static int
+handle_work_burst(void *arg)
+{
+	struct rte_mbuf *pkts[RTE_DISTRIB_BURST_SIZE];
+	struct rte_distributor *d = arg;
+	unsigned id = __sync_fetch_and_add(&worker_idx, 1);
+	int num;
+
+	num = rte_distributor_get_pkt_burst(d, id, pkts, NULL, 0);
+	while (!quit) {
+		worker_stats[id].handled_packets += num;
+		num = rte_distributor_get_pkt_burst(d, id, pkts, pkts, num);
+	}
+	worker_stats[id].handled_packets += num;
+	rte_distributor_return_pkt_burst(d, id, pkts, num);
+	return 0;
+}
+
 /* this basic performance test just repeatedly sends in 32 packets at a time
  * to the distributor and verifies at the end that we got them all in the worker
  * threads and finally how long per packet the processing took.
  */
 static inline int
-perf_test(struct rte_distributor *d, struct rte_mempool *p)
+perf_test(struct rte_distributor *d, struct rte_mempool *p,
+		unsigned num_workers, uint64_t *cycles_per_pkt)
 {
 	unsigned i;
 	uint64_t start, end;
@@ -175,9 +195,10 @@ perf_test(struct rte_distributor *d, struct rte_mempool *p)
 	printf("Time per burst:  %"PRIu64"\n", (end - start) >> ITER_POWER);
 	printf("Time per packet: %"PRIu64"\n\n",
 			((end - start) >> ITER_POWER)/BURST);
+	*cycles_per_pkt = ((end - start) >> ITER_POWER) / BURST;
 	rte_mempool_put_bulk(p, (void *)bufs, BURST);
 
-	for (i = 0; i < rte_lcore_count() - 1; i++)
+	for (i = 0; i < num_workers; i++)
 		printf("Worker %u handled %u packets\n", i,
 				worker_stats[i].handled_packets);
 	printf("Total packets: %u (%x)\n", total_packet_count(),
@@ -187,11 +208,14 @@ perf_test(struct rte_distributor *d, struct rte_mempool *p)
 	return 0;
 }
 
-/* Useful function which ensures that all worker functions terminate */
+/* Useful function which ensures that all worker functions terminate. In
+ * burst mode, a worker takes all the packets queued to it at once, so the
+ * packets are sent one at a time until each worker got one.
+ */
 static void
-quit_workers(struct rte_distributor *d, struct rte_mempool *p)
+quit_workers(struct rte_distributor *d, struct rte_mempool *p,
+		unsigned num_workers, int burst)
 {
-	const unsigned num_workers = rte_lcore_count() - 1;
 	unsigned i;
 	struct rte_mbuf *bufs[RTE_MAX_LCORE];
 	rte_mempool_get_bulk(p, (void *)bufs, num_workers);
@@ -199,7 +223,13 @@ quit_workers(struct rte_distributor *d, struct rte_mempool *p)
 	quit = 1;
 	for (i = 0; i < num_workers; i++)
 		bufs[i]->hash.usr = i << 1;
-	rte_distributor_process(d, bufs, num_workers);
+	if (burst) {
+		for (i = 0; i < num_workers; i++) {
+			rte_distributor_process(d, &bufs[i], 1);
+			rte_distributor_flush(d);
+		}
+	} else
+		rte_distributor_process(d, bufs, num_workers);
 
 	rte_mempool_put_bulk(p, (void *)bufs, num_workers);
 
@@ -209,13 +239,32 @@ quit_workers(struct rte_distributor *d, struct rte_mempool *p)
 	worker_idx = 0;
 }
 
+/* launches the worker function on the first num_workers slave lcores */
+static void
+launch_workers(lcore_function_t *f, struct rte_distributor *d,
+		unsigned num_workers)
+{
+	unsigned lcore_id, n = 0;
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (n++ == num_workers)
+			break;
+		rte_eal_remote_launch(f, d, lcore_id);
+	}
+}
+
 #define MBUF_DATA_SIZE (2048 + RTE_PKTMBUF_HEADROOM)
 
+static const unsigned perf_num_workers[] = {2, 8, 16, 32};
+
 static int
 test_distributor_perf(void)
 {
-	static struct rte_distributor *d;
+	static struct rte_distributor *d[RTE_DIM(perf_num_workers)][2];
 	static struct rte_mempool *p;
+	uint64_t cycles[RTE_DIM(perf_num_workers)][2];
+	char name[RTE_DISTRIBUTOR_NAMESIZE];
+	unsigned i, burst;
 
 	if (rte_lcore_count() < 2) {
 		printf("ERROR: not enough cores to test distributor\n");
@@ -225,18 +274,6 @@ test_distributor_perf(void)
 	/* first time how long it takes to round-trip a cache line */
 	time_cache_line_switch();
 
-	if (d == NULL) {
-		d = rte_distributor_create("Test_perf", rte_socket_id(),
-				rte_lcore_count() - 1);
-		if (d == NULL) {
-			printf("Error creating distributor\n");
-			return -1;
-		}
-	} else {
-		rte_distributor_flush(d);
-		rte_distributor_clear_returns(d);
-	}
-
 	const unsigned nb_bufs = (511 * rte_lcore_count()) < BIG_BATCH ?
 			(BIG_BATCH * 2) - 1 : (511 * rte_lcore_count());
 	if (p == NULL) {
@@ -248,10 +285,54 @@ test_distributor_perf(void)
 		}
 	}
 
-	rte_eal_mp_remote_launch(handle_work, d, SKIP_MASTER);
-	if (perf_test(d, p) < 0)
-		return -1;
-	quit_workers(d, p);
+	/* time both the single packet and the burst modes */
+	memset(cycles, 0, sizeof(cycles));
+	for (i = 0; i < RTE_DIM(perf_num_workers); i++) {
+		const unsigned num_workers = perf_num_workers[i];
+
+		if (num_workers > rte_lcore_count() - 1) {
+			printf("Not enough cores to test %u workers\n",
+					num_workers);
+			continue;
+		}
+
+		for (burst = 0; burst < 2; burst++) {
+			if (d[i][burst] == NULL) {
+				snprintf(name, sizeof(name), "Test_perf%s_%u",
+						burst ? "_burst" : "",
+						num_workers);
+				d[i][burst] = burst ?
+					rte_distributor_create_burst(name,
+						rte_socket_id(), num_workers) :
+					rte_distributor_create(name,
+						rte_socket_id(), num_workers);
+				if (d[i][burst] == NULL) {
+					printf("Error creating distributor\n");
+					return -1;
+				}
+			} else {
+				rte_distributor_flush(d[i][burst]);
+				rte_distributor_clear_returns(d[i][burst]);
+			}
+
+			printf("=== %u workers, %s mode ===\n", num_workers,
+					burst ? "burst" : "single packet");
+			launch_workers(burst ? handle_work_burst : handle_work,
+					d[i][burst], num_workers);
+			if (perf_test(d[i][burst], p, num_workers,
+					&cycles[i][burst]) < 0)
+				return -1;
+			quit_workers(d[i][burst], p, num_workers, burst);
+		}
+	}
+
+	printf("=== Distributor cycles per packet ===\n");
+	printf("Workers   Single   Burst\n");
+	for (i = 0; i < RTE_DIM(perf_num_workers); i++)
+		if (cycles[i][0] != 0)
+			printf("%7u %8"PRIu64" %7"PRIu64"\n",
+					perf_num_workers[i],
+					cycles[i][0], cycles[i][1]);
 
 	return 0;
 }
@@ -774,6 +774,9 @@ test_no_huge_flag(void)
 	/* With --no-huge, -m and --socket-mem */
 	const char *argv4[] = {prgname, prefix, no_huge, "-c", "1", "-n", "2",
 			"-m", DEFAULT_MEM_SIZE, "--socket-mem=" DEFAULT_MEM_SIZE};
+	/* With --no-huge and --mem-grow */
+	const char *argv5[] = {prgname, prefix, no_huge, "-c", "1", "-n", "2",
+			"--mem-grow"};
 	if (launch_proc(argv1) != 0) {
 		printf("Error - process did not run ok with --no-huge flag\n");
 		return -1;
@@ -797,6 +800,11 @@ test_no_huge_flag(void)
 				"--socket-mem flags\n");
 		return -1;
 	}
+	if (launch_proc(argv5) == 0) {
+		printf("Error - process run ok with --no-huge and --mem-grow "
+				"flags\n");
+		return -1;
+	}
 	return 0;
 }
 
@@ -33,6 +33,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -48,6 +49,9 @@
 #include <rte_eal.h>
 #include <rte_ip.h>
 #include <rte_string_fns.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
+#include <rte_atomic.h>
 
 #include "test.h"
 
@@ -461,6 +465,7 @@ static int test_five_keys(void)
 	int expected_pos[5];
 	unsigned i;
 	int ret;
+	uint64_t hit_mask;
 
 	ut_params.name = "test3";
 	handle = rte_hash_create(&ut_params);
@@ -487,6 +492,15 @@ static int test_five_keys(void)
 					"failed to find key (pos[%u]=%d)", i, pos[i]);
 		}
 
+	ret = rte_hash_lookup_bulk_hit_mask(handle, &key_array[0], 5,
+			(int32_t *)pos, &hit_mask);
+	RETURN_IF_ERROR(ret != 5 || hit_mask != 0x1f,
+			"bulk lookup found %d keys (hit_mask=0x%"PRIx64")",
+			ret, hit_mask);
+	for (i = 0; i < 5; i++)
+		RETURN_IF_ERROR(pos[i] != expected_pos[i],
+				"failed to find key (pos[%u]=%d)", i, pos[i]);
+
 	/* Add - update */
 	for (i = 0; i < 5; i++) {
 		pos[i] = rte_hash_add_key(handle, &keys[i]);
@@ -1374,6 +1388,191 @@ fail_jhash_3word:
 	return ret;
 }
 
+#define CUCKOO_TEST_ENTRIES	(1 << 16)
+#define CUCKOO_TEST_MIN_LOAD	95	/* percent */
+
+/*
+ * Fill a cuckoo hash with distinct keys until it reports -ENOSPC, then
+ * check the load reached, that every key added is still found at the
+ * position returned when it was added, in both single and bulk lookups,
+ * and that deleted positions are reused.
+ */
+static int
+test_cuckoo_load_factor(void)
+{
+	struct rte_hash *handle;
+	struct rte_hash_parameters params = {
+		.name = "cuckoo_load",
+		.entries = CUCKOO_TEST_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_CUCKOO,
+	};
+	static int32_t key_pos[CUCKOO_TEST_ENTRIES];
+	const void *key_ptrs[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t positions[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t keys_u32[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t i, j, added;
+	uint64_t hit_mask;
+	int32_t pos;
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	for (added = 0; added < CUCKOO_TEST_ENTRIES; added++) {
+		pos = rte_hash_add_key(handle, &added);
+		if (pos == -ENOSPC)
+			break;
+		RETURN_IF_ERROR(pos < 0 || pos >= CUCKOO_TEST_ENTRIES,
+				"failed to add key %u (pos=%d)", added, pos);
+		key_pos[added] = pos;
+	}
+	printf("# Cuckoo hash filled %u of %u entries (%u%%)\n", added,
+			CUCKOO_TEST_ENTRIES, added * 100 / CUCKOO_TEST_ENTRIES);
+	RETURN_IF_ERROR(added * 100 < CUCKOO_TEST_MIN_LOAD * CUCKOO_TEST_ENTRIES,
+			"load factor below %u%%", CUCKOO_TEST_MIN_LOAD);
+
+	for (i = 0; i < added; i++) {
+		pos = rte_hash_lookup(handle, &i);
+		RETURN_IF_ERROR(pos != key_pos[i],
+				"key %u found at %d instead of %d", i, pos,
+				key_pos[i]);
+	}
+
+	for (i = 0; i + RTE_HASH_LOOKUP_BULK_MAX <= added;
+			i += RTE_HASH_LOOKUP_BULK_MAX) {
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++) {
+			/* mix hits and misses */
+			keys_u32[j] = (j & 1) ? i + j : CUCKOO_TEST_ENTRIES + j;
+			key_ptrs[j] = &keys_u32[j];
+		}
+		RETURN_IF_ERROR(rte_hash_lookup_bulk_hit_mask(handle, key_ptrs,
+				RTE_HASH_LOOKUP_BULK_MAX, positions,
+				&hit_mask) != RTE_HASH_LOOKUP_BULK_MAX / 2,
+				"bulk lookup failed");
+		RETURN_IF_ERROR(hit_mask != 0xaaaaaaaaaaaaaaaaULL >>
+				(64 - RTE_HASH_LOOKUP_BULK_MAX),
+				"bad bulk lookup hit mask 0x%"PRIx64, hit_mask);
+		for (j = 0; j < RTE_HASH_LOOKUP_BULK_MAX; j++) {
+			pos = (j & 1) ? key_pos[i + j] : -ENOENT;
+			RETURN_IF_ERROR(positions[j] != pos,
+					"bulk lookup of key %u returned %d "
+					"instead of %d", keys_u32[j],
+					positions[j], pos);
+		}
+	}
+
+	/* Deleted positions must be available again */
+	for (i = 0; i < added; i += 2) {
+		pos = rte_hash_del_key(handle, &i);
+		RETURN_IF_ERROR(pos != key_pos[i],
+				"failed to delete key %u (pos=%d)", i, pos);
+	}
+	for (i = 0; i < added; i += 2) {
+		pos = rte_hash_add_key(handle, &i);
+		RETURN_IF_ERROR(pos < 0, "failed to re-add key %u", i);
+	}
+
+	rte_hash_free(handle);
+	return 0;
+}
+
+#define CUCKOO_LF_PRELOAD	(CUCKOO_TEST_ENTRIES / 2)
+
+static struct rte_hash *cuckoo_lf_handle;
+static int32_t cuckoo_lf_pos[CUCKOO_LF_PRELOAD];
+static volatile int cuckoo_lf_stop;
+static rte_atomic32_t cuckoo_lf_errors;
+
+/* Reader: keys added before the writer started must always be found. */
+static int
+test_cuckoo_lf_reader(__attribute__((unused)) void *arg)
+{
+	uint32_t i;
+	int32_t pos;
+
+	while (!cuckoo_lf_stop) {
+		for (i = 0; i < CUCKOO_LF_PRELOAD; i++) {
+			pos = rte_hash_lookup(cuckoo_lf_handle, &i);
+			if (pos != cuckoo_lf_pos[i])
+				rte_atomic32_inc(&cuckoo_lf_errors);
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Run lookups on all slave lcores while the master lcore keeps adding and
+ * deleting keys in a lock-free cuckoo hash loaded high enough to force
+ * displacements, and check no reader ever misses a stable key.
+ */
+static int
+test_cuckoo_rw_lf(void)
+{
+	struct rte_hash *handle;
+	struct rte_hash_parameters params = {
+		.name = "cuckoo_rw_lf",
+		.entries = CUCKOO_TEST_ENTRIES,
+		.key_len = sizeof(uint32_t),
+		.hash_func = rte_jhash,
+		.hash_func_init_val = 0,
+		.socket_id = 0,
+		.extra_flag = RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF,
+	};
+	uint32_t i, k, added;
+	int32_t pos;
+	unsigned round;
+
+	if (rte_lcore_count() < 2) {
+		printf("# Not enough lcores for lock-free cuckoo test, "
+				"skipping\n");
+		return 0;
+	}
+
+	handle = rte_hash_create(&params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+	RETURN_IF_ERROR(rte_hash_free_key_with_position(handle, -1) == 0,
+			"freed an invalid position");
+
+	for (i = 0; i < CUCKOO_LF_PRELOAD; i++) {
+		cuckoo_lf_pos[i] = rte_hash_add_key(handle, &i);
+		RETURN_IF_ERROR(cuckoo_lf_pos[i] < 0, "failed to add key %u", i);
+	}
+
+	cuckoo_lf_handle = handle;
+	cuckoo_lf_stop = 0;
+	rte_atomic32_init(&cuckoo_lf_errors);
+	rte_eal_mp_remote_launch(test_cuckoo_lf_reader, NULL, SKIP_MASTER);
+
+	for (round = 0; round < 4; round++) {
+		/* Fill up, moving the stable keys around */
+		for (k = CUCKOO_LF_PRELOAD; k < CUCKOO_TEST_ENTRIES; k++)
+			if (rte_hash_add_key(handle, &k) < 0)
+				break;
+		added = k;
+		for (k = CUCKOO_LF_PRELOAD; k < added; k++) {
+			pos = rte_hash_del_key(handle, &k);
+			if (pos < 0 ||
+				rte_hash_free_key_with_position(handle, pos))
+				break;
+		}
+	}
+
+	cuckoo_lf_stop = 1;
+	rte_eal_mp_wait_lcore();
+
+	RETURN_IF_ERROR(k != added, "failed to delete key %u", k);
+	RETURN_IF_ERROR(rte_atomic32_read(&cuckoo_lf_errors) != 0,
+			"readers missed %d lookups",
+			rte_atomic32_read(&cuckoo_lf_errors));
+
+	rte_hash_free(handle);
+	return 0;
+}
+
 /*
  * Do all unit and performance tests.
  */
@@ -1401,6 +1600,20 @@ test_hash(void)
 	if (test_full_bucket() < 0)
 		return -1;
 
+	/* Repeat the basic sequences with the cuckoo backend */
+	ut_params.extra_flag = RTE_HASH_EXTRA_FLAGS_CUCKOO;
+	if (test_add_delete() < 0)
+		return -1;
+	if (test_add_update_delete() < 0)
+		return -1;
+	if (test_five_keys() < 0)
+		return -1;
+	ut_params.extra_flag = 0;
+	if (test_cuckoo_load_factor() < 0)
+		return -1;
+	if (test_cuckoo_rw_lf() < 0)
+		return -1;
+
 	if (test_fbk_hash_find_existing() < 0)
 		return -1;
 	if (fbk_hash_unit_test() < 0)
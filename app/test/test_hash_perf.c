@@ -749,6 +749,111 @@ fbk_hash_perf_test(void)
 	return 0;
 }
 
+/* Control operation of the bulk lookup performance test. */
+#define BULK_PERF_ENTRIES (1 << 16)	/* Table entries. */
+#define BULK_PERF_KEY_LEN 16		/* Key length, as an IPv4 5-tuple. */
+#define BULK_PERF_LOOKUPS (1 << 20)	/* Lookups timed per measurement. */
+
+/*
+ * Compare the cost of looking up a burst of keys one at a time with
+ * rte_hash_lookup() against a single rte_hash_lookup_bulk_hit_mask() call,
+ * for both table backends and several burst sizes.
+ */
+static int
+run_bulk_perf_test(uint8_t extra_flag, uint32_t bucket_entries,
+		uint32_t load)
+{
+	struct rte_hash_parameters hash_params = {
+		.name = "bulk_perf",
+		.entries = BULK_PERF_ENTRIES,
+		.bucket_entries = bucket_entries,
+		.key_len = BULK_PERF_KEY_LEN,
+		.hash_func = rte_hash_crc,
+		.hash_func_init_val = 0,
+		.socket_id = rte_socket_id(),
+		.extra_flag = extra_flag,
+	};
+	static const uint32_t burst_sizes[] = {8, 16, 32, RTE_HASH_LOOKUP_BULK_MAX};
+	struct rte_hash *handle;
+	uint8_t (*keys)[BULK_PERF_KEY_LEN];
+	const void *key_ptrs[RTE_HASH_LOOKUP_BULK_MAX];
+	int32_t positions[RTE_HASH_LOOKUP_BULK_MAX];
+	uint64_t begin, single_ticks, bulk_ticks, hit_mask, hits = 0;
+	uint32_t added = 0, i, j, b, burst;
+
+	handle = rte_hash_create(&hash_params);
+	RETURN_IF_ERROR(handle == NULL, "hash creation failed");
+
+	keys = rte_malloc(NULL, BULK_PERF_ENTRIES * BULK_PERF_KEY_LEN, 0);
+	if (keys == NULL) {
+		rte_hash_free(handle);
+		printf("ERROR line %d: key array allocation failed\n",
+			__LINE__);
+		return -1;
+	}
+
+	/* Fill the table up to the requested load with random keys */
+	while (added * 100 < load * BULK_PERF_ENTRIES) {
+		for (j = 0; j < BULK_PERF_KEY_LEN; j++)
+			keys[added][j] = (uint8_t) rte_rand();
+		if (rte_hash_add_key(handle, keys[added]) >= 0)
+			added++;
+	}
+
+	for (b = 0; b < RTE_DIM(burst_sizes); b++) {
+		burst = burst_sizes[b];
+
+		begin = rte_rdtsc();
+		for (i = 0; i < BULK_PERF_LOOKUPS; i += burst) {
+			for (j = 0; j < burst; j++)
+				positions[j] = rte_hash_lookup(handle,
+					keys[(i * 7919 + j * 104729) % added]);
+			hits += positions[0] >= 0;
+		}
+		single_ticks = rte_rdtsc() - begin;
+
+		begin = rte_rdtsc();
+		for (i = 0; i < BULK_PERF_LOOKUPS; i += burst) {
+			for (j = 0; j < burst; j++)
+				key_ptrs[j] =
+					keys[(i * 7919 + j * 104729) % added];
+			rte_hash_lookup_bulk_hit_mask(handle, key_ptrs, burst,
+					positions, &hit_mask);
+			hits += hit_mask & 1;
+		}
+		bulk_ticks = rte_rdtsc() - begin;
+
+		printf("%-8s, %-10u, %-9u, %-18.2f, %.2f\n",
+			(extra_flag & RTE_HASH_EXTRA_FLAGS_CUCKOO) ?
+				"cuckoo" : "bucket",
+			added, burst,
+			(double)single_ticks / BULK_PERF_LOOKUPS,
+			(double)bulk_ticks / BULK_PERF_LOOKUPS);
+	}
+
+	/* Keep the lookups from being optimised out */
+	if (hits == 0)
+		printf("No hit in bulk lookup performance test\n");
+
+	rte_free(keys);
+	rte_hash_free(handle);
+	return 0;
+}
+
+static int
+run_all_bulk_perf_tests(void)
+{
+	printf("\n\n *** Hash table bulk lookup performance test results ***\n");
+	printf("Backend , Keys      , Burst    , Single Ticks/Lookup, "
+	       "Bulk Ticks/Lookup\n");
+
+	if (run_bulk_perf_test(0, 16, 50) < 0)
+		return -1;
+	if (run_bulk_perf_test(RTE_HASH_EXTRA_FLAGS_CUCKOO, 0, 90) < 0)
+		return -1;
+	return 0;
+}
+
 /*
  * Do all unit and performance tests.
  */
@@ -757,6 +862,8 @@ test_hash_perf(void)
 {
 	if (run_all_tbl_perf_tests() < 0)
 		return -1;
+	if (run_all_bulk_perf_tests() < 0)
+		return -1;
 	run_hash_func_tests();
 
 	if (fbk_hash_perf_test() < 0)
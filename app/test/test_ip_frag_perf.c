@@ -0,0 +1,671 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+#include <rte_cycles.h>
+#include <rte_errno.h>
+#include <rte_random.h>
+#include <rte_mbuf.h>
+#include <rte_ip.h>
+#include <rte_ip_frag.h>
+
+#include "test.h"
+
+#define NB_MBUF          16384
+#define MBUF_DATA_SIZE   (RTE_PKTMBUF_HEADROOM + 128)
+#define BURST            32
+#define PREFETCH_OFFSET  3
+
+#define FRAG_PER_PKT     4  /* fragments per datagram */
+#define FRAG_PAYLOAD     64 /* payload bytes per fragment */
+
+#define TBL_ENTRIES      4096
+#define BUCKET_ENTRIES   16
+#define TMS_STEP         1000 /* virtual cycles between bursts */
+#define TTL_BURSTS       256  /* entry TTL, in bursts */
+
+#define REORDER_PKTS     8192 /* datagrams in the reorder-heavy stream */
+#define REORDER_WINDOW   64   /* datagrams shuffled together */
+
+#define FLOOD_BURSTS     2048 /* bursts in the flood stream */
+#define FLOOD_LEGIT      8    /* fragments of complete datagrams per burst */
+
+#define FLOOD_MAX_MBUFS  2048
+#define FLOOD_ADMIT_MBUFS 1536
+
+#define MAX_FRAGS        (FLOOD_BURSTS * BURST)
+
+#define JUMBO_NB_MBUF    1024
+#define JUMBO_SEG_SIZE   2048 /* data room of the input packets segments */
+#define JUMBO_PKT_SIZE   9000 /* size of the packets to fragment */
+#define JUMBO_MTU        1500
+#define JUMBO_ITER       256
+#define JUMBO_MAX_FRAGS  (BURST * ((JUMBO_PKT_SIZE + JUMBO_MTU - 1) / \
+	(JUMBO_MTU - 48) + 1))
+#define IND_NB_MBUF      (JUMBO_MAX_FRAGS * 4)
+
+/* fragment to generate */
+struct frag_gen {
+	uint32_t src;
+	uint16_t id;
+	uint16_t idx;
+};
+
+static struct frag_gen frags[MAX_FRAGS];
+static uint32_t nb_frags;
+
+static struct rte_mempool *frag_pool;
+static struct rte_mempool *jumbo_pool;
+static struct rte_mempool *ind_pool;
+static struct rte_ip_frag_death_row death_row;
+
+static void
+gen_datagram(uint32_t src, uint16_t id)
+{
+	uint32_t i;
+
+	for (i = 0; i != FRAG_PER_PKT; i++) {
+		frags[nb_frags].src = src;
+		frags[nb_frags].id = id;
+		frags[nb_frags].idx = (uint16_t)i;
+		nb_frags++;
+	}
+}
+
+static void
+shuffle(struct frag_gen *f, uint32_t n)
+{
+	struct frag_gen t;
+	uint32_t i, j;
+
+	for (i = n - 1; i != 0; i--) {
+		j = rte_rand() % (i + 1);
+		t = f[i];
+		f[i] = f[j];
+		f[j] = t;
+	}
+}
+
+/*
+ * fragments of REORDER_WINDOW consecutive datagrams
+ * arrive in random order.
+ */
+static void
+gen_reorder_stream(void)
+{
+	uint32_t i;
+
+	nb_frags = 0;
+	for (i = 0; i != REORDER_PKTS; i++) {
+		gen_datagram(IPv4(10, 0, 0, 1), (uint16_t)i);
+		if ((i + 1) % REORDER_WINDOW == 0)
+			shuffle(frags + nb_frags -
+				REORDER_WINDOW * FRAG_PER_PKT,
+				REORDER_WINDOW * FRAG_PER_PKT);
+	}
+}
+
+/*
+ * each burst carries FLOOD_LEGIT fragments of complete datagrams,
+ * the rest are first fragments of datagrams that never complete.
+ */
+static void
+gen_flood_stream(void)
+{
+	uint32_t i, j;
+	uint16_t id;
+
+	nb_frags = 0;
+	id = 0;
+	for (i = 0; i != FLOOD_BURSTS; i++) {
+		for (j = 0; j != FLOOD_LEGIT; j += FRAG_PER_PKT)
+			gen_datagram(IPv4(10, 0, 0, 1), id++);
+		for (; j != BURST; j++) {
+			frags[nb_frags].src = (uint32_t)rte_rand();
+			frags[nb_frags].id = (uint16_t)rte_rand();
+			frags[nb_frags].idx = 0;
+			nb_frags++;
+		}
+		shuffle(frags + nb_frags - BURST, BURST);
+	}
+}
+
+static struct rte_mbuf *
+build_ipv4_frag(const struct frag_gen *f)
+{
+	struct rte_mbuf *m;
+	struct ipv4_hdr *ip;
+	uint16_t ofs;
+
+	m = rte_pktmbuf_alloc(frag_pool);
+	if (m == NULL)
+		return NULL;
+
+	ip = (struct ipv4_hdr *)rte_pktmbuf_append(m,
+		sizeof(*ip) + FRAG_PAYLOAD);
+	if (ip == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(ip, 0, sizeof(*ip));
+	ip->version_ihl = 0x45;
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->total_length = rte_cpu_to_be_16(sizeof(*ip) + FRAG_PAYLOAD);
+	ip->packet_id = rte_cpu_to_be_16(f->id);
+	ofs = (uint16_t)(f->idx * FRAG_PAYLOAD / IPV4_HDR_OFFSET_UNITS);
+	if (f->idx != FRAG_PER_PKT - 1)
+		ofs |= IPV4_HDR_MF_FLAG;
+	ip->fragment_offset = rte_cpu_to_be_16(ofs);
+	ip->src_addr = rte_cpu_to_be_32(f->src);
+	ip->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+
+	m->l2_len = 0;
+	m->l3_len = sizeof(*ip);
+	return m;
+}
+
+static struct rte_mbuf *
+build_ipv6_frag(const struct frag_gen *f)
+{
+	struct rte_mbuf *m;
+	struct ipv6_hdr *ip;
+	struct ipv6_extension_fragment *fh;
+	uint16_t ofs;
+
+	m = rte_pktmbuf_alloc(frag_pool);
+	if (m == NULL)
+		return NULL;
+
+	ip = (struct ipv6_hdr *)rte_pktmbuf_append(m,
+		sizeof(*ip) + sizeof(*fh) + FRAG_PAYLOAD);
+	if (ip == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	fh = (struct ipv6_extension_fragment *)(ip + 1);
+	memset(ip, 0, sizeof(*ip) + sizeof(*fh));
+	ip->vtc_flow = rte_cpu_to_be_32(6 << 28);
+	ip->payload_len = rte_cpu_to_be_16(sizeof(*fh) + FRAG_PAYLOAD);
+	ip->proto = IPPROTO_FRAGMENT;
+	ip->hop_limits = 64;
+	memcpy(ip->src_addr, &f->src, sizeof(f->src));
+	ip->dst_addr[15] = 2;
+
+	ofs = (uint16_t)(f->idx * FRAG_PAYLOAD / 8) << 3;
+	if (f->idx != FRAG_PER_PKT - 1)
+		ofs |= 1;
+	fh->next_header = IPPROTO_UDP;
+	fh->frag_data = rte_cpu_to_be_16(ofs);
+	fh->id = rte_cpu_to_be_32(f->id);
+
+	m->l2_len = 0;
+	m->l3_len = sizeof(*ip) + sizeof(*fh);
+	return m;
+}
+
+/* feed the current fragment stream through a new table. */
+static int
+frag_run(const char *scenario, int ipv6, int bulk, uint32_t max_mbufs,
+	uint32_t admit_mbufs, uint32_t expect)
+{
+	struct rte_ip_frag_tbl *tbl;
+	struct rte_mbuf *in[BURST], *out[BURST];
+	struct rte_mbuf *m;
+	struct ipv6_hdr *ip6;
+	uint64_t tms, start, cycles;
+	uint32_t i, j, k, n, peak, done, pkt_len;
+	int ret;
+
+	tbl = rte_ip_frag_table_create(TBL_ENTRIES / BUCKET_ENTRIES,
+		BUCKET_ENTRIES, TBL_ENTRIES, TTL_BURSTS * TMS_STEP,
+		rte_socket_id());
+	if (tbl == NULL) {
+		printf("%s: cannot create fragmentation table\n", __func__);
+		return -1;
+	}
+	if (rte_ip_frag_table_set_mbuf_limit(tbl, max_mbufs,
+			admit_mbufs) != 0) {
+		printf("%s: cannot set mbuf limit\n", __func__);
+		rte_ip_frag_table_destroy(tbl);
+		return -1;
+	}
+
+	pkt_len = (ipv6 ? sizeof(struct ipv6_hdr) : sizeof(struct ipv4_hdr)) +
+		FRAG_PER_PKT * FRAG_PAYLOAD;
+	tms = 0;
+	cycles = 0;
+	peak = 0;
+	done = 0;
+	ret = 0;
+
+	for (i = 0; i < nb_frags; i += n) {
+
+		n = RTE_MIN(nb_frags - i, (uint32_t)BURST);
+		for (j = 0; j != n; j++) {
+			in[j] = ipv6 ? build_ipv6_frag(frags + i + j) :
+				build_ipv4_frag(frags + i + j);
+			if (in[j] == NULL) {
+				printf("%s: cannot build packet\n", __func__);
+				while (j != 0)
+					rte_pktmbuf_free(in[--j]);
+				rte_ip_frag_table_destroy(tbl);
+				return -1;
+			}
+		}
+		tms += TMS_STEP;
+
+		start = rte_rdtsc();
+		if (bulk != 0) {
+			k = ipv6 ? rte_ipv6_frag_reassemble_bulk(tbl,
+					&death_row, in, n, tms, out) :
+				rte_ipv4_frag_reassemble_bulk(tbl,
+					&death_row, in, n, tms, out);
+		} else {
+			for (j = 0, k = 0; j != n; j++) {
+				m = in[j];
+				if (ipv6) {
+					ip6 = rte_pktmbuf_mtod(m,
+						struct ipv6_hdr *);
+					m = rte_ipv6_frag_reassemble_packet(tbl,
+						&death_row, m, tms, ip6,
+						rte_ipv6_frag_get_ipv6_fragment_header(
+							ip6));
+				} else
+					m = rte_ipv4_frag_reassemble_packet(tbl,
+						&death_row, m, tms,
+						rte_pktmbuf_mtod(m,
+							struct ipv4_hdr *));
+				if (m != NULL)
+					out[k++] = m;
+			}
+		}
+		rte_ip_frag_free_death_row(&death_row, PREFETCH_OFFSET);
+		cycles += rte_rdtsc() - start;
+
+		peak = RTE_MAX(peak, tbl->nb_mbufs);
+		for (j = 0; j != k; j++) {
+			if (out[j]->pkt_len != pkt_len) {
+				printf("%s: invalid reassembled packet length "
+					"%u, expected %u\n", __func__,
+					out[j]->pkt_len, pkt_len);
+				ret = -1;
+			}
+			rte_pktmbuf_free(out[j]);
+		}
+		done += k;
+	}
+
+	/* let everything left in the table expire. */
+	for (i = 0; tbl->use_entries != 0 && i != TBL_ENTRIES; i++) {
+		tms += 2 * TTL_BURSTS * TMS_STEP;
+		if (ipv6)
+			rte_ipv6_frag_reassemble_bulk(tbl, &death_row, in, 0,
+				tms, out);
+		else
+			rte_ipv4_frag_reassemble_bulk(tbl, &death_row, in, 0,
+				tms, out);
+		rte_ip_frag_free_death_row(&death_row, PREFETCH_OFFSET);
+	}
+
+	printf("%-8s %-4s %-6s %-9s %12.1f %11u %10u\n", scenario,
+		ipv6 ? "ipv6" : "ipv4", bulk ? "bulk" : "single",
+		max_mbufs != 0 ? "limited" : "unlimited",
+		(double)cycles / nb_frags, done, peak);
+
+	if (expect != 0 && done != expect) {
+		printf("%s: %u packets reassembled, expected %u\n",
+			__func__, done, expect);
+		ret = -1;
+	}
+	if (max_mbufs != 0 && peak > max_mbufs) {
+		printf("%s: table held %u mbufs, limit %u\n",
+			__func__, peak, max_mbufs);
+		ret = -1;
+	}
+	if (tbl->use_entries != 0 || tbl->nb_mbufs != 0 ||
+			rte_mempool_count(frag_pool) != NB_MBUF) {
+		printf("%s: %u entries, %u mbufs left in the table, "
+			"%u mbufs left in the pool\n", __func__,
+			tbl->use_entries, tbl->nb_mbufs,
+			rte_mempool_count(frag_pool));
+		ret = -1;
+	}
+
+	rte_ip_frag_table_destroy(tbl);
+	return ret;
+}
+
+/* build a multi-segment packet of JUMBO_PKT_SIZE bytes with known payload */
+static struct rte_mbuf *
+build_jumbo(int ipv6, uint16_t id)
+{
+	struct rte_mbuf *m, *seg, *last;
+	struct ipv4_hdr *ip4;
+	struct ipv6_hdr *ip6;
+	uint32_t hlen, i, n, ofs;
+	uint8_t *p;
+
+	m = NULL;
+	last = NULL;
+	for (ofs = 0; ofs != JUMBO_PKT_SIZE; ofs += n) {
+		seg = rte_pktmbuf_alloc(jumbo_pool);
+		if (seg == NULL) {
+			rte_pktmbuf_free(m);
+			return NULL;
+		}
+		n = RTE_MIN(JUMBO_PKT_SIZE - ofs, (uint32_t)JUMBO_SEG_SIZE);
+		p = (uint8_t *)rte_pktmbuf_append(seg, n);
+		if (p == NULL) {
+			rte_pktmbuf_free(seg);
+			rte_pktmbuf_free(m);
+			return NULL;
+		}
+		for (i = 0; i != n; i++)
+			p[i] = (uint8_t)(ofs + i);
+		if (m == NULL) {
+			m = seg;
+		} else {
+			last->next = seg;
+			m->nb_segs++;
+			m->pkt_len += n;
+		}
+		last = seg;
+	}
+
+	if (ipv6) {
+		hlen = sizeof(*ip6);
+		ip6 = rte_pktmbuf_mtod(m, struct ipv6_hdr *);
+		memset(ip6, 0, hlen);
+		ip6->vtc_flow = rte_cpu_to_be_32(6 << 28);
+		ip6->payload_len = rte_cpu_to_be_16(JUMBO_PKT_SIZE - hlen);
+		ip6->proto = IPPROTO_UDP;
+		ip6->hop_limits = 64;
+		ip6->src_addr[15] = 1;
+		ip6->dst_addr[15] = 2;
+	} else {
+		hlen = sizeof(*ip4);
+		ip4 = rte_pktmbuf_mtod(m, struct ipv4_hdr *);
+		memset(ip4, 0, hlen);
+		ip4->version_ihl = 0x45;
+		ip4->time_to_live = 64;
+		ip4->next_proto_id = IPPROTO_UDP;
+		ip4->total_length = rte_cpu_to_be_16(JUMBO_PKT_SIZE);
+		ip4->packet_id = rte_cpu_to_be_16(id);
+		ip4->src_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 1));
+		ip4->dst_addr = rte_cpu_to_be_32(IPv4(10, 0, 0, 2));
+		ip4->hdr_checksum = rte_ipv4_cksum(ip4);
+	}
+	m->l3_len = hlen;
+	return m;
+}
+
+/* check headers and payload of the fragments of one input packet */
+static int
+check_fragments(int ipv6, uint32_t flags, struct rte_mbuf **out, uint32_t n)
+{
+	struct ipv4_hdr *ip4;
+	struct ipv6_hdr *ip6;
+	struct ipv6_extension_fragment *fh;
+	struct rte_mbuf *seg;
+	uint32_t i, j, hlen, ofs, len, mf, fofs;
+	uint16_t cksum;
+	const uint8_t *p;
+
+	hlen = ipv6 ? sizeof(*ip6) : sizeof(*ip4);
+	ofs = 0;
+	for (i = 0; i != n; i++) {
+
+		if (out[i]->pkt_len > JUMBO_MTU) {
+			printf("fragment %u: length %u exceeds MTU\n",
+				i, out[i]->pkt_len);
+			return -1;
+		}
+
+		if (ipv6) {
+			ip6 = rte_pktmbuf_mtod(out[i], struct ipv6_hdr *);
+			fh = rte_ipv6_frag_get_ipv6_fragment_header(ip6);
+			if (fh == NULL || fh->next_header != IPPROTO_UDP) {
+				printf("fragment %u: invalid fragment header\n",
+					i);
+				return -1;
+			}
+			fofs = rte_be_to_cpu_16(fh->frag_data) & ~7;
+			mf = rte_be_to_cpu_16(fh->frag_data) & 1;
+			len = rte_be_to_cpu_16(ip6->payload_len) -
+				sizeof(*fh);
+			hlen = sizeof(*ip6) + sizeof(*fh);
+		} else {
+			ip4 = rte_pktmbuf_mtod(out[i], struct ipv4_hdr *);
+			fofs = rte_be_to_cpu_16(ip4->fragment_offset);
+			mf = (fofs & IPV4_HDR_MF_FLAG) != 0;
+			fofs = (fofs & IPV4_HDR_OFFSET_MASK) *
+				IPV4_HDR_OFFSET_UNITS;
+			len = rte_be_to_cpu_16(ip4->total_length) - hlen;
+			if ((flags & RTE_IP_FRAG_F_HW_CKSUM) == 0) {
+				cksum = ip4->hdr_checksum;
+				ip4->hdr_checksum = 0;
+				if (rte_ipv4_cksum(ip4) != cksum) {
+					printf("fragment %u: invalid checksum "
+						"%#x\n", i, cksum);
+					return -1;
+				}
+				ip4->hdr_checksum = cksum;
+			} else if ((out[i]->ol_flags &
+					PKT_TX_IP_CKSUM) == 0) {
+				printf("fragment %u: checksum offload is not "
+					"requested\n", i);
+				return -1;
+			}
+		}
+
+		if (fofs != ofs || mf != (i + 1 != n) ||
+				len + hlen != out[i]->pkt_len) {
+			printf("fragment %u: offset %u, expected %u, MF %u, "
+				"length %u, packet length %u\n",
+				i, fofs, ofs, mf, len, out[i]->pkt_len);
+			return -1;
+		}
+
+		/* payload starts right after the header of the input packet */
+		j = ofs + (ipv6 ? sizeof(*ip6) : sizeof(*ip4));
+		for (seg = out[i]->next; seg != NULL; seg = seg->next) {
+			p = rte_pktmbuf_mtod(seg, const uint8_t *);
+			for (len = 0; len != seg->data_len; len++, j++) {
+				if (p[len] != (uint8_t)j) {
+					printf("fragment %u: invalid payload "
+						"at %u\n", i, j);
+					return -1;
+				}
+			}
+		}
+		ofs = j - (ipv6 ? sizeof(*ip6) : sizeof(*ip4));
+	}
+
+	if (ofs + (ipv6 ? sizeof(*ip6) : sizeof(*ip4)) != JUMBO_PKT_SIZE) {
+		printf("fragments carry %u bytes of payload\n", ofs);
+		return -1;
+	}
+	return 0;
+}
+
+/* fragment bursts of jumbo packets, as a tunnel endpoint would do */
+static int
+fragment_run(int ipv6, int bulk, uint32_t flags)
+{
+	struct rte_mbuf *in[BURST], *out[JUMBO_MAX_FRAGS];
+	uint64_t start, cycles;
+	uint32_t i, j, k, n, nb_out;
+	uint16_t nb;
+	int32_t ret;
+
+	cycles = 0;
+	nb_out = 0;
+	for (i = 0; i != JUMBO_ITER; i++) {
+
+		for (j = 0; j != BURST; j++) {
+			in[j] = build_jumbo(ipv6, (uint16_t)j);
+			if (in[j] == NULL) {
+				printf("%s: cannot build packet\n", __func__);
+				while (j != 0)
+					rte_pktmbuf_free(in[--j]);
+				return -1;
+			}
+		}
+
+		k = 0;
+		ret = 0;
+		start = rte_rdtsc();
+		if (bulk) {
+			nb = RTE_DIM(out);
+			n = ipv6 ? rte_ipv6_fragment_bulk(in, BURST, out, &nb,
+					JUMBO_MTU, frag_pool, ind_pool) :
+				rte_ipv4_fragment_bulk(in, BURST, out, &nb,
+					JUMBO_MTU, frag_pool, ind_pool, flags);
+			k = nb;
+			if (n != BURST)
+				ret = -rte_errno;
+		} else {
+			for (j = 0; j != BURST && ret >= 0; j++) {
+				ret = ipv6 ? rte_ipv6_fragment_packet(in[j],
+						out + k, RTE_DIM(out) - k,
+						JUMBO_MTU, frag_pool, ind_pool) :
+					rte_ipv4_fragment_packet(in[j],
+						out + k, RTE_DIM(out) - k,
+						JUMBO_MTU, frag_pool, ind_pool);
+				if (ret >= 0) {
+					rte_pktmbuf_free(in[j]);
+					k += ret;
+				}
+			}
+			n = j - (ret < 0);
+		}
+		cycles += rte_rdtsc() - start;
+
+		for (j = n; j != BURST; j++)
+			rte_pktmbuf_free(in[j]);
+
+		/* fragments of each packet go one after another */
+		if (ret >= 0 && i == 0) {
+			for (j = 0; j != BURST && ret == 0; j++)
+				ret = check_fragments(ipv6, flags,
+					out + j * (k / BURST), k / BURST);
+		}
+
+		for (j = 0; j != k; j++)
+			rte_pktmbuf_free(out[j]);
+		nb_out += k;
+
+		if (ret < 0) {
+			printf("%s: fragmentation failed: %d\n",
+				__func__, ret);
+			return -1;
+		}
+	}
+
+	printf("%-8s %-4s %-6s %-9s %12.1f %11u\n", "fragment",
+		ipv6 ? "ipv6" : "ipv4", bulk ? "bulk" : "single",
+		ipv6 ? "-" : ((flags & RTE_IP_FRAG_F_HW_CKSUM) ? "hw" : "sw"),
+		(double)cycles / (JUMBO_ITER * BURST), nb_out);
+
+	if (rte_mempool_count(frag_pool) != NB_MBUF ||
+			rte_mempool_count(ind_pool) != IND_NB_MBUF ||
+			rte_mempool_count(jumbo_pool) != JUMBO_NB_MBUF) {
+		printf("%s: mbufs leaked\n", __func__);
+		return -1;
+	}
+	return 0;
+}
+
+static int
+test_ip_frag_perf(void)
+{
+	int ret;
+
+	if (frag_pool == NULL) {
+		frag_pool = rte_pktmbuf_pool_create("IP_FRAG_PERF_POOL",
+			NB_MBUF, BURST, 0, MBUF_DATA_SIZE, rte_socket_id());
+		if (frag_pool == NULL) {
+			printf("%s: cannot create mbuf pool\n", __func__);
+			return -1;
+		}
+	}
+
+	if (jumbo_pool == NULL) {
+		jumbo_pool = rte_pktmbuf_pool_create("IP_FRAG_PERF_JUMBO",
+			JUMBO_NB_MBUF, BURST, 0,
+			RTE_PKTMBUF_HEADROOM + JUMBO_SEG_SIZE, rte_socket_id());
+		ind_pool = rte_pktmbuf_pool_create("IP_FRAG_PERF_IND",
+			IND_NB_MBUF, BURST, 0, 0, rte_socket_id());
+		if (jumbo_pool == NULL || ind_pool == NULL) {
+			printf("%s: cannot create mbuf pool\n", __func__);
+			return -1;
+		}
+	}
+
+	printf("%-8s %-4s %-6s %-9s %12s %11s %10s\n", "scenario", "af",
+		"api", "mbufs", "cycles/frag", "reassembled", "peak mbufs");
+
+	ret = 0;
+
+	gen_reorder_stream();
+	ret |= frag_run("reorder", 0, 0, 0, 0, REORDER_PKTS);
+	ret |= frag_run("reorder", 0, 1, 0, 0, REORDER_PKTS);
+	ret |= frag_run("reorder", 1, 0, 0, 0, REORDER_PKTS);
+	ret |= frag_run("reorder", 1, 1, 0, 0, REORDER_PKTS);
+
+	gen_flood_stream();
+	ret |= frag_run("flood", 0, 0, 0, 0, 0);
+	ret |= frag_run("flood", 0, 1, 0, 0, 0);
+	ret |= frag_run("flood", 0, 0, FLOOD_MAX_MBUFS, FLOOD_ADMIT_MBUFS, 0);
+	ret |= frag_run("flood", 0, 1, FLOOD_MAX_MBUFS, FLOOD_ADMIT_MBUFS, 0);
+
+	printf("\n%-8s %-4s %-6s %-9s %12s %11s\n", "scenario", "af",
+		"api", "cksum", "cycles/pkt", "fragments");
+	ret |= fragment_run(0, 0, RTE_IP_FRAG_F_HW_CKSUM);
+	ret |= fragment_run(0, 1, RTE_IP_FRAG_F_HW_CKSUM);
+	ret |= fragment_run(0, 1, 0);
+	ret |= fragment_run(1, 0, 0);
+	ret |= fragment_run(1, 1, 0);
+
+	return ret;
+}
+
+static struct test_command ip_frag_perf_cmd = {
+	.command = "ip_frag_perf_autotest",
+	.callback = test_ip_frag_perf,
+};
+REGISTER_TEST_COMMAND(ip_frag_perf_cmd);
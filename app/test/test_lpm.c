@@ -33,7 +33,9 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 #include <sys/queue.h>
 
@@ -43,7 +45,12 @@
 #include <rte_random.h>
 #include <rte_branch_prediction.h>
 #include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_atomic.h>
+#include <rte_errno.h>
 #include <time.h>
+#include <sched.h>
 
 #include "test.h"
 
@@ -77,6 +84,8 @@ static int32_t test14(void);
 static int32_t test15(void);
 static int32_t test16(void);
 static int32_t test17(void);
+static int32_t test18(void);
+static int32_t test19(void);
 static int32_t perf_test(void);
 
 rte_lpm_test tests[] = {
@@ -99,14 +108,20 @@ rte_lpm_test tests[] = {
 	test15,
 	test16,
 	test17,
+	test18,
+	test19,
 	perf_test,
 };
 
 #define NUM_LPM_TESTS (sizeof(tests)/sizeof(tests[0]))
 #define MAX_DEPTH 32
 #define MAX_RULES 256
+#define NUMBER_TBL8S 256
 #define PASS 0
 
+/* Configuration of the tables created by the tests, reset before each test. */
+static struct rte_lpm_config config;
+
 /*
  * Check that rte_lpm_create fails gracefully for incorrect user input
  * arguments
@@ -117,16 +132,33 @@ test0(void)
 	struct rte_lpm *lpm = NULL;
 
 	/* rte_lpm_create: lpm name == NULL */
-	lpm = rte_lpm_create(NULL, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(NULL, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm == NULL);
+
+	/* rte_lpm_create: config == NULL */
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, NULL);
 	TEST_LPM_ASSERT(lpm == NULL);
 
 	/* rte_lpm_create: max_rules = 0 */
 	/* Note: __func__ inserts the function name, in this case "test0". */
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, 0, 0);
+	config.max_rules = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm == NULL);
+	config.max_rules = MAX_RULES;
+
+	/* rte_lpm_create: number_tbl8s = 0 */
+	config.number_tbl8s = 0;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm == NULL);
 
+	/* rte_lpm_create: number_tbl8s too large to be indexed */
+	config.number_tbl8s = RTE_LPM_MAX_TBL8_NUM_GROUPS + 1;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm == NULL);
+	config.number_tbl8s = NUMBER_TBL8S;
+
 	/* socket_id < -1 is invalid */
-	lpm = rte_lpm_create(__func__, -2, MAX_RULES, 0);
+	lpm = rte_lpm_create(__func__, -2, &config);
 	TEST_LPM_ASSERT(lpm == NULL);
 
 	return PASS;
@@ -144,7 +176,8 @@ test1(void)
 
 	/* rte_lpm_free: Free NULL */
 	for (i = 0; i < 100; i++) {
-		lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES - i, 0);
+		config.max_rules = MAX_RULES - i;
+		lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 		TEST_LPM_ASSERT(lpm != NULL);
 
 		rte_lpm_free(lpm);
@@ -165,7 +198,7 @@ test2(void)
 {
 	struct rte_lpm *lpm = NULL;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, RTE_LPM_HEAP);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	rte_lpm_free(lpm);
@@ -181,7 +214,8 @@ test3(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t depth = 24, next_hop = 100;
+	uint32_t next_hop = 100;
+	uint8_t depth = 24;
 	int32_t status = 0;
 
 	/* rte_lpm_add: lpm == NULL */
@@ -189,7 +223,7 @@ test3(void)
 	TEST_LPM_ASSERT(status < 0);
 
 	/*Create vaild lpm to use in rest of test. */
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* rte_lpm_add: depth < 1 */
@@ -200,6 +234,10 @@ test3(void)
 	status = rte_lpm_add(lpm, ip, (MAX_DEPTH + 1), next_hop);
 	TEST_LPM_ASSERT(status < 0);
 
+	/* rte_lpm_add: next_hop > RTE_LPM_MAX_NEXT_HOP */
+	status = rte_lpm_add(lpm, ip, depth, RTE_LPM_MAX_NEXT_HOP + 1);
+	TEST_LPM_ASSERT(status < 0);
+
 	rte_lpm_free(lpm);
 
 	return PASS;
@@ -222,7 +260,7 @@ test4(void)
 	TEST_LPM_ASSERT(status < 0);
 
 	/*Create vaild lpm to use in rest of test. */
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* rte_lpm_delete: depth < 1 */
@@ -248,7 +286,7 @@ test5(void)
 #if defined(RTE_LIBRTE_LPM_DEBUG)
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t next_hop_return = 0;
+	uint32_t next_hop_return = 0;
 	int32_t status = 0;
 
 	/* rte_lpm_lookup: lpm == NULL */
@@ -256,7 +294,7 @@ test5(void)
 	TEST_LPM_ASSERT(status < 0);
 
 	/*Create vaild lpm to use in rest of test. */
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* rte_lpm_lookup: depth < 1 */
@@ -278,10 +316,11 @@ test6(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t depth = 24, next_hop_add = 100, next_hop_return = 0;
+	uint32_t next_hop_add = 100, next_hop_return = 0;
+	uint8_t depth = 24;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	status = rte_lpm_add(lpm, ip, depth, next_hop_add);
@@ -309,13 +348,14 @@ int32_t
 test7(void)
 {
 	__m128i ipx4;
-	uint16_t hop[4];
+	uint32_t hop[4];
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip = IPv4(0, 0, 0, 0);
-	uint8_t depth = 32, next_hop_add = 100, next_hop_return = 0;
+	uint32_t next_hop_add = 100, next_hop_return = 0;
+	uint8_t depth = 32;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	status = rte_lpm_add(lpm, ip, depth, next_hop_add);
@@ -325,10 +365,10 @@ test7(void)
 	TEST_LPM_ASSERT((status == 0) && (next_hop_return == next_hop_add));
 
 	ipx4 = _mm_set_epi32(ip, ip + 0x100, ip - 0x100, ip);
-	rte_lpm_lookupx4(lpm, ipx4, hop, UINT16_MAX);
+	rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
 	TEST_LPM_ASSERT(hop[0] == next_hop_add);
-	TEST_LPM_ASSERT(hop[1] == UINT16_MAX);
-	TEST_LPM_ASSERT(hop[2] == UINT16_MAX);
+	TEST_LPM_ASSERT(hop[1] == UINT32_MAX);
+	TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
 	TEST_LPM_ASSERT(hop[3] == next_hop_add);
 
 	status = rte_lpm_delete(lpm, ip, depth);
@@ -355,13 +395,14 @@ int32_t
 test8(void)
 {
 	__m128i ipx4;
-	uint16_t hop[4];
+	uint32_t hop[4];
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip1 = IPv4(127, 255, 255, 255), ip2 = IPv4(128, 0, 0, 0);
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* Loop with rte_lpm_add. */
@@ -381,16 +422,16 @@ test8(void)
 			(next_hop_return == next_hop_add));
 
 		ipx4 = _mm_set_epi32(ip2, ip1, ip2, ip1);
-		rte_lpm_lookupx4(lpm, ipx4, hop, UINT16_MAX);
-		TEST_LPM_ASSERT(hop[0] == UINT16_MAX);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
+		TEST_LPM_ASSERT(hop[0] == UINT32_MAX);
 		TEST_LPM_ASSERT(hop[1] == next_hop_add);
-		TEST_LPM_ASSERT(hop[2] == UINT16_MAX);
+		TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
 		TEST_LPM_ASSERT(hop[3] == next_hop_add);
 	}
 
 	/* Loop with rte_lpm_delete. */
 	for (depth = 32; depth >= 1; depth--) {
-		next_hop_add = (uint8_t) (depth - 1);
+		next_hop_add = (uint32_t) (depth - 1);
 
 		status = rte_lpm_delete(lpm, ip2, depth);
 		TEST_LPM_ASSERT(status == 0);
@@ -409,16 +450,16 @@ test8(void)
 		TEST_LPM_ASSERT(status == -ENOENT);
 
 		ipx4 = _mm_set_epi32(ip1, ip1, ip2, ip2);
-		rte_lpm_lookupx4(lpm, ipx4, hop, UINT16_MAX);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
 		if (depth != 1) {
 			TEST_LPM_ASSERT(hop[0] == next_hop_add);
 			TEST_LPM_ASSERT(hop[1] == next_hop_add);
 		} else {
-			TEST_LPM_ASSERT(hop[0] == UINT16_MAX);
-			TEST_LPM_ASSERT(hop[1] == UINT16_MAX);
+			TEST_LPM_ASSERT(hop[0] == UINT32_MAX);
+			TEST_LPM_ASSERT(hop[1] == UINT32_MAX);
 		}
-		TEST_LPM_ASSERT(hop[2] == UINT16_MAX);
-		TEST_LPM_ASSERT(hop[3] == UINT16_MAX);
+		TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
+		TEST_LPM_ASSERT(hop[3] == UINT32_MAX);
 	}
 
 	rte_lpm_free(lpm);
@@ -438,8 +479,8 @@ test9(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip, ip_1, ip_2;
-	uint8_t depth, depth_1, depth_2, next_hop_add, next_hop_add_1,
-		next_hop_add_2, next_hop_return;
+	uint32_t next_hop_add, next_hop_add_1, next_hop_add_2, next_hop_return;
+	uint8_t depth, depth_1, depth_2;
 	int32_t status = 0;
 
 	/* Add & lookup to hit invalid TBL24 entry */
@@ -447,7 +488,7 @@ test9(void)
 	depth = 24;
 	next_hop_add = 100;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	status = rte_lpm_add(lpm, ip, depth, next_hop_add);
@@ -602,12 +643,13 @@ test10(void)
 
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
 	/* Add rule that covers a TBL24 range previously invalid & lookup
 	 * (& delete & lookup) */
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, RTE_LPM_HEAP);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	ip = IPv4(128, 0, 0, 0);
@@ -788,10 +830,11 @@ test11(void)
 
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	ip = IPv4(128, 0, 0, 0);
@@ -851,13 +894,14 @@ int32_t
 test12(void)
 {
 	__m128i ipx4;
-	uint16_t hop[4];
+	uint32_t hop[4];
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip, i;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	ip = IPv4(128, 0, 0, 0);
@@ -873,10 +917,10 @@ test12(void)
 				(next_hop_return == next_hop_add));
 
 		ipx4 = _mm_set_epi32(ip, ip + 1, ip, ip - 1);
-		rte_lpm_lookupx4(lpm, ipx4, hop, UINT16_MAX);
-		TEST_LPM_ASSERT(hop[0] == UINT16_MAX);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
+		TEST_LPM_ASSERT(hop[0] == UINT32_MAX);
 		TEST_LPM_ASSERT(hop[1] == next_hop_add);
-		TEST_LPM_ASSERT(hop[2] == UINT16_MAX);
+		TEST_LPM_ASSERT(hop[2] == UINT32_MAX);
 		TEST_LPM_ASSERT(hop[3] == next_hop_add);
 
 		status = rte_lpm_delete(lpm, ip, depth);
@@ -904,10 +948,11 @@ test13(void)
 {
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip, i;
-	uint8_t depth, next_hop_add_1, next_hop_add_2, next_hop_return;
+	uint32_t next_hop_add_1, next_hop_add_2, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	ip = IPv4(128, 0, 0, 0);
@@ -966,11 +1011,13 @@ test14(void)
 
 	struct rte_lpm *lpm = NULL;
 	uint32_t ip;
-	uint8_t depth, next_hop_add, next_hop_return;
+	uint32_t next_hop_add, next_hop_return;
+	uint8_t depth;
 	int32_t status = 0;
 
 	/* Add enough space for 256 rules for every depth */
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, 256 * 32, 0);
+	config.max_rules = 256 * 32;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	depth = 32;
@@ -1014,7 +1061,8 @@ test15(void)
 	struct rte_lpm *lpm = NULL, *result = NULL;
 
 	/* Create lpm  */
-	lpm = rte_lpm_create("lpm_find_existing", SOCKET_ID_ANY, 256 * 32, 0);
+	config.max_rules = 256 * 32;
+	lpm = rte_lpm_create("lpm_find_existing", SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* Try to find existing lpm */
@@ -1034,14 +1082,20 @@ test15(void)
 
 /*
  * test failure condition of overloading the tbl8 so no more will fit
- * Check we get an error return value in that case
+ * Check we get an error return value in that case. The table is created
+ * with more tbl8 groups than the 256 of the 2.0 API to check that the
+ * configured number is the one enforced.
  */
 int32_t
 test16(void)
 {
 	uint32_t ip;
-	struct rte_lpm *lpm = rte_lpm_create(__func__, SOCKET_ID_ANY,
-			256 * 32, 0);
+	struct rte_lpm *lpm;
+
+	config.max_rules = 256 * 32;
+	config.number_tbl8s = 2048;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* ip loops through all possibilities for top 24 bits of address */
 	for (ip = 0; ip < 0xFFFFFF; ip++){
@@ -1051,14 +1105,16 @@ test16(void)
 			break;
 	}
 
-	if (ip != RTE_LPM_TBL8_NUM_GROUPS) {
+	rte_lpm_free(lpm);
+
+	if (ip != config.number_tbl8s) {
 		printf("Error, unexpected failure with filling tbl8 groups\n");
 		printf("Failed after %u additions, expected after %u\n",
-				(unsigned)ip, (unsigned)RTE_LPM_TBL8_NUM_GROUPS);
+				(unsigned)ip, (unsigned)config.number_tbl8s);
+		return -1;
 	}
 
-	rte_lpm_free(lpm);
-	return 0;
+	return PASS;
 }
 
 /*
@@ -1078,13 +1134,13 @@ test17(void)
 	const uint8_t d_ip_10_32 = 32,
 			d_ip_10_24 = 24,
 			d_ip_20_25 = 25;
-	const uint8_t next_hop_ip_10_32 = 100,
+	const uint32_t next_hop_ip_10_32 = 100,
 			next_hop_ip_10_24 = 105,
 			next_hop_ip_20_25 = 111;
-	uint8_t next_hop_return = 0;
+	uint32_t next_hop_return = 0;
 	int32_t status = 0;
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, MAX_RULES, 0);
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	if ((status = rte_lpm_add(lpm, ip_10_32, d_ip_10_32,
@@ -1092,7 +1148,7 @@ test17(void)
 		return -1;
 
 	status = rte_lpm_lookup(lpm, ip_10_32, &next_hop_return);
-	uint8_t test_hop_10_32 = next_hop_return;
+	uint32_t test_hop_10_32 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_10_32);
 
@@ -1101,7 +1157,7 @@ test17(void)
 			return -1;
 
 	status = rte_lpm_lookup(lpm, ip_10_24, &next_hop_return);
-	uint8_t test_hop_10_24 = next_hop_return;
+	uint32_t test_hop_10_24 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_10_24);
 
@@ -1110,7 +1166,7 @@ test17(void)
 		return -1;
 
 	status = rte_lpm_lookup(lpm, ip_20_25, &next_hop_return);
-	uint8_t test_hop_20_25 = next_hop_return;
+	uint32_t test_hop_20_25 = next_hop_return;
 	TEST_LPM_ASSERT(status == 0);
 	TEST_LPM_ASSERT(next_hop_return == next_hop_ip_20_25);
 
@@ -1137,6 +1193,146 @@ test17(void)
 	return PASS;
 }
 
+/*
+ * Check next hops wider than 8 bits and tbl8 group indexes above 255:
+ *  - add /32 rules in 512 different tbl8 groups with next hops near the
+ *    24-bit limit, and /24 rules with next hops above 16 bits
+ *  - lookup every rule with the single, bulk and x4 lookup functions
+ *  - delete all the rules and check that every lookup misses
+ */
+int32_t
+test18(void)
+{
+	__m128i ipx4;
+	uint32_t hop[4], ips[4];
+	struct rte_lpm *lpm = NULL;
+	uint32_t ip_32, ip_24, i;
+	uint32_t next_hop_32, next_hop_24, next_hop_return;
+	int32_t status = 0;
+
+	config.max_rules = 1024;
+	config.number_tbl8s = 1024;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	for (i = 0; i < 512; i++) {
+		ip_32 = IPv4(10, i >> 8, i & 0xFF, 1);
+		ip_24 = IPv4(20, i >> 8, i & 0xFF, 0);
+		next_hop_32 = RTE_LPM_MAX_NEXT_HOP - i;
+		next_hop_24 = 0x10000 + i;
+
+		status = rte_lpm_add(lpm, ip_32, 32, next_hop_32);
+		TEST_LPM_ASSERT(status == 0);
+		status = rte_lpm_add(lpm, ip_24, 24, next_hop_24);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	for (i = 0; i < 512; i++) {
+		ip_32 = IPv4(10, i >> 8, i & 0xFF, 1);
+		ip_24 = IPv4(20, i >> 8, i & 0xFF, 0);
+		next_hop_32 = RTE_LPM_MAX_NEXT_HOP - i;
+		next_hop_24 = 0x10000 + i;
+
+		status = rte_lpm_lookup(lpm, ip_32, &next_hop_return);
+		TEST_LPM_ASSERT((status == 0) &&
+				(next_hop_return == next_hop_32));
+		status = rte_lpm_lookup(lpm, ip_24 + 0xFF, &next_hop_return);
+		TEST_LPM_ASSERT((status == 0) &&
+				(next_hop_return == next_hop_24));
+
+		status = rte_lpm_is_rule_present(lpm, ip_32, 32,
+				&next_hop_return);
+		TEST_LPM_ASSERT((status == 1) &&
+				(next_hop_return == next_hop_32));
+
+		ips[0] = ip_32;
+		ips[1] = ip_32 + 1;
+		ips[2] = ip_24;
+		ips[3] = ip_24 + 0x100 * 512;
+		rte_lpm_lookup_bulk(lpm, ips, hop, 4);
+		TEST_LPM_ASSERT((hop[0] & RTE_LPM_LOOKUP_SUCCESS) &&
+				(hop[0] & RTE_LPM_MAX_NEXT_HOP) == next_hop_32);
+		TEST_LPM_ASSERT(!(hop[1] & RTE_LPM_LOOKUP_SUCCESS));
+		TEST_LPM_ASSERT((hop[2] & RTE_LPM_LOOKUP_SUCCESS) &&
+				(hop[2] & RTE_LPM_MAX_NEXT_HOP) == next_hop_24);
+		TEST_LPM_ASSERT(!(hop[3] & RTE_LPM_LOOKUP_SUCCESS));
+
+		ipx4 = _mm_set_epi32(ips[3], ips[2], ips[1], ips[0]);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
+		TEST_LPM_ASSERT(hop[0] == next_hop_32);
+		TEST_LPM_ASSERT(hop[1] == UINT32_MAX);
+		TEST_LPM_ASSERT(hop[2] == next_hop_24);
+		TEST_LPM_ASSERT(hop[3] == UINT32_MAX);
+
+		/* All four lookups hit, i.e. the x4 fast path. */
+		ipx4 = _mm_set_epi32(ip_24, ip_24 + 1, ip_24 + 2, ip_24 + 3);
+		rte_lpm_lookupx4(lpm, ipx4, hop, UINT32_MAX);
+		TEST_LPM_ASSERT(hop[0] == next_hop_24);
+		TEST_LPM_ASSERT(hop[1] == next_hop_24);
+		TEST_LPM_ASSERT(hop[2] == next_hop_24);
+		TEST_LPM_ASSERT(hop[3] == next_hop_24);
+	}
+
+	for (i = 0; i < 512; i++) {
+		ip_32 = IPv4(10, i >> 8, i & 0xFF, 1);
+		ip_24 = IPv4(20, i >> 8, i & 0xFF, 0);
+
+		status = rte_lpm_delete(lpm, ip_32, 32);
+		TEST_LPM_ASSERT(status == 0);
+		status = rte_lpm_delete(lpm, ip_24, 24);
+		TEST_LPM_ASSERT(status == 0);
+
+		status = rte_lpm_lookup(lpm, ip_32, &next_hop_return);
+		TEST_LPM_ASSERT(status == -ENOENT);
+		status = rte_lpm_lookup(lpm, ip_24, &next_hop_return);
+		TEST_LPM_ASSERT(status == -ENOENT);
+	}
+
+	rte_lpm_free(lpm);
+
+	return PASS;
+}
+
+/*
+ * Add and delete a short rule covering a longer rule with a wide next hop:
+ * the tbl24 entries of the longer rule must be kept and their next hop must
+ * not be taken for a tbl8 group index.
+ */
+int32_t
+test19(void)
+{
+	struct rte_lpm *lpm = NULL;
+	const uint32_t ip_24 = IPv4(104, 212, 1, 0), ip_15 = IPv4(104, 212, 0, 0);
+	const uint32_t next_hop_24 = RTE_LPM_MAX_NEXT_HOP, next_hop_15 = 15;
+	uint32_t next_hop_return;
+	int32_t status = 0;
+
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	status = rte_lpm_add(lpm, ip_24, 24, next_hop_24);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm_add(lpm, ip_15, 15, next_hop_15);
+	TEST_LPM_ASSERT(status == 0);
+
+	status = rte_lpm_lookup(lpm, ip_24, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == next_hop_24));
+	status = rte_lpm_lookup(lpm, ip_15, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == next_hop_15));
+
+	status = rte_lpm_delete(lpm, ip_15, 15);
+	TEST_LPM_ASSERT(status == 0);
+
+	status = rte_lpm_lookup(lpm, ip_24, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == next_hop_24));
+	status = rte_lpm_lookup(lpm, ip_15, &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+
+	rte_lpm_free(lpm);
+
+	return PASS;
+}
+
 /*
  * Lookup performance test
  */
@@ -1145,6 +1341,9 @@ test17(void)
 #define BATCH_SIZE (1 << 12)
 #define BULK_SIZE 32
 
+/* Enough tbl8 groups for the rules longer than /24 of a full table. */
+#define FULL_TABLE_NUMBER_TBL8S (1 << 15)
+
 static void
 print_route_distribution(const struct route_rule *table, uint32_t n)
 {
@@ -1175,7 +1374,7 @@ perf_test(void)
 	struct rte_lpm *lpm = NULL;
 	uint64_t begin, total_time, lpm_used_entries = 0;
 	unsigned i, j;
-	uint8_t next_hop_add = 0xAA, next_hop_return = 0;
+	uint32_t next_hop_add = 0xAA, next_hop_return = 0;
 	int status = 0;
 	uint64_t cache_line_counter = 0;
 	int64_t count = 0;
@@ -1186,7 +1385,9 @@ perf_test(void)
 
 	print_route_distribution(large_route_table, (uint32_t) NUM_ROUTE_ENTRIES);
 
-	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, 1000000, 0);
+	config.max_rules = 1000000;
+	config.number_tbl8s = FULL_TABLE_NUMBER_TBL8S;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
 	TEST_LPM_ASSERT(lpm != NULL);
 
 	/* Measue add. */
@@ -1252,7 +1453,7 @@ perf_test(void)
 	count = 0;
 	for (i = 0; i < ITERATIONS; i ++) {
 		static uint32_t ip_batch[BATCH_SIZE];
-		uint16_t next_hops[BULK_SIZE];
+		uint32_t next_hops[BULK_SIZE];
 
 		/* Create array of random IP addresses */
 		for (j = 0; j < BATCH_SIZE; j ++)
@@ -1279,7 +1480,7 @@ perf_test(void)
 	count = 0;
 	for (i = 0; i < ITERATIONS; i++) {
 		static uint32_t ip_batch[BATCH_SIZE];
-		uint16_t next_hops[4];
+		uint32_t next_hops[4];
 
 		/* Create array of random IP addresses */
 		for (j = 0; j < BATCH_SIZE; j++)
@@ -1293,9 +1494,9 @@ perf_test(void)
 
 			ipx4 = _mm_loadu_si128((__m128i *)(ip_batch + j));
 			ipx4 = *(__m128i *)(ip_batch + j);
-			rte_lpm_lookupx4(lpm, ipx4, next_hops, UINT16_MAX);
+			rte_lpm_lookupx4(lpm, ipx4, next_hops, UINT32_MAX);
 			for (k = 0; k < RTE_DIM(next_hops); k++)
-				if (unlikely(next_hops[k] == UINT16_MAX))
+				if (unlikely(next_hops[k] == UINT32_MAX))
 					count++;
 		}
 
@@ -1326,6 +1527,458 @@ perf_test(void)
 	return PASS;
 }
 
+/*
+ * Full routing table performance test
+ *
+ * The table is generated with the prefix length distribution of a full
+ * IPv4 BGP table, plus the more specific routes found in the table of a
+ * provider edge router, each rule getting a next hop out of a 24-bit range.
+ * Lookups are done on addresses covered by the table, as on a router
+ * holding a full table, where almost no packet misses.
+ */
+
+#define FULL_TABLE_NUM_ROUTES 850000
+#define FULL_TABLE_SEED 0x1d9c7e3
+
+struct full_table_route {
+	uint32_t ip;
+	uint32_t next_hop;
+	uint8_t depth;
+};
+
+/* Share of the routes for each prefix length, in 1/100000. */
+static const uint32_t full_table_depth_share[RTE_LPM_MAX_DEPTH + 1] = {
+	[8] = 2, [9] = 2, [10] = 4, [11] = 12, [12] = 35, [13] = 70,
+	[14] = 130, [15] = 230, [16] = 1450, [17] = 850, [18] = 1400,
+	[19] = 2600, [20] = 4500, [21] = 4600, [22] = 11500, [23] = 10300,
+	[24] = 60585, [25] = 300, [26] = 250, [27] = 150, [28] = 150,
+	[29] = 200, [30] = 250, [31] = 30, [32] = 400,
+};
+
+static void
+generate_full_table(struct full_table_route *routes, uint32_t n)
+{
+	uint32_t i, j, depth, first_octet;
+
+	rte_srand(FULL_TABLE_SEED);
+
+	i = 0;
+	for (depth = 1; depth <= RTE_LPM_MAX_DEPTH; depth++) {
+		uint32_t depth_routes = (uint64_t)n *
+				full_table_depth_share[depth] / 100000;
+
+		for (j = 0; j < depth_routes && i < n; j++, i++) {
+			/* Unicast address space, i.e. 1.0.0.0 - 223.255.255.255 */
+			first_octet = 1 + rte_rand() % 223;
+			routes[i].ip = (first_octet << 24) |
+					(rte_rand() & 0x00FFFFFF);
+			routes[i].ip &= (uint32_t)((int32_t)0x80000000 >>
+					(depth - 1));
+			routes[i].depth = depth;
+			routes[i].next_hop = rte_rand() & RTE_LPM_MAX_NEXT_HOP;
+		}
+	}
+
+	/* Rounding leftovers are /24 routes, the most common ones. */
+	for (; i < n; i++) {
+		first_octet = 1 + rte_rand() % 223;
+		routes[i].ip = ((first_octet << 24) |
+				(rte_rand() & 0x00FFFFFF)) & 0xFFFFFF00;
+		routes[i].depth = 24;
+		routes[i].next_hop = rte_rand() & RTE_LPM_MAX_NEXT_HOP;
+	}
+
+	/* Shuffle so that prefixes of all lengths are interleaved. */
+	for (i = n - 1; i > 0; i--) {
+		struct full_table_route tmp;
+
+		j = rte_rand() % (i + 1);
+		tmp = routes[i];
+		routes[i] = routes[j];
+		routes[j] = tmp;
+	}
+}
+
+/* Fill a lookup batch with addresses covered by random routes of the table. */
+static void
+generate_lookup_batch(const struct full_table_route *routes,
+		uint32_t *ip_batch)
+{
+	uint32_t j, k, host_mask;
+
+	for (j = 0; j < BATCH_SIZE; j++) {
+		k = rte_rand() % FULL_TABLE_NUM_ROUTES;
+		host_mask = ~(uint32_t)((int32_t)0x80000000 >>
+				(routes[k].depth - 1));
+		ip_batch[j] = routes[k].ip | ((uint32_t)rte_rand() & host_mask);
+	}
+}
+
+static int32_t
+full_table_perf_test(void)
+{
+	struct rte_lpm *lpm = NULL;
+	struct full_table_route *routes;
+	uint32_t *ip_batch;
+	uint32_t next_hops[BULK_SIZE];
+	uint32_t next_hop_return;
+	uint64_t begin, total_time;
+	uint32_t i, j, k, tbl8_used, depth_counter[RTE_LPM_MAX_DEPTH + 1];
+	int64_t count;
+	int status;
+
+	routes = malloc(sizeof(*routes) * FULL_TABLE_NUM_ROUTES);
+	ip_batch = malloc(sizeof(*ip_batch) * BATCH_SIZE);
+	if (routes == NULL || ip_batch == NULL) {
+		printf("Error, cannot allocate the route table\n");
+		free(routes);
+		free(ip_batch);
+		return -1;
+	}
+
+	generate_full_table(routes, FULL_TABLE_NUM_ROUTES);
+
+	memset(depth_counter, 0, sizeof(depth_counter));
+	for (i = 0; i < FULL_TABLE_NUM_ROUTES; i++)
+		depth_counter[routes[i].depth]++;
+
+	printf("No. routes = %u\n", (unsigned) FULL_TABLE_NUM_ROUTES);
+	printf("Route distribution per prefix width: \n");
+	printf("DEPTH    QUANTITY (PERCENT)\n");
+	printf("--------------------------- \n");
+	for (i = 1; i <= RTE_LPM_MAX_DEPTH; i++)
+		printf("%.2u%15u (%.2f)\n", i, depth_counter[i],
+				depth_counter[i] * 100.0 /
+				FULL_TABLE_NUM_ROUTES);
+	printf("\n");
+
+	config.max_rules = FULL_TABLE_NUM_ROUTES;
+	config.number_tbl8s = FULL_TABLE_NUMBER_TBL8S;
+	lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	if (lpm == NULL) {
+		free(routes);
+		free(ip_batch);
+		return -1;
+	}
+
+	/* Measure add. */
+	status = 0;
+	begin = rte_rdtsc();
+	for (i = 0; i < FULL_TABLE_NUM_ROUTES; i++) {
+		if (rte_lpm_add(lpm, routes[i].ip, routes[i].depth,
+				routes[i].next_hop) != 0)
+			status++;
+	}
+	total_time = rte_rdtsc() - begin;
+
+	tbl8_used = 0;
+	for (i = 0; i < lpm->number_tbl8s; i++)
+		if (lpm->tbl8[i * RTE_LPM_TBL8_GROUP_NUM_ENTRIES].valid_group)
+			tbl8_used++;
+
+	printf("Failed additions = %d\n", status);
+	printf("Used tbl8 groups = %u of %u\n", tbl8_used, lpm->number_tbl8s);
+	printf("Average LPM Add: %g cycles\n",
+			(double)total_time / FULL_TABLE_NUM_ROUTES);
+	if (status != 0)
+		goto error;
+
+	/* Measure single Lookup */
+	total_time = 0;
+	count = 0;
+	for (i = 0; i < ITERATIONS; i++) {
+		generate_lookup_batch(routes, ip_batch);
+
+		begin = rte_rdtsc();
+		for (j = 0; j < BATCH_SIZE; j++) {
+			if (rte_lpm_lookup(lpm, ip_batch[j],
+					&next_hop_return) != 0)
+				count++;
+		}
+		total_time += rte_rdtsc() - begin;
+	}
+	printf("Average LPM Lookup: %.1f cycles (fails = %.1f%%)\n",
+			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
+			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+	if (count != 0)
+		goto error;
+
+	/* Measure bulk Lookup */
+	total_time = 0;
+	count = 0;
+	for (i = 0; i < ITERATIONS; i++) {
+		generate_lookup_batch(routes, ip_batch);
+
+		begin = rte_rdtsc();
+		for (j = 0; j < BATCH_SIZE; j += BULK_SIZE) {
+			rte_lpm_lookup_bulk(lpm, &ip_batch[j], next_hops,
+					BULK_SIZE);
+			for (k = 0; k < BULK_SIZE; k++)
+				if (unlikely(!(next_hops[k] &
+						RTE_LPM_LOOKUP_SUCCESS)))
+					count++;
+		}
+		total_time += rte_rdtsc() - begin;
+	}
+	printf("BULK LPM Lookup: %.1f cycles (fails = %.1f%%)\n",
+			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
+			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+
+	/* Measure LookupX4 */
+	total_time = 0;
+	count = 0;
+	for (i = 0; i < ITERATIONS; i++) {
+		generate_lookup_batch(routes, ip_batch);
+
+		begin = rte_rdtsc();
+		for (j = 0; j < BATCH_SIZE; j += 4) {
+			__m128i ipx4;
+
+			ipx4 = _mm_loadu_si128((__m128i *)(ip_batch + j));
+			rte_lpm_lookupx4(lpm, ipx4, next_hops, UINT32_MAX);
+			for (k = 0; k < 4; k++)
+				if (unlikely(next_hops[k] == UINT32_MAX))
+					count++;
+		}
+		total_time += rte_rdtsc() - begin;
+	}
+	printf("LPM LookupX4: %.1f cycles (fails = %.1f%%)\n",
+			(double)total_time / ((double)ITERATIONS * BATCH_SIZE),
+			(count * 100.0) / (double)(ITERATIONS * BATCH_SIZE));
+
+	rte_lpm_free(lpm);
+	free(routes);
+	free(ip_batch);
+
+	return PASS;
+
+error:
+	rte_lpm_free(lpm);
+	free(routes);
+	free(ip_batch);
+
+	return -1;
+}
+
+/*
+ * Stress test of the updates done while lookups run on other lcores.
+ *
+ * The readers look up addresses inside stable /16 rules. The writer
+ * adds and deletes more specific rules around those addresses: the ones
+ * covering them have the next hop of the /16, the others a different one,
+ * so that tbl8 groups are allocated, populated, recycled and reused all the
+ * time. Any lookup returning a miss or another next hop is a misrouting.
+ */
+#define STRESS_NUM_SUBNETS      16
+#define STRESS_SECONDS          2
+#define STRESS_NUM_TBL8S        32
+#define STRESS_BURST            32
+#define STRESS_HOP(subnet)      (0x10000 + (subnet))
+#define STRESS_OTHER_HOP        0xabcdef
+
+static struct rte_lpm *stress_lpm;
+static volatile int stress_done;
+
+struct stress_reader_stats {
+	uint64_t lookups;
+	uint64_t errors;
+} __rte_cache_aligned;
+
+static struct stress_reader_stats stress_stats[RTE_MAX_LCORE];
+
+/* Address n of the looked up ones, and the next hop it must match. */
+static inline uint32_t
+stress_ip(uint32_t n, uint32_t *next_hop)
+{
+	uint32_t subnet = n % STRESS_NUM_SUBNETS;
+
+	*next_hop = STRESS_HOP(subnet);
+	return IPv4(10, subnet, (n / STRESS_NUM_SUBNETS) & 0xff, 1);
+}
+
+static int
+stress_reader(__attribute__((unused)) void *arg)
+{
+	unsigned lcore_id = rte_lcore_id();
+	struct stress_reader_stats *stats = &stress_stats[lcore_id];
+	uint32_t ips[STRESS_BURST], expected[STRESS_BURST];
+	uint32_t next_hops[STRESS_BURST], hop, n;
+	uint64_t seed = lcore_id;
+	unsigned i;
+
+	rte_lpm_reader_register(stress_lpm, lcore_id);
+
+	while (!stress_done) {
+		for (i = 0; i < STRESS_BURST; i++) {
+			seed = seed * 6364136223846793005ULL + 1;
+			n = (uint32_t)(seed >> 33);
+			ips[i] = stress_ip(n, &expected[i]);
+		}
+
+		for (i = 0; i < STRESS_BURST; i++) {
+			if (rte_lpm_lookup(stress_lpm, ips[i], &hop) != 0 ||
+					hop != expected[i])
+				stats->errors++;
+		}
+
+		rte_lpm_lookup_bulk(stress_lpm, ips, next_hops, STRESS_BURST);
+		for (i = 0; i < STRESS_BURST; i++) {
+			if ((next_hops[i] & RTE_LPM_LOOKUP_SUCCESS) == 0 ||
+					(next_hops[i] & RTE_LPM_MAX_NEXT_HOP) !=
+					expected[i])
+				stats->errors++;
+		}
+
+		for (i = 0; i < STRESS_BURST; i += 4) {
+			rte_lpm_lookupx4(stress_lpm,
+					_mm_loadu_si128((__m128i *)&ips[i]),
+					&next_hops[i], UINT32_MAX);
+			if (next_hops[i] != expected[i] ||
+					next_hops[i + 1] != expected[i + 1] ||
+					next_hops[i + 2] != expected[i + 2] ||
+					next_hops[i + 3] != expected[i + 3])
+				stats->errors++;
+		}
+
+		stats->lookups += 3 * STRESS_BURST;
+		rte_lpm_reader_quiescent(stress_lpm, lcore_id);
+	}
+
+	rte_lpm_reader_unregister(stress_lpm, lcore_id);
+
+	return 0;
+}
+
+/* Applies updates, waiting for the readers when tbl8 groups run out. */
+static int
+stress_apply(struct rte_lpm_update *updates, unsigned n, int bulk)
+{
+	unsigned done = 0;
+	int ret;
+
+	while (done < n) {
+		if (bulk) {
+			ret = rte_lpm_update_bulk(stress_lpm, &updates[done],
+					n - done);
+			if (ret < 0)
+				return ret;
+			done += ret;
+			if (done < n && rte_errno != ENOSPC)
+				return -rte_errno;
+		} else {
+			if (updates[done].op == RTE_LPM_UPDATE_ADD)
+				ret = rte_lpm_add(stress_lpm, updates[done].ip,
+						updates[done].depth,
+						updates[done].next_hop);
+			else
+				ret = rte_lpm_delete(stress_lpm,
+						updates[done].ip,
+						updates[done].depth);
+			if (ret == 0)
+				done++;
+			else if (ret != -ENOSPC)
+				return ret;
+		}
+		if (done < n)
+			sched_yield();
+	}
+
+	return 0;
+}
+
+static int
+stress_test(void)
+{
+	struct rte_lpm_update updates[8];
+	uint64_t lookups = 0, errors = 0, begin, total, duration;
+	uint32_t subnet, net24, i;
+	unsigned lcore_id, num_readers = 0;
+	int status = 0;
+
+	config.max_rules = 1024;
+	config.number_tbl8s = STRESS_NUM_TBL8S;
+
+	stress_lpm = rte_lpm_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(stress_lpm != NULL);
+
+	for (subnet = 0; subnet < STRESS_NUM_SUBNETS; subnet++) {
+		status = rte_lpm_add(stress_lpm, IPv4(10, subnet, 0, 0), 16,
+				STRESS_HOP(subnet));
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	memset(stress_stats, 0, sizeof(stress_stats));
+	stress_done = 0;
+	rte_mb();
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		rte_eal_remote_launch(stress_reader, NULL, lcore_id);
+		num_readers++;
+	}
+	if (num_readers == 0) {
+		printf("At least 2 lcores are needed\n");
+		rte_lpm_free(stress_lpm);
+		return -1;
+	}
+
+	srand(1);
+	duration = rte_get_tsc_hz() * STRESS_SECONDS;
+	begin = rte_rdtsc();
+	for (i = 0; rte_rdtsc() - begin < duration && status == 0; i++) {
+		subnet = rand() % STRESS_NUM_SUBNETS;
+		net24 = IPv4(10, subnet, rand() & 0xff, 0);
+
+		/* Covering the looked up address x.x.x.1, same next hop. */
+		updates[0] = (struct rte_lpm_update) { net24 | 1, 32,
+				RTE_LPM_UPDATE_ADD, STRESS_HOP(subnet) };
+		updates[1] = (struct rte_lpm_update) { net24, 24,
+				RTE_LPM_UPDATE_ADD, STRESS_HOP(subnet) };
+		updates[2] = (struct rte_lpm_update) { net24, 30,
+				RTE_LPM_UPDATE_ADD, STRESS_HOP(subnet) };
+		/* Beside it, another next hop. */
+		updates[3] = (struct rte_lpm_update) { net24 | 128, 25,
+				RTE_LPM_UPDATE_ADD, STRESS_OTHER_HOP };
+		updates[4] = (struct rte_lpm_update) { net24 | 4, 30,
+				RTE_LPM_UPDATE_ADD, STRESS_OTHER_HOP };
+		status = stress_apply(updates, 5, i & 1);
+		if (status != 0)
+			break;
+
+		/* Delete them, in an order recycling the tbl8 group or not. */
+		updates[0].op = RTE_LPM_UPDATE_DELETE;
+		updates[1].op = RTE_LPM_UPDATE_DELETE;
+		updates[2].op = RTE_LPM_UPDATE_DELETE;
+		updates[3].op = RTE_LPM_UPDATE_DELETE;
+		updates[4].op = RTE_LPM_UPDATE_DELETE;
+		if (i & 2) {
+			updates[5] = updates[0];
+			updates[0] = updates[1];
+			updates[1] = updates[5];
+		}
+		status = stress_apply(updates, 5, i & 1);
+	}
+	total = rte_rdtsc() - begin;
+
+	stress_done = 1;
+	rte_eal_mp_wait_lcore();
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		lookups += stress_stats[lcore_id].lookups;
+		errors += stress_stats[lcore_id].errors;
+	}
+
+	printf("Updates: %u in %g cycles on average, status %d\n",
+			i * 10, (double)total / (i * 10), status);
+	printf("Lookups: %"PRIu64" by %u readers, %"PRIu64" misroutes\n",
+			lookups, num_readers, errors);
+
+	rte_lpm_free(stress_lpm);
+
+	if (status != 0 || errors != 0)
+		return -1;
+
+	return PASS;
+}
+
 /*
  * Do all unit and performance tests.
  */
@@ -1337,6 +1990,10 @@ test_lpm(void)
 	int status, global_status = 0;
 
 	for (i = 0; i < NUM_LPM_TESTS; i++) {
+		config.max_rules = MAX_RULES;
+		config.number_tbl8s = NUMBER_TBL8S;
+		config.flags = 0;
+
 		status = tests[i]();
 		if (status < 0) {
 			printf("ERROR: LPM Test %s: FAIL\n", RTE_STR(tests[i]));
@@ -1352,3 +2009,31 @@ static struct test_command lpm_cmd = {
 	.callback = test_lpm,
 };
 REGISTER_TEST_COMMAND(lpm_cmd);
+
+static int
+test_lpm_full_table_perf(void)
+{
+	config.flags = 0;
+
+	return full_table_perf_test();
+}
+
+static struct test_command lpm_full_table_perf_cmd = {
+	.command = "lpm_full_table_perf_autotest",
+	.callback = test_lpm_full_table_perf,
+};
+REGISTER_TEST_COMMAND(lpm_full_table_perf_cmd);
+
+static int
+test_lpm_concurrency(void)
+{
+	config.flags = 0;
+
+	return stress_test();
+}
+
+static struct test_command lpm_concurrency_cmd = {
+	.command = "lpm_concurrency_autotest",
+	.callback = test_lpm_concurrency,
+};
+REGISTER_TEST_COMMAND(lpm_concurrency_cmd);
@@ -32,12 +32,14 @@
  */
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
 #include <sys/queue.h>
 
 #include <time.h>
+#include <sched.h>
 
 #include "test.h"
 
@@ -47,6 +49,10 @@
 #include <rte_random.h>
 #include <rte_branch_prediction.h>
 #include <rte_ip.h>
+#include <rte_lcore.h>
+#include <rte_launch.h>
+#include <rte_atomic.h>
+#include <rte_errno.h>
 
 #include "rte_lpm6.h"
 #include "test_lpm6_routes.h"
@@ -88,6 +94,9 @@ static int32_t test24(void);
 static int32_t test25(void);
 static int32_t test26(void);
 static int32_t test27(void);
+static int32_t test28(void);
+static int32_t test29(void);
+static int32_t test30(void);
 static int32_t perf_test(void);
 
 rte_lpm6_test tests6[] = {
@@ -120,6 +129,9 @@ rte_lpm6_test tests6[] = {
 	test25,
 	test26,
 	test27,
+	test28,
+	test29,
+	test30,
 	perf_test,
 };
 
@@ -1761,6 +1773,319 @@ test27(void)
 		return PASS;
 }
 
+/*
+ * Check that the tbl8 groups are given back on delete:
+ *  - add and delete a /128 rule more times than the tbl8 groups it needs
+ *    allow, with and without a rule covering it
+ *  - lookup after each step
+ */
+int32_t
+test28(void)
+{
+	struct rte_lpm6 *lpm = NULL;
+	struct rte_lpm6_config config;
+	uint8_t ip[] = {32, 1, 13, 184, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+	uint8_t next_hop_return = 0;
+	int32_t status = 0;
+	unsigned i;
+
+	config.max_rules = MAX_RULES;
+	/* A /128 rule needs 13 tbl8 groups. */
+	config.number_tbl8s = 16;
+	config.flags = 0;
+
+	lpm = rte_lpm6_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	for (i = 0; i < 100; i++) {
+		status = rte_lpm6_add(lpm, ip, 128, 100);
+		TEST_LPM_ASSERT(status == 0);
+
+		status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+		TEST_LPM_ASSERT((status == 0) && (next_hop_return == 100));
+
+		status = rte_lpm6_delete(lpm, ip, 128);
+		TEST_LPM_ASSERT(status == 0);
+
+		status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+		TEST_LPM_ASSERT(status == -ENOENT);
+	}
+
+	status = rte_lpm6_add(lpm, ip, 40, 40);
+	TEST_LPM_ASSERT(status == 0);
+
+	for (i = 0; i < 100; i++) {
+		status = rte_lpm6_add(lpm, ip, 128, 100);
+		TEST_LPM_ASSERT(status == 0);
+
+		status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+		TEST_LPM_ASSERT((status == 0) && (next_hop_return == 100));
+
+		status = rte_lpm6_delete(lpm, ip, 128);
+		TEST_LPM_ASSERT(status == 0);
+
+		status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+		TEST_LPM_ASSERT((status == 0) && (next_hop_return == 40));
+	}
+
+	/* A failed add leaves no group behind either. */
+	ip[4] = 1;
+	status = rte_lpm6_add(lpm, ip, 128, 100);
+	TEST_LPM_ASSERT(status == 0);
+	ip[3] = 185;
+	status = rte_lpm6_add(lpm, ip, 128, 101);
+	TEST_LPM_ASSERT(status == -ENOSPC);
+	status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+	TEST_LPM_ASSERT(status == -ENOENT);
+	ip[3] = 184;
+	status = rte_lpm6_delete(lpm, ip, 128);
+	TEST_LPM_ASSERT(status == 0);
+	ip[3] = 185;
+	status = rte_lpm6_add(lpm, ip, 128, 101);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+	TEST_LPM_ASSERT((status == 0) && (next_hop_return == 101));
+
+	rte_lpm6_free(lpm);
+
+	return PASS;
+}
+
+#define TEST29_NUM_RULES 64
+
+/* Clears the bits of an IPv6 address after the given depth. */
+static void
+test29_mask_ip(uint8_t *ip, unsigned depth)
+{
+	unsigned i;
+
+	for (i = depth; i < RTE_LPM6_IPV6_ADDR_SIZE * 8; i++)
+		ip[i / 8] &= (uint8_t)~(0x80 >> (i % 8));
+}
+
+/*
+ * Random sequences of adds and deletes of overlapping rules, checked against
+ * the longest prefix match found by scanning the rules:
+ *  - the rules are random prefixes sharing many bits
+ *  - after each update, lookup an address inside every rule
+ *  - finally delete all the rules with rte_lpm6_update_bulk() and check all
+ *    the tbl8 groups can be allocated again
+ */
+int32_t
+test29(void)
+{
+	struct rte_lpm6 *lpm = NULL;
+	struct rte_lpm6_config config;
+	struct rte_lpm6_update updates[TEST29_NUM_RULES];
+	struct {
+		uint8_t ip[RTE_LPM6_IPV6_ADDR_SIZE];
+		uint8_t depth;
+		uint8_t next_hop;
+		int added;
+	} rules[TEST29_NUM_RULES];
+	uint8_t ip[RTE_LPM6_IPV6_ADDR_SIZE], masked[RTE_LPM6_IPV6_ADDR_SIZE];
+	uint8_t next_hop_return = 0, next_hop_expected = 0;
+	int32_t status = 0;
+	unsigned i, j, k, n, iter;
+	int depth_expected;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = 1024;
+	config.flags = 0;
+
+	lpm = rte_lpm6_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	srand(29);
+	for (i = 0; i < TEST29_NUM_RULES; i++) {
+		/* Mostly 0 or 1 bytes, so that the rules overlap. */
+		for (j = 0; j < RTE_LPM6_IPV6_ADDR_SIZE; j++)
+			rules[i].ip[j] = (rand() & 3) == 0 ? (uint8_t)rand() :
+					(j < 4 || (rand() & 1) ? 0 : 0xff);
+		rules[i].depth = (uint8_t)(1 + rand() % MAX_DEPTH);
+		rules[i].next_hop = (uint8_t)i;
+		rules[i].added = 0;
+		test29_mask_ip(rules[i].ip, rules[i].depth);
+
+		/* Rules are identified by their prefix and depth. */
+		for (n = 0; n < i; n++)
+			if (rules[n].depth == rules[i].depth &&
+					memcmp(rules[n].ip, rules[i].ip,
+					RTE_LPM6_IPV6_ADDR_SIZE) == 0)
+				break;
+		if (n < i)
+			i--;
+	}
+
+	for (iter = 0; iter < 2000; iter++) {
+		i = rand() % TEST29_NUM_RULES;
+		if (rules[i].added) {
+			status = rte_lpm6_delete(lpm, rules[i].ip,
+					rules[i].depth);
+			TEST_LPM_ASSERT(status == 0);
+			rules[i].added = 0;
+		} else {
+			status = rte_lpm6_add(lpm, rules[i].ip,
+					rules[i].depth, rules[i].next_hop);
+			TEST_LPM_ASSERT(status == 0);
+			rules[i].added = 1;
+		}
+
+		for (k = 0; k < TEST29_NUM_RULES; k++) {
+			/* Random address inside rule k. */
+			for (j = 0; j < RTE_LPM6_IPV6_ADDR_SIZE; j++)
+				ip[j] = (uint8_t)rand();
+			for (j = 0; j < rules[k].depth; j++) {
+				uint8_t bit = (uint8_t)(0x80 >> (j % 8));
+
+				ip[j / 8] = (uint8_t)((ip[j / 8] & ~bit) |
+						(rules[k].ip[j / 8] & bit));
+			}
+
+			depth_expected = -1;
+			for (n = 0; n < TEST29_NUM_RULES; n++) {
+				if (!rules[n].added ||
+						rules[n].depth <= depth_expected)
+					continue;
+				memcpy(masked, ip, sizeof(masked));
+				test29_mask_ip(masked, rules[n].depth);
+				if (memcmp(masked, rules[n].ip,
+						sizeof(masked)) == 0) {
+					depth_expected = rules[n].depth;
+					next_hop_expected = rules[n].next_hop;
+				}
+			}
+
+			status = rte_lpm6_lookup(lpm, ip, &next_hop_return);
+			if (depth_expected < 0)
+				TEST_LPM_ASSERT(status == -ENOENT);
+			else
+				TEST_LPM_ASSERT((status == 0) &&
+					(next_hop_return == next_hop_expected));
+		}
+	}
+
+	n = 0;
+	for (i = 0; i < TEST29_NUM_RULES; i++) {
+		if (!rules[i].added)
+			continue;
+		memcpy(updates[n].ip, rules[i].ip, RTE_LPM6_IPV6_ADDR_SIZE);
+		updates[n].depth = rules[i].depth;
+		updates[n].op = RTE_LPM6_UPDATE_DELETE;
+		n++;
+	}
+	status = rte_lpm6_update_bulk(lpm, updates, n);
+	TEST_LPM_ASSERT(status == (int32_t)n);
+
+	/* Each /128 rule with a different first byte needs 13 groups. */
+	memset(ip, 0, sizeof(ip));
+	for (i = 0; i < config.number_tbl8s / 13; i++) {
+		ip[0] = (uint8_t)i;
+		status = rte_lpm6_add(lpm, ip, 128, 1);
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	rte_lpm6_free(lpm);
+
+	return PASS;
+}
+
+/*
+ * Check that the bulk lookup returns the same next hops as the single one,
+ * with lookups ending at different levels of the trie interleaved in the
+ * same batch, and that the memory report counts the groups of each level.
+ */
+#define TEST30_NUM_IPS 100
+
+int32_t
+test30(void)
+{
+	struct rte_lpm6 *lpm = NULL;
+	struct rte_lpm6_config config;
+	struct rte_lpm6_memory_stats stats;
+	uint8_t ips[TEST30_NUM_IPS][RTE_LPM6_IPV6_ADDR_SIZE];
+	int16_t next_hops[TEST30_NUM_IPS];
+	uint8_t ip[RTE_LPM6_IPV6_ADDR_SIZE];
+	uint8_t next_hop_return = 0;
+	int32_t status = 0;
+	unsigned i, j;
+
+	config.max_rules = MAX_RULES;
+	config.number_tbl8s = NUMBER_TBL8S;
+	config.flags = 0;
+
+	lpm = rte_lpm6_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(lpm != NULL);
+
+	status = rte_lpm6_get_memory_stats(lpm, &stats);
+	TEST_LPM_ASSERT(status == 0);
+	TEST_LPM_ASSERT(stats.used_rules == 0 && stats.used_tbl8s == 0);
+	TEST_LPM_ASSERT(stats.number_tbl8s == NUMBER_TBL8S);
+	TEST_LPM_ASSERT(stats.used_size < stats.total_size);
+
+	/* 1::/16, 1:0:100::/40, 1::/128 and 1:0:100::/128. */
+	memset(ip, 0, sizeof(ip));
+	ip[1] = 1;
+	status = rte_lpm6_add(lpm, ip, 16, 16);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_add(lpm, ip, 128, 128);
+	TEST_LPM_ASSERT(status == 0);
+	ip[4] = 1;
+	status = rte_lpm6_add(lpm, ip, 40, 40);
+	TEST_LPM_ASSERT(status == 0);
+	status = rte_lpm6_add(lpm, ip, 128, 129);
+	TEST_LPM_ASSERT(status == 0);
+
+	status = rte_lpm6_get_memory_stats(lpm, &stats);
+	TEST_LPM_ASSERT(status == 0);
+	TEST_LPM_ASSERT(stats.used_rules == 4);
+	/* Both /128 differ at byte 4, indexing the level 1 group. */
+	TEST_LPM_ASSERT(stats.level_tbl8s[0] == 1);
+	TEST_LPM_ASSERT(stats.level_tbl8s[1] == 1);
+	for (i = 2; i < RTE_LPM6_TBL8_NUM_LEVELS; i++)
+		TEST_LPM_ASSERT(stats.level_tbl8s[i] == 2);
+	TEST_LPM_ASSERT(stats.used_tbl8s == 2 * RTE_LPM6_TBL8_NUM_LEVELS - 2);
+
+	/* Addresses ending at each level, or missing all rules. */
+	srand(30);
+	for (i = 0; i < TEST30_NUM_IPS; i++) {
+		memset(ips[i], 0, RTE_LPM6_IPV6_ADDR_SIZE);
+		switch (rand() % 4) {
+		case 0:
+			ips[i][0] = (uint8_t)(rand() % 2);
+			ips[i][1] = (uint8_t)rand();
+			break;
+		case 1:
+			ips[i][1] = 1;
+			ips[i][4] = (uint8_t)(rand() % 2);
+			ips[i][5 + rand() % 11] = (uint8_t)(rand() % 2);
+			break;
+		default:
+			ips[i][1] = 1;
+			ips[i][4] = (uint8_t)(rand() % 2);
+			break;
+		}
+	}
+
+	/* All batch sizes, so that incomplete batches are checked too. */
+	for (j = 1; j <= TEST30_NUM_IPS; j++) {
+		status = rte_lpm6_lookup_bulk_func(lpm, ips, next_hops, j);
+		TEST_LPM_ASSERT(status == 0);
+
+		for (i = 0; i < j; i++) {
+			status = rte_lpm6_lookup(lpm, ips[i], &next_hop_return);
+			if (status == 0)
+				TEST_LPM_ASSERT(next_hops[i] == next_hop_return);
+			else
+				TEST_LPM_ASSERT(next_hops[i] == -1);
+		}
+	}
+
+	rte_lpm6_free(lpm);
+
+	return PASS;
+}
+
 /*
  * Lookup performance test
  */
@@ -1797,6 +2122,7 @@ perf_test(void)
 {
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_lpm6_config config;
+	struct rte_lpm6_memory_stats stats;
 	uint64_t begin, total_time;
 	unsigned i, j;
 	uint8_t next_hop_add = 0xAA, next_hop_return = 0;
@@ -1831,6 +2157,17 @@ perf_test(void)
 	printf("Average LPM Add: %g cycles\n",
 			(double)total_time / NUM_ROUTE_ENTRIES);
 
+	/* Memory footprint */
+	rte_lpm6_get_memory_stats(lpm, &stats);
+	printf("Memory: %"PRIu64" bytes used of %"PRIu64" allocated, "
+			"%u rules, %u/%u tbl8 groups\n",
+			stats.used_size, stats.total_size, stats.used_rules,
+			stats.used_tbl8s, stats.number_tbl8s);
+	printf("tbl8 groups per level:");
+	for (i = 0; i < RTE_LPM6_TBL8_NUM_LEVELS; i++)
+		printf(" %u", stats.level_tbl8s[i]);
+	printf("\n");
+
 	/* Measure single Lookup */
 	total_time = 0;
 	count = 0;
@@ -1897,6 +2234,213 @@ perf_test(void)
 	return PASS;
 }
 
+/*
+ * Stress test of the updates done while lookups run on other lcores.
+ *
+ * The readers look up addresses inside stable /48 rules. The writer
+ * adds and deletes more specific rules around those addresses: the ones
+ * covering them have the next hop of the /48, the others a different one,
+ * so that tbl8 groups are allocated, populated, freed and reused all the
+ * time. Any lookup returning a miss or another next hop is a misrouting.
+ */
+#define STRESS_NUM_SUBNETS      16
+#define STRESS_SECONDS          2
+#define STRESS_NUM_TBL8S        256
+#define STRESS_BURST            32
+#define STRESS_HOP(subnet)      (1 + (subnet))
+#define STRESS_OTHER_HOP        200
+
+static struct rte_lpm6 *stress_lpm;
+static volatile int stress_done;
+
+struct stress_reader_stats {
+	uint64_t lookups;
+	uint64_t errors;
+} __rte_cache_aligned;
+
+static struct stress_reader_stats stress_stats[RTE_MAX_LCORE];
+
+/* Address 2001:db8:<subnet>:<n>::1, inside the 2001:db8:<subnet>::/48 rule. */
+static void
+stress_ip(uint8_t *ip, uint32_t subnet, uint32_t n)
+{
+	memset(ip, 0, RTE_LPM6_IPV6_ADDR_SIZE);
+	ip[0] = 0x20;
+	ip[1] = 0x01;
+	ip[2] = 0x0d;
+	ip[3] = 0xb8;
+	ip[5] = (uint8_t)subnet;
+	ip[7] = (uint8_t)n;
+	ip[15] = 1;
+}
+
+static int
+stress_reader(__attribute__((unused)) void *arg)
+{
+	unsigned lcore_id = rte_lcore_id();
+	struct stress_reader_stats *stats = &stress_stats[lcore_id];
+	uint8_t ips[STRESS_BURST][RTE_LPM6_IPV6_ADDR_SIZE];
+	uint8_t expected[STRESS_BURST], hop;
+	int16_t next_hops[STRESS_BURST];
+	uint64_t seed = lcore_id;
+	uint32_t n;
+	unsigned i;
+
+	rte_lpm6_reader_register(stress_lpm, lcore_id);
+
+	while (!stress_done) {
+		for (i = 0; i < STRESS_BURST; i++) {
+			seed = seed * 6364136223846793005ULL + 1;
+			n = (uint32_t)(seed >> 33);
+			stress_ip(ips[i], n % STRESS_NUM_SUBNETS,
+					n / STRESS_NUM_SUBNETS);
+			expected[i] = STRESS_HOP(n % STRESS_NUM_SUBNETS);
+		}
+
+		for (i = 0; i < STRESS_BURST; i++) {
+			if (rte_lpm6_lookup(stress_lpm, ips[i], &hop) != 0 ||
+					hop != expected[i])
+				stats->errors++;
+		}
+
+		rte_lpm6_lookup_bulk_func(stress_lpm, ips, next_hops,
+				STRESS_BURST);
+		for (i = 0; i < STRESS_BURST; i++) {
+			if (next_hops[i] != expected[i])
+				stats->errors++;
+		}
+
+		stats->lookups += 2 * STRESS_BURST;
+		rte_lpm6_reader_quiescent(stress_lpm, lcore_id);
+	}
+
+	rte_lpm6_reader_unregister(stress_lpm, lcore_id);
+
+	return 0;
+}
+
+/* Applies updates, waiting for the readers when tbl8 groups run out. */
+static int
+stress_apply(struct rte_lpm6_update *updates, unsigned n)
+{
+	unsigned done = 0;
+	int ret;
+
+	while (done < n) {
+		ret = rte_lpm6_update_bulk(stress_lpm, &updates[done],
+				n - done);
+		if (ret < 0)
+			return ret;
+		done += ret;
+		if (done < n) {
+			if (rte_errno != ENOSPC)
+				return -rte_errno;
+			sched_yield();
+		}
+	}
+
+	return 0;
+}
+
+static int
+stress_test(void)
+{
+	struct rte_lpm6_config config;
+	struct rte_lpm6_update updates[6];
+	uint8_t ip[RTE_LPM6_IPV6_ADDR_SIZE];
+	uint64_t lookups = 0, errors = 0, begin, total, duration;
+	uint32_t subnet, n, i, j;
+	unsigned lcore_id, num_readers = 0;
+	int status = 0;
+
+	config.max_rules = 1024;
+	config.number_tbl8s = STRESS_NUM_TBL8S;
+	config.flags = 0;
+
+	stress_lpm = rte_lpm6_create(__func__, SOCKET_ID_ANY, &config);
+	TEST_LPM_ASSERT(stress_lpm != NULL);
+
+	for (subnet = 0; subnet < STRESS_NUM_SUBNETS; subnet++) {
+		stress_ip(ip, subnet, 0);
+		status = rte_lpm6_add(stress_lpm, ip, 48, STRESS_HOP(subnet));
+		TEST_LPM_ASSERT(status == 0);
+	}
+
+	memset(stress_stats, 0, sizeof(stress_stats));
+	stress_done = 0;
+	rte_mb();
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		rte_eal_remote_launch(stress_reader, NULL, lcore_id);
+		num_readers++;
+	}
+	if (num_readers == 0) {
+		printf("At least 2 lcores are needed\n");
+		rte_lpm6_free(stress_lpm);
+		return -1;
+	}
+
+	srand(1);
+	duration = rte_get_tsc_hz() * STRESS_SECONDS;
+	begin = rte_rdtsc();
+	for (i = 0; rte_rdtsc() - begin < duration && status == 0; i++) {
+		subnet = rand() % STRESS_NUM_SUBNETS;
+		n = rand() & 0xff;
+
+		/* Covering the looked up address, same next hop. */
+		updates[0].depth = 128;
+		updates[0].next_hop = STRESS_HOP(subnet);
+		updates[1].depth = 64;
+		updates[1].next_hop = STRESS_HOP(subnet);
+		updates[2].depth = 120;
+		updates[2].next_hop = STRESS_HOP(subnet);
+		/* Beside it, another next hop. */
+		updates[3].depth = 128;
+		updates[3].next_hop = STRESS_OTHER_HOP;
+		updates[4].depth = 72;
+		updates[4].next_hop = STRESS_OTHER_HOP;
+		for (j = 0; j < 5; j++) {
+			stress_ip(updates[j].ip, subnet, n);
+			updates[j].op = RTE_LPM6_UPDATE_ADD;
+		}
+		updates[3].ip[15] = 2;
+		updates[4].ip[8] = 0x80;
+		status = stress_apply(updates, 5);
+		if (status != 0)
+			break;
+
+		/* Delete them, in an order freeing the tbl8 groups or not. */
+		for (j = 0; j < 5; j++)
+			updates[j].op = RTE_LPM6_UPDATE_DELETE;
+		if (i & 1) {
+			updates[5] = updates[0];
+			updates[0] = updates[1];
+			updates[1] = updates[5];
+		}
+		status = stress_apply(updates, 5);
+	}
+	total = rte_rdtsc() - begin;
+
+	stress_done = 1;
+	rte_eal_mp_wait_lcore();
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		lookups += stress_stats[lcore_id].lookups;
+		errors += stress_stats[lcore_id].errors;
+	}
+
+	printf("Updates: %u in %g cycles on average, status %d\n",
+			i * 10, (double)total / (i * 10), status);
+	printf("Lookups: %"PRIu64" by %u readers, %"PRIu64" misroutes\n",
+			lookups, num_readers, errors);
+
+	rte_lpm6_free(stress_lpm);
+
+	if (status != 0 || errors != 0)
+		return -1;
+
+	return PASS;
+}
+
 /*
  * Do all unit and performance tests.
  */
@@ -1923,3 +2467,15 @@ static struct test_command lpm6_cmd = {
 	.callback = test_lpm6,
 };
 REGISTER_TEST_COMMAND(lpm6_cmd);
+
+static int
+test_lpm6_concurrency(void)
+{
+	return stress_test();
+}
+
+static struct test_command lpm6_concurrency_cmd = {
+	.command = "lpm6_concurrency_autotest",
+	.callback = test_lpm6_concurrency,
+};
+REGISTER_TEST_COMMAND(lpm6_concurrency_cmd);
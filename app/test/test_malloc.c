@@ -33,6 +33,7 @@
 
 #include <stdio.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <stdarg.h>
 #include <errno.h>
@@ -50,6 +51,7 @@
 #include <rte_malloc.h>
 #include <rte_cycles.h>
 #include <rte_random.h>
+#include <rte_atomic.h>
 #include <rte_string_fns.h>
 
 #include "test.h"
@@ -298,6 +300,7 @@ test_big_alloc(void)
 	struct rte_malloc_socket_stats pre_stats, post_stats;
 	size_t size =rte_str_to_size(MALLOC_MEMZONE_SIZE)*2;
 	int align = 0;
+	int split;
 #ifndef RTE_LIBRTE_MALLOC_DEBUG
 	int overhead = RTE_CACHE_LINE_SIZE + RTE_CACHE_LINE_SIZE;
 #else
@@ -317,8 +320,13 @@ test_big_alloc(void)
 		printf("Malloc statistics are incorrect - heap_totalsz_bytes\n");
 		return -1;
 	}
+	/* With --mem-grow, the block may be split from the end of a segment
+	 * added at runtime, bigger than the memzone that would be reserved */
+	split = rte_eal_memseg_grow(socket, 0) != -ENOTSUP &&
+			post_stats.heap_allocsz_bytes == pre_stats.heap_allocsz_bytes +
+			size + overhead - RTE_CACHE_LINE_SIZE;
 	/* Check that allocated size adds up correctly */
-	if (post_stats.heap_allocsz_bytes !=
+	if (!split && post_stats.heap_allocsz_bytes !=
 			pre_stats.heap_allocsz_bytes + size + align + overhead) {
 		printf("Malloc statistics are incorrect - alloc_size\n");
 		return -1;
@@ -336,7 +344,9 @@ test_big_alloc(void)
 	}
 	/* New blocks now available - just allocated 1 but also 1 new free */
 	if (post_stats.free_count != pre_stats.free_count &&
-			post_stats.free_count != pre_stats.free_count - 1) {
+			post_stats.free_count != pre_stats.free_count - 1 &&
+			!(split && post_stats.free_count ==
+			pre_stats.free_count + 1)) {
 		printf("Malloc statistics are incorrect - free_count\n");
 		return -1;
 	}
@@ -923,6 +933,252 @@ test_alloc_socket(void)
 	return 0;
 }
 
+/*
+ * Per-lcore cache throughput test: every lcore allocates bursts of small
+ * objects of random size classes, writes them and frees them again, first
+ * with the per-lcore caches disabled and then enabled.
+ */
+#define CACHE_TEST_BURST 32
+#define CACHE_TEST_ITER 2000
+#define CACHE_TEST_SIZE 64
+
+static rte_atomic64_t cache_test_cycles;
+
+static int
+test_cache_alloc_free_per_lcore(__attribute__((unused)) void *arg)
+{
+	void *objs[CACHE_TEST_BURST];
+	uint64_t start;
+	unsigned i, j;
+	size_t size;
+
+	start = rte_rdtsc();
+	for (i = 0; i != CACHE_TEST_ITER; i++) {
+		for (j = 0; j != CACHE_TEST_BURST; j++) {
+			size = CACHE_TEST_SIZE * (1 + rte_rand() % 8);
+			objs[j] = rte_malloc(NULL, size, 0);
+			if (objs[j] == NULL) {
+				printf("%s(): rte_malloc(%zu) failed\n",
+						__func__, size);
+				while (j-- != 0)
+					rte_free(objs[j]);
+				return -1;
+			}
+			memset(objs[j], 0xa5, size);
+		}
+		for (j = 0; j != CACHE_TEST_BURST; j++)
+			rte_free(objs[j]);
+	}
+	rte_atomic64_add(&cache_test_cycles, rte_rdtsc() - start);
+	return 0;
+}
+
+static int
+test_cache_flush_per_lcore(__attribute__((unused)) void *arg)
+{
+	rte_malloc_cache_flush();
+	return 0;
+}
+
+/* run fn on every lcore, including the master */
+static int
+run_on_all_lcores(lcore_function_t *fn)
+{
+	unsigned lcore_id;
+	int ret = 0;
+
+	rte_eal_mp_remote_launch(fn, NULL, CALL_MASTER);
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+	}
+	return ret;
+}
+
+static int
+test_cache_alloc_free(void)
+{
+	struct rte_malloc_socket_stats pre, post;
+	struct rte_malloc_cache_stats cache_pre, cache_post;
+	uint64_t ops, hits, misses;
+	void *p1, *p2;
+	unsigned i;
+	int socket = rte_socket_id();
+	int ret = -1;
+
+	ops = (uint64_t)rte_lcore_count() * CACHE_TEST_ITER * CACHE_TEST_BURST;
+
+	if (rte_malloc_cache_enable(RTE_MALLOC_CACHE_MAX_SIZE + 1) != -EINVAL) {
+		printf("%s(): oversized cache accepted\n", __func__);
+		return -1;
+	}
+	rte_malloc_get_socket_stats(socket, &pre);
+	rte_malloc_get_cache_stats(socket, &cache_pre);
+
+	/* baseline: every allocation takes the heap lock */
+	rte_atomic64_clear(&cache_test_cycles);
+	if (run_on_all_lcores(test_cache_alloc_free_per_lcore) < 0)
+		return -1;
+	printf("%u lcores, heap only: %"PRIu64" cycles per alloc/free\n",
+			rte_lcore_count(),
+			rte_atomic64_read(&cache_test_cycles) / ops);
+
+	if (rte_malloc_cache_enable(RTE_MALLOC_CACHE_MAX_SIZE) != 0) {
+		printf("%s(): cannot enable cache\n", __func__);
+		return -1;
+	}
+
+	/* a freed object is handed back by the next same-size allocation */
+	p1 = rte_malloc(NULL, CACHE_TEST_SIZE, 0);
+	rte_free(p1);
+	p2 = rte_malloc(NULL, CACHE_TEST_SIZE, 0);
+	rte_free(p2);
+	if (p1 == NULL || p1 != p2) {
+		printf("%s(): object not reused from cache\n", __func__);
+		goto out;
+	}
+
+	rte_atomic64_clear(&cache_test_cycles);
+	if (run_on_all_lcores(test_cache_alloc_free_per_lcore) < 0)
+		goto out;
+	printf("%u lcores, per-lcore cache: %"PRIu64" cycles per alloc/free\n",
+			rte_lcore_count(),
+			rte_atomic64_read(&cache_test_cycles) / ops);
+
+	rte_malloc_get_cache_stats(socket, &cache_post);
+	hits = misses = 0;
+	for (i = 0; i != RTE_MALLOC_CACHE_NB_CLASSES; i++) {
+		hits += cache_post.cache_hits[i] - cache_pre.cache_hits[i];
+		misses += cache_post.cache_misses[i] -
+				cache_pre.cache_misses[i];
+	}
+	printf("cache hits %"PRIu64", misses %"PRIu64", cached bytes %zu\n",
+			hits, misses, cache_post.cache_sz_bytes);
+	if (hits + misses < ops || hits <= misses ||
+			cache_post.cache_sz_bytes == 0) {
+		printf("%s(): unexpected cache statistics\n", __func__);
+		goto out;
+	}
+	ret = 0;
+
+out:
+	/* return all cached objects, the heap must be back to its state */
+	rte_malloc_cache_enable(0);
+	if (run_on_all_lcores(test_cache_flush_per_lcore) < 0)
+		return -1;
+	rte_malloc_get_socket_stats(socket, &post);
+	rte_malloc_get_cache_stats(socket, &cache_post);
+	if (cache_post.cache_sz_bytes != 0 ||
+			post.alloc_count != pre.alloc_count) {
+		printf("%s(): heap not restored after cache flush\n",
+				__func__);
+		rte_malloc_dump_stats(stdout, NULL);
+		return -1;
+	}
+	return ret;
+}
+
+/*
+ * Memory growth test: when the EAL runs with --mem-grow, add and release a
+ * segment, then allocate until the heap spills into a segment added at
+ * runtime and check that freeing everything gives it back.
+ */
+#define GROW_TEST_ALLOC_SIZE (1 << 20)
+#define GROW_TEST_MAX_ALLOCS 4096
+
+/* return the index of the memory segment holding addr, or -1 */
+static int
+memseg_lookup(const void *addr)
+{
+	const struct rte_memseg *ms = rte_eal_get_physmem_layout();
+	int i;
+
+	for (i = 0; i < RTE_MAX_MEMSEG; i++)
+		if (ms[i].len != 0 && (uintptr_t)addr >= ms[i].addr_64 &&
+				(uintptr_t)addr < ms[i].addr_64 + ms[i].len)
+			return i;
+	return -1;
+}
+
+static int
+test_malloc_grow(void)
+{
+	const struct rte_memseg *ms = rte_eal_get_physmem_layout();
+	struct rte_malloc_socket_stats pre, post;
+	void **objs;
+	unsigned i, n;
+	int socket = rte_socket_id();
+	int idx, ret = -1;
+
+	idx = rte_eal_memseg_grow(socket, 1);
+	if (idx == -ENOTSUP) {
+		printf("memory cannot grow, run with --mem-grow to test it\n");
+		return 0;
+	}
+	if (idx < 0) {
+		printf("%s(): cannot add a segment: %s\n", __func__,
+				strerror(-idx));
+		return -1;
+	}
+	if (ms[idx].addr == NULL || ms[idx].socket_id != socket) {
+		printf("%s(): invalid segment %d\n", __func__, idx);
+		return -1;
+	}
+	memset(ms[idx].addr, 0xa5, ms[idx].len);
+	if (rte_eal_memseg_release(ms[idx].addr) != 0 ||
+			rte_eal_memseg_release(ms[idx].addr) != -EINVAL ||
+			ms[idx].len != 0) {
+		printf("%s(): cannot release segment %d\n", __func__, idx);
+		return -1;
+	}
+
+	objs = calloc(GROW_TEST_MAX_ALLOCS, sizeof(objs[0]));
+	if (objs == NULL)
+		return -1;
+
+	/* the first segment added by the heap reuses the released slot */
+	rte_malloc_get_socket_stats(socket, &pre);
+	for (n = 0; n != GROW_TEST_MAX_ALLOCS; n++) {
+		objs[n] = rte_malloc_socket(NULL, GROW_TEST_ALLOC_SIZE, 0,
+				socket);
+		if (objs[n] == NULL)
+			break;
+		memset(objs[n], 0x5a, GROW_TEST_ALLOC_SIZE);
+		if (memseg_lookup(objs[n]) == idx) {
+			n++;
+			break;
+		}
+	}
+	rte_malloc_get_socket_stats(socket, &post);
+	printf("%u allocations, heap grew from %zu to %zu bytes\n", n,
+			pre.heap_totalsz_bytes, post.heap_totalsz_bytes);
+	if (n == 0 || memseg_lookup(objs[n - 1]) != idx) {
+		printf("%s(): heap did not grow\n", __func__);
+		goto out;
+	}
+	if (rte_malloc_virt2phy(objs[n - 1]) != rte_mem_virt2phy(objs[n - 1])) {
+		printf("%s(): wrong physical address\n", __func__);
+		goto out;
+	}
+	ret = 0;
+
+out:
+	for (i = 0; i != n; i++)
+		rte_free(objs[i]);
+	free(objs);
+
+	rte_malloc_get_socket_stats(socket, &post);
+	if (post.alloc_count != pre.alloc_count) {
+		printf("%s(): allocation leaked\n", __func__);
+		return -1;
+	}
+	if (ret == 0 && ms[idx].len != 0) {
+		printf("%s(): segment %d not released\n", __func__, idx);
+		return -1;
+	}
+	return ret;
+}
+
 static int
 test_malloc(void)
 {
@@ -1042,6 +1298,22 @@ test_malloc(void)
 	else
 		printf("test_multi_alloc_statistics() passed\n");
 
+	ret = test_malloc_grow();
+	if (ret < 0) {
+		printf("test_malloc_grow() failed\n");
+		return ret;
+	}
+	else
+		printf("test_malloc_grow() passed\n");
+
+	ret = test_cache_alloc_free();
+	if (ret < 0) {
+		printf("test_cache_alloc_free() failed\n");
+		return ret;
+	}
+	else
+		printf("test_cache_alloc_free() passed\n");
+
 	return 0;
 }
 
@@ -56,6 +56,7 @@
 #include <rte_mempool.h>
 #include <rte_spinlock.h>
 #include <rte_malloc.h>
+#include <rte_errno.h>
 
 #include "test.h"
 
@@ -79,6 +80,7 @@
 
 static struct rte_mempool *mp;
 static struct rte_mempool *mp_cache, *mp_nocache;
+static struct rte_mempool *mp_stack;
 
 static rte_atomic32_t synchro;
 
@@ -123,7 +125,8 @@ test_mempool_basic(void)
 
 	printf("get private data\n");
 	if (rte_mempool_get_priv(mp) !=
-			(char*) mp + MEMPOOL_HEADER_SIZE(mp, mp->pg_num))
+			(char*) mp + MEMPOOL_HEADER_SIZE(mp, mp->pg_num,
+			mp->cache_size))
 		return -1;
 
 	printf("get physical address of an object\n");
@@ -454,6 +457,115 @@ test_mempool_xmem_misc(void)
 	return (0);
 }
 
+/*
+ * Get and put objects through a user-owned cache, as a non-EAL thread
+ * would do, on a mempool without per-lcore caches.
+ */
+static int
+test_mempool_user_cache(struct rte_mempool *mp_tc)
+{
+	struct rte_mempool_cache *cache;
+	void *obj_table[MAX_KEEP];
+	unsigned i;
+	int ret = -1;
+
+	if (rte_mempool_default_cache(mp_tc, rte_lcore_id()) != NULL) {
+		printf("mempool without cache has a per-lcore cache\n");
+		return -1;
+	}
+
+	if (rte_mempool_cache_create(RTE_MEMPOOL_CACHE_MAX_SIZE + 1,
+			SOCKET_ID_ANY) != NULL || rte_errno != EINVAL) {
+		printf("created a mempool cache larger than the maximum\n");
+		return -1;
+	}
+
+	cache = rte_mempool_cache_create(MAX_KEEP, SOCKET_ID_ANY);
+	if (cache == NULL) {
+		printf("cannot create mempool cache\n");
+		return -1;
+	}
+
+	/* the cache is filled from the common pool on the first get */
+	for (i = 0; i < MAX_KEEP; i++) {
+		if (rte_mempool_generic_get(mp_tc, &obj_table[i], 1,
+				cache, 1) < 0) {
+			printf("cannot get object through the user cache\n");
+			goto fail;
+		}
+	}
+	if (cache->len == 0 || cache->len > cache->flushthresh) {
+		printf("user cache not filled as expected (len=%u)\n",
+			cache->len);
+		goto fail;
+	}
+
+	rte_mempool_generic_put(mp_tc, obj_table, MAX_KEEP, cache, 1);
+	if (cache->len > cache->flushthresh) {
+		printf("user cache not flushed at its threshold\n");
+		goto fail;
+	}
+
+	/* objects in the cache are not in the pool until it is flushed */
+	rte_mempool_cache_flush(cache, mp_tc);
+	if (cache->len != 0 || rte_mempool_count(mp_tc) != MEMPOOL_SIZE) {
+		printf("user cache flush did not return all objects\n");
+		goto fail;
+	}
+
+	ret = 0;
+
+fail:
+	rte_mempool_cache_flush(cache, mp_tc);
+	rte_mempool_cache_free(cache);
+	return ret;
+}
+
+/*
+ * Run the basic tests on mempools using the stack handler, and check that
+ * an unknown handler is refused.
+ */
+static int
+test_mempool_stack_handler(void)
+{
+	struct rte_mempool *mp_tc;
+
+	if (mp_stack == NULL)
+		mp_stack = rte_mempool_create_with_ops("test_stack",
+			MEMPOOL_SIZE, MEMPOOL_ELT_SIZE,
+			RTE_MEMPOOL_CACHE_MAX_SIZE, 0,
+			NULL, NULL, my_obj_init, NULL,
+			SOCKET_ID_ANY, 0, RTE_MEMPOOL_OPS_STACK);
+	if (mp_stack == NULL) {
+		printf("cannot create mempool with stack handler\n");
+		return -1;
+	}
+
+	if (rte_mempool_ops_lookup(RTE_MEMPOOL_OPS_STACK) !=
+			mp_stack->ops_index) {
+		printf("mempool does not use the requested handler\n");
+		return -1;
+	}
+
+	mp = mp_stack;
+	if (test_mempool_basic() < 0)
+		return -1;
+
+	if (test_mempool_basic_ex(mp_stack) < 0)
+		return -1;
+
+	mp_tc = rte_mempool_create_with_ops("test_unknown_handler",
+		MEMPOOL_SIZE, MEMPOOL_ELT_SIZE, 0, 0,
+		NULL, NULL, NULL, NULL,
+		SOCKET_ID_ANY, 0, "no_such_handler");
+	if (mp_tc != NULL || rte_errno != ENOENT) {
+		printf("mempool created with an unknown handler\n");
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 test_mempool(void)
 {
@@ -516,6 +628,12 @@ test_mempool(void)
 	if (test_mempool_xmem_misc() < 0)
 		return -1;
 
+	if (test_mempool_stack_handler() < 0)
+		return -1;
+
+	if (test_mempool_user_cache(mp_nocache) < 0)
+		return -1;
+
 	rte_mempool_list_dump(stdout);
 
 	return 0;
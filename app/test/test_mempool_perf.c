@@ -88,6 +88,13 @@
  *
  *      - 32
  *      - 128
+ *
+ *    Then, the pool handlers (*ops_name*) are compared on a reduced set of
+ *    bulk sizes, with and without cache:
+ *
+ *      - Multi-producer/multi-consumer ring, on 1, 2 and max. cores
+ *      - LIFO stack, on 1, 2 and max. cores
+ *      - Single-producer/single-consumer ring, on one core only
  */
 
 #define N 65536
@@ -161,7 +168,8 @@ per_lcore_mempool_test(__attribute__((unused)) void *arg)
 							   n_get_bulk);
 				if (unlikely(ret < 0)) {
 					rte_mempool_dump(stdout, mp);
-					rte_ring_dump(stdout, mp->ring);
+					if (mp->ring != NULL)
+						rte_ring_dump(stdout, mp->ring);
 					/* in this case, objects are lost... */
 					return -1;
 				}
@@ -198,11 +206,12 @@ launch_cores(unsigned cores)
 	/* reset stats */
 	memset(stats, 0, sizeof(stats));
 
-	printf("mempool_autotest cache=%u cores=%u n_get_bulk=%u "
+	printf("mempool_autotest handler=%s cache=%u cores=%u n_get_bulk=%u "
 	       "n_put_bulk=%u n_keep=%u ",
+	       rte_mempool_get_ops(mp->ops_index)->name,
 	       (unsigned) mp->cache_size, cores, n_get_bulk, n_put_bulk, n_keep);
 
-	if (rte_mempool_count(mp) != MEMPOOL_SIZE) {
+	if (rte_mempool_count(mp) != mp->size) {
 		printf("mempool is not full\n");
 		return -1;
 	}
@@ -272,6 +281,76 @@ do_one_mempool_test(unsigned cores)
 	return 0;
 }
 
+/* for a given number of core, compare handlers on a subset of test cases */
+static int
+do_one_handler_test(unsigned cores)
+{
+	unsigned bulk_tab[] = { 1, 32, 0 };
+	unsigned *bulk_ptr;
+
+	for (bulk_ptr = bulk_tab; *bulk_ptr; bulk_ptr++) {
+		n_get_bulk = *bulk_ptr;
+		n_put_bulk = *bulk_ptr;
+		n_keep = MAX_KEEP;
+		if (launch_cores(cores) < 0)
+			return -1;
+	}
+	return 0;
+}
+
+/* create mempools using the given handler, and run the handler tests */
+static int
+test_mempool_handler_perf(const char *ops_name, int single_core)
+{
+	char name[RTE_MEMPOOL_NAMESIZE];
+	struct rte_mempool *pools[2];
+	unsigned cache_size[2] = { 0, RTE_MEMPOOL_CACHE_MAX_SIZE };
+	unsigned i;
+
+	/*
+	 * Only size the pools for the running lcores, so that they all fit
+	 * in memory: a cache can grow up to 1.5 times its size before being
+	 * flushed.
+	 */
+	unsigned pool_size = rte_lcore_count() *
+		(MAX_KEEP + (RTE_MEMPOOL_CACHE_MAX_SIZE * 3) / 2);
+
+	for (i = 0; i < RTE_DIM(pools); i++) {
+		snprintf(name, sizeof(name), "perf_%s_%u", ops_name,
+			cache_size[i]);
+		pools[i] = rte_mempool_lookup(name);
+		if (pools[i] == NULL)
+			pools[i] = rte_mempool_create_with_ops(name,
+				pool_size, MEMPOOL_ELT_SIZE, cache_size[i],
+				0, NULL, NULL, my_obj_init, NULL,
+				SOCKET_ID_ANY, 0, ops_name);
+		if (pools[i] == NULL) {
+			printf("cannot create mempool with handler %s\n",
+				ops_name);
+			return -1;
+		}
+	}
+
+	printf("start performance test (handler %s)\n", ops_name);
+	for (i = 0; i < RTE_DIM(pools); i++) {
+		mp = pools[i];
+
+		if (do_one_handler_test(1) < 0)
+			return -1;
+
+		if (single_core)
+			continue;
+
+		if (do_one_handler_test(2) < 0)
+			return -1;
+
+		if (do_one_handler_test(rte_lcore_count()) < 0)
+			return -1;
+	}
+
+	return 0;
+}
+
 static int
 test_mempool_perf(void)
 {
@@ -324,6 +403,16 @@ test_mempool_perf(void)
 	if (do_one_mempool_test(rte_lcore_count()) < 0)
 		return -1;
 
+	/* compare the pool handlers */
+	if (test_mempool_handler_perf(RTE_MEMPOOL_OPS_RING_MP_MC, 0) < 0)
+		return -1;
+
+	if (test_mempool_handler_perf(RTE_MEMPOOL_OPS_STACK, 0) < 0)
+		return -1;
+
+	if (test_mempool_handler_perf(RTE_MEMPOOL_OPS_RING_SP_SC, 1) < 0)
+		return -1;
+
 	rte_mempool_list_dump(stdout);
 
 	return 0;
@@ -231,8 +231,10 @@ run_object_creation_tests(void)
 #endif
 
 #ifdef RTE_LIBRTE_LPM
+	const struct rte_lpm_config lpm_config = {
+		.max_rules = size, .number_tbl8s = 256 };
 	rte_errno=0;
-	if ((rte_lpm_create("test_lpm", size, rte_socket_id(), 0) != NULL) &&
+	if ((rte_lpm_create("test_lpm", rte_socket_id(), &lpm_config) != NULL) &&
 	    (rte_lpm_find_existing("test_lpm") == NULL)){
 		printf("Error: unexpected return value from rte_lpm_create()\n");
 		return -1;
@@ -42,6 +42,7 @@
 #include <rte_mbuf.h>
 #include <rte_reorder.h>
 #include <rte_lcore.h>
+#include <rte_launch.h>
 #include <rte_malloc.h>
 
 #include "test.h"
@@ -334,6 +335,177 @@ exit:
 	return ret;
 }
 
+static int
+test_reorder_drain_timeout(void)
+{
+	struct rte_reorder_buffer *b = NULL;
+	struct rte_mempool *p = test_params->p;
+	struct rte_reorder_stats stats;
+	const unsigned int size = 8;
+	const unsigned int num_bufs = 8;
+	struct rte_mbuf *bufs[num_bufs], *out[num_bufs];
+	unsigned i, cnt, mp;
+	int ret;
+
+	ret = rte_mempool_get_bulk(p, (void *)bufs, num_bufs);
+	TEST_ASSERT_SUCCESS(ret, "Error getting mbuf from pool");
+
+	/* same sequence with the single and the multi-producer insert */
+	for (mp = 0; mp < 2; mp++) {
+		b = rte_reorder_create(mp ? "test_timeout_mp" : "test_timeout",
+				rte_socket_id(), size);
+		TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+		rte_reorder_set_timeout(b, rte_get_tsc_hz() / 1000);
+
+		for (i = 0; i < num_bufs; i++)
+			bufs[i]->seqn = i;
+
+		/* OB[] = {0, 1, NULL, 3, 4, NULL, NULL, NULL} */
+		for (i = 0; i < 5; i++) {
+			if (i == 2)
+				continue;
+			ret = mp ? rte_reorder_insert_mp(b, bufs[i]) :
+				rte_reorder_insert(b, bufs[i]);
+			TEST_ASSERT_SUCCESS(ret, "Error inserting packet %u", i);
+		}
+
+		/* the drain waits for 2 until the timeout */
+		cnt = rte_reorder_drain(b, out, num_bufs);
+		TEST_ASSERT_EQUAL(cnt, 2, "%u packets drained, expected 2", cnt);
+		cnt = rte_reorder_drain(b, out, num_bufs);
+		TEST_ASSERT_EQUAL(cnt, 0, "Missing packet not waited for");
+
+		rte_delay_ms(2);
+		cnt = rte_reorder_drain(b, out, num_bufs);
+		TEST_ASSERT_EQUAL(cnt, 2, "%u packets drained after timeout, "
+				"expected 2", cnt);
+		TEST_ASSERT(out[0] == bufs[3] && out[1] == bufs[4],
+				"Wrong packets drained after timeout");
+
+		/* 2 is now late */
+		ret = mp ? rte_reorder_insert_mp(b, bufs[2]) :
+			rte_reorder_insert(b, bufs[2]);
+		TEST_ASSERT(ret == -1 && rte_errno == ERANGE,
+				"No error inserting skipped packet");
+
+		/* nothing is skipped when no packet is waiting */
+		rte_delay_ms(2);
+		cnt = rte_reorder_drain(b, out, num_bufs);
+		rte_delay_ms(2);
+		cnt += rte_reorder_drain(b, out, num_bufs);
+		TEST_ASSERT_EQUAL(cnt, 0, "Packets drained from empty buffer");
+
+		if (mp) {
+			/* duplicate and too early packets are rejected */
+			ret = rte_reorder_insert_mp(b, bufs[5]);
+			TEST_ASSERT_SUCCESS(ret, "Error inserting packet 5");
+			ret = rte_reorder_insert_mp(b, bufs[5]);
+			TEST_ASSERT(ret == -1 && rte_errno == EEXIST,
+					"No error inserting duplicate packet");
+			bufs[6]->seqn = 5 + size;
+			ret = rte_reorder_insert_mp(b, bufs[6]);
+			TEST_ASSERT(ret == -1 && rte_errno == ENOSPC,
+					"No error inserting early packet");
+			cnt = rte_reorder_drain(b, out, num_bufs);
+			TEST_ASSERT(cnt == 1 && out[0] == bufs[5],
+					"Packet 5 not drained");
+		}
+
+		rte_reorder_stats_get(b, &stats);
+		TEST_ASSERT(stats.late == 1 && stats.skipped == 1 &&
+				stats.dropped == (mp ? 2 : 0),
+				"Wrong stats: late %"PRIu64", skipped %"PRIu64
+				", dropped %"PRIu64, stats.late, stats.skipped,
+				stats.dropped);
+		rte_reorder_stats_reset(b);
+		rte_reorder_stats_get(b, &stats);
+		TEST_ASSERT(stats.late == 0 && stats.skipped == 0 &&
+				stats.dropped == 0, "Stats not reset");
+
+		rte_reorder_free(b);
+	}
+
+	rte_mempool_put_bulk(p, (void *)bufs, num_bufs);
+	return 0;
+}
+
+#define MP_NUM_PKTS 4096
+#define MP_REORDER_SIZE 256
+
+static struct rte_mbuf *mp_bufs[MP_NUM_PKTS];
+static unsigned mp_num_workers;
+static volatile unsigned mp_worker_idx;
+
+/* inserts the packets whose sequence numbers belong to this worker, in
+ * reverse order within each group of 8, retrying when they are too early */
+static int
+reorder_mp_worker(void *arg)
+{
+	struct rte_reorder_buffer *b = arg;
+	const unsigned id = __sync_fetch_and_add(&mp_worker_idx, 1);
+	unsigned i, j;
+
+	for (i = id * 8; i < MP_NUM_PKTS; i += mp_num_workers * 8)
+		for (j = 8; j-- > 0; )
+			while (rte_reorder_insert_mp(b, mp_bufs[i + j]) != 0) {
+				if (rte_errno != ENOSPC)
+					return -1;
+				rte_pause();
+			}
+	return 0;
+}
+
+static int
+test_reorder_insert_mp(void)
+{
+	struct rte_reorder_buffer *b;
+	struct rte_mempool *p = test_params->p;
+	struct rte_mbuf *out[BURST];
+	unsigned lcore_id, i, cnt, total = 0;
+	uint32_t next_seqn = 0;
+	uint64_t deadline;
+	int ret = 0;
+
+	if (rte_lcore_count() < 2) {
+		printf("Not enough cores for the multi-producer test, skipping\n");
+		return 0;
+	}
+
+	b = rte_reorder_create("test_insert_mp", rte_socket_id(),
+			MP_REORDER_SIZE);
+	TEST_ASSERT_NOT_NULL(b, "Failed to create reorder buffer");
+	TEST_ASSERT_SUCCESS(rte_mempool_get_bulk(p, (void *)mp_bufs,
+			MP_NUM_PKTS), "Error getting mbuf from pool");
+	for (i = 0; i < MP_NUM_PKTS; i++)
+		mp_bufs[i]->seqn = i;
+
+	mp_num_workers = rte_lcore_count() - 1;
+	mp_worker_idx = 0;
+	rte_eal_mp_remote_launch(reorder_mp_worker, b, SKIP_MASTER);
+
+	/* drain concurrently with the inserts, checking the order */
+	deadline = rte_get_tsc_cycles() + 10 * rte_get_tsc_hz();
+	while (total < MP_NUM_PKTS && rte_get_tsc_cycles() < deadline) {
+		cnt = rte_reorder_drain(b, out, BURST);
+		for (i = 0; i < cnt; i++)
+			if (out[i]->seqn != next_seqn++)
+				ret = -1;
+		total += cnt;
+	}
+
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) != 0)
+			ret = -1;
+
+	rte_mempool_put_bulk(p, (void *)mp_bufs, MP_NUM_PKTS);
+	rte_reorder_free(b);
+
+	TEST_ASSERT_EQUAL(total, MP_NUM_PKTS, "%u packets drained, expected %u",
+			total, MP_NUM_PKTS);
+	TEST_ASSERT_SUCCESS(ret, "Packets drained out of order");
+	return 0;
+}
+
 static int
 test_setup(void)
 {
@@ -372,6 +544,8 @@ static struct unit_test_suite reorder_test_suite  = {
 		TEST_CASE(test_reorder_free),
 		TEST_CASE(test_reorder_insert),
 		TEST_CASE(test_reorder_drain),
+		TEST_CASE(test_reorder_drain_timeout),
+		TEST_CASE(test_reorder_insert_mp),
 		TEST_CASES_END()
 	}
 };
@@ -93,6 +93,27 @@
  *    - At the same time, change the watermark on the master lcore.
  *    - The slave lcore will check that watermark changes from 16 to 32.
  *
+ * #. Synchronization modes
+ *
+ *    - Check enqueue/dequeue with the RTS and HTS modes, alone or mixed
+ *      with the default ones, and that conflicting flags are rejected.
+ *    - All lcores move objects out of a ring and back in it, with each
+ *      synchronization mode. Check that no object is lost or duplicated.
+ *
+ * #. Zero-copy API
+ *
+ *    - Enqueue and dequeue in place with single and HTS producers and
+ *      consumers, committing less objects than reserved, across the end
+ *      of the ring. Check the other modes reserve nothing.
+ *    - Same multi-thread check as above, moving objects in place.
+ *
+ * #. Rings of objects of any size
+ *
+ *    - Enqueue and dequeue bulks and bursts of random sizes of 4 to 20
+ *      bytes objects, with each synchronization mode. Check the objects
+ *      content, the water mark, and that a full ring truncates bursts.
+ *    - Check that invalid object sizes are rejected.
+ *
  * #. Performance tests.
  *
  * Tests done in test_ring_perf.c
@@ -1321,6 +1342,533 @@ fail_test:
 	return ret;
 }
 
+/*
+ * Synchronization modes tests
+ */
+#define SYNC_RING_SIZE 64
+#define SYNC_ITERATIONS 20000
+
+static const unsigned sync_flags[] = {
+	RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ,
+	RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ,
+	RING_F_MP_RTS_ENQ | RING_F_MC_HTS_DEQ,
+	RING_F_MP_HTS_ENQ | RING_F_SC_DEQ,
+	RING_F_SP_ENQ | RING_F_MC_RTS_DEQ,
+};
+
+#define NUM_SYNC_FLAGS (sizeof(sync_flags) / sizeof(sync_flags[0]))
+
+static struct rte_ring *sync_ring;
+
+static int
+test_ring_sync_modes_basic(struct rte_ring *r)
+{
+	void *src[SYNC_RING_SIZE], *dst[SYNC_RING_SIZE];
+	uintptr_t next_in = 0, next_out = 0;
+	unsigned i, j, n;
+	int ret;
+
+	/* partial enqueues/dequeues, so that indexes wrap around */
+	for (i = 0; i < 1000; i++) {
+		n = 1 + i % (SYNC_RING_SIZE / 2);
+		for (j = 0; j < n; j++)
+			src[j] = (void *)(next_in + j);
+		ret = rte_ring_enqueue_bulk(r, src, n);
+		TEST_RING_VERIFY(ret == 0);
+		next_in += n;
+
+		ret = rte_ring_dequeue_bulk(r, dst, n);
+		TEST_RING_VERIFY(ret == 0);
+		for (j = 0; j < n; j++)
+			TEST_RING_VERIFY(dst[j] == (void *)(next_out + j));
+		next_out += n;
+	}
+
+	/* fill the ring, bulk fails and burst is truncated when full */
+	for (j = 0; j < SYNC_RING_SIZE; j++)
+		src[j] = (void *)(next_in + j);
+	ret = rte_ring_enqueue_burst(r, src, SYNC_RING_SIZE);
+	TEST_RING_VERIFY(ret == SYNC_RING_SIZE - 1);
+	next_in += ret;
+	TEST_RING_VERIFY(rte_ring_full(r));
+	TEST_RING_VERIFY(rte_ring_enqueue(r, src[0]) == -ENOBUFS);
+	TEST_RING_VERIFY(rte_ring_enqueue_burst(r, src, 1) == 0);
+
+	TEST_RING_VERIFY(rte_ring_dequeue_bulk(r, dst, SYNC_RING_SIZE) ==
+			-ENOENT);
+	ret = rte_ring_dequeue_burst(r, dst, SYNC_RING_SIZE);
+	TEST_RING_VERIFY(ret == SYNC_RING_SIZE - 1);
+	for (j = 0; j < (unsigned)ret; j++)
+		TEST_RING_VERIFY(dst[j] == (void *)(next_out + j));
+	TEST_RING_VERIFY(rte_ring_empty(r));
+	TEST_RING_VERIFY(rte_ring_dequeue(r, dst) == -ENOENT);
+
+	return 0;
+}
+
+static int
+sync_mover(__attribute__((unused)) void *arg)
+{
+	void *objs[MAX_BULK];
+	unsigned i, n;
+
+	while (rte_atomic32_read(&synchro) == 0)
+		rte_pause();
+
+	for (i = 0; i < SYNC_ITERATIONS; i++) {
+		n = rte_ring_dequeue_burst(sync_ring, objs, 1 + i % MAX_BULK);
+		if (n != 0 && rte_ring_enqueue_bulk(sync_ring, objs, n) != 0)
+			return -1;
+	}
+	return 0;
+}
+
+/* move objects out of a HTS ring and back in it, in place */
+static int
+sync_mover_zc(__attribute__((unused)) void *arg)
+{
+	struct rte_ring_zc_data zcd;
+	void *objs[MAX_BULK];
+	unsigned i, j, n;
+
+	while (rte_atomic32_read(&synchro) == 0)
+		rte_pause();
+
+	for (i = 0; i < SYNC_ITERATIONS; i++) {
+		n = rte_ring_dequeue_zc_burst_start(sync_ring, 1 + i % MAX_BULK,
+				&zcd);
+		if (n == 0)
+			continue;
+		for (j = 0; j < n; j++)
+			objs[j] = j < zcd.n1 ? zcd.ptr1[j] :
+				zcd.ptr2[j - zcd.n1];
+		rte_ring_dequeue_zc_finish(sync_ring, n);
+
+		if (rte_ring_enqueue_zc_bulk_start(sync_ring, n, &zcd) != n)
+			return -1;
+		for (j = 0; j < n; j++) {
+			if (j < zcd.n1)
+				zcd.ptr1[j] = objs[j];
+			else
+				zcd.ptr2[j - zcd.n1] = objs[j];
+		}
+		rte_ring_enqueue_zc_finish(sync_ring, n);
+	}
+	return 0;
+}
+
+static int
+test_ring_sync_modes_mt(lcore_function_t *mover)
+{
+	uint8_t seen[SYNC_RING_SIZE / 2];
+	void *obj;
+	unsigned lcore_id;
+	uintptr_t v;
+	int ret = 0;
+
+	/* half full, so that the movers never wait for room */
+	for (v = 0; v < SYNC_RING_SIZE / 2; v++)
+		if (rte_ring_enqueue(sync_ring, (void *)v) != 0)
+			return -1;
+
+	rte_atomic32_set(&synchro, 0);
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		rte_eal_remote_launch(mover, NULL, lcore_id);
+	rte_atomic32_set(&synchro, 1);
+	if (mover(NULL) < 0)
+		ret = -1;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id)
+		if (rte_eal_wait_lcore(lcore_id) < 0)
+			ret = -1;
+	if (ret < 0) {
+		printf("%s: enqueue failed\n", __func__);
+		return -1;
+	}
+
+	memset(seen, 0, sizeof(seen));
+	while (rte_ring_dequeue(sync_ring, &obj) == 0) {
+		v = (uintptr_t)obj;
+		if (v >= SYNC_RING_SIZE / 2 || seen[v]) {
+			printf("%s: bad or duplicated object %"PRIuPTR"\n",
+					__func__, v);
+			return -1;
+		}
+		seen[v] = 1;
+	}
+	for (v = 0; v < SYNC_RING_SIZE / 2; v++) {
+		if (!seen[v]) {
+			printf("%s: lost object %"PRIuPTR"\n", __func__, v);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static int
+test_ring_sync_modes(void)
+{
+	struct rte_ring *rp;
+	char name[RTE_RING_NAMESIZE];
+	unsigned i;
+
+	/* conflicting flags */
+	rp = rte_ring_create("test_sync_bad", SYNC_RING_SIZE, SOCKET_ID_ANY,
+			RING_F_SP_ENQ | RING_F_MP_RTS_ENQ);
+	if (rp != NULL || rte_errno != EINVAL) {
+		printf("%s: conflicting producer flags accepted\n", __func__);
+		return -1;
+	}
+	rp = rte_ring_create("test_sync_bad", SYNC_RING_SIZE, SOCKET_ID_ANY,
+			RING_F_MC_RTS_DEQ | RING_F_MC_HTS_DEQ);
+	if (rp != NULL || rte_errno != EINVAL) {
+		printf("%s: conflicting consumer flags accepted\n", __func__);
+		return -1;
+	}
+
+	for (i = 0; i < NUM_SYNC_FLAGS; i++) {
+		snprintf(name, sizeof(name), "test_sync_%u", i);
+		rp = rte_ring_lookup(name);
+		if (rp == NULL)
+			rp = rte_ring_create(name, SYNC_RING_SIZE,
+					SOCKET_ID_ANY, sync_flags[i]);
+		if (rp == NULL) {
+			printf("%s: cannot create ring %s\n", __func__, name);
+			return -1;
+		}
+
+		/* the head-tail distance can only be set in RTS mode */
+		if ((rte_ring_set_prod_htd_max(rp, 8) == 0) !=
+				((sync_flags[i] & RING_F_MP_RTS_ENQ) != 0) ||
+				(rte_ring_set_cons_htd_max(rp, 8) == 0) !=
+				((sync_flags[i] & RING_F_MC_RTS_DEQ) != 0)) {
+			printf("%s: bad htd_max result for %s\n",
+					__func__, name);
+			return -1;
+		}
+		if (rte_ring_set_prod_htd_max(rp, 0) != -EINVAL &&
+				(sync_flags[i] & RING_F_MP_RTS_ENQ)) {
+			printf("%s: htd_max 0 accepted\n", __func__);
+			return -1;
+		}
+
+		if (test_ring_sync_modes_basic(rp) < 0) {
+			printf("%s: basic test failed for %s\n",
+					__func__, name);
+			return -1;
+		}
+
+		/* multi-thread test for multi producers and consumers */
+		if ((sync_flags[i] & (RING_F_SP_ENQ | RING_F_SC_DEQ)) != 0)
+			continue;
+		sync_ring = rp;
+		if (test_ring_sync_modes_mt(sync_mover) < 0) {
+			printf("%s: multi-thread test failed for %s\n",
+					__func__, name);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Zero-copy API tests
+ */
+static int
+test_ring_zc_basic(struct rte_ring *r)
+{
+	struct rte_ring_zc_data zcd;
+	uintptr_t next_in = 0, next_out = 0;
+	unsigned i, j, k, n, wraps = 0;
+	void *obj;
+
+	for (i = 0; i < 1000; i++) {
+		/* enqueue in place, sometimes less than reserved */
+		k = 1 + rte_rand() % MAX_BULK;
+		n = rte_ring_enqueue_zc_bulk_start(r, k, &zcd);
+		if (n == 0) {
+			TEST_RING_VERIFY(rte_ring_free_count(r) < k);
+		} else {
+			TEST_RING_VERIFY(n == k);
+			TEST_RING_VERIFY(zcd.n1 <= n);
+			TEST_RING_VERIFY((zcd.ptr2 != NULL) == (zcd.n1 < n));
+			if (zcd.ptr2 != NULL)
+				wraps++;
+			for (j = 0; j < n; j++) {
+				if (j < zcd.n1)
+					zcd.ptr1[j] = (void *)(next_in + j);
+				else
+					zcd.ptr2[j - zcd.n1] =
+						(void *)(next_in + j);
+			}
+			if (i % 3 == 0)
+				n--;
+			rte_ring_enqueue_zc_finish(r, n);
+			next_in += n;
+		}
+		TEST_RING_VERIFY(rte_ring_count(r) == next_in - next_out);
+
+		/* inspect in place, take only some of the objects */
+		k = 1 + rte_rand() % MAX_BULK;
+		n = rte_ring_dequeue_zc_burst_start(r, k, &zcd);
+		TEST_RING_VERIFY(n == RTE_MIN(k, next_in - next_out));
+		if (n == 0)
+			continue;
+		for (j = 0; j < n; j++)
+			TEST_RING_VERIFY((j < zcd.n1 ? zcd.ptr1[j] :
+					zcd.ptr2[j - zcd.n1]) ==
+					(void *)(next_out + j));
+		n -= n / 4;
+		rte_ring_dequeue_zc_finish(r, n);
+		next_out += n;
+		TEST_RING_VERIFY(rte_ring_count(r) == next_in - next_out);
+	}
+
+	/* the default dequeue goes on after the zero-copy one */
+	if (next_in != next_out) {
+		TEST_RING_VERIFY(rte_ring_dequeue(r, &obj) == 0);
+		TEST_RING_VERIFY(obj == (void *)next_out);
+	}
+	TEST_RING_VERIFY(wraps > 0);
+
+	return 0;
+}
+
+static int
+test_ring_zc(void)
+{
+	static const unsigned zc_flags[] = {
+		RING_F_SP_ENQ | RING_F_SC_DEQ,
+		RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ,
+		RING_F_SP_ENQ | RING_F_MC_HTS_DEQ,
+	};
+	struct rte_ring_zc_data zcd;
+	struct rte_ring *rp;
+	char name[RTE_RING_NAMESIZE];
+	void *obj = NULL;
+	unsigned i;
+
+	for (i = 0; i < sizeof(zc_flags) / sizeof(zc_flags[0]); i++) {
+		snprintf(name, sizeof(name), "test_zc_%u", i);
+		rp = rte_ring_lookup(name);
+		if (rp == NULL)
+			rp = rte_ring_create(name, SYNC_RING_SIZE,
+					SOCKET_ID_ANY, zc_flags[i]);
+		if (rp == NULL) {
+			printf("%s: cannot create ring %s\n", __func__, name);
+			return -1;
+		}
+		if (test_ring_zc_basic(rp) < 0) {
+			printf("%s: basic test failed for %s\n",
+					__func__, name);
+			return -1;
+		}
+		/* empty it for the next run */
+		while (rte_ring_dequeue(rp, &obj) == 0)
+			;
+	}
+
+	/* the other modes reserve nothing */
+	rp = rte_ring_lookup("test_sync_0");
+	if (rp == NULL || rte_ring_enqueue(rp, obj) != 0 ||
+			rte_ring_enqueue_zc_burst_start(rp, 1, &zcd) != 0 ||
+			rte_ring_dequeue_zc_burst_start(rp, 1, &zcd) != 0 ||
+			rte_ring_dequeue(rp, &obj) != 0) {
+		printf("%s: RTS ring reserved slots\n", __func__);
+		return -1;
+	}
+
+	/* multi-thread, in place */
+	sync_ring = rte_ring_lookup("test_zc_1");
+	if (test_ring_sync_modes_mt(sync_mover_zc) < 0) {
+		printf("%s: multi-thread test failed\n", __func__);
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Rings of objects of any size
+ */
+#define ELEM_MAX_SIZE 20
+
+/* each 4 bytes word of an object holds its sequence number and position */
+static void
+elem_fill(uint32_t *obj, unsigned esize, uint32_t seq, unsigned n)
+{
+	unsigned i, w;
+
+	for (i = 0; i < n; i++)
+		for (w = 0; w < esize / 4; w++)
+			*obj++ = ((seq + i) << 8) | w;
+}
+
+static int
+elem_check(const uint32_t *obj, unsigned esize, uint32_t seq, unsigned n)
+{
+	unsigned i, w;
+
+	for (i = 0; i < n; i++)
+		for (w = 0; w < esize / 4; w++)
+			if (*obj++ != (((seq + i) << 8) | w))
+				return -1;
+	return 0;
+}
+
+static int
+test_ring_elem_basic(struct rte_ring *r, unsigned esize)
+{
+	uint32_t src[SYNC_RING_SIZE * ELEM_MAX_SIZE / 4];
+	uint32_t dst[SYNC_RING_SIZE * ELEM_MAX_SIZE / 4];
+	uint32_t next_in = 0, next_out = 0;
+	unsigned i, k, n, avail;
+	int ret;
+
+	/* random bulk and burst sizes, so that indexes wrap around */
+	for (i = 0; i < 1000; i++) {
+		k = 1 + rte_rand() % MAX_BULK;
+		avail = rte_ring_free_count(r);
+		elem_fill(src, esize, next_in, k);
+		if (i % 2 == 0) {
+			ret = rte_ring_enqueue_bulk_elem(r, src, esize, k);
+			if (k > avail) {
+				TEST_RING_VERIFY(ret == -ENOBUFS);
+				n = 0;
+			} else {
+				TEST_RING_VERIFY(ret == 0);
+				n = k;
+			}
+		} else {
+			n = rte_ring_enqueue_burst_elem(r, src, esize, k);
+			TEST_RING_VERIFY(n == RTE_MIN(k, avail));
+		}
+		next_in += n;
+		TEST_RING_VERIFY(rte_ring_count(r) == next_in - next_out);
+
+		k = 1 + rte_rand() % MAX_BULK;
+		avail = rte_ring_count(r);
+		if (i % 3 == 0) {
+			ret = rte_ring_dequeue_bulk_elem(r, dst, esize, k);
+			if (k > avail) {
+				TEST_RING_VERIFY(ret == -ENOENT);
+				n = 0;
+			} else {
+				TEST_RING_VERIFY(ret == 0);
+				n = k;
+			}
+		} else {
+			n = rte_ring_dequeue_burst_elem(r, dst, esize, k);
+			TEST_RING_VERIFY(n == RTE_MIN(k, avail));
+		}
+		TEST_RING_VERIFY(elem_check(dst, esize, next_out, n) == 0);
+		next_out += n;
+	}
+
+	/* drain the ring, one object at a time */
+	while (rte_ring_dequeue_elem(r, dst, esize) == 0) {
+		TEST_RING_VERIFY(elem_check(dst, esize, next_out, 1) == 0);
+		next_out++;
+	}
+	TEST_RING_VERIFY(next_in == next_out);
+	TEST_RING_VERIFY(rte_ring_empty(r));
+
+	/* the water mark is honoured */
+	TEST_RING_VERIFY(rte_ring_set_water_mark(r, SYNC_RING_SIZE / 2) == 0);
+	elem_fill(src, esize, next_in, SYNC_RING_SIZE / 2);
+	TEST_RING_VERIFY(rte_ring_enqueue_bulk_elem(r, src, esize,
+			SYNC_RING_SIZE / 2 - 1) == 0);
+	TEST_RING_VERIFY(rte_ring_enqueue_elem(r,
+			&src[(SYNC_RING_SIZE / 2 - 1) * esize / 4], esize) ==
+			-EDQUOT);
+	TEST_RING_VERIFY(rte_ring_set_water_mark(r, 0) == 0);
+	next_in += SYNC_RING_SIZE / 2;
+
+	/* fill the ring, bulk fails and burst is truncated when full */
+	elem_fill(src, esize, next_in, SYNC_RING_SIZE);
+	TEST_RING_VERIFY(rte_ring_enqueue_bulk_elem(r, src, esize,
+			SYNC_RING_SIZE) == -ENOBUFS);
+	n = rte_ring_enqueue_burst_elem(r, src, esize, SYNC_RING_SIZE);
+	TEST_RING_VERIFY(n == SYNC_RING_SIZE / 2 - 1);
+	TEST_RING_VERIFY(rte_ring_full(r));
+	next_in += n;
+
+	n = rte_ring_dequeue_burst_elem(r, dst, esize, SYNC_RING_SIZE);
+	TEST_RING_VERIFY(n == next_in - next_out);
+	TEST_RING_VERIFY(elem_check(dst, esize, next_out, n) == 0);
+	TEST_RING_VERIFY(rte_ring_empty(r));
+
+	return 0;
+}
+
+static int
+test_ring_elem(void)
+{
+	static const unsigned elem_sizes[] = { 4, 8, 12, 16, ELEM_MAX_SIZE };
+	uint32_t obj[ELEM_MAX_SIZE / sizeof(uint32_t)];
+	struct rte_ring_zc_data zcd;
+	struct rte_ring *rp;
+	char name[RTE_RING_NAMESIZE];
+	unsigned i;
+
+	for (i = 0; i < sizeof(elem_sizes) / sizeof(elem_sizes[0]); i++) {
+		snprintf(name, sizeof(name), "test_elem_%u", i);
+		rp = rte_ring_lookup(name);
+		if (rp == NULL)
+			rp = rte_ring_create_elem(name, elem_sizes[i],
+					SYNC_RING_SIZE, SOCKET_ID_ANY,
+					sync_flags[i % NUM_SYNC_FLAGS]);
+		if (rp == NULL) {
+			printf("%s: cannot create ring %s\n", __func__, name);
+			return -1;
+		}
+		if (test_ring_elem_basic(rp, elem_sizes[i]) < 0) {
+			printf("%s: basic test failed for %u bytes objects\n",
+					__func__, elem_sizes[i]);
+			rte_ring_dump(stdout, rp);
+			return -1;
+		}
+	}
+
+	/* the object size must be a multiple of 4 */
+	if (rte_ring_get_memsize_elem(0, SYNC_RING_SIZE) != -EINVAL ||
+			rte_ring_get_memsize_elem(6, SYNC_RING_SIZE) != -EINVAL ||
+			rte_ring_create_elem("test_elem_bad", 6, SYNC_RING_SIZE,
+				SOCKET_ID_ANY, 0) != NULL) {
+		printf("%s: invalid object size accepted\n", __func__);
+		return -1;
+	}
+	if (rte_ring_get_memsize_elem(sizeof(void *), SYNC_RING_SIZE) !=
+			rte_ring_get_memsize(SYNC_RING_SIZE)) {
+		printf("%s: wrong memory size\n", __func__);
+		return -1;
+	}
+
+	/* the zero-copy API reserves nothing on rings of other objects */
+	rp = rte_ring_lookup("test_elem_zc");
+	if (rp == NULL)
+		rp = rte_ring_create_elem("test_elem_zc", ELEM_MAX_SIZE,
+				SYNC_RING_SIZE, SOCKET_ID_ANY,
+				RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (rp == NULL) {
+		printf("%s: cannot create ring test_elem_zc\n", __func__);
+		return -1;
+	}
+	elem_fill(obj, ELEM_MAX_SIZE, 0, 1);
+	if (rte_ring_enqueue_bulk_elem(rp, obj, ELEM_MAX_SIZE, 1) != 0 ||
+			rte_ring_enqueue_zc_burst_start(rp, 1, &zcd) != 0 ||
+			rte_ring_dequeue_zc_burst_start(rp, 1, &zcd) != 0 ||
+			rte_ring_dequeue_bulk_elem(rp, obj, ELEM_MAX_SIZE,
+				1) != 0 ||
+			elem_check(obj, ELEM_MAX_SIZE, 0, 1) != 0) {
+		printf("%s: zero-copy API used on a ring of %u bytes "
+			"objects\n", __func__, ELEM_MAX_SIZE);
+		return -1;
+	}
+
+	return 0;
+}
+
 static int
 test_ring(void)
 {
@@ -1386,6 +1934,17 @@ test_ring(void)
 	if (test_ring_creation_with_an_used_name() < 0)
 		return -1;
 
+	/* RTS and HTS synchronization modes */
+	if (test_ring_sync_modes() < 0)
+		return -1;
+
+	/* zero-copy API */
+	if (test_ring_zc() < 0)
+		return -1;
+
+	if (test_ring_elem() < 0)
+		return -1;
+
 	/* dump the ring status */
 	rte_ring_list_dump(stdout);
 
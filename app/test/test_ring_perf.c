@@ -48,6 +48,10 @@
  *  * Empty ring dequeue
  *  * Enqueue/dequeue of bursts in 1 threads
  *  * Enqueue/dequeue of bursts in 2 threads
+ *  * Enqueue/dequeue of bulks of 4 to 32 bytes objects in 1 thread
+ *  * Enqueue/dequeue of bursts in all threads, for each multi-thread
+ *    synchronization mode. Run it with more lcores than cores, e.g.
+ *    --lcores='(0-7)@(0-3)', to see the effect of preemption.
  */
 
 #define RING_NAME "RING_PERF"
@@ -381,6 +385,187 @@ test_bulk_enqueue_dequeue(void)
 	}
 }
 
+/*
+ * Rings of objects of any size, on a single lcore. The object size is a
+ * constant in each instance of the loop, as in real users.
+ */
+#define ELEM_RING_SIZE 1024
+#define ELEM_MAX_SIZE 32
+
+static inline void __attribute__((always_inline))
+test_elem_bulk(struct rte_ring *er, const unsigned esize)
+{
+	const unsigned iterations = 1 << 20;
+	unsigned sz, i;
+	uint32_t burst[MAX_BURST * ELEM_MAX_SIZE / sizeof(uint32_t)] = {0};
+
+	for (sz = 0; sz < sizeof(bulk_sizes)/sizeof(bulk_sizes[0]); sz++) {
+		const uint64_t sc_start = rte_rdtsc();
+		for (i = 0; i < iterations; i++) {
+			rte_ring_sp_enqueue_bulk_elem(er, burst, esize,
+					bulk_sizes[sz]);
+			rte_ring_sc_dequeue_bulk_elem(er, burst, esize,
+					bulk_sizes[sz]);
+		}
+		const uint64_t sc_end = rte_rdtsc();
+
+		const uint64_t mc_start = rte_rdtsc();
+		for (i = 0; i < iterations; i++) {
+			rte_ring_mp_enqueue_bulk_elem(er, burst, esize,
+					bulk_sizes[sz]);
+			rte_ring_mc_dequeue_bulk_elem(er, burst, esize,
+					bulk_sizes[sz]);
+		}
+		const uint64_t mc_end = rte_rdtsc();
+
+		printf("%2u bytes SP/SC bulk enq/dequeue (size: %u): %.2F\n",
+				esize, bulk_sizes[sz],
+				(double)(sc_end - sc_start) /
+				((double)iterations * bulk_sizes[sz]));
+		printf("%2u bytes MP/MC bulk enq/dequeue (size: %u): %.2F\n",
+				esize, bulk_sizes[sz],
+				(double)(mc_end - mc_start) /
+				((double)iterations * bulk_sizes[sz]));
+	}
+}
+
+static int
+test_elem_sizes(void)
+{
+	static const unsigned elem_sizes[] = { 4, 8, 16, ELEM_MAX_SIZE };
+	struct rte_ring *er;
+	char name[RTE_RING_NAMESIZE];
+	unsigned i;
+
+	for (i = 0; i < sizeof(elem_sizes)/sizeof(elem_sizes[0]); i++) {
+		snprintf(name, sizeof(name), "%s_ELEM_%u", RING_NAME,
+				elem_sizes[i]);
+		er = rte_ring_lookup(name);
+		if (er == NULL)
+			er = rte_ring_create_elem(name, elem_sizes[i],
+					ELEM_RING_SIZE, rte_socket_id(), 0);
+		if (er == NULL)
+			return -1;
+
+		switch (elem_sizes[i]) {
+		case 4:
+			test_elem_bulk(er, 4);
+			break;
+		case 8:
+			test_elem_bulk(er, 8);
+			break;
+		case 16:
+			test_elem_bulk(er, 16);
+			break;
+		default:
+			test_elem_bulk(er, ELEM_MAX_SIZE);
+			break;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Multi-thread synchronization modes compared with all lcores doing
+ * enqueue/dequeue bursts on the same ring at once.
+ */
+struct sync_mode {
+	const char *name;
+	unsigned flags;
+};
+
+static const struct sync_mode sync_modes[] = {
+	{ "MP/MC", 0 },
+	{ "MP/MC RTS", RING_F_MP_RTS_ENQ | RING_F_MC_RTS_DEQ },
+	{ "MP/MC HTS", RING_F_MP_HTS_ENQ | RING_F_MC_HTS_DEQ },
+};
+
+#define SYNC_ITERATIONS (1 << 16)
+
+static struct rte_ring *sync_r;
+static uint64_t sync_cycles[RTE_MAX_LCORE];
+
+static int
+sync_enqueue_dequeue(void *p)
+{
+	const unsigned size = *(const unsigned *)p;
+	const unsigned nb_lcores = rte_lcore_count();
+	unsigned i, n;
+	void *burst[MAX_BURST] = {0};
+
+	if (__sync_add_and_fetch(&lcore_count, 1) != nb_lcores)
+		while (lcore_count != nb_lcores)
+			rte_pause();
+
+	const uint64_t start = rte_rdtsc();
+	for (i = 0; i < SYNC_ITERATIONS; i++) {
+		n = rte_ring_enqueue_burst(sync_r, burst, size);
+		rte_ring_dequeue_burst(sync_r, burst, n);
+	}
+	const uint64_t end = rte_rdtsc();
+
+	sync_cycles[rte_lcore_id()] = end - start;
+	return 0;
+}
+
+/* Number of CPUs the lcores run on. */
+static unsigned
+get_nb_cpus(void)
+{
+	unsigned cpu, lcore_id, nb_cpus = 0;
+
+	for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+		RTE_LCORE_FOREACH(lcore_id) {
+			if (CPU_ISSET(cpu, &lcore_config[lcore_id].cpuset)) {
+				nb_cpus++;
+				break;
+			}
+		}
+	}
+	return nb_cpus;
+}
+
+static int
+test_sync_modes(void)
+{
+	unsigned i, sz, lcore_id, size;
+	uint64_t max_cycles;
+	char name[RTE_RING_NAMESIZE];
+
+	printf("%u lcores on %u cpus\n", rte_lcore_count(), get_nb_cpus());
+
+	for (i = 0; i < sizeof(sync_modes)/sizeof(sync_modes[0]); i++) {
+		snprintf(name, sizeof(name), "%s_%u", RING_NAME, i);
+		sync_r = rte_ring_lookup(name);
+		if (sync_r == NULL)
+			sync_r = rte_ring_create(name, RING_SIZE,
+					rte_socket_id(), sync_modes[i].flags);
+		if (sync_r == NULL)
+			return -1;
+
+		for (sz = 0; sz < sizeof(bulk_sizes)/sizeof(bulk_sizes[0]);
+				sz++) {
+			size = bulk_sizes[sz];
+			lcore_count = 0;
+			rte_eal_mp_remote_launch(sync_enqueue_dequeue, &size,
+					CALL_MASTER);
+			rte_eal_mp_wait_lcore();
+
+			/* all lcores ran the same number of iterations */
+			max_cycles = 0;
+			RTE_LCORE_FOREACH(lcore_id)
+				max_cycles = RTE_MAX(max_cycles,
+						sync_cycles[lcore_id]);
+
+			printf("%s burst enq/dequeue (size: %u): %.2F\n",
+					sync_modes[i].name, size,
+					(double)max_cycles / ((double)SYNC_ITERATIONS *
+					size * rte_lcore_count()));
+		}
+	}
+	return 0;
+}
+
 static int
 test_ring_perf(void)
 {
@@ -411,6 +596,14 @@ test_ring_perf(void)
 		printf("\n### Testing using two NUMA nodes ###\n");
 		run_on_core_pair(&cores, enqueue_bulk, dequeue_bulk);
 	}
+
+	printf("\n### Testing synchronization modes using all lcores ###\n");
+	if (test_sync_modes() < 0)
+		return -1;
+
+	printf("\n### Testing objects of any size using a single lcore ###\n");
+	if (test_elem_sizes() < 0)
+		return -1;
 	return 0;
 }
 
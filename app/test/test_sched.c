@@ -40,6 +40,8 @@
 #include "test.h"
 
 #include <rte_cycles.h>
+#include <rte_launch.h>
+#include <rte_lcore.h>
 #include <rte_ether.h>
 #include <rte_ip.h>
 #include <rte_byteorder.h>
@@ -133,6 +135,308 @@ prepare_pkt(struct rte_mbuf *mbuf)
 }
 
 
+#define SHAPE_N_PIPES		64
+#define SHAPE_PIPE		5
+
+/* Check that a port with the given pipe shape schedules the traffic classes
+ * of a pipe in strict priority order and keeps the packet path intact */
+static int
+test_sched_shape(struct rte_mempool *mp, uint32_t n_tcs, uint32_t n_queues)
+{
+	struct rte_sched_subport_params subport = subport_param[0];
+	struct rte_sched_pipe_params profile = pipe_profile[0];
+	struct rte_sched_port_params params = port_param;
+	struct rte_sched_port *port;
+	struct rte_mbuf *in_mbufs[RTE_SCHED_QUEUES_PER_PIPE_MAX];
+	struct rte_mbuf *out_mbufs[RTE_SCHED_QUEUES_PER_PIPE_MAX];
+	uint32_t n_pkts = n_tcs * n_queues;
+	uint32_t i, pipe, prev_tc, n_out;
+	int err;
+
+	for (i = 0; i < n_tcs; i++) {
+		subport.tc_rate[i] = subport.tb_rate;
+		profile.tc_rate[i] = profile.tb_rate;
+		params.qsize[i] = 64;
+	}
+	for (i = 0; i < n_pkts; i++)
+		profile.wrr_weights[i] = 1;
+
+	params.n_pipes_per_subport = SHAPE_N_PIPES;
+	params.pipe_profiles = &profile;
+	params.n_traffic_classes = n_tcs;
+	params.n_queues_per_traffic_class = n_queues;
+
+	port = rte_sched_port_config(&params);
+	TEST_ASSERT_NOT_NULL(port, "Error config sched port %ux%u\n", n_tcs, n_queues);
+
+	err = rte_sched_subport_config(port, SUBPORT, &subport);
+	TEST_ASSERT_SUCCESS(err, "Error config sched subport, err=%d\n", err);
+
+	for (pipe = 0; pipe < SHAPE_N_PIPES; pipe++) {
+		err = rte_sched_pipe_config(port, SUBPORT, pipe, 0);
+		TEST_ASSERT_SUCCESS(err, "Error config sched pipe %u, err=%d\n", pipe, err);
+	}
+
+	/* One packet per queue, lowest priority traffic class first */
+	for (i = 0; i < n_pkts; i++) {
+		uint32_t tc = n_tcs - 1 - i / n_queues;
+
+		in_mbufs[i] = rte_pktmbuf_alloc(mp);
+		TEST_ASSERT_NOT_NULL(in_mbufs[i], "Packet allocation failed\n");
+		in_mbufs[i]->pkt_len = 60;
+		in_mbufs[i]->data_len = 60;
+		rte_sched_port_pkt_write_path(port, in_mbufs[i], SUBPORT, SHAPE_PIPE,
+			tc, i % n_queues, e_RTE_METER_GREEN);
+	}
+
+	err = rte_sched_port_enqueue(port, in_mbufs, n_pkts);
+	TEST_ASSERT_EQUAL(err, (int)n_pkts, "Wrong enqueue, err=%d\n", err);
+
+	n_out = 0;
+	for (i = 0; i < 100 && n_out < n_pkts; i++)
+		n_out += rte_sched_port_dequeue(port, out_mbufs + n_out, n_pkts - n_out);
+	TEST_ASSERT_EQUAL(n_out, n_pkts, "Wrong dequeue, count=%u\n", n_out);
+
+	prev_tc = 0;
+	for (i = 0; i < n_out; i++) {
+		uint32_t subport_id, pipe_id, tc, queue;
+
+		rte_sched_port_pkt_read_path(port, out_mbufs[i],
+			&subport_id, &pipe_id, &tc, &queue);
+		TEST_ASSERT_EQUAL(subport_id, SUBPORT, "Wrong subport\n");
+		TEST_ASSERT_EQUAL(pipe_id, SHAPE_PIPE, "Wrong pipe\n");
+		TEST_ASSERT(tc < n_tcs && queue < n_queues, "Wrong queue %u/%u\n", tc, queue);
+		TEST_ASSERT(tc >= prev_tc, "Traffic class %u dequeued after %u\n", tc, prev_tc);
+		prev_tc = tc;
+		rte_pktmbuf_free(out_mbufs[i]);
+	}
+
+	rte_sched_port_free(port);
+
+	return 0;
+}
+
+static int
+test_sched_shapes(struct rte_mempool *mp)
+{
+	struct rte_sched_port_params params = port_param;
+	uint32_t size_4x4, size_4x1;
+
+	/* Invalid shapes */
+	params.n_traffic_classes = 3;
+	TEST_ASSERT_EQUAL(rte_sched_port_get_memory_footprint(&params), 0,
+		"Non power of 2 number of traffic classes accepted\n");
+	params.n_traffic_classes = 16;
+	params.n_queues_per_traffic_class = 2;
+	TEST_ASSERT_EQUAL(rte_sched_port_get_memory_footprint(&params), 0,
+		"More than %u queues per pipe accepted\n", RTE_SCHED_QUEUES_PER_PIPE_MAX);
+
+	/* Memory footprint follows the number of configured queues */
+	params.n_traffic_classes = 4;
+	params.n_queues_per_traffic_class = 4;
+	size_4x4 = rte_sched_port_get_memory_footprint(&params);
+	params.n_queues_per_traffic_class = 1;
+	size_4x1 = rte_sched_port_get_memory_footprint(&params);
+	TEST_ASSERT(size_4x1 != 0 && size_4x1 < size_4x4,
+		"Footprint does not scale with queues (%u vs %u)\n", size_4x1, size_4x4);
+
+	TEST_ASSERT_SUCCESS(test_sched_shape(mp, 16, 1), "16x1 shape failed\n");
+	TEST_ASSERT_SUCCESS(test_sched_shape(mp, 8, 2), "8x2 shape failed\n");
+	TEST_ASSERT_SUCCESS(test_sched_shape(mp, 4, 4), "4x4 shape failed\n");
+	TEST_ASSERT_SUCCESS(test_sched_shape(mp, 2, 4), "2x4 shape failed\n");
+
+	return 0;
+}
+
+#define ARB_N_SHARDS		2
+#define ARB_RATE		2000000
+#define ARB_PKT_LEN		1000
+#define ARB_N_PKTS		256
+#define ARB_N_PIPES		64
+#define ARB_TIME_MS		100
+#define ARB_BURST		32
+
+struct sched_shard {
+	struct rte_sched_port *port;
+	uint64_t end_cycles;
+	uint64_t n_bytes;
+	uint32_t n_pkts;
+};
+
+static uint32_t
+sched_shard_dequeue(struct sched_shard *shard)
+{
+	struct rte_mbuf *mbufs[ARB_BURST];
+	int i, n;
+
+	n = rte_sched_port_dequeue(shard->port, mbufs, ARB_BURST);
+	for (i = 0; i < n; i++) {
+		shard->n_bytes += mbufs[i]->pkt_len + RTE_SCHED_FRAME_OVERHEAD_DEFAULT;
+		rte_pktmbuf_free(mbufs[i]);
+	}
+	shard->n_pkts += n;
+
+	return n;
+}
+
+static int
+sched_shard_run(void *arg)
+{
+	struct sched_shard *shard = arg;
+
+	while (rte_get_tsc_cycles() < shard->end_cycles)
+		sched_shard_dequeue(shard);
+
+	return 0;
+}
+
+/* Two port scheduler instances, each with its own subport, share the rate of
+ * the output port through an arbiter: their aggregate output cannot exceed
+ * the port rate, while each of them alone would send its backlog at once */
+static int
+test_sched_arbiter(void)
+{
+	struct rte_sched_subport_params subport = subport_param[0];
+	struct rte_sched_pipe_params profile = pipe_profile[0];
+	struct rte_sched_port_params params = port_param;
+	struct rte_sched_arbiter_params arb_params = {
+		.name = "test_arbiter",
+		.socket = SOCKET,
+		.rate = ARB_RATE,
+		.tb_size = 4 * (ARB_PKT_LEN + RTE_SCHED_FRAME_OVERHEAD_DEFAULT),
+		.quantum = 2 * (ARB_PKT_LEN + RTE_SCHED_FRAME_OVERHEAD_DEFAULT),
+	};
+	struct sched_shard shards[ARB_N_SHARDS];
+	struct rte_sched_arbiter *arbiter, *mismatch;
+	struct rte_mempool *mp;
+	uint64_t start, elapsed, max_bytes, n_bytes;
+	unsigned lcore_id, lcores[ARB_N_SHARDS], n_lcores;
+	uint32_t i, j, n_pkts;
+	int err;
+
+	mp = rte_mempool_lookup("test_sched_arb");
+	if (mp == NULL)
+		mp = rte_pktmbuf_pool_create("test_sched_arb",
+			ARB_N_SHARDS * ARB_N_PKTS + 64, MEMPOOL_CACHE_SZ, 0,
+			MBUF_DATA_SZ, SOCKET);
+	TEST_ASSERT_NOT_NULL(mp, "Error creating mempool\n");
+
+	subport.tb_rate = ARB_RATE;
+	profile.tb_rate = ARB_RATE;
+	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+		subport.tc_rate[i] = ARB_RATE;
+		profile.tc_rate[i] = ARB_RATE;
+		params.qsize[i] = ARB_N_PKTS;
+	}
+	params.rate = ARB_RATE;
+	params.n_pipes_per_subport = ARB_N_PIPES;
+	params.pipe_profiles = &profile;
+
+	arb_params.rate = 0;
+	TEST_ASSERT_NULL(rte_sched_arbiter_create(&arb_params),
+		"Arbiter created with null rate\n");
+	arb_params.rate = ARB_RATE / 2;
+	mismatch = rte_sched_arbiter_create(&arb_params);
+	TEST_ASSERT_NOT_NULL(mismatch, "Error creating arbiter\n");
+	arb_params.rate = ARB_RATE;
+
+	arbiter = rte_sched_arbiter_create(&arb_params);
+	TEST_ASSERT_NOT_NULL(arbiter, "Error creating arbiter\n");
+
+	for (i = 0; i < ARB_N_SHARDS; i++) {
+		struct rte_mbuf *mbufs[ARB_N_PKTS];
+
+		shards[i].port = rte_sched_port_config(&params);
+		TEST_ASSERT_NOT_NULL(shards[i].port, "Error config shard %u\n", i);
+		shards[i].n_bytes = 0;
+		shards[i].n_pkts = 0;
+
+		err = rte_sched_subport_config(shards[i].port, SUBPORT, &subport);
+		TEST_ASSERT_SUCCESS(err, "Error config subport, err=%d\n", err);
+		err = rte_sched_pipe_config(shards[i].port, SUBPORT, PIPE, 0);
+		TEST_ASSERT_SUCCESS(err, "Error config pipe, err=%d\n", err);
+
+		err = rte_sched_port_arbiter_attach(shards[i].port, mismatch);
+		TEST_ASSERT_EQUAL(err, -2, "Attached to arbiter of different rate\n");
+		err = rte_sched_port_arbiter_attach(shards[i].port, arbiter);
+		TEST_ASSERT_SUCCESS(err, "Error attaching shard %u, err=%d\n", i, err);
+
+		for (j = 0; j < ARB_N_PKTS; j++) {
+			mbufs[j] = rte_pktmbuf_alloc(mp);
+			TEST_ASSERT_NOT_NULL(mbufs[j], "Packet allocation failed\n");
+			mbufs[j]->pkt_len = ARB_PKT_LEN;
+			mbufs[j]->data_len = ARB_PKT_LEN;
+			rte_sched_port_pkt_write(mbufs[j], SUBPORT, PIPE, TC, QUEUE,
+				e_RTE_METER_GREEN);
+		}
+		err = rte_sched_port_enqueue(shards[i].port, mbufs, ARB_N_PKTS);
+		TEST_ASSERT_EQUAL(err, ARB_N_PKTS, "Wrong enqueue, err=%d\n", err);
+	}
+
+	/* Run each shard on its own lcore when enough of them are available */
+	n_lcores = 0;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (n_lcores < ARB_N_SHARDS)
+			lcores[n_lcores++] = lcore_id;
+	}
+
+	start = rte_get_tsc_cycles();
+	for (i = 0; i < ARB_N_SHARDS; i++)
+		shards[i].end_cycles = start + rte_get_tsc_hz() * ARB_TIME_MS / 1000;
+
+	if (n_lcores == ARB_N_SHARDS) {
+		for (i = 0; i < ARB_N_SHARDS; i++)
+			rte_eal_remote_launch(sched_shard_run, &shards[i], lcores[i]);
+		for (i = 0; i < ARB_N_SHARDS; i++)
+			rte_eal_wait_lcore(lcores[i]);
+	} else {
+		while (rte_get_tsc_cycles() < shards[0].end_cycles)
+			for (i = 0; i < ARB_N_SHARDS; i++)
+				sched_shard_dequeue(&shards[i]);
+	}
+	elapsed = rte_get_tsc_cycles() - start;
+
+	n_bytes = 0;
+	for (i = 0; i < ARB_N_SHARDS; i++) {
+		printf("Shard %u: %u packets, %" PRIu64 " bytes\n",
+			i, shards[i].n_pkts, shards[i].n_bytes);
+		TEST_ASSERT(shards[i].n_pkts > 0, "Shard %u starved\n", i);
+		n_bytes += shards[i].n_bytes;
+	}
+
+	/* Credits are handed out at the port rate since arbiter creation */
+	max_bytes = (uint64_t) ARB_RATE * elapsed / rte_get_tsc_hz() +
+		ARB_RATE * 10 / 1000 + arb_params.tb_size;
+	TEST_ASSERT(n_bytes <= max_bytes,
+		"Port rate exceeded: %" PRIu64 " bytes sent, %" PRIu64 " allowed\n",
+		n_bytes, max_bytes);
+	TEST_ASSERT(n_bytes >= (uint64_t) ARB_RATE * elapsed / rte_get_tsc_hz() / 2,
+		"Port rate not used: %" PRIu64 " bytes sent\n", n_bytes);
+
+	/* Once detached, the shards drain their backlog without port credits */
+	for (i = 0; i < ARB_N_SHARDS; i++) {
+		err = rte_sched_port_arbiter_attach(shards[i].port, NULL);
+		TEST_ASSERT_SUCCESS(err, "Error detaching shard %u, err=%d\n", i, err);
+
+		/* the backlog is still paced by the pipe traffic class rate */
+		n_pkts = shards[i].n_pkts;
+		start = rte_get_tsc_cycles();
+		while (shards[i].n_pkts < ARB_N_PKTS &&
+				rte_get_tsc_cycles() - start < 5 * rte_get_tsc_hz())
+			sched_shard_dequeue(&shards[i]);
+		TEST_ASSERT_EQUAL(shards[i].n_pkts, ARB_N_PKTS,
+			"Shard %u: %u packets left after detach\n", i,
+			ARB_N_PKTS - shards[i].n_pkts);
+		TEST_ASSERT(shards[i].n_pkts > n_pkts, "Shard %u not drained\n", i);
+
+		rte_sched_port_free(shards[i].port);
+	}
+	rte_sched_arbiter_free(mismatch);
+	rte_sched_arbiter_free(arbiter);
+
+	return 0;
+}
+
 /**
  * test main entrance for library sched
  */
@@ -211,7 +515,11 @@ test_sched(void)
 
 	rte_sched_port_free(port);
 
-	return 0;
+	err = test_sched_shapes(mp);
+	if (err != 0)
+		return err;
+
+	return test_sched_arbiter();
 }
 
 static struct test_command sched_cmd = {
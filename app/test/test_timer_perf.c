@@ -61,6 +61,127 @@ timer_cb(struct rte_timer *t __rte_unused, void *param __rte_unused)
 #define do_delay() rte_pause()
 #endif
 
+#define ENGINE_PERF_DELAY_MS 200
+#define ENGINE_PERF_NB_SIZES 3
+
+static const unsigned engine_perf_sizes[ENGINE_PERF_NB_SIZES] = {
+	1000, 100000, 2000000
+};
+
+struct engine_perf_result {
+	uint64_t arm;    /**< cycles per rte_timer_reset() of a stopped timer */
+	uint64_t reset;  /**< cycles per rte_timer_reset() of a pending timer */
+	uint64_t stop;   /**< cycles per rte_timer_stop() of a pending timer */
+	uint64_t expire; /**< cycles per expired timer in rte_timer_manage() */
+};
+
+/*
+ * Measure the cost of arming, re-arming, cancelling and expiring n timers
+ * with random delays on the current lcore, using the current engine.
+ */
+static int
+timer_engine_perf(struct rte_timer *tms, unsigned n,
+		struct engine_perf_result *res)
+{
+	const uint64_t ticks = rte_get_timer_hz() * ENGINE_PERF_DELAY_MS / 1000;
+	unsigned lcore_id = rte_lcore_id();
+	uint64_t start_tsc, delay_start;
+	unsigned i;
+
+	for (i = 0; i < n; i++)
+		rte_timer_init(&tms[i]);
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < n; i++)
+		rte_timer_reset(&tms[i], rte_rand() % ticks, SINGLE, lcore_id,
+				timer_cb, NULL);
+	res->arm = (rte_rdtsc() - start_tsc) / n;
+
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < n; i++)
+		rte_timer_reset(&tms[i], rte_rand() % ticks, SINGLE, lcore_id,
+				timer_cb, NULL);
+	res->reset = (rte_rdtsc() - start_tsc) / n;
+
+	/* cancel every other timer, then arm it again */
+	start_tsc = rte_rdtsc();
+	for (i = 0; i < n; i += 2)
+		rte_timer_stop(&tms[i]);
+	res->stop = (rte_rdtsc() - start_tsc) / ((n + 1) / 2);
+	for (i = 0; i < n; i += 2)
+		rte_timer_reset(&tms[i], rte_rand() % ticks, SINGLE, lcore_id,
+				timer_cb, NULL);
+
+	outstanding_count = n;
+	delay_start = rte_get_timer_cycles();
+	while (rte_get_timer_cycles() < delay_start + ticks)
+		do_delay();
+
+	start_tsc = rte_rdtsc();
+	while (outstanding_count > 0)
+		rte_timer_manage();
+	res->expire = (rte_rdtsc() - start_tsc) / n;
+
+	if (outstanding_count != 0) {
+		printf("Error: outstanding callback count = %d\n",
+				outstanding_count);
+		return -1;
+	}
+	return 0;
+}
+
+/* compare the skiplist and the timer wheel engines */
+static int
+test_timer_engine_perf(void)
+{
+	static const char * const names[] = { "skiplist", "wheel" };
+	struct engine_perf_result res[2][ENGINE_PERF_NB_SIZES];
+	const uint64_t resolution = rte_get_timer_hz() / 100000;
+	unsigned max_timers = engine_perf_sizes[ENGINE_PERF_NB_SIZES - 1];
+	struct rte_timer *tms;
+	unsigned e, i;
+	int ret = 0;
+
+	tms = rte_malloc(NULL, sizeof(*tms) * max_timers, 0);
+	if (tms == NULL) {
+		printf("Cannot allocate %u timers\n", max_timers);
+		return -1;
+	}
+
+	for (e = 0; e < 2 && ret == 0; e++) {
+		if (rte_timer_subsystem_set_engine(e == 0 ?
+				RTE_TIMER_ENGINE_SKIPLIST :
+				RTE_TIMER_ENGINE_WHEEL, resolution) != 0) {
+			printf("Cannot select the %s engine\n", names[e]);
+			ret = -1;
+			break;
+		}
+		for (i = 0; i < ENGINE_PERF_NB_SIZES && ret == 0; i++) {
+			printf("Testing %u timers with the %s engine\n",
+					engine_perf_sizes[i], names[e]);
+			ret = timer_engine_perf(tms, engine_perf_sizes[i],
+					&res[e][i]);
+		}
+	}
+	rte_timer_subsystem_set_engine(RTE_TIMER_ENGINE_SKIPLIST, 0);
+	rte_free(tms);
+	if (ret != 0)
+		return ret;
+
+	printf("\nTimer engine comparison (cycles per timer, wheel "
+			"resolution %"PRIu64" cycles)\n", resolution);
+	printf("%-10s%10s%10s%10s%10s%10s\n", "engine", "timers", "arm",
+			"reset", "stop", "expire");
+	for (e = 0; e < 2; e++)
+		for (i = 0; i < ENGINE_PERF_NB_SIZES; i++)
+			printf("%-10s%10u%10"PRIu64"%10"PRIu64"%10"PRIu64
+					"%10"PRIu64"\n", names[e],
+					engine_perf_sizes[i], res[e][i].arm,
+					res[e][i].reset, res[e][i].stop,
+					res[e][i].expire);
+	return 0;
+}
+
 static int
 test_timer_perf(void)
 {
@@ -155,7 +276,10 @@ test_timer_perf(void)
 	printf("Time per rte_timer_manage with zero callbacks: %"PRIu64" cycles\n",
 			(end_tsc - start_tsc + iterations/2) / iterations);
 
-	return 0;
+	rte_timer_stop(&tms[0]);
+	rte_free(tms);
+
+	return test_timer_engine_perf();
 }
 
 static struct test_command timer_perf_cmd = {
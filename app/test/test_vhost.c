@@ -0,0 +1,704 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <inttypes.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+#include <rte_memzone.h>
+#include <rte_malloc.h>
+#include <rte_virtio_net.h>
+
+#include "test.h"
+
+/*
+ * The tests act as the guest driver of a virtio device whose memory is a
+ * memzone, so that the vhost data path can be run without a VM.
+ */
+
+#define RING_SIZE 256
+#define DESC_PER_PKT 4 /* header and up to 3 data buffers */
+#define MAX_PKTS (RING_SIZE / DESC_PER_PKT)
+#define BURST 32
+#define BUF_SIZE 2048
+#define NUM_MBUFS 1024
+#define MBUF_DATA_SIZE (2048 + RTE_PKTMBUF_HEADROOM)
+
+#define GUEST_PA 0x40000000ULL
+#define DESC_OFF 0
+#define AVAIL_OFF 0x1000
+#define USED_OFF 0x2000
+#define HDR_OFF 0x4000
+#define BUF_OFF 0x10000
+#define RX_DESC_OFF 0x30000
+#define RX_AVAIL_OFF 0x31000
+#define RX_USED_OFF 0x32000
+#define RX_BUF_OFF 0x40000
+#define RX_BUF_SIZE 1024
+#define GUEST_MEM_SIZE (RX_BUF_OFF + RING_SIZE * RX_BUF_SIZE)
+
+#define PERF_ITERATIONS 10000
+#define PERF_PKT_LEN 1500
+
+static const struct rte_memzone *guest_mz;
+static struct virtio_net *dev;
+static struct rte_mempool *pool;
+static uint16_t guest_avail_idx;
+static uint16_t guest_rx_avail_idx;
+static uint16_t guest_rx_used_idx;
+
+static void *
+guest_buf(uint16_t slot)
+{
+	return RTE_PTR_ADD(guest_mz->addr, BUF_OFF + slot * BUF_SIZE);
+}
+
+static uint16_t
+guest_used_idx(void)
+{
+	return *(volatile uint16_t *)&dev->virtqueue[VIRTIO_TXQ]->used->idx;
+}
+
+/*
+ * Make n packets of len bytes available in the TX queue, each split in
+ * nb_bufs data buffers. The data is filled with a pattern if fill is set.
+ */
+static void
+guest_send(unsigned n, uint32_t len, unsigned nb_bufs, int fill)
+{
+	struct vhost_virtqueue *vq = dev->virtqueue[VIRTIO_TXQ];
+	struct vring_desc *desc;
+	uint16_t slot, head;
+	uint32_t off, buf_len;
+	unsigned i, j;
+
+	for (i = 0; i < n; i++) {
+		slot = guest_avail_idx % MAX_PKTS;
+		head = slot * DESC_PER_PKT;
+
+		desc = &vq->desc[head];
+		desc->addr = GUEST_PA + HDR_OFF + slot * 16;
+		desc->len = sizeof(struct virtio_net_hdr);
+		desc->flags = VRING_DESC_F_NEXT;
+		desc->next = head + 1;
+
+		for (j = 0, off = 0; j < nb_bufs; j++, off += buf_len) {
+			buf_len = (j == nb_bufs - 1) ? len - off : len / nb_bufs;
+			desc = &vq->desc[head + 1 + j];
+			desc->addr = GUEST_PA + BUF_OFF + slot * BUF_SIZE + off;
+			desc->len = buf_len;
+			desc->flags = (j == nb_bufs - 1) ? 0 : VRING_DESC_F_NEXT;
+			desc->next = head + 2 + j;
+		}
+
+		if (fill)
+			memset(guest_buf(slot), guest_avail_idx & 0xff, len);
+
+		vq->avail->ring[guest_avail_idx & (RING_SIZE - 1)] = head;
+		guest_avail_idx++;
+	}
+
+	rte_wmb();
+	vq->avail->idx = guest_avail_idx;
+}
+
+/* Make n receive buffers available, reusing the ones already used. */
+static void
+guest_rx_post(unsigned n)
+{
+	struct vhost_virtqueue *vq = dev->virtqueue[VIRTIO_RXQ];
+	uint16_t slot;
+	unsigned i;
+
+	for (i = 0; i < n; i++) {
+		slot = guest_rx_avail_idx & (RING_SIZE - 1);
+		vq->desc[slot].addr = GUEST_PA + RX_BUF_OFF + slot * RX_BUF_SIZE;
+		vq->desc[slot].len = RX_BUF_SIZE;
+		vq->desc[slot].flags = VRING_DESC_F_WRITE;
+		vq->avail->ring[slot] = slot;
+		guest_rx_avail_idx++;
+	}
+
+	rte_wmb();
+	vq->avail->idx = guest_rx_avail_idx;
+}
+
+/*
+ * Receive a packet from the used ring, checking that it is made of len
+ * bytes of the given pattern. Returns the number of buffers it used, or
+ * -1 on error.
+ */
+static int
+guest_rx_check(uint32_t len, uint8_t pattern)
+{
+	struct vhost_virtqueue *vq = dev->virtqueue[VIRTIO_RXQ];
+	struct virtio_net_hdr_mrg_rxbuf *hdr;
+	struct vring_used_elem *used;
+	const uint8_t *data;
+	uint32_t i, total = 0, hlen = vq->vhost_hlen;
+	uint16_t nb_bufs, n;
+
+	if (guest_rx_used_idx == *(volatile uint16_t *)&vq->used->idx)
+		return -1;
+
+	used = &vq->used->ring[guest_rx_used_idx & (RING_SIZE - 1)];
+	hdr = RTE_PTR_ADD(guest_mz->addr, RX_BUF_OFF + used->id * RX_BUF_SIZE);
+	nb_bufs = hdr->num_buffers;
+
+	for (n = 0; n < nb_bufs; n++) {
+		used = &vq->used->ring[guest_rx_used_idx & (RING_SIZE - 1)];
+		data = RTE_PTR_ADD(guest_mz->addr,
+			RX_BUF_OFF + used->id * RX_BUF_SIZE + hlen);
+		for (i = 0; i < used->len - hlen; i++)
+			if (data[i] != pattern)
+				return -1;
+		total += used->len - hlen;
+		guest_rx_used_idx++;
+		hlen = 0;
+	}
+
+	if (total != len)
+		return -1;
+	return nb_bufs;
+}
+
+static int
+check_pkt(struct rte_mbuf *m, uint32_t len, uint8_t pattern)
+{
+	const uint8_t *data;
+	struct rte_mbuf *seg;
+	uint32_t i, total = 0;
+
+	for (seg = m; seg != NULL; seg = seg->next) {
+		data = rte_pktmbuf_mtod(seg, const uint8_t *);
+		for (i = 0; i < seg->data_len; i++)
+			if (data[i] != pattern)
+				return -1;
+		total += seg->data_len;
+	}
+	if (total != len || m->pkt_len != len)
+		return -1;
+	return 0;
+}
+
+static int
+test_setup(void)
+{
+	struct vhost_virtqueue *vq;
+
+	if (guest_mz == NULL) {
+		guest_mz = rte_memzone_reserve_aligned("vhost_test_guest",
+			GUEST_MEM_SIZE, SOCKET_ID_ANY, 0, RTE_CACHE_LINE_SIZE);
+		if (guest_mz == NULL) {
+			printf("%s: cannot reserve guest memory\n", __func__);
+			return -1;
+		}
+	}
+
+	if (pool == NULL) {
+		pool = rte_pktmbuf_pool_create("vhost_test_pool", NUM_MBUFS,
+			0, 0, MBUF_DATA_SIZE, SOCKET_ID_ANY);
+		if (pool == NULL) {
+			printf("%s: cannot create mbuf pool\n", __func__);
+			return -1;
+		}
+	}
+
+	if (dev == NULL) {
+		dev = rte_zmalloc(NULL, sizeof(*dev), RTE_CACHE_LINE_SIZE);
+		if (dev == NULL)
+			return -1;
+		dev->virtqueue[VIRTIO_RXQ] = rte_zmalloc(NULL,
+			sizeof(struct vhost_virtqueue), RTE_CACHE_LINE_SIZE);
+		dev->virtqueue[VIRTIO_TXQ] = rte_zmalloc(NULL,
+			sizeof(struct vhost_virtqueue), RTE_CACHE_LINE_SIZE);
+		dev->mem = rte_zmalloc(NULL, sizeof(struct virtio_memory) +
+			sizeof(struct virtio_memory_regions), 0);
+		if (dev->virtqueue[VIRTIO_RXQ] == NULL ||
+				dev->virtqueue[VIRTIO_TXQ] == NULL ||
+				dev->mem == NULL)
+			return -1;
+	}
+
+	/* a single memory region covering the memzone */
+	memset(guest_mz->addr, 0, GUEST_MEM_SIZE);
+	dev->mem->nregions = 1;
+	dev->mem->regions[0].guest_phys_address = GUEST_PA;
+	dev->mem->regions[0].guest_phys_address_end = GUEST_PA + GUEST_MEM_SIZE;
+	dev->mem->regions[0].memory_size = GUEST_MEM_SIZE;
+	dev->mem->regions[0].address_offset = guest_mz->addr_64 - GUEST_PA;
+
+	vq = dev->virtqueue[VIRTIO_TXQ];
+	memset(vq, 0, sizeof(*vq));
+	vq->desc = RTE_PTR_ADD(guest_mz->addr, DESC_OFF);
+	vq->avail = RTE_PTR_ADD(guest_mz->addr, AVAIL_OFF);
+	vq->used = RTE_PTR_ADD(guest_mz->addr, USED_OFF);
+	vq->size = RING_SIZE;
+	vq->callfd = (eventfd_t)-1;
+	vq->kickfd = (eventfd_t)-1;
+	vq->avail->flags = VRING_AVAIL_F_NO_INTERRUPT;
+	guest_avail_idx = 0;
+
+	/* mergeable receive buffers, all made available */
+	dev->features = 1ULL << VIRTIO_NET_F_MRG_RXBUF;
+	vq = dev->virtqueue[VIRTIO_RXQ];
+	memset(vq, 0, sizeof(*vq));
+	vq->desc = RTE_PTR_ADD(guest_mz->addr, RX_DESC_OFF);
+	vq->avail = RTE_PTR_ADD(guest_mz->addr, RX_AVAIL_OFF);
+	vq->used = RTE_PTR_ADD(guest_mz->addr, RX_USED_OFF);
+	vq->size = RING_SIZE;
+	vq->vhost_hlen = sizeof(struct virtio_net_hdr_mrg_rxbuf);
+	vq->callfd = (eventfd_t)-1;
+	vq->kickfd = (eventfd_t)-1;
+	vq->avail->flags = VRING_AVAIL_F_NO_INTERRUPT;
+	guest_rx_avail_idx = 0;
+	guest_rx_used_idx = 0;
+	guest_rx_post(RING_SIZE);
+
+	return 0;
+}
+
+static int
+test_vhost_dequeue_copy(void)
+{
+	struct rte_mbuf *pkts[BURST];
+	unsigned i, n;
+	int ret = 0;
+
+	guest_send(BURST, 1000, 1, 1);
+	n = rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, pkts, BURST);
+	TEST_ASSERT_EQUAL(n, BURST, "%u packets dequeued", n);
+	TEST_ASSERT_EQUAL(guest_used_idx(), BURST,
+		"buffers were not given back to the guest");
+
+	for (i = 0; i < n; i++) {
+		if (rte_pktmbuf_mtod(pkts[i], void *) == guest_buf(i) ||
+				check_pkt(pkts[i], 1000, i) < 0)
+			ret = -1;
+		rte_pktmbuf_free(pkts[i]);
+	}
+	TEST_ASSERT_SUCCESS(ret, "bad packet data");
+
+	/* packets scattered in several buffers */
+	guest_send(BURST, 1500, 3, 1);
+	n = rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, pkts, BURST);
+	TEST_ASSERT_EQUAL(n, BURST, "%u packets dequeued", n);
+	for (i = 0; i < n; i++) {
+		if (check_pkt(pkts[i], 1500, BURST + i) < 0)
+			ret = -1;
+		rte_pktmbuf_free(pkts[i]);
+	}
+	TEST_ASSERT_SUCCESS(ret, "bad scattered packet data");
+
+	return 0;
+}
+
+static int
+test_vhost_dequeue_zero_copy(void)
+{
+	struct rte_mbuf *zc_pkts[BURST], *pkts[BURST];
+	unsigned i, n, free_count;
+	int ret = 0;
+
+	free_count = rte_mempool_count(pool);
+	TEST_ASSERT_SUCCESS(rte_vhost_enable_dequeue_zero_copy(dev,
+		VIRTIO_TXQ, 1), "cannot enable zero copy");
+
+	guest_send(BURST, 1000, 1, 1);
+	n = rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, zc_pkts, BURST);
+	TEST_ASSERT_EQUAL(n, BURST, "%u packets dequeued", n);
+
+	if (rte_pktmbuf_mtod(zc_pkts[0], void *) != guest_buf(0)) {
+		/* guest memory is not made of hugepages */
+		printf("zero copy not used, skipping\n");
+		for (i = 0; i < n; i++)
+			rte_pktmbuf_free(zc_pkts[i]);
+		return rte_vhost_enable_dequeue_zero_copy(dev, VIRTIO_TXQ, 0);
+	}
+
+	TEST_ASSERT_EQUAL(guest_used_idx(), 0,
+		"buffers given back before the mbufs are freed");
+	for (i = 0; i < n; i++) {
+		if (rte_pktmbuf_mtod(zc_pkts[i], void *) != guest_buf(i) ||
+				zc_pkts[i]->buf_physaddr != guest_mz->phys_addr +
+				BUF_OFF + i * BUF_SIZE ||
+				check_pkt(zc_pkts[i], 1000, i) < 0)
+			ret = -1;
+	}
+	TEST_ASSERT_SUCCESS(ret, "bad zero copy packet");
+
+	/* the buffers are given back in order as their mbufs are freed */
+	for (i = 1; i < BURST / 2; i++)
+		rte_pktmbuf_free(zc_pkts[i]);
+	n = rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, pkts, BURST);
+	TEST_ASSERT_EQUAL(n, 0, "%u packets dequeued", n);
+	TEST_ASSERT_EQUAL(guest_used_idx(), 0,
+		"%u buffers given back out of order", guest_used_idx());
+	rte_pktmbuf_free(zc_pkts[0]);
+	n = rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, pkts, BURST);
+	TEST_ASSERT_EQUAL(n, 0, "%u packets dequeued", n);
+	TEST_ASSERT_EQUAL(guest_used_idx(), BURST / 2,
+		"%u buffers given back", guest_used_idx());
+
+	/* disabling fails while the application holds mbufs */
+	TEST_ASSERT_FAIL(rte_vhost_enable_dequeue_zero_copy(dev,
+		VIRTIO_TXQ, 0), "zero copy disabled with mbufs in use");
+
+	/* packets scattered in several buffers are copied */
+	guest_send(BURST / 2, 1500, 2, 1);
+	n = rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, pkts, BURST / 2);
+	TEST_ASSERT_EQUAL(n, BURST / 2, "%u packets dequeued", n);
+	TEST_ASSERT_EQUAL(guest_used_idx(), BURST,
+		"copied buffers were not given back to the guest");
+	for (i = 0; i < n; i++) {
+		if (check_pkt(pkts[i], 1500, BURST + i) < 0)
+			ret = -1;
+		rte_pktmbuf_free(pkts[i]);
+	}
+	TEST_ASSERT_SUCCESS(ret, "bad scattered packet data");
+
+	/* the mbufs get their own buffer back once freed */
+	for (i = BURST / 2; i < BURST; i++)
+		rte_pktmbuf_free(zc_pkts[i]);
+	TEST_ASSERT_SUCCESS(rte_vhost_enable_dequeue_zero_copy(dev,
+		VIRTIO_TXQ, 0), "cannot disable zero copy");
+	TEST_ASSERT_EQUAL(guest_used_idx(), BURST + BURST / 2,
+		"%u buffers given back", guest_used_idx());
+	TEST_ASSERT_EQUAL(rte_mempool_count(pool), free_count,
+		"mbufs leaked");
+
+	n = rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, pkts, 1);
+	TEST_ASSERT_EQUAL(n, 0, "%u packets dequeued", n);
+	pkts[0] = rte_pktmbuf_alloc(pool);
+	TEST_ASSERT_NOT_NULL(pkts[0], "cannot allocate mbuf");
+	TEST_ASSERT(rte_pktmbuf_mtod(pkts[0], char *) ==
+		(char *)pkts[0]->buf_addr + RTE_PKTMBUF_HEADROOM &&
+		pkts[0]->buf_len == MBUF_DATA_SIZE,
+		"mbuf buffer not restored");
+	rte_pktmbuf_free(pkts[0]);
+
+	return 0;
+}
+
+static struct rte_mbuf *
+alloc_pkt(uint32_t len, uint8_t pattern)
+{
+	struct rte_mbuf *m;
+	char *data;
+
+	m = rte_pktmbuf_alloc(pool);
+	if (m == NULL)
+		return NULL;
+	data = rte_pktmbuf_append(m, len);
+	if (data == NULL) {
+		rte_pktmbuf_free(m);
+		return NULL;
+	}
+	memset(data, pattern, len);
+	return m;
+}
+
+static int
+test_vhost_enqueue_mergeable(void)
+{
+	struct rte_mbuf *pkts[BURST];
+	unsigned i, n;
+	int ret = 0;
+
+	/* each packet takes 2 receive buffers */
+	for (i = 0; i < BURST; i++) {
+		pkts[i] = alloc_pkt(1500, i);
+		TEST_ASSERT_NOT_NULL(pkts[i], "cannot allocate packet");
+	}
+	n = rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, BURST);
+	TEST_ASSERT_EQUAL(n, BURST, "%u packets enqueued", n);
+	TEST_ASSERT_EQUAL(dev->virtqueue[VIRTIO_RXQ]->used->idx, 2 * BURST,
+		"%u buffers used", dev->virtqueue[VIRTIO_RXQ]->used->idx);
+	for (i = 0; i < BURST; i++)
+		if (guest_rx_check(1500, i) != 2)
+			ret = -1;
+	TEST_ASSERT_SUCCESS(ret, "bad received packet");
+
+	/* the remaining buffers can hold 2.5 more bursts only */
+	n = rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, BURST / 2);
+	TEST_ASSERT_EQUAL(n, BURST / 2, "%u packets enqueued", n);
+	for (i = 0; i < 2; i++) {
+		n = rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, BURST);
+		TEST_ASSERT_EQUAL(n, BURST, "%u packets enqueued", n);
+	}
+	n = rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, BURST);
+	TEST_ASSERT_EQUAL(n, BURST / 2, "%u packets enqueued", n);
+	for (i = 0; i < BURST / 2; i++)
+		if (guest_rx_check(1500, i) != 2)
+			ret = -1;
+	for (i = 0; i < 2 * BURST + BURST / 2; i++)
+		if (guest_rx_check(1500, i % BURST) != 2)
+			ret = -1;
+	TEST_ASSERT_SUCCESS(ret, "bad received packet");
+	TEST_ASSERT_EQUAL(guest_rx_check(0, 0), -1, "too many packets");
+
+	for (i = 0; i < BURST; i++)
+		rte_pktmbuf_free(pkts[i]);
+	return 0;
+}
+
+/* return 1 if the guest was notified since the last call, 0 otherwise */
+static int
+guest_notified(int callfd)
+{
+	eventfd_t value;
+
+	return eventfd_read(callfd, &value) == 0;
+}
+
+static int
+test_vhost_enqueue_notify(void)
+{
+	struct vhost_virtqueue *vq = dev->virtqueue[VIRTIO_RXQ];
+	struct rte_mbuf *pkts[BURST];
+	unsigned i, n;
+	int callfd, ret = 0;
+
+	callfd = eventfd(0, EFD_NONBLOCK);
+	TEST_ASSERT(callfd >= 0, "cannot create eventfd");
+	vq->callfd = (eventfd_t)callfd;
+	vq->avail->flags = 0;
+
+	for (i = 0; i < BURST; i++) {
+		pkts[i] = alloc_pkt(1500, i);
+		if (pkts[i] == NULL)
+			ret = -1;
+	}
+	if (ret != 0)
+		goto out;
+
+	/* without threshold, each burst notifies the guest */
+	n = rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, 1);
+	if (n != 1 || !guest_notified(callfd))
+		ret = -1;
+	if (rte_vhost_set_notify_threshold(dev, VIRTIO_TXQ, 1) == 0 ||
+		rte_vhost_set_notify_threshold(dev, VIRTIO_RXQ, 64) != 0)
+		ret = -1;
+	if (ret != 0) {
+		printf("notification without threshold failed\n");
+		goto out;
+	}
+
+	/* notify once 64 entries are used, 2 per packet */
+	n = rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, 16);
+	if (n != 16 || guest_notified(callfd))
+		ret = -1;
+	n = rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, 16);
+	if (n != 16 || !guest_notified(callfd))
+		ret = -1;
+	n = rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, 8);
+	if (n != 8 || guest_notified(callfd))
+		ret = -1;
+	if (ret != 0) {
+		printf("notification coalescing failed\n");
+		goto out;
+	}
+
+	/* flush the pending notification */
+	rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, 0);
+	if (!guest_notified(callfd))
+		ret = -1;
+	rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, 0);
+	if (guest_notified(callfd))
+		ret = -1;
+	if (ret != 0) {
+		printf("notification flush failed\n");
+		goto out;
+	}
+
+	/* the guest is notified when its buffers run out */
+	n = rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, 8);
+	if (n != 8 || guest_notified(callfd))
+		ret = -1;
+	while (n == BURST || n == 8)
+		n = rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, BURST);
+	if (!guest_notified(callfd))
+		ret = -1;
+	if (ret != 0)
+		printf("notification on full ring failed\n");
+
+out:
+	for (i = 0; i < BURST; i++)
+		rte_pktmbuf_free(pkts[i]);
+	vq->callfd = (eventfd_t)-1;
+	close(callfd);
+	return ret;
+}
+
+/* cycles per packet to enqueue a burst of packets of len bytes */
+static uint64_t
+enqueue_perf(uint32_t len)
+{
+	struct rte_mbuf *pkts[BURST];
+	uint64_t start, cycles = 0;
+	unsigned i, n;
+
+	for (i = 0; i < BURST; i++) {
+		pkts[i] = alloc_pkt(len, i);
+		if (pkts[i] == NULL)
+			return 0;
+	}
+
+	for (i = 0; i < PERF_ITERATIONS; i++) {
+		start = rte_rdtsc();
+		n = rte_vhost_enqueue_burst(dev, VIRTIO_RXQ, pkts, BURST);
+		cycles += rte_rdtsc() - start;
+
+		if (n != BURST)
+			break;
+		/* the guest gets the packets and gives the buffers back */
+		guest_rx_used_idx = dev->virtqueue[VIRTIO_RXQ]->used->idx;
+		guest_rx_post(BURST * ((len + RX_BUF_SIZE - 1) / RX_BUF_SIZE));
+	}
+
+	for (n = 0; n < BURST; n++)
+		rte_pktmbuf_free(pkts[n]);
+	if (i != PERF_ITERATIONS)
+		return 0;
+	return cycles / (PERF_ITERATIONS * BURST);
+}
+
+static int
+test_vhost_enqueue_perf(void)
+{
+	struct vhost_virtqueue *vq = dev->virtqueue[VIRTIO_RXQ];
+	uint64_t cycles_64, cycles_1500;
+	int callfd;
+
+	/* the guest wants to be notified */
+	callfd = eventfd(0, EFD_NONBLOCK);
+	TEST_ASSERT(callfd >= 0, "cannot create eventfd");
+	vq->callfd = (eventfd_t)callfd;
+	vq->avail->flags = 0;
+
+	cycles_64 = enqueue_perf(64);
+	cycles_1500 = enqueue_perf(1500);
+	TEST_ASSERT(cycles_64 != 0 && cycles_1500 != 0, "enqueue failed");
+	printf("mergeable enqueue: %"PRIu64" cycles/pkt for 64 bytes, "
+		"%"PRIu64" cycles/pkt for 1500 bytes\n",
+		cycles_64, cycles_1500);
+
+	/* coalesce the notifications of 4 bursts */
+	rte_vhost_set_notify_threshold(dev, VIRTIO_RXQ, 4 * BURST);
+	cycles_64 = enqueue_perf(64);
+	cycles_1500 = enqueue_perf(1500);
+	TEST_ASSERT(cycles_64 != 0 && cycles_1500 != 0, "enqueue failed");
+	printf("with notify threshold %u: %"PRIu64" cycles/pkt for 64 bytes, "
+		"%"PRIu64" cycles/pkt for 1500 bytes\n", 4 * BURST,
+		cycles_64, cycles_1500);
+
+	vq->callfd = (eventfd_t)-1;
+	close(callfd);
+	return 0;
+}
+
+/* cycles per packet to dequeue and free packets of PERF_PKT_LEN bytes */
+static uint64_t
+dequeue_perf(void)
+{
+	struct rte_mbuf *pkts[BURST];
+	uint64_t start, cycles = 0;
+	unsigned i, j, n;
+
+	for (i = 0; i < PERF_ITERATIONS; i++) {
+		guest_send(BURST, PERF_PKT_LEN, 1, 0);
+
+		start = rte_rdtsc();
+		n = rte_vhost_dequeue_burst(dev, VIRTIO_TXQ, pool, pkts, BURST);
+		for (j = 0; j < n; j++)
+			rte_pktmbuf_free(pkts[j]);
+		cycles += rte_rdtsc() - start;
+
+		if (n != BURST)
+			return 0;
+	}
+
+	return cycles / (PERF_ITERATIONS * BURST);
+}
+
+static int
+test_vhost_dequeue_perf(void)
+{
+	uint64_t copy_cycles, zero_copy_cycles;
+
+	copy_cycles = dequeue_perf();
+	TEST_ASSERT(copy_cycles != 0, "copy dequeue failed");
+
+	TEST_ASSERT_SUCCESS(rte_vhost_enable_dequeue_zero_copy(dev,
+		VIRTIO_TXQ, 1), "cannot enable zero copy");
+	zero_copy_cycles = dequeue_perf();
+	TEST_ASSERT_SUCCESS(rte_vhost_enable_dequeue_zero_copy(dev,
+		VIRTIO_TXQ, 0), "cannot disable zero copy");
+	TEST_ASSERT(zero_copy_cycles != 0, "zero copy dequeue failed");
+
+	printf("dequeue of %u byte packets: copy %"PRIu64" cycles/pkt, "
+		"zero copy %"PRIu64" cycles/pkt\n", PERF_PKT_LEN,
+		copy_cycles, zero_copy_cycles);
+	return 0;
+}
+
+static struct unit_test_suite vhost_test_suite  = {
+	.setup = NULL,
+	.suite_name = "Vhost Unit Test Suite",
+	.unit_test_cases = {
+		TEST_CASE_ST(test_setup, NULL, test_vhost_dequeue_copy),
+		TEST_CASE_ST(test_setup, NULL, test_vhost_dequeue_zero_copy),
+		TEST_CASE_ST(test_setup, NULL, test_vhost_dequeue_perf),
+		TEST_CASE_ST(test_setup, NULL, test_vhost_enqueue_mergeable),
+		TEST_CASE_ST(test_setup, NULL, test_vhost_enqueue_notify),
+		TEST_CASE_ST(test_setup, NULL, test_vhost_enqueue_perf),
+		TEST_CASES_END()
+	}
+};
+
+static int
+test_vhost(void)
+{
+	return unit_test_suite_runner(&vhost_test_suite);
+}
+
+static struct test_command vhost_cmd = {
+	.command = "vhost_autotest",
+	.callback = test_vhost,
+};
+REGISTER_TEST_COMMAND(vhost_cmd);
@@ -228,9 +228,16 @@ static struct l3fwd_ipv6_route l3fwd_ipv6_route_array[] = {
 };
 
 #define LPM_MAX_RULES         1024
+#define LPM_NUMBER_TBL8S (1 << 8)
 #define LPM6_MAX_RULES         1024
 #define LPM6_NUMBER_TBL8S (1 << 16)
 
+struct rte_lpm_config lpm_config = {
+		.max_rules = LPM_MAX_RULES,
+		.number_tbl8s = LPM_NUMBER_TBL8S,
+		.flags = 0
+};
+
 struct rte_lpm6_config lpm6_config = {
 		.max_rules = LPM6_MAX_RULES,
 		.number_tbl8s = LPM6_NUMBER_TBL8S,
@@ -269,7 +276,8 @@ l3fwd_simple_forward(struct rte_mbuf *m, struct lcore_queue_conf *qconf,
 {
 	struct rx_queue *rxq;
 	uint32_t i, len;
-	uint8_t next_hop, port_out, ipv6;
+	uint32_t next_hop;
+	uint8_t next_hop6, port_out, ipv6;
 	int32_t len2;
 
 	ipv6 = 0;
@@ -330,9 +338,9 @@ l3fwd_simple_forward(struct rte_mbuf *m, struct lcore_queue_conf *qconf,
 		ip_hdr = rte_pktmbuf_mtod(m, struct ipv6_hdr *);
 
 		/* Find destination port */
-		if (rte_lpm6_lookup(rxq->lpm6, ip_hdr->dst_addr, &next_hop) == 0 &&
-				(enabled_port_mask & 1 << next_hop) != 0) {
-			port_out = next_hop;
+		if (rte_lpm6_lookup(rxq->lpm6, ip_hdr->dst_addr, &next_hop6) == 0 &&
+				(enabled_port_mask & 1 << next_hop6) != 0) {
+			port_out = next_hop6;
 
 			/* Build transmission burst for new port */
 			len = qconf->tx_mbufs[port_out].len;
@@ -771,7 +779,7 @@ init_mem(void)
 			RTE_LOG(INFO, IP_FRAG, "Creating LPM table on socket %i\n", socket);
 			snprintf(buf, sizeof(buf), "IP_FRAG_LPM_%i", socket);
 
-			lpm = rte_lpm_create(buf, socket, LPM_MAX_RULES, 0);
+			lpm = rte_lpm_create(buf, socket, &lpm_config);
 			if (lpm == NULL) {
 				RTE_LOG(ERR, IP_FRAG, "Cannot create LPM table\n");
 				return -1;
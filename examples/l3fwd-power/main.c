@@ -329,6 +329,7 @@ static struct ipv4_l3fwd_route ipv4_l3fwd_route_array[] = {
 	(sizeof(ipv4_l3fwd_route_array) / sizeof(ipv4_l3fwd_route_array[0]))
 
 #define IPV4_L3FWD_LPM_MAX_RULES     1024
+#define IPV4_L3FWD_LPM_NUMBER_TBL8S  (1 << 8)
 
 typedef struct rte_lpm lookup_struct_t;
 static lookup_struct_t *ipv4_l3fwd_lookup_struct[NB_SOCKETS];
@@ -618,7 +619,7 @@ static inline uint8_t
 get_ipv4_dst_port(struct ipv4_hdr *ipv4_hdr, uint8_t portid,
 		lookup_struct_t *ipv4_l3fwd_lookup_struct)
 {
-	uint8_t next_hop;
+	uint32_t next_hop;
 
 	return (uint8_t) ((rte_lpm_lookup(ipv4_l3fwd_lookup_struct,
 			rte_be_to_cpu_32(ipv4_hdr->dst_addr), &next_hop) == 0)?
@@ -1321,14 +1322,18 @@ setup_hash(int socketid)
 static void
 setup_lpm(int socketid)
 {
+	struct rte_lpm_config config;
 	unsigned i;
 	int ret;
 	char s[64];
 
 	/* create the LPM table */
+	config.max_rules = IPV4_L3FWD_LPM_MAX_RULES;
+	config.number_tbl8s = IPV4_L3FWD_LPM_NUMBER_TBL8S;
+	config.flags = 0;
 	snprintf(s, sizeof(s), "IPV4_L3FWD_LPM_%d", socketid);
 	ipv4_l3fwd_lookup_struct[socketid] = rte_lpm_create(s, socketid,
-				IPV4_L3FWD_LPM_MAX_RULES, 0);
+				&config);
 	if (ipv4_l3fwd_lookup_struct[socketid] == NULL)
 		rte_exit(EXIT_FAILURE, "Unable to create the l3fwd LPM table"
 				" on socket %d\n", socketid);
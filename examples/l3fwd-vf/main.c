@@ -288,6 +288,7 @@ static struct l3fwd_route l3fwd_route_array[] = {
 	(sizeof(l3fwd_route_array) / sizeof(l3fwd_route_array[0]))
 
 #define L3FWD_LPM_MAX_RULES     1024
+#define L3FWD_LPM_NUMBER_TBL8S  (1 << 8)
 
 typedef struct rte_lpm lookup_struct_t;
 static lookup_struct_t *l3fwd_lookup_struct[NB_SOCKETS];
@@ -443,7 +444,7 @@ get_dst_port(struct ipv4_hdr *ipv4_hdr,  uint8_t portid, lookup_struct_t * l3fwd
 static inline uint8_t
 get_dst_port(struct ipv4_hdr *ipv4_hdr,  uint8_t portid, lookup_struct_t * l3fwd_lookup_struct)
 {
-	uint8_t next_hop;
+	uint32_t next_hop;
 
 	return (uint8_t) ((rte_lpm_lookup(l3fwd_lookup_struct,
 			rte_be_to_cpu_32(ipv4_hdr->dst_addr), &next_hop) == 0)?
@@ -868,14 +869,18 @@ setup_hash(int socketid)
 static void
 setup_lpm(int socketid)
 {
+	struct rte_lpm_config config;
 	unsigned i;
 	int ret;
 	char s[64];
 
 	/* create the LPM table */
+	config.max_rules = L3FWD_LPM_MAX_RULES;
+	config.number_tbl8s = L3FWD_LPM_NUMBER_TBL8S;
+	config.flags = 0;
 	snprintf(s, sizeof(s), "L3FWD_LPM_%d", socketid);
 	l3fwd_lookup_struct[socketid] = rte_lpm_create(s, socketid,
-				L3FWD_LPM_MAX_RULES, 0);
+				&config);
 	if (l3fwd_lookup_struct[socketid] == NULL)
 		rte_exit(EXIT_FAILURE, "Unable to create the l3fwd LPM table"
 				" on socket %d\n", socketid);
@@ -99,6 +99,10 @@
 #define APP_MAX_LPM_RULES 1024
 #endif
 
+#ifndef APP_LPM_NUMBER_TBL8S
+#define APP_LPM_NUMBER_TBL8S (1 << 8)
+#endif
+
 /* NIC RX */
 #ifndef APP_DEFAULT_NIC_RX_RING_SIZE
 #define APP_DEFAULT_NIC_RX_RING_SIZE 1024
@@ -338,11 +338,29 @@ cfg_load_port(struct cfg_file *cfg, struct rte_sched_port_params *port_params)
 	if (entry)
 		port_params->n_pipes_per_subport = (uint32_t)atoi(entry);
 
+	entry = cfg_get_entry(cfg, "port", "number of traffic classes per pipe");
+	if (entry)
+		port_params->n_traffic_classes = (uint32_t)atoi(entry);
+
+	entry = cfg_get_entry(cfg, "port", "number of queues per traffic class");
+	if (entry)
+		port_params->n_queues_per_traffic_class = (uint32_t)atoi(entry);
+
+	if (port_params->n_traffic_classes == 0 ||
+			port_params->n_traffic_classes > RTE_SCHED_TRAFFIC_CLASSES_MAX ||
+			port_params->n_queues_per_traffic_class == 0 ||
+			port_params->n_queues_per_traffic_class >
+				RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX)
+		rte_exit(EXIT_FAILURE, "Wrong pipe shape: %u traffic classes, "
+				"%u queues per traffic class\n",
+				port_params->n_traffic_classes,
+				port_params->n_queues_per_traffic_class);
+
 	entry = cfg_get_entry(cfg, "port", "queue sizes");
 	if (entry) {
 		char *next;
 
-		for(j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j++) {
+		for(j = 0; j < (int)port_params->n_traffic_classes; j++) {
 			port_params->qsize[j] = (uint16_t)strtol(entry, &next, 10);
 			if (next == NULL)
 				break;
@@ -351,7 +369,7 @@ cfg_load_port(struct cfg_file *cfg, struct rte_sched_port_params *port_params)
 	}
 
 #ifdef RTE_SCHED_RED
-	for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j++) {
+	for (j = 0; j < (int)port_params->n_traffic_classes; j++) {
 		char str[32];
 
 		/* Parse WRED min thresholds */
@@ -427,10 +445,12 @@ cfg_load_port(struct cfg_file *cfg, struct rte_sched_port_params *port_params)
 int
 cfg_load_pipe(struct cfg_file *cfg, struct rte_sched_pipe_params *pipe_params)
 {
-	int i, j;
+	int i, j, k;
 	char *next;
 	const char *entry;
 	int profiles;
+	int n_tcs = (int)port_params.n_traffic_classes;
+	int n_queues_per_tc = (int)port_params.n_queues_per_traffic_class;
 
 	if (!cfg || !pipe_params)
 		return -1;
@@ -454,66 +474,40 @@ cfg_load_pipe(struct cfg_file *cfg, struct rte_sched_pipe_params *pipe_params)
 		if (entry)
 			pipe_params[j].tc_period = (uint32_t)atoi(entry);
 
-		entry = cfg_get_entry(cfg, pipe_name, "tc 0 rate");
-		if (entry)
-			pipe_params[j].tc_rate[0] = (uint32_t)atoi(entry);
-
-		entry = cfg_get_entry(cfg, pipe_name, "tc 1 rate");
-		if (entry)
-			pipe_params[j].tc_rate[1] = (uint32_t)atoi(entry);
+		for (k = 0; k < n_tcs; k++) {
+			char str[32];
 
-		entry = cfg_get_entry(cfg, pipe_name, "tc 2 rate");
-		if (entry)
-			pipe_params[j].tc_rate[2] = (uint32_t)atoi(entry);
-
-		entry = cfg_get_entry(cfg, pipe_name, "tc 3 rate");
-		if (entry)
-			pipe_params[j].tc_rate[3] = (uint32_t)atoi(entry);
+			snprintf(str, sizeof(str), "tc %d rate", k);
+			entry = cfg_get_entry(cfg, pipe_name, str);
+			if (entry)
+				pipe_params[j].tc_rate[k] = (uint32_t)atoi(entry);
+		}
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-		entry = cfg_get_entry(cfg, pipe_name, "tc 3 oversubscription weight");
-		if (entry)
-			pipe_params[j].tc_ov_weight = (uint8_t)atoi(entry);
-#endif
+		{
+			char str[48];
 
-		entry = cfg_get_entry(cfg, pipe_name, "tc 0 wrr weights");
-		if (entry) {
-			for(i = 0; i < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
-				pipe_params[j].wrr_weights[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE*0 + i] =
-					(uint8_t)strtol(entry, &next, 10);
-				if (next == NULL)
-					break;
-				entry = next;
-			}
-		}
-		entry = cfg_get_entry(cfg, pipe_name, "tc 1 wrr weights");
-		if (entry) {
-			for(i = 0; i < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
-				pipe_params[j].wrr_weights[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE*1 + i] =
-					(uint8_t)strtol(entry, &next, 10);
-				if (next == NULL)
-					break;
-				entry = next;
-			}
-		}
-		entry = cfg_get_entry(cfg, pipe_name, "tc 2 wrr weights");
-		if (entry) {
-			for(i = 0; i < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
-				pipe_params[j].wrr_weights[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE*2 + i] =
-					(uint8_t)strtol(entry, &next, 10);
-				if (next == NULL)
-					break;
-				entry = next;
-			}
+			snprintf(str, sizeof(str), "tc %d oversubscription weight",
+				n_tcs - 1);
+			entry = cfg_get_entry(cfg, pipe_name, str);
+			if (entry)
+				pipe_params[j].tc_ov_weight = (uint8_t)atoi(entry);
 		}
-		entry = cfg_get_entry(cfg, pipe_name, "tc 3 wrr weights");
-		if (entry) {
-			for(i = 0; i < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
-				pipe_params[j].wrr_weights[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE*3 + i] =
-					(uint8_t)strtol(entry, &next, 10);
-				if (next == NULL)
-					break;
-				entry = next;
+#endif
+
+		for (k = 0; k < n_tcs; k++) {
+			char str[32];
+
+			snprintf(str, sizeof(str), "tc %d wrr weights", k);
+			entry = cfg_get_entry(cfg, pipe_name, str);
+			if (entry) {
+				for(i = 0; i < n_queues_per_tc; i++) {
+					pipe_params[j].wrr_weights[n_queues_per_tc*k + i] =
+						(uint8_t)strtol(entry, &next, 10);
+					if (next == NULL)
+						break;
+					entry = next;
+				}
 			}
 		}
 	}
@@ -548,21 +542,14 @@ cfg_load_subport(struct cfg_file *cfg, struct rte_sched_subport_params *subport_
 			if (entry)
 				subport_params[i].tc_period = (uint32_t)atoi(entry);
 
-			entry = cfg_get_entry(cfg, sec_name, "tc 0 rate");
-			if (entry)
-				subport_params[i].tc_rate[0] = (uint32_t)atoi(entry);
-
-			entry = cfg_get_entry(cfg, sec_name, "tc 1 rate");
-			if (entry)
-				subport_params[i].tc_rate[1] = (uint32_t)atoi(entry);
-
-			entry = cfg_get_entry(cfg, sec_name, "tc 2 rate");
-			if (entry)
-				subport_params[i].tc_rate[2] = (uint32_t)atoi(entry);
+			for (k = 0; k < (int)port_params.n_traffic_classes; k++) {
+				char str[32];
 
-			entry = cfg_get_entry(cfg, sec_name, "tc 3 rate");
-			if (entry)
-				subport_params[i].tc_rate[3] = (uint32_t)atoi(entry);
+				snprintf(str, sizeof(str), "tc %d rate", k);
+				entry = cfg_get_entry(cfg, sec_name, str);
+				if (entry)
+					subport_params[i].tc_rate[k] = (uint32_t)atoi(entry);
+			}
 
 			int n_entries = cfg_section_num_entries(cfg, sec_name);
 			struct cfg_entry entries[n_entries];
@@ -209,6 +209,8 @@ struct rte_sched_port_params port_params = {
 	.qsize = {64, 64, 64, 64},
 	.pipe_profiles = pipe_profiles,
 	.n_pipe_profiles = sizeof(pipe_profiles) / sizeof(struct rte_sched_pipe_params),
+	.n_traffic_classes = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE,
+	.n_queues_per_traffic_class = RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS,
 
 #ifdef RTE_SCHED_RED
 	.red_params = {
@@ -50,13 +50,13 @@ qavg_q(uint8_t port_id, uint32_t subport_id, uint32_t pipe_id, uint8_t tc, uint8
                         break;
         }
         if (i == nb_pfc || subport_id >= port_params.n_subports_per_port || pipe_id >= port_params.n_pipes_per_subport
-                        || tc >= RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE || q >= RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS)
+                        || tc >= port_params.n_traffic_classes || q >= port_params.n_queues_per_traffic_class)
                 return -1;
 
         port = qos_conf[i].sched_port;
 
-        queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + pipe_id);
-        queue_id = queue_id + (tc * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + q);
+        queue_id = port_params.n_traffic_classes * port_params.n_queues_per_traffic_class * (subport_id * port_params.n_pipes_per_subport + pipe_id);
+        queue_id = queue_id + (tc * port_params.n_queues_per_traffic_class + q);
 
         average = 0;
 
@@ -87,22 +87,22 @@ qavg_tcpipe(uint8_t port_id, uint32_t subport_id, uint32_t pipe_id, uint8_t tc)
                         break;
         }
         if (i == nb_pfc || subport_id >= port_params.n_subports_per_port || pipe_id >= port_params.n_pipes_per_subport
-                        || tc >= RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE)
+                        || tc >= port_params.n_traffic_classes)
                 return -1;
 
         port = qos_conf[i].sched_port;
 
-        queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + pipe_id);
+        queue_id = port_params.n_traffic_classes * port_params.n_queues_per_traffic_class * (subport_id * port_params.n_pipes_per_subport + pipe_id);
 
         average = 0;
 
         for (count = 0; count < qavg_ntimes; count++) {
                 part_average = 0;
-                for (i = 0; i < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
-                        rte_sched_queue_read_stats(port, queue_id + (tc * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + i), &stats, &qlen);
+                for (i = 0; i < port_params.n_queues_per_traffic_class; i++) {
+                        rte_sched_queue_read_stats(port, queue_id + (tc * port_params.n_queues_per_traffic_class + i), &stats, &qlen);
                         part_average += qlen;
                 }
-                average += part_average / RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
+                average += part_average / port_params.n_queues_per_traffic_class;
                 usleep(qavg_period);
         }
 
@@ -131,17 +131,17 @@ qavg_pipe(uint8_t port_id, uint32_t subport_id, uint32_t pipe_id)
 
         port = qos_conf[i].sched_port;
 
-        queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + pipe_id);
+        queue_id = port_params.n_traffic_classes * port_params.n_queues_per_traffic_class * (subport_id * port_params.n_pipes_per_subport + pipe_id);
 
         average = 0;
 
         for (count = 0; count < qavg_ntimes; count++) {
                 part_average = 0;
-                for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; i++) {
+                for (i = 0; i < port_params.n_traffic_classes * port_params.n_queues_per_traffic_class; i++) {
                         rte_sched_queue_read_stats(port, queue_id + i, &stats, &qlen);
                         part_average += qlen;
                 }
-                average += part_average / (RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS);
+                average += part_average / (port_params.n_traffic_classes * port_params.n_queues_per_traffic_class);
                 usleep(qavg_period);
         }
 
@@ -165,7 +165,7 @@ qavg_tcsubport(uint8_t port_id, uint32_t subport_id, uint8_t tc)
                 if (qos_conf[i].tx_port == port_id)
                         break;
         }
-        if (i == nb_pfc || subport_id >= port_params.n_subports_per_port || tc >= RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE)
+        if (i == nb_pfc || subport_id >= port_params.n_subports_per_port || tc >= port_params.n_traffic_classes)
                 return -1;
 
         port = qos_conf[i].sched_port;
@@ -175,15 +175,15 @@ qavg_tcsubport(uint8_t port_id, uint32_t subport_id, uint8_t tc)
         for (count = 0; count < qavg_ntimes; count++) {
                 part_average = 0;
                 for (i = 0; i < port_params.n_pipes_per_subport; i++) {
-                        queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + i);
+                        queue_id = port_params.n_traffic_classes * port_params.n_queues_per_traffic_class * (subport_id * port_params.n_pipes_per_subport + i);
 
-                        for (j = 0; j < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; j++) {
-                                rte_sched_queue_read_stats(port, queue_id + (tc * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + j), &stats, &qlen);
+                        for (j = 0; j < port_params.n_queues_per_traffic_class; j++) {
+                                rte_sched_queue_read_stats(port, queue_id + (tc * port_params.n_queues_per_traffic_class + j), &stats, &qlen);
                                 part_average += qlen;
                         }
                 }
 
-                average += part_average / (port_params.n_pipes_per_subport * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS);
+                average += part_average / (port_params.n_pipes_per_subport * port_params.n_queues_per_traffic_class);
                 usleep(qavg_period);
         }
 
@@ -217,15 +217,15 @@ qavg_subport(uint8_t port_id, uint32_t subport_id)
         for (count = 0; count < qavg_ntimes; count++) {
                 part_average = 0;
                 for (i = 0; i < port_params.n_pipes_per_subport; i++) {
-                        queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + i);
+                        queue_id = port_params.n_traffic_classes * port_params.n_queues_per_traffic_class * (subport_id * port_params.n_pipes_per_subport + i);
 
-                        for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; j++) {
+                        for (j = 0; j < port_params.n_traffic_classes * port_params.n_queues_per_traffic_class; j++) {
                                 rte_sched_queue_read_stats(port, queue_id + j, &stats, &qlen);
                                 part_average += qlen;
                         }
                 }
 
-                average += part_average / (port_params.n_pipes_per_subport * RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS);
+                average += part_average / (port_params.n_pipes_per_subport * port_params.n_traffic_classes * port_params.n_queues_per_traffic_class);
                 usleep(qavg_period);
         }
 
@@ -241,7 +241,7 @@ subport_stat(uint8_t port_id, uint32_t subport_id)
 {
         struct rte_sched_subport_stats stats;
         struct rte_sched_port *port;
-        uint32_t tc_ov[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+        uint32_t tc_ov[RTE_SCHED_TRAFFIC_CLASSES_MAX];
         uint8_t i;
 
         for (i = 0; i < nb_pfc; i++) {
@@ -261,8 +261,8 @@ subport_stat(uint8_t port_id, uint32_t subport_id)
         printf("| TC |   Pkts OK   |Pkts Dropped |  Bytes OK   |Bytes Dropped|  OV Status  |\n");
         printf("+----+-------------+-------------+-------------+-------------+-------------+\n");
 
-        for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
-                printf("|  %d | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " |\n", i,
+        for (i = 0; i < port_params.n_traffic_classes; i++) {
+                printf("| %2d | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " |\n", i,
                                 stats.n_pkts_tc[i], stats.n_pkts_tc_dropped[i],
                                 stats.n_bytes_tc[i], stats.n_bytes_tc_dropped[i], tc_ov[i]);
                 printf("+----+-------------+-------------+-------------+-------------+-------------+\n");
@@ -290,23 +290,23 @@ pipe_stat(uint8_t port_id, uint32_t subport_id, uint32_t pipe_id)
 
         port = qos_conf[i].sched_port;
 
-        queue_id = RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * (subport_id * port_params.n_pipes_per_subport + pipe_id);
+        queue_id = port_params.n_traffic_classes * port_params.n_queues_per_traffic_class * (subport_id * port_params.n_pipes_per_subport + pipe_id);
 
         printf("\n");
         printf("+----+-------+-------------+-------------+-------------+-------------+-------------+\n");
         printf("| TC | Queue |   Pkts OK   |Pkts Dropped |  Bytes OK   |Bytes Dropped|    Length   |\n");
         printf("+----+-------+-------------+-------------+-------------+-------------+-------------+\n");
 
-        for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
-                for (j = 0; j < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS; j++) {
+        for (i = 0; i < port_params.n_traffic_classes; i++) {
+                for (j = 0; j < port_params.n_queues_per_traffic_class; j++) {
 
-                        rte_sched_queue_read_stats(port, queue_id + (i * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + j), &stats, &qlen);
+                        rte_sched_queue_read_stats(port, queue_id + (i * port_params.n_queues_per_traffic_class + j), &stats, &qlen);
 
-                        printf("|  %d |   %d   | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11i |\n", i, j,
+                        printf("| %2d |   %d   | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11" PRIu32 " | %11i |\n", i, j,
                                         stats.n_pkts, stats.n_pkts_dropped, stats.n_bytes, stats.n_bytes_dropped, qlen);
                         printf("+----+-------+-------------+-------------+-------------+-------------+-------------+\n");
                 }
-                if (i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE - 1)
+                if (i < port_params.n_traffic_classes - 1)
                         printf("+----+-------+-------------+-------------+-------------+-------------+-------------+\n");
         }
         printf("\n");
@@ -31,13 +31,18 @@
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include <pthread.h>
 #include <rte_acl.h>
+#include <rte_lcore.h>
 #include "tb_mem.h"
 #include "acl.h"
 
 #define	ACL_POOL_ALIGN		8
 #define	ACL_POOL_ALLOC_MIN	0x800000
 
+/* minimum number of rules per thread of a parallel build */
+#define	ACL_PAR_MIN_RULES	0x100
+
 /* number of pointers per alloc */
 #define ACL_PTR_ALLOC	32
 
@@ -91,6 +96,8 @@ struct rte_acl_build_rule {
 	uint32_t                    *wildness;
 };
 
+struct acl_build_worker;
+
 /* Context for build phase */
 struct acl_build_context {
 	const struct rte_acl_ctx *acx;
@@ -100,11 +107,15 @@ struct acl_build_context {
 	uint32_t                  node;
 	uint32_t                  num_nodes;
 	uint32_t                  category_mask;
+	uint32_t                  first_rule; /* first rule of acx to build */
 	uint32_t                  num_rules;
 	uint32_t                  node_id;
 	uint32_t                  src_mask;
 	uint32_t                  num_build_rules;
 	uint32_t                  num_tries;
+	uint32_t                  max_tries;
+	uint32_t                  num_workers;
+	struct acl_build_worker   *workers; /* parallel build threads */
 	struct tb_mem_pool        pool;
 	struct rte_acl_trie       tries[RTE_ACL_MAX_TRIES];
 	struct rte_acl_bld_trie   bld_tries[RTE_ACL_MAX_TRIES];
@@ -1696,7 +1707,6 @@ static int
 acl_build_tries(struct acl_build_context *context,
 	struct rte_acl_build_rule *head)
 {
-	int32_t rc;
 	uint32_t n, num_tries;
 	struct rte_acl_config *config;
 	struct rte_acl_build_rule *last;
@@ -1714,11 +1724,6 @@ acl_build_tries(struct acl_build_context *context,
 
 	context->tries[0].type = RTE_ACL_FULL_TRIE;
 
-	/* calc wildness of each field of each rule */
-	rc = acl_calc_wildness(head, config);
-	if (rc != 0)
-		return rc;
-
 	for (n = 0;; n = num_tries) {
 
 		num_tries = n + 1;
@@ -1733,7 +1738,7 @@ acl_build_tries(struct acl_build_context *context,
 		if (last == NULL)
 			break;
 
-		if (num_tries == RTE_DIM(context->tries)) {
+		if (num_tries == context->max_tries) {
 			RTE_LOG(ERR, ACL,
 				"Exceeded max number of tries: %u\n",
 				num_tries);
@@ -1767,6 +1772,37 @@ acl_build_tries(struct acl_build_context *context,
 	return 0;
 }
 
+/*
+ * Parallel build.
+ * The rules, sorted by wildness, are split into contiguous subsets of
+ * about the same size. Each subset is built into its own trie(s) by a
+ * worker thread, with its own build context and temporary memory.
+ * The tries of all workers are then generated together, as if built
+ * by a single context.
+ */
+struct acl_build_worker {
+	pthread_t                  thread;
+	rte_cpuset_t               cpuset;
+	struct acl_build_context   bcx;
+	struct rte_acl_build_rule *rules;
+	int32_t                    rc;
+};
+
+/*
+ * Temporary memory of the build, with the workers.
+ */
+static size_t
+acl_build_mem(const struct acl_build_context *bcx)
+{
+	uint32_t n;
+	size_t sz;
+
+	sz = bcx->pool.alloc;
+	for (n = 0; n != bcx->num_workers; n++)
+		sz += bcx->workers[n].bcx.pool.alloc;
+	return sz;
+}
+
 static void
 acl_build_log(const struct acl_build_context *ctx)
 {
@@ -1775,11 +1811,13 @@ acl_build_log(const struct acl_build_context *ctx)
 	RTE_LOG(DEBUG, ACL, "Build phase for ACL \"%s\":\n"
 		"node limit for tree split: %u\n"
 		"nodes created: %u\n"
+		"build threads: %u\n"
 		"memory consumed: %zu\n",
 		ctx->acx->name,
 		ctx->node_max,
 		ctx->num_nodes,
-		ctx->pool.alloc);
+		RTE_MAX(ctx->num_workers, 1U),
+		acl_build_mem(ctx));
 
 	for (n = 0; n < RTE_DIM(ctx->tries); n++) {
 		if (ctx->tries[n].count != 0)
@@ -1800,7 +1838,7 @@ acl_build_rules(struct acl_build_context *bcx)
 	size_t ofs, sz;
 
 	fn = bcx->cfg.num_fields;
-	n = bcx->acx->num_rules;
+	n = bcx->acx->num_rules - bcx->first_rule;
 	ofs = n * sizeof(*br);
 	sz = ofs + n * fn * sizeof(*wp);
 
@@ -1812,7 +1850,8 @@ acl_build_rules(struct acl_build_context *bcx)
 
 	for (i = 0; i != n; i++) {
 		rule = (const struct rte_acl_rule *)
-			((uintptr_t)bcx->acx->rules + bcx->acx->rule_sz * i);
+			((uintptr_t)bcx->acx->rules +
+			bcx->acx->rule_sz * (bcx->first_rule + i));
 		if ((rule->data.category_mask & bcx->category_mask) != 0) {
 			br[num].next = head;
 			br[num].config = &bcx->cfg;
@@ -1848,26 +1887,167 @@ acl_set_data_indexes(struct rte_acl_ctx *ctx)
 	}
 }
 
+static void
+acl_build_worker_run(struct acl_build_worker *w)
+{
+	int32_t rc;
+
+	rc = sigsetjmp(w->bcx.pool.fail, 0);
+
+	/* build phase runs out of memory. */
+	if (rc == 0)
+		rc = acl_build_tries(&w->bcx, w->rules);
+	w->rc = rc;
+}
+
+static void *
+acl_build_worker_main(void *arg)
+{
+	struct acl_build_worker *w = arg;
+
+	/* run on any cpu of the application, not on the one of the caller */
+	rte_thread_set_affinity(&w->cpuset);
+	acl_build_worker_run(w);
+	return NULL;
+}
+
+static void
+acl_bld_init(struct acl_build_context *bcx, const struct rte_acl_ctx *ctx,
+	const struct rte_acl_config *cfg, uint32_t node_max)
+{
+	memset(bcx, 0, sizeof(*bcx));
+	bcx->acx = ctx;
+	bcx->pool.alignment = ACL_POOL_ALIGN;
+	bcx->pool.min_alloc = ACL_POOL_ALLOC_MIN;
+	bcx->cfg = *cfg;
+	bcx->category_mask = LEN2MASK(bcx->cfg.num_categories);
+	bcx->node_max = node_max;
+	bcx->max_tries = RTE_ACL_MAX_TRIES;
+}
+
+static void
+acl_build_free_workers(struct acl_build_context *bcx)
+{
+	uint32_t n;
+
+	for (n = 0; n != bcx->num_workers; n++)
+		tb_free_pool(&bcx->workers[n].bcx.pool);
+	free(bcx->workers);
+	bcx->workers = NULL;
+	bcx->num_workers = 0;
+}
+
+static void
+acl_bld_free(struct acl_build_context *bcx)
+{
+	acl_build_free_workers(bcx);
+	tb_free_pool(&bcx->pool);
+}
+
+static int
+acl_build_parallel(struct acl_build_context *bcx, uint32_t num_workers)
+{
+	uint32_t i, k, n, lcore_id, per_worker;
+	struct rte_acl_config *config;
+	struct rte_acl_build_rule *rule, *last;
+	struct acl_build_worker *w;
+	rte_cpuset_t cpuset;
+
+	bcx->workers = calloc(num_workers, sizeof(bcx->workers[0]));
+	if (bcx->workers == NULL)
+		return -ENOMEM;
+	bcx->num_workers = num_workers;
+
+	/* sort all rules with a copy of the config, as build_one_trie() */
+	config = acl_build_alloc(bcx, 1, sizeof(*config));
+	memcpy(config, &bcx->cfg, sizeof(*config));
+	for (rule = bcx->build_rules; rule != NULL; rule = rule->next)
+		rule->config = config;
+	acl_rule_stats(bcx->build_rules, config);
+	rule = sort_rules(bcx->build_rules);
+	bcx->build_rules = NULL;
+
+	/* the workers can run on all the cpus of the lcores */
+	CPU_ZERO(&cpuset);
+	RTE_LCORE_FOREACH(lcore_id) {
+		for (n = 0; n != CPU_SETSIZE; n++) {
+			if (CPU_ISSET(n, &lcore_config[lcore_id].cpuset))
+				CPU_SET(n, &cpuset);
+		}
+	}
+
+	/* split the rules and start the workers */
+	per_worker = (bcx->num_rules + num_workers - 1) / num_workers;
+	for (i = 0; i != num_workers; i++) {
+		w = bcx->workers + i;
+		acl_bld_init(&w->bcx, bcx->acx, &bcx->cfg, bcx->node_max);
+		w->bcx.max_tries = RTE_ACL_MAX_TRIES / num_workers;
+		w->cpuset = cpuset;
+		w->rules = rule;
+
+		for (n = 0, last = NULL; n != per_worker && rule != NULL;
+				n++, rule = rule->next) {
+			rule->config = &w->bcx.cfg;
+			last = rule;
+		}
+		if (last != NULL)
+			last->next = NULL;
+
+		if (w->rules == NULL) {
+			w->rc = -EINVAL;
+			w->thread = pthread_self();
+		} else if (pthread_create(&w->thread, NULL,
+				acl_build_worker_main, w) != 0) {
+			w->thread = pthread_self();
+			acl_build_worker_run(w);
+		}
+	}
+
+	/* wait for all workers, then gather their tries */
+	for (i = 0; i != num_workers; i++) {
+		w = bcx->workers + i;
+		if (!pthread_equal(w->thread, pthread_self()))
+			pthread_join(w->thread, NULL);
+	}
+
+	k = 0;
+	for (i = 0; i != num_workers; i++) {
+		w = bcx->workers + i;
+		if (w->rc != 0)
+			return w->rc;
+
+		bcx->num_nodes += w->bcx.num_nodes;
+		for (n = 0; n != w->bcx.num_tries; n++, k++) {
+			bcx->tries[k] = w->bcx.tries[n];
+			bcx->bld_tries[k] = w->bcx.bld_tries[n];
+			memcpy(bcx->data_indexes[k], w->bcx.data_indexes[n],
+				sizeof(bcx->data_indexes[k]));
+			bcx->tries[k].data_index = bcx->data_indexes[k];
+		}
+	}
+	bcx->num_tries = k;
+
+	return 0;
+}
+
 /*
  * Internal routine, performs 'build' phase of trie generation:
  * - setups build context.
  * - analizes given set of rules.
- * - builds internal tree(s).
+ * - builds internal tree(s), in parallel if configured so.
  */
 static int
 acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
-	const struct rte_acl_config *cfg, uint32_t node_max)
+	const struct rte_acl_config *cfg, uint32_t node_max,
+	uint32_t first_rule, uint32_t max_tries)
 {
 	int32_t rc;
+	uint32_t num_workers;
 
 	/* setup build context. */
-	memset(bcx, 0, sizeof(*bcx));
-	bcx->acx = ctx;
-	bcx->pool.alignment = ACL_POOL_ALIGN;
-	bcx->pool.min_alloc = ACL_POOL_ALLOC_MIN;
-	bcx->cfg = *cfg;
-	bcx->category_mask = LEN2MASK(bcx->cfg.num_categories);
-	bcx->node_max = node_max;
+	acl_bld_init(bcx, ctx, cfg, node_max);
+	bcx->first_rule = first_rule;
+	bcx->max_tries = max_tries;
 
 	rc = sigsetjmp(bcx->pool.fail, 0);
 
@@ -1885,13 +2065,38 @@ acl_bld(struct acl_build_context *bcx, struct rte_acl_ctx *ctx,
 		return rc;
 
 	/* No rules to build for that context+config */
-	if (bcx->build_rules == NULL) {
-		rc = -EINVAL;
-	} else {
-		/* build internal trie representation. */
-		rc = acl_build_tries(bcx, bcx->build_rules);
+	if (bcx->build_rules == NULL)
+		return -EINVAL;
+
+	/* calc wildness of each field of each rule */
+	rc = acl_calc_wildness(bcx->build_rules, &bcx->cfg);
+	if (rc != 0)
+		return rc;
+
+	num_workers = RTE_MIN(cfg->num_threads, max_tries);
+	num_workers = RTE_MIN(num_workers, bcx->num_rules / ACL_PAR_MIN_RULES);
+
+	if (num_workers > 1) {
+		rc = acl_build_parallel(bcx, num_workers);
+		if (rc == 0)
+			return 0;
+
+		/* a subset needs more tries than its share, do it serially */
+		RTE_LOG(DEBUG, ACL,
+			"ACL context: %s, parallel build with %u threads "
+			"failed with error code: %d, retrying with one\n",
+			bcx->acx->name, num_workers, rc);
+		acl_build_free_workers(bcx);
+		bcx->num_nodes = 0;
+		rc = acl_build_rules(bcx);
+		if (rc == 0)
+			rc = acl_calc_wildness(bcx->build_rules, &bcx->cfg);
+		if (rc != 0)
+			return rc;
 	}
-	return rc;
+
+	/* build internal trie representation. */
+	return acl_build_tries(bcx, bcx->build_rules);
 }
 
 int
@@ -1899,7 +2104,7 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 {
 	int32_t rc;
 	uint32_t n;
-	size_t max_size;
+	size_t max_size, mem_peak;
 	struct acl_build_context bcx;
 
 	if (ctx == NULL || cfg == NULL || cfg->num_categories == 0 ||
@@ -1916,10 +2121,11 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 		max_size = cfg->max_size;
 	}
 
+	mem_peak = 0;
 	for (rc = -ERANGE; n >= NODE_MIN && rc == -ERANGE; n /= 2) {
 
 		/* perform build phase. */
-		rc = acl_bld(&bcx, ctx, cfg, n);
+		rc = acl_bld(&bcx, ctx, cfg, n, 0, RTE_ACL_MAX_TRIES);
 
 		if (rc == 0) {
 			/* allocate and fill run-time  structures. */
@@ -1937,10 +2143,75 @@ rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg)
 		}
 
 		acl_build_log(&bcx);
+		mem_peak = RTE_MAX(mem_peak, acl_build_mem(&bcx));
+
+		ctx->bld_stats.num_threads = RTE_MAX(bcx.num_workers, 1U);
+		ctx->bld_stats.num_nodes = bcx.num_nodes;
 
 		/* cleanup after build. */
-		tb_free_pool(&bcx.pool);
+		acl_bld_free(&bcx);
+	}
+
+	ctx->bld_stats.temp_mem_peak = mem_peak;
+	ctx->bld_stats.runtime_mem = ctx->mem_sz;
+	ctx->bld_stats.num_tries = ctx->num_tries;
+
+	return rc;
+}
+
+int
+rte_acl_add_delta_rules(struct rte_acl_ctx *ctx,
+	const struct rte_acl_rule *rules, uint32_t num)
+{
+	int32_t rc;
+	uint32_t first_rule;
+	size_t max_size;
+	struct acl_build_context bcx;
+
+	if (ctx == NULL || rules == NULL || num == 0 || ctx->mem == NULL)
+		return -EINVAL;
+
+	if (ctx->num_tries == RTE_ACL_MAX_TRIES)
+		return -ENOSPC;
+
+	first_rule = ctx->num_rules;
+	rc = rte_acl_add_rules(ctx, rules, num);
+	if (rc != 0)
+		return rc;
+
+	max_size = (ctx->config.max_size == 0) ? SIZE_MAX :
+		ctx->config.max_size;
+
+	/* build the new rules only, and append their tries. */
+	rc = acl_bld(&bcx, ctx, &ctx->config, NODE_MIN, first_rule,
+		RTE_ACL_MAX_TRIES - ctx->num_tries);
+	if (rc == 0)
+		rc = rte_acl_gen_delta(ctx, bcx.tries, bcx.bld_tries,
+			bcx.num_tries, max_size);
+
+	acl_build_log(&bcx);
+
+	if (rc == 0) {
+		ctx->bld_stats.num_delta_tries += bcx.num_tries;
+		ctx->bld_stats.num_delta_rules += num;
+		ctx->bld_stats.num_tries = ctx->num_tries;
+		ctx->bld_stats.runtime_mem = ctx->mem_sz;
+	} else {
+		/* roll back the rules, the next full build ignores them */
+		ctx->num_rules = first_rule;
 	}
 
+	acl_bld_free(&bcx);
 	return rc;
 }
+
+int
+rte_acl_get_build_stats(const struct rte_acl_ctx *ctx,
+	struct rte_acl_build_stats *stats)
+{
+	if (ctx == NULL || stats == NULL)
+		return -EINVAL;
+
+	*stats = ctx->bld_stats;
+	return 0;
+}
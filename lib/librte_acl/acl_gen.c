@@ -443,11 +443,16 @@ acl_gen_node(struct rte_acl_node *node, uint64_t *node_array,
 	}
 }
 
+/*
+ * The nodes of the tries are laid out from the *node_start* index of the
+ * transitions array, and their match results from the *match_start* index
+ * of the results array.
+ */
 static void
 acl_calc_counts_indices(struct acl_node_counters *counts,
 	struct rte_acl_indices *indices,
 	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
-	uint64_t no_match)
+	uint64_t no_match, int32_t node_start, int32_t match_start)
 {
 	uint32_t n;
 
@@ -460,14 +465,14 @@ acl_calc_counts_indices(struct acl_node_counters *counts,
 			no_match, 1);
 	}
 
-	indices->dfa_index = RTE_ACL_DFA_SIZE + 1;
+	indices->dfa_index = node_start;
 	indices->quad_index = indices->dfa_index +
 		counts->dfa_gr64 * RTE_ACL_DFA_GR64_SIZE;
 	indices->single_index = indices->quad_index + counts->quad_vectors;
 	indices->match_start = indices->single_index + counts->single + 1;
 	indices->match_start = RTE_ALIGN(indices->match_start,
 		(XMM_SIZE / sizeof(uint64_t)));
-	indices->match_index = 1;
+	indices->match_index = match_start;
 }
 
 /*
@@ -490,7 +495,7 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 
 	/* Fill counts and indices arrays from the nodes. */
 	acl_calc_counts_indices(&counts, &indices,
-		node_bld_trie, num_tries, no_match);
+		node_bld_trie, num_tries, no_match, RTE_ACL_DFA_SIZE + 1, 1);
 
 	/* Allocate runtime memory (align to cache boundary) */
 	total_size = RTE_ALIGN(data_index_sz, RTE_CACHE_LINE_SIZE) +
@@ -551,6 +556,7 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	ctx->num_tries = num_tries;
 	ctx->num_categories = num_categories;
 	ctx->match_index = match_index;
+	ctx->num_matches = indices.match_index;
 	ctx->no_match = no_match;
 	ctx->idle = node_array[RTE_ACL_DFA_SIZE];
 	ctx->trans_table = node_array;
@@ -559,3 +565,99 @@ rte_acl_gen(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
 	acl_gen_log_stats(ctx, &counts, &indices, max_size);
 	return 0;
 }
+
+/*
+ * Generate the runtime structure of extra tries, appended to the ones
+ * already generated for the context.
+ * The new nodes are laid out after the existing ones, and their match
+ * results after the existing results: the transitions of the existing
+ * nodes, match ones included, remain valid in the new structure.
+ */
+int
+rte_acl_gen_delta(struct rte_acl_ctx *ctx, struct rte_acl_trie *trie,
+	struct rte_acl_bld_trie *node_bld_trie, uint32_t num_tries,
+	size_t max_size)
+{
+	void *mem;
+	size_t total_size, index_sz;
+	uint64_t *node_array;
+	uint32_t n, k, match_index;
+	struct rte_acl_match_results *match;
+	struct acl_node_counters counts;
+	struct rte_acl_indices indices;
+
+	if (ctx->num_tries + num_tries > RTE_ACL_MAX_TRIES)
+		return -ENOSPC;
+
+	/* Lay the new nodes out where the match results started. */
+	acl_calc_counts_indices(&counts, &indices, node_bld_trie, num_tries,
+		ctx->no_match, ctx->match_index, ctx->num_matches);
+
+	index_sz = (uintptr_t)ctx->trans_table - (uintptr_t)ctx->mem;
+	total_size = index_sz +
+		indices.match_start * sizeof(uint64_t) +
+		(ctx->num_matches + counts.match) *
+		sizeof(struct rte_acl_match_results) +
+		XMM_SIZE;
+
+	if (total_size > max_size) {
+		RTE_LOG(DEBUG, ACL,
+			"Gen phase for ACL ctx \"%s\" exceeds max_size limit, "
+			"bytes required: %zu, allowed: %zu\n",
+			ctx->name, total_size, max_size);
+		return -ERANGE;
+	}
+
+	mem = rte_zmalloc_socket(ctx->name, total_size, RTE_CACHE_LINE_SIZE,
+			ctx->socket_id);
+	if (mem == NULL) {
+		RTE_LOG(ERR, ACL,
+			"allocation of %zu bytes on socket %d for %s failed\n",
+			total_size, ctx->socket_id, ctx->name);
+		return -ENOMEM;
+	}
+
+	/* Copy the data indexes and the nodes, then the match results. */
+	match_index = indices.match_start;
+	node_array = (uint64_t *)((uintptr_t)mem + index_sz);
+	memcpy(mem, ctx->mem, index_sz + ctx->match_index * sizeof(uint64_t));
+	match = (struct rte_acl_match_results *)(node_array + match_index);
+	memcpy(match, ctx->trans_table + ctx->match_index,
+		ctx->num_matches * sizeof(*match));
+
+	for (n = 0; n < num_tries; n++) {
+
+		acl_gen_node(node_bld_trie[n].trie, node_array, ctx->no_match,
+			&indices, ctx->num_categories);
+
+		if (node_bld_trie[n].trie->node_index == ctx->no_match)
+			trie[n].root_index = 0;
+		else
+			trie[n].root_index = node_bld_trie[n].trie->node_index;
+	}
+
+	/* Append the new tries and point all data indexes to the copy. */
+	for (n = 0; n < num_tries; n++) {
+		k = ctx->num_tries + n;
+		ctx->trie[k] = trie[n];
+		memcpy((uint32_t *)mem + k * RTE_ACL_MAX_FIELDS,
+			trie[n].data_index, trie[n].num_data_indexes *
+			sizeof(ctx->data_indexes[0]));
+	}
+	for (n = 0; n < ctx->num_tries + num_tries; n++)
+		ctx->trie[n].data_index = (uint32_t *)mem +
+			n * RTE_ACL_MAX_FIELDS;
+
+	rte_free(ctx->mem);
+
+	ctx->mem = mem;
+	ctx->mem_sz = total_size;
+	ctx->data_indexes = mem;
+	ctx->num_tries += num_tries;
+	ctx->match_index = match_index;
+	ctx->num_matches = indices.match_index;
+	ctx->trans_table = node_array;
+
+	acl_gen_log_stats(ctx, &counts, &indices, max_size);
+	return 0;
+}
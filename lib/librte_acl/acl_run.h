@@ -37,6 +37,7 @@
 #include <rte_acl.h>
 #include "acl.h"
 
+#define MAX_SEARCHES_AVX512	32
 #define MAX_SEARCHES_AVX16	16
 #define MAX_SEARCHES_SSE8	8
 #define MAX_SEARCHES_SSE4	4
@@ -54,7 +55,7 @@
 
 /*
  * Structure to manage N parallel trie traversals.
- * The runtime trie traversal routines can process 8, 4, or 2 tries
+ * The runtime trie traversal routines can process 32, 16, 8, 4, or 2 tries
  * in parallel. Each packet may require multiple trie traversals (up to 4).
  * This structure is used to fill the slots (0 to n-1) for parallel processing
  * with the trie traversals needed for each packet.
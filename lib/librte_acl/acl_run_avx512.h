@@ -0,0 +1,336 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include "acl_run_avx2.h"
+
+static const rte_zmm_t zmm_match_mask = {
+	.u32 = {
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+		RTE_ACL_NODE_MATCH, RTE_ACL_NODE_MATCH,
+	},
+};
+
+static const rte_zmm_t zmm_index_mask = {
+	.u32 = {
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+		RTE_ACL_NODE_INDEX, RTE_ACL_NODE_INDEX,
+	},
+};
+
+static const rte_zmm_t zmm_shuffle_input = {
+	.u32 = {
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+		0x00000000, 0x04040404, 0x08080808, 0x0c0c0c0c,
+	},
+};
+
+static const rte_zmm_t zmm_ones_8 = {
+	.u32 = {
+		0x01010101, 0x01010101, 0x01010101, 0x01010101,
+		0x01010101, 0x01010101, 0x01010101, 0x01010101,
+		0x01010101, 0x01010101, 0x01010101, 0x01010101,
+		0x01010101, 0x01010101, 0x01010101, 0x01010101,
+	},
+};
+
+static const rte_zmm_t zmm_ones_16 = {
+	.u32 = {
+		0x00010001, 0x00010001, 0x00010001, 0x00010001,
+		0x00010001, 0x00010001, 0x00010001, 0x00010001,
+		0x00010001, 0x00010001, 0x00010001, 0x00010001,
+		0x00010001, 0x00010001, 0x00010001, 0x00010001,
+	},
+};
+
+static const rte_zmm_t zmm_range_base = {
+	.u32 = {
+		0xffffff00, 0xffffff04, 0xffffff08, 0xffffff0c,
+		0xffffff00, 0xffffff04, 0xffffff08, 0xffffff0c,
+		0xffffff00, 0xffffff04, 0xffffff08, 0xffffff0c,
+		0xffffff00, 0xffffff04, 0xffffff08, 0xffffff0c,
+	},
+};
+
+/*
+ * Process 16 transitions in parallel.
+ * tr_lo contains low 32 bits for 16 transition.
+ * tr_hi contains high 32 bits for 16 transition.
+ * next_input contains up to 4 input bytes for 16 flows.
+ * Same calculations as ACL_TR_CALC_ADDR(), but AVX512 comparisons
+ * produce bit masks instead of vectors, so blend through them.
+ */
+static inline __attribute__((always_inline)) zmm_t
+transition16(zmm_t next_input, const uint64_t *trans, zmm_t *tr_lo,
+	zmm_t *tr_hi)
+{
+	const int32_t *tr;
+	zmm_t addr, in, node_type, r, t, dfa_ofs, quad_ofs;
+	__mmask16 dfa_msk;
+	__mmask64 quad_msk;
+
+	tr = (const int32_t *)(uintptr_t)trans;
+
+	in = _mm512_shuffle_epi8(next_input, zmm_shuffle_input.z);
+
+	/* Calc node type and node addr */
+	node_type = _mm512_andnot_si512(zmm_index_mask.z, *tr_lo);
+	addr = _mm512_and_si512(zmm_index_mask.z, *tr_lo);
+
+	/* mask for DFA type(0) nodes */
+	dfa_msk = _mm512_testn_epi32_mask(node_type, node_type);
+
+	/* DFA calculations. */
+	r = _mm512_srli_epi32(in, 30);
+	r = _mm512_add_epi8(r, zmm_range_base.z);
+	t = _mm512_srli_epi32(in, 24);
+	r = _mm512_shuffle_epi8(*tr_hi, r);
+
+	dfa_ofs = _mm512_sub_epi32(t, r);
+
+	/* QUAD/SINGLE calculations: count range boundaries below input. */
+	quad_msk = _mm512_cmpgt_epi8_mask(in, *tr_hi);
+	t = _mm512_maskz_mov_epi8(quad_msk, zmm_ones_8.z);
+	t = _mm512_maddubs_epi16(t, zmm_ones_8.z);
+	quad_ofs = _mm512_madd_epi16(t, zmm_ones_16.z);
+
+	/* blend DFA and QUAD/SINGLE. */
+	t = _mm512_mask_mov_epi32(quad_ofs, dfa_msk, dfa_ofs);
+
+	/* calculate address for next transitions. */
+	addr = _mm512_add_epi32(addr, t);
+
+	/* load lower 32 bits of 16 transactions at once. */
+	*tr_lo = _mm512_i32gather_epi32(addr, tr, sizeof(trans[0]));
+
+	next_input = _mm512_srli_epi32(next_input, CHAR_BIT);
+
+	/* load high 32 bits of 16 transactions at once. */
+	*tr_hi = _mm512_i32gather_epi32(addr, tr + 1, sizeof(trans[0]));
+
+	return next_input;
+}
+
+/*
+ * Check for matches in 16 flows, and restart the completed ones
+ * with their next trie (or the idle one).
+ */
+static inline void
+acl_match_check_avx512x16(const struct rte_acl_ctx *ctx,
+	struct parms *parms, struct acl_flow_data *flows, uint32_t slot,
+	zmm_t *tr_lo, zmm_t *tr_hi)
+{
+	uint32_t i, msk;
+	uint64_t tr;
+	rte_zmm_t lo, hi;
+
+	msk = _mm512_test_epi32_mask(*tr_lo, zmm_match_mask.z);
+
+	while (msk != 0) {
+
+		lo.z = *tr_lo;
+		hi.z = *tr_hi;
+
+		do {
+			i = __builtin_ctz(msk);
+			msk &= msk - 1;
+
+			/*
+			 * Low 32bits of the transition are enough
+			 * to process the match.
+			 */
+			tr = acl_match_check(lo.u32[i], slot + i,
+				ctx, parms, flows, resolve_priority_sse);
+			lo.u32[i] = (uint32_t)tr;
+			hi.u32[i] = (uint32_t)(tr >> 32);
+		} while (msk != 0);
+
+		*tr_lo = lo.z;
+		*tr_hi = hi.z;
+
+		/* the first transition of the next trie can be a match. */
+		msk = _mm512_test_epi32_mask(*tr_lo, zmm_match_mask.z);
+	}
+}
+
+/*
+ * Gather 4 bytes of input data for 16 flows.
+ */
+static inline zmm_t
+acl_input_avx512x16(struct parms *parms, uint32_t slot)
+{
+	uint32_t i;
+	rte_zmm_t in;
+
+	for (i = 0; i != RTE_DIM(in.u32); i++)
+		in.u32[i] = GET_NEXT_4BYTES(parms, slot + i);
+
+	return in.z;
+}
+
+/*
+ * Execute trie traversal for up to 32 flows in parallel:
+ * two independent sets of 16 flows, one per ZMM register,
+ * to hide the latency of the gathers.
+ */
+static inline int
+search_avx512x32(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	uint32_t i, n;
+	struct acl_flow_data flows;
+	uint64_t tr;
+	struct completion cmplt[MAX_SEARCHES_AVX512];
+	struct parms parms[MAX_SEARCHES_AVX512];
+	rte_zmm_t lo, hi;
+	zmm_t input[2], tr_lo[2], tr_hi[2];
+
+	acl_set_flow(&flows, cmplt, RTE_DIM(cmplt), data, results,
+		total_packets, categories, ctx->trans_table);
+
+	for (n = 0; n < RTE_DIM(cmplt); n++)
+		cmplt[n].count = 0;
+
+	for (n = 0; n != RTE_DIM(tr_lo); n++) {
+		for (i = 0; i != RTE_DIM(lo.u32); i++) {
+			tr = acl_start_next_trie(&flows, parms,
+				n * RTE_DIM(lo.u32) + i, ctx);
+			lo.u32[i] = (uint32_t)tr;
+			hi.u32[i] = (uint32_t)(tr >> 32);
+		}
+		tr_lo[n] = lo.z;
+		tr_hi[n] = hi.z;
+	}
+
+	/* Check for any matches. */
+	acl_match_check_avx512x16(ctx, parms, &flows, 0,
+		&tr_lo[0], &tr_hi[0]);
+	acl_match_check_avx512x16(ctx, parms, &flows, 16,
+		&tr_lo[1], &tr_hi[1]);
+
+	while (flows.started > 0) {
+
+		input[0] = acl_input_avx512x16(parms, 0);
+		input[1] = acl_input_avx512x16(parms, 16);
+
+		input[0] = transition16(input[0], flows.trans,
+			&tr_lo[0], &tr_hi[0]);
+		input[1] = transition16(input[1], flows.trans,
+			&tr_lo[1], &tr_hi[1]);
+
+		input[0] = transition16(input[0], flows.trans,
+			&tr_lo[0], &tr_hi[0]);
+		input[1] = transition16(input[1], flows.trans,
+			&tr_lo[1], &tr_hi[1]);
+
+		input[0] = transition16(input[0], flows.trans,
+			&tr_lo[0], &tr_hi[0]);
+		input[1] = transition16(input[1], flows.trans,
+			&tr_lo[1], &tr_hi[1]);
+
+		input[0] = transition16(input[0], flows.trans,
+			&tr_lo[0], &tr_hi[0]);
+		input[1] = transition16(input[1], flows.trans,
+			&tr_lo[1], &tr_hi[1]);
+
+		/* Check for any matches. */
+		acl_match_check_avx512x16(ctx, parms, &flows, 0,
+			&tr_lo[0], &tr_hi[0]);
+		acl_match_check_avx512x16(ctx, parms, &flows, 16,
+			&tr_lo[1], &tr_hi[1]);
+	}
+
+	return 0;
+}
+
+/*
+ * Execute trie traversal for up to 16 flows in parallel.
+ */
+static inline int
+search_avx512x16(const struct rte_acl_ctx *ctx, const uint8_t **data,
+	uint32_t *results, uint32_t total_packets, uint32_t categories)
+{
+	uint32_t n;
+	struct acl_flow_data flows;
+	uint64_t tr;
+	struct completion cmplt[MAX_SEARCHES_AVX16];
+	struct parms parms[MAX_SEARCHES_AVX16];
+	rte_zmm_t lo, hi;
+	zmm_t input, tr_lo, tr_hi;
+
+	acl_set_flow(&flows, cmplt, RTE_DIM(cmplt), data, results,
+		total_packets, categories, ctx->trans_table);
+
+	for (n = 0; n < RTE_DIM(cmplt); n++) {
+		cmplt[n].count = 0;
+		tr = acl_start_next_trie(&flows, parms, n, ctx);
+		lo.u32[n] = (uint32_t)tr;
+		hi.u32[n] = (uint32_t)(tr >> 32);
+	}
+
+	tr_lo = lo.z;
+	tr_hi = hi.z;
+
+	/* Check for any matches. */
+	acl_match_check_avx512x16(ctx, parms, &flows, 0, &tr_lo, &tr_hi);
+
+	while (flows.started > 0) {
+
+		input = acl_input_avx512x16(parms, 0);
+
+		input = transition16(input, flows.trans, &tr_lo, &tr_hi);
+		input = transition16(input, flows.trans, &tr_lo, &tr_hi);
+		input = transition16(input, flows.trans, &tr_lo, &tr_hi);
+		input = transition16(input, flows.trans, &tr_lo, &tr_hi);
+
+		/* Check for any matches. */
+		acl_match_check_avx512x16(ctx, parms, &flows, 0,
+			&tr_lo, &tr_hi);
+	}
+
+	return 0;
+}
@@ -57,11 +57,26 @@ rte_acl_classify_avx2(__rte_unused const struct rte_acl_ctx *ctx,
 	return -ENOTSUP;
 }
 
+/*
+ * If the compiler doesn't support AVX512 instructions,
+ * then the dummy one would be used instead for AVX512 classify method.
+ */
+int __attribute__ ((weak))
+rte_acl_classify_avx512(__rte_unused const struct rte_acl_ctx *ctx,
+	__rte_unused const uint8_t **data,
+	__rte_unused uint32_t *results,
+	__rte_unused uint32_t num,
+	__rte_unused uint32_t categories)
+{
+	return -ENOTSUP;
+}
+
 static const rte_acl_classify_t classify_fns[] = {
 	[RTE_ACL_CLASSIFY_DEFAULT] = rte_acl_classify_scalar,
 	[RTE_ACL_CLASSIFY_SCALAR] = rte_acl_classify_scalar,
 	[RTE_ACL_CLASSIFY_SSE] = rte_acl_classify_sse,
 	[RTE_ACL_CLASSIFY_AVX2] = rte_acl_classify_avx2,
+	[RTE_ACL_CLASSIFY_AVX512] = rte_acl_classify_avx512,
 };
 
 /* by default, use always available scalar code path. */
@@ -74,37 +89,83 @@ rte_acl_set_default_classify(enum rte_acl_classify_alg alg)
 	rte_acl_default_classify = alg;
 }
 
+/*
+ * Check that given classify method is built in and could run on this CPU.
+ */
+static int
+acl_check_alg(enum rte_acl_classify_alg alg)
+{
+	switch (alg) {
+	case RTE_ACL_CLASSIFY_DEFAULT:
+	case RTE_ACL_CLASSIFY_SCALAR:
+		return 0;
+	case RTE_ACL_CLASSIFY_SSE:
+		if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1))
+			return 0;
+		break;
+	case RTE_ACL_CLASSIFY_AVX2:
+#ifdef CC_AVX2_SUPPORT
+		if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
+			return 0;
+#endif
+		break;
+	case RTE_ACL_CLASSIFY_AVX512:
+#ifdef CC_AVX512_SUPPORT
+		if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512F) &&
+				rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX512BW))
+			return 0;
+#endif
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return -ENOTSUP;
+}
+
 extern int
 rte_acl_set_ctx_classify(struct rte_acl_ctx *ctx, enum rte_acl_classify_alg alg)
 {
+	int rc;
+
 	if (ctx == NULL || (uint32_t)alg >= RTE_DIM(classify_fns))
 		return -EINVAL;
 
+	rc = acl_check_alg(alg);
+	if (rc != 0)
+		return rc;
+
 	ctx->alg = alg;
 	return 0;
 }
 
 /*
  * Select highest available classify method as default one.
- * Note that CLASSIFY_AVX2 should be set as a default only
- * if both conditions are met:
- * at build time compiler supports AVX2 and target cpu supports AVX2.
+ * Note that CLASSIFY_AVX2 and CLASSIFY_AVX512 should be set as a default
+ * only if both conditions are met:
+ * at build time compiler supports them and target cpu supports them.
+ * As some CPUs lower their frequency while running 512-bit instructions,
+ * which slows down the rest of the core, CLASSIFY_AVX512 is a default
+ * only with CONFIG_RTE_LIBRTE_ACL_AVX512_DEFAULT, otherwise it has to be
+ * selected explicitly with rte_acl_set_ctx_classify().
  */
 static void __attribute__((constructor))
 rte_acl_init(void)
 {
-	enum rte_acl_classify_alg alg = RTE_ACL_CLASSIFY_DEFAULT;
-
-#ifdef CC_AVX2_SUPPORT
-	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_AVX2))
-		alg = RTE_ACL_CLASSIFY_AVX2;
-	else if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1))
-#else
-	if (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_1))
+	uint32_t i;
+	static const enum rte_acl_classify_alg alg[] = {
+#ifdef RTE_LIBRTE_ACL_AVX512_DEFAULT
+		RTE_ACL_CLASSIFY_AVX512,
 #endif
-		alg = RTE_ACL_CLASSIFY_SSE;
+		RTE_ACL_CLASSIFY_AVX2,
+		RTE_ACL_CLASSIFY_SSE,
+	};
+
+	for (i = 0; i != RTE_DIM(alg) && acl_check_alg(alg[i]) != 0; i++)
+		;
 
-	rte_acl_set_default_classify(alg);
+	rte_acl_set_default_classify((i != RTE_DIM(alg)) ? alg[i] :
+		RTE_ACL_CLASSIFY_DEFAULT);
 }
 
 int
@@ -343,6 +404,9 @@ rte_acl_dump(const struct rte_acl_ctx *ctx)
 	printf("  num_rules=%"PRIu32"\n", ctx->num_rules);
 	printf("  num_categories=%"PRIu32"\n", ctx->num_categories);
 	printf("  num_tries=%"PRIu32"\n", ctx->num_tries);
+	printf("  num_delta_tries=%"PRIu32"\n",
+		ctx->bld_stats.num_delta_tries);
+	printf("  mem_sz=%zu\n", ctx->mem_sz);
 }
 
 /*
@@ -96,6 +96,11 @@ struct rte_acl_config {
 	/**< array of field definitions. */
 	size_t max_size;
 	/**< max memory limit for internal run-time structures. */
+	uint32_t num_threads;
+	/**<
+	 * number of threads building the tries in parallel,
+	 * 0 or 1 to build them in the calling thread.
+	 */
 };
 
 /**
@@ -248,6 +253,72 @@ rte_acl_reset_rules(struct rte_acl_ctx *ctx);
 int
 rte_acl_build(struct rte_acl_ctx *ctx, const struct rte_acl_config *cfg);
 
+/**
+ * Add rules to a built ACL context and make them active at once.
+ * This function is not multi-thread safe, in particular it must not run
+ * at the same time as a classification with that context.
+ *
+ * The rules are added to the context, as with rte_acl_add_rules(), and
+ * built into one or more extra tries, with the build configuration of
+ * the last rte_acl_build(). The tries are appended to the run-time
+ * structures: the classification resolves the priorities between these
+ * rules and the others as usual. Only the new rules are built, which is
+ * much faster than a full rebuild of a large rule set, at the cost of
+ * one more trie to walk per classified input. The next rte_acl_build()
+ * merges them with the other rules.
+ *
+ * @param ctx
+ *   ACL context to add rules to, already built.
+ * @param rules
+ *   Array of rules to add to the ACL context, in the same format as for
+ *   rte_acl_add_rules().
+ * @param num
+ *   Number of elements in the input array of rules.
+ * @return
+ *   - -EINVAL if the parameters are invalid or the context is not built.
+ *   - -ENOSPC if the context has no room for another trie: a full
+ *     rte_acl_build() is needed.
+ *   - -ENOMEM if there is no space in the ACL context for these rules,
+ *     or not enough memory to build them.
+ *   - -ERANGE if the run-time structures would exceed the max_size of
+ *     the build configuration.
+ *   - Zero if operation completed successfully.
+ *   On error, the context and its run-time structures are not modified.
+ */
+int
+rte_acl_add_delta_rules(struct rte_acl_ctx *ctx,
+	const struct rte_acl_rule *rules, uint32_t num);
+
+/**
+ * Statistics of the builds of an ACL context.
+ */
+struct rte_acl_build_stats {
+	size_t   temp_mem_peak;  /**< Peak temporary memory of the last build. */
+	size_t   runtime_mem;    /**< Size of the run-time structures. */
+	uint32_t num_threads;    /**< Threads used by the last build. */
+	uint32_t num_tries;      /**< Number of tries, including delta ones. */
+	uint32_t num_nodes;      /**< Build nodes created by the last build. */
+	uint32_t num_delta_tries; /**< Tries added by rte_acl_add_delta_rules. */
+	uint32_t num_delta_rules; /**< Rules added by rte_acl_add_delta_rules. */
+};
+
+/**
+ * Get the statistics of the builds of an ACL context: full builds with
+ * rte_acl_build() and additions of rules since then with
+ * rte_acl_add_delta_rules().
+ *
+ * @param ctx
+ *   ACL context.
+ * @param stats
+ *   Structure filled with the statistics.
+ * @return
+ *   - -EINVAL if the parameters are invalid.
+ *   - Zero on success.
+ */
+int
+rte_acl_get_build_stats(const struct rte_acl_ctx *ctx,
+	struct rte_acl_build_stats *stats);
+
 /**
  * Delete all rules from the ACL context and
  * destroy all internal run-time structures.
@@ -267,6 +338,7 @@ enum rte_acl_classify_alg {
 	RTE_ACL_CLASSIFY_SCALAR = 1,  /**< generic implementation. */
 	RTE_ACL_CLASSIFY_SSE = 2,     /**< requires SSE4.1 support. */
 	RTE_ACL_CLASSIFY_AVX2 = 3,    /**< requires AVX2 support. */
+	RTE_ACL_CLASSIFY_AVX512 = 4,  /**< requires AVX512F/BW support. */
 	RTE_ACL_CLASSIFY_NUM          /* should always be the last one. */
 };
 
@@ -352,10 +424,9 @@ rte_acl_classify_alg(const struct rte_acl_ctx *ctx,
  *   ACL context to change classify function for.
  * @param alg
  *   New default classify algorithm for given ACL context.
- *   It is the caller responsibility to ensure that the value refers to the
- *   existing algorithm, and that it could be run on the given CPU.
  * @return
  *   - -EINVAL if the parameters are invalid.
+ *   - -ENOTSUP if the algorithm isn't built in, or can't run on this CPU.
  *   - Zero if operation completed successfully.
  */
 extern int
@@ -40,6 +40,9 @@
 #include <rte_errno.h>
 #include <rte_string_fns.h>
 #include <rte_eal_memconfig.h>
+#ifdef RTE_MACHINE_CPUFLAG_SSE2
+#include <rte_vect.h>
+#endif
 #include "rte_distributor.h"
 
 #define NO_FLAGS 0
@@ -54,6 +57,7 @@
 #define RTE_DISTRIB_NO_BUF 0       /**< empty flags: no buffer requested */
 #define RTE_DISTRIB_GET_BUF (1)    /**< worker requests a buffer, returns old */
 #define RTE_DISTRIB_RETURN_BUF (2) /**< worker returns a buffer, no request */
+#define RTE_DISTRIB_VALID_BUF (4)  /**< burst entry holds a buffer */
 
 #define RTE_DISTRIB_BACKLOG_SIZE 8
 #define RTE_DISTRIB_BACKLOG_MASK (RTE_DISTRIB_BACKLOG_SIZE - 1)
@@ -86,6 +90,44 @@ struct rte_distributor_backlog {
 	int64_t pkts[RTE_DISTRIB_BACKLOG_SIZE];
 };
 
+/**
+ * Buffer structure used in burst mode. The distributor passes up to
+ * RTE_DISTRIB_BURST_SIZE packets to the worker in the first cache line, with
+ * the request flags kept in the first entry, and the worker returns its
+ * previous packets in the third one, so that each side only writes to its
+ * own cache line. Padding is used for the same reason as above.
+ */
+struct rte_distributor_burst_buffer {
+	volatile int64_t bufptr64[RTE_DISTRIB_BURST_SIZE] __rte_cache_aligned;
+	char pad1[RTE_CACHE_LINE_SIZE];
+	volatile int64_t retptr64[RTE_DISTRIB_BURST_SIZE] __rte_cache_aligned;
+	char pad2[RTE_CACHE_LINE_SIZE];
+} __rte_cache_aligned;
+
+struct rte_distributor_burst_backlog {
+	unsigned count;
+	struct rte_mbuf *pkts[RTE_DISTRIB_BURST_SIZE];
+};
+
+/**
+ * Burst mode state, stored right after the distributor structure.
+ */
+struct rte_distributor_burst {
+	uint16_t tags[RTE_DISTRIB_MAX_WORKERS][RTE_DISTRIB_BURST_SIZE * 2]
+			__rte_cache_aligned;
+		/**< Tags of the packets being processed by each worker, followed
+		 * by the tags of its backlog; 0 for an unused entry. Kept
+		 * together so that all of them are compared at once.
+		 */
+	uint64_t active_bitmask;
+		/**< Workers which requested packets and did not shut down */
+	unsigned next_worker;  /**< Round robin start for new flows */
+
+	struct rte_distributor_burst_backlog backlog[RTE_DISTRIB_MAX_WORKERS];
+
+	struct rte_distributor_burst_buffer bufs[RTE_DISTRIB_MAX_WORKERS];
+};
+
 struct rte_distributor_returned_pkts {
 	unsigned start;
 	unsigned count;
@@ -97,6 +139,7 @@ struct rte_distributor {
 
 	char name[RTE_DISTRIBUTOR_NAMESIZE];  /**< Name of the ring. */
 	unsigned num_workers;                 /**< Number of workers polling */
+	struct rte_distributor_burst *burst;  /**< Burst mode state, or NULL */
 
 	uint32_t in_flight_tags[RTE_DISTRIB_MAX_WORKERS];
 		/**< Tracks the tag being processed per core */
@@ -169,6 +212,94 @@ rte_distributor_return_pkt(struct rte_distributor *d,
 	return 0;
 }
 
+/**** APIs called by workers in burst mode ****/
+
+int
+rte_distributor_request_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned count)
+{
+	struct rte_distributor_burst_buffer *buf = &d->burst->bufs[worker_id];
+	unsigned i;
+
+	if (count > RTE_DISTRIB_BURST_SIZE)
+		return -EINVAL;
+
+	/* wait for the distributor to take the previous request into account */
+	while (unlikely(buf->bufptr64[0] &
+			(RTE_DISTRIB_GET_BUF | RTE_DISTRIB_RETURN_BUF)))
+		rte_pause();
+
+	for (i = 0; i < count; i++)
+		buf->retptr64[i] = (((int64_t)(uintptr_t)oldpkt[i]) <<
+				RTE_DISTRIB_FLAG_BITS) | RTE_DISTRIB_VALID_BUF;
+	for (; i < RTE_DISTRIB_BURST_SIZE; i++)
+		buf->retptr64[i] = 0;
+
+	buf->bufptr64[0] = RTE_DISTRIB_GET_BUF;
+	return 0;
+}
+
+int
+rte_distributor_poll_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **pkts)
+{
+	struct rte_distributor_burst_buffer *buf = &d->burst->bufs[worker_id];
+	unsigned i, count = 0;
+
+	if (buf->bufptr64[0] & RTE_DISTRIB_GET_BUF)
+		return -1;
+
+	for (i = 0; i < RTE_DISTRIB_BURST_SIZE; i++) {
+		/* since bufptr64 is signed, this should be an arithmetic shift */
+		int64_t data = buf->bufptr64[i];
+
+		if (!(data & RTE_DISTRIB_VALID_BUF))
+			break;
+		pkts[count++] = (struct rte_mbuf *)
+				((uintptr_t)(data >> RTE_DISTRIB_FLAG_BITS));
+	}
+	return count;
+}
+
+int
+rte_distributor_get_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **pkts,
+		struct rte_mbuf **oldpkt, unsigned count)
+{
+	int ret;
+
+	ret = rte_distributor_request_pkt_burst(d, worker_id, oldpkt, count);
+	if (ret < 0)
+		return ret;
+	while ((ret = rte_distributor_poll_pkt_burst(d, worker_id, pkts)) < 0)
+		rte_pause();
+	return ret;
+}
+
+int
+rte_distributor_return_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned num)
+{
+	struct rte_distributor_burst_buffer *buf = &d->burst->bufs[worker_id];
+	unsigned i;
+
+	if (num > RTE_DISTRIB_BURST_SIZE)
+		return -EINVAL;
+
+	while (unlikely(buf->bufptr64[0] &
+			(RTE_DISTRIB_GET_BUF | RTE_DISTRIB_RETURN_BUF)))
+		rte_pause();
+
+	for (i = 0; i < num; i++)
+		buf->retptr64[i] = (((int64_t)(uintptr_t)oldpkt[i]) <<
+				RTE_DISTRIB_FLAG_BITS) | RTE_DISTRIB_VALID_BUF;
+	for (; i < RTE_DISTRIB_BURST_SIZE; i++)
+		buf->retptr64[i] = 0;
+
+	buf->bufptr64[0] = RTE_DISTRIB_RETURN_BUF;
+	return 0;
+}
+
 /**** APIs called on distributor core ***/
 
 /* as name suggests, adds a packet to the backlog for a particular worker */
@@ -281,6 +412,228 @@ process_returns(struct rte_distributor *d)
 	return flushed;
 }
 
+/* tag used in burst mode for a packet: 16 bits folded from the user tag,
+ * never 0 as that marks unused entries */
+static inline uint16_t
+burst_tag(const struct rte_mbuf *mb)
+{
+	uint16_t tag = (uint16_t)(mb->hash.usr ^ (mb->hash.usr >> 16));
+
+	return tag | (tag == 0);
+}
+
+/* returns the worker processing or having in its backlog a packet with the
+ * given tag, or -1 if there is none */
+static inline int
+find_match_burst(const struct rte_distributor *d, uint16_t tag)
+{
+	const struct rte_distributor_burst *b = d->burst;
+	unsigned wkr;
+
+#ifdef RTE_MACHINE_CPUFLAG_SSE2
+	const __m128i tag_vec = _mm_set1_epi16(tag);
+
+	for (wkr = 0; wkr < d->num_workers; wkr++) {
+		__m128i inflight = _mm_load_si128(
+				(const __m128i *)&b->tags[wkr][0]);
+		__m128i backlog = _mm_load_si128((const __m128i *)
+				&b->tags[wkr][RTE_DISTRIB_BURST_SIZE]);
+
+		if (_mm_movemask_epi8(_mm_or_si128(
+				_mm_cmpeq_epi16(inflight, tag_vec),
+				_mm_cmpeq_epi16(backlog, tag_vec))))
+			return wkr;
+	}
+#else
+	unsigned i;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++) {
+		unsigned match = 0;
+
+		for (i = 0; i < RTE_DISTRIB_BURST_SIZE * 2; i++)
+			match |= (b->tags[wkr][i] == tag);
+		if (match)
+			return wkr;
+	}
+#endif
+	return -1;
+}
+
+/* returns the active worker with the shortest backlog that still has room,
+ * in round robin order among the equally loaded ones, or -1 if there is none */
+static inline int
+find_worker_burst(const struct rte_distributor *d)
+{
+	struct rte_distributor_burst *b = d->burst;
+	unsigned i, wkr = b->next_worker;
+	unsigned best_count = RTE_DISTRIB_BURST_SIZE;
+	int best = -1;
+
+	for (i = 0; i < d->num_workers; i++) {
+		if (((b->active_bitmask >> wkr) & 1) &&
+				b->backlog[wkr].count < best_count) {
+			best = wkr;
+			best_count = b->backlog[wkr].count;
+			if (best_count == 0)
+				break;
+		}
+		if (++wkr == d->num_workers)
+			wkr = 0;
+	}
+
+	if (best >= 0)
+		b->next_worker = ((unsigned)best + 1 == d->num_workers) ?
+				0 : (unsigned)best + 1;
+	return best;
+}
+
+/* hands the backlog of a worker waiting for packets to it */
+static void
+release_burst(struct rte_distributor *d, unsigned wkr)
+{
+	struct rte_distributor_burst *b = d->burst;
+	struct rte_distributor_burst_buffer *buf = &b->bufs[wkr];
+	struct rte_distributor_burst_backlog *bl = &b->backlog[wkr];
+	unsigned i;
+
+	/* the backlog becomes the set of packets being processed */
+	for (i = 0; i < RTE_DISTRIB_BURST_SIZE; i++) {
+		b->tags[wkr][i] = b->tags[wkr][RTE_DISTRIB_BURST_SIZE + i];
+		b->tags[wkr][RTE_DISTRIB_BURST_SIZE + i] = 0;
+	}
+
+	for (i = 1; i < RTE_DISTRIB_BURST_SIZE; i++)
+		buf->bufptr64[i] = (i < bl->count) ?
+			(((int64_t)(uintptr_t)bl->pkts[i]) <<
+				RTE_DISTRIB_FLAG_BITS) | RTE_DISTRIB_VALID_BUF :
+			0;
+	/* written last, as it also clears the request flag */
+	buf->bufptr64[0] = (((int64_t)(uintptr_t)bl->pkts[0]) <<
+			RTE_DISTRIB_FLAG_BITS) | RTE_DISTRIB_VALID_BUF;
+
+	bl->count = 0;
+}
+
+static void
+handle_worker_shutdown_burst(struct rte_distributor *d, unsigned wkr)
+{
+	struct rte_distributor_burst *b = d->burst;
+	struct rte_distributor_burst_backlog *bl = &b->backlog[wkr];
+
+	b->active_bitmask &= ~(1UL << wkr);
+	memset(b->tags[wkr], 0, sizeof(b->tags[wkr]));
+	b->bufs[wkr].bufptr64[0] = 0;
+
+	if (unlikely(bl->count != 0)) {
+		/* queue the backlog to the other workers, as in single
+		 * packet mode */
+		struct rte_mbuf *pkts[RTE_DISTRIB_BURST_SIZE];
+		unsigned count = bl->count;
+
+		memcpy(pkts, bl->pkts, count * sizeof(pkts[0]));
+		bl->count = 0;
+		rte_distributor_process(d, pkts, count);
+	}
+}
+
+/* collects the packets returned by a worker, and gives it its backlog if it
+ * is waiting for packets. Returns 1 if the worker was given packets. */
+static int
+poll_worker_burst(struct rte_distributor *d, unsigned wkr)
+{
+	struct rte_distributor_burst *b = d->burst;
+	struct rte_distributor_burst_buffer *buf = &b->bufs[wkr];
+	const int64_t data = buf->bufptr64[0];
+	unsigned i;
+
+	if (!(data & (RTE_DISTRIB_GET_BUF | RTE_DISTRIB_RETURN_BUF)))
+		return 0;
+
+	for (i = 0; i < RTE_DISTRIB_BURST_SIZE; i++) {
+		const int64_t ret = buf->retptr64[i];
+
+		if (!(ret & RTE_DISTRIB_VALID_BUF))
+			break;
+		store_return(ret >> RTE_DISTRIB_FLAG_BITS, d,
+				&d->returns.start, &d->returns.count);
+		buf->retptr64[i] = 0;
+	}
+
+	if (data & RTE_DISTRIB_RETURN_BUF) {
+		handle_worker_shutdown_burst(d, wkr);
+		return 0;
+	}
+
+	/* the worker is done with the packets it was given */
+	b->active_bitmask |= (1UL << wkr);
+	for (i = 0; i < RTE_DISTRIB_BURST_SIZE; i++)
+		b->tags[wkr][i] = 0;
+
+	if (b->backlog[wkr].count == 0)
+		return 0;
+
+	release_burst(d, wkr);
+	return 1;
+}
+
+/* queues a packet to the worker processing its flow, or else to the least
+ * loaded worker, waiting for the workers if all the backlogs are full */
+static inline void
+distribute_pkt_burst(struct rte_distributor *d, struct rte_mbuf *mb)
+{
+	struct rte_distributor_burst *b = d->burst;
+	const uint16_t tag = burst_tag(mb);
+	unsigned i;
+
+	for (;;) {
+		int wkr = find_match_burst(d, tag);
+
+		if (wkr < 0)
+			wkr = find_worker_burst(d);
+
+		if (wkr >= 0 &&
+				b->backlog[wkr].count < RTE_DISTRIB_BURST_SIZE) {
+			struct rte_distributor_burst_backlog *bl =
+					&b->backlog[wkr];
+
+			b->tags[wkr][RTE_DISTRIB_BURST_SIZE + bl->count] = tag;
+			bl->pkts[bl->count++] = mb;
+			/* hand over full bursts as soon as possible */
+			if (bl->count == RTE_DISTRIB_BURST_SIZE)
+				poll_worker_burst(d, wkr);
+			return;
+		}
+
+		/* Note that a worker shutting down while we wait moves its
+		 * backlog, so the worker has to be searched again. */
+		for (i = 0; i < d->num_workers; i++)
+			poll_worker_burst(d, i);
+		rte_pause();
+	}
+}
+
+static int
+process_burst(struct rte_distributor *d, struct rte_mbuf **mbufs,
+		unsigned num_mbufs)
+{
+	unsigned i, wkr, flushed = 0;
+
+	for (wkr = 0; wkr < d->num_workers; wkr++)
+		flushed += poll_worker_burst(d, wkr);
+
+	if (unlikely(num_mbufs == 0))
+		return flushed;
+
+	for (i = 0; i < num_mbufs; i++)
+		distribute_pkt_burst(d, mbufs[i]);
+
+	/* to finish, hand the backlogs to the workers waiting for packets */
+	for (wkr = 0; wkr < d->num_workers; wkr++)
+		poll_worker_burst(d, wkr);
+
+	return num_mbufs;
+}
+
 /* process a set of packets to distribute them to workers */
 int
 rte_distributor_process(struct rte_distributor *d,
@@ -294,6 +647,9 @@ rte_distributor_process(struct rte_distributor *d,
 	unsigned ret_start = d->returns.start,
 			ret_count = d->returns.count;
 
+	if (d->burst != NULL)
+		return process_burst(d, mbufs, num_mbufs);
+
 	if (unlikely(num_mbufs == 0))
 		return process_returns(d);
 
@@ -410,7 +766,16 @@ rte_distributor_returned_pkts(struct rte_distributor *d,
 static inline unsigned
 total_outstanding(const struct rte_distributor *d)
 {
-	unsigned wkr, total_outstanding;
+	unsigned wkr, i, total_outstanding = 0;
+
+	if (d->burst != NULL) {
+		for (wkr = 0; wkr < d->num_workers; wkr++) {
+			for (i = 0; i < RTE_DISTRIB_BURST_SIZE; i++)
+				total_outstanding += (d->burst->tags[wkr][i] != 0);
+			total_outstanding += d->burst->backlog[wkr].count;
+		}
+		return total_outstanding;
+	}
 
 	total_outstanding = __builtin_popcountl(d->in_flight_bitmask);
 
@@ -443,30 +808,37 @@ rte_distributor_clear_returns(struct rte_distributor *d)
 #endif
 }
 
-/* creates a distributor instance */
-struct rte_distributor *
-rte_distributor_create(const char *name,
-		unsigned socket_id,
-		unsigned num_workers)
+static struct rte_distributor *
+distributor_create(const char *name, unsigned socket_id,
+		unsigned num_workers, int burst)
 {
 	struct rte_distributor *d;
 	struct rte_distributor_list *distributor_list;
 	char mz_name[RTE_MEMZONE_NAMESIZE];
 	const struct rte_memzone *mz;
+	size_t size;
 
 	/* compilation-time checks */
 	RTE_BUILD_BUG_ON((sizeof(*d) & RTE_CACHE_LINE_MASK) != 0);
 	RTE_BUILD_BUG_ON((RTE_DISTRIB_MAX_WORKERS & 7) != 0);
 	RTE_BUILD_BUG_ON(RTE_DISTRIB_MAX_WORKERS >
 				sizeof(d->in_flight_bitmask) * CHAR_BIT);
+	RTE_BUILD_BUG_ON(RTE_DISTRIB_MAX_WORKERS >
+				sizeof(d->burst->active_bitmask) * CHAR_BIT);
+	RTE_BUILD_BUG_ON(RTE_DISTRIB_BURST_SIZE * sizeof(int64_t) >
+				RTE_CACHE_LINE_SIZE);
 
 	if (name == NULL || num_workers >= RTE_DISTRIB_MAX_WORKERS) {
 		rte_errno = EINVAL;
 		return NULL;
 	}
 
+	size = sizeof(*d);
+	if (burst)
+		size += sizeof(struct rte_distributor_burst);
+
 	snprintf(mz_name, sizeof(mz_name), RTE_DISTRIB_PREFIX"%s", name);
-	mz = rte_memzone_reserve(mz_name, sizeof(*d), socket_id, NO_FLAGS);
+	mz = rte_memzone_reserve(mz_name, size, socket_id, NO_FLAGS);
 	if (mz == NULL) {
 		rte_errno = ENOMEM;
 		return NULL;
@@ -475,6 +847,8 @@ rte_distributor_create(const char *name,
 	d = mz->addr;
 	snprintf(d->name, sizeof(d->name), "%s", name);
 	d->num_workers = num_workers;
+	/* burst state follows the cache aligned distributor structure */
+	d->burst = burst ? (struct rte_distributor_burst *)(d + 1) : NULL;
 
 	distributor_list = RTE_TAILQ_CAST(rte_distributor_tailq.head,
 					  rte_distributor_list);
@@ -485,3 +859,21 @@ rte_distributor_create(const char *name,
 
 	return d;
 }
+
+/* creates a distributor instance */
+struct rte_distributor *
+rte_distributor_create(const char *name,
+		unsigned socket_id,
+		unsigned num_workers)
+{
+	return distributor_create(name, socket_id, num_workers, 0);
+}
+
+/* creates a distributor instance working with bursts of packets */
+struct rte_distributor *
+rte_distributor_create_burst(const char *name,
+		unsigned socket_id,
+		unsigned num_workers)
+{
+	return distributor_create(name, socket_id, num_workers, 1);
+}
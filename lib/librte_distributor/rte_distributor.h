@@ -39,7 +39,9 @@
  * RTE distributor
  *
  * The distributor is a component which is designed to pass packets
- * one-at-a-time to workers, with dynamic load balancing.
+ * one-at-a-time to workers, with dynamic load balancing. A distributor
+ * created with rte_distributor_create_burst() passes them instead in bursts
+ * of up to RTE_DISTRIB_BURST_SIZE packets, using the burst worker API.
  */
 
 #ifdef __cplusplus
@@ -50,6 +52,8 @@ extern "C" {
 
 #define RTE_DISTRIBUTOR_NAMESIZE 32 /**< Length of name for instance */
 
+#define RTE_DISTRIB_BURST_SIZE 8 /**< Max packets exchanged with a worker */
+
 struct rte_distributor;
 
 /**
@@ -72,6 +76,35 @@ struct rte_distributor *
 rte_distributor_create(const char *name, unsigned socket_id,
 		unsigned num_workers);
 
+/**
+ * Function to create a new distributor instance working in burst mode
+ *
+ * Same as rte_distributor_create(), except that the workers request and
+ * return packets in bursts of up to RTE_DISTRIB_BURST_SIZE packets at a time,
+ * exchanged through one cache line per direction, which lowers the cost per
+ * packet on the distributor lcore. Workers of such an instance must use the
+ * burst worker APIs only, e.g. rte_distributor_get_pkt_burst(). The
+ * distributor lcore APIs are the same for both modes.
+ *
+ * In burst mode, all the packets of a flow queued to a worker are passed to
+ * it in order, and no two packets with the same tag are processed by two
+ * workers at the same time. Tags are folded to 16 bits for the comparisons,
+ * so distinct flows may occasionally be held to the same worker.
+ *
+ * @param name
+ *   The name to be given to the distributor instance.
+ * @param socket_id
+ *   The NUMA node on which the memory is to be allocated
+ * @param num_workers
+ *   The maximum number of workers that will request packets from this
+ *   distributor
+ * @return
+ *   The newly created distributor instance
+ */
+struct rte_distributor *
+rte_distributor_create_burst(const char *name, unsigned socket_id,
+		unsigned num_workers);
+
 /*  *** APIS to be called on the distributor lcore ***  */
 /*
  * The following APIs are the public APIs which are designed for use on a
@@ -241,6 +274,111 @@ struct rte_mbuf *
 rte_distributor_poll_pkt(struct rte_distributor *d,
 		unsigned worker_id);
 
+/*  *** APIS to be called on the worker lcores in burst mode ***  */
+/*
+ * The following APIs are the equivalent of the above ones for distributor
+ * instances created with rte_distributor_create_burst(). They must not be
+ * mixed with the single packet APIs for the same distributor instance.
+ */
+
+/**
+ * API called by a worker to get new packets to process. All the packets
+ * previously given to the worker are assumed to have completed processing,
+ * and may be optionally returned to the distributor via the oldpkt array.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param pkts
+ *   The array of RTE_DISTRIB_BURST_SIZE mbuf pointers to be filled in
+ * @param oldpkt
+ *   The previous packets, if any, being processed by the worker
+ * @param count
+ *   The number of packets in the oldpkt array, at most RTE_DISTRIB_BURST_SIZE
+ *
+ * @return
+ *   The number of new packets to be processed by the worker thread, or
+ *   -EINVAL if more than RTE_DISTRIB_BURST_SIZE packets are returned.
+ */
+int
+rte_distributor_get_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **pkts,
+		struct rte_mbuf **oldpkt, unsigned count);
+
+/**
+ * API called by a worker to return completed packets without requesting
+ * new ones, for example, because a worker thread is shutting down. The
+ * packets queued for the worker are then distributed to the other workers.
+ *
+ * This must not be called while a request made with
+ * rte_distributor_request_pkt_burst() has not yet been fulfilled.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param oldpkt
+ *   The previous packets being processed by the worker
+ * @param num
+ *   The number of packets in the oldpkt array
+ * @return
+ *   0 on success, -EINVAL if more than RTE_DISTRIB_BURST_SIZE packets are
+ *   returned.
+ */
+int
+rte_distributor_return_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned num);
+
+/**
+ * API called by a worker to request new packets to process, without
+ * waiting for them. The packets previously given to the worker are assumed
+ * to have completed processing, and may be optionally returned to the
+ * distributor via the oldpkt array.
+ *
+ * NOTE: after calling this function, rte_distributor_poll_pkt_burst() should
+ * be used to poll for the packets requested.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param oldpkt
+ *   The previous packets, if any, being processed by the worker
+ * @param count
+ *   The number of packets in the oldpkt array, at most RTE_DISTRIB_BURST_SIZE
+ * @return
+ *   0 on success, -EINVAL if more than RTE_DISTRIB_BURST_SIZE packets are
+ *   returned. Nothing is requested in this case.
+ */
+int
+rte_distributor_request_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **oldpkt, unsigned count);
+
+/**
+ * API called by a worker to check for new packets that were previously
+ * requested by a call to rte_distributor_request_pkt_burst(). It does not
+ * wait for the packets to be available.
+ *
+ * @param d
+ *   The distributor instance to be used
+ * @param worker_id
+ *   The worker instance number to use - must be less that num_workers passed
+ *   at distributor creation time.
+ * @param pkts
+ *   The array of RTE_DISTRIB_BURST_SIZE mbuf pointers to be filled in
+ *
+ * @return
+ *   The number of new packets to be processed by the worker thread, or -1
+ *   if the request has not yet been fulfilled.
+ */
+int
+rte_distributor_poll_pkt_burst(struct rte_distributor *d,
+		unsigned worker_id, struct rte_mbuf **pkts);
+
 #ifdef __cplusplus
 }
 #endif
@@ -442,6 +442,8 @@ rte_eal_init(int argc, char **argv)
 	if (!rte_atomic32_test_and_set(&run_once))
 		return -1;
 
+	eal_timing_start();
+
 	thread_id = pthread_self();
 
 	if (rte_eal_log_early_init() < 0)
@@ -457,11 +459,15 @@ rte_eal_init(int argc, char **argv)
 	/* set log level as early as possible */
 	rte_set_log_level(internal_config.log_level);
 
+	eal_timing_step("arguments");
+
 	if (internal_config.no_hugetlbfs == 0 &&
 			internal_config.process_type != RTE_PROC_SECONDARY &&
 			eal_hugepage_info_init() < 0)
 		rte_panic("Cannot get hugepage information\n");
 
+	eal_timing_step("hugepage info");
+
 	if (internal_config.memory == 0 && internal_config.force_sockets == 0) {
 		if (internal_config.no_hugetlbfs)
 			internal_config.memory = MEMSIZE_IF_NO_HUGE_PAGE;
@@ -487,12 +493,16 @@ rte_eal_init(int argc, char **argv)
 	if (rte_eal_memory_init() < 0)
 		rte_panic("Cannot init memory\n");
 
+	eal_timing_step("memory");
+
 	if (rte_eal_memzone_init() < 0)
 		rte_panic("Cannot init memzone\n");
 
 	if (rte_eal_tailqs_init() < 0)
 		rte_panic("Cannot init tail queues for objects\n");
 
+	eal_timing_step("memzones and tailqs");
+
 /*	if (rte_eal_log_init(argv[0], internal_config.syslog_facility) < 0)
 		rte_panic("Cannot init logs\n");*/
 
@@ -508,6 +518,8 @@ rte_eal_init(int argc, char **argv)
 	if (rte_eal_pci_init() < 0)
 		rte_panic("Cannot init PCI\n");
 
+	eal_timing_step("interrupts and timer");
+
 	eal_check_mem_on_local_socket();
 
 	rte_eal_mcfg_complete();
@@ -550,10 +562,15 @@ rte_eal_init(int argc, char **argv)
 	rte_eal_mp_remote_launch(sync_func, NULL, SKIP_MASTER);
 	rte_eal_mp_wait_lcore();
 
+	eal_timing_step("lcores and devices");
+
 	/* Probe & Initialize PCI devices */
 	if (rte_eal_pci_probe())
 		rte_panic("Cannot probe PCI\n");
 
+	eal_timing_step("pci probe");
+	eal_timing_dump();
+
 	return fctret;
 }
 
@@ -30,6 +30,7 @@
  *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
+#include <errno.h>
 #include <sys/mman.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -41,6 +42,7 @@
 #include <rte_eal_memconfig.h>
 #include <rte_log.h>
 #include <rte_string_fns.h>
+#include <rte_common.h>
 #include "eal_private.h"
 #include "eal_internal_cfg.h"
 #include "eal_filesystem.h"
@@ -59,6 +61,34 @@ rte_mem_virt2phy(const void *virtaddr)
 	return RTE_BAD_PHYS_ADDR;
 }
 
+/*
+ * contigmem buffers are all reserved at boot, memory cannot grow at runtime.
+ */
+int
+rte_eal_memseg_grow(int socket_id, size_t len)
+{
+	RTE_SET_USED(socket_id);
+	RTE_SET_USED(len);
+	return -ENOTSUP;
+}
+
+int
+rte_eal_memseg_release(const void *addr)
+{
+	RTE_SET_USED(addr);
+	return -EINVAL;
+}
+
+/* memory cannot grow at runtime, the generation never changes */
+const volatile uint32_t *__rte_eal_memseg_shared_gen;
+uint32_t __rte_eal_memseg_gen;
+
+int
+__rte_eal_memseg_sync(void)
+{
+	return 0;
+}
+
 static int
 rte_eal_contigmem_init(void)
 {
@@ -0,0 +1,101 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdint.h>
+#include <inttypes.h>
+#include <time.h>
+
+#include <rte_log.h>
+#include <rte_common.h>
+
+#include "eal_private.h"
+
+#define EAL_TIMING_MAX_STEPS 32
+
+/* one step of the EAL initialization and the time it took */
+struct eal_timing_step {
+	const char *name;
+	uint64_t ns;
+};
+
+static struct eal_timing_step eal_timing_steps[EAL_TIMING_MAX_STEPS];
+static unsigned eal_timing_nb_steps;
+static uint64_t eal_timing_start_ns;
+static uint64_t eal_timing_last_ns;
+
+/* rdtsc is not calibrated yet during most of the initialization */
+static uint64_t
+eal_timing_now(void)
+{
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+		return 0;
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+void
+eal_timing_start(void)
+{
+	eal_timing_nb_steps = 0;
+	eal_timing_start_ns = eal_timing_now();
+	eal_timing_last_ns = eal_timing_start_ns;
+}
+
+void
+eal_timing_step(const char *name)
+{
+	uint64_t now = eal_timing_now();
+
+	if (eal_timing_nb_steps < EAL_TIMING_MAX_STEPS) {
+		eal_timing_steps[eal_timing_nb_steps].name = name;
+		eal_timing_steps[eal_timing_nb_steps].ns =
+			now - eal_timing_last_ns;
+		eal_timing_nb_steps++;
+	}
+	eal_timing_last_ns = now;
+}
+
+void
+eal_timing_dump(void)
+{
+	unsigned i;
+
+	RTE_LOG(INFO, EAL, "Initialization took %" PRIu64 " ms\n",
+		(eal_timing_last_ns - eal_timing_start_ns) / 1000000);
+	for (i = 0; i < eal_timing_nb_steps; i++)
+		RTE_LOG(INFO, EAL, "  %-20s %8" PRIu64 ".%03" PRIu64 " ms\n",
+			eal_timing_steps[i].name,
+			eal_timing_steps[i].ns / 1000000,
+			eal_timing_steps[i].ns / 1000 % 1000);
+}
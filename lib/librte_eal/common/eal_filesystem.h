@@ -84,6 +84,23 @@ eal_hugepage_info_path(void)
 	return buffer;
 }
 
+/** Path of the file tracking memory segments added at runtime. */
+#define MEMGROW_INFO_FMT "%s/.%s_memgrow_info"
+
+static inline const char *
+eal_memgrow_info_path(void)
+{
+	static char buffer[PATH_MAX]; /* static so auto-zeroed */
+	const char *directory = default_config_dir;
+	const char *home_dir = getenv("HOME");
+
+	if (getuid() != 0 && home_dir != NULL)
+		directory = home_dir;
+	snprintf(buffer, sizeof(buffer) - 1, MEMGROW_INFO_FMT, directory,
+			internal_config.hugefile_prefix);
+	return buffer;
+}
+
 /** String format for hugepage map files. */
 #define HUGEFILE_FMT "%s/%smap_%d"
 #define TEMP_HUGEFILE_FMT "%s/%smap_temp_%d"
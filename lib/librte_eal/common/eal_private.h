@@ -232,4 +232,29 @@ int rte_eal_dev_init(void);
  */
 int rte_eal_check_module(const char *module_name);
 
+/**
+ * Start timing the EAL initialization.
+ *
+ * This function is private to EAL.
+ */
+void eal_timing_start(void);
+
+/**
+ * Record the end of an initialization step, which covers the time
+ * elapsed since the previous step or since eal_timing_start().
+ *
+ * This function is private to EAL.
+ *
+ * @param name
+ *   Name of the step, must remain valid until eal_timing_dump() is called.
+ */
+void eal_timing_step(const char *name);
+
+/**
+ * Log the time taken by each recorded initialization step.
+ *
+ * This function is private to EAL.
+ */
+void eal_timing_dump(void);
+
 #endif /* _EAL_PRIVATE_H_ */
@@ -175,6 +175,85 @@ unsigned rte_memory_get_nchannel(void);
  */
 unsigned rte_memory_get_nrank(void);
 
+/**
+ * Map additional hugepages as a new memory segment.
+ *
+ * This is only available on Linux when the EAL was started with the
+ * --mem-grow option. The segment is appended to the memseg table and is
+ * visible to all processes sharing the memory configuration once they
+ * call rte_eal_memseg_sync(). It is only virtually contiguous: its
+ * phys_addr field is the physical address of the first hugepage, use
+ * rte_mem_virt2phy() for other addresses. The segment is not made
+ * available to the memzone allocator.
+ *
+ * @param socket_id
+ *   The NUMA socket the hugepages must be allocated on.
+ * @param len
+ *   Minimum length of the segment, rounded up to the hugepage size.
+ * @return
+ *   - The index of the new segment in the memseg table on success.
+ *   - (-ENOTSUP) if memory cannot grow at runtime.
+ *   - (-EINVAL) if socket_id is invalid.
+ *   - (-ENOSPC) if the memseg table is full.
+ *   - (-ENOMEM) if not enough hugepages are available on the socket.
+ */
+int rte_eal_memseg_grow(int socket_id, size_t len);
+
+/**
+ * Unmap a memory segment added by rte_eal_memseg_grow() and give its
+ * hugepages back to the system.
+ *
+ * The segment must not be in use by any process anymore. The other
+ * processes unmap it on their next call to rte_eal_memseg_sync().
+ *
+ * @param addr
+ *   Start virtual address of the segment.
+ * @return
+ *   - 0 on success.
+ *   - (-EINVAL) if addr is not the start of a segment added at runtime.
+ */
+int rte_eal_memseg_release(const void *addr);
+
+/**
+ * Map the memory segments added, and unmap the segments released, by other
+ * processes since the previous call.
+ *
+ * This is cheap when the memseg table did not change, and a no-op when
+ * memory cannot grow at runtime.
+ *
+ * @return
+ *   0 on success, negative if a segment cannot be mapped at the address
+ *   used by the process which added it.
+ */
+static inline int rte_eal_memseg_sync(void);
+
+/**
+ * @internal Generation of the memseg table shared by all processes,
+ * bumped when a segment is added or released at runtime. NULL when
+ * memory cannot grow at runtime.
+ */
+extern const volatile uint32_t *__rte_eal_memseg_shared_gen;
+
+/**
+ * @internal Generation of the memseg table mapped by this process.
+ */
+extern uint32_t __rte_eal_memseg_gen;
+
+/**
+ * @internal Map and unmap the segments changed since __rte_eal_memseg_gen.
+ */
+int __rte_eal_memseg_sync(void);
+
+static inline int
+rte_eal_memseg_sync(void)
+{
+	/* the allocation paths only pay for a comparison, without lock */
+	if (__rte_eal_memseg_shared_gen == NULL ||
+			*__rte_eal_memseg_shared_gen == __rte_eal_memseg_gen)
+		return 0;
+	return __rte_eal_memseg_sync();
+}
+
 #ifdef RTE_LIBRTE_XEN_DOM0
 /**
  * Return the physical address of elt, which is an element of the pool mp.
@@ -359,6 +359,7 @@ eal_usage(const char *prgname)
 	       "  --"OPT_CREATE_UIO_DEV"    Create /dev/uioX (usually done by hotplug)\n"
 	       "  --"OPT_VFIO_INTR"         Interrupt mode for VFIO (legacy|msi|msix)\n"
 	       "  --"OPT_XEN_DOM0"          Support running on Xen dom0 without hugetlbfs\n"
+	       "  --"OPT_MEM_GROW"          Map hugepages on demand beyond -m\n"
 	       "\n");
 	/* Allow the application to print its usage message too if hook is set */
 	if ( rte_application_usage_hook ) {
@@ -564,6 +565,16 @@ eal_parse_args(int argc, char **argv)
 #endif
 			break;
 
+		case OPT_MEM_GROW_NUM:
+#ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
+			RTE_LOG(ERR, EAL, "Option --"OPT_MEM_GROW" is not "
+				"supported with single file segments\n");
+			return -1;
+#else
+			internal_config.mem_grow = 1;
+#endif
+			break;
+
 		case OPT_HUGE_DIR_NUM:
 			internal_config.hugepage_dir = optarg;
 			break;
@@ -638,6 +649,16 @@ eal_parse_args(int argc, char **argv)
 		return -1;
 	}
 
+	/* memory can only grow from hugetlbfs */
+	if (internal_config.mem_grow &&
+			(internal_config.no_hugetlbfs ||
+			 internal_config.xen_dom0_support)) {
+		RTE_LOG(ERR, EAL, "Option --"OPT_MEM_GROW" cannot be specified "
+			"together with --"OPT_NO_HUGE" or --"OPT_XEN_DOM0"\n");
+		eal_usage(prgname);
+		return -1;
+	}
+
 	if (optind >= 0)
 		argv[optind-1] = prgname;
 	ret = optind-1;
@@ -709,6 +730,8 @@ rte_eal_init(int argc, char **argv)
 	if (!rte_atomic32_test_and_set(&run_once))
 		return -1;
 
+	eal_timing_start();
+
 	logid = strrchr(argv[0], '/');
 	logid = strdup(logid ? logid + 1: argv[0]);
 
@@ -727,12 +750,16 @@ rte_eal_init(int argc, char **argv)
 	/* set log level as early as possible */
 	rte_set_log_level(internal_config.log_level);
 
+	eal_timing_step("arguments");
+
 	if (internal_config.no_hugetlbfs == 0 &&
 			internal_config.process_type != RTE_PROC_SECONDARY &&
 			internal_config.xen_dom0_support == 0 &&
 			eal_hugepage_info_init() < 0)
 		rte_panic("Cannot get hugepage information\n");
 
+	eal_timing_step("hugepage info");
+
 	if (internal_config.memory == 0 && internal_config.force_sockets == 0) {
 		if (internal_config.no_hugetlbfs)
 			internal_config.memory = MEMSIZE_IF_NO_HUGE_PAGE;
@@ -758,6 +785,8 @@ rte_eal_init(int argc, char **argv)
 	if (rte_eal_pci_init() < 0)
 		rte_panic("Cannot init PCI\n");
 
+	eal_timing_step("pci scan");
+
 #ifdef RTE_LIBRTE_IVSHMEM
 	if (rte_eal_ivshmem_init() < 0)
 		rte_panic("Cannot init IVSHMEM\n");
@@ -769,6 +798,8 @@ rte_eal_init(int argc, char **argv)
 	/* the directories are locked during eal_hugepage_info_init */
 	eal_hugedirs_unlock();
 
+	eal_timing_step("memory");
+
 	if (rte_eal_memzone_init() < 0)
 		rte_panic("Cannot init memzone\n");
 
@@ -780,6 +811,8 @@ rte_eal_init(int argc, char **argv)
 		rte_panic("Cannot init IVSHMEM objects\n");
 #endif
 
+	eal_timing_step("memzones and tailqs");
+
 	if (rte_eal_log_init(logid, internal_config.syslog_facility) < 0)
 		rte_panic("Cannot init logs\n");
 
@@ -792,6 +825,8 @@ rte_eal_init(int argc, char **argv)
 	if (rte_eal_timer_init() < 0)
 		rte_panic("Cannot init HPET or TSC timers\n");
 
+	eal_timing_step("interrupts and timer");
+
 	eal_check_mem_on_local_socket();
 
 	rte_eal_mcfg_complete();
@@ -841,10 +876,15 @@ rte_eal_init(int argc, char **argv)
 	rte_eal_mp_remote_launch(sync_func, NULL, SKIP_MASTER);
 	rte_eal_mp_wait_lcore();
 
+	eal_timing_step("lcores and devices");
+
 	/* Probe & Initialize PCI devices */
 	if (rte_eal_pci_probe())
 		rte_panic("Cannot probe PCI\n");
 
+	eal_timing_step("pci probe");
+	eal_timing_dump();
+
 	return fctret;
 }
 
@@ -80,6 +80,9 @@
 #include <errno.h>
 #include <sys/ioctl.h>
 #include <sys/time.h>
+#include <sys/syscall.h>
+#include <sched.h>
+#include <pthread.h>
 
 #include <rte_log.h>
 #include <rte_memory.h>
@@ -91,6 +94,7 @@
 #include <rte_lcore.h>
 #include <rte_common.h>
 #include <rte_string_fns.h>
+#include <rte_rwlock.h>
 
 #include "eal_private.h"
 #include "eal_internal_cfg.h"
@@ -111,8 +115,19 @@
 
 static uint64_t baseaddr_offset;
 
+/* number of hugepage files created at startup */
+static uint32_t memgrow_next_file_id;
+
 #define RANDOMIZE_VA_SPACE_FILE "/proc/sys/kernel/randomize_va_space"
 
+/* NUMA memory policy, as in <numaif.h> */
+#define EAL_MPOL_PREFERRED 1
+#define EAL_MPOL_F_NODE (1 << 0)
+#define EAL_MPOL_F_ADDR (1 << 1)
+
+/* maximum number of threads mapping hugepages on each NUMA node */
+#define HUGEPAGE_MAP_THREADS_PER_NODE 4
+
 /* Lock page in physical memory and prevent from swapping. */
 int
 rte_mem_lock_page(const void *virt)
@@ -124,13 +139,14 @@ rte_mem_lock_page(const void *virt)
 }
 
 /*
- * Get physical address of any mapped virtual address in the current process.
+ * Get physical address of a virtual address, using an already opened
+ * /proc/self/pagemap file so that many addresses can be looked up
+ * without reopening it.
  */
-phys_addr_t
-rte_mem_virt2phy(const void *virtaddr)
+static phys_addr_t
+pagemap_virt2phy(int fd, const void *virtaddr)
 {
-	int fd;
-	uint64_t page, physaddr;
+	uint64_t page;
 	unsigned long virt_pfn;
 	int page_size;
 	off_t offset;
@@ -138,25 +154,11 @@ rte_mem_virt2phy(const void *virtaddr)
 	/* standard page size */
 	page_size = getpagesize();
 
-	fd = open("/proc/self/pagemap", O_RDONLY);
-	if (fd < 0) {
-		RTE_LOG(ERR, EAL, "%s(): cannot open /proc/self/pagemap: %s\n",
-			__func__, strerror(errno));
-		return RTE_BAD_PHYS_ADDR;
-	}
-
 	virt_pfn = (unsigned long)virtaddr / page_size;
 	offset = sizeof(uint64_t) * virt_pfn;
-	if (lseek(fd, offset, SEEK_SET) == (off_t) -1) {
-		RTE_LOG(ERR, EAL, "%s(): seek error in /proc/self/pagemap: %s\n",
-				__func__, strerror(errno));
-		close(fd);
-		return RTE_BAD_PHYS_ADDR;
-	}
-	if (read(fd, &page, sizeof(uint64_t)) < 0) {
+	if (pread(fd, &page, sizeof(uint64_t), offset) != sizeof(uint64_t)) {
 		RTE_LOG(ERR, EAL, "%s(): cannot read /proc/self/pagemap: %s\n",
 				__func__, strerror(errno));
-		close(fd);
 		return RTE_BAD_PHYS_ADDR;
 	}
 
@@ -164,29 +166,29 @@ rte_mem_virt2phy(const void *virtaddr)
 	 * the pfn (page frame number) are bits 0-54 (see
 	 * pagemap.txt in linux Documentation)
 	 */
-	physaddr = ((page & 0x7fffffffffffffULL) * page_size)
+	return ((page & 0x7fffffffffffffULL) * page_size)
 		+ ((unsigned long)virtaddr % page_size);
-	close(fd);
-	return physaddr;
 }
 
 /*
- * For each hugepage in hugepg_tbl, fill the physaddr value. We find
- * it by browsing the /proc/self/pagemap special file.
+ * Get physical address of any mapped virtual address in the current process.
  */
-static int
-find_physaddrs(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
+phys_addr_t
+rte_mem_virt2phy(const void *virtaddr)
 {
-	unsigned i;
-	phys_addr_t addr;
+	int fd;
+	phys_addr_t physaddr;
 
-	for (i = 0; i < hpi->num_pages[0]; i++) {
-		addr = rte_mem_virt2phy(hugepg_tbl[i].orig_va);
-		if (addr == RTE_BAD_PHYS_ADDR)
-			return -1;
-		hugepg_tbl[i].physaddr = addr;
+	fd = open("/proc/self/pagemap", O_RDONLY);
+	if (fd < 0) {
+		RTE_LOG(ERR, EAL, "%s(): cannot open /proc/self/pagemap: %s\n",
+			__func__, strerror(errno));
+		return RTE_BAD_PHYS_ADDR;
 	}
-	return 0;
+
+	physaddr = pagemap_virt2phy(fd, virtaddr);
+	close(fd);
+	return physaddr;
 }
 
 /*
@@ -278,15 +280,312 @@ get_virtual_area(size_t *size, size_t hugepage_sz)
 }
 
 /*
- * Mmap all hugepages of hugepage table: it first open a file in
- * hugetlbfs, then mmap() hugepage_sz data in it. If orig is set, the
- * virtual address is stored in hugepg_tbl[i].orig_va, else it is stored
- * in hugepg_tbl[i].final_va. The second mapping (when orig is 0) tries to
- * map continguous physical blocks in contiguous virtual blocks.
+ * Parse /proc/self/numa_maps to get the NUMA socket ID for each huge
+ * page.
  */
 static int
-map_all_hugepages(struct hugepage_file *hugepg_tbl,
-		struct hugepage_info *hpi, int orig)
+find_numasocket(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
+{
+	int socket_id;
+	char *end, *nodestr;
+	unsigned i, hp_count = 0;
+	uint64_t virt_addr;
+	char buf[BUFSIZ];
+	char hugedir_str[PATH_MAX];
+	FILE *f;
+
+	f = fopen("/proc/self/numa_maps", "r");
+	if (f == NULL) {
+		RTE_LOG(INFO, EAL, "cannot open /proc/self/numa_maps,"
+				" consider that all memory is in socket_id 0\n");
+		return 0;
+	}
+
+	snprintf(hugedir_str, sizeof(hugedir_str),
+			"%s/%s", hpi->hugedir, internal_config.hugefile_prefix);
+
+	/* parse numa map */
+	while (fgets(buf, sizeof(buf), f) != NULL) {
+
+		/* ignore non huge page */
+		if (strstr(buf, " huge ") == NULL &&
+				strstr(buf, hugedir_str) == NULL)
+			continue;
+
+		/* get zone addr */
+		virt_addr = strtoull(buf, &end, 16);
+		if (virt_addr == 0 || end == buf) {
+			RTE_LOG(ERR, EAL, "%s(): error in numa_maps parsing\n", __func__);
+			goto error;
+		}
+
+		/* get node id (socket id) */
+		nodestr = strstr(buf, " N");
+		if (nodestr == NULL) {
+			RTE_LOG(ERR, EAL, "%s(): error in numa_maps parsing\n", __func__);
+			goto error;
+		}
+		nodestr += 2;
+		end = strstr(nodestr, "=");
+		if (end == NULL) {
+			RTE_LOG(ERR, EAL, "%s(): error in numa_maps parsing\n", __func__);
+			goto error;
+		}
+		end[0] = '\0';
+		end = NULL;
+
+		socket_id = strtoul(nodestr, &end, 0);
+		if ((nodestr[0] == '\0') || (end == NULL) || (*end != '\0')) {
+			RTE_LOG(ERR, EAL, "%s(): error in numa_maps parsing\n", __func__);
+			goto error;
+		}
+
+		/* if we find this page in our mappings, set socket_id */
+		for (i = 0; i < hpi->num_pages[0]; i++) {
+			void *va = (void *)(unsigned long)virt_addr;
+			if (hugepg_tbl[i].orig_va == va) {
+				hugepg_tbl[i].socket_id = socket_id;
+				hp_count++;
+			}
+		}
+	}
+
+	if (hp_count < hpi->num_pages[0])
+		goto error;
+
+	fclose(f);
+	return 0;
+
+error:
+	fclose(f);
+	return -1;
+}
+
+/* hugepages mapped for the first time by one thread */
+struct hugepage_map_work {
+	pthread_t thread;
+	struct hugepage_file *pages; /**< first page of this thread */
+	unsigned nb_pages;           /**< number of pages to map */
+	uint64_t hugepage_sz;
+	int socket_id;               /**< node to allocate on, -1 for any */
+	int cpu;                     /**< cpu to run on, -1 if not pinned */
+	int numa_known;              /**< set if all page sockets were found */
+	int ret;
+};
+
+/*
+ * Thread body of map_all_hugepages_orig(): map and fault in the pages,
+ * then look up their physical address and NUMA socket.
+ */
+static void *
+map_hugepages_worker(void *arg)
+{
+	struct hugepage_map_work *work = arg;
+	struct hugepage_file *hp;
+	unsigned long nodemask;
+	cpu_set_t cpuset;
+	void *virtaddr;
+	unsigned i;
+	int fd, pagemap_fd, node;
+
+	work->ret = -1;
+	work->numa_known = 1;
+
+	if (work->cpu >= 0) {
+		CPU_ZERO(&cpuset);
+		CPU_SET(work->cpu, &cpuset);
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpuset),
+				&cpuset) != 0)
+			RTE_LOG(DEBUG, EAL, "%s(): cannot run on cpu %d\n",
+				__func__, work->cpu);
+	}
+
+	pagemap_fd = open("/proc/self/pagemap", O_RDONLY);
+	if (pagemap_fd < 0) {
+		RTE_LOG(ERR, EAL, "%s(): cannot open /proc/self/pagemap: %s\n",
+			__func__, strerror(errno));
+		return NULL;
+	}
+
+	for (i = 0; i < work->nb_pages; i++) {
+		hp = &work->pages[i];
+
+		/* try to create hugepage file */
+		fd = open(hp->filepath, O_CREAT | O_RDWR, 0755);
+		if (fd < 0) {
+			RTE_LOG(ERR, EAL, "%s(): open failed: %s\n", __func__,
+					strerror(errno));
+			goto out;
+		}
+
+		virtaddr = mmap(NULL, work->hugepage_sz, PROT_READ | PROT_WRITE,
+				MAP_SHARED, fd, 0);
+		if (virtaddr == MAP_FAILED) {
+			RTE_LOG(ERR, EAL, "%s(): mmap failed: %s\n", __func__,
+					strerror(errno));
+			close(fd);
+			goto out;
+		}
+		hp->orig_va = virtaddr;
+
+		/* the page is allocated when faulted in: ask for the node
+		 * of this thread, it is only a preference as the kernel
+		 * falls back to other nodes once it runs out of pages */
+		if (work->socket_id >= 0) {
+			nodemask = 1UL << work->socket_id;
+			syscall(__NR_mbind, virtaddr, work->hugepage_sz,
+				EAL_MPOL_PREFERRED, &nodemask,
+				sizeof(nodemask) * CHAR_BIT, 0);
+		}
+		memset(virtaddr, 0, work->hugepage_sz);
+
+		/* set shared flock on the file. */
+		if (flock(fd, LOCK_SH | LOCK_NB) == -1) {
+			RTE_LOG(ERR, EAL, "%s(): Locking file failed:%s \n",
+				__func__, strerror(errno));
+			close(fd);
+			goto out;
+		}
+
+		close(fd);
+
+		hp->physaddr = pagemap_virt2phy(pagemap_fd, virtaddr);
+		if (hp->physaddr == RTE_BAD_PHYS_ADDR)
+			goto out;
+
+		if (work->numa_known && syscall(__NR_get_mempolicy, &node,
+				NULL, 0, virtaddr,
+				EAL_MPOL_F_NODE | EAL_MPOL_F_ADDR) == 0)
+			hp->socket_id = node;
+		else
+			work->numa_known = 0;
+	}
+	work->ret = 0;
+
+out:
+	close(pagemap_fd);
+	return NULL;
+}
+
+/*
+ * Create and mmap all hugepage files of the hugepage table, storing the
+ * virtual address in hugepg_tbl[i].orig_va, and fill the physical address
+ * and NUMA socket of each page.
+ *
+ * Most of the time is spent by the kernel allocating and clearing the
+ * pages when they are faulted in, so the table is split between threads.
+ * Each NUMA node is given as many pages as it has free, faulted in by up
+ * to HUGEPAGE_MAP_THREADS_PER_NODE threads running on the cores of that
+ * node, so that pages are cleared by local cores.
+ */
+static int
+map_all_hugepages_orig(struct hugepage_file *hugepg_tbl,
+		struct hugepage_info *hpi)
+{
+	struct hugepage_map_work
+		work[RTE_MAX_NUMA_NODES * HUGEPAGE_MAP_THREADS_PER_NODE + 1];
+	int thread_created[RTE_DIM(work)];
+	int cpus[HUGEPAGE_MAP_THREADS_PER_NODE];
+	unsigned i, socket, lcore_id, nb_cpus, nb_threads, nb_works = 0;
+	unsigned first = 0, nb_pages;
+	unsigned long free_pages;
+	char path[PATH_MAX];
+	int numa_known = 1, ret = 0;
+
+	for (i = 0; i < hpi->num_pages[0]; i++) {
+		hugepg_tbl[i].file_id = i;
+		hugepg_tbl[i].size = hpi->hugepage_sz;
+#ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
+		eal_get_hugefile_temp_path(hugepg_tbl[i].filepath,
+				sizeof(hugepg_tbl[i].filepath), hpi->hugedir,
+				hugepg_tbl[i].file_id);
+#else
+		eal_get_hugefile_path(hugepg_tbl[i].filepath,
+				sizeof(hugepg_tbl[i].filepath), hpi->hugedir,
+				hugepg_tbl[i].file_id);
+#endif
+		hugepg_tbl[i].filepath[sizeof(hugepg_tbl[i].filepath) - 1] = '\0';
+	}
+
+	memset(work, 0, sizeof(work));
+	for (socket = 0; socket < RTE_MAX_NUMA_NODES &&
+			first < hpi->num_pages[0]; socket++) {
+		snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/"
+			"hugepages/hugepages-%" PRIu64 "kB/free_hugepages",
+			socket, hpi->hugepage_sz >> 10);
+		if (eal_parse_sysfs_value(path, &free_pages) < 0 ||
+				free_pages == 0)
+			continue;
+		nb_pages = RTE_MIN(free_pages,
+			(unsigned long)(hpi->num_pages[0] - first));
+
+		nb_cpus = 0;
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE &&
+				nb_cpus < HUGEPAGE_MAP_THREADS_PER_NODE;
+				lcore_id++) {
+			if (lcore_config[lcore_id].detected &&
+					lcore_config[lcore_id].socket_id == socket)
+				cpus[nb_cpus++] = lcore_id;
+		}
+
+		/* nodes without cores are handled by one unpinned thread */
+		nb_threads = RTE_MIN(RTE_MAX(nb_cpus, 1u), nb_pages);
+		for (i = 0; i < nb_threads; i++) {
+			work[nb_works].pages = &hugepg_tbl[first];
+			work[nb_works].nb_pages = nb_pages / nb_threads +
+				(i < nb_pages % nb_threads);
+			work[nb_works].hugepage_sz = hpi->hugepage_sz;
+			work[nb_works].socket_id = socket;
+			work[nb_works].cpu = nb_cpus ? cpus[i] : -1;
+			first += work[nb_works].nb_pages;
+			nb_works++;
+		}
+	}
+
+	/* pages not accounted for in sysfs are mapped without preference */
+	if (first < hpi->num_pages[0]) {
+		work[nb_works].pages = &hugepg_tbl[first];
+		work[nb_works].nb_pages = hpi->num_pages[0] - first;
+		work[nb_works].hugepage_sz = hpi->hugepage_sz;
+		work[nb_works].socket_id = -1;
+		work[nb_works].cpu = -1;
+		nb_works++;
+	}
+
+	for (i = 0; i < nb_works; i++) {
+		thread_created[i] = nb_works > 1 &&
+			pthread_create(&work[i].thread, NULL,
+				map_hugepages_worker, &work[i]) == 0;
+		if (!thread_created[i]) {
+			/* never pin the calling thread */
+			work[i].cpu = -1;
+			map_hugepages_worker(&work[i]);
+		}
+	}
+
+	for (i = 0; i < nb_works; i++) {
+		if (thread_created[i])
+			pthread_join(work[i].thread, NULL);
+		if (work[i].ret < 0)
+			ret = -1;
+		if (!work[i].numa_known)
+			numa_known = 0;
+	}
+
+	if (ret == 0 && !numa_known)
+		ret = find_numasocket(hugepg_tbl, hpi);
+
+	return ret;
+}
+
+#ifndef RTE_EAL_SINGLE_FILE_SEGMENTS
+/*
+ * Mmap all hugepages of hugepage table a second time, storing the virtual
+ * address in hugepg_tbl[i].final_va: contiguous physical blocks are mapped
+ * in contiguous virtual blocks.
+ */
+static int
+map_all_hugepages(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
 {
 	int fd;
 	unsigned i;
@@ -294,32 +593,14 @@ map_all_hugepages(struct hugepage_file *hugepg_tbl,
 	void *vma_addr = NULL;
 	size_t vma_len = 0;
 
-#ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
-	RTE_SET_USED(vma_len);
-#endif
-
 	for (i = 0; i < hpi->num_pages[0]; i++) {
 		uint64_t hugepage_sz = hpi->hugepage_sz;
 
-		if (orig) {
-			hugepg_tbl[i].file_id = i;
-			hugepg_tbl[i].size = hugepage_sz;
-#ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
-			eal_get_hugefile_temp_path(hugepg_tbl[i].filepath,
-					sizeof(hugepg_tbl[i].filepath), hpi->hugedir,
-					hugepg_tbl[i].file_id);
-#else
-			eal_get_hugefile_path(hugepg_tbl[i].filepath,
-					sizeof(hugepg_tbl[i].filepath), hpi->hugedir,
-					hugepg_tbl[i].file_id);
-#endif
-			hugepg_tbl[i].filepath[sizeof(hugepg_tbl[i].filepath) - 1] = '\0';
-		}
 #ifndef RTE_ARCH_64
 		/* for 32-bit systems, don't remap 1G and 16G pages, just reuse
 		 * original map address as final map address.
 		 */
-		else if ((hugepage_sz == RTE_PGSIZE_1G)
+		if ((hugepage_sz == RTE_PGSIZE_1G)
 			|| (hugepage_sz == RTE_PGSIZE_16G)) {
 			hugepg_tbl[i].final_va = hugepg_tbl[i].orig_va;
 			hugepg_tbl[i].orig_va = NULL;
@@ -327,8 +608,7 @@ map_all_hugepages(struct hugepage_file *hugepg_tbl,
 		}
 #endif
 
-#ifndef RTE_EAL_SINGLE_FILE_SEGMENTS
-		else if (vma_len == 0) {
+		if (vma_len == 0) {
 			unsigned j, num_pages;
 
 			/* reserve a virtual area for next contiguous
@@ -357,7 +637,6 @@ map_all_hugepages(struct hugepage_file *hugepg_tbl,
 			if (vma_addr == NULL)
 				vma_len = hugepage_sz;
 		}
-#endif
 
 		/* try to create hugepage file */
 		fd = open(hugepg_tbl[i].filepath, O_CREAT | O_RDWR, 0755);
@@ -376,13 +655,7 @@ map_all_hugepages(struct hugepage_file *hugepg_tbl,
 			return -1;
 		}
 
-		if (orig) {
-			hugepg_tbl[i].orig_va = virtaddr;
-			memset(virtaddr, 0, hugepage_sz);
-		}
-		else {
-			hugepg_tbl[i].final_va = virtaddr;
-		}
+		hugepg_tbl[i].final_va = virtaddr;
 
 		/* set shared flock on the file. */
 		if (flock(fd, LOCK_SH | LOCK_NB) == -1) {
@@ -399,6 +672,7 @@ map_all_hugepages(struct hugepage_file *hugepg_tbl,
 	}
 	return 0;
 }
+#endif
 
 #ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
 
@@ -587,135 +861,33 @@ unmap_all_hugepages_orig(struct hugepage_file *hugepg_tbl, struct hugepage_info
 }
 #endif /* RTE_EAL_SINGLE_FILE_SEGMENTS */
 
-/*
- * Parse /proc/self/numa_maps to get the NUMA socket ID for each huge
- * page.
- */
 static int
-find_numasocket(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
+cmp_physaddr(const void *a, const void *b)
 {
-	int socket_id;
-	char *end, *nodestr;
-	unsigned i, hp_count = 0;
-	uint64_t virt_addr;
-	char buf[BUFSIZ];
-	char hugedir_str[PATH_MAX];
-	FILE *f;
-
-	f = fopen("/proc/self/numa_maps", "r");
-	if (f == NULL) {
-		RTE_LOG(INFO, EAL, "cannot open /proc/self/numa_maps,"
-				" consider that all memory is in socket_id 0\n");
-		return 0;
-	}
-
-	snprintf(hugedir_str, sizeof(hugedir_str),
-			"%s/%s", hpi->hugedir, internal_config.hugefile_prefix);
-
-	/* parse numa map */
-	while (fgets(buf, sizeof(buf), f) != NULL) {
-
-		/* ignore non huge page */
-		if (strstr(buf, " huge ") == NULL &&
-				strstr(buf, hugedir_str) == NULL)
-			continue;
-
-		/* get zone addr */
-		virt_addr = strtoull(buf, &end, 16);
-		if (virt_addr == 0 || end == buf) {
-			RTE_LOG(ERR, EAL, "%s(): error in numa_maps parsing\n", __func__);
-			goto error;
-		}
-
-		/* get node id (socket id) */
-		nodestr = strstr(buf, " N");
-		if (nodestr == NULL) {
-			RTE_LOG(ERR, EAL, "%s(): error in numa_maps parsing\n", __func__);
-			goto error;
-		}
-		nodestr += 2;
-		end = strstr(nodestr, "=");
-		if (end == NULL) {
-			RTE_LOG(ERR, EAL, "%s(): error in numa_maps parsing\n", __func__);
-			goto error;
-		}
-		end[0] = '\0';
-		end = NULL;
-
-		socket_id = strtoul(nodestr, &end, 0);
-		if ((nodestr[0] == '\0') || (end == NULL) || (*end != '\0')) {
-			RTE_LOG(ERR, EAL, "%s(): error in numa_maps parsing\n", __func__);
-			goto error;
-		}
-
-		/* if we find this page in our mappings, set socket_id */
-		for (i = 0; i < hpi->num_pages[0]; i++) {
-			void *va = (void *)(unsigned long)virt_addr;
-			if (hugepg_tbl[i].orig_va == va) {
-				hugepg_tbl[i].socket_id = socket_id;
-				hp_count++;
-			}
-		}
-	}
+	const struct hugepage_file *p1 = a;
+	const struct hugepage_file *p2 = b;
 
-	if (hp_count < hpi->num_pages[0])
-		goto error;
-
-	fclose(f);
-	return 0;
-
-error:
-	fclose(f);
-	return -1;
+#ifdef RTE_ARCH_PPC_64
+	/* PowerPC needs memory sorted in reverse order from x86 */
+	if (p1->physaddr > p2->physaddr)
+		return -1;
+	return p1->physaddr < p2->physaddr;
+#else
+	if (p1->physaddr < p2->physaddr)
+		return -1;
+	return p1->physaddr > p2->physaddr;
+#endif
 }
 
 /*
  * Sort the hugepg_tbl by physical address (lower addresses first on x86,
- * higher address first on powerpc). We use a slow algorithm, but we won't
- * have millions of pages, and this is only done at init time.
+ * higher address first on powerpc).
  */
 static int
 sort_by_physaddr(struct hugepage_file *hugepg_tbl, struct hugepage_info *hpi)
 {
-	unsigned i, j;
-	int compare_idx;
-	uint64_t compare_addr;
-	struct hugepage_file tmp;
-
-	for (i = 0; i < hpi->num_pages[0]; i++) {
-		compare_addr = 0;
-		compare_idx = -1;
-
-		/*
-		 * browse all entries starting at 'i', and find the
-		 * entry with the smallest addr
-		 */
-		for (j=i; j< hpi->num_pages[0]; j++) {
-
-			if (compare_addr == 0 ||
-#ifdef RTE_ARCH_PPC_64
-				hugepg_tbl[j].physaddr > compare_addr) {
-#else
-				hugepg_tbl[j].physaddr < compare_addr) {
-#endif
-				compare_addr = hugepg_tbl[j].physaddr;
-				compare_idx = j;
-			}
-		}
-
-		/* should not happen */
-		if (compare_idx == -1) {
-			RTE_LOG(ERR, EAL, "%s(): error in physaddr sorting\n", __func__);
-			return -1;
-		}
-
-		/* swap the 2 entries in the table */
-		memcpy(&tmp, &hugepg_tbl[compare_idx],
-			sizeof(struct hugepage_file));
-		memcpy(&hugepg_tbl[compare_idx], &hugepg_tbl[i],
-			sizeof(struct hugepage_file));
-		memcpy(&hugepg_tbl[i], &tmp, sizeof(struct hugepage_file));
-	}
+	qsort(hugepg_tbl, hpi->num_pages[0], sizeof(struct hugepage_file),
+		cmp_physaddr);
 	return 0;
 }
 
@@ -1083,10 +1255,21 @@ rte_eal_hugepage_init(void)
 	/* calculate total number of hugepages available. at this point we haven't
 	 * yet started sorting them so they all are on socket 0 */
 	for (i = 0; i < (int) internal_config.num_hugepage_sizes; i++) {
-		/* meanwhile, also initialize used_hp hugepage sizes in used_hp */
-		used_hp[i].hugepage_sz = internal_config.hugepage_info[i].hugepage_sz;
+		struct hugepage_info *hpi = &internal_config.hugepage_info[i];
 
-		nr_hugepages += internal_config.hugepage_info[i].num_pages[0];
+		/* meanwhile, also initialize used_hp hugepage sizes in used_hp */
+		used_hp[i].hugepage_sz = hpi->hugepage_sz;
+
+		/* when memory can grow at runtime and no per-socket amounts
+		 * were requested, only map the pages -m asks for instead of
+		 * every page of the system */
+		if (internal_config.mem_grow &&
+				internal_config.force_sockets == 0)
+			hpi->num_pages[0] = RTE_MIN(hpi->num_pages[0],
+					(uint32_t)((internal_config.memory +
+					hpi->hugepage_sz - 1) / hpi->hugepage_sz));
+
+		nr_hugepages += hpi->num_pages[0];
 	}
 
 	/*
@@ -1117,28 +1300,18 @@ rte_eal_hugepage_init(void)
 		if (hpi->num_pages[0] == 0)
 			continue;
 
-		/* map all hugepages available */
-		if (map_all_hugepages(&tmp_hp[hp_offset], hpi, 1) < 0){
+		/* map all hugepages available, and find physical addresses
+		 * and sockets for each hugepage */
+		if (map_all_hugepages_orig(&tmp_hp[hp_offset], hpi) < 0){
 			RTE_LOG(DEBUG, EAL, "Failed to mmap %u MB hugepages\n",
 					(unsigned)(hpi->hugepage_sz / 0x100000));
 			goto fail;
 		}
-
-		/* find physical addresses and sockets for each hugepage */
-		if (find_physaddrs(&tmp_hp[hp_offset], hpi) < 0){
-			RTE_LOG(DEBUG, EAL, "Failed to find phys addr for %u MB pages\n",
-					(unsigned)(hpi->hugepage_sz / 0x100000));
-			goto fail;
-		}
-
-		if (find_numasocket(&tmp_hp[hp_offset], hpi) < 0){
-			RTE_LOG(DEBUG, EAL, "Failed to find NUMA socket for %u MB pages\n",
-					(unsigned)(hpi->hugepage_sz / 0x100000));
-			goto fail;
-		}
+		eal_timing_step("hugepage map");
 
 		if (sort_by_physaddr(&tmp_hp[hp_offset], hpi) < 0)
 			goto fail;
+		eal_timing_step("hugepage sort");
 
 #ifdef RTE_EAL_SINGLE_FILE_SEGMENTS
 		/* remap all hugepages into single file segments */
@@ -1149,11 +1322,13 @@ rte_eal_hugepage_init(void)
 			goto fail;
 		}
 
+		eal_timing_step("hugepage remap");
+
 		/* we have processed a num of hugepages of this size, so inc offset */
 		hp_offset += new_pages_count[i];
 #else
 		/* remap all hugepages */
-		if (map_all_hugepages(&tmp_hp[hp_offset], hpi, 0) < 0){
+		if (map_all_hugepages(&tmp_hp[hp_offset], hpi) < 0){
 			RTE_LOG(DEBUG, EAL, "Failed to remap %u MB pages\n",
 					(unsigned)(hpi->hugepage_sz / 0x100000));
 			goto fail;
@@ -1163,6 +1338,8 @@ rte_eal_hugepage_init(void)
 		if (unmap_all_hugepages_orig(&tmp_hp[hp_offset], hpi) < 0)
 			goto fail;
 
+		eal_timing_step("hugepage remap");
+
 		/* we have processed a num of hugepages of this size, so inc offset */
 		hp_offset += hpi->num_pages[0];
 #endif
@@ -1264,6 +1441,9 @@ rte_eal_hugepage_init(void)
 	free(tmp_hp);
 	tmp_hp = NULL;
 
+	/* files created at runtime are numbered after the ones above */
+	memgrow_next_file_id = nr_hugefiles;
+
 	/* find earliest free memseg - this is needed because in case of IVSHMEM,
 	 * segments might have already been initialized */
 	for (j = 0; j < RTE_MAX_MEMSEG; j++)
@@ -1350,6 +1530,418 @@ fail:
 	return -1;
 }
 
+/*
+ * Memory segments added at runtime (--mem-grow).
+ *
+ * The segments are stored in the memseg table after the ones mapped at
+ * startup. The hugepage files backing them are described in a table
+ * shared between processes, along with a generation number bumped on
+ * every change so that each process can cheaply tell when it has to map
+ * or unmap segments. The memseg table and this table are protected by
+ * the memzone lock.
+ */
+
+/* hugepage files of a segment added at runtime */
+struct memgrow_seg {
+	uint32_t file_id;      /**< id of the first hugepage file */
+	uint32_t nb_pages;     /**< number of hugepages, 0 if unused */
+	uint32_t hugepage_idx; /**< index of the hugepage size */
+};
+
+/* bookkeeping shared by all processes */
+struct memgrow_info {
+	volatile uint32_t gen;     /**< bumped when a segment is added/removed */
+	uint32_t nb_init_memseg;   /**< number of segments mapped at startup */
+	uint32_t next_file_id;     /**< id of the next hugepage file to create */
+	uint32_t num_hugepage_sizes;
+	uint64_t hugepage_sz[MAX_HUGEPAGE_SIZES];
+	char hugedir[MAX_HUGEPAGE_SIZES][PATH_MAX];
+	struct memgrow_seg seg[RTE_MAX_MEMSEG];
+};
+
+static struct memgrow_info *memgrow;
+
+/*
+ * Process local view of the segments added at runtime. The generations
+ * are exported for the inline rte_eal_memseg_sync().
+ */
+const volatile uint32_t *__rte_eal_memseg_shared_gen;
+uint32_t __rte_eal_memseg_gen;
+static void *memgrow_addr[RTE_MAX_MEMSEG];
+static size_t memgrow_len[RTE_MAX_MEMSEG];
+
+/*
+ * The memzone lock, without taking the address of a member of the packed
+ * rte_mem_config: mlock is at an aligned offset.
+ */
+static inline rte_rwlock_t *
+memgrow_lock(struct rte_mem_config *mcfg)
+{
+	return RTE_PTR_ADD(mcfg, offsetof(struct rte_mem_config, mlock));
+}
+
+/* return the number of segments mapped at startup */
+static unsigned
+memgrow_nb_init_memseg(void)
+{
+	return memgrow == NULL ? RTE_MAX_MEMSEG : memgrow->nb_init_memseg;
+}
+
+/* unmap the first n pages of a segment, unlinking their files if asked */
+static void
+memgrow_unmap(void *addr, const struct memgrow_seg *seg, unsigned n,
+		int unlink_files)
+{
+	char path[PATH_MAX];
+	unsigned i;
+
+	munmap(addr, (size_t)n * memgrow->hugepage_sz[seg->hugepage_idx]);
+	for (i = 0; unlink_files && i != n; i++) {
+		eal_get_hugefile_path(path, sizeof(path),
+				memgrow->hugedir[seg->hugepage_idx],
+				seg->file_id + i);
+		unlink(path);
+	}
+}
+
+/*
+ * Map the hugepage files of a segment at addr. When create is set, the
+ * files are created and their pages are faulted in on the given socket.
+ */
+static int
+memgrow_map(void *addr, const struct memgrow_seg *seg, int create,
+		int socket_id)
+{
+	const uint64_t hugepage_sz = memgrow->hugepage_sz[seg->hugepage_idx];
+	const size_t len = (size_t)seg->nb_pages * hugepage_sz;
+	char path[PATH_MAX];
+	unsigned long nodemask;
+	void *va;
+	unsigned i;
+	int fd, node;
+
+	for (i = 0; i != seg->nb_pages; i++) {
+		eal_get_hugefile_path(path, sizeof(path),
+				memgrow->hugedir[seg->hugepage_idx],
+				seg->file_id + i);
+		fd = open(path, create ? O_CREAT | O_RDWR : O_RDWR, 0755);
+		if (fd < 0) {
+			RTE_LOG(ERR, EAL, "%s(): open %s failed: %s\n",
+					__func__, path, strerror(errno));
+			goto error;
+		}
+
+		va = mmap(RTE_PTR_ADD(addr, i * hugepage_sz), hugepage_sz,
+				PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+		if (va == MAP_FAILED ||
+				va != RTE_PTR_ADD(addr, i * hugepage_sz)) {
+			/* not an error when the system runs out of pages */
+			RTE_LOG(DEBUG, EAL, "%s(): cannot mmap %s at %p\n",
+					__func__, path,
+					RTE_PTR_ADD(addr, i * hugepage_sz));
+			if (va != MAP_FAILED)
+				munmap(va, hugepage_sz);
+			close(fd);
+			if (create)
+				unlink(path);
+			goto error;
+		}
+
+		/* set shared flock on the file, as done at startup */
+		if (flock(fd, LOCK_SH | LOCK_NB) == -1) {
+			RTE_LOG(ERR, EAL, "%s(): Locking file failed: %s\n",
+					__func__, strerror(errno));
+			close(fd);
+			i++;
+			goto error;
+		}
+		close(fd);
+	}
+
+	if (!create)
+		return 0;
+
+	/* prefer the requested node, then fault the pages in and check where
+	 * they landed; a kernel without NUMA support fails both calls */
+	nodemask = 1UL << socket_id;
+	syscall(__NR_mbind, addr, len, EAL_MPOL_PREFERRED, &nodemask,
+			sizeof(nodemask) * CHAR_BIT, 0);
+	for (i = 0; i != seg->nb_pages; i++) {
+		va = RTE_PTR_ADD(addr, i * hugepage_sz);
+		*(volatile char *)va = 0;
+		if (syscall(__NR_get_mempolicy, &node, NULL, 0, va,
+				EAL_MPOL_F_NODE | EAL_MPOL_F_ADDR) == 0 &&
+				node != socket_id) {
+			RTE_LOG(DEBUG, EAL, "%s(): hugepage on socket %d "
+					"instead of %d\n", __func__, node,
+					socket_id);
+			goto error;
+		}
+	}
+	return 0;
+
+error:
+	memgrow_unmap(addr, seg, i, create);
+	return -1;
+}
+
+/*
+ * Bring the process view of the segments added at runtime in line with
+ * the shared table. Memzone lock must be held by the caller.
+ */
+static int
+memgrow_sync_locked(void)
+{
+	const struct rte_mem_config *mcfg =
+			rte_eal_get_configuration()->mem_config;
+	const uint32_t gen = memgrow->gen;
+	const struct memgrow_seg *seg;
+	unsigned i;
+
+	if (gen == __rte_eal_memseg_gen)
+		return 0;
+
+	for (i = memgrow->nb_init_memseg; i < RTE_MAX_MEMSEG; i++) {
+		seg = &memgrow->seg[i];
+
+		/* released, or released then reused, by another process */
+		if (memgrow_addr[i] != NULL && (seg->nb_pages == 0 ||
+				memgrow_addr[i] != mcfg->memseg[i].addr)) {
+			munmap(memgrow_addr[i], memgrow_len[i]);
+			memgrow_addr[i] = NULL;
+		}
+
+		if (seg->nb_pages == 0 || memgrow_addr[i] != NULL)
+			continue;
+
+		if (memgrow_map(mcfg->memseg[i].addr, seg, 0, 0) < 0) {
+			RTE_LOG(ERR, EAL, "Could not map segment %u at %p\n",
+					i, mcfg->memseg[i].addr);
+			if (aslr_enabled() > 0)
+				RTE_LOG(ERR, EAL, "It is recommended to "
+					"disable ASLR in the kernel\n");
+			return -1;
+		}
+		memgrow_addr[i] = mcfg->memseg[i].addr;
+		memgrow_len[i] = mcfg->memseg[i].len;
+	}
+	__rte_eal_memseg_gen = gen;
+	return 0;
+}
+
+int
+__rte_eal_memseg_sync(void)
+{
+	struct rte_mem_config *mcfg;
+	int ret;
+
+	if (memgrow == NULL || memgrow->gen == __rte_eal_memseg_gen)
+		return 0;
+
+	mcfg = rte_eal_get_configuration()->mem_config;
+	rte_rwlock_read_lock(memgrow_lock(mcfg));
+	ret = memgrow_sync_locked();
+	rte_rwlock_read_unlock(memgrow_lock(mcfg));
+	return ret;
+}
+
+int
+rte_eal_memseg_grow(int socket_id, size_t len)
+{
+	struct rte_mem_config *mcfg;
+	struct rte_memseg *ms;
+	struct memgrow_seg *seg;
+	char path[PATH_MAX];
+	size_t seg_len, va_len;
+	void *addr;
+	unsigned i, idx;
+	int ret;
+
+	if (memgrow == NULL)
+		return -ENOTSUP;
+	if (socket_id < 0 || socket_id >= RTE_MAX_NUMA_NODES || len == 0)
+		return -EINVAL;
+
+	/* do not fault pages in for a node the system does not have */
+	snprintf(path, sizeof(path), "/sys/devices/system/node/node%d",
+			socket_id);
+	if (socket_id != 0 && access(path, F_OK) != 0)
+		return -ENOMEM;
+
+	mcfg = rte_eal_get_configuration()->mem_config;
+	rte_rwlock_write_lock(memgrow_lock(mcfg));
+
+	/* the slot picked below must not be stale in this process */
+	if (memgrow_sync_locked() < 0) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	for (idx = memgrow->nb_init_memseg; idx < RTE_MAX_MEMSEG; idx++)
+		if (memgrow->seg[idx].nb_pages == 0)
+			break;
+	if (idx == RTE_MAX_MEMSEG) {
+		ret = -ENOSPC;
+		goto out;
+	}
+
+	/* try each hugepage size in the order used at startup */
+	ret = -ENOMEM;
+	seg = &memgrow->seg[idx];
+	for (i = 0; i != memgrow->num_hugepage_sizes; i++) {
+		seg_len = RTE_ALIGN_CEIL(len, memgrow->hugepage_sz[i]);
+		seg->file_id = memgrow->next_file_id;
+		seg->nb_pages = seg_len / memgrow->hugepage_sz[i];
+		seg->hugepage_idx = i;
+
+		va_len = seg_len;
+		addr = get_virtual_area(&va_len, memgrow->hugepage_sz[i]);
+		if (addr == NULL || va_len != seg_len ||
+				memgrow_map(addr, seg, 1, socket_id) < 0)
+			continue;
+
+		ms = &mcfg->memseg[idx];
+		ms->phys_addr = rte_mem_virt2phy(addr);
+		ms->addr = addr;
+		ms->len = seg_len;
+		ms->hugepage_sz = memgrow->hugepage_sz[i];
+		ms->socket_id = socket_id;
+		ms->nchannel = mcfg->nchannel;
+		ms->nrank = mcfg->nrank;
+
+		memgrow->next_file_id += seg->nb_pages;
+		memgrow_addr[idx] = addr;
+		memgrow_len[idx] = seg_len;
+		__rte_eal_memseg_gen = ++memgrow->gen;
+
+		RTE_LOG(DEBUG, EAL, "Added segment %u of %u %uMB pages at %p "
+				"on socket %d\n", idx, seg->nb_pages,
+				(unsigned)(ms->hugepage_sz / 0x100000), addr,
+				socket_id);
+		ret = idx;
+		break;
+	}
+	if (ret < 0)
+		memset(seg, 0, sizeof(*seg));
+
+out:
+	rte_rwlock_write_unlock(memgrow_lock(mcfg));
+	return ret;
+}
+
+int
+rte_eal_memseg_release(const void *addr)
+{
+	struct rte_mem_config *mcfg;
+	struct memgrow_seg *seg;
+	unsigned idx;
+	int ret = -EINVAL;
+
+	if (memgrow == NULL || addr == NULL)
+		return -EINVAL;
+
+	mcfg = rte_eal_get_configuration()->mem_config;
+	rte_rwlock_write_lock(memgrow_lock(mcfg));
+
+	if (memgrow_sync_locked() < 0)
+		goto out;
+
+	for (idx = memgrow->nb_init_memseg; idx < RTE_MAX_MEMSEG; idx++) {
+		seg = &memgrow->seg[idx];
+		if (seg->nb_pages == 0 || mcfg->memseg[idx].addr != addr)
+			continue;
+
+		memgrow_unmap(memgrow_addr[idx], seg, seg->nb_pages, 1);
+		memset(&mcfg->memseg[idx], 0, sizeof(mcfg->memseg[idx]));
+		memset(seg, 0, sizeof(*seg));
+		memgrow_addr[idx] = NULL;
+		__rte_eal_memseg_gen = ++memgrow->gen;
+
+		RTE_LOG(DEBUG, EAL, "Released segment %u at %p\n", idx, addr);
+		ret = 0;
+		break;
+	}
+
+out:
+	rte_rwlock_write_unlock(memgrow_lock(mcfg));
+	return ret;
+}
+
+/*
+ * In the primary process, create the table of segments added at runtime
+ * when --mem-grow is used, or remove a stale one left by a previous run.
+ */
+static int
+memgrow_init(void)
+{
+	const struct rte_mem_config *mcfg =
+			rte_eal_get_configuration()->mem_config;
+	const struct hugepage_info *hpi;
+	unsigned i, n;
+
+	if (internal_config.mem_grow == 0) {
+		unlink(eal_memgrow_info_path());
+		return 0;
+	}
+
+	memgrow = create_shared_memory(eal_memgrow_info_path(),
+			sizeof(*memgrow));
+	if (memgrow == NULL || memgrow == MAP_FAILED) {
+		RTE_LOG(ERR, EAL, "Failed to create shared memory for "
+				"segments added at runtime!\n");
+		memgrow = NULL;
+		return -1;
+	}
+	memset(memgrow, 0, sizeof(*memgrow));
+
+	for (i = 0; i < RTE_MAX_MEMSEG && mcfg->memseg[i].len != 0; i++)
+		;
+	memgrow->nb_init_memseg = i;
+
+	/* file ids used at startup are below the number of pages mapped */
+	n = 0;
+	for (i = 0; i < internal_config.num_hugepage_sizes; i++) {
+		hpi = &internal_config.hugepage_info[i];
+		if (hpi->hugedir == NULL)
+			continue;
+		memgrow->hugepage_sz[n] = hpi->hugepage_sz;
+		snprintf(memgrow->hugedir[n], sizeof(memgrow->hugedir[n]),
+				"%s", hpi->hugedir);
+		n++;
+	}
+	memgrow->num_hugepage_sizes = n;
+	memgrow->next_file_id = memgrow_next_file_id;
+	__rte_eal_memseg_shared_gen = &memgrow->gen;
+	return 0;
+}
+
+/*
+ * In a secondary process, attach to the table of segments added at
+ * runtime if the primary process created one.
+ */
+static int
+memgrow_attach(void)
+{
+	void *addr;
+	int fd;
+
+	fd = open(eal_memgrow_info_path(), O_RDWR);
+	if (fd < 0)
+		return 0;
+
+	addr = mmap(NULL, sizeof(*memgrow), PROT_READ | PROT_WRITE,
+			MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		RTE_LOG(ERR, EAL, "Could not mmap %s\n",
+				eal_memgrow_info_path());
+		return -1;
+	}
+	memgrow = addr;
+	__rte_eal_memseg_shared_gen = &memgrow->gen;
+	return 0;
+}
+
 /*
  * uses fstat to report the size of a file on disk
  */
@@ -1407,8 +1999,9 @@ rte_eal_hugepage_attach(void)
 		goto error;
 	}
 
-	/* map all segments into memory to make sure we get the addrs */
-	for (s = 0; s < RTE_MAX_MEMSEG; ++s) {
+	/* map all segments into memory to make sure we get the addrs, the
+	 * ones added at runtime are mapped by rte_eal_memseg_sync() */
+	for (s = 0; s < memgrow_nb_init_memseg(); ++s) {
 		void *base_addr;
 
 		/*
@@ -1461,7 +2054,7 @@ rte_eal_hugepage_attach(void)
 	RTE_LOG(DEBUG, EAL, "Analysing %u files\n", num_hp);
 
 	s = 0;
-	while (s < RTE_MAX_MEMSEG && mcfg->memseg[s].len > 0){
+	while (s < memgrow_nb_init_memseg() && mcfg->memseg[s].len > 0){
 		void *addr, *base_addr;
 		uintptr_t offset = 0;
 		size_t mapping_size;
@@ -1550,12 +2143,20 @@ int
 rte_eal_memory_init(void)
 {
 	RTE_LOG(INFO, EAL, "Setting up memory...\n");
+	if (rte_eal_process_type() != RTE_PROC_PRIMARY && memgrow_attach() < 0)
+		return -1;
+
 	const int retval = rte_eal_process_type() == RTE_PROC_PRIMARY ?
 			rte_eal_hugepage_init() :
 			rte_eal_hugepage_attach();
 	if (retval < 0)
 		return -1;
 
+	/* set up or catch up with the segments added at runtime */
+	if (rte_eal_process_type() == RTE_PROC_PRIMARY ?
+			memgrow_init() < 0 : rte_eal_memseg_sync() < 0)
+		return -1;
+
 	if (internal_config.no_shconf == 0 && rte_eal_memdevice_init() < 0)
 		return -1;
 
@@ -0,0 +1,532 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_memory.h>
+#include <rte_memcpy.h>
+#include <rte_prefetch.h>
+#include <rte_branch_prediction.h>
+#include <rte_atomic.h>
+#ifdef RTE_MACHINE_CPUFLAG_SSE2
+#include <rte_vect.h>
+#endif
+
+#include "rte_hash.h"
+#include "rte_cuckoo_hash.h"
+
+/* Stored key size is a multiple of this value */
+#define KEY_ALIGNMENT           16
+
+/* Element of the breadth first search for a displacement path */
+struct cuckoo_queue_node {
+	uint32_t bkt_idx;		/* Bucket visited */
+	int prev_slot;			/* Entry of the previous bucket that
+					   would move into this bucket */
+	struct cuckoo_queue_node *prev;	/* Previous bucket on the path */
+};
+
+static inline uint32_t
+align_size(uint32_t val, uint32_t alignment)
+{
+	return alignment * ((val + alignment - 1) / alignment);
+}
+
+/* The upper half of the hash value is kept in the bucket as a signature. */
+static inline uint16_t
+cuckoo_short_sig(hash_sig_t sig)
+{
+	return (uint16_t)(sig >> 16);
+}
+
+static inline uint32_t
+cuckoo_prim_bkt(const struct rte_hash_cuckoo *c, hash_sig_t sig)
+{
+	return sig & c->bucket_bitmask;
+}
+
+/*
+ * The alternative bucket is derived from the current bucket and the short
+ * signature only, so that an entry can be moved to its other bucket without
+ * rehashing its key, whichever of the two it currently sits in.
+ */
+static inline uint32_t
+cuckoo_alt_bkt(const struct rte_hash_cuckoo *c, uint32_t bkt_idx,
+		uint16_t short_sig)
+{
+	return (bkt_idx ^ short_sig) & c->bucket_bitmask;
+}
+
+static inline void *
+cuckoo_key(const struct rte_hash_cuckoo *c, uint32_t key_idx)
+{
+	return c->key_store + (size_t)key_idx * c->key_entry_size;
+}
+
+size_t
+rte_cuckoo_hash_mem_size(const struct rte_hash_parameters *params)
+{
+	uint32_t num_buckets = params->entries / RTE_HASH_CUCKOO_BUCKET_ENTRIES;
+
+	return align_size(sizeof(struct rte_hash_cuckoo), RTE_CACHE_LINE_SIZE) +
+		(size_t)num_buckets * sizeof(struct rte_hash_cuckoo_bucket) +
+		align_size(((size_t)params->entries + 1) *
+				align_size(params->key_len, KEY_ALIGNMENT),
+			RTE_CACHE_LINE_SIZE) +
+		(size_t)params->entries * sizeof(uint32_t);
+}
+
+void
+rte_cuckoo_hash_init(struct rte_hash *h, void *mem,
+		const struct rte_hash_parameters *params)
+{
+	struct rte_hash_cuckoo *c = mem;
+	uint8_t *p = mem;
+	uint32_t i;
+
+	c->num_buckets = params->entries / RTE_HASH_CUCKOO_BUCKET_ENTRIES;
+	c->bucket_bitmask = c->num_buckets - 1;
+	c->key_entry_size = align_size(params->key_len, KEY_ALIGNMENT);
+	c->rw_lf = !!(params->extra_flag &
+			RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF);
+	c->tbl_chng_cnt = 0;
+
+	p += align_size(sizeof(*c), RTE_CACHE_LINE_SIZE);
+	c->buckets = (struct rte_hash_cuckoo_bucket *)p;
+	p += (size_t)c->num_buckets * sizeof(struct rte_hash_cuckoo_bucket);
+	c->key_store = p;
+	p += align_size(((size_t)params->entries + 1) * c->key_entry_size,
+			RTE_CACHE_LINE_SIZE);
+	c->free_slots = (uint32_t *)p;
+
+	/* Hand out low key indexes first */
+	for (i = 0; i < params->entries; i++)
+		c->free_slots[i] = params->entries - i;
+	c->free_slots_cnt = params->entries;
+
+	h->cuckoo = c;
+}
+
+/* Returns the key index of key in the bucket, or CUCKOO_EMPTY_SLOT. */
+static inline uint32_t
+cuckoo_search_bucket(const struct rte_hash *h,
+		const struct rte_hash_cuckoo_bucket *bkt,
+		const void *key, uint16_t short_sig)
+{
+	const struct rte_hash_cuckoo *c = h->cuckoo;
+	uint32_t i, key_idx;
+
+	for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES; i++) {
+		if (bkt->sig[i] != short_sig)
+			continue;
+		key_idx = bkt->key_idx[i];
+		if (key_idx != CUCKOO_EMPTY_SLOT &&
+				likely(memcmp(key, cuckoo_key(c, key_idx),
+					h->key_len) == 0))
+			return key_idx;
+	}
+
+	return CUCKOO_EMPTY_SLOT;
+}
+
+/* Returns the first unused entry of the bucket, or -1 if it is full. */
+static inline int
+cuckoo_find_empty(const struct rte_hash_cuckoo_bucket *bkt)
+{
+	int i;
+
+	for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES; i++) {
+		if (bkt->key_idx[i] == CUCKOO_EMPTY_SLOT)
+			return i;
+	}
+
+	return -1;
+}
+
+/*
+ * Moves the entries along the displacement path ending in node, whose bucket
+ * has an unused entry at slot, starting from the end of the path. A moved
+ * key is first published in its new bucket and only then overwritten in its
+ * old one, so it can always be found in at least one of its two buckets; the
+ * change counter lets a reader which checked them in the wrong order retry.
+ * Returns the entry of the first bucket of the path that is now free.
+ */
+static int
+cuckoo_move_path(struct rte_hash_cuckoo *c, struct cuckoo_queue_node *node,
+		int slot)
+{
+	struct rte_hash_cuckoo_bucket *dst, *src;
+	struct cuckoo_queue_node *prev;
+	int prev_slot;
+
+	while (node->prev != NULL) {
+		prev = node->prev;
+		prev_slot = node->prev_slot;
+		dst = &c->buckets[node->bkt_idx];
+		src = &c->buckets[prev->bkt_idx];
+
+		dst->sig[slot] = src->sig[prev_slot];
+		rte_smp_wmb();
+		dst->key_idx[slot] = src->key_idx[prev_slot];
+		rte_smp_wmb();
+		c->tbl_chng_cnt++;
+		rte_smp_wmb();
+
+		node = prev;
+		slot = prev_slot;
+	}
+
+	return slot;
+}
+
+/*
+ * Breadth first search, starting from bkt_idx, for the shortest chain of
+ * entries that can each move to their alternative bucket and which ends in a
+ * bucket with an unused entry. Being the shortest, the chain never visits a
+ * bucket twice, so moving it cannot displace an entry already moved. Returns
+ * the entry of bkt_idx freed by moving the chain, or -ENOSPC if none was
+ * found.
+ */
+static int
+cuckoo_make_space(struct rte_hash_cuckoo *c, uint32_t bkt_idx)
+{
+	struct cuckoo_queue_node queue[CUCKOO_BFS_QUEUE_MAX_LEN];
+	struct cuckoo_queue_node *node;
+	struct rte_hash_cuckoo_bucket *bkt;
+	uint32_t head = 0, tail = 0, i;
+	int slot;
+
+	queue[tail].bkt_idx = bkt_idx;
+	queue[tail].prev = NULL;
+	queue[tail].prev_slot = -1;
+	tail++;
+
+	while (head != tail &&
+			tail < CUCKOO_BFS_QUEUE_MAX_LEN -
+				RTE_HASH_CUCKOO_BUCKET_ENTRIES) {
+		node = &queue[head++];
+		bkt = &c->buckets[node->bkt_idx];
+
+		slot = cuckoo_find_empty(bkt);
+		if (slot >= 0)
+			return cuckoo_move_path(c, node, slot);
+
+		for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES; i++) {
+			queue[tail].bkt_idx = cuckoo_alt_bkt(c, node->bkt_idx,
+					bkt->sig[i]);
+			queue[tail].prev = node;
+			queue[tail].prev_slot = i;
+			tail++;
+		}
+	}
+
+	return -ENOSPC;
+}
+
+int32_t
+rte_cuckoo_hash_add_key_with_hash(const struct rte_hash *h,
+		const void *key, hash_sig_t sig)
+{
+	struct rte_hash_cuckoo *c = h->cuckoo;
+	struct rte_hash_cuckoo_bucket *bkt;
+	uint16_t short_sig = cuckoo_short_sig(sig);
+	uint32_t prim_idx, sec_idx, key_idx;
+	int slot;
+
+	prim_idx = cuckoo_prim_bkt(c, sig);
+	sec_idx = cuckoo_alt_bkt(c, prim_idx, short_sig);
+
+	/* Check if key is already present in the hash */
+	key_idx = cuckoo_search_bucket(h, &c->buckets[prim_idx], key,
+			short_sig);
+	if (key_idx == CUCKOO_EMPTY_SLOT)
+		key_idx = cuckoo_search_bucket(h, &c->buckets[sec_idx], key,
+				short_sig);
+	if (key_idx != CUCKOO_EMPTY_SLOT)
+		return key_idx - 1;
+
+	if (unlikely(c->free_slots_cnt == 0))
+		return -ENOSPC;
+
+	/* Find a free entry, displacing other keys if both buckets are full */
+	bkt = &c->buckets[prim_idx];
+	slot = cuckoo_find_empty(bkt);
+	if (slot < 0) {
+		bkt = &c->buckets[sec_idx];
+		slot = cuckoo_find_empty(bkt);
+	}
+	if (slot < 0) {
+		bkt = &c->buckets[prim_idx];
+		slot = cuckoo_make_space(c, prim_idx);
+	}
+	if (slot < 0) {
+		bkt = &c->buckets[sec_idx];
+		slot = cuckoo_make_space(c, sec_idx);
+	}
+	if (unlikely(slot < 0))
+		return -ENOSPC;
+
+	/* The key must be in place before readers can see its index */
+	key_idx = c->free_slots[--c->free_slots_cnt];
+	rte_memcpy(cuckoo_key(c, key_idx), key, h->key_len);
+	bkt->sig[slot] = short_sig;
+	rte_smp_wmb();
+	bkt->key_idx[slot] = key_idx;
+
+	return key_idx - 1;
+}
+
+int32_t
+rte_cuckoo_hash_del_key_with_hash(const struct rte_hash *h,
+		const void *key, hash_sig_t sig)
+{
+	struct rte_hash_cuckoo *c = h->cuckoo;
+	struct rte_hash_cuckoo_bucket *bkt;
+	uint16_t short_sig = cuckoo_short_sig(sig);
+	uint32_t bkt_idx, i, key_idx;
+	unsigned n;
+
+	bkt_idx = cuckoo_prim_bkt(c, sig);
+	for (n = 0; n < 2; n++) {
+		bkt = &c->buckets[bkt_idx];
+		for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES; i++) {
+			key_idx = bkt->key_idx[i];
+			if (bkt->sig[i] != short_sig ||
+					key_idx == CUCKOO_EMPTY_SLOT ||
+					memcmp(key, cuckoo_key(c, key_idx),
+						h->key_len) != 0)
+				continue;
+
+			bkt->key_idx[i] = CUCKOO_EMPTY_SLOT;
+			/*
+			 * Concurrent readers may still be comparing the key,
+			 * so its index is only recycled on explicit request.
+			 */
+			if (!c->rw_lf)
+				c->free_slots[c->free_slots_cnt++] = key_idx;
+			return key_idx - 1;
+		}
+		bkt_idx = cuckoo_alt_bkt(c, bkt_idx, short_sig);
+	}
+
+	return -ENOENT;
+}
+
+int32_t
+rte_cuckoo_hash_lookup_with_hash(const struct rte_hash *h,
+		const void *key, hash_sig_t sig)
+{
+	const struct rte_hash_cuckoo *c = h->cuckoo;
+	uint16_t short_sig = cuckoo_short_sig(sig);
+	uint32_t prim_idx, sec_idx, key_idx, cnt;
+
+	prim_idx = cuckoo_prim_bkt(c, sig);
+	sec_idx = cuckoo_alt_bkt(c, prim_idx, short_sig);
+
+	do {
+		cnt = c->tbl_chng_cnt;
+		rte_smp_rmb();
+
+		key_idx = cuckoo_search_bucket(h, &c->buckets[prim_idx], key,
+				short_sig);
+		if (key_idx != CUCKOO_EMPTY_SLOT)
+			return key_idx - 1;
+		key_idx = cuckoo_search_bucket(h, &c->buckets[sec_idx], key,
+				short_sig);
+		if (key_idx != CUCKOO_EMPTY_SLOT)
+			return key_idx - 1;
+
+		rte_smp_rmb();
+		/* A key moved meanwhile may have been missed, search again */
+	} while (unlikely(cnt != c->tbl_chng_cnt));
+
+	return -ENOENT;
+}
+
+/*
+ * Compares the short signature against all entries of both buckets of a key
+ * at once. The masks returned have two bits per matching entry, as given by
+ * the byte mask of a 16-bit compare.
+ */
+static inline void
+cuckoo_compare_sigs(const struct rte_hash_cuckoo_bucket *prim_bkt,
+		const struct rte_hash_cuckoo_bucket *sec_bkt, uint16_t short_sig,
+		uint32_t *prim_mask, uint32_t *sec_mask)
+{
+#if defined(RTE_MACHINE_CPUFLAG_AVX2)
+	__m256i bkts = _mm256_inserti128_si256(_mm256_castsi128_si256(
+			_mm_load_si128((const __m128i *)prim_bkt->sig)),
+			_mm_load_si128((const __m128i *)sec_bkt->sig), 1);
+	uint32_t mask = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi16(bkts,
+			_mm256_set1_epi16(short_sig)));
+
+	*prim_mask = mask & 0xffff;
+	*sec_mask = mask >> 16;
+#elif defined(RTE_MACHINE_CPUFLAG_SSE2)
+	__m128i sig_vec = _mm_set1_epi16(short_sig);
+
+	*prim_mask = _mm_movemask_epi8(_mm_cmpeq_epi16(sig_vec,
+			_mm_load_si128((const __m128i *)prim_bkt->sig)));
+	*sec_mask = _mm_movemask_epi8(_mm_cmpeq_epi16(sig_vec,
+			_mm_load_si128((const __m128i *)sec_bkt->sig)));
+#else
+	uint32_t i;
+
+	*prim_mask = 0;
+	*sec_mask = 0;
+	for (i = 0; i < RTE_HASH_CUCKOO_BUCKET_ENTRIES; i++) {
+		*prim_mask |= (uint32_t)(prim_bkt->sig[i] == short_sig) << (i * 2);
+		*sec_mask |= (uint32_t)(sec_bkt->sig[i] == short_sig) << (i * 2);
+	}
+#endif
+}
+
+/*
+ * Compares the key against the entries of the bucket flagged in the mask
+ * returned by cuckoo_compare_sigs(). Returns the key index or
+ * CUCKOO_EMPTY_SLOT.
+ */
+static inline uint32_t
+cuckoo_compare_keys(const struct rte_hash *h,
+		const struct rte_hash_cuckoo_bucket *bkt, const void *key,
+		uint32_t mask)
+{
+	const struct rte_hash_cuckoo *c = h->cuckoo;
+	uint32_t i, key_idx;
+
+	while (mask != 0) {
+		i = __builtin_ctz(mask) >> 1;
+		mask &= ~(3U << (i * 2));
+		key_idx = bkt->key_idx[i];
+		if (key_idx != CUCKOO_EMPTY_SLOT &&
+				likely(memcmp(key, cuckoo_key(c, key_idx),
+					h->key_len) == 0))
+			return key_idx;
+	}
+
+	return CUCKOO_EMPTY_SLOT;
+}
+
+int
+rte_cuckoo_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
+		uint32_t num_keys, int32_t *positions, uint64_t *hit_mask)
+{
+	const struct rte_hash_cuckoo *c = h->cuckoo;
+	const struct rte_hash_cuckoo_bucket *prim_bkt[RTE_HASH_LOOKUP_BULK_MAX];
+	const struct rte_hash_cuckoo_bucket *sec_bkt[RTE_HASH_LOOKUP_BULK_MAX];
+	hash_sig_t sigs[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t prim_masks[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t sec_masks[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t i, prim_idx, key_idx, cnt;
+	uint64_t hits = 0;
+	int n_hits = 0;
+
+	/* Get the hash values and pre-fetch both buckets of every key */
+	for (i = 0; i < num_keys; i++) {
+		sigs[i] = rte_hash_hash(h, keys[i]);
+		prim_idx = cuckoo_prim_bkt(c, sigs[i]);
+		prim_bkt[i] = &c->buckets[prim_idx];
+		sec_bkt[i] = &c->buckets[cuckoo_alt_bkt(c, prim_idx,
+				cuckoo_short_sig(sigs[i]))];
+		rte_prefetch0((volatile void *)(uintptr_t)prim_bkt[i]);
+		rte_prefetch0((volatile void *)(uintptr_t)sec_bkt[i]);
+	}
+
+	cnt = c->tbl_chng_cnt;
+	rte_smp_rmb();
+
+	/* Compare signatures, pre-fetching the first candidate key */
+	for (i = 0; i < num_keys; i++) {
+		cuckoo_compare_sigs(prim_bkt[i], sec_bkt[i],
+				cuckoo_short_sig(sigs[i]),
+				&prim_masks[i], &sec_masks[i]);
+		if (prim_masks[i] != 0)
+			rte_prefetch0(cuckoo_key(c, prim_bkt[i]->key_idx[
+					__builtin_ctz(prim_masks[i]) >> 1]));
+		else if (sec_masks[i] != 0)
+			rte_prefetch0(cuckoo_key(c, sec_bkt[i]->key_idx[
+					__builtin_ctz(sec_masks[i]) >> 1]));
+	}
+
+	/* Compare the full keys */
+	for (i = 0; i < num_keys; i++) {
+		key_idx = cuckoo_compare_keys(h, prim_bkt[i], keys[i],
+				prim_masks[i]);
+		if (key_idx == CUCKOO_EMPTY_SLOT)
+			key_idx = cuckoo_compare_keys(h, sec_bkt[i], keys[i],
+					sec_masks[i]);
+		if (key_idx != CUCKOO_EMPTY_SLOT) {
+			positions[i] = key_idx - 1;
+			hits |= 1ULL << i;
+			n_hits++;
+		} else
+			positions[i] = -ENOENT;
+	}
+
+	rte_smp_rmb();
+	/* Keys moved meanwhile may have been missed, search them again */
+	if (unlikely(cnt != c->tbl_chng_cnt) && n_hits != (int)num_keys) {
+		for (i = 0; i < num_keys; i++) {
+			if (hits & (1ULL << i))
+				continue;
+			positions[i] = rte_cuckoo_hash_lookup_with_hash(h,
+					keys[i], sigs[i]);
+			if (positions[i] >= 0) {
+				hits |= 1ULL << i;
+				n_hits++;
+			}
+		}
+	}
+
+	if (hit_mask != NULL)
+		*hit_mask = hits;
+
+	return n_hits;
+}
+
+int
+rte_cuckoo_hash_free_key_with_position(const struct rte_hash *h,
+		int32_t position)
+{
+	struct rte_hash_cuckoo *c = h->cuckoo;
+
+	if (!c->rw_lf || position < 0 || (uint32_t)position >= h->entries ||
+			c->free_slots_cnt >= h->entries)
+		return -EINVAL;
+
+	c->free_slots[c->free_slots_cnt++] = position + 1;
+	return 0;
+}
@@ -0,0 +1,110 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _RTE_CUCKOO_HASH_H_
+#define _RTE_CUCKOO_HASH_H_
+
+/*
+ * Internal definitions of the cuckoo hash backend of rte_hash. Not part of
+ * the public API.
+ */
+
+#include <stdint.h>
+
+#include <rte_memory.h>
+
+#include "rte_hash.h"
+
+/* Key index stored in a bucket entry that is not in use */
+#define CUCKOO_EMPTY_SLOT		0
+
+/* Max number of buckets visited when searching a displacement path */
+#define CUCKOO_BFS_QUEUE_MAX_LEN	1000
+
+/*
+ * A bucket holds a short signature and an index into the key store for each
+ * of its entries, so that a whole bucket fits in a single cache line and the
+ * key itself is only read once the signature matches.
+ */
+struct rte_hash_cuckoo_bucket {
+	uint16_t sig[RTE_HASH_CUCKOO_BUCKET_ENTRIES];
+	uint32_t key_idx[RTE_HASH_CUCKOO_BUCKET_ENTRIES];
+} __rte_cache_aligned;
+
+struct rte_hash_cuckoo {
+	uint32_t num_buckets;		/* Number of buckets, power of 2 */
+	uint32_t bucket_bitmask;	/* Bucket index mask */
+	uint32_t key_entry_size;	/* Size of a key store entry */
+	uint32_t rw_lf;			/* Lock-free readers with one writer */
+	/*
+	 * Incremented by the writer each time a key is moved from one bucket
+	 * to the other, so that a reader which raced with the move and missed
+	 * the key in both buckets can retry.
+	 */
+	volatile uint32_t tbl_chng_cnt;
+	uint32_t free_slots_cnt;	/* Number of unused key indexes */
+	uint32_t *free_slots;		/* Stack of unused key indexes */
+	struct rte_hash_cuckoo_bucket *buckets;
+	uint8_t *key_store;		/* Key index 0 is never used */
+};
+
+/* Memory needed by the cuckoo state of a table with the given parameters */
+size_t
+rte_cuckoo_hash_mem_size(const struct rte_hash_parameters *params);
+
+/* Setup the cuckoo state in the memory area following the hash structure */
+void
+rte_cuckoo_hash_init(struct rte_hash *h, void *mem,
+		const struct rte_hash_parameters *params);
+
+int32_t
+rte_cuckoo_hash_add_key_with_hash(const struct rte_hash *h,
+		const void *key, hash_sig_t sig);
+
+int32_t
+rte_cuckoo_hash_del_key_with_hash(const struct rte_hash *h,
+		const void *key, hash_sig_t sig);
+
+int32_t
+rte_cuckoo_hash_lookup_with_hash(const struct rte_hash *h,
+		const void *key, hash_sig_t sig);
+
+int
+rte_cuckoo_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
+		uint32_t num_keys, int32_t *positions, uint64_t *hit_mask);
+
+int
+rte_cuckoo_hash_free_key_with_position(const struct rte_hash *h,
+		int32_t position);
+
+#endif /* _RTE_CUCKOO_HASH_H_ */
@@ -56,7 +56,12 @@
 #include <rte_rwlock.h>
 #include <rte_spinlock.h>
 
+#ifdef RTE_MACHINE_CPUFLAG_SSE2
+#include <rte_vect.h>
+#endif
+
 #include "rte_hash.h"
+#include "rte_cuckoo_hash.h"
 
 TAILQ_HEAD(rte_hash_list, rte_tailq_entry);
 
@@ -165,6 +170,82 @@ rte_hash_find_existing(const char *name)
 	return h;
 }
 
+static struct rte_hash *
+rte_hash_create_cuckoo(const struct rte_hash_parameters *params)
+{
+	struct rte_hash *h = NULL;
+	struct rte_tailq_entry *te;
+	uint32_t hash_tbl_size;
+	size_t mem_size;
+	char hash_name[RTE_HASH_NAMESIZE];
+	struct rte_hash_list *hash_list;
+
+	hash_list = RTE_TAILQ_CAST(rte_hash_tailq.head, rte_hash_list);
+
+	/* Check for valid parameters */
+	if ((params->entries > RTE_HASH_ENTRIES_MAX) ||
+			(params->entries < RTE_HASH_CUCKOO_BUCKET_ENTRIES) ||
+			!rte_is_power_of_2(params->entries) ||
+			(params->key_len == 0) ||
+			(params->key_len > RTE_HASH_KEY_LENGTH_MAX)) {
+		rte_errno = EINVAL;
+		RTE_LOG(ERR, HASH, "rte_hash_create has invalid parameters\n");
+		return NULL;
+	}
+
+	snprintf(hash_name, sizeof(hash_name), "HT_%s", params->name);
+
+	hash_tbl_size = align_size(sizeof(struct rte_hash), RTE_CACHE_LINE_SIZE);
+	mem_size = hash_tbl_size + rte_cuckoo_hash_mem_size(params);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* guarantee there's no existing */
+	TAILQ_FOREACH(te, hash_list, next) {
+		h = (struct rte_hash *) te->data;
+		if (strncmp(params->name, h->name, RTE_HASH_NAMESIZE) == 0)
+			break;
+	}
+	if (te != NULL)
+		goto exit;
+
+	te = rte_zmalloc("HASH_TAILQ_ENTRY", sizeof(*te), 0);
+	if (te == NULL) {
+		RTE_LOG(ERR, HASH, "tailq entry allocation failed\n");
+		goto exit;
+	}
+
+	h = (struct rte_hash *)rte_zmalloc_socket(hash_name, mem_size,
+					   RTE_CACHE_LINE_SIZE, params->socket_id);
+	if (h == NULL) {
+		RTE_LOG(ERR, HASH, "memory allocation failed\n");
+		rte_free(te);
+		goto exit;
+	}
+
+	/* Setup hash context */
+	snprintf(h->name, sizeof(h->name), "%s", params->name);
+	h->entries = params->entries;
+	h->bucket_entries = RTE_HASH_CUCKOO_BUCKET_ENTRIES;
+	h->key_len = params->key_len;
+	h->hash_func_init_val = params->hash_func_init_val;
+	h->hash_func = (params->hash_func == NULL) ?
+		DEFAULT_HASH_FUNC : params->hash_func;
+	h->extra_flag = params->extra_flag | RTE_HASH_EXTRA_FLAGS_CUCKOO;
+	rte_cuckoo_hash_init(h, (uint8_t *)h + hash_tbl_size, params);
+	h->num_buckets = h->cuckoo->num_buckets;
+	h->bucket_bitmask = h->cuckoo->bucket_bitmask;
+
+	te->data = (void *) h;
+
+	TAILQ_INSERT_TAIL(hash_list, te, next);
+
+exit:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	return h;
+}
+
 struct rte_hash *
 rte_hash_create(const struct rte_hash_parameters *params)
 {
@@ -177,6 +258,11 @@ rte_hash_create(const struct rte_hash_parameters *params)
 
 	hash_list = RTE_TAILQ_CAST(rte_hash_tailq.head, rte_hash_list);
 
+	if ((params != NULL) && (params->extra_flag &
+			(RTE_HASH_EXTRA_FLAGS_CUCKOO |
+			 RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF)))
+		return rte_hash_create_cuckoo(params);
+
 	/* Check for valid parameters */
 	if ((params == NULL) ||
 			(params->entries > RTE_HASH_ENTRIES_MAX) ||
@@ -332,6 +418,8 @@ rte_hash_add_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->cuckoo != NULL)
+		return rte_cuckoo_hash_add_key_with_hash(h, key, sig);
 	return __rte_hash_add_key_with_hash(h, key, sig);
 }
 
@@ -339,6 +427,9 @@ int32_t
 rte_hash_add_key(const struct rte_hash *h, const void *key)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->cuckoo != NULL)
+		return rte_cuckoo_hash_add_key_with_hash(h, key,
+				rte_hash_hash(h, key));
 	return __rte_hash_add_key_with_hash(h, key, rte_hash_hash(h, key));
 }
 
@@ -374,6 +465,8 @@ rte_hash_del_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->cuckoo != NULL)
+		return rte_cuckoo_hash_del_key_with_hash(h, key, sig);
 	return __rte_hash_del_key_with_hash(h, key, sig);
 }
 
@@ -381,6 +474,9 @@ int32_t
 rte_hash_del_key(const struct rte_hash *h, const void *key)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->cuckoo != NULL)
+		return rte_cuckoo_hash_del_key_with_hash(h, key,
+				rte_hash_hash(h, key));
 	return __rte_hash_del_key_with_hash(h, key, rte_hash_hash(h, key));
 }
 
@@ -415,6 +511,8 @@ rte_hash_lookup_with_hash(const struct rte_hash *h,
 			const void *key, hash_sig_t sig)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->cuckoo != NULL)
+		return rte_cuckoo_hash_lookup_with_hash(h, key, sig);
 	return __rte_hash_lookup_with_hash(h, key, sig);
 }
 
@@ -422,50 +520,129 @@ int32_t
 rte_hash_lookup(const struct rte_hash *h, const void *key)
 {
 	RETURN_IF_TRUE(((h == NULL) || (key == NULL)), -EINVAL);
+	if (h->cuckoo != NULL)
+		return rte_cuckoo_hash_lookup_with_hash(h, key,
+				rte_hash_hash(h, key));
 	return __rte_hash_lookup_with_hash(h, key, rte_hash_hash(h, key));
 }
 
+/*
+ * Returns a mask of the entries of the signature bucket matching sig, one bit
+ * per entry. Signature buckets are padded to SIG_BUCKET_ALIGNMENT bytes, so
+ * whole vectors can be compared even for buckets smaller than that.
+ */
+static inline uint32_t
+sig_bucket_match(const struct rte_hash *h, const hash_sig_t *sig_bucket,
+		hash_sig_t sig)
+{
+	uint32_t mask = 0;
+	uint32_t i;
+
+#ifdef RTE_MACHINE_CPUFLAG_SSE2
+	const __m128i sig_vec = _mm_set1_epi32(sig);
+
+	for (i = 0; i < h->bucket_entries; i += 4) {
+		__m128i cmp = _mm_cmpeq_epi32(sig_vec,
+				_mm_load_si128((const __m128i *)&sig_bucket[i]));
+		mask |= (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(cmp)) << i;
+	}
+	mask &= (1ULL << h->bucket_entries) - 1;
+#else
+	for (i = 0; i < h->bucket_entries; i++)
+		if (sig_bucket[i] == sig)
+			mask |= 1 << i;
+#endif
+
+	return mask;
+}
+
 int
-rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
-		      uint32_t num_keys, int32_t *positions)
+rte_hash_lookup_bulk_hit_mask(const struct rte_hash *h, const void **keys,
+		uint32_t num_keys, int32_t *positions, uint64_t *hit_mask)
 {
 	uint32_t i, j, bucket_index;
 	hash_sig_t sigs[RTE_HASH_LOOKUP_BULK_MAX];
+	uint32_t sig_masks[RTE_HASH_LOOKUP_BULK_MAX];
+	uint64_t hits = 0;
+	int n_hits = 0;
 
 	RETURN_IF_TRUE(((h == NULL) || (keys == NULL) || (num_keys == 0) ||
 			(num_keys > RTE_HASH_LOOKUP_BULK_MAX) ||
 			(positions == NULL)), -EINVAL);
 
-	/* Get the hash signature and bucket index */
+	if (h->cuckoo != NULL)
+		return rte_cuckoo_hash_lookup_bulk(h, keys, num_keys,
+				positions, hit_mask);
+
+	/* Get the hash signatures and pre-fetch all signature buckets */
 	for (i = 0; i < num_keys; i++) {
 		sigs[i] = h->hash_func(keys[i], h->key_len,
 				h->hash_func_init_val) | h->sig_msb;
 		bucket_index = sigs[i] & h->bucket_bitmask;
-
-		/* Pre-fetch relevant buckets */
-		rte_prefetch1((void *) get_sig_tbl_bucket(h, bucket_index));
-		rte_prefetch1((void *) get_key_tbl_bucket(h, bucket_index));
+		rte_prefetch0((void *) get_sig_tbl_bucket(h, bucket_index));
 	}
 
-	/* Check if key is already present in the hash */
+	/*
+	 * Compare signatures and only pre-fetch the keys that may match,
+	 * instead of the whole key bucket.
+	 */
 	for (i = 0; i < num_keys; i++) {
 		bucket_index = sigs[i] & h->bucket_bitmask;
-		hash_sig_t *sig_bucket = get_sig_tbl_bucket(h, bucket_index);
-		uint8_t *key_bucket = get_key_tbl_bucket(h, bucket_index);
+		sig_masks[i] = sig_bucket_match(h,
+				get_sig_tbl_bucket(h, bucket_index), sigs[i]);
+		if (sig_masks[i] != 0)
+			rte_prefetch0(get_key_from_bucket(h,
+					get_key_tbl_bucket(h, bucket_index),
+					__builtin_ctz(sig_masks[i])));
+	}
 
-		positions[i] = -ENOENT;
+	/* Compare the full keys of the matching signatures */
+	for (i = 0; i < num_keys; i++) {
+		uint32_t mask = sig_masks[i];
+		uint8_t *key_bucket;
 
-		for (j = 0; j < h->bucket_entries; j++) {
-			if ((sigs[i] == sig_bucket[j]) &&
-			    likely(memcmp(keys[i],
-					  get_key_from_bucket(h, key_bucket, j),
-					  h->key_len) == 0)) {
+		positions[i] = -ENOENT;
+		bucket_index = sigs[i] & h->bucket_bitmask;
+		key_bucket = get_key_tbl_bucket(h, bucket_index);
+
+		while (mask != 0) {
+			j = __builtin_ctz(mask);
+			mask &= mask - 1;
+			if (likely(memcmp(keys[i],
+					get_key_from_bucket(h, key_bucket, j),
+					h->key_len) == 0)) {
 				positions[i] = bucket_index *
 					h->bucket_entries + j;
+				hits |= 1ULL << i;
+				n_hits++;
 				break;
 			}
 		}
 	}
 
-	return 0;
+	if (hit_mask != NULL)
+		*hit_mask = hits;
+
+	return n_hits;
+}
+
+int
+rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
+		      uint32_t num_keys, int32_t *positions)
+{
+	int ret;
+
+	ret = rte_hash_lookup_bulk_hit_mask(h, keys, num_keys, positions,
+			NULL);
+
+	return (ret < 0) ? ret : 0;
+}
+
+int
+rte_hash_free_key_with_position(const struct rte_hash *h,
+				const int32_t position)
+{
+	if ((h == NULL) || (h->cuckoo == NULL))
+		return -EINVAL;
+	return rte_cuckoo_hash_free_key_with_position(h, position);
 }
@@ -57,12 +57,26 @@ extern "C" {
 #define RTE_HASH_KEY_LENGTH_MAX			64
 
 /** Max number of keys that can be searched for using rte_hash_lookup_multi. */
-#define RTE_HASH_LOOKUP_BULK_MAX		16
+#define RTE_HASH_LOOKUP_BULK_MAX		64
 #define RTE_HASH_LOOKUP_MULTI_MAX		RTE_HASH_LOOKUP_BULK_MAX
 
 /** Max number of characters in hash name.*/
 #define RTE_HASH_NAMESIZE			32
 
+/** Number of entries in each bucket of a cuckoo hash table. */
+#define RTE_HASH_CUCKOO_BUCKET_ENTRIES		8
+
+/** Use the cuckoo hash backend instead of the fixed bucket one. */
+#define RTE_HASH_EXTRA_FLAGS_CUCKOO		0x01
+
+/**
+ * Cuckoo hash backend where lookups may run concurrently with one writer
+ * without taking any lock. Implies RTE_HASH_EXTRA_FLAGS_CUCKOO. Deleted key
+ * positions are not recycled until rte_hash_free_key_with_position() is
+ * called, which must only happen once no reader can still reference them.
+ */
+#define RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF	0x02
+
 /** Signature of key that is stored internally. */
 typedef uint32_t hash_sig_t;
 
@@ -82,8 +96,13 @@ struct rte_hash_parameters {
 	rte_hash_function hash_func;	/**< Function used to calculate hash. */
 	uint32_t hash_func_init_val;	/**< Init value used by hash_func. */
 	int socket_id;			/**< NUMA Socket ID for memory. */
+	uint8_t extra_flag;		/**< Indicate if additional parameters
+					   are present (RTE_HASH_EXTRA_FLAGS_*). */
 };
 
+/* Internal state of a cuckoo hash table. */
+struct rte_hash_cuckoo;
+
 /** A hash table structure. */
 struct rte_hash {
 	char name[RTE_HASH_NAMESIZE];	/**< Name of the hash. */
@@ -104,11 +123,22 @@ struct rte_hash {
 	uint32_t key_tbl_key_size;	/**< Keys may be padded for alignment
 					   reasons, and this is the key size
 					   used	by key_tbl. */
+	uint8_t extra_flag;	/**< RTE_HASH_EXTRA_FLAGS_* from creation. */
+	struct rte_hash_cuckoo *cuckoo;	/**< Cuckoo table state, NULL if the
+					   fixed bucket backend is used. */
 };
 
 /**
  * Create a new hash table.
  *
+ * By default the table is split in fixed size buckets of signatures. When
+ * RTE_HASH_EXTRA_FLAGS_CUCKOO is set in params->extra_flag, a cuckoo hash is
+ * created instead: each key has two candidate buckets of
+ * RTE_HASH_CUCKOO_BUCKET_ENTRIES entries and existing keys are displaced to
+ * their alternative bucket to make room, so the table can be filled well
+ * above 90% of params->entries. The bucket_entries parameter is ignored for
+ * cuckoo tables.
+ *
  * @param params
  *   Parameters used to create and initialise the hash table.
  * @return
@@ -224,6 +254,26 @@ int32_t
 rte_hash_del_key_with_hash(const struct rte_hash *h,
 				const void *key, hash_sig_t sig);
 
+/**
+ * Release a key position returned by a previous delete so that it can be
+ * reused by a later add. Only valid for tables created with
+ * RTE_HASH_EXTRA_FLAGS_RW_CONCURRENCY_LF, where the position of a deleted
+ * key is kept reserved until no reader can be referencing it any more.
+ * This operation is not multi-thread safe and should only be called from
+ * the writer thread.
+ *
+ * @param h
+ *   Hash table the key was deleted from.
+ * @param position
+ *   Position returned by rte_hash_del_key() or rte_hash_del_key_with_hash().
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL if the parameters are invalid.
+ */
+int
+rte_hash_free_key_with_position(const struct rte_hash *h,
+				const int32_t position);
+
 
 /**
  * Find a key in the hash table. This operation is multi-thread safe.
@@ -302,6 +352,34 @@ rte_hash_hash(const struct rte_hash *h, const void *key)
 int
 rte_hash_lookup_bulk(const struct rte_hash *h, const void **keys,
 		      uint32_t num_keys, int32_t *positions);
+
+/**
+ * Find multiple keys in the hash table and report which ones were found.
+ * This operation is multi-thread safe.
+ *
+ * The lookup is done in stages over the whole burst: all hash values are
+ * computed and their buckets pre-fetched first, then the signatures of each
+ * bucket are compared with vector instructions, and only the keys whose
+ * signature matches are pre-fetched and compared. This hides most of the
+ * memory latency of each lookup behind the work done for the other keys.
+ *
+ * @param h
+ *   Hash table to look in.
+ * @param keys
+ *   A pointer to a list of keys to look for.
+ * @param num_keys
+ *   How many keys are in the keys list (up to RTE_HASH_LOOKUP_BULK_MAX).
+ * @param positions
+ *   Output containing a list of values, corresponding to the list of keys,
+ *   as for rte_hash_lookup_bulk().
+ * @param hit_mask
+ *   Output bitmask, bit i being set if keys[i] was found. May be NULL.
+ * @return
+ *   -EINVAL if there's an error, otherwise the number of keys found.
+ */
+int
+rte_hash_lookup_bulk_hit_mask(const struct rte_hash *h, const void **keys,
+		uint32_t num_keys, int32_t *positions, uint64_t *hit_mask);
 #ifdef __cplusplus
 }
 #endif
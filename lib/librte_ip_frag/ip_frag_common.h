@@ -34,6 +34,8 @@
 #ifndef _IP_FRAG_COMMON_H_
 #define _IP_FRAG_COMMON_H_
 
+#include <errno.h>
+
 #include "rte_ip_frag.h"
 
 /* logging macros. */
@@ -57,23 +59,55 @@ if (!(exp))	{							\
 /* helper macros */
 #define	IP_FRAG_MBUF2DR(dr, mb)	((dr)->row[(dr)->cnt++] = (mb))
 
+#define	IP_FRAG_TBL_POS(tbl, sig)	\
+	((tbl)->pkt + ((sig) & (tbl)->entry_mask))
+
+#define	IP_FRAG_TBL_SLOT(tbl, tms)	\
+	((tbl)->wheel + (((tms) >> (tbl)->wheel_shift) & \
+	(IP_FRAG_TBL_WHEEL_SLOTS - 1)))
+
+#ifdef RTE_LIBRTE_IP_FRAG_TBL_STAT
+#define	IP_FRAG_TBL_STAT_UPDATE(s, f, v)	((s)->f += (v))
+#else
+#define	IP_FRAG_TBL_STAT_UPDATE(s, f, v)	do {} while (0)
+#endif /* IP_FRAG_TBL_STAT */
+
 #define IPv6_KEY_BYTES(key) \
 	(key)[0], (key)[1], (key)[2], (key)[3]
 #define IPv6_KEY_BYTES_FMT \
 	"%08" PRIx64 "%08" PRIx64 "%08" PRIx64 "%08" PRIx64
 
+/* fragment attributes collected by the bulk reassembly functions */
+struct ip_frag_desc {
+	struct ip_frag_key key;   /* fragmentation key, key_len 0 - not a fragment */
+	uint32_t sig1;            /* primary hash signature */
+	uint32_t sig2;            /* secondary hash signature */
+	uint16_t ofs;             /* fragment offset */
+	uint16_t len;             /* fragment payload length */
+	uint16_t more_frags;      /* more fragments flag */
+};
+
 /* internal functions declarations */
-struct rte_mbuf * ip_frag_process(struct ip_frag_pkt *fp,
-		struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb,
-		uint16_t ofs, uint16_t len, uint16_t more_frags);
+struct rte_mbuf * ip_frag_process(struct rte_ip_frag_tbl *tbl,
+		struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
+		struct rte_mbuf *mb, uint16_t ofs, uint16_t len,
+		uint16_t more_frags);
 
 struct ip_frag_pkt * ip_frag_find(struct rte_ip_frag_tbl *tbl,
 		struct rte_ip_frag_death_row *dr,
 		const struct ip_frag_key *key, uint64_t tms);
 
 struct ip_frag_pkt * ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
-	const struct ip_frag_key *key, uint64_t tms,
-	struct ip_frag_pkt **free, struct ip_frag_pkt **stale);
+	const struct ip_frag_key *key, uint32_t sig1, uint32_t sig2,
+	uint64_t tms, struct ip_frag_pkt **free, struct ip_frag_pkt **stale);
+
+uint32_t ip_frag_tbl_expire(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, uint64_t tms, uint32_t budget);
+
+int ip_frag_reassemble_bulk(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct rte_mbuf **pkts_in,
+		struct ip_frag_desc *desc, uint16_t nb_pkts, uint64_t tms,
+		struct rte_mbuf **pkts_out);
 
 /* these functions need to be declared here as ip_frag_process relies on them */
 struct rte_mbuf * ipv4_frag_reassemble(const struct ip_frag_pkt *fp);
@@ -120,11 +154,11 @@ ip_frag_key_cmp(const struct ip_frag_key * k1, const struct ip_frag_key * k2)
  * misc fragment functions
  */
 
-/* put fragment on death row */
-static inline void
+/* put fragment on death row, return number of freed mbufs */
+static inline uint32_t
 ip_frag_free(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr)
 {
-	uint32_t i, k;
+	uint32_t i, k, n;
 
 	k = dr->cnt;
 	for (i = 0; i != fp->last_idx; i++) {
@@ -134,20 +168,33 @@ ip_frag_free(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr)
 		}
 	}
 
+	n = k - dr->cnt;
 	fp->last_idx = 0;
 	dr->cnt = k;
+	return (n);
 }
 
-/* if key is empty, mark key as in use */
+/* if key is empty, remove the entry from the expiration wheel */
 static inline void
-ip_frag_inuse(struct rte_ip_frag_tbl *tbl, const struct  ip_frag_pkt *fp)
+ip_frag_inuse(struct rte_ip_frag_tbl *tbl, struct ip_frag_pkt *fp)
 {
 	if (ip_frag_key_is_empty(&fp->key)) {
-		TAILQ_REMOVE(&tbl->lru, fp, lru);
+		TAILQ_REMOVE(IP_FRAG_TBL_SLOT(tbl, fp->start), fp, lru);
 		tbl->use_entries--;
 	}
 }
 
+/* check that a burst could be processed with the given death row */
+static inline int
+ip_frag_bulk_check(const struct rte_ip_frag_death_row *dr, uint16_t nb_pkts)
+{
+	if (nb_pkts > IP_FRAG_DEATH_ROW_LEN)
+		return (-EINVAL);
+	if (dr->cnt + nb_pkts * (IP_MAX_FRAG_NUM + 1) > RTE_DIM(dr->row))
+		return (-ENOSPC);
+	return (0);
+}
+
 /* reset the fragment */
 static inline void
 ip_frag_reset(struct ip_frag_pkt *fp, uint64_t tms)
@@ -166,6 +213,65 @@ ip_frag_reset(struct ip_frag_pkt *fp, uint64_t tms)
 	fp->frags[IP_FIRST_FRAG_IDX] = zero_frag;
 }
 
+/* allocate direct mbufs for the fragments of a packet */
+static inline int
+ip_frag_alloc_direct(struct rte_mempool *mp, struct rte_mbuf **mb,
+	uint32_t num)
+{
+	uint32_t i;
+
+	if (rte_mempool_get_bulk(mp, (void **)mb, num) < 0)
+		return (-ENOMEM);
+
+	for (i = 0; i != num; i++) {
+		rte_mbuf_refcnt_set(mb[i], 1);
+		rte_pktmbuf_reset(mb[i]);
+	}
+	return (0);
+}
+
+/*
+ * append next len bytes of the input packet to the fragment
+ * as indirect mbufs attached to the input segments.
+ */
+static inline int
+ip_frag_attach_payload(struct rte_mbuf *out_pkt, struct rte_mbuf **in_seg,
+	uint32_t *in_pos, uint32_t len, struct rte_mempool *pool_indirect)
+{
+	struct rte_mbuf *seg, *prev;
+	uint32_t n;
+
+	prev = out_pkt;
+	while (len != 0) {
+
+		/* skip consumed input segments. */
+		while (*in_pos == (*in_seg)->data_len) {
+			*in_seg = (*in_seg)->next;
+			*in_pos = 0;
+			if (unlikely(*in_seg == NULL))
+				return (-EINVAL);
+		}
+
+		seg = rte_pktmbuf_alloc(pool_indirect);
+		if (unlikely(seg == NULL))
+			return (-ENOMEM);
+
+		rte_pktmbuf_attach(seg, *in_seg);
+		n = RTE_MIN(len, (*in_seg)->data_len - *in_pos);
+		seg->data_off = (uint16_t)((*in_seg)->data_off + *in_pos);
+		seg->data_len = (uint16_t)n;
+
+		prev->next = seg;
+		prev = seg;
+		out_pkt->pkt_len += n;
+		out_pkt->nb_segs++;
+
+		*in_pos += n;
+		len -= n;
+	}
+	return (0);
+}
+
 /* chain two mbufs */
 static inline void
 ip_frag_chain(struct rte_mbuf *mn, struct rte_mbuf *mp)
@@ -34,31 +34,22 @@
 #include <stddef.h>
 
 #include <rte_jhash.h>
-#ifdef RTE_MACHINE_CPUFLAG_SSE4_2
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_I686)
 #include <rte_hash_crc.h>
-#endif /* RTE_MACHINE_CPUFLAG_SSE4_2 */
+#endif
 
 #include "ip_frag_common.h"
 
 #define	PRIME_VALUE	0xeaad8405
 
-#define	IP_FRAG_TBL_POS(tbl, sig)	\
-	((tbl)->pkt + ((sig) & (tbl)->entry_mask))
-
-#ifdef RTE_LIBRTE_IP_FRAG_TBL_STAT
-#define	IP_FRAG_TBL_STAT_UPDATE(s, f, v)	((s)->f += (v))
-#else
-#define	IP_FRAG_TBL_STAT_UPDATE(s, f, v)	do {} while (0)
-#endif /* IP_FRAG_TBL_STAT */
-
 /* local frag table helper functions */
 static inline void
 ip_frag_tbl_del(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 	struct ip_frag_pkt *fp)
 {
-	ip_frag_free(fp, dr);
+	tbl->nb_mbufs -= ip_frag_free(fp, dr);
 	ip_frag_key_invalidate(&fp->key);
-	TAILQ_REMOVE(&tbl->lru, fp, lru);
+	TAILQ_REMOVE(IP_FRAG_TBL_SLOT(tbl, fp->start), fp, lru);
 	tbl->use_entries--;
 	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, del_num, 1);
 }
@@ -69,7 +60,7 @@ ip_frag_tbl_add(struct rte_ip_frag_tbl *tbl,  struct ip_frag_pkt *fp,
 {
 	fp->key = key[0];
 	ip_frag_reset(fp, tms);
-	TAILQ_INSERT_TAIL(&tbl->lru, fp, lru);
+	TAILQ_INSERT_TAIL(IP_FRAG_TBL_SLOT(tbl, tms), fp, lru);
 	tbl->use_entries++;
 	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, add_num, 1);
 }
@@ -78,70 +69,100 @@ static inline void
 ip_frag_tbl_reuse(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 	struct ip_frag_pkt *fp, uint64_t tms)
 {
-	ip_frag_free(fp, dr);
+	tbl->nb_mbufs -= ip_frag_free(fp, dr);
+	TAILQ_REMOVE(IP_FRAG_TBL_SLOT(tbl, fp->start), fp, lru);
 	ip_frag_reset(fp, tms);
-	TAILQ_REMOVE(&tbl->lru, fp, lru);
-	TAILQ_INSERT_TAIL(&tbl->lru, fp, lru);
+	TAILQ_INSERT_TAIL(IP_FRAG_TBL_SLOT(tbl, tms), fp, lru);
 	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, reuse_num, 1);
 }
 
-
+/*
+ * CRC32 is used when the table was created on a CPU with SSE4.2 support,
+ * jhash otherwise, as software CRC32 is slower than jhash.
+ */
 static inline void
-ipv4_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
+ipv4_frag_hash(const struct rte_ip_frag_tbl *tbl, const struct ip_frag_key *key,
+	uint32_t *v1, uint32_t *v2)
 {
 	uint32_t v;
 	const uint32_t *p;
 
-	p = (const uint32_t *)&key->src_dst;
-
-#ifdef RTE_MACHINE_CPUFLAG_SSE4_2
-	v = rte_hash_crc_4byte(p[0], PRIME_VALUE);
-	v = rte_hash_crc_4byte(p[1], v);
-	v = rte_hash_crc_4byte(key->id, v);
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_I686)
+	if (likely(tbl->hash_crc != 0)) {
+		v = rte_hash_crc_8byte(key->src_dst[0], PRIME_VALUE);
+		v = rte_hash_crc_4byte(key->id, v);
+	} else
 #else
-
-	v = rte_jhash_3words(p[0], p[1], key->id, PRIME_VALUE);
-#endif /* RTE_MACHINE_CPUFLAG_SSE4_2 */
+	RTE_SET_USED(tbl);
+#endif
+	{
+		p = (const uint32_t *)&key->src_dst;
+		v = rte_jhash_3words(p[0], p[1], key->id, PRIME_VALUE);
+	}
 
 	*v1 =  v;
 	*v2 = (v << 7) + (v >> 14);
 }
 
 static inline void
-ipv6_frag_hash(const struct ip_frag_key *key, uint32_t *v1, uint32_t *v2)
+ipv6_frag_hash(const struct rte_ip_frag_tbl *tbl, const struct ip_frag_key *key,
+	uint32_t *v1, uint32_t *v2)
 {
 	uint32_t v;
 	const uint32_t *p;
 
-	p = (const uint32_t *) &key->src_dst;
-
-#ifdef RTE_MACHINE_CPUFLAG_SSE4_2
-	v = rte_hash_crc_4byte(p[0], PRIME_VALUE);
-	v = rte_hash_crc_4byte(p[1], v);
-	v = rte_hash_crc_4byte(p[2], v);
-	v = rte_hash_crc_4byte(p[3], v);
-	v = rte_hash_crc_4byte(p[4], v);
-	v = rte_hash_crc_4byte(p[5], v);
-	v = rte_hash_crc_4byte(p[6], v);
-	v = rte_hash_crc_4byte(p[7], v);
-	v = rte_hash_crc_4byte(key->id, v);
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_I686)
+	if (likely(tbl->hash_crc != 0)) {
+		v = rte_hash_crc_8byte(key->src_dst[0], PRIME_VALUE);
+		v = rte_hash_crc_8byte(key->src_dst[1], v);
+		v = rte_hash_crc_8byte(key->src_dst[2], v);
+		v = rte_hash_crc_8byte(key->src_dst[3], v);
+		v = rte_hash_crc_4byte(key->id, v);
+	} else
 #else
-
-	v = rte_jhash_3words(p[0], p[1], p[2], PRIME_VALUE);
-	v = rte_jhash_3words(p[3], p[4], p[5], v);
-	v = rte_jhash_3words(p[6], p[7], key->id, v);
-#endif /* RTE_MACHINE_CPUFLAG_SSE4_2 */
+	RTE_SET_USED(tbl);
+#endif
+	{
+		p = (const uint32_t *)&key->src_dst;
+		v = rte_jhash_3words(p[0], p[1], p[2], PRIME_VALUE);
+		v = rte_jhash_3words(p[3], p[4], p[5], v);
+		v = rte_jhash_3words(p[6], p[7], key->id, v);
+	}
 
 	*v1 =  v;
 	*v2 = (v << 7) + (v >> 14);
 }
 
+/* different hashing methods for IPv4 and IPv6 */
+static inline void
+ip_frag_key_hash(const struct rte_ip_frag_tbl *tbl,
+	const struct ip_frag_key *key, uint32_t *sig1, uint32_t *sig2)
+{
+	if (key->key_len == IPV4_KEYLEN)
+		ipv4_frag_hash(tbl, key, sig1, sig2);
+	else
+		ipv6_frag_hash(tbl, key, sig1, sig2);
+}
+
 struct rte_mbuf *
-ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
-	struct rte_mbuf *mb, uint16_t ofs, uint16_t len, uint16_t more_frags)
+ip_frag_process(struct rte_ip_frag_tbl *tbl, struct ip_frag_pkt *fp,
+	struct rte_ip_frag_death_row *dr, struct rte_mbuf *mb, uint16_t ofs,
+	uint16_t len, uint16_t more_frags)
 {
 	uint32_t idx;
 
+	/*
+	 * table is holding too many fragments: drop the whole packet,
+	 * so the memory it holds could be used by the others.
+	 */
+	if (unlikely(tbl->max_mbufs != 0 && tbl->nb_mbufs >= tbl->max_mbufs)) {
+		tbl->nb_mbufs -= ip_frag_free(fp, dr);
+		ip_frag_key_invalidate(&fp->key);
+		IP_FRAG_MBUF2DR(dr, mb);
+		IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, fail_limit, 1);
+		return (NULL);
+	}
+
 	fp->frag_size += len;
 
 	/* this is the first fragment. */
@@ -196,7 +217,7 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 				fp->frags[IP_LAST_FRAG_IDX].len);
 
 		/* free all fragments, invalidate the entry. */
-		ip_frag_free(fp, dr);
+		tbl->nb_mbufs -= ip_frag_free(fp, dr);
 		ip_frag_key_invalidate(&fp->key);
 		IP_FRAG_MBUF2DR(dr, mb);
 
@@ -206,6 +227,7 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 	fp->frags[idx].ofs = ofs;
 	fp->frags[idx].len = len;
 	fp->frags[idx].mb = mb;
+	tbl->nb_mbufs++;
 
 	mb = NULL;
 
@@ -254,7 +276,11 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
 				fp->frags[IP_LAST_FRAG_IDX].len);
 
 		/* free associated resources. */
-		ip_frag_free(fp, dr);
+		tbl->nb_mbufs -= ip_frag_free(fp, dr);
+
+	/* all fragments are chained into the reassembled packet. */
+	} else {
+		tbl->nb_mbufs -= fp->last_idx;
 	}
 
 	/* we are done with that entry, invalidate it. */
@@ -268,11 +294,12 @@ ip_frag_process(struct ip_frag_pkt *fp, struct rte_ip_frag_death_row *dr,
  * If such entry is not present, then allocate a new one.
  * If the entry is stale, then free and reuse it.
  */
-struct ip_frag_pkt *
-ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
-	const struct ip_frag_key *key, uint64_t tms)
+static inline struct ip_frag_pkt *
+ip_frag_find_sig(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
+	const struct ip_frag_key *key, uint32_t sig1, uint32_t sig2,
+	uint64_t tms)
 {
-	struct ip_frag_pkt *pkt, *free, *stale, *lru;
+	struct ip_frag_pkt *pkt, *free, *stale;
 	uint64_t max_cycles;
 
 	/*
@@ -285,7 +312,8 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 
 	IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, find_num, 1);
 
-	if ((pkt = ip_frag_lookup(tbl, key, tms, &free, &stale)) == NULL) {
+	if ((pkt = ip_frag_lookup(tbl, key, sig1, sig2, tms,
+			&free, &stale)) == NULL) {
 
 		/*timed-out entry, free and invalidate it*/
 		if (stale != NULL) {
@@ -298,15 +326,20 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 		 * check if we have a timed out entry to delete.
 		 */
 		} else if (free != NULL &&
-				tbl->max_entries <= tbl->use_entries) {
-			lru = TAILQ_FIRST(&tbl->lru);
-			if (max_cycles + lru->start < tms) {
-				ip_frag_tbl_del(tbl, dr, lru);
-			} else {
-				free = NULL;
-				IP_FRAG_TBL_STAT_UPDATE(&tbl->stat,
-					fail_nospace, 1);
-			}
+				tbl->max_entries <= tbl->use_entries &&
+				ip_frag_tbl_expire(tbl, dr, tms, 1) == 0) {
+			free = NULL;
+			IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, fail_nospace, 1);
+		}
+
+		/*
+		 * table holds too many fragments already,
+		 * don't start reassembly of new packets.
+		 */
+		if (free != NULL && tbl->admit_mbufs != 0 &&
+				tbl->nb_mbufs >= tbl->admit_mbufs) {
+			free = NULL;
+			IP_FRAG_TBL_STAT_UPDATE(&tbl->stat, fail_admit, 1);
 		}
 
 		/* found a free entry to reuse. */
@@ -317,8 +350,8 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 
 	/*
 	 * we found the flow, but it is already timed out,
-	 * so free associated resources, reposition it in the LRU list,
-	 * and reuse it.
+	 * so free associated resources, reposition it in the expiration
+	 * wheel, and reuse it.
 	 */
 	} else if (max_cycles + pkt->start < tms) {
 		ip_frag_tbl_reuse(tbl, dr, pkt, tms);
@@ -330,15 +363,25 @@ ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
 	return (pkt);
 }
 
+struct ip_frag_pkt *
+ip_frag_find(struct rte_ip_frag_tbl *tbl, struct rte_ip_frag_death_row *dr,
+	const struct ip_frag_key *key, uint64_t tms)
+{
+	uint32_t sig1, sig2;
+
+	ip_frag_key_hash(tbl, key, &sig1, &sig2);
+	return (ip_frag_find_sig(tbl, dr, key, sig1, sig2, tms));
+}
+
 struct ip_frag_pkt *
 ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
-	const struct ip_frag_key *key, uint64_t tms,
-	struct ip_frag_pkt **free, struct ip_frag_pkt **stale)
+	const struct ip_frag_key *key, uint32_t sig1, uint32_t sig2,
+	uint64_t tms, struct ip_frag_pkt **free, struct ip_frag_pkt **stale)
 {
 	struct ip_frag_pkt *p1, *p2;
 	struct ip_frag_pkt *empty, *old;
 	uint64_t max_cycles;
-	uint32_t i, assoc, sig1, sig2;
+	uint32_t i, assoc;
 
 	empty = NULL;
 	old = NULL;
@@ -349,12 +392,6 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 	if (tbl->last != NULL && ip_frag_key_cmp(key, &tbl->last->key) == 0)
 		return (tbl->last);
 
-	/* different hashing methods for IPv4 and IPv6 */
-	if (key->key_len == IPV4_KEYLEN)
-		ipv4_frag_hash(key, &sig1, &sig2);
-	else
-		ipv6_frag_hash(key, &sig1, &sig2);
-
 	p1 = IP_FRAG_TBL_POS(tbl, sig1);
 	p2 = IP_FRAG_TBL_POS(tbl, sig2);
 
@@ -416,3 +453,111 @@ ip_frag_lookup(struct rte_ip_frag_tbl *tbl,
 	*stale = old;
 	return (NULL);
 }
+
+/*
+ * Free stale entries from the slots the expiration wheel has passed,
+ * at most *budget* of them. Returns number of freed entries.
+ */
+uint32_t
+ip_frag_tbl_expire(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, uint64_t tms, uint32_t budget)
+{
+	struct ip_frag_pkt *fp, *next;
+	struct ip_pkt_list *slot;
+	uint64_t cur;
+	uint32_t n;
+
+	cur = tms >> tbl->wheel_shift;
+
+	/* nothing to expire, just move the wheel forward. */
+	if (tbl->use_entries == 0) {
+		tbl->wheel_tick = cur;
+		return (0);
+	}
+
+	/* wheel was idle for more than a turn, visit each slot only once. */
+	if (tbl->wheel_tick + tbl->wheel_span + IP_FRAG_TBL_WHEEL_SLOTS <= cur)
+		tbl->wheel_tick = cur - tbl->wheel_span -
+			IP_FRAG_TBL_WHEEL_SLOTS + 1;
+
+	n = 0;
+	while (tbl->wheel_tick + tbl->wheel_span <= cur) {
+
+		/*
+		 * slot could also contain entries added a whole number
+		 * of turns later, so check each entry's own timestamp.
+		 */
+		slot = tbl->wheel + (tbl->wheel_tick &
+			(IP_FRAG_TBL_WHEEL_SLOTS - 1));
+		for (fp = TAILQ_FIRST(slot); fp != NULL; fp = next) {
+			next = TAILQ_NEXT(fp, lru);
+			if (tbl->max_cycles + fp->start < tms) {
+				if (n == budget)
+					return (n);
+				ip_frag_tbl_del(tbl, dr, fp);
+				IP_FRAG_TBL_STAT_UPDATE(&tbl->stat,
+					expire_num, 1);
+				n++;
+			}
+		}
+		tbl->wheel_tick++;
+	}
+
+	return (n);
+}
+
+/*
+ * Process a burst of fragments: hash all the keys and prefetch
+ * the table buckets first, then find/add entries and collect
+ * the fragments, then expire as many stale entries as the death row allows.
+ */
+int
+ip_frag_reassemble_bulk(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, struct rte_mbuf **pkts_in,
+	struct ip_frag_desc *desc, uint16_t nb_pkts, uint64_t tms,
+	struct rte_mbuf **pkts_out)
+{
+	struct ip_frag_pkt *fp;
+	struct rte_mbuf *mb;
+	uint32_t i, k;
+
+	for (i = 0; i != nb_pkts; i++) {
+		if (desc[i].key.key_len == 0)
+			continue;
+		ip_frag_key_hash(tbl, &desc[i].key, &desc[i].sig1,
+			&desc[i].sig2);
+		rte_prefetch0(IP_FRAG_TBL_POS(tbl, desc[i].sig1));
+		rte_prefetch0(IP_FRAG_TBL_POS(tbl, desc[i].sig2));
+	}
+
+	k = 0;
+	for (i = 0; i != nb_pkts; i++) {
+
+		mb = pkts_in[i];
+
+		/* not a fragment, pass it through. */
+		if (desc[i].key.key_len == 0) {
+			pkts_out[k++] = mb;
+			continue;
+		}
+
+		fp = ip_frag_find_sig(tbl, dr, &desc[i].key, desc[i].sig1,
+			desc[i].sig2, tms);
+		if (fp == NULL) {
+			IP_FRAG_MBUF2DR(dr, mb);
+			continue;
+		}
+
+		mb = ip_frag_process(tbl, fp, dr, mb, desc[i].ofs,
+			desc[i].len, desc[i].more_frags);
+		ip_frag_inuse(tbl, fp);
+
+		if (mb != NULL)
+			pkts_out[k++] = mb;
+	}
+
+	ip_frag_tbl_expire(tbl, dr, tms,
+		(RTE_DIM(dr->row) - dr->cnt) / IP_MAX_FRAG_NUM);
+
+	return (k);
+}
@@ -81,7 +81,7 @@ struct ip_frag_key {
  * First two entries in the frags[] array are for the last and first fragments.
  */
 struct ip_frag_pkt {
-	TAILQ_ENTRY(ip_frag_pkt) lru;   /**< LRU list */
+	TAILQ_ENTRY(ip_frag_pkt) lru;   /**< expiration wheel slot list */
 	struct ip_frag_key key;           /**< fragmentation key */
 	uint64_t             start;       /**< creation timestamp */
 	uint32_t             total_size;  /**< expected reassembled size */
@@ -101,6 +101,14 @@ struct rte_ip_frag_death_row {
 
 TAILQ_HEAD(ip_pkt_list, ip_frag_pkt); /**< @internal fragments tailq */
 
+/**
+ * @internal Number of slots in the table expiration wheel.
+ * Each slot covers 1/(IP_FRAG_TBL_WHEEL_SLOTS - 2) of max_cycles
+ * (rounded up to a power of two), so every entry in a slot that
+ * the wheel has fallen behind by a full turn is guaranteed to be stale.
+ */
+#define IP_FRAG_TBL_WHEEL_SLOTS 64
+
 /** fragmentation table statistics */
 struct ip_frag_tbl_stat {
 	uint64_t find_num;      /**< total # of find/insert attempts. */
@@ -109,6 +117,9 @@ struct ip_frag_tbl_stat {
 	uint64_t reuse_num;     /**< # of reuse (del/add) ops. */
 	uint64_t fail_total;    /**< total # of add failures. */
 	uint64_t fail_nospace;  /**< # of 'no space' add failures. */
+	uint64_t fail_admit;    /**< # of add failures due to admission control. */
+	uint64_t fail_limit;    /**< # of packets dropped by the mbuf limit. */
+	uint64_t expire_num;    /**< # of entries freed by the expiration wheel. */
 } __rte_cache_aligned;
 
 /** fragmentation table */
@@ -120,12 +131,26 @@ struct rte_ip_frag_tbl {
 	uint32_t             bucket_entries;  /**< hash assocaitivity. */
 	uint32_t             nb_entries;      /**< total size of the table. */
 	uint32_t             nb_buckets;      /**< num of associativity lines. */
+	uint32_t             nb_mbufs;        /**< fragments held by the table. */
+	uint32_t             max_mbufs;       /**< max fragments held (0 - no limit). */
+	uint32_t             admit_mbufs;     /**< new packets admission threshold. */
+	uint32_t             hash_crc;        /**< use CRC32 for key hashing. */
+	uint32_t             wheel_shift;     /**< log2 of wheel slot cycles. */
+	uint32_t             wheel_span;      /**< ticks after which entries are stale. */
+	uint64_t             wheel_tick;      /**< next wheel tick to expire. */
 	struct ip_frag_pkt *last;         /**< last used entry. */
-	struct ip_pkt_list lru;           /**< LRU list for table entries. */
+	struct ip_pkt_list wheel[IP_FRAG_TBL_WHEEL_SLOTS];
+	/**< expiration wheel for table entries. */
 	struct ip_frag_tbl_stat stat;     /**< statistics counters. */
 	struct ip_frag_pkt pkt[0];        /**< hash table. */
 };
 
+/**
+ * Fragmentation flag: leave IPv4 header checksum of the fragments to the NIC
+ * (PKT_TX_IP_CKSUM), instead of computing it in software.
+ */
+#define RTE_IP_FRAG_F_HW_CKSUM  (1 << 0)
+
 /** IPv6 fragment extension header */
 struct ipv6_extension_fragment {
 	uint8_t next_header;            /**< Next header type */
@@ -168,6 +193,29 @@ struct rte_ip_frag_tbl * rte_ip_frag_table_create(uint32_t bucket_num,
 		uint32_t bucket_entries,  uint32_t max_entries,
 		uint64_t max_cycles, int socket_id);
 
+/**
+ * Limit the number of fragments held by an IP fragmentation table.
+ *
+ * Once the table holds *admit_mbufs* fragments, fragments that would start
+ * a new packet are dropped, while fragments of packets already in the table
+ * are still accepted, so partially received packets get a chance to complete.
+ * A fragment that would push the table beyond *max_mbufs* is dropped together
+ * with all previously received fragments of its packet.
+ *
+ * @param tbl
+ *   Fragmentation table to configure.
+ * @param max_mbufs
+ *   Maximum number of fragments held by the table, 0 means no limit.
+ * @param admit_mbufs
+ *   Number of held fragments above which new packets are not admitted,
+ *   0 means no admission control. Should not exceed *max_mbufs*.
+ * @return
+ *   - 0 on success.
+ *   - -EINVAL if the parameters are invalid.
+ */
+int rte_ip_frag_table_set_mbuf_limit(struct rte_ip_frag_tbl *tbl,
+		uint32_t max_mbufs, uint32_t admit_mbufs);
+
 /*
  * Free allocated IP fragmentation table.
  *
@@ -209,6 +257,44 @@ rte_ipv6_fragment_packet(struct rte_mbuf *pkt_in,
 		struct rte_mempool *pool_direct,
 		struct rte_mempool *pool_indirect);
 
+/**
+ * IPv6 fragmentation of a burst of packets.
+ *
+ * Fragments share the payload of the input packet by reference
+ * (indirect mbufs), only the IPv6 and fragment headers are written into
+ * a direct mbuf per fragment, from a template built once per packet.
+ * Packets that fit into the MTU are passed to *pkts_out* unchanged.
+ * Fragmented packets are freed: their data is released when
+ * all fragments are freed.
+ *
+ * @param pkts_in
+ *   Array of input packets, with data pointing to the IPv6 header.
+ * @param nb_pkts_in
+ *   Number of packets in *pkts_in*.
+ * @param pkts_out
+ *   Array storing the output packets and fragments.
+ * @param nb_pkts_out
+ *   Size of *pkts_out* on input,
+ *   number of packets placed in *pkts_out* on output.
+ * @param mtu_size
+ *   Size in bytes of the Maximum Transfer Unit (MTU) for the outgoing IPv6
+ *   datagrams. This value includes the size of the IPv6 header.
+ * @param pool_direct
+ *   MBUF pool used for allocating direct buffers for the output fragments.
+ * @param pool_indirect
+ *   MBUF pool used for allocating indirect buffers for the output fragments.
+ * @return
+ *   Number of input packets processed. If it is less than *nb_pkts_in*,
+ *   packet pkts_in[ret] is left to the caller and rte_errno is set to:
+ *   - ENOSPC if *pkts_out* has no room for all of its fragments.
+ *   - ENOMEM if mbufs could not be allocated.
+ *   - EINVAL if *mtu_size* is too small.
+ */
+int rte_ipv6_fragment_bulk(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+		struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out,
+		uint16_t mtu_size, struct rte_mempool *pool_direct,
+		struct rte_mempool *pool_indirect);
+
 /*
  * This function implements reassembly of fragmented IPv6 packets.
  * Incoming mbuf should have its l2_len/l3_len fields setup correctly.
@@ -235,6 +321,39 @@ struct rte_mbuf *rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		struct rte_mbuf *mb, uint64_t tms, struct ipv6_hdr *ip_hdr,
 		struct ipv6_extension_fragment *frag_hdr);
 
+/**
+ * Reassemble a burst of IPv6 packets.
+ *
+ * Fragment keys of the whole burst are hashed and the table buckets are
+ * prefetched before any fragment is processed, then stale table entries are
+ * expired, with as much work as the room left on the death row allows.
+ * Incoming mbufs should have their l2_len/l3_len fields setup correctly,
+ * with l3_len covering the IPv6 header and the fragment extension header.
+ * Non-fragmented packets are passed to *pkts_out* unchanged.
+ *
+ * @param tbl
+ *   Table where to lookup/add the fragmented packets.
+ * @param dr
+ *   Death row to free buffers to. It should have room for at least
+ *   nb_pkts * (RTE_LIBRTE_IP_FRAG_MAX_FRAG + 1) mbufs.
+ * @param pkts_in
+ *   Array of incoming IPv6 packets.
+ * @param nb_pkts
+ *   Number of packets in *pkts_in*, at most IP_FRAG_DEATH_ROW_LEN.
+ * @param tms
+ *   Arrival timestamp of the burst.
+ * @param pkts_out
+ *   Array to store reassembled and non-fragmented packets to.
+ *   It should have room for *nb_pkts* entries.
+ * @return
+ *   - Number of packets stored in *pkts_out*.
+ *   - -EINVAL if *nb_pkts* is too big.
+ *   - -ENOSPC if the death row does not have enough room.
+ */
+int rte_ipv6_frag_reassemble_bulk(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct rte_mbuf **pkts_in,
+		uint16_t nb_pkts, uint64_t tms, struct rte_mbuf **pkts_out);
+
 /*
  * Return a pointer to the packet's fragment header, if found.
  * It only looks at the extension header that's right after the fixed IPv6
@@ -285,6 +404,49 @@ int32_t rte_ipv4_fragment_packet(struct rte_mbuf *pkt_in,
 			struct rte_mempool *pool_direct,
 			struct rte_mempool *pool_indirect);
 
+/**
+ * IPv4 fragmentation of a burst of packets.
+ *
+ * Fragments share the payload of the input packet by reference
+ * (indirect mbufs), only the IPv4 header is written into a direct mbuf
+ * per fragment, from a template built once per packet. The header checksum
+ * is updated incrementally from the template one, or left to the NIC
+ * if RTE_IP_FRAG_F_HW_CKSUM is set.
+ * Packets that fit into the MTU are passed to *pkts_out* unchanged.
+ * Fragmented packets are freed: their data is released when
+ * all fragments are freed.
+ *
+ * @param pkts_in
+ *   Array of input packets, with data pointing to the IPv4 header.
+ * @param nb_pkts_in
+ *   Number of packets in *pkts_in*.
+ * @param pkts_out
+ *   Array storing the output packets and fragments.
+ * @param nb_pkts_out
+ *   Size of *pkts_out* on input,
+ *   number of packets placed in *pkts_out* on output.
+ * @param mtu_size
+ *   Size in bytes of the Maximum Transfer Unit (MTU) for the outgoing IPv4
+ *   datagrams. This value includes the size of the IPv4 header.
+ * @param pool_direct
+ *   MBUF pool used for allocating direct buffers for the output fragments.
+ * @param pool_indirect
+ *   MBUF pool used for allocating indirect buffers for the output fragments.
+ * @param flags
+ *   0 or RTE_IP_FRAG_F_HW_CKSUM.
+ * @return
+ *   Number of input packets processed. If it is less than *nb_pkts_in*,
+ *   packet pkts_in[ret] is left to the caller and rte_errno is set to:
+ *   - ENOTSUP if the packet has the Don't Fragment flag set.
+ *   - ENOSPC if *pkts_out* has no room for all of its fragments.
+ *   - ENOMEM if mbufs could not be allocated.
+ *   - EINVAL if *mtu_size* is too small.
+ */
+int rte_ipv4_fragment_bulk(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+		struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out,
+		uint16_t mtu_size, struct rte_mempool *pool_direct,
+		struct rte_mempool *pool_indirect, uint32_t flags);
+
 /*
  * This function implements reassembly of fragmented IPv4 packets.
  * Incoming mbufs should have its l2_len/l3_len fields setup correclty.
@@ -308,6 +470,38 @@ struct rte_mbuf * rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 		struct rte_ip_frag_death_row *dr,
 		struct rte_mbuf *mb, uint64_t tms, struct ipv4_hdr *ip_hdr);
 
+/**
+ * Reassemble a burst of IPv4 packets.
+ *
+ * Fragment keys of the whole burst are hashed and the table buckets are
+ * prefetched before any fragment is processed, then stale table entries are
+ * expired, with as much work as the room left on the death row allows.
+ * Incoming mbufs should have their l2_len/l3_len fields setup correctly.
+ * Non-fragmented packets are passed to *pkts_out* unchanged.
+ *
+ * @param tbl
+ *   Table where to lookup/add the fragmented packets.
+ * @param dr
+ *   Death row to free buffers to. It should have room for at least
+ *   nb_pkts * (RTE_LIBRTE_IP_FRAG_MAX_FRAG + 1) mbufs.
+ * @param pkts_in
+ *   Array of incoming IPv4 packets.
+ * @param nb_pkts
+ *   Number of packets in *pkts_in*, at most IP_FRAG_DEATH_ROW_LEN.
+ * @param tms
+ *   Arrival timestamp of the burst.
+ * @param pkts_out
+ *   Array to store reassembled and non-fragmented packets to.
+ *   It should have room for *nb_pkts* entries.
+ * @return
+ *   - Number of packets stored in *pkts_out*.
+ *   - -EINVAL if *nb_pkts* is too big.
+ *   - -ENOSPC if the death row does not have enough room.
+ */
+int rte_ipv4_frag_reassemble_bulk(struct rte_ip_frag_tbl *tbl,
+		struct rte_ip_frag_death_row *dr, struct rte_mbuf **pkts_in,
+		uint16_t nb_pkts, uint64_t tms, struct rte_mbuf **pkts_out);
+
 /*
  * Check if the IPv4 packet is fragmented
  *
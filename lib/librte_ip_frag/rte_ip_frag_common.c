@@ -36,6 +36,7 @@
 
 #include <rte_memory.h>
 #include <rte_log.h>
+#include <rte_cpuflags.h>
 
 #include "ip_frag_common.h"
 
@@ -72,7 +73,8 @@ rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 {
 	struct rte_ip_frag_tbl *tbl;
 	size_t sz;
-	uint64_t nb_entries;
+	uint64_t nb_entries, slot_cycles;
+	uint32_t i;
 
 	nb_entries = rte_align32pow2(bucket_num);
 	nb_entries *= bucket_entries;
@@ -105,35 +107,71 @@ rte_ip_frag_table_create(uint32_t bucket_num, uint32_t bucket_entries,
 	tbl->bucket_entries = bucket_entries;
 	tbl->entry_mask = (tbl->nb_entries - 1) & ~(tbl->bucket_entries  - 1);
 
-	TAILQ_INIT(&(tbl->lru));
+	/*
+	 * make wheel slots long enough for an entry to become stale
+	 * before the wheel makes a full turn.
+	 */
+	slot_cycles = max_cycles / (IP_FRAG_TBL_WHEEL_SLOTS - 2) + 1;
+	while ((UINT64_C(1) << tbl->wheel_shift) < slot_cycles)
+		tbl->wheel_shift++;
+	tbl->wheel_span = (uint32_t)(max_cycles >> tbl->wheel_shift) + 2;
+	for (i = 0; i != RTE_DIM(tbl->wheel); i++)
+		TAILQ_INIT(tbl->wheel + i);
+
+#if defined(RTE_ARCH_X86_64) || defined(RTE_ARCH_I686)
+	tbl->hash_crc = (rte_cpu_get_flag_enabled(RTE_CPUFLAG_SSE4_2) > 0);
+#endif
+
 	return (tbl);
 }
 
+/* limit number of mbufs held by the table */
+int
+rte_ip_frag_table_set_mbuf_limit(struct rte_ip_frag_tbl *tbl,
+	uint32_t max_mbufs, uint32_t admit_mbufs)
+{
+	if (tbl == NULL || (max_mbufs != 0 && admit_mbufs > max_mbufs))
+		return (-EINVAL);
+
+	tbl->max_mbufs = max_mbufs;
+	tbl->admit_mbufs = admit_mbufs;
+	return (0);
+}
+
 /* dump frag table statistics to file */
 void
 rte_ip_frag_table_statistics_dump(FILE *f, const struct rte_ip_frag_tbl *tbl)
 {
-	uint64_t fail_total, fail_nospace;
+	uint64_t fail_total, fail_nospace, fail_admit;
 
 	fail_total = tbl->stat.fail_total;
 	fail_nospace = tbl->stat.fail_nospace;
+	fail_admit = tbl->stat.fail_admit;
 
 	fprintf(f, "max entries:\t%u;\n"
 		"entries in use:\t%u;\n"
+		"mbufs in use:\t%u;\n"
 		"finds/inserts:\t%" PRIu64 ";\n"
 		"entries added:\t%" PRIu64 ";\n"
 		"entries deleted by timeout:\t%" PRIu64 ";\n"
+		"entries expired by wheel:\t%" PRIu64 ";\n"
 		"entries reused by timeout:\t%" PRIu64 ";\n"
 		"total add failures:\t%" PRIu64 ";\n"
 		"add no-space failures:\t%" PRIu64 ";\n"
-		"add hash-collisions failures:\t%" PRIu64 ";\n",
+		"add admission failures:\t%" PRIu64 ";\n"
+		"add hash-collisions failures:\t%" PRIu64 ";\n"
+		"mbuf limit drops:\t%" PRIu64 ";\n",
 		tbl->max_entries,
 		tbl->use_entries,
+		tbl->nb_mbufs,
 		tbl->stat.find_num,
 		tbl->stat.add_num,
 		tbl->stat.del_num,
+		tbl->stat.expire_num,
 		tbl->stat.reuse_num,
 		fail_total,
 		fail_nospace,
-		fail_total - fail_nospace);
+		fail_admit,
+		fail_total - fail_nospace - fail_admit,
+		tbl->stat.fail_limit);
 }
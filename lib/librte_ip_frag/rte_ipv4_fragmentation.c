@@ -37,6 +37,7 @@
 #include <rte_memcpy.h>
 #include <rte_mempool.h>
 #include <rte_debug.h>
+#include <rte_errno.h>
 
 #include "ip_frag_common.h"
 
@@ -50,16 +51,49 @@
 
 #define	IPV4_HDR_FO_MASK			((1 << IPV4_HDR_FO_SHIFT) - 1)
 
-static inline void __fill_ipv4hdr_frag(struct ipv4_hdr *dst,
-		const struct ipv4_hdr *src, uint16_t len, uint16_t fofs,
-		uint16_t dofs, uint32_t mf)
+/*
+ * Header template, built once per packet: only total length, fragment
+ * offset and checksum differ between the fragments.
+ */
+struct ipv4_frag_tmpl {
+	struct ipv4_hdr hdr;     /* header with zero length, offset and cksum */
+	uint32_t cksum;          /* raw checksum of the header */
+	uint16_t flag_offset;    /* flags and offset of the input packet */
+};
+
+static inline void
+__init_ipv4hdr_tmpl(struct ipv4_frag_tmpl *tmpl,
+		const struct ipv4_hdr *src, uint16_t flag_offset)
+{
+	tmpl->hdr = *src;
+	tmpl->hdr.total_length = 0;
+	tmpl->hdr.fragment_offset = 0;
+	tmpl->hdr.hdr_checksum = 0;
+	tmpl->cksum = __rte_raw_cksum(&tmpl->hdr, sizeof(tmpl->hdr), 0);
+	tmpl->flag_offset = flag_offset;
+}
+
+static inline void
+__fill_ipv4hdr_frag(struct ipv4_hdr *dst,
+		const struct ipv4_frag_tmpl *tmpl, uint16_t len,
+		uint16_t dofs, uint32_t mf, uint32_t flags)
 {
-	rte_memcpy(dst, src, sizeof(*dst));
-	fofs = (uint16_t)(fofs + (dofs >> IPV4_HDR_FO_SHIFT));
+	uint32_t sum;
+	uint16_t fofs, cksum;
+
+	fofs = (uint16_t)(tmpl->flag_offset + (dofs >> IPV4_HDR_FO_SHIFT));
 	fofs = (uint16_t)(fofs | mf << IPV4_HDR_MF_SHIFT);
+
+	*dst = tmpl->hdr;
 	dst->fragment_offset = rte_cpu_to_be_16(fofs);
 	dst->total_length = rte_cpu_to_be_16(len);
-	dst->hdr_checksum = 0;
+
+	/* update checksum of the template with the new fields. */
+	if ((flags & RTE_IP_FRAG_F_HW_CKSUM) == 0) {
+		sum = tmpl->cksum + dst->fragment_offset + dst->total_length;
+		cksum = __rte_raw_cksum_reduce(sum);
+		dst->hdr_checksum = (cksum == 0xffff) ? cksum : ~cksum;
+	}
 }
 
 static inline void __free_fragments(struct rte_mbuf *mb[], uint32_t num)
@@ -69,6 +103,84 @@ static inline void __free_fragments(struct rte_mbuf *mb[], uint32_t num)
 		rte_pktmbuf_free(mb[i]);
 }
 
+static inline int32_t
+ipv4_fragment_packet(struct rte_mbuf *pkt_in,
+	struct rte_mbuf **pkts_out,
+	uint16_t nb_pkts_out,
+	uint16_t mtu_size,
+	struct rte_mempool *pool_direct,
+	struct rte_mempool *pool_indirect,
+	uint32_t flags)
+{
+	struct rte_mbuf *in_seg, *out_pkt;
+	struct ipv4_hdr *in_hdr, *out_hdr;
+	struct ipv4_frag_tmpl tmpl;
+	uint32_t i, nb_frags, in_seg_data_pos, len, payload;
+	uint16_t fragment_offset, flag_offset, frag_size;
+	int ret;
+
+	/* Fragment size should be a multiply of 8. */
+	frag_size = (uint16_t)((mtu_size - sizeof(struct ipv4_hdr)) &
+		~IPV4_HDR_FO_MASK);
+
+	in_hdr = rte_pktmbuf_mtod(pkt_in, struct ipv4_hdr *);
+	flag_offset = rte_cpu_to_be_16(in_hdr->fragment_offset);
+
+	/* If Don't Fragment flag is set */
+	if (unlikely ((flag_offset & IPV4_HDR_DF_MASK) != 0))
+		return -ENOTSUP;
+
+	/* Check that pkts_out is big enough to hold all fragments */
+	payload = pkt_in->pkt_len - sizeof(struct ipv4_hdr);
+	if (unlikely(mtu_size <= sizeof(struct ipv4_hdr) || frag_size == 0))
+		return -EINVAL;
+	nb_frags = (payload + frag_size - 1) / frag_size;
+	if (unlikely(nb_frags > nb_pkts_out))
+		return -ENOSPC;
+
+	if (unlikely(ip_frag_alloc_direct(pool_direct, pkts_out,
+			nb_frags) != 0))
+		return -ENOMEM;
+
+	__init_ipv4hdr_tmpl(&tmpl, in_hdr, flag_offset);
+
+	in_seg = pkt_in;
+	in_seg_data_pos = sizeof(struct ipv4_hdr);
+	fragment_offset = 0;
+
+	for (i = 0; i != nb_frags; i++) {
+
+		out_pkt = pkts_out[i];
+		len = RTE_MIN((uint32_t)frag_size, payload - fragment_offset);
+
+		/* Reserve space for the IP header that will be built later */
+		out_pkt->data_len = sizeof(struct ipv4_hdr);
+		out_pkt->pkt_len = sizeof(struct ipv4_hdr);
+
+		/* Share payload of the input packet by reference */
+		ret = ip_frag_attach_payload(out_pkt, &in_seg,
+			&in_seg_data_pos, len, pool_indirect);
+		if (unlikely(ret != 0)) {
+			__free_fragments(pkts_out, nb_frags);
+			return ret;
+		}
+
+		/* Build the IP header */
+		out_hdr = rte_pktmbuf_mtod(out_pkt, struct ipv4_hdr *);
+		__fill_ipv4hdr_frag(out_hdr, &tmpl,
+		    (uint16_t)out_pkt->pkt_len,
+		    fragment_offset, i + 1 != nb_frags, flags);
+
+		fragment_offset = (uint16_t)(fragment_offset + len);
+
+		if ((flags & RTE_IP_FRAG_F_HW_CKSUM) != 0)
+			out_pkt->ol_flags |= PKT_TX_IP_CKSUM | PKT_TX_IPV4;
+		out_pkt->l3_len = sizeof(struct ipv4_hdr);
+	}
+
+	return nb_frags;
+}
+
 /**
  * IPv4 fragmentation.
  *
@@ -98,112 +210,57 @@ rte_ipv4_fragment_packet(struct rte_mbuf *pkt_in,
 	struct rte_mempool *pool_direct,
 	struct rte_mempool *pool_indirect)
 {
-	struct rte_mbuf *in_seg = NULL;
-	struct ipv4_hdr *in_hdr;
-	uint32_t out_pkt_pos, in_seg_data_pos;
-	uint32_t more_in_segs;
-	uint16_t fragment_offset, flag_offset, frag_size;
-
-	frag_size = (uint16_t)(mtu_size - sizeof(struct ipv4_hdr));
+	int32_t ret;
 
 	/* Fragment size should be a multiply of 8. */
-	IP_FRAG_ASSERT((frag_size & IPV4_HDR_FO_MASK) == 0);
-
-	in_hdr = rte_pktmbuf_mtod(pkt_in, struct ipv4_hdr *);
-	flag_offset = rte_cpu_to_be_16(in_hdr->fragment_offset);
-
-	/* If Don't Fragment flag is set */
-	if (unlikely ((flag_offset & IPV4_HDR_DF_MASK) != 0))
-		return -ENOTSUP;
+	IP_FRAG_ASSERT(((mtu_size - sizeof(struct ipv4_hdr)) &
+		IPV4_HDR_FO_MASK) == 0);
 
-	/* Check that pkts_out is big enough to hold all fragments */
-	if (unlikely(frag_size * nb_pkts_out <
-	    (uint16_t)(pkt_in->pkt_len - sizeof (struct ipv4_hdr))))
-		return -EINVAL;
+	ret = ipv4_fragment_packet(pkt_in, pkts_out, nb_pkts_out, mtu_size,
+		pool_direct, pool_indirect, RTE_IP_FRAG_F_HW_CKSUM);
 
-	in_seg = pkt_in;
-	in_seg_data_pos = sizeof(struct ipv4_hdr);
-	out_pkt_pos = 0;
-	fragment_offset = 0;
+	/* pkts_out is not big enough to hold all fragments */
+	return (ret == -ENOSPC) ? -EINVAL : ret;
+}
 
-	more_in_segs = 1;
-	while (likely(more_in_segs)) {
-		struct rte_mbuf *out_pkt = NULL, *out_seg_prev = NULL;
-		uint32_t more_out_segs;
-		struct ipv4_hdr *out_hdr;
-
-		/* Allocate direct buffer */
-		out_pkt = rte_pktmbuf_alloc(pool_direct);
-		if (unlikely(out_pkt == NULL)) {
-			__free_fragments(pkts_out, out_pkt_pos);
-			return -ENOMEM;
-		}
+/*
+ * IPv4 fragmentation of a burst of packets.
+ * Packets that fit into the MTU are passed through,
+ * fragmented packets are freed (fragments keep references to their data).
+ */
+int
+rte_ipv4_fragment_bulk(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+	struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out, uint16_t mtu_size,
+	struct rte_mempool *pool_direct, struct rte_mempool *pool_indirect,
+	uint32_t flags)
+{
+	uint32_t i, k;
+	int32_t ret;
 
-		/* Reserve space for the IP header that will be built later */
-		out_pkt->data_len = sizeof(struct ipv4_hdr);
-		out_pkt->pkt_len = sizeof(struct ipv4_hdr);
+	k = 0;
+	for (i = 0; i != nb_pkts_in; i++) {
 
-		out_seg_prev = out_pkt;
-		more_out_segs = 1;
-		while (likely(more_out_segs && more_in_segs)) {
-			struct rte_mbuf *out_seg = NULL;
-			uint32_t len;
-
-			/* Allocate indirect buffer */
-			out_seg = rte_pktmbuf_alloc(pool_indirect);
-			if (unlikely(out_seg == NULL)) {
-				rte_pktmbuf_free(out_pkt);
-				__free_fragments(pkts_out, out_pkt_pos);
-				return -ENOMEM;
-			}
-			out_seg_prev->next = out_seg;
-			out_seg_prev = out_seg;
-
-			/* Prepare indirect buffer */
-			rte_pktmbuf_attach(out_seg, in_seg);
-			len = mtu_size - out_pkt->pkt_len;
-			if (len > (in_seg->data_len - in_seg_data_pos)) {
-				len = in_seg->data_len - in_seg_data_pos;
-			}
-			out_seg->data_off = in_seg->data_off + in_seg_data_pos;
-			out_seg->data_len = (uint16_t)len;
-			out_pkt->pkt_len = (uint16_t)(len +
-			    out_pkt->pkt_len);
-			out_pkt->nb_segs += 1;
-			in_seg_data_pos += len;
-
-			/* Current output packet (i.e. fragment) done ? */
-			if (unlikely(out_pkt->pkt_len >= mtu_size))
-				more_out_segs = 0;
-
-			/* Current input segment done ? */
-			if (unlikely(in_seg_data_pos == in_seg->data_len)) {
-				in_seg = in_seg->next;
-				in_seg_data_pos = 0;
-
-				if (unlikely(in_seg == NULL))
-					more_in_segs = 0;
+		if (pkts_in[i]->pkt_len <= mtu_size) {
+			if (unlikely(k == *nb_pkts_out)) {
+				rte_errno = ENOSPC;
+				break;
 			}
+			pkts_out[k++] = pkts_in[i];
+			continue;
 		}
 
-		/* Build the IP header */
-
-		out_hdr = rte_pktmbuf_mtod(out_pkt, struct ipv4_hdr *);
-
-		__fill_ipv4hdr_frag(out_hdr, in_hdr,
-		    (uint16_t)out_pkt->pkt_len,
-		    flag_offset, fragment_offset, more_in_segs);
-
-		fragment_offset = (uint16_t)(fragment_offset +
-		    out_pkt->pkt_len - sizeof(struct ipv4_hdr));
-
-		out_pkt->ol_flags |= PKT_TX_IP_CKSUM;
-		out_pkt->l3_len = sizeof(struct ipv4_hdr);
+		ret = ipv4_fragment_packet(pkts_in[i], pkts_out + k,
+			(uint16_t)(*nb_pkts_out - k), mtu_size,
+			pool_direct, pool_indirect, flags);
+		if (unlikely(ret < 0)) {
+			rte_errno = -ret;
+			break;
+		}
 
-		/* Write the fragment to the output list */
-		pkts_out[out_pkt_pos] = out_pkt;
-		out_pkt_pos ++;
+		rte_pktmbuf_free(pkts_in[i]);
+		k += ret;
 	}
 
-	return out_pkt_pos;
+	*nb_pkts_out = (uint16_t)k;
+	return i;
 }
@@ -32,6 +32,7 @@
  */
 
 #include <stddef.h>
+#include <string.h>
 
 #include <rte_debug.h>
 
@@ -165,7 +166,7 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 
 	/* process the fragmented packet. */
-	mb = ip_frag_process(fp, dr, mb, ip_ofs, ip_len, ip_flag);
+	mb = ip_frag_process(tbl, fp, dr, mb, ip_ofs, ip_len, ip_flag);
 	ip_frag_inuse(tbl, fp);
 
 	IP_FRAG_LOG(DEBUG, "%s:%d:\n"
@@ -180,3 +181,54 @@ rte_ipv4_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 	return (mb);
 }
+
+/*
+ * Process a burst of IPV4 packets.
+ * Incoming mbufs should have their l2_len/l3_len fields setup correctly.
+ */
+int
+rte_ipv4_frag_reassemble_bulk(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, struct rte_mbuf **pkts_in,
+	uint16_t nb_pkts, uint64_t tms, struct rte_mbuf **pkts_out)
+{
+	struct ip_frag_desc desc[IP_FRAG_DEATH_ROW_LEN];
+	struct ipv4_hdr *ip_hdr;
+	uint32_t addr[2];
+	uint16_t flag_offset, ip_ofs, ip_flag;
+	uint32_t i;
+	int ret;
+
+	if ((ret = ip_frag_bulk_check(dr, nb_pkts)) != 0)
+		return (ret);
+
+	for (i = 0; i != nb_pkts; i++) {
+
+		ip_hdr = (struct ipv4_hdr *)(rte_pktmbuf_mtod(pkts_in[i],
+			uint8_t *) + pkts_in[i]->l2_len);
+
+		flag_offset = rte_be_to_cpu_16(ip_hdr->fragment_offset);
+		ip_ofs = (uint16_t)(flag_offset & IPV4_HDR_OFFSET_MASK);
+		ip_flag = (uint16_t)(flag_offset & IPV4_HDR_MF_FLAG);
+
+		if (ip_ofs == 0 && ip_flag == 0) {
+			desc[i].key.key_len = 0;
+			continue;
+		}
+
+		/* same key as rte_ipv4_frag_reassemble_packet(), read field
+		 * by field as the header may be unaligned */
+		addr[0] = ip_hdr->src_addr;
+		addr[1] = ip_hdr->dst_addr;
+		memcpy(&desc[i].key.src_dst[0], addr, sizeof(addr));
+		desc[i].key.id = ip_hdr->packet_id;
+		desc[i].key.key_len = IPV4_KEYLEN;
+
+		desc[i].ofs = (uint16_t)(ip_ofs * IPV4_HDR_OFFSET_UNITS);
+		desc[i].len = (uint16_t)(rte_be_to_cpu_16(
+			ip_hdr->total_length) - pkts_in[i]->l3_len);
+		desc[i].more_frags = ip_flag;
+	}
+
+	return (ip_frag_reassemble_bulk(tbl, dr, pkts_in, desc, nb_pkts, tms,
+		pkts_out));
+}
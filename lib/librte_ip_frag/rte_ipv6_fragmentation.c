@@ -35,6 +35,7 @@
 #include <errno.h>
 
 #include <rte_memcpy.h>
+#include <rte_errno.h>
 
 #include "ip_frag_common.h"
 
@@ -52,24 +53,39 @@
 #define	IPV6_HDR_MF_MASK			(1 << IPV6_HDR_MF_SHIFT)
 #define	IPV6_HDR_FO_MASK			((1 << IPV6_HDR_FO_SHIFT) - 1)
 
+/*
+ * Header template, built once per packet: only payload length and
+ * fragment offset/flag differ between the fragments.
+ */
+struct ipv6_frag_tmpl {
+	struct ipv6_hdr hdr;                   /* IPv6 header */
+	struct ipv6_extension_fragment fh;     /* fragment extension header */
+} __attribute__((__packed__));
+
+static inline void
+__init_ipv6hdr_tmpl(struct ipv6_frag_tmpl *tmpl, const struct ipv6_hdr *src)
+{
+	tmpl->hdr = *src;
+	tmpl->hdr.payload_len = 0;
+	tmpl->hdr.proto = IPPROTO_FRAGMENT;
+
+	tmpl->fh.next_header = src->proto;
+	tmpl->fh.reserved1 = 0;
+	tmpl->fh.frag_data = 0;
+	tmpl->fh.id = 0;
+}
+
 static inline void
-__fill_ipv6hdr_frag(struct ipv6_hdr *dst,
-		const struct ipv6_hdr *src, uint16_t len, uint16_t fofs,
+__fill_ipv6hdr_frag(struct ipv6_frag_tmpl *dst,
+		const struct ipv6_frag_tmpl *tmpl, uint16_t len, uint16_t fofs,
 		uint32_t mf)
 {
-	struct ipv6_extension_fragment *fh;
-
-	rte_memcpy(dst, src, sizeof(*dst));
-	dst->payload_len = rte_cpu_to_be_16(len);
-	dst->proto = IPPROTO_FRAGMENT;
-
-	fh = (struct ipv6_extension_fragment *) ++dst;
-	fh->next_header = src->proto;
-	fh->reserved1   = 0;
-	fh->frag_offset = rte_cpu_to_be_16(fofs);
-	fh->reserved2   = 0;
-	fh->more_frags  = rte_cpu_to_be_16(mf);
-	fh->id = 0;
+	*dst = *tmpl;
+	dst->hdr.payload_len = rte_cpu_to_be_16(len);
+
+	/* offset is in 8 bytes units, so it is aligned already. */
+	dst->fh.frag_data = rte_cpu_to_be_16((uint16_t)(fofs |
+		mf << IPV6_HDR_MF_SHIFT));
 }
 
 static inline void
@@ -80,6 +96,72 @@ __free_fragments(struct rte_mbuf *mb[], uint32_t num)
 		rte_pktmbuf_free(mb[i]);
 }
 
+static inline int32_t
+ipv6_fragment_packet(struct rte_mbuf *pkt_in,
+	struct rte_mbuf **pkts_out,
+	uint16_t nb_pkts_out,
+	uint16_t mtu_size,
+	struct rte_mempool *pool_direct,
+	struct rte_mempool *pool_indirect)
+{
+	struct rte_mbuf *in_seg, *out_pkt;
+	struct ipv6_frag_tmpl tmpl;
+	uint32_t i, nb_frags, in_seg_data_pos, len, payload;
+	uint16_t fragment_offset, frag_size;
+	int ret;
+
+	/* Fragment size should be a multiple of 8. */
+	frag_size = (uint16_t)((mtu_size - sizeof(tmpl)) & ~IPV6_HDR_FO_MASK);
+
+	/* Check that pkts_out is big enough to hold all fragments */
+	payload = pkt_in->pkt_len - sizeof(struct ipv6_hdr);
+	if (unlikely(mtu_size <= sizeof(tmpl) || frag_size == 0))
+		return (-EINVAL);
+	nb_frags = (payload + frag_size - 1) / frag_size;
+	if (unlikely(nb_frags > nb_pkts_out))
+		return (-ENOSPC);
+
+	if (unlikely(ip_frag_alloc_direct(pool_direct, pkts_out,
+			nb_frags) != 0))
+		return (-ENOMEM);
+
+	__init_ipv6hdr_tmpl(&tmpl,
+		rte_pktmbuf_mtod(pkt_in, struct ipv6_hdr *));
+
+	in_seg = pkt_in;
+	in_seg_data_pos = sizeof(struct ipv6_hdr);
+	fragment_offset = 0;
+
+	for (i = 0; i != nb_frags; i++) {
+
+		out_pkt = pkts_out[i];
+		len = RTE_MIN((uint32_t)frag_size, payload - fragment_offset);
+
+		/* Reserve space for the IP header that will be built later */
+		out_pkt->data_len = sizeof(tmpl);
+		out_pkt->pkt_len  = sizeof(tmpl);
+
+		/* Share payload of the input packet by reference */
+		ret = ip_frag_attach_payload(out_pkt, &in_seg,
+			&in_seg_data_pos, len, pool_indirect);
+		if (unlikely(ret != 0)) {
+			__free_fragments(pkts_out, nb_frags);
+			return (ret);
+		}
+
+		/* Build the IP header */
+		__fill_ipv6hdr_frag(
+		    rte_pktmbuf_mtod(out_pkt, struct ipv6_frag_tmpl *), &tmpl,
+		    (uint16_t)(out_pkt->pkt_len - sizeof(struct ipv6_hdr)),
+		    fragment_offset, i + 1 != nb_frags);
+
+		fragment_offset = (uint16_t)(fragment_offset + len);
+		out_pkt->l3_len = sizeof(tmpl);
+	}
+
+	return (nb_frags);
+}
+
 /**
  * IPv6 fragmentation.
  *
@@ -109,107 +191,56 @@ rte_ipv6_fragment_packet(struct rte_mbuf *pkt_in,
 	struct rte_mempool *pool_direct,
 	struct rte_mempool *pool_indirect)
 {
-	struct rte_mbuf *in_seg = NULL;
-	struct ipv6_hdr *in_hdr;
-	uint32_t out_pkt_pos, in_seg_data_pos;
-	uint32_t more_in_segs;
-	uint16_t fragment_offset, frag_size;
-
-	frag_size = (uint16_t)(mtu_size - sizeof(struct ipv6_hdr));
+	int32_t ret;
 
 	/* Fragment size should be a multiple of 8. */
-	IP_FRAG_ASSERT((frag_size & IPV6_HDR_FO_MASK) == 0);
-
-	/* Check that pkts_out is big enough to hold all fragments */
-	if (unlikely (frag_size * nb_pkts_out <
-	    (uint16_t)(pkt_in->pkt_len - sizeof (struct ipv6_hdr))))
-		return (-EINVAL);
+	IP_FRAG_ASSERT(((mtu_size - sizeof(struct ipv6_hdr)) &
+		IPV6_HDR_FO_MASK) == 0);
 
-	in_hdr = rte_pktmbuf_mtod(pkt_in, struct ipv6_hdr *);
+	ret = ipv6_fragment_packet(pkt_in, pkts_out, nb_pkts_out, mtu_size,
+		pool_direct, pool_indirect);
 
-	in_seg = pkt_in;
-	in_seg_data_pos = sizeof(struct ipv6_hdr);
-	out_pkt_pos = 0;
-	fragment_offset = 0;
-
-	more_in_segs = 1;
-	while (likely(more_in_segs)) {
-		struct rte_mbuf *out_pkt = NULL, *out_seg_prev = NULL;
-		uint32_t more_out_segs;
-		struct ipv6_hdr *out_hdr;
-
-		/* Allocate direct buffer */
-		out_pkt = rte_pktmbuf_alloc(pool_direct);
-		if (unlikely(out_pkt == NULL)) {
-			__free_fragments(pkts_out, out_pkt_pos);
-			return (-ENOMEM);
-		}
+	/* pkts_out is not big enough to hold all fragments */
+	return (ret == -ENOSPC) ? -EINVAL : ret;
+}
 
-		/* Reserve space for the IP header that will be built later */
-		out_pkt->data_len = sizeof(struct ipv6_hdr) + sizeof(struct ipv6_extension_fragment);
-		out_pkt->pkt_len  = sizeof(struct ipv6_hdr) + sizeof(struct ipv6_extension_fragment);
-
-		out_seg_prev = out_pkt;
-		more_out_segs = 1;
-		while (likely(more_out_segs && more_in_segs)) {
-			struct rte_mbuf *out_seg = NULL;
-			uint32_t len;
-
-			/* Allocate indirect buffer */
-			out_seg = rte_pktmbuf_alloc(pool_indirect);
-			if (unlikely(out_seg == NULL)) {
-				rte_pktmbuf_free(out_pkt);
-				__free_fragments(pkts_out, out_pkt_pos);
-				return (-ENOMEM);
-			}
-			out_seg_prev->next = out_seg;
-			out_seg_prev = out_seg;
-
-			/* Prepare indirect buffer */
-			rte_pktmbuf_attach(out_seg, in_seg);
-			len = mtu_size - out_pkt->pkt_len;
-			if (len > (in_seg->data_len - in_seg_data_pos)) {
-				len = in_seg->data_len - in_seg_data_pos;
-			}
-			out_seg->data_off = in_seg->data_off + in_seg_data_pos;
-			out_seg->data_len = (uint16_t)len;
-			out_pkt->pkt_len = (uint16_t)(len +
-			    out_pkt->pkt_len);
-			out_pkt->nb_segs += 1;
-			in_seg_data_pos += len;
-
-			/* Current output packet (i.e. fragment) done ? */
-			if (unlikely(out_pkt->pkt_len >= mtu_size)) {
-				more_out_segs = 0;
-			}
+/*
+ * IPv6 fragmentation of a burst of packets.
+ * Packets that fit into the MTU are passed through,
+ * fragmented packets are freed (fragments keep references to their data).
+ */
+int
+rte_ipv6_fragment_bulk(struct rte_mbuf **pkts_in, uint16_t nb_pkts_in,
+	struct rte_mbuf **pkts_out, uint16_t *nb_pkts_out, uint16_t mtu_size,
+	struct rte_mempool *pool_direct, struct rte_mempool *pool_indirect)
+{
+	uint32_t i, k;
+	int32_t ret;
 
-			/* Current input segment done ? */
-			if (unlikely(in_seg_data_pos == in_seg->data_len)) {
-				in_seg = in_seg->next;
-				in_seg_data_pos = 0;
+	k = 0;
+	for (i = 0; i != nb_pkts_in; i++) {
 
-				if (unlikely(in_seg == NULL)) {
-					more_in_segs = 0;
-				}
+		if (pkts_in[i]->pkt_len <= mtu_size) {
+			if (unlikely(k == *nb_pkts_out)) {
+				rte_errno = ENOSPC;
+				break;
 			}
+			pkts_out[k++] = pkts_in[i];
+			continue;
 		}
 
-		/* Build the IP header */
-
-		out_hdr = rte_pktmbuf_mtod(out_pkt, struct ipv6_hdr *);
-
-		__fill_ipv6hdr_frag(out_hdr, in_hdr,
-		    (uint16_t) out_pkt->pkt_len - sizeof(struct ipv6_hdr),
-		    fragment_offset, more_in_segs);
-
-		fragment_offset = (uint16_t)(fragment_offset +
-		    out_pkt->pkt_len - sizeof(struct ipv6_hdr)
-			- sizeof(struct ipv6_extension_fragment));
+		ret = ipv6_fragment_packet(pkts_in[i], pkts_out + k,
+			(uint16_t)(*nb_pkts_out - k), mtu_size,
+			pool_direct, pool_indirect);
+		if (unlikely(ret < 0)) {
+			rte_errno = -ret;
+			break;
+		}
 
-		/* Write the fragment to the output list */
-		pkts_out[out_pkt_pos] = out_pkt;
-		out_pkt_pos ++;
+		rte_pktmbuf_free(pkts_in[i]);
+		k += ret;
 	}
 
-	return (out_pkt_pos);
+	*nb_pkts_out = (uint16_t)k;
+	return (i);
 }
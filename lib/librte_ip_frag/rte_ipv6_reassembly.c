@@ -204,7 +204,7 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 
 	/* process the fragmented packet. */
-	mb = ip_frag_process(fp, dr, mb, ip_ofs, ip_len,
+	mb = ip_frag_process(tbl, fp, dr, mb, ip_ofs, ip_len,
 			MORE_FRAGS(frag_hdr->frag_data));
 	ip_frag_inuse(tbl, fp);
 
@@ -220,3 +220,47 @@ rte_ipv6_frag_reassemble_packet(struct rte_ip_frag_tbl *tbl,
 
 	return mb;
 }
+
+/*
+ * Process a burst of IPV6 packets.
+ * Incoming mbufs should have their l2_len/l3_len fields setup correctly.
+ */
+int
+rte_ipv6_frag_reassemble_bulk(struct rte_ip_frag_tbl *tbl,
+	struct rte_ip_frag_death_row *dr, struct rte_mbuf **pkts_in,
+	uint16_t nb_pkts, uint64_t tms, struct rte_mbuf **pkts_out)
+{
+	struct ip_frag_desc desc[IP_FRAG_DEATH_ROW_LEN];
+	struct ipv6_hdr *ip_hdr;
+	struct ipv6_extension_fragment *frag_hdr;
+	uint32_t i;
+	int ret;
+
+	if ((ret = ip_frag_bulk_check(dr, nb_pkts)) != 0)
+		return (ret);
+
+	for (i = 0; i != nb_pkts; i++) {
+
+		ip_hdr = (struct ipv6_hdr *)(rte_pktmbuf_mtod(pkts_in[i],
+			uint8_t *) + pkts_in[i]->l2_len);
+
+		frag_hdr = rte_ipv6_frag_get_ipv6_fragment_header(ip_hdr);
+		if (frag_hdr == NULL) {
+			desc[i].key.key_len = 0;
+			continue;
+		}
+
+		rte_memcpy(&desc[i].key.src_dst[0], ip_hdr->src_addr, 16);
+		rte_memcpy(&desc[i].key.src_dst[2], ip_hdr->dst_addr, 16);
+		desc[i].key.id = frag_hdr->id;
+		desc[i].key.key_len = IPV6_KEYLEN;
+
+		desc[i].ofs = (uint16_t)(FRAG_OFFSET(frag_hdr->frag_data) * 8);
+		desc[i].len = (uint16_t)(rte_be_to_cpu_16(ip_hdr->payload_len) -
+			sizeof(*frag_hdr));
+		desc[i].more_frags = MORE_FRAGS(frag_hdr->frag_data);
+	}
+
+	return (ip_frag_reassemble_bulk(tbl, dr, pkts_in, desc, nb_pkts, tms,
+		pkts_out));
+}
@@ -541,6 +541,13 @@ add_mempool_to_metadata(const struct rte_mempool * mp,
 		return -1;
 	}
 
+	/* only ring based mempools can be shared */
+	if (mp->ring == NULL) {
+		RTE_LOG(ERR, EAL, "Mempool %s is not backed by a ring!\n",
+				mp->name);
+		return -1;
+	}
+
 	/* mempool consists of memzone and ring */
 	ret = add_memzone_to_metadata(mz, config);
 	if (ret < 0)
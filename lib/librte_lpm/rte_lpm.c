@@ -52,6 +52,7 @@
 #include <rte_errno.h>
 #include <rte_rwlock.h>
 #include <rte_spinlock.h>
+#include <rte_compat.h>
 
 #include "rte_lpm.h"
 
@@ -144,23 +145,1191 @@ rte_lpm_find_existing(const char *name)
 	return l;
 }
 
+/*
+ * The exported functions are versioned, see the compatibility code with the
+ * DPDK 2.0 ABI at the end of this file.
+ */
+struct rte_lpm *rte_lpm_create_v21(const char *name, int socket_id,
+		const struct rte_lpm_config *config);
+void rte_lpm_free_v21(struct rte_lpm *lpm);
+int rte_lpm_add_v21(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
+		uint32_t next_hop);
+int rte_lpm_is_rule_present_v21(struct rte_lpm *lpm, uint32_t ip,
+		uint8_t depth, uint32_t *next_hop);
+int rte_lpm_delete_v21(struct rte_lpm *lpm, uint32_t ip, uint8_t depth);
+void rte_lpm_delete_all_v21(struct rte_lpm *lpm);
+
+/*
+ * Writes a tbl24 or tbl8 entry with a single store, so that a concurrent
+ * lookup reads either the previous or the new entry.
+ */
+static inline void
+tbl_entry_write(struct rte_lpm_tbl_entry *dst, struct rte_lpm_tbl_entry src)
+{
+	union {
+		struct rte_lpm_tbl_entry entry;
+		uint32_t u32;
+	} v = { .entry = src };
+
+	*(volatile uint32_t *)dst = v.u32;
+}
+
+/*
+ * Allocates memory for LPM object
+ */
+struct rte_lpm * __vsym
+rte_lpm_create_v21(const char *name, int socket_id,
+		const struct rte_lpm_config *config)
+{
+	char mem_name[RTE_LPM_NAMESIZE];
+	struct rte_lpm *lpm = NULL;
+	struct rte_tailq_entry *te;
+	size_t mem_size, rules_size, tbl8s_size, pending_size;
+	struct rte_lpm_list *lpm_list;
+
+	lpm_list = RTE_TAILQ_CAST(rte_lpm_tailq.head, rte_lpm_list);
+
+	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl_entry) != 4);
+
+	/* Check user arguments. */
+	if ((name == NULL) || (socket_id < -1) || (config == NULL) ||
+			(config->max_rules == 0) ||
+			(config->number_tbl8s == 0) ||
+			(config->number_tbl8s > RTE_LPM_MAX_TBL8_NUM_GROUPS)) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	snprintf(mem_name, sizeof(mem_name), "LPM_%s", name);
+
+	/* Determine the amount of memory to allocate. */
+	mem_size = sizeof(*lpm);
+	rules_size = sizeof(struct rte_lpm_rule) * config->max_rules;
+	tbl8s_size = (sizeof(struct rte_lpm_tbl_entry) *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES * config->number_tbl8s);
+	/* One more slot than groups, so that a full list is not empty. */
+	pending_size = sizeof(struct rte_lpm_tbl8_pending) *
+			(config->number_tbl8s + 1);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* guarantee there's no existing */
+	TAILQ_FOREACH(te, lpm_list, next) {
+		lpm = (struct rte_lpm *) te->data;
+		if (strncmp(name, lpm->name, RTE_LPM_NAMESIZE) == 0)
+			break;
+	}
+	if (te != NULL)
+		goto exit;
+
+	/* allocate tailq entry */
+	te = rte_zmalloc("LPM_TAILQ_ENTRY", sizeof(*te), 0);
+	if (te == NULL) {
+		RTE_LOG(ERR, LPM, "Failed to allocate tailq entry\n");
+		rte_errno = ENOMEM;
+		goto exit;
+	}
+
+	/* Allocate memory to store the LPM data structures. */
+	lpm = (struct rte_lpm *)rte_zmalloc_socket(mem_name, mem_size,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	if (lpm == NULL) {
+		RTE_LOG(ERR, LPM, "LPM memory allocation failed\n");
+		rte_free(te);
+		rte_errno = ENOMEM;
+		goto exit;
+	}
+
+	lpm->rules_tbl = (struct rte_lpm_rule *)rte_zmalloc_socket(NULL,
+			rules_size, RTE_CACHE_LINE_SIZE, socket_id);
+	if (lpm->rules_tbl == NULL) {
+		RTE_LOG(ERR, LPM, "LPM rules_tbl memory allocation failed\n");
+		rte_free(lpm);
+		lpm = NULL;
+		rte_free(te);
+		rte_errno = ENOMEM;
+		goto exit;
+	}
+
+	lpm->tbl8 = (struct rte_lpm_tbl_entry *)rte_zmalloc_socket(NULL,
+			tbl8s_size, RTE_CACHE_LINE_SIZE, socket_id);
+	if (lpm->tbl8 == NULL) {
+		RTE_LOG(ERR, LPM, "LPM tbl8 memory allocation failed\n");
+		rte_free(lpm->rules_tbl);
+		rte_free(lpm);
+		lpm = NULL;
+		rte_free(te);
+		rte_errno = ENOMEM;
+		goto exit;
+	}
+
+	lpm->tbl8_pending = (struct rte_lpm_tbl8_pending *)rte_zmalloc_socket(
+			NULL, pending_size, RTE_CACHE_LINE_SIZE, socket_id);
+	if (lpm->tbl8_pending == NULL) {
+		RTE_LOG(ERR, LPM, "LPM tbl8 list memory allocation failed\n");
+		rte_free(lpm->tbl8);
+		rte_free(lpm->rules_tbl);
+		rte_free(lpm);
+		lpm = NULL;
+		rte_free(te);
+		rte_errno = ENOMEM;
+		goto exit;
+	}
+
+	/* Save user arguments. */
+	lpm->max_rules = config->max_rules;
+	lpm->number_tbl8s = config->number_tbl8s;
+	/* Epoch 0 stands for an unregistered reader. */
+	lpm->epoch = 1;
+	snprintf(lpm->name, sizeof(lpm->name), "%s", name);
+
+	te->data = (void *) lpm;
+
+	TAILQ_INSERT_TAIL(lpm_list, te, next);
+
+exit:
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	return lpm;
+}
+BIND_DEFAULT_SYMBOL(rte_lpm_create, _v21, 2.1);
+MAP_STATIC_SYMBOL(struct rte_lpm *rte_lpm_create(const char *name,
+		int socket_id, const struct rte_lpm_config *config),
+		rte_lpm_create_v21);
+
+/*
+ * Deallocates memory for given LPM table.
+ */
+void __vsym
+rte_lpm_free_v21(struct rte_lpm *lpm)
+{
+	struct rte_lpm_list *lpm_list;
+	struct rte_tailq_entry *te;
+
+	/* Check user arguments. */
+	if (lpm == NULL)
+		return;
+
+	lpm_list = RTE_TAILQ_CAST(rte_lpm_tailq.head, rte_lpm_list);
+
+	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
+
+	/* find our tailq entry */
+	TAILQ_FOREACH(te, lpm_list, next) {
+		if (te->data == (void *) lpm)
+			break;
+	}
+	if (te == NULL) {
+		rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+		return;
+	}
+
+	TAILQ_REMOVE(lpm_list, te, next);
+
+	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
+
+	rte_free(lpm->tbl8_pending);
+	rte_free(lpm->tbl8);
+	rte_free(lpm->rules_tbl);
+	rte_free(lpm);
+	rte_free(te);
+}
+BIND_DEFAULT_SYMBOL(rte_lpm_free, _v21, 2.1);
+MAP_STATIC_SYMBOL(void rte_lpm_free(struct rte_lpm *lpm),
+		rte_lpm_free_v21);
+
+/*
+ * Adds a rule to the rule table.
+ *
+ * NOTE: The rule table is split into 32 groups. Each group contains rules that
+ * apply to a specific prefix depth (i.e. group 1 contains rules that apply to
+ * prefixes with a depth of 1 etc.). In the following code (depth - 1) is used
+ * to refer to depth 1 because even though the depth range is 1 - 32, depths
+ * are stored in the rule table from 0 - 31.
+ * NOTE: Valid range for depth parameter is 1 .. 32 inclusive.
+ */
+static inline int32_t
+rule_add(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
+	uint32_t next_hop)
+{
+	uint32_t rule_gindex, rule_index, last_rule;
+	int i;
+
+	VERIFY_DEPTH(depth);
+
+	/* Scan through rule group to see if rule already exists. */
+	if (lpm->rule_info[depth - 1].used_rules > 0) {
+
+		/* rule_gindex stands for rule group index. */
+		rule_gindex = lpm->rule_info[depth - 1].first_rule;
+		/* Initialise rule_index to point to start of rule group. */
+		rule_index = rule_gindex;
+		/* Last rule = Last used rule in this rule group. */
+		last_rule = rule_gindex + lpm->rule_info[depth - 1].used_rules;
+
+		for (; rule_index < last_rule; rule_index++) {
+
+			/* If rule already exists update its next_hop and return. */
+			if (lpm->rules_tbl[rule_index].ip == ip_masked) {
+				lpm->rules_tbl[rule_index].next_hop = next_hop;
+
+				return rule_index;
+			}
+		}
+
+		if (rule_index == lpm->max_rules)
+			return -ENOSPC;
+	} else {
+		/* Calculate the position in which the rule will be stored. */
+		rule_index = 0;
+
+		for (i = depth - 1; i > 0; i--) {
+			if (lpm->rule_info[i - 1].used_rules > 0) {
+				rule_index = lpm->rule_info[i - 1].first_rule + lpm->rule_info[i - 1].used_rules;
+				break;
+			}
+		}
+		if (rule_index == lpm->max_rules)
+			return -ENOSPC;
+
+		lpm->rule_info[depth - 1].first_rule = rule_index;
+	}
+
+	/* Make room for the new rule in the array. */
+	for (i = RTE_LPM_MAX_DEPTH; i > depth; i--) {
+		if (lpm->rule_info[i - 1].first_rule + lpm->rule_info[i - 1].used_rules == lpm->max_rules)
+			return -ENOSPC;
+
+		if (lpm->rule_info[i - 1].used_rules > 0) {
+			lpm->rules_tbl[lpm->rule_info[i - 1].first_rule + lpm->rule_info[i - 1].used_rules]
+					= lpm->rules_tbl[lpm->rule_info[i - 1].first_rule];
+			lpm->rule_info[i - 1].first_rule++;
+		}
+	}
+
+	/* Add the new rule. */
+	lpm->rules_tbl[rule_index].ip = ip_masked;
+	lpm->rules_tbl[rule_index].next_hop = next_hop;
+
+	/* Increment the used rules counter for this rule group. */
+	lpm->rule_info[depth - 1].used_rules++;
+
+	return rule_index;
+}
+
+/*
+ * Delete a rule from the rule table.
+ * NOTE: Valid range for depth parameter is 1 .. 32 inclusive.
+ */
+static inline void
+rule_delete(struct rte_lpm *lpm, int32_t rule_index, uint8_t depth)
+{
+	int i;
+
+	VERIFY_DEPTH(depth);
+
+	lpm->rules_tbl[rule_index] = lpm->rules_tbl[lpm->rule_info[depth - 1].first_rule
+			+ lpm->rule_info[depth - 1].used_rules - 1];
+
+	for (i = depth; i < RTE_LPM_MAX_DEPTH; i++) {
+		if (lpm->rule_info[i].used_rules > 0) {
+			lpm->rules_tbl[lpm->rule_info[i].first_rule - 1] =
+					lpm->rules_tbl[lpm->rule_info[i].first_rule + lpm->rule_info[i].used_rules - 1];
+			lpm->rule_info[i].first_rule--;
+		}
+	}
+
+	lpm->rule_info[depth - 1].used_rules--;
+}
+
+/*
+ * Finds a rule in rule table.
+ * NOTE: Valid range for depth parameter is 1 .. 32 inclusive.
+ */
+static inline int32_t
+rule_find(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth)
+{
+	uint32_t rule_gindex, last_rule, rule_index;
+
+	VERIFY_DEPTH(depth);
+
+	rule_gindex = lpm->rule_info[depth - 1].first_rule;
+	last_rule = rule_gindex + lpm->rule_info[depth - 1].used_rules;
+
+	/* Scan used rules at given depth to find rule. */
+	for (rule_index = rule_gindex; rule_index < last_rule; rule_index++) {
+		/* If rule is found return the rule index. */
+		if (lpm->rules_tbl[rule_index].ip == ip_masked)
+			return (rule_index);
+	}
+
+	/* If rule is not found return -EINVAL. */
+	return -EINVAL;
+}
+
+/*
+ * Makes the tbl8 groups unlinked before all the registered readers went
+ * through a quiescent state available again.
+ * Returns the number of groups made available.
+ */
+static uint32_t
+tbl8_reclaim(struct rte_lpm *lpm)
+{
+	const struct rte_lpm_tbl8_pending *pending;
+	uint64_t epoch, reader_epoch;
+	uint32_t n = 0;
+	unsigned i;
+
+	if (lpm->pending_tail == lpm->pending_head)
+		return 0;
+
+	/* Find the oldest epoch a reader may still be in. */
+	epoch = lpm->epoch;
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		reader_epoch = lpm->readers[i].epoch;
+		if (reader_epoch != 0 && reader_epoch < epoch)
+			epoch = reader_epoch;
+	}
+
+	/* Groups are queued in increasing epoch order. */
+	while (lpm->pending_tail != lpm->pending_head) {
+		pending = &lpm->tbl8_pending[lpm->pending_tail];
+		if (pending->epoch > epoch)
+			break;
+
+		lpm->tbl8[pending->group_index *
+				RTE_LPM_TBL8_GROUP_NUM_ENTRIES].valid_group =
+				INVALID;
+		if (pending->group_index < lpm->tbl8_free_hint)
+			lpm->tbl8_free_hint = pending->group_index;
+		if (++lpm->pending_tail > lpm->number_tbl8s)
+			lpm->pending_tail = 0;
+		n++;
+	}
+
+	return n;
+}
+
+/*
+ * Find, clean and allocate a tbl8.
+ */
+static inline int32_t
+tbl8_alloc(struct rte_lpm *lpm)
+{
+	uint32_t tbl8_gindex; /* tbl8 group index. */
+	struct rte_lpm_tbl_entry *tbl8_entry;
+
+	do {
+		/*
+		 * Scan through tbl8 to find a free (i.e. INVALID) group,
+		 * starting from the lowest one which may be free.
+		 */
+		for (tbl8_gindex = lpm->tbl8_free_hint;
+				tbl8_gindex < lpm->number_tbl8s;
+				tbl8_gindex++) {
+			tbl8_entry = &lpm->tbl8[tbl8_gindex *
+					RTE_LPM_TBL8_GROUP_NUM_ENTRIES];
+			/*
+			 * If a free tbl8 group is found clean it and set as
+			 * VALID. No lookup can read it, it is not linked.
+			 */
+			if (!tbl8_entry->valid_group) {
+				memset(&tbl8_entry[0], 0,
+						RTE_LPM_TBL8_GROUP_NUM_ENTRIES *
+						sizeof(tbl8_entry[0]));
+
+				tbl8_entry->valid_group = VALID;
+				lpm->tbl8_free_hint = tbl8_gindex + 1;
+
+				/* Return group index for allocated group. */
+				return tbl8_gindex;
+			}
+		}
+		lpm->tbl8_free_hint = lpm->number_tbl8s;
+	/* Retry with the unlinked groups no reader can access any more. */
+	} while (tbl8_reclaim(lpm) > 0);
+
+	/* If there are no tbl8 groups free then return error. */
+	return -ENOSPC;
+}
+
+/*
+ * Frees a tbl8 group, once unlinked from tbl24.
+ */
+static inline void
+tbl8_free(struct rte_lpm *lpm, uint32_t tbl8_group_start)
+{
+	struct rte_lpm_tbl8_pending *pending;
+
+	/*
+	 * Lookups started before the unlink may still read the group: it
+	 * is queued, with valid_group still set, until tbl8_reclaim() finds
+	 * that all the readers went through a quiescent state since.
+	 */
+	lpm->epoch++;
+	pending = &lpm->tbl8_pending[lpm->pending_head];
+	pending->group_index = tbl8_group_start / RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+	pending->epoch = lpm->epoch;
+	if (++lpm->pending_head > lpm->number_tbl8s)
+		lpm->pending_head = 0;
+}
+
+static inline int32_t
+add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
+		uint32_t next_hop)
+{
+	uint32_t tbl24_index, tbl24_range, tbl8_index, tbl8_group_end, i, j;
+
+	/* Calculate the index into Table24. */
+	tbl24_index = ip >> 8;
+	tbl24_range = depth_to_range(depth);
+
+	for (i = tbl24_index; i < (tbl24_index + tbl24_range); i++) {
+		/*
+		 * For invalid OR valid and non-extended tbl 24 entries set
+		 * entry.
+		 */
+		if (!lpm->tbl24[i].valid || (lpm->tbl24[i].valid_group == 0 &&
+				lpm->tbl24[i].depth <= depth)) {
+
+			struct rte_lpm_tbl_entry new_tbl24_entry = {
+				.next_hop = next_hop,
+				.valid = VALID,
+				.valid_group = 0,
+				.depth = depth,
+			};
+
+			/* Setting tbl24 entry in one go to avoid race
+			 * conditions */
+			tbl_entry_write(&lpm->tbl24[i], new_tbl24_entry);
+
+			continue;
+		}
+
+		/*
+		 * A valid and non-extended entry of a deeper rule is kept,
+		 * only its next hop field must not be taken for a tbl8 index.
+		 */
+		if (lpm->tbl24[i].valid_group == 0)
+			continue;
+
+		/* If tbl24 entry is valid and extended calculate the index
+		 * into tbl8. */
+		tbl8_index = lpm->tbl24[i].next_hop *
+				RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		tbl8_group_end = tbl8_index + RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+
+		for (j = tbl8_index; j < tbl8_group_end; j++) {
+			if (!lpm->tbl8[j].valid ||
+					lpm->tbl8[j].depth <= depth) {
+				struct rte_lpm_tbl_entry new_tbl8_entry = {
+					.valid = VALID,
+					.valid_group = VALID,
+					.depth = depth,
+					.next_hop = next_hop,
+				};
+
+				/*
+				 * Setting tbl8 entry in one go to avoid race
+				 * conditions
+				 */
+				tbl_entry_write(&lpm->tbl8[j], new_tbl8_entry);
+
+				continue;
+			}
+		}
+	}
+
+	return 0;
+}
+
+static inline int32_t
+add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
+		uint32_t next_hop)
+{
+	uint32_t tbl24_index;
+	int32_t tbl8_group_index, tbl8_group_start, tbl8_group_end, tbl8_index,
+		tbl8_range, i;
+
+	struct rte_lpm_tbl_entry new_tbl8_entry = {
+		.valid = VALID,
+		.valid_group = VALID,
+		.depth = depth,
+		.next_hop = next_hop,
+	};
+
+	tbl24_index = (ip_masked >> 8);
+	tbl8_range = depth_to_range(depth);
+
+	if (!lpm->tbl24[tbl24_index].valid) {
+		/* Search for a free tbl8 group. */
+		tbl8_group_index = tbl8_alloc(lpm);
+
+		/* Check tbl8 allocation was successful. */
+		if (tbl8_group_index < 0) {
+			return tbl8_group_index;
+		}
+
+		/* Find index into tbl8 and range. */
+		tbl8_index = (tbl8_group_index *
+				RTE_LPM_TBL8_GROUP_NUM_ENTRIES) +
+				(ip_masked & 0xFF);
+
+		/* Set tbl8 entry. */
+		for (i = tbl8_index; i < (tbl8_index + tbl8_range); i++)
+			tbl_entry_write(&lpm->tbl8[i], new_tbl8_entry);
+
+		/*
+		 * Update tbl24 entry to point to new tbl8 entry. Note: The
+		 * ext_flag and tbl8_index need to be updated simultaneously,
+		 * so assign whole structure in one go
+		 */
+
+		struct rte_lpm_tbl_entry new_tbl24_entry = {
+			.next_hop = (uint32_t)tbl8_group_index,
+			.valid = VALID,
+			.valid_group = 1,
+			.depth = 0,
+		};
+
+		/* The tbl8 group must be complete before it is linked. */
+		rte_wmb();
+		tbl_entry_write(&lpm->tbl24[tbl24_index], new_tbl24_entry);
+
+	}/* If valid entry but not extended calculate the index into Table8. */
+	else if (lpm->tbl24[tbl24_index].valid_group == 0) {
+		/* Search for free tbl8 group. */
+		tbl8_group_index = tbl8_alloc(lpm);
+
+		if (tbl8_group_index < 0) {
+			return tbl8_group_index;
+		}
+
+		tbl8_group_start = tbl8_group_index *
+				RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		tbl8_group_end = tbl8_group_start +
+				RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+
+		struct rte_lpm_tbl_entry tbl24_tbl8_entry = {
+			.valid = VALID,
+			.valid_group = VALID,
+			.depth = lpm->tbl24[tbl24_index].depth,
+			.next_hop = lpm->tbl24[tbl24_index].next_hop,
+		};
+
+		/* Populate new tbl8 with tbl24 value. */
+		for (i = tbl8_group_start; i < tbl8_group_end; i++)
+			tbl_entry_write(&lpm->tbl8[i], tbl24_tbl8_entry);
+
+		tbl8_index = tbl8_group_start + (ip_masked & 0xFF);
+
+		/* Insert new rule into the tbl8 entry. */
+		for (i = tbl8_index; i < tbl8_index + tbl8_range; i++) {
+			if (!lpm->tbl8[i].valid ||
+					lpm->tbl8[i].depth <= depth) {
+				tbl_entry_write(&lpm->tbl8[i], new_tbl8_entry);
+
+				continue;
+			}
+		}
+
+		/*
+		 * Update tbl24 entry to point to new tbl8 entry. Note: The
+		 * ext_flag and tbl8_index need to be updated simultaneously,
+		 * so assign whole structure in one go.
+		 */
+
+		struct rte_lpm_tbl_entry new_tbl24_entry = {
+				.next_hop = (uint32_t)tbl8_group_index,
+				.valid = VALID,
+				.valid_group = 1,
+				.depth = 0,
+		};
+
+		/* The tbl8 group must be complete before it is linked. */
+		rte_wmb();
+		tbl_entry_write(&lpm->tbl24[tbl24_index], new_tbl24_entry);
+
+	}
+	else { /*
+		* If it is valid, extended entry calculate the index into tbl8.
+		*/
+		tbl8_group_index = lpm->tbl24[tbl24_index].next_hop;
+		tbl8_group_start = tbl8_group_index *
+				RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+		tbl8_index = tbl8_group_start + (ip_masked & 0xFF);
+
+		for (i = tbl8_index; i < (tbl8_index + tbl8_range); i++) {
+
+			if (!lpm->tbl8[i].valid ||
+					lpm->tbl8[i].depth <= depth) {
+				/*
+				 * Setting tbl8 entry in one go to avoid race
+				 * condition
+				 */
+				tbl_entry_write(&lpm->tbl8[i], new_tbl8_entry);
+
+				continue;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Add a route
+ */
+int __vsym
+rte_lpm_add_v21(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
+		uint32_t next_hop)
+{
+	int32_t rule_index, status = 0;
+	uint32_t ip_masked;
+
+	/* Check user arguments. */
+	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM_MAX_DEPTH) ||
+			(next_hop > RTE_LPM_MAX_NEXT_HOP))
+		return -EINVAL;
+
+	ip_masked = ip & depth_to_mask(depth);
+
+	/* Add the rule to the rule table. */
+	rule_index = rule_add(lpm, ip_masked, depth, next_hop);
+
+	/* If the is no space available for new rule return error. */
+	if (rule_index < 0) {
+		return rule_index;
+	}
+
+	if (depth <= MAX_DEPTH_TBL24) {
+		status = add_depth_small(lpm, ip_masked, depth, next_hop);
+	}
+	else { /* If depth > RTE_LPM_MAX_DEPTH_TBL24 */
+		status = add_depth_big(lpm, ip_masked, depth, next_hop);
+
+		/*
+		 * If add fails due to exhaustion of tbl8 extensions delete
+		 * rule that was added to rule table.
+		 */
+		if (status < 0) {
+			rule_delete(lpm, rule_index, depth);
+
+			return status;
+		}
+	}
+
+	return 0;
+}
+BIND_DEFAULT_SYMBOL(rte_lpm_add, _v21, 2.1);
+MAP_STATIC_SYMBOL(int rte_lpm_add(struct rte_lpm *lpm, uint32_t ip,
+		uint8_t depth, uint32_t next_hop), rte_lpm_add_v21);
+
+/*
+ * Look for a rule in the high-level rules table
+ */
+int __vsym
+rte_lpm_is_rule_present_v21(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
+uint32_t *next_hop)
+{
+	uint32_t ip_masked;
+	int32_t rule_index;
+
+	/* Check user arguments. */
+	if ((lpm == NULL) ||
+		(next_hop == NULL) ||
+		(depth < 1) || (depth > RTE_LPM_MAX_DEPTH))
+		return -EINVAL;
+
+	/* Look for the rule using rule_find. */
+	ip_masked = ip & depth_to_mask(depth);
+	rule_index = rule_find(lpm, ip_masked, depth);
+
+	if (rule_index >= 0) {
+		*next_hop = lpm->rules_tbl[rule_index].next_hop;
+		return 1;
+	}
+
+	/* If rule is not found return 0. */
+	return 0;
+}
+BIND_DEFAULT_SYMBOL(rte_lpm_is_rule_present, _v21, 2.1);
+MAP_STATIC_SYMBOL(int rte_lpm_is_rule_present(struct rte_lpm *lpm, uint32_t ip,
+		uint8_t depth, uint32_t *next_hop), rte_lpm_is_rule_present_v21);
+
+static inline int32_t
+find_previous_rule(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint8_t *sub_rule_depth)
+{
+	int32_t rule_index;
+	uint32_t ip_masked;
+	uint8_t prev_depth;
+
+	for (prev_depth = (uint8_t)(depth - 1); prev_depth > 0; prev_depth--) {
+		ip_masked = ip & depth_to_mask(prev_depth);
+
+		rule_index = rule_find(lpm, ip_masked, prev_depth);
+
+		if (rule_index >= 0) {
+			*sub_rule_depth = prev_depth;
+			return rule_index;
+		}
+	}
+
+	return -1;
+}
+
+static inline int32_t
+delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
+	uint8_t depth, int32_t sub_rule_index, uint8_t sub_rule_depth)
+{
+	uint32_t tbl24_range, tbl24_index, tbl8_group_index, tbl8_index, i, j;
+	struct rte_lpm_tbl_entry new_tbl24_entry, new_tbl8_entry;
+
+	/* Calculate the range and index into Table24. */
+	tbl24_range = depth_to_range(depth);
+	tbl24_index = (ip_masked >> 8);
+
+	/*
+	 * Firstly check the sub_rule_index. A -1 indicates no replacement rule
+	 * and a positive number indicates a sub_rule_index.
+	 */
+	if (sub_rule_index < 0) {
+		/*
+		 * If no replacement rule exists then invalidate entries
+		 * associated with this rule.
+		 */
+		memset(&new_tbl24_entry, 0, sizeof(new_tbl24_entry));
+		memset(&new_tbl8_entry, 0, sizeof(new_tbl8_entry));
+		new_tbl8_entry.valid_group = VALID;
+	}
+	else {
+		/*
+		 * If a replacement rule exists then modify entries
+		 * associated with this rule.
+		 */
+		new_tbl24_entry = (struct rte_lpm_tbl_entry) {
+			.next_hop = lpm->rules_tbl[sub_rule_index].next_hop,
+			.valid = VALID,
+			.valid_group = 0,
+			.depth = sub_rule_depth,
+		};
+
+		new_tbl8_entry = (struct rte_lpm_tbl_entry) {
+			.valid = VALID,
+			.valid_group = VALID,
+			.depth = sub_rule_depth,
+			.next_hop = lpm->rules_tbl
+			[sub_rule_index].next_hop,
+		};
+	}
+
+	for (i = tbl24_index; i < (tbl24_index + tbl24_range); i++) {
+
+		if (lpm->tbl24[i].valid_group == 0 &&
+				lpm->tbl24[i].depth <= depth) {
+			tbl_entry_write(&lpm->tbl24[i], new_tbl24_entry);
+		}
+		else if (lpm->tbl24[i].valid_group == 1) {
+			/*
+			 * If TBL24 entry is extended, then there has
+			 * to be a rule with depth >= 25 in the
+			 * associated TBL8 group.
+			 */
+
+			tbl8_group_index = lpm->tbl24[i].next_hop;
+			tbl8_index = tbl8_group_index *
+					RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+
+			for (j = tbl8_index; j < (tbl8_index +
+				RTE_LPM_TBL8_GROUP_NUM_ENTRIES); j++) {
+
+				if (lpm->tbl8[j].depth <= depth)
+					tbl_entry_write(&lpm->tbl8[j],
+							new_tbl8_entry);
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Checks if table 8 group can be recycled.
+ *
+ * Return of -EEXIST means tbl8 is in use and thus can not be recycled.
+ * Return of -EINVAL means tbl8 is empty and thus can be recycled
+ * Return of value > -1 means tbl8 is in use but has all the same values and
+ * thus can be recycled
+ */
+static inline int32_t
+tbl8_recycle_check(struct rte_lpm_tbl_entry *tbl8, uint32_t tbl8_group_start)
+{
+	uint32_t tbl8_group_end, i;
+	tbl8_group_end = tbl8_group_start + RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+
+	/*
+	 * Check the first entry of the given tbl8. If it is invalid we know
+	 * this tbl8 does not contain any rule with a depth < RTE_LPM_MAX_DEPTH
+	 *  (As they would affect all entries in a tbl8) and thus this table
+	 *  can not be recycled.
+	 */
+	if (tbl8[tbl8_group_start].valid) {
+		/*
+		 * If first entry is valid check if the depth is less than 24
+		 * and if so check the rest of the entries to verify that they
+		 * are all of this depth.
+		 */
+		if (tbl8[tbl8_group_start].depth < MAX_DEPTH_TBL24) {
+			for (i = (tbl8_group_start + 1); i < tbl8_group_end;
+					i++) {
+
+				if (tbl8[i].depth !=
+						tbl8[tbl8_group_start].depth) {
+
+					return -EEXIST;
+				}
+			}
+			/* If all entries are the same return the tb8 index */
+			return tbl8_group_start;
+		}
+
+		return -EEXIST;
+	}
+	/*
+	 * If the first entry is invalid check if the rest of the entries in
+	 * the tbl8 are invalid.
+	 */
+	for (i = (tbl8_group_start + 1); i < tbl8_group_end; i++) {
+		if (tbl8[i].valid)
+			return -EEXIST;
+	}
+	/* If no valid entries are found then return -EINVAL. */
+	return -EINVAL;
+}
+
+static inline int32_t
+delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
+	uint8_t depth, int32_t sub_rule_index, uint8_t sub_rule_depth)
+{
+	uint32_t tbl24_index, tbl8_group_index, tbl8_group_start, tbl8_index,
+			tbl8_range, i;
+	int32_t tbl8_recycle_index;
+	struct rte_lpm_tbl_entry new_tbl8_entry;
+
+	/*
+	 * Calculate the index into tbl24 and range. Note: All depths larger
+	 * than MAX_DEPTH_TBL24 are associated with only one tbl24 entry.
+	 */
+	tbl24_index = ip_masked >> 8;
+
+	/* Calculate the index into tbl8 and range. */
+	tbl8_group_index = lpm->tbl24[tbl24_index].next_hop;
+	tbl8_group_start = tbl8_group_index * RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
+	tbl8_index = tbl8_group_start + (ip_masked & 0xFF);
+	tbl8_range = depth_to_range(depth);
+
+	if (sub_rule_index < 0) {
+		/* Invalidate the entries, the group stays allocated. */
+		memset(&new_tbl8_entry, 0, sizeof(new_tbl8_entry));
+		new_tbl8_entry.valid_group = VALID;
+	}
+	else {
+		/* Set new tbl8 entry. */
+		new_tbl8_entry = (struct rte_lpm_tbl_entry) {
+			.valid = VALID,
+			.depth = sub_rule_depth,
+			.valid_group = VALID,
+			.next_hop = lpm->rules_tbl[sub_rule_index].next_hop,
+		};
+	}
+
+	/*
+	 * Loop through the range of entries on tbl8 for which the
+	 * rule_to_delete must be removed or modified.
+	 */
+	for (i = tbl8_index; i < (tbl8_index + tbl8_range); i++) {
+		if (lpm->tbl8[i].depth <= depth)
+			tbl_entry_write(&lpm->tbl8[i], new_tbl8_entry);
+	}
+
+	/*
+	 * Check if there are any valid entries in this tbl8 group. If all
+	 * tbl8 entries are invalid we can free the tbl8 and invalidate the
+	 * associated tbl24 entry.
+	 */
+
+	tbl8_recycle_index = tbl8_recycle_check(lpm->tbl8, tbl8_group_start);
+
+	if (tbl8_recycle_index == -EINVAL){
+		struct rte_lpm_tbl_entry new_tbl24_entry = {
+			.next_hop = 0,
+			.valid = INVALID,
+			.valid_group = 0,
+			.depth = 0,
+		};
+
+		/* Set tbl24 before freeing tbl8 to avoid race condition. */
+		tbl_entry_write(&lpm->tbl24[tbl24_index], new_tbl24_entry);
+		tbl8_free(lpm, tbl8_group_start);
+	}
+	else if (tbl8_recycle_index > -1) {
+		/* Update tbl24 entry. */
+		struct rte_lpm_tbl_entry new_tbl24_entry = {
+			.next_hop = lpm->tbl8[tbl8_recycle_index].next_hop,
+			.valid = VALID,
+			.valid_group = 0,
+			.depth = lpm->tbl8[tbl8_recycle_index].depth,
+		};
+
+		/* Set tbl24 before freeing tbl8 to avoid race condition. */
+		tbl_entry_write(&lpm->tbl24[tbl24_index], new_tbl24_entry);
+		tbl8_free(lpm, tbl8_group_start);
+	}
+
+	return 0;
+}
+
+/*
+ * Deletes a rule
+ */
+int __vsym
+rte_lpm_delete_v21(struct rte_lpm *lpm, uint32_t ip, uint8_t depth)
+{
+	int32_t rule_to_delete_index, sub_rule_index;
+	uint32_t ip_masked;
+	uint8_t sub_rule_depth;
+	/*
+	 * Check input arguments. Note: IP must be a positive integer of 32
+	 * bits in length therefore it need not be checked.
+	 */
+	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM_MAX_DEPTH)) {
+		return -EINVAL;
+	}
+
+	ip_masked = ip & depth_to_mask(depth);
+
+	/*
+	 * Find the index of the input rule, that needs to be deleted, in the
+	 * rule table.
+	 */
+	rule_to_delete_index = rule_find(lpm, ip_masked, depth);
+
+	/*
+	 * Check if rule_to_delete_index was found. If no rule was found the
+	 * function rule_find returns -EINVAL.
+	 */
+	if (rule_to_delete_index < 0)
+		return -EINVAL;
+
+	/* Delete the rule from the rule table. */
+	rule_delete(lpm, rule_to_delete_index, depth);
+
+	/*
+	 * Find rule to replace the rule_to_delete. If there is no rule to
+	 * replace the rule_to_delete we return -1 and invalidate the table
+	 * entries associated with this rule.
+	 */
+	sub_rule_depth = 0;
+	sub_rule_index = find_previous_rule(lpm, ip, depth, &sub_rule_depth);
+
+	/*
+	 * If the input depth value is less than 25 use function
+	 * delete_depth_small otherwise use delete_depth_big.
+	 */
+	if (depth <= MAX_DEPTH_TBL24) {
+		return delete_depth_small(lpm, ip_masked, depth,
+				sub_rule_index, sub_rule_depth);
+	}
+	else { /* If depth > MAX_DEPTH_TBL24 */
+		return delete_depth_big(lpm, ip_masked, depth, sub_rule_index, sub_rule_depth);
+	}
+}
+BIND_DEFAULT_SYMBOL(rte_lpm_delete, _v21, 2.1);
+MAP_STATIC_SYMBOL(int rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip,
+		uint8_t depth), rte_lpm_delete_v21);
+
+/*
+ * Delete all rules from the LPM table.
+ */
+void __vsym
+rte_lpm_delete_all_v21(struct rte_lpm *lpm)
+{
+	/* Zero rule information. */
+	memset(lpm->rule_info, 0, sizeof(lpm->rule_info));
+
+	/* Zero tbl24. */
+	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
+
+	/* Zero tbl8. */
+	memset(lpm->tbl8, 0, sizeof(lpm->tbl8[0])
+			* RTE_LPM_TBL8_GROUP_NUM_ENTRIES * lpm->number_tbl8s);
+
+	/* Delete all rules form the rules table. */
+	memset(lpm->rules_tbl, 0, sizeof(lpm->rules_tbl[0]) * lpm->max_rules);
+
+	/* All tbl8 groups are free, no lookup is running. */
+	lpm->pending_head = 0;
+	lpm->pending_tail = 0;
+	lpm->tbl8_free_hint = 0;
+}
+BIND_DEFAULT_SYMBOL(rte_lpm_delete_all, _v21, 2.1);
+MAP_STATIC_SYMBOL(void rte_lpm_delete_all(struct rte_lpm *lpm),
+		rte_lpm_delete_all_v21);
+
+/*
+ * Applies a batch of route updates
+ */
+int
+rte_lpm_update_bulk(struct rte_lpm *lpm, const struct rte_lpm_update *updates,
+		unsigned n)
+{
+	unsigned i;
+	int ret = 0;
+
+	/* Check user arguments. */
+	if ((lpm == NULL) || (updates == NULL && n != 0))
+		return -EINVAL;
+
+	for (i = 0; i < n; i++) {
+		switch (updates[i].op) {
+		case RTE_LPM_UPDATE_ADD:
+			ret = rte_lpm_add_v21(lpm, updates[i].ip,
+					updates[i].depth, updates[i].next_hop);
+			break;
+		case RTE_LPM_UPDATE_DELETE:
+			ret = rte_lpm_delete_v21(lpm, updates[i].ip,
+					updates[i].depth);
+			break;
+		default:
+			ret = -EINVAL;
+			break;
+		}
+
+		if (ret < 0) {
+			rte_errno = -ret;
+			break;
+		}
+	}
+
+	/* Make the groups freed by the batch available as soon as possible. */
+	tbl8_reclaim(lpm);
+
+	return i;
+}
+
+/*
+ * Registers an lcore doing lookups
+ */
+int
+rte_lpm_reader_register(struct rte_lpm *lpm, unsigned lcore_id)
+{
+	/* Check user arguments. */
+	if ((lpm == NULL) || (lcore_id >= RTE_MAX_LCORE))
+		return -EINVAL;
+
+	lpm->readers[lcore_id].epoch = lpm->epoch;
+
+	/* The writer must see the state before the first lookup is done. */
+	rte_mb();
+
+	return 0;
+}
+
+/*
+ * Unregisters an lcore doing lookups
+ */
+void
+rte_lpm_reader_unregister(struct rte_lpm *lpm, unsigned lcore_id)
+{
+	/* Check user arguments. */
+	if ((lpm == NULL) || (lcore_id >= RTE_MAX_LCORE))
+		return;
+
+	/* The last lookups must be done before the state is cleared. */
+	rte_mb();
+
+	lpm->readers[lcore_id].epoch = 0;
+}
+
+/*
+ * Compatibility with the DPDK 2.0 ABI: tables created by binaries built
+ * against it use 8-bit next hops and a fixed number of tbl8 groups, and
+ * are looked up by the inline functions of the 2.0 header.
+ */
+
+/** @internal Tbl24 entry structure of the 2.0 ABI. */
+struct rte_lpm_tbl24_entry_v20 {
+	/* Stores Next hop or group index (i.e. gindex)into tbl8. */
+	union {
+		uint8_t next_hop;
+		uint8_t tbl8_gindex;
+	};
+	/* Using single uint8_t to store 3 values. */
+	uint8_t valid     :1; /**< Validation flag. */
+	uint8_t ext_entry :1; /**< External entry. */
+	uint8_t depth     :6; /**< Rule depth. */
+};
+
+/** @internal Tbl8 entry structure of the 2.0 ABI. */
+struct rte_lpm_tbl8_entry_v20 {
+	uint8_t next_hop; /**< next hop. */
+	/* Using single uint8_t to store 3 values. */
+	uint8_t valid       :1; /**< Validation flag. */
+	uint8_t valid_group :1; /**< Group validation flag. */
+	uint8_t depth       :6; /**< Rule depth. */
+};
+
+/** @internal Rule structure of the 2.0 ABI. */
+struct rte_lpm_rule_v20 {
+	uint32_t ip; /**< Rule IP address. */
+	uint8_t  next_hop; /**< Rule next hop. */
+};
+
+/** @internal LPM structure of the 2.0 ABI. */
+struct rte_lpm_v20 {
+	/* LPM metadata. */
+	char name[RTE_LPM_NAMESIZE];        /**< Name of the lpm. */
+	int mem_location; /**< @deprecated @see RTE_LPM_HEAP and RTE_LPM_MEMZONE. */
+	uint32_t max_rules; /**< Max. balanced rules per lpm. */
+	struct rte_lpm_rule_info rule_info[RTE_LPM_MAX_DEPTH]; /**< Rule info table. */
+
+	/* LPM Tables. */
+	struct rte_lpm_tbl24_entry_v20 tbl24[RTE_LPM_TBL24_NUM_ENTRIES] \
+			__rte_cache_aligned; /**< LPM tbl24 table. */
+	struct rte_lpm_tbl8_entry_v20 tbl8[RTE_LPM_TBL8_NUM_GROUPS *
+			RTE_LPM_TBL8_GROUP_NUM_ENTRIES] \
+			__rte_cache_aligned; /**< LPM tbl8 table. */
+	struct rte_lpm_rule_v20 rules_tbl[0] \
+			__rte_cache_aligned; /**< LPM rules. */
+};
+
+struct rte_lpm_v20 *rte_lpm_create_v20(const char *name, int socket_id,
+		int max_rules, int flags);
+void rte_lpm_free_v20(struct rte_lpm_v20 *lpm);
+int rte_lpm_add_v20(struct rte_lpm_v20 *lpm, uint32_t ip, uint8_t depth,
+		uint8_t next_hop);
+int rte_lpm_is_rule_present_v20(struct rte_lpm_v20 *lpm, uint32_t ip,
+		uint8_t depth, uint8_t *next_hop);
+int rte_lpm_delete_v20(struct rte_lpm_v20 *lpm, uint32_t ip, uint8_t depth);
+void rte_lpm_delete_all_v20(struct rte_lpm_v20 *lpm);
+
 /*
  * Allocates memory for LPM object
  */
-struct rte_lpm *
-rte_lpm_create(const char *name, int socket_id, int max_rules,
+struct rte_lpm_v20 * __vsym
+rte_lpm_create_v20(const char *name, int socket_id, int max_rules,
 		__rte_unused int flags)
 {
 	char mem_name[RTE_LPM_NAMESIZE];
-	struct rte_lpm *lpm = NULL;
+	struct rte_lpm_v20 *lpm = NULL;
 	struct rte_tailq_entry *te;
 	uint32_t mem_size;
 	struct rte_lpm_list *lpm_list;
 
 	lpm_list = RTE_TAILQ_CAST(rte_lpm_tailq.head, rte_lpm_list);
 
-	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl24_entry) != 2);
-	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl8_entry) != 2);
+	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl24_entry_v20) != 2);
+	RTE_BUILD_BUG_ON(sizeof(struct rte_lpm_tbl8_entry_v20) != 2);
 
 	/* Check user arguments. */
 	if ((name == NULL) || (socket_id < -1) || (max_rules == 0)){
@@ -177,7 +1346,7 @@ rte_lpm_create(const char *name, int socket_id, int max_rules,
 
 	/* guarantee there's no existing */
 	TAILQ_FOREACH(te, lpm_list, next) {
-		lpm = (struct rte_lpm *) te->data;
+		lpm = (struct rte_lpm_v20 *) te->data;
 		if (strncmp(name, lpm->name, RTE_LPM_NAMESIZE) == 0)
 			break;
 	}
@@ -192,7 +1361,7 @@ rte_lpm_create(const char *name, int socket_id, int max_rules,
 	}
 
 	/* Allocate memory to store the LPM data structures. */
-	lpm = (struct rte_lpm *)rte_zmalloc_socket(mem_name, mem_size,
+	lpm = (struct rte_lpm_v20 *)rte_zmalloc_socket(mem_name, mem_size,
 			RTE_CACHE_LINE_SIZE, socket_id);
 	if (lpm == NULL) {
 		RTE_LOG(ERR, LPM, "LPM memory allocation failed\n");
@@ -213,12 +1382,13 @@ exit:
 
 	return lpm;
 }
+VERSION_SYMBOL(rte_lpm_create, _v20, 2.0);
 
 /*
  * Deallocates memory for given LPM table.
  */
-void
-rte_lpm_free(struct rte_lpm *lpm)
+void __vsym
+rte_lpm_free_v20(struct rte_lpm_v20 *lpm)
 {
 	struct rte_lpm_list *lpm_list;
 	struct rte_tailq_entry *te;
@@ -248,6 +1418,7 @@ rte_lpm_free(struct rte_lpm *lpm)
 	rte_free(lpm);
 	rte_free(te);
 }
+VERSION_SYMBOL(rte_lpm_free, _v20, 2.0);
 
 /*
  * Adds a rule to the rule table.
@@ -260,7 +1431,7 @@ rte_lpm_free(struct rte_lpm *lpm)
  * NOTE: Valid range for depth parameter is 1 .. 32 inclusive.
  */
 static inline int32_t
-rule_add(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
+rule_add_v20(struct rte_lpm_v20 *lpm, uint32_t ip_masked, uint8_t depth,
 	uint8_t next_hop)
 {
 	uint32_t rule_gindex, rule_index, last_rule;
@@ -333,7 +1504,7 @@ rule_add(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
  * NOTE: Valid range for depth parameter is 1 .. 32 inclusive.
  */
 static inline void
-rule_delete(struct rte_lpm *lpm, int32_t rule_index, uint8_t depth)
+rule_delete_v20(struct rte_lpm_v20 *lpm, int32_t rule_index, uint8_t depth)
 {
 	int i;
 
@@ -358,7 +1529,7 @@ rule_delete(struct rte_lpm *lpm, int32_t rule_index, uint8_t depth)
  * NOTE: Valid range for depth parameter is 1 .. 32 inclusive.
  */
 static inline int32_t
-rule_find(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth)
+rule_find_v20(struct rte_lpm_v20 *lpm, uint32_t ip_masked, uint8_t depth)
 {
 	uint32_t rule_gindex, last_rule, rule_index;
 
@@ -382,10 +1553,10 @@ rule_find(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth)
  * Find, clean and allocate a tbl8.
  */
 static inline int32_t
-tbl8_alloc(struct rte_lpm_tbl8_entry *tbl8)
+tbl8_alloc_v20(struct rte_lpm_tbl8_entry_v20 *tbl8)
 {
 	uint32_t tbl8_gindex; /* tbl8 group index. */
-	struct rte_lpm_tbl8_entry *tbl8_entry;
+	struct rte_lpm_tbl8_entry_v20 *tbl8_entry;
 
 	/* Scan through tbl8 to find a free (i.e. INVALID) tbl8 group. */
 	for (tbl8_gindex = 0; tbl8_gindex < RTE_LPM_TBL8_NUM_GROUPS;
@@ -410,14 +1581,14 @@ tbl8_alloc(struct rte_lpm_tbl8_entry *tbl8)
 }
 
 static inline void
-tbl8_free(struct rte_lpm_tbl8_entry *tbl8, uint32_t tbl8_group_start)
+tbl8_free_v20(struct rte_lpm_tbl8_entry_v20 *tbl8, uint32_t tbl8_group_start)
 {
 	/* Set tbl8 group invalid*/
 	tbl8[tbl8_group_start].valid_group = INVALID;
 }
 
 static inline int32_t
-add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
+add_depth_small_v20(struct rte_lpm_v20 *lpm, uint32_t ip, uint8_t depth,
 		uint8_t next_hop)
 {
 	uint32_t tbl24_index, tbl24_range, tbl8_index, tbl8_group_end, i, j;
@@ -434,7 +1605,7 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 		if (!lpm->tbl24[i].valid || (lpm->tbl24[i].ext_entry == 0 &&
 				lpm->tbl24[i].depth <= depth)) {
 
-			struct rte_lpm_tbl24_entry new_tbl24_entry = {
+			struct rte_lpm_tbl24_entry_v20 new_tbl24_entry = {
 				{ .next_hop = next_hop, },
 				.valid = VALID,
 				.ext_entry = 0,
@@ -457,7 +1628,7 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 		for (j = tbl8_index; j < tbl8_group_end; j++) {
 			if (!lpm->tbl8[j].valid ||
 					lpm->tbl8[j].depth <= depth) {
-				struct rte_lpm_tbl8_entry new_tbl8_entry = {
+				struct rte_lpm_tbl8_entry_v20 new_tbl8_entry = {
 					.valid = VALID,
 					.valid_group = VALID,
 					.depth = depth,
@@ -479,7 +1650,7 @@ add_depth_small(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 }
 
 static inline int32_t
-add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
+add_depth_big_v20(struct rte_lpm_v20 *lpm, uint32_t ip_masked, uint8_t depth,
 		uint8_t next_hop)
 {
 	uint32_t tbl24_index;
@@ -491,7 +1662,7 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 
 	if (!lpm->tbl24[tbl24_index].valid) {
 		/* Search for a free tbl8 group. */
-		tbl8_group_index = tbl8_alloc(lpm->tbl8);
+		tbl8_group_index = tbl8_alloc_v20(lpm->tbl8);
 
 		/* Check tbl8 allocation was successful. */
 		if (tbl8_group_index < 0) {
@@ -516,7 +1687,7 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 		 * so assign whole structure in one go
 		 */
 
-		struct rte_lpm_tbl24_entry new_tbl24_entry = {
+		struct rte_lpm_tbl24_entry_v20 new_tbl24_entry = {
 			{ .tbl8_gindex = (uint8_t)tbl8_group_index, },
 			.valid = VALID,
 			.ext_entry = 1,
@@ -528,7 +1699,7 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 	}/* If valid entry but not extended calculate the index into Table8. */
 	else if (lpm->tbl24[tbl24_index].ext_entry == 0) {
 		/* Search for free tbl8 group. */
-		tbl8_group_index = tbl8_alloc(lpm->tbl8);
+		tbl8_group_index = tbl8_alloc_v20(lpm->tbl8);
 
 		if (tbl8_group_index < 0) {
 			return tbl8_group_index;
@@ -567,7 +1738,7 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 		 * so assign whole structure in one go.
 		 */
 
-		struct rte_lpm_tbl24_entry new_tbl24_entry = {
+		struct rte_lpm_tbl24_entry_v20 new_tbl24_entry = {
 				{ .tbl8_gindex = (uint8_t)tbl8_group_index, },
 				.valid = VALID,
 				.ext_entry = 1,
@@ -589,7 +1760,7 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 
 			if (!lpm->tbl8[i].valid ||
 					lpm->tbl8[i].depth <= depth) {
-				struct rte_lpm_tbl8_entry new_tbl8_entry = {
+				struct rte_lpm_tbl8_entry_v20 new_tbl8_entry = {
 					.valid = VALID,
 					.depth = depth,
 					.next_hop = next_hop,
@@ -613,8 +1784,8 @@ add_depth_big(struct rte_lpm *lpm, uint32_t ip_masked, uint8_t depth,
 /*
  * Add a route
  */
-int
-rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
+int __vsym
+rte_lpm_add_v20(struct rte_lpm_v20 *lpm, uint32_t ip, uint8_t depth,
 		uint8_t next_hop)
 {
 	int32_t rule_index, status = 0;
@@ -627,7 +1798,7 @@ rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 	ip_masked = ip & depth_to_mask(depth);
 
 	/* Add the rule to the rule table. */
-	rule_index = rule_add(lpm, ip_masked, depth, next_hop);
+	rule_index = rule_add_v20(lpm, ip_masked, depth, next_hop);
 
 	/* If the is no space available for new rule return error. */
 	if (rule_index < 0) {
@@ -635,17 +1806,17 @@ rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 	}
 
 	if (depth <= MAX_DEPTH_TBL24) {
-		status = add_depth_small(lpm, ip_masked, depth, next_hop);
+		status = add_depth_small_v20(lpm, ip_masked, depth, next_hop);
 	}
 	else { /* If depth > RTE_LPM_MAX_DEPTH_TBL24 */
-		status = add_depth_big(lpm, ip_masked, depth, next_hop);
+		status = add_depth_big_v20(lpm, ip_masked, depth, next_hop);
 
 		/*
 		 * If add fails due to exhaustion of tbl8 extensions delete
 		 * rule that was added to rule table.
 		 */
 		if (status < 0) {
-			rule_delete(lpm, rule_index, depth);
+			rule_delete_v20(lpm, rule_index, depth);
 
 			return status;
 		}
@@ -653,12 +1824,13 @@ rte_lpm_add(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
 
 	return 0;
 }
+VERSION_SYMBOL(rte_lpm_add, _v20, 2.0);
 
 /*
  * Look for a rule in the high-level rules table
  */
-int
-rte_lpm_is_rule_present(struct rte_lpm *lpm, uint32_t ip, uint8_t depth,
+int __vsym
+rte_lpm_is_rule_present_v20(struct rte_lpm_v20 *lpm, uint32_t ip, uint8_t depth,
 uint8_t *next_hop)
 {
 	uint32_t ip_masked;
@@ -672,7 +1844,7 @@ uint8_t *next_hop)
 
 	/* Look for the rule using rule_find. */
 	ip_masked = ip & depth_to_mask(depth);
-	rule_index = rule_find(lpm, ip_masked, depth);
+	rule_index = rule_find_v20(lpm, ip_masked, depth);
 
 	if (rule_index >= 0) {
 		*next_hop = lpm->rules_tbl[rule_index].next_hop;
@@ -682,9 +1854,10 @@ uint8_t *next_hop)
 	/* If rule is not found return 0. */
 	return 0;
 }
+VERSION_SYMBOL(rte_lpm_is_rule_present, _v20, 2.0);
 
 static inline int32_t
-find_previous_rule(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint8_t *sub_rule_depth)
+find_previous_rule_v20(struct rte_lpm_v20 *lpm, uint32_t ip, uint8_t depth, uint8_t *sub_rule_depth)
 {
 	int32_t rule_index;
 	uint32_t ip_masked;
@@ -693,7 +1866,7 @@ find_previous_rule(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint8_t *sub
 	for (prev_depth = (uint8_t)(depth - 1); prev_depth > 0; prev_depth--) {
 		ip_masked = ip & depth_to_mask(prev_depth);
 
-		rule_index = rule_find(lpm, ip_masked, prev_depth);
+		rule_index = rule_find_v20(lpm, ip_masked, prev_depth);
 
 		if (rule_index >= 0) {
 			*sub_rule_depth = prev_depth;
@@ -705,7 +1878,7 @@ find_previous_rule(struct rte_lpm *lpm, uint32_t ip, uint8_t depth, uint8_t *sub
 }
 
 static inline int32_t
-delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
+delete_depth_small_v20(struct rte_lpm_v20 *lpm, uint32_t ip_masked,
 	uint8_t depth, int32_t sub_rule_index, uint8_t sub_rule_depth)
 {
 	uint32_t tbl24_range, tbl24_index, tbl8_group_index, tbl8_index, i, j;
@@ -755,14 +1928,14 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
 		 * associated with this rule.
 		 */
 
-		struct rte_lpm_tbl24_entry new_tbl24_entry = {
+		struct rte_lpm_tbl24_entry_v20 new_tbl24_entry = {
 			{.next_hop = lpm->rules_tbl[sub_rule_index].next_hop,},
 			.valid = VALID,
 			.ext_entry = 0,
 			.depth = sub_rule_depth,
 		};
 
-		struct rte_lpm_tbl8_entry new_tbl8_entry = {
+		struct rte_lpm_tbl8_entry_v20 new_tbl8_entry = {
 			.valid = VALID,
 			.depth = sub_rule_depth,
 			.next_hop = lpm->rules_tbl
@@ -808,7 +1981,7 @@ delete_depth_small(struct rte_lpm *lpm, uint32_t ip_masked,
  * thus can be recycled
  */
 static inline int32_t
-tbl8_recycle_check(struct rte_lpm_tbl8_entry *tbl8, uint32_t tbl8_group_start)
+tbl8_recycle_check_v20(struct rte_lpm_tbl8_entry_v20 *tbl8, uint32_t tbl8_group_start)
 {
 	uint32_t tbl8_group_end, i;
 	tbl8_group_end = tbl8_group_start + RTE_LPM_TBL8_GROUP_NUM_ENTRIES;
@@ -854,7 +2027,7 @@ tbl8_recycle_check(struct rte_lpm_tbl8_entry *tbl8, uint32_t tbl8_group_start)
 }
 
 static inline int32_t
-delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
+delete_depth_big_v20(struct rte_lpm_v20 *lpm, uint32_t ip_masked,
 	uint8_t depth, int32_t sub_rule_index, uint8_t sub_rule_depth)
 {
 	uint32_t tbl24_index, tbl8_group_index, tbl8_group_start, tbl8_index,
@@ -885,7 +2058,7 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 	}
 	else {
 		/* Set new tbl8 entry. */
-		struct rte_lpm_tbl8_entry new_tbl8_entry = {
+		struct rte_lpm_tbl8_entry_v20 new_tbl8_entry = {
 			.valid = VALID,
 			.depth = sub_rule_depth,
 			.valid_group = lpm->tbl8[tbl8_group_start].valid_group,
@@ -908,16 +2081,16 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 	 * associated tbl24 entry.
 	 */
 
-	tbl8_recycle_index = tbl8_recycle_check(lpm->tbl8, tbl8_group_start);
+	tbl8_recycle_index = tbl8_recycle_check_v20(lpm->tbl8, tbl8_group_start);
 
 	if (tbl8_recycle_index == -EINVAL){
 		/* Set tbl24 before freeing tbl8 to avoid race condition. */
 		lpm->tbl24[tbl24_index].valid = 0;
-		tbl8_free(lpm->tbl8, tbl8_group_start);
+		tbl8_free_v20(lpm->tbl8, tbl8_group_start);
 	}
 	else if (tbl8_recycle_index > -1) {
 		/* Update tbl24 entry. */
-		struct rte_lpm_tbl24_entry new_tbl24_entry = {
+		struct rte_lpm_tbl24_entry_v20 new_tbl24_entry = {
 			{ .next_hop = lpm->tbl8[tbl8_recycle_index].next_hop, },
 			.valid = VALID,
 			.ext_entry = 0,
@@ -926,7 +2099,7 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 
 		/* Set tbl24 before freeing tbl8 to avoid race condition. */
 		lpm->tbl24[tbl24_index] = new_tbl24_entry;
-		tbl8_free(lpm->tbl8, tbl8_group_start);
+		tbl8_free_v20(lpm->tbl8, tbl8_group_start);
 	}
 
 	return 0;
@@ -935,8 +2108,8 @@ delete_depth_big(struct rte_lpm *lpm, uint32_t ip_masked,
 /*
  * Deletes a rule
  */
-int
-rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth)
+int __vsym
+rte_lpm_delete_v20(struct rte_lpm_v20 *lpm, uint32_t ip, uint8_t depth)
 {
 	int32_t rule_to_delete_index, sub_rule_index;
 	uint32_t ip_masked;
@@ -955,7 +2128,7 @@ rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth)
 	 * Find the index of the input rule, that needs to be deleted, in the
 	 * rule table.
 	 */
-	rule_to_delete_index = rule_find(lpm, ip_masked, depth);
+	rule_to_delete_index = rule_find_v20(lpm, ip_masked, depth);
 
 	/*
 	 * Check if rule_to_delete_index was found. If no rule was found the
@@ -965,7 +2138,7 @@ rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth)
 		return -EINVAL;
 
 	/* Delete the rule from the rule table. */
-	rule_delete(lpm, rule_to_delete_index, depth);
+	rule_delete_v20(lpm, rule_to_delete_index, depth);
 
 	/*
 	 * Find rule to replace the rule_to_delete. If there is no rule to
@@ -973,26 +2146,27 @@ rte_lpm_delete(struct rte_lpm *lpm, uint32_t ip, uint8_t depth)
 	 * entries associated with this rule.
 	 */
 	sub_rule_depth = 0;
-	sub_rule_index = find_previous_rule(lpm, ip, depth, &sub_rule_depth);
+	sub_rule_index = find_previous_rule_v20(lpm, ip, depth, &sub_rule_depth);
 
 	/*
 	 * If the input depth value is less than 25 use function
 	 * delete_depth_small otherwise use delete_depth_big.
 	 */
 	if (depth <= MAX_DEPTH_TBL24) {
-		return delete_depth_small(lpm, ip_masked, depth,
+		return delete_depth_small_v20(lpm, ip_masked, depth,
 				sub_rule_index, sub_rule_depth);
 	}
 	else { /* If depth > MAX_DEPTH_TBL24 */
-		return delete_depth_big(lpm, ip_masked, depth, sub_rule_index, sub_rule_depth);
+		return delete_depth_big_v20(lpm, ip_masked, depth, sub_rule_index, sub_rule_depth);
 	}
 }
+VERSION_SYMBOL(rte_lpm_delete, _v20, 2.0);
 
 /*
  * Delete all rules from the LPM table.
  */
-void
-rte_lpm_delete_all(struct rte_lpm *lpm)
+void __vsym
+rte_lpm_delete_all_v20(struct rte_lpm_v20 *lpm)
 {
 	/* Zero rule information. */
 	memset(lpm->rule_info, 0, sizeof(lpm->rule_info));
@@ -1006,4 +2180,5 @@ rte_lpm_delete_all(struct rte_lpm *lpm)
 	/* Delete all rules form the rules table. */
 	memset(lpm->rules_tbl, 0, sizeof(lpm->rules_tbl[0]) * lpm->max_rules);
 }
+VERSION_SYMBOL(rte_lpm_delete_all, _v20, 2.0);
 
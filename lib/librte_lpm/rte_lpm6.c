@@ -52,6 +52,9 @@
 #include <rte_errno.h>
 #include <rte_rwlock.h>
 #include <rte_spinlock.h>
+#include <rte_atomic.h>
+#include <rte_lcore.h>
+#include <rte_prefetch.h>
 
 #include "rte_lpm6.h"
 
@@ -68,6 +71,9 @@
 #define BYTE_SIZE                                 8
 #define BYTES2_SIZE                              16
 
+/* Number of lookups progressing together in rte_lpm6_lookup_bulk_func(). */
+#define LOOKUP_BULK_BATCH                         16
+
 #define lpm6_tbl8_gindex next_hop
 
 /** Flags for setting an entry as valid/invalid. */
@@ -101,6 +107,18 @@ struct rte_lpm6_rule {
 	uint8_t depth; /**< Rule depth. */
 };
 
+/** Reader state, see rte_lpm6_reader_quiescent(). */
+struct rte_lpm6_reader {
+	/** Writer epoch seen at the last quiescent state, 0 if unregistered. */
+	volatile uint64_t epoch;
+} __rte_cache_aligned;
+
+/** tbl8 group unlinked from the tables, waiting to be reused. */
+struct rte_lpm6_tbl8_pending {
+	uint32_t group_index; /**< Index of the tbl8 group. */
+	uint64_t epoch;       /**< Writer epoch at which it was unlinked. */
+};
+
 /** LPM6 structure. */
 struct rte_lpm6 {
 	/* LPM metadata. */
@@ -108,7 +126,15 @@ struct rte_lpm6 {
 	uint32_t max_rules;              /**< Max number of rules. */
 	uint32_t used_rules;             /**< Used rules so far. */
 	uint32_t number_tbl8s;           /**< Number of tbl8s to allocate. */
-	uint32_t next_tbl8;              /**< Next tbl8 to be used. */
+	uint32_t free_tbl8s;             /**< Number of free tbl8s. */
+	uint32_t *tbl8_free;             /**< Stack of free tbl8s. */
+
+	/* Deferred reuse of the tbl8 groups. */
+	volatile uint64_t epoch;         /**< Writer epoch, bumped on unlink. */
+	uint32_t pending_head;           /**< Next slot of tbl8_pending. */
+	uint32_t pending_tail;           /**< Oldest slot of tbl8_pending. */
+	struct rte_lpm6_tbl8_pending *tbl8_pending; /**< Unlinked tbl8s. */
+	struct rte_lpm6_reader readers[RTE_MAX_LCORE]; /**< Reader states. */
 
 	/* LPM Tables. */
 	struct rte_lpm6_rule *rules_tbl; /**< LPM rules. */
@@ -142,6 +168,37 @@ mask_ip(uint8_t *ip, uint8_t depth)
 		}
 }
 
+/*
+ * Writes a tbl24 or tbl8 entry with a single store, so that a concurrent
+ * lookup reads either the previous or the new entry.
+ */
+static inline void
+tbl_entry_write(struct rte_lpm6_tbl_entry *dst, struct rte_lpm6_tbl_entry src)
+{
+	union {
+		struct rte_lpm6_tbl_entry entry;
+		uint32_t u32;
+	} v = { .entry = src };
+
+	*(volatile uint32_t *)dst = v.u32;
+}
+
+/*
+ * Initializes the stack of free tbl8 groups, so that they are allocated
+ * in increasing order.
+ */
+static void
+tbl8_free_init(struct rte_lpm6 *lpm)
+{
+	uint32_t i;
+
+	for (i = 0; i < lpm->number_tbl8s; i++)
+		lpm->tbl8_free[i] = lpm->number_tbl8s - 1 - i;
+	lpm->free_tbl8s = lpm->number_tbl8s;
+	lpm->pending_head = 0;
+	lpm->pending_tail = 0;
+}
+
 /*
  * Allocates memory for LPM object
  */
@@ -152,7 +209,7 @@ rte_lpm6_create(const char *name, int socket_id,
 	char mem_name[RTE_LPM6_NAMESIZE];
 	struct rte_lpm6 *lpm = NULL;
 	struct rte_tailq_entry *te;
-	uint64_t mem_size, rules_size;
+	uint64_t mem_size, rules_size, free_size, pending_size;
 	struct rte_lpm6_list *lpm_list;
 
 	lpm_list = RTE_TAILQ_CAST(rte_lpm6_tailq.head, rte_lpm6_list);
@@ -173,6 +230,10 @@ rte_lpm6_create(const char *name, int socket_id,
 	mem_size = sizeof(*lpm) + (sizeof(lpm->tbl8[0]) *
 			RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * config->number_tbl8s);
 	rules_size = sizeof(struct rte_lpm6_rule) * config->max_rules;
+	free_size = sizeof(uint32_t) * (config->number_tbl8s + 1);
+	/* One more slot than groups, so that a full list is not empty. */
+	pending_size = sizeof(struct rte_lpm6_tbl8_pending) *
+			(config->number_tbl8s + 1);
 
 	rte_rwlock_write_lock(RTE_EAL_TAILQ_RWLOCK);
 
@@ -208,6 +269,24 @@ rte_lpm6_create(const char *name, int socket_id,
 	if (lpm->rules_tbl == NULL) {
 		RTE_LOG(ERR, LPM, "LPM memory allocation failed\n");
 		rte_free(lpm);
+		lpm = NULL;
+		rte_free(te);
+		goto exit;
+	}
+
+	lpm->tbl8_free = (uint32_t *)rte_zmalloc_socket(NULL,
+			(size_t)free_size, RTE_CACHE_LINE_SIZE, socket_id);
+	lpm->tbl8_pending = (struct rte_lpm6_tbl8_pending *)rte_zmalloc_socket(
+			NULL, (size_t)pending_size, RTE_CACHE_LINE_SIZE,
+			socket_id);
+
+	if (lpm->tbl8_free == NULL || lpm->tbl8_pending == NULL) {
+		RTE_LOG(ERR, LPM, "LPM memory allocation failed\n");
+		rte_free(lpm->tbl8_pending);
+		rte_free(lpm->tbl8_free);
+		rte_free(lpm->rules_tbl);
+		rte_free(lpm);
+		lpm = NULL;
 		rte_free(te);
 		goto exit;
 	}
@@ -215,6 +294,9 @@ rte_lpm6_create(const char *name, int socket_id,
 	/* Save user arguments. */
 	lpm->max_rules = config->max_rules;
 	lpm->number_tbl8s = config->number_tbl8s;
+	tbl8_free_init(lpm);
+	/* Epoch 0 stands for an unregistered reader. */
+	lpm->epoch = 1;
 	snprintf(lpm->name, sizeof(lpm->name), "%s", name);
 
 	te->data = (void *) lpm;
@@ -286,6 +368,9 @@ rte_lpm6_free(struct rte_lpm6 *lpm)
 
 	rte_rwlock_write_unlock(RTE_EAL_TAILQ_RWLOCK);
 
+	rte_free(lpm->tbl8_pending);
+	rte_free(lpm->tbl8_free);
+	rte_free(lpm->rules_tbl);
 	rte_free(lpm);
 	rte_free(te);
 }
@@ -331,6 +416,85 @@ rule_add(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t next_hop, uint8_t depth)
 	return rule_index;
 }
 
+/*
+ * Makes the tbl8 groups unlinked before all the registered readers went
+ * through a quiescent state available again.
+ * Returns the number of groups made available.
+ */
+static uint32_t
+tbl8_reclaim(struct rte_lpm6 *lpm)
+{
+	const struct rte_lpm6_tbl8_pending *pending;
+	uint64_t epoch, reader_epoch;
+	uint32_t n = 0;
+	unsigned i;
+
+	if (lpm->pending_tail == lpm->pending_head)
+		return 0;
+
+	/* Find the oldest epoch a reader may still be in. */
+	epoch = lpm->epoch;
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		reader_epoch = lpm->readers[i].epoch;
+		if (reader_epoch != 0 && reader_epoch < epoch)
+			epoch = reader_epoch;
+	}
+
+	/* Groups are queued in increasing epoch order. */
+	while (lpm->pending_tail != lpm->pending_head) {
+		pending = &lpm->tbl8_pending[lpm->pending_tail];
+		if (pending->epoch > epoch)
+			break;
+
+		/* Free groups are kept clean to be linked right away. */
+		memset(&lpm->tbl8[pending->group_index *
+				RTE_LPM6_TBL8_GROUP_NUM_ENTRIES], 0,
+				sizeof(lpm->tbl8[0]) *
+				RTE_LPM6_TBL8_GROUP_NUM_ENTRIES);
+		lpm->tbl8_free[lpm->free_tbl8s++] = pending->group_index;
+
+		if (++lpm->pending_tail > lpm->number_tbl8s)
+			lpm->pending_tail = 0;
+		n++;
+	}
+
+	return n;
+}
+
+/*
+ * Allocates a clean tbl8 group.
+ */
+static inline int32_t
+tbl8_alloc(struct rte_lpm6 *lpm)
+{
+	/* Retry with the unlinked groups no reader can access any more. */
+	if (lpm->free_tbl8s == 0 && tbl8_reclaim(lpm) == 0)
+		return -ENOSPC;
+
+	return lpm->tbl8_free[--lpm->free_tbl8s];
+}
+
+/*
+ * Frees a tbl8 group, once unlinked from the tables.
+ */
+static inline void
+tbl8_free(struct rte_lpm6 *lpm, uint32_t tbl8_gindex)
+{
+	struct rte_lpm6_tbl8_pending *pending;
+
+	/*
+	 * Lookups started before the unlink may still read the group: it
+	 * is queued until tbl8_reclaim() finds that all the readers went
+	 * through a quiescent state since.
+	 */
+	lpm->epoch++;
+	pending = &lpm->tbl8_pending[lpm->pending_head];
+	pending->group_index = tbl8_gindex;
+	pending->epoch = lpm->epoch;
+	if (++lpm->pending_head > lpm->number_tbl8s)
+		lpm->pending_head = 0;
+}
+
 /*
  * Function that expands a rule across the data structure when a less-generic
  * one has been added before. It assures that every possible combination of bits
@@ -356,7 +520,7 @@ expand_rule(struct rte_lpm6 *lpm, uint32_t tbl8_gindex, uint8_t depth,
 		if (!lpm->tbl8[j].valid || (lpm->tbl8[j].ext_entry == 0
 				&& lpm->tbl8[j].depth <= depth)) {
 
-			lpm->tbl8[j] = new_tbl8_entry;
+			tbl_entry_write(&lpm->tbl8[j], new_tbl8_entry);
 
 		} else if (lpm->tbl8[j].ext_entry == 1) {
 
@@ -367,6 +531,27 @@ expand_rule(struct rte_lpm6 *lpm, uint32_t tbl8_gindex, uint8_t depth,
 	}
 }
 
+/*
+ * Calculates index to the table based on the number and position
+ * of the bytes being inspected in a step.
+ */
+static inline uint32_t
+step_tbl_index(const uint8_t *ip, uint8_t bytes, uint8_t first_byte)
+{
+	uint32_t tbl_index, i;
+	int8_t bitshift;
+
+	tbl_index = 0;
+	for (i = first_byte; i < (uint32_t)(first_byte + bytes); i++) {
+		bitshift = (int8_t)((bytes - i)*BYTE_SIZE);
+
+		if (bitshift < 0) bitshift = 0;
+		tbl_index = tbl_index | ip[i-1] << bitshift;
+	}
+
+	return tbl_index;
+}
+
 /*
  * Partially adds a new route to the data structure (tbl24+tbl8s).
  * It returns 0 on success, a negative number on failure, or 1 if
@@ -379,20 +564,9 @@ add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
 {
 	uint32_t tbl_index, tbl_range, tbl8_group_start, tbl8_group_end, i;
 	int32_t tbl8_gindex;
-	int8_t bitshift;
 	uint8_t bits_covered;
 
-	/*
-	 * Calculate index to the table based on the number and position
-	 * of the bytes being inspected in this step.
-	 */
-	tbl_index = 0;
-	for (i = first_byte; i < (uint32_t)(first_byte + bytes); i++) {
-		bitshift = (int8_t)((bytes - i)*BYTE_SIZE);
-
-		if (bitshift < 0) bitshift = 0;
-		tbl_index = tbl_index | ip[i-1] << bitshift;
-	}
+	tbl_index = step_tbl_index(ip, bytes, first_byte);
 
 	/* Number of bits covered in this step */
 	bits_covered = (uint8_t)((bytes+first_byte-1)*BYTE_SIZE);
@@ -416,7 +590,7 @@ add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
 					.ext_entry = 0,
 				};
 
-				tbl[i] = new_tbl_entry;
+				tbl_entry_write(&tbl[i], new_tbl_entry);
 
 			} else if (tbl[i].ext_entry == 1) {
 
@@ -437,12 +611,14 @@ add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
 	 * and calculate the index to the next table.
 	 */
 	else {
-		/* If it's invalid a new tbl8 is needed */
+		/*
+		 * If it's invalid a new tbl8 is needed, lookups find no
+		 * match in it until it is filled.
+		 */
 		if (!tbl[tbl_index].valid) {
-			if (lpm->next_tbl8 < lpm->number_tbl8s)
-				tbl8_gindex = (lpm->next_tbl8)++;
-			else
-				return -ENOSPC;
+			tbl8_gindex = tbl8_alloc(lpm);
+			if (tbl8_gindex < 0)
+				return tbl8_gindex;
 
 			struct rte_lpm6_tbl_entry new_tbl_entry = {
 				.lpm6_tbl8_gindex = tbl8_gindex,
@@ -452,7 +628,7 @@ add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
 				.ext_entry = 1,
 			};
 
-			tbl[tbl_index] = new_tbl_entry;
+			tbl_entry_write(&tbl[tbl_index], new_tbl_entry);
 		}
 		/*
 		 * If it's valid but not extended the rule that was stored *
@@ -460,23 +636,26 @@ add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
 		 */
 		else if (tbl[tbl_index].ext_entry == 0) {
 			/* Search for free tbl8 group. */
-			if (lpm->next_tbl8 < lpm->number_tbl8s)
-				tbl8_gindex = (lpm->next_tbl8)++;
-			else
-				return -ENOSPC;
+			tbl8_gindex = tbl8_alloc(lpm);
+			if (tbl8_gindex < 0)
+				return tbl8_gindex;
 
 			tbl8_group_start = tbl8_gindex *
 					RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
 			tbl8_group_end = tbl8_group_start +
 					RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
 
+			struct rte_lpm6_tbl_entry tbl_tbl8_entry = {
+				.next_hop = tbl[tbl_index].next_hop,
+				.depth = tbl[tbl_index].depth,
+				.valid = VALID,
+				.valid_group = VALID,
+				.ext_entry = 0,
+			};
+
 			/* Populate new tbl8 with tbl value. */
-			for (i = tbl8_group_start; i < tbl8_group_end; i++) {
-				lpm->tbl8[i].valid = VALID;
-				lpm->tbl8[i].depth = tbl[tbl_index].depth;
-				lpm->tbl8[i].next_hop = tbl[tbl_index].next_hop;
-				lpm->tbl8[i].ext_entry = 0;
-			}
+			for (i = tbl8_group_start; i < tbl8_group_end; i++)
+				tbl_entry_write(&lpm->tbl8[i], tbl_tbl8_entry);
 
 			/*
 			 * Update tbl entry to point to new tbl8 entry. Note: The
@@ -491,7 +670,9 @@ add_step(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl,
 				.ext_entry = 1,
 			};
 
-			tbl[tbl_index] = new_tbl_entry;
+			/* The tbl8 group must be complete before it is linked. */
+			rte_wmb();
+			tbl_entry_write(&tbl[tbl_index], new_tbl_entry);
 		}
 
 		*tbl_next = &(lpm->tbl8[tbl[tbl_index].lpm6_tbl8_gindex *
@@ -626,44 +807,142 @@ rte_lpm6_lookup(const struct rte_lpm6 *lpm, uint8_t *ip, uint8_t *next_hop)
 
 /*
  * Looks up a group of IP addresses
+ *
+ * The lookups of a batch progress together, one trie level at a time: the
+ * entry of the next level of each lookup is prefetched before any of them is
+ * read, so that the memory accesses of the batch overlap instead of being
+ * serialized by the dependency between the levels of a single lookup.
  */
 int
 rte_lpm6_lookup_bulk_func(const struct rte_lpm6 *lpm,
 		uint8_t ips[][RTE_LPM6_IPV6_ADDR_SIZE],
 		int16_t * next_hops, unsigned n)
 {
-	unsigned i;
-	const struct rte_lpm6_tbl_entry *tbl;
-	const struct rte_lpm6_tbl_entry *tbl_next;
-	uint32_t tbl24_index;
-	uint8_t first_byte, next_hop;
-	int status;
+	const struct rte_lpm6_tbl_entry *tbl[LOOKUP_BULK_BATCH];
+	uint8_t first_byte[LOOKUP_BULK_BATCH];
+	uint8_t active[LOOKUP_BULK_BATCH];
+	unsigned i, j, k, num, num_active, num_next;
+	uint32_t tbl24_index, tbl8_index, tbl_entry;
 
 	/* DEBUG: Check user input arguments. */
 	if ((lpm == NULL) || (ips == NULL) || (next_hops == NULL)) {
 		return -EINVAL;
 	}
 
-	for (i = 0; i < n; i++) {
-		first_byte = LOOKUP_FIRST_BYTE;
-		tbl24_index = (ips[i][0] << BYTES2_SIZE) |
-				(ips[i][1] << BYTE_SIZE) | ips[i][2];
+	for (i = 0; i < n; i += LOOKUP_BULK_BATCH) {
+		num = RTE_MIN(n - i, (unsigned)LOOKUP_BULK_BATCH);
+
+		/* Start with the tbl24 entries of the whole batch. */
+		for (j = 0; j < num; j++) {
+			tbl24_index = (ips[i + j][0] << BYTES2_SIZE) |
+					(ips[i + j][1] << BYTE_SIZE) |
+					ips[i + j][2];
+			tbl[j] = &lpm->tbl24[tbl24_index];
+			rte_prefetch0((volatile void *)(uintptr_t)tbl[j]);
+			first_byte[j] = LOOKUP_FIRST_BYTE;
+			active[j] = (uint8_t)j;
+		}
+		num_active = num;
+
+		/* Inspect one more level of the lookups not done yet. */
+		while (num_active > 0) {
+			num_next = 0;
+
+			for (k = 0; k < num_active; k++) {
+				j = active[k];
+				tbl_entry = *(const uint32_t *)tbl[j];
+
+				if ((tbl_entry &
+						RTE_LPM6_VALID_EXT_ENTRY_BITMASK) ==
+						RTE_LPM6_VALID_EXT_ENTRY_BITMASK) {
+					tbl8_index = ips[i + j][first_byte[j] - 1] +
+						((tbl_entry &
+						RTE_LPM6_TBL8_BITMASK) *
+						RTE_LPM6_TBL8_GROUP_NUM_ENTRIES);
+					tbl[j] = &lpm->tbl8[tbl8_index];
+					rte_prefetch0((volatile void *)
+							(uintptr_t)tbl[j]);
+					first_byte[j]++;
+					active[num_next++] = (uint8_t)j;
+				} else if (tbl_entry & RTE_LPM6_LOOKUP_SUCCESS) {
+					next_hops[i + j] = (uint8_t)tbl_entry;
+				} else {
+					next_hops[i + j] = -1;
+				}
+			}
+
+			num_active = num_next;
+		}
+	}
 
-		/* Calculate pointer to the first entry to be inspected */
-		tbl = &lpm->tbl24[tbl24_index];
+	return 0;
+}
+
+/*
+ * Counts the tbl8 groups linked below a tbl8 group, at each level.
+ */
+static void
+count_tbl8s(const struct rte_lpm6 *lpm, uint32_t tbl8_gindex, unsigned level,
+		struct rte_lpm6_memory_stats *stats)
+{
+	uint32_t tbl8_group_start, i;
+
+	stats->level_tbl8s[level]++;
+	tbl8_group_start = tbl8_gindex * RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
+
+	for (i = tbl8_group_start;
+			i < tbl8_group_start + RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
+			i++) {
+		if (lpm->tbl8[i].valid && lpm->tbl8[i].ext_entry &&
+				level + 1 < RTE_LPM6_TBL8_NUM_LEVELS)
+			count_tbl8s(lpm, lpm->tbl8[i].lpm6_tbl8_gindex,
+					level + 1, stats);
+	}
+}
+
+/*
+ * Reports the memory footprint
+ */
+int
+rte_lpm6_get_memory_stats(const struct rte_lpm6 *lpm,
+		struct rte_lpm6_memory_stats *stats)
+{
+	uint32_t i;
+
+	/* Check user arguments. */
+	if ((lpm == NULL) || (stats == NULL))
+		return -EINVAL;
 
-		do {
-			/* Continue inspecting following levels until success or failure */
-			status = lookup_step(lpm, tbl, &tbl_next, ips[i], first_byte++,
-					&next_hop);
-			tbl = tbl_next;
-		} while (status == 1);
+	memset(stats, 0, sizeof(*stats));
+	stats->used_rules = lpm->used_rules;
+	stats->max_rules = lpm->max_rules;
+	stats->number_tbl8s = lpm->number_tbl8s;
 
-		if (status < 0)
-			next_hops[i] = -1;
-		else
-			next_hops[i] = next_hop;
+	for (i = 0; i < RTE_LPM6_TBL24_NUM_ENTRIES; i++) {
+		if (lpm->tbl24[i].valid && lpm->tbl24[i].ext_entry)
+			count_tbl8s(lpm, lpm->tbl24[i].lpm6_tbl8_gindex, 0,
+					stats);
 	}
+	for (i = 0; i < RTE_LPM6_TBL8_NUM_LEVELS; i++)
+		stats->used_tbl8s += stats->level_tbl8s[i];
+
+	if (lpm->pending_head >= lpm->pending_tail)
+		stats->pending_tbl8s = lpm->pending_head - lpm->pending_tail;
+	else
+		stats->pending_tbl8s = lpm->number_tbl8s + 1 -
+				lpm->pending_tail + lpm->pending_head;
+
+	stats->total_size = sizeof(*lpm) + (uint64_t)sizeof(lpm->tbl8[0]) *
+			RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * lpm->number_tbl8s +
+			(uint64_t)sizeof(lpm->rules_tbl[0]) * lpm->max_rules +
+			(uint64_t)sizeof(lpm->tbl8_free[0]) *
+			(lpm->number_tbl8s + 1) +
+			(uint64_t)sizeof(lpm->tbl8_pending[0]) *
+			(lpm->number_tbl8s + 1);
+	stats->used_size = sizeof(lpm->tbl24) +
+			(uint64_t)sizeof(lpm->tbl8[0]) *
+			RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * stats->used_tbl8s +
+			(uint64_t)sizeof(lpm->rules_tbl[0]) * lpm->used_rules;
 
 	return 0;
 }
@@ -739,22 +1018,197 @@ rule_delete(struct rte_lpm6 *lpm, int32_t rule_index)
 }
 
 /*
- * Deletes a rule
+ * Finds the rule with the longest prefix covering a rule being deleted,
+ * whose next hop its entries are replaced with.
  */
-int
-rte_lpm6_delete(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth)
+static int32_t
+find_previous_rule(struct rte_lpm6 *lpm, const uint8_t *ip, uint8_t depth)
 {
-	int32_t rule_to_delete_index;
 	uint8_t ip_masked[RTE_LPM6_IPV6_ADDR_SIZE];
-	unsigned i;
+	uint32_t rule_index;
+	int32_t sub_rule_index = -1;
+	uint8_t sub_rule_depth = 0;
 
-	/*
-	 * Check input arguments.
-	 */
-	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM6_MAX_DEPTH)) {
-		return -EINVAL;
+	for (rule_index = 0; rule_index < lpm->used_rules; rule_index++) {
+		if (lpm->rules_tbl[rule_index].depth >= depth ||
+				lpm->rules_tbl[rule_index].depth <=
+				sub_rule_depth)
+			continue;
+
+		memcpy(ip_masked, ip, RTE_LPM6_IPV6_ADDR_SIZE);
+		mask_ip(ip_masked, lpm->rules_tbl[rule_index].depth);
+
+		if (memcmp(lpm->rules_tbl[rule_index].ip, ip_masked,
+				RTE_LPM6_IPV6_ADDR_SIZE) == 0) {
+			sub_rule_index = rule_index;
+			sub_rule_depth = lpm->rules_tbl[rule_index].depth;
+		}
+	}
+
+	return sub_rule_index;
+}
+
+/*
+ * Replaces the entry linking a tbl8 group with the value of the entries of
+ * the group, if they are all the same and belong to a rule short enough to
+ * be stored in the linking entry, and frees the group.
+ * Returns 1 if the group is freed, 0 otherwise.
+ */
+static int
+tbl8_collapse(struct rte_lpm6 *lpm, struct rte_lpm6_tbl_entry *tbl_entry,
+		uint8_t bits_covered)
+{
+	struct rte_lpm6_tbl_entry first, new_tbl_entry;
+	uint32_t tbl8_gindex, tbl8_group_start, i;
+
+	tbl8_gindex = tbl_entry->lpm6_tbl8_gindex;
+	tbl8_group_start = tbl8_gindex * RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
+	first = lpm->tbl8[tbl8_group_start];
+
+	if (first.ext_entry || (first.valid && first.depth > bits_covered))
+		return 0;
+
+	for (i = tbl8_group_start + 1;
+			i < tbl8_group_start + RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
+			i++) {
+		if (lpm->tbl8[i].valid != first.valid ||
+				lpm->tbl8[i].ext_entry)
+			return 0;
+		if (first.valid && (lpm->tbl8[i].depth != first.depth ||
+				lpm->tbl8[i].next_hop != first.next_hop))
+			return 0;
+	}
+
+	memset(&new_tbl_entry, 0, sizeof(new_tbl_entry));
+	if (first.valid) {
+		new_tbl_entry.next_hop = first.next_hop;
+		new_tbl_entry.depth = first.depth;
+		new_tbl_entry.valid = VALID;
+		new_tbl_entry.valid_group = VALID;
 	}
 
+	/* Unlink the group before freeing it. */
+	tbl_entry_write(tbl_entry, new_tbl_entry);
+	tbl8_free(lpm, tbl8_gindex);
+
+	return 1;
+}
+
+/*
+ * Function that shrinks a deleted rule across the data structure: the
+ * entries of the rule in a tbl8 group and the ones below it are replaced
+ * with the entry of the rule covering it, or invalidated.
+ */
+static void
+shrink_rule(struct rte_lpm6 *lpm, uint32_t tbl8_gindex, uint8_t depth,
+		struct rte_lpm6_tbl_entry new_tbl_entry, uint8_t bits_covered)
+{
+	uint32_t tbl8_group_start, tbl8_group_end, j;
+
+	tbl8_group_start = tbl8_gindex * RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
+	tbl8_group_end = tbl8_group_start + RTE_LPM6_TBL8_GROUP_NUM_ENTRIES;
+
+	for (j = tbl8_group_start; j < tbl8_group_end; j++) {
+		if (lpm->tbl8[j].ext_entry == 0 &&
+				lpm->tbl8[j].depth <= depth) {
+
+			tbl_entry_write(&lpm->tbl8[j], new_tbl_entry);
+
+		} else if (lpm->tbl8[j].ext_entry == 1) {
+
+			shrink_rule(lpm, lpm->tbl8[j].lpm6_tbl8_gindex, depth,
+					new_tbl_entry,
+					(uint8_t)(bits_covered + BYTE_SIZE));
+			tbl8_collapse(lpm, &lpm->tbl8[j], bits_covered);
+		}
+	}
+}
+
+/*
+ * Removes a rule, already deleted from the rules table, from the data
+ * structure (tbl24+tbl8s). The tbl8 groups left with a single value on its
+ * path are freed.
+ */
+static void
+delete_rule_entries(struct rte_lpm6 *lpm, uint8_t *ip_masked, uint8_t depth,
+		int32_t sub_rule_index)
+{
+	struct rte_lpm6_tbl_entry *tbl, *path[RTE_LPM6_IPV6_ADDR_SIZE];
+	struct rte_lpm6_tbl_entry new_tbl_entry;
+	uint8_t path_bits[RTE_LPM6_IPV6_ADDR_SIZE];
+	uint32_t tbl_index, tbl_range, i;
+	uint8_t bits_covered, first_byte, bytes;
+	unsigned n_path = 0;
+
+	memset(&new_tbl_entry, 0, sizeof(new_tbl_entry));
+	if (sub_rule_index >= 0) {
+		new_tbl_entry.next_hop = lpm->rules_tbl[sub_rule_index].next_hop;
+		new_tbl_entry.depth = lpm->rules_tbl[sub_rule_index].depth;
+		new_tbl_entry.valid = VALID;
+		new_tbl_entry.valid_group = VALID;
+	}
+
+	/* Inspect the first three bytes through tbl24 on the first step. */
+	tbl = lpm->tbl24;
+	first_byte = 1;
+	bytes = ADD_FIRST_BYTE;
+
+	for (;;) {
+		tbl_index = step_tbl_index(ip_masked, bytes, first_byte);
+		bits_covered = (uint8_t)((bytes + first_byte - 1) * BYTE_SIZE);
+
+		/* Last step: shrink the rule across its range. */
+		if (depth <= bits_covered) {
+			tbl_range = 1 << (bits_covered - depth);
+
+			for (i = tbl_index; i < (tbl_index + tbl_range); i++) {
+				if (tbl[i].ext_entry == 0 &&
+						tbl[i].depth <= depth) {
+					tbl_entry_write(&tbl[i], new_tbl_entry);
+				} else if (tbl[i].ext_entry == 1) {
+					shrink_rule(lpm,
+						tbl[i].lpm6_tbl8_gindex, depth,
+						new_tbl_entry,
+						(uint8_t)(bits_covered +
+						BYTE_SIZE));
+					tbl8_collapse(lpm, &tbl[i],
+							bits_covered);
+				}
+			}
+			break;
+		}
+
+		/* The rule may have been partially added only. */
+		if (!tbl[tbl_index].valid || tbl[tbl_index].ext_entry == 0)
+			break;
+
+		path[n_path] = &tbl[tbl_index];
+		path_bits[n_path] = bits_covered;
+		n_path++;
+
+		tbl = &lpm->tbl8[tbl[tbl_index].lpm6_tbl8_gindex *
+				RTE_LPM6_TBL8_GROUP_NUM_ENTRIES];
+		first_byte = (uint8_t)(first_byte + bytes);
+		bytes = 1;
+	}
+
+	/* Free the groups of the path, from the deepest one. */
+	while (n_path > 0) {
+		n_path--;
+		if (!tbl8_collapse(lpm, path[n_path], path_bits[n_path]))
+			break;
+	}
+}
+
+/*
+ * Deletes a rule from the rules table and the data structure.
+ */
+static int
+delete_rule(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth)
+{
+	int32_t rule_to_delete_index, sub_rule_index;
+	uint8_t ip_masked[RTE_LPM6_IPV6_ADDR_SIZE];
+
 	/* Copy the IP and mask it to avoid modifying user's input data. */
 	memcpy(ip_masked, ip, RTE_LPM6_IPV6_ADDR_SIZE);
 	mask_ip(ip_masked, depth);
@@ -776,24 +1230,29 @@ rte_lpm6_delete(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth)
 	rule_delete(lpm, rule_to_delete_index);
 
 	/*
-	 * Set all the table entries to 0 (ie delete every rule
-	 * from the data structure.
+	 * Replace the entries of the rule in place with the ones of the rule
+	 * covering it, so that lookups keep on matching during the update.
 	 */
-	lpm->next_tbl8 = 0;
-	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
-	memset(lpm->tbl8, 0, sizeof(lpm->tbl8[0])
-			* RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * lpm->number_tbl8s);
+	sub_rule_index = find_previous_rule(lpm, ip_masked, depth);
+	delete_rule_entries(lpm, ip_masked, depth, sub_rule_index);
 
+	return 0;
+}
+
+/*
+ * Deletes a rule
+ */
+int
+rte_lpm6_delete(struct rte_lpm6 *lpm, uint8_t *ip, uint8_t depth)
+{
 	/*
-	 * Add every rule again (except for the one that was removed from
-	 * the rules table).
+	 * Check input arguments.
 	 */
-	for (i = 0; i < lpm->used_rules; i++) {
-		rte_lpm6_add(lpm, lpm->rules_tbl[i].ip, lpm->rules_tbl[i].depth,
-				lpm->rules_tbl[i].next_hop);
+	if ((lpm == NULL) || (depth < 1) || (depth > RTE_LPM6_MAX_DEPTH)) {
+		return -EINVAL;
 	}
 
-	return 0;
+	return delete_rule(lpm, ip, depth);
 }
 
 /*
@@ -803,8 +1262,6 @@ int
 rte_lpm6_delete_bulk_func(struct rte_lpm6 *lpm,
 		uint8_t ips[][RTE_LPM6_IPV6_ADDR_SIZE], uint8_t *depths, unsigned n)
 {
-	int32_t rule_to_delete_index;
-	uint8_t ip_masked[RTE_LPM6_IPV6_ADDR_SIZE];
 	unsigned i;
 
 	/*
@@ -814,44 +1271,11 @@ rte_lpm6_delete_bulk_func(struct rte_lpm6 *lpm,
 		return -EINVAL;
 	}
 
+	/* Rules not found are skipped. */
 	for (i = 0; i < n; i++) {
-		/* Copy the IP and mask it to avoid modifying user's input data. */
-		memcpy(ip_masked, ips[i], RTE_LPM6_IPV6_ADDR_SIZE);
-		mask_ip(ip_masked, depths[i]);
-
-		/*
-		 * Find the index of the input rule, that needs to be deleted, in the
-		 * rule table.
-		 */
-		rule_to_delete_index = rule_find(lpm, ip_masked, depths[i]);
-
-		/*
-		 * Check if rule_to_delete_index was found. If no rule was found the
-		 * function rule_find returns -ENOENT.
-		 */
-		if (rule_to_delete_index < 0)
+		if ((depths[i] < 1) || (depths[i] > RTE_LPM6_MAX_DEPTH))
 			continue;
-
-		/* Delete the rule from the rule table. */
-		rule_delete(lpm, rule_to_delete_index);
-	}
-
-	/*
-	 * Set all the table entries to 0 (ie delete every rule
-	 * from the data structure.
-	 */
-	lpm->next_tbl8 = 0;
-	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
-	memset(lpm->tbl8, 0, sizeof(lpm->tbl8[0])
-			* RTE_LPM6_TBL8_GROUP_NUM_ENTRIES * lpm->number_tbl8s);
-
-	/*
-	 * Add every rule again (except for the ones that were removed from
-	 * the rules table).
-	 */
-	for (i = 0; i < lpm->used_rules; i++) {
-		rte_lpm6_add(lpm, lpm->rules_tbl[i].ip, lpm->rules_tbl[i].depth,
-				lpm->rules_tbl[i].next_hop);
+		delete_rule(lpm, ips[i], depths[i]);
 	}
 
 	return 0;
@@ -866,8 +1290,8 @@ rte_lpm6_delete_all(struct rte_lpm6 *lpm)
 	/* Zero used rules counter. */
 	lpm->used_rules = 0;
 
-	/* Zero next tbl8 index. */
-	lpm->next_tbl8 = 0;
+	/* All tbl8 groups are free, no lookup is running. */
+	tbl8_free_init(lpm);
 
 	/* Zero tbl24. */
 	memset(lpm->tbl24, 0, sizeof(lpm->tbl24));
@@ -879,3 +1303,91 @@ rte_lpm6_delete_all(struct rte_lpm6 *lpm)
 	/* Delete all rules form the rules table. */
 	memset(lpm->rules_tbl, 0, sizeof(struct rte_lpm6_rule) * lpm->max_rules);
 }
+
+/*
+ * Applies a batch of route updates
+ */
+int
+rte_lpm6_update_bulk(struct rte_lpm6 *lpm,
+		const struct rte_lpm6_update *updates, unsigned n)
+{
+	uint8_t ip[RTE_LPM6_IPV6_ADDR_SIZE];
+	unsigned i;
+	int ret = 0;
+
+	/* Check user arguments. */
+	if ((lpm == NULL) || (updates == NULL && n != 0))
+		return -EINVAL;
+
+	for (i = 0; i < n; i++) {
+		memcpy(ip, updates[i].ip, RTE_LPM6_IPV6_ADDR_SIZE);
+
+		switch (updates[i].op) {
+		case RTE_LPM6_UPDATE_ADD:
+			ret = rte_lpm6_add(lpm, ip, updates[i].depth,
+					updates[i].next_hop);
+			break;
+		case RTE_LPM6_UPDATE_DELETE:
+			ret = rte_lpm6_delete(lpm, ip, updates[i].depth);
+			break;
+		default:
+			ret = -EINVAL;
+			break;
+		}
+
+		if (ret < 0) {
+			rte_errno = -ret;
+			break;
+		}
+	}
+
+	/* Make the groups freed by the batch available as soon as possible. */
+	tbl8_reclaim(lpm);
+
+	return i;
+}
+
+/*
+ * Registers an lcore doing lookups
+ */
+int
+rte_lpm6_reader_register(struct rte_lpm6 *lpm, unsigned lcore_id)
+{
+	/* Check user arguments. */
+	if ((lpm == NULL) || (lcore_id >= RTE_MAX_LCORE))
+		return -EINVAL;
+
+	lpm->readers[lcore_id].epoch = lpm->epoch;
+
+	/* The writer must see the state before the first lookup is done. */
+	rte_mb();
+
+	return 0;
+}
+
+/*
+ * Unregisters an lcore doing lookups
+ */
+void
+rte_lpm6_reader_unregister(struct rte_lpm6 *lpm, unsigned lcore_id)
+{
+	/* Check user arguments. */
+	if ((lpm == NULL) || (lcore_id >= RTE_MAX_LCORE))
+		return;
+
+	/* The last lookups must be done before the state is cleared. */
+	rte_mb();
+
+	lpm->readers[lcore_id].epoch = 0;
+}
+
+/*
+ * Reports a quiescent state of an lcore doing lookups
+ */
+void
+rte_lpm6_reader_quiescent(struct rte_lpm6 *lpm, unsigned lcore_id)
+{
+	/* The previous lookups must be done before the state is stored. */
+	rte_smp_mb();
+	lpm->readers[lcore_id].epoch = lpm->epoch;
+}
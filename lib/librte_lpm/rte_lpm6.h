@@ -48,9 +48,25 @@ extern "C" {
 /** Max number of characters in LPM name. */
 #define RTE_LPM6_NAMESIZE                 32
 
+/** Number of trie levels made of tbl8 groups, below the tbl24 level. */
+#define RTE_LPM6_TBL8_NUM_LEVELS          13
+
 /** LPM structure. */
 struct rte_lpm6;
 
+/** Memory footprint of an LPM object, see rte_lpm6_get_memory_stats(). */
+struct rte_lpm6_memory_stats {
+	uint32_t used_rules;      /**< Number of rules. */
+	uint32_t max_rules;       /**< Max number of rules. */
+	uint32_t number_tbl8s;    /**< Number of tbl8 groups allocated. */
+	uint32_t used_tbl8s;      /**< tbl8 groups linked in the trie. */
+	uint32_t pending_tbl8s;   /**< tbl8 groups freed, waiting for readers. */
+	/** tbl8 groups linked at each level, level 0 being below tbl24. */
+	uint32_t level_tbl8s[RTE_LPM6_TBL8_NUM_LEVELS];
+	uint64_t total_size;      /**< Bytes allocated for the object. */
+	uint64_t used_size;       /**< Bytes of tbl24, used tbl8s and rules. */
+};
+
 /** LPM configuration structure. */
 struct rte_lpm6_config {
 	uint32_t max_rules;      /**< Max number of rules. */
@@ -58,6 +74,20 @@ struct rte_lpm6_config {
 	int flags;               /**< This field is currently unused. */
 };
 
+/** Operations of rte_lpm6_update_bulk(). */
+enum rte_lpm6_update_op {
+	RTE_LPM6_UPDATE_ADD,    /**< Add a rule, as rte_lpm6_add(). */
+	RTE_LPM6_UPDATE_DELETE, /**< Delete a rule, as rte_lpm6_delete(). */
+};
+
+/** Route update applied by rte_lpm6_update_bulk(). */
+struct rte_lpm6_update {
+	uint8_t ip[RTE_LPM6_IPV6_ADDR_SIZE]; /**< IP of the rule. */
+	uint8_t depth;    /**< Depth of the rule. */
+	uint8_t op;       /**< Operation, see enum rte_lpm6_update_op. */
+	uint8_t next_hop; /**< Next hop of the rule, for RTE_LPM6_UPDATE_ADD. */
+};
+
 /**
  * Create an LPM object.
  *
@@ -178,12 +208,99 @@ rte_lpm6_delete_bulk_func(struct rte_lpm6 *lpm,
 /**
  * Delete all rules from the LPM table.
  *
+ * Unlike the other update functions, it must not be called while lookups
+ * are done in the table.
+ *
  * @param lpm
  *   LPM object handle
  */
 void
 rte_lpm6_delete_all(struct rte_lpm6 *lpm);
 
+/**
+ * Apply a batch of rule additions and deletions to the LPM table, in order.
+ *
+ * The updates are applied as with rte_lpm6_add() and rte_lpm6_delete(),
+ * then the tbl8 groups that no registered reader can access any more are
+ * reclaimed at once.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param updates
+ *   Array of updates
+ * @param n
+ *   Number of elements in the updates array
+ * @return
+ *   The number of updates applied, -EINVAL for incorrect arguments.
+ *   If it is less than n, the next update failed and rte_errno is set to
+ *   the error it returned.
+ */
+int
+rte_lpm6_update_bulk(struct rte_lpm6 *lpm,
+		const struct rte_lpm6_update *updates, unsigned n);
+
+/**
+ * Register an lcore doing lookups in the LPM table.
+ *
+ * rte_lpm6_add() and rte_lpm6_delete() can be called by a single writer
+ * while other lcores do lookups: a lookup always returns either the next
+ * hop before or after the update. A tbl8 group freed by a delete is only
+ * reused once all the registered lcores reported a quiescent state with
+ * rte_lpm6_reader_quiescent(). An lcore which does lookups while rules are
+ * deleted must be registered.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param lcore_id
+ *   Id of the lcore doing lookups
+ * @return
+ *   0 on success, -EINVAL for incorrect arguments
+ */
+int
+rte_lpm6_reader_register(struct rte_lpm6 *lpm, unsigned lcore_id);
+
+/**
+ * Unregister an lcore doing lookups in the LPM table.
+ *
+ * The lcore must not do lookups any more, until it is registered again.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param lcore_id
+ *   Id of the lcore doing lookups
+ */
+void
+rte_lpm6_reader_unregister(struct rte_lpm6 *lpm, unsigned lcore_id);
+
+/**
+ * Report a quiescent state of a registered lcore: it holds no result of a
+ * lookup done before. It is typically called once per burst of packets.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param lcore_id
+ *   Id of the lcore doing lookups
+ */
+void
+rte_lpm6_reader_quiescent(struct rte_lpm6 *lpm, unsigned lcore_id);
+
+/**
+ * Report the memory footprint of the LPM table, as well as the number of
+ * tbl8 groups used at each level of the trie for its rule set.
+ *
+ * It walks the whole table and is meant for the control path.
+ *
+ * @param lpm
+ *   LPM object handle
+ * @param stats
+ *   Structure filled with the memory footprint
+ * @return
+ *   0 on success, -EINVAL for incorrect arguments
+ */
+int
+rte_lpm6_get_memory_stats(const struct rte_lpm6 *lpm,
+		struct rte_lpm6_memory_stats *stats);
+
 /**
  * Lookup an IP into the LPM table.
  *
@@ -202,6 +319,10 @@ rte_lpm6_lookup(const struct rte_lpm6 *lpm, uint8_t *ip, uint8_t *next_hop);
 /**
  * Lookup multiple IP addresses in an LPM table.
  *
+ * The lookups are interleaved, so that the memory accesses of the trie
+ * levels of several addresses overlap: it is faster than successive calls
+ * to rte_lpm6_lookup() for rules longer than 24 bits.
+ *
  * @param lpm
  *   LPM object handle
  * @param ips
@@ -240,17 +240,12 @@ join_elem(struct malloc_elem *elem1, struct malloc_elem *elem2)
 }
 
 /*
- * free a malloc_elem block by adding it to the free list. If the
- * blocks either immediately before or immediately after newly freed block
- * are also free, the blocks are merged together.
+ * return a malloc_elem block to the free list, merging it with its free
+ * neighbours. Heap lock must be held by the caller.
  */
-int
-malloc_elem_free(struct malloc_elem *elem)
+static void
+elem_free(struct malloc_elem *elem)
 {
-	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY)
-		return -1;
-
-	rte_spinlock_lock(&(elem->heap->lock));
 	struct malloc_elem *next = RTE_PTR_ADD(elem, elem->size);
 	if (next->state == ELEM_FREE){
 		/* remove from free list, join to this one */
@@ -264,16 +259,67 @@ malloc_elem_free(struct malloc_elem *elem)
 	if (elem->prev != NULL && elem->prev->state == ELEM_FREE) {
 		elem_free_list_remove(elem->prev);
 		join_elem(elem->prev, elem);
-		malloc_elem_free_list_insert(elem->prev);
+		elem = elem->prev;
 	}
-	/* otherwise add ourselves to the free list */
-	else {
-		malloc_elem_free_list_insert(elem);
+	/* otherwise the element is inserted in the free list as is */
+	else
 		elem->pad = 0;
-	}
+
 	/* decrease heap's count of allocated elements */
 	elem->heap->alloc_count--;
-	rte_spinlock_unlock(&(elem->heap->lock));
+
+	/* segments added at runtime go back to the system once empty */
+	if (malloc_heap_shrink(elem) < 0)
+		malloc_elem_free_list_insert(elem);
+}
+
+/*
+ * free a malloc_elem block by adding it to the free list. If the
+ * blocks either immediately before or immediately after newly freed block
+ * are also free, the blocks are merged together.
+ */
+int
+malloc_elem_free(struct malloc_elem *elem)
+{
+	struct malloc_heap *heap;
+
+	if (!malloc_elem_cookies_ok(elem) || elem->state != ELEM_BUSY)
+		return -1;
+
+	/* elem may be unmapped once freed */
+	heap = elem->heap;
+	rte_spinlock_lock(&heap->lock);
+	elem_free(elem);
+	rte_spinlock_unlock(&heap->lock);
+
+	return 0;
+}
+
+/*
+ * free a number of malloc_elem blocks of the same heap,
+ * taking the heap lock only once.
+ */
+int
+malloc_elem_free_bulk(struct malloc_elem **elems, unsigned n)
+{
+	struct malloc_heap *heap;
+	unsigned i;
+
+	if (n == 0)
+		return 0;
+
+	heap = elems[0]->heap;
+	for (i = 0; i != n; i++) {
+		if (!malloc_elem_cookies_ok(elems[i]) ||
+				elems[i]->state != ELEM_BUSY ||
+				elems[i]->heap != heap)
+			return -1;
+	}
+
+	rte_spinlock_lock(&heap->lock);
+	for (i = 0; i != n; i++)
+		elem_free(elems[i]);
+	rte_spinlock_unlock(&heap->lock);
 
 	return 0;
 }
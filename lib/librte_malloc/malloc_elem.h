@@ -49,7 +49,7 @@ struct malloc_elem {
 	struct malloc_heap *heap;
 	struct malloc_elem *volatile prev;      /* points to prev elem in memzone */
 	LIST_ENTRY(malloc_elem) free_list;      /* list of free elements in heap */
-	const struct rte_memzone *mz;
+	const struct rte_memzone *mz;          /* NULL in segments added at runtime */
 	volatile enum elem_state state;
 	uint32_t pad;
 	size_t size;
@@ -168,6 +168,13 @@ malloc_elem_alloc(struct malloc_elem *elem, size_t size, unsigned align);
 int
 malloc_elem_free(struct malloc_elem *elem);
 
+/*
+ * free a number of malloc_elem blocks belonging to the same heap,
+ * taking the heap lock only once.
+ */
+int
+malloc_elem_free_bulk(struct malloc_elem **elems, unsigned n);
+
 /*
  * attempt to resize a malloc_elem by expanding into any free space
  * immediately after it in memory.
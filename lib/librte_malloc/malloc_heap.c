@@ -120,6 +120,61 @@ malloc_heap_add_memzone(struct malloc_heap *heap, size_t size, unsigned align)
 	return 0;
 }
 
+/*
+ * map extra hugepages as a new memory segment and make it available for use
+ * by a particular heap. Used when no memzone can be reserved anymore and the
+ * EAL can grow memory at runtime. The segment is laid out as a memzone
+ * would be, with no memzone attached to its elements.
+ */
+static int
+malloc_heap_grow(struct malloc_heap *heap, size_t size, unsigned align)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	const size_t min_size = size + align + MALLOC_ELEM_OVERHEAD * 2;
+	const struct rte_memseg *ms;
+	int idx;
+
+	idx = rte_eal_memseg_grow(heap - mcfg->malloc_heaps,
+			RTE_MAX(min_size, get_malloc_memzone_size()));
+	if (idx < 0)
+		return -1;
+	ms = &mcfg->memseg[idx];
+
+	struct malloc_elem *start_elem = (struct malloc_elem *)ms->addr;
+	struct malloc_elem *end_elem = RTE_PTR_ADD(ms->addr,
+			ms->len - MALLOC_ELEM_OVERHEAD);
+	end_elem = RTE_PTR_ALIGN_FLOOR(end_elem, RTE_CACHE_LINE_SIZE);
+
+	const size_t elem_size = (uintptr_t)end_elem - (uintptr_t)start_elem;
+	malloc_elem_init(start_elem, heap, NULL, elem_size);
+	malloc_elem_mkend(end_elem, start_elem);
+	malloc_elem_free_list_insert(start_elem);
+
+	heap->total_size += elem_size;
+	return 0;
+}
+
+/*
+ * give a segment added by malloc_heap_grow() back to the EAL once its first
+ * element is free and spans the whole segment. Heap lock must be held by
+ * the caller, the element must not be on a free list.
+ */
+int
+malloc_heap_shrink(struct malloc_elem *elem)
+{
+	struct malloc_elem *next = RTE_PTR_ADD(elem, elem->size);
+
+	if (elem->mz != NULL || elem->prev != NULL || next->size != 0)
+		return -1;
+
+	elem->heap->total_size -= elem->size;
+	if (rte_eal_memseg_release(elem) < 0) {
+		elem->heap->total_size += elem->size;
+		return -1;
+	}
+	return 0;
+}
+
 /*
  * Iterates through the freelist for a heap to find a free element
  * which can store data of the required size and with the requested alignment.
@@ -145,21 +200,16 @@ find_suitable_element(struct malloc_heap *heap, size_t size, unsigned align)
 }
 
 /*
- * Main function called by malloc to allocate a block of memory from the
- * heap. It locks the free list, scans it, and adds a new memzone if the
- * scan fails. Once the new memzone is added, it re-scans and should return
- * the new element after releasing the lock.
+ * Allocate an element from the heap, adding a new memzone if the scan
+ * of the free lists fails. Heap lock must be held by the caller.
  */
-void *
-malloc_heap_alloc(struct malloc_heap *heap,
-		const char *type __attribute__((unused)), size_t size, unsigned align)
+static struct malloc_elem *
+heap_alloc(struct malloc_heap *heap, size_t size, unsigned align)
 {
-	size = RTE_CACHE_LINE_ROUNDUP(size);
-	align = RTE_CACHE_LINE_ROUNDUP(align);
-	rte_spinlock_lock(&heap->lock);
 	struct malloc_elem *elem = find_suitable_element(heap, size, align);
 	if (elem == NULL){
-		if ((malloc_heap_add_memzone(heap, size, align)) == 0)
+		if (malloc_heap_add_memzone(heap, size, align) == 0 ||
+				malloc_heap_grow(heap, size, align) == 0)
 			elem = find_suitable_element(heap, size, align);
 	}
 
@@ -168,11 +218,52 @@ malloc_heap_alloc(struct malloc_heap *heap,
 		/* increase heap's count of allocated elements */
 		heap->alloc_count++;
 	}
+	return elem;
+}
+
+/*
+ * Main function called by malloc to allocate a block of memory from the
+ * heap. It locks the free list, scans it, and adds a new memzone if the
+ * scan fails. Once the new memzone is added, it re-scans and should return
+ * the new element after releasing the lock.
+ */
+void *
+malloc_heap_alloc(struct malloc_heap *heap,
+		const char *type __attribute__((unused)), size_t size, unsigned align)
+{
+	size = RTE_CACHE_LINE_ROUNDUP(size);
+	align = RTE_CACHE_LINE_ROUNDUP(align);
+	rte_spinlock_lock(&heap->lock);
+	struct malloc_elem *elem = heap_alloc(heap, size, align);
 	rte_spinlock_unlock(&heap->lock);
 	return elem == NULL ? NULL : (void *)(&elem[1]);
 
 }
 
+/*
+ * Allocate up to n blocks of the same size, taking the heap lock only once.
+ * Returns the number of blocks allocated.
+ */
+unsigned
+malloc_heap_alloc_bulk(struct malloc_heap *heap, size_t size, unsigned align,
+		void **objs, unsigned n)
+{
+	struct malloc_elem *elem;
+	unsigned i;
+
+	size = RTE_CACHE_LINE_ROUNDUP(size);
+	align = RTE_CACHE_LINE_ROUNDUP(align);
+	rte_spinlock_lock(&heap->lock);
+	for (i = 0; i != n; i++) {
+		elem = heap_alloc(heap, size, align);
+		if (elem == NULL)
+			break;
+		objs[i] = &elem[1];
+	}
+	rte_spinlock_unlock(&heap->lock);
+	return i;
+}
+
 /*
  * Function to retrieve data for heap on given socket
  */
@@ -32,6 +32,8 @@
  */
 
 #include <stdint.h>
+#include <inttypes.h>
+#include <errno.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
@@ -54,11 +56,204 @@
 #include "malloc_elem.h"
 #include "malloc_heap.h"
 
+/* largest object size served by the per-lcore caches */
+#define MALLOC_CACHE_MAX_OBJ_SIZE \
+	(RTE_MALLOC_CACHE_NB_CLASSES * RTE_CACHE_LINE_SIZE)
+
+/* per-lcore LIFO of free objects for one size class */
+struct malloc_cache_class {
+	unsigned len;                 /**< Number of objects held */
+	uint64_t hits;                /**< Allocations served from the cache */
+	uint64_t misses;              /**< Allocations refilled from the heap */
+	void *objs[RTE_MALLOC_CACHE_MAX_SIZE]; /**< Data pointers */
+};
+
+/* per-lcore cache, only ever touched by its owning lcore */
+struct malloc_lcore_cache {
+	struct malloc_heap *heap;     /**< Heap the cached objects belong to */
+	struct malloc_cache_class cls[RTE_MALLOC_CACHE_NB_CLASSES];
+} __rte_cache_aligned;
+
+static struct malloc_lcore_cache lcore_cache[RTE_MAX_LCORE];
+
+/* maximum number of objects per class and per lcore, 0 when disabled */
+static unsigned malloc_cache_size;
+
+/*
+ * The heap of a socket, without taking the address of a member of the
+ * packed rte_mem_config: malloc_heaps is at an aligned offset.
+ */
+static inline struct malloc_heap *
+malloc_socket_heap(struct rte_mem_config *mcfg, unsigned socket)
+{
+	return RTE_PTR_ADD(mcfg, offsetof(struct rte_mem_config, malloc_heaps) +
+		socket * sizeof(struct malloc_heap));
+}
+
+/*
+ * Return the cache of the calling lcore bound to its local heap,
+ * or NULL if the caches are disabled or the caller is not an EAL lcore.
+ */
+static inline struct malloc_lcore_cache *
+malloc_cache_get(void)
+{
+	struct rte_mem_config *mcfg;
+	struct malloc_lcore_cache *cache;
+	unsigned lcore_id = rte_lcore_id();
+
+	if (malloc_cache_size == 0 || lcore_id >= RTE_MAX_LCORE)
+		return NULL;
+
+	cache = &lcore_cache[lcore_id];
+	if (unlikely(cache->heap == NULL)) {
+		mcfg = rte_eal_get_configuration()->mem_config;
+		cache->heap = malloc_socket_heap(mcfg,
+			malloc_get_numa_socket());
+	}
+	return cache;
+}
+
+/* Return the n oldest objects of a cache class to the heap */
+static void
+malloc_cache_class_flush(struct malloc_cache_class *cls, unsigned n)
+{
+	struct malloc_elem *elems[RTE_MALLOC_CACHE_MAX_SIZE];
+	unsigned i;
+
+	for (i = 0; i != n; i++)
+		elems[i] = malloc_elem_from_data(cls->objs[i]);
+	if (malloc_elem_free_bulk(elems, n) < 0)
+		rte_panic("Fatal error: Invalid memory\n");
+
+	cls->len -= n;
+	memmove(cls->objs, &cls->objs[n], cls->len * sizeof(cls->objs[0]));
+}
+
+/*
+ * Try to serve an allocation from the calling lcore's cache, refilling
+ * the size class from the heap on a miss. Returns NULL if the request
+ * cannot be cached or the refill failed.
+ */
+static void *
+malloc_cache_alloc(size_t size, unsigned align, int socket_arg)
+{
+	struct malloc_lcore_cache *cache;
+	struct malloc_cache_class *cls;
+	unsigned idx, n;
+
+	size = RTE_CACHE_LINE_ROUNDUP(size);
+	if (size > MALLOC_CACHE_MAX_OBJ_SIZE || align > RTE_CACHE_LINE_SIZE)
+		return NULL;
+
+	cache = malloc_cache_get();
+	if (cache == NULL)
+		return NULL;
+	if (socket_arg != SOCKET_ID_ANY &&
+			socket_arg != (int)malloc_get_numa_socket())
+		return NULL;
+
+	idx = size / RTE_CACHE_LINE_SIZE - 1;
+	cls = &cache->cls[idx];
+	if (likely(cls->len != 0)) {
+		cls->hits++;
+		return cls->objs[--cls->len];
+	}
+
+	cls->misses++;
+	n = malloc_heap_alloc_bulk(cache->heap, size, RTE_CACHE_LINE_SIZE,
+			cls->objs, malloc_cache_size / 2 + 1);
+	if (n == 0)
+		return NULL;
+	cls->len = n - 1;
+	return cls->objs[n - 1];
+}
+
+/*
+ * Try to put a freed object in the calling lcore's cache, returning half
+ * of the size class to the heap when it is full. Returns 0 if the object
+ * was cached.
+ */
+static int
+malloc_cache_free(void *addr)
+{
+	struct malloc_lcore_cache *cache;
+	struct malloc_cache_class *cls;
+	struct malloc_elem *elem;
+	size_t usable;
+	unsigned idx;
+
+	cache = malloc_cache_get();
+	if (cache == NULL)
+		return -1;
+
+	elem = malloc_elem_from_data(addr);
+	if (elem == NULL || !malloc_elem_cookies_ok(elem) ||
+			elem->state != ELEM_BUSY)
+		rte_panic("Fatal error: Invalid memory\n");
+	if (elem->heap != cache->heap)
+		return -1;
+
+	/* an object can serve any class not bigger than its usable size */
+	usable = elem->size - elem->pad - MALLOC_ELEM_OVERHEAD;
+	if (usable < RTE_CACHE_LINE_SIZE ||
+			usable >= MALLOC_CACHE_MAX_OBJ_SIZE + RTE_CACHE_LINE_SIZE)
+		return -1;
+
+	idx = usable / RTE_CACHE_LINE_SIZE - 1;
+	cls = &cache->cls[idx];
+
+#ifdef RTE_LIBRTE_MALLOC_DEBUG
+	{
+		unsigned i;
+
+		for (i = 0; i != cls->len; i++)
+			if (cls->objs[i] == addr)
+				rte_panic("Fatal error: Double free of %p\n",
+						addr);
+	}
+#endif
+
+	if (cls->len >= malloc_cache_size)
+		malloc_cache_class_flush(cls,
+				cls->len - malloc_cache_size / 2);
+	cls->objs[cls->len++] = addr;
+	return 0;
+}
+
+int
+rte_malloc_cache_enable(unsigned cache_size)
+{
+	if (cache_size > RTE_MALLOC_CACHE_MAX_SIZE)
+		return -EINVAL;
+
+	malloc_cache_size = cache_size;
+	return 0;
+}
+
+void
+rte_malloc_cache_flush(void)
+{
+	struct malloc_lcore_cache *cache;
+	unsigned lcore_id = rte_lcore_id();
+	unsigned i;
+
+	if (lcore_id >= RTE_MAX_LCORE)
+		return;
+
+	cache = &lcore_cache[lcore_id];
+	for (i = 0; i != RTE_MALLOC_CACHE_NB_CLASSES; i++)
+		malloc_cache_class_flush(&cache->cls[i], cache->cls[i].len);
+}
 
 /* Free the memory space back to heap */
 void rte_free(void *addr)
 {
 	if (addr == NULL) return;
+	/* addr may be in a segment added by another process */
+	if (rte_eal_memseg_sync() < 0)
+		rte_panic("Fatal error: Cannot map memory\n");
+	if (malloc_cache_free(addr) == 0)
+		return;
 	if (malloc_elem_free(malloc_elem_from_data(addr)) < 0)
 		rte_panic("Fatal error: Invalid memory\n");
 }
@@ -86,7 +281,15 @@ rte_malloc_socket(const char *type, size_t size, unsigned align, int socket_arg)
 	if (socket >= RTE_MAX_NUMA_NODES)
 		return NULL;
 
-	ret = malloc_heap_alloc(&mcfg->malloc_heaps[socket], type,
+	/* the heap may use segments added by another process */
+	if (rte_eal_memseg_sync() < 0)
+		return NULL;
+
+	ret = malloc_cache_alloc(size, align, socket_arg);
+	if (ret != NULL)
+		return ret;
+
+	ret = malloc_heap_alloc(malloc_socket_heap(mcfg, socket), type,
 				size, align == 0 ? 1 : align);
 	if (ret != NULL || socket_arg != SOCKET_ID_ANY)
 		return ret;
@@ -97,7 +300,7 @@ rte_malloc_socket(const char *type, size_t size, unsigned align, int socket_arg)
 		if (i == socket)
 			continue;
 
-		ret = malloc_heap_alloc(&mcfg->malloc_heaps[i], type,
+		ret = malloc_heap_alloc(malloc_socket_heap(mcfg, i), type,
 					size, align == 0 ? 1 : align);
 		if (ret != NULL)
 			return ret;
@@ -209,7 +412,41 @@ rte_malloc_get_socket_stats(int socket,
 	if (socket >= RTE_MAX_NUMA_NODES || socket < 0)
 		return -1;
 
-	return malloc_heap_get_stats(&mcfg->malloc_heaps[socket], socket_stats);
+	return malloc_heap_get_stats(malloc_socket_heap(mcfg, socket),
+		socket_stats);
+}
+
+/*
+ * Function to retrieve the cache statistics of the lcores of a socket
+ */
+int
+rte_malloc_get_cache_stats(int socket,
+		struct rte_malloc_cache_stats *cache_stats)
+{
+	struct rte_mem_config *mcfg = rte_eal_get_configuration()->mem_config;
+	struct malloc_heap *heap;
+	const struct malloc_cache_class *cls;
+	unsigned lcore_id, i;
+
+	if (socket >= RTE_MAX_NUMA_NODES || socket < 0)
+		return -1;
+
+	heap = malloc_socket_heap(mcfg, socket);
+
+	/* cache counters are read without synchronisation */
+	memset(cache_stats, 0, sizeof(*cache_stats));
+	for (lcore_id = 0; lcore_id != RTE_MAX_LCORE; lcore_id++) {
+		if (lcore_cache[lcore_id].heap != heap)
+			continue;
+		for (i = 0; i != RTE_MALLOC_CACHE_NB_CLASSES; i++) {
+			cls = &lcore_cache[lcore_id].cls[i];
+			cache_stats->cache_sz_bytes += (size_t)cls->len *
+					(i + 1) * RTE_CACHE_LINE_SIZE;
+			cache_stats->cache_hits[i] += cls->hits;
+			cache_stats->cache_misses[i] += cls->misses;
+		}
+	}
+	return 0;
 }
 
 /*
@@ -218,8 +455,9 @@ rte_malloc_get_socket_stats(int socket,
 void
 rte_malloc_dump_stats(FILE *f, __rte_unused const char *type)
 {
-	unsigned int socket;
+	unsigned int socket, i;
 	struct rte_malloc_socket_stats sock_stats;
+	struct rte_malloc_cache_stats cache_stats;
 	/* Iterate through all initialised heaps */
 	for (socket=0; socket< RTE_MAX_NUMA_NODES; socket++) {
 		if ((rte_malloc_get_socket_stats(socket, &sock_stats) < 0))
@@ -233,6 +471,18 @@ rte_malloc_dump_stats(FILE *f, __rte_unused const char *type)
 				sock_stats.greatest_free_size);
 		fprintf(f, "\tAlloc_count:%u,\n",sock_stats.alloc_count);
 		fprintf(f, "\tFree_count:%u,\n", sock_stats.free_count);
+		rte_malloc_get_cache_stats(socket, &cache_stats);
+		fprintf(f, "\tCache_size:%zu,\n", cache_stats.cache_sz_bytes);
+		for (i = 0; i != RTE_MALLOC_CACHE_NB_CLASSES; i++) {
+			if (cache_stats.cache_hits[i] == 0 &&
+					cache_stats.cache_misses[i] == 0)
+				continue;
+			fprintf(f, "\tCache_class_%u:hits=%"PRIu64
+					",misses=%"PRIu64",\n",
+					(i + 1) * RTE_CACHE_LINE_SIZE,
+					cache_stats.cache_hits[i],
+					cache_stats.cache_misses[i]);
+		}
 	}
 	return;
 }
@@ -256,5 +506,8 @@ rte_malloc_virt2phy(const void *addr)
 	const struct malloc_elem *elem = malloc_elem_from_data(addr);
 	if (elem == NULL)
 		return 0;
+	/* segments added at runtime are only virtually contiguous */
+	if (elem->mz == NULL)
+		return rte_mem_virt2phy(addr);
 	return elem->mz->phys_addr + ((uintptr_t)addr - (uintptr_t)elem->mz->addr);
 }
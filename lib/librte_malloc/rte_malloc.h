@@ -42,12 +42,19 @@
 
 #include <stdio.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <rte_memory.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+/**
+ * Number of size classes served by the per-lcore malloc caches. Class i
+ * holds objects of (i + 1) * RTE_CACHE_LINE_SIZE bytes.
+ */
+#define RTE_MALLOC_CACHE_NB_CLASSES 8
+
 /**
  *  Structure to hold heap statistics obtained from rte_malloc_get_socket_stats function.
  */
@@ -60,6 +67,18 @@ struct rte_malloc_socket_stats {
 	size_t heap_allocsz_bytes; /**< Total allocated bytes on heap */
 };
 
+/**
+ *  Structure to hold the statistics of the per-lcore caches of a socket,
+ *  obtained from rte_malloc_get_cache_stats function.
+ */
+struct rte_malloc_cache_stats {
+	size_t cache_sz_bytes;     /**< Bytes held in per-lcore caches */
+	/** Per size class allocations served by the per-lcore caches */
+	uint64_t cache_hits[RTE_MALLOC_CACHE_NB_CLASSES];
+	/** Per size class allocations that had to refill from the heap */
+	uint64_t cache_misses[RTE_MALLOC_CACHE_NB_CLASSES];
+};
+
 /**
  * This function allocates memory from the huge-page area of memory. The memory
  * is not cleared. In NUMA systems, the memory allocated resides on the same
@@ -291,6 +310,56 @@ int
 rte_malloc_get_socket_stats(int socket,
 		struct rte_malloc_socket_stats *socket_stats);
 
+/**
+ * Enable or disable the per-lcore size-class caches.
+ *
+ * When enabled, allocations of at most RTE_MALLOC_CACHE_NB_CLASSES cache
+ * lines with no alignment stronger than a cache line, made by an EAL lcore
+ * on its local socket (or SOCKET_ID_ANY), are served from a per-lcore
+ * cache without taking the heap lock. Misses refill half a cache from the
+ * heap under a single lock acquisition, and full caches return half of
+ * their objects to the heap in one batch.
+ *
+ * Objects held in the caches are accounted as allocated in the heap
+ * statistics. Disabling the caches does not release the objects they
+ * hold; each lcore must call rte_malloc_cache_flush() for that.
+ *
+ * @param cache_size
+ *   Maximum number of objects cached per size class and per lcore,
+ *   or 0 to disable the caches. Must not exceed
+ *   RTE_MALLOC_CACHE_MAX_SIZE.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): cache_size is too big.
+ */
+int
+rte_malloc_cache_enable(unsigned cache_size);
+
+/**
+ * Get the statistics of the per-lcore caches of the lcores of a socket.
+ * The counters are read without synchronisation with the lcores.
+ *
+ * @param socket
+ *   Socket to get stats for
+ * @param cache_stats
+ *   Pointer to structure storing statistics on success
+ * @return
+ *   - 0: Success.
+ *   - (-1): Invalid socket.
+ */
+int
+rte_malloc_get_cache_stats(int socket,
+		struct rte_malloc_cache_stats *cache_stats);
+
+/**
+ * Return all objects held in the calling lcore's cache to the heap.
+ *
+ * This function must be called on the lcore owning the cache. It does
+ * nothing when called from a non-EAL thread.
+ */
+void
+rte_malloc_cache_flush(void);
+
 /**
  * Dump statistics.
  *
@@ -39,7 +39,8 @@
  * RTE Mempool.
  *
  * A memory pool is an allocator of fixed-size object. It is
- * identified by its name, and uses a ring to store free objects. It
+ * identified by its name, and uses a pool handler (a ring by default,
+ * see struct rte_mempool_ops) to store free objects. It
  * provides some other optional services, like a per-core object
  * cache, and an alignment helper to ensure that objects are padded
  * to spread them equally on all RAM channels, ranks, and so on.
@@ -71,6 +72,7 @@
 #include <rte_lcore.h>
 #include <rte_memory.h>
 #include <rte_branch_prediction.h>
+#include <rte_spinlock.h>
 #include <rte_ring.h>
 
 #ifdef __cplusplus
@@ -95,19 +97,21 @@ struct rte_mempool_debug_stats {
 } __rte_cache_aligned;
 #endif
 
-#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
 /**
- * A structure that stores a per-core object cache.
+ * A structure that stores an object cache: either the per-lcore cache
+ * of a mempool, or a cache owned by the user (see
+ * rte_mempool_cache_create()).
  */
 struct rte_mempool_cache {
-	unsigned len; /**< Cache len */
+	uint32_t size;        /**< Size of the cache */
+	uint32_t flushthresh; /**< Threshold before we flush excess elements */
+	uint32_t len;         /**< Current cache count */
 	/*
 	 * Cache is allocated to this size to allow it to overflow in certain
 	 * cases to avoid needless emptying of cache.
 	 */
 	void *objs[RTE_MEMPOOL_CACHE_MAX_SIZE * 3]; /**< Cache objects */
 } __rte_cache_aligned;
-#endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
 struct rte_mempool_objsz {
 	uint32_t elt_size;     /**< Size of an element. */
@@ -144,13 +148,17 @@ struct rte_mempool_objsz {
  */
 struct rte_mempool {
 	char name[RTE_MEMPOOL_NAMESIZE]; /**< Name of mempool. */
-	struct rte_ring *ring;           /**< Ring to store objects. */
+	struct rte_ring *ring;           /**< Ring to store objects, if the
+					      pool handler is ring based. */
+	void *pool_data;                 /**< Private data of the handler. */
+	int32_t ops_index;               /**< Index of the pool handler in
+					      rte_mempool_ops_table. */
 	phys_addr_t phys_addr;           /**< Phys. addr. of mempool struct. */
 	int flags;                       /**< Flags of the mempool. */
+	int socket_id;                   /**< Socket id passed at mempool
+					      creation. */
 	uint32_t size;                   /**< Size of the mempool. */
 	uint32_t cache_size;             /**< Size of per-lcore local cache. */
-	uint32_t cache_flushthresh;
-	/**< Threshold before we flush excess elements. */
 
 	uint32_t elt_size;               /**< Size of an element. */
 	uint32_t header_size;            /**< Size of header (before elt). */
@@ -158,10 +166,11 @@ struct rte_mempool {
 
 	unsigned private_data_size;      /**< Size of private data. */
 
-#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	/** Per-lcore local cache. */
-	struct rte_mempool_cache local_cache[RTE_MAX_LCORE];
-#endif
+	/**
+	 * Per-lcore local caches, stored after the mempool header.
+	 * NULL if cache_size is 0.
+	 */
+	struct rte_mempool_cache *local_cache;
 
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
 	/** Per-lcore statistics. */
@@ -183,6 +192,151 @@ struct rte_mempool {
 
 }  __rte_cache_aligned;
 
+#define RTE_MEMPOOL_OPS_NAMESIZE 32 /**< Max length of ops struct name. */
+
+/** Name of the default ring handler, multi-producer/multi-consumer. */
+#define RTE_MEMPOOL_OPS_RING_MP_MC	"ring_mp_mc"
+/** Name of the single-producer/single-consumer ring handler. */
+#define RTE_MEMPOOL_OPS_RING_SP_SC	"ring_sp_sc"
+/** Name of the multi-producer/single-consumer ring handler. */
+#define RTE_MEMPOOL_OPS_RING_MP_SC	"ring_mp_sc"
+/** Name of the single-producer/multi-consumer ring handler. */
+#define RTE_MEMPOOL_OPS_RING_SP_MC	"ring_sp_mc"
+/** Name of the LIFO stack handler. */
+#define RTE_MEMPOOL_OPS_STACK		"stack"
+
+/**
+ * Prototype for the handler function allocating the common pool of a
+ * mempool, able to store mp->size objects. It can use mp->pool_data to
+ * store its private data.
+ */
+typedef int (*rte_mempool_alloc_t)(struct rte_mempool *mp);
+
+/** Prototype for the handler function freeing the common pool. */
+typedef void (*rte_mempool_free_t)(struct rte_mempool *mp);
+
+/**
+ * Prototype for the handler function storing n objects in the common pool.
+ * Returns 0 on success, or a negative value if the objects cannot all be
+ * stored.
+ */
+typedef int (*rte_mempool_enqueue_t)(struct rte_mempool *mp,
+		void * const *obj_table, unsigned n);
+
+/**
+ * Prototype for the handler function getting n objects from the common
+ * pool. Either all n objects are dequeued and 0 is returned, or none is and
+ * a negative value is returned.
+ */
+typedef int (*rte_mempool_dequeue_t)(struct rte_mempool *mp,
+		void **obj_table, unsigned n);
+
+/** Prototype for the handler function counting objects in the pool. */
+typedef unsigned (*rte_mempool_get_count_t)(const struct rte_mempool *mp);
+
+/**
+ * A pool handler, implementing the common pool of free objects used behind
+ * the per-lcore caches.
+ */
+struct rte_mempool_ops {
+	char name[RTE_MEMPOOL_OPS_NAMESIZE]; /**< Name of handler. */
+	rte_mempool_alloc_t alloc;           /**< Allocate common pool. */
+	rte_mempool_free_t free;             /**< Free common pool. */
+	rte_mempool_enqueue_t enqueue;       /**< Enqueue objects. */
+	rte_mempool_dequeue_t dequeue;       /**< Dequeue objects. */
+	rte_mempool_get_count_t get_count;   /**< Get number of objects. */
+} __rte_cache_aligned;
+
+#define RTE_MEMPOOL_MAX_OPS_IDX 16  /**< Max registered handlers. */
+
+/**
+ * Table of the registered pool handlers. A mempool stores the index of
+ * its handler rather than a pointer to it, so that it is valid in all
+ * processes, as long as they register the same handlers in the same order.
+ */
+struct rte_mempool_ops_table {
+	rte_spinlock_t sl;     /**< Spinlock for add/delete. */
+	uint32_t num_ops;      /**< Number of used ops structs in the table. */
+	/** Storage for all possible handlers. */
+	struct rte_mempool_ops ops[RTE_MEMPOOL_MAX_OPS_IDX];
+} __rte_cache_aligned;
+
+/** Array of registered pool handlers. */
+extern struct rte_mempool_ops_table rte_mempool_ops_table;
+
+/**
+ * @internal Get the handler of a mempool from its index.
+ */
+static inline struct rte_mempool_ops *
+rte_mempool_get_ops(int ops_index)
+{
+#ifdef RTE_LIBRTE_MEMPOOL_DEBUG
+	if (ops_index < 0 || ops_index >= RTE_MEMPOOL_MAX_OPS_IDX)
+		rte_panic("invalid mempool ops index %d\n", ops_index);
+#endif
+	return &rte_mempool_ops_table.ops[ops_index];
+}
+
+/**
+ * @internal Wrapper for the handler dequeue callback.
+ */
+static inline int
+rte_mempool_ops_dequeue_bulk(struct rte_mempool *mp,
+		void **obj_table, unsigned n)
+{
+	struct rte_mempool_ops *ops;
+
+	ops = rte_mempool_get_ops(mp->ops_index);
+	return ops->dequeue(mp, obj_table, n);
+}
+
+/**
+ * @internal Wrapper for the handler enqueue callback.
+ */
+static inline int
+rte_mempool_ops_enqueue_bulk(struct rte_mempool *mp, void * const *obj_table,
+		unsigned n)
+{
+	struct rte_mempool_ops *ops;
+
+	ops = rte_mempool_get_ops(mp->ops_index);
+	return ops->enqueue(mp, obj_table, n);
+}
+
+/**
+ * Register a pool handler.
+ *
+ * @param ops
+ *   Pointer to the handler structure, which is copied in the table.
+ * @return
+ *   - >=0: Success; the index of the handler in the table.
+ *   - -EINVAL: some callbacks are missing.
+ *   - -EEXIST: a handler with the same name is already registered.
+ *   - -ENOSPC: the table of handlers is full.
+ */
+int rte_mempool_register_ops(const struct rte_mempool_ops *ops);
+
+/**
+ * Get the index of a registered pool handler from its name.
+ *
+ * @param name
+ *   Name of the handler.
+ * @return
+ *   The index of the handler, or -ENOENT if it is not registered.
+ */
+int rte_mempool_ops_lookup(const char *name);
+
+/**
+ * Macro to statically register a pool handler at startup, before
+ * rte_eal_init().
+ */
+#define MEMPOOL_REGISTER_OPS(ops)					\
+	void mp_hdlr_init_##ops(void);					\
+	void __attribute__((constructor, used)) mp_hdlr_init_##ops(void)\
+	{								\
+		rte_mempool_register_ops(&ops);				\
+	}
+
 #define MEMPOOL_F_NO_SPREAD      0x0001 /**< Do not spread in memory. */
 #define MEMPOOL_F_NO_CACHE_ALIGN 0x0002 /**< Do not align objs on cache lines.*/
 #define MEMPOOL_F_SP_PUT         0x0004 /**< Default put is "single-producer".*/
@@ -215,10 +369,14 @@ struct rte_mempool {
  *   Pointer to the memory pool.
  * @param pgn
  *   Number of page used to store mempool objects.
+ * @param cs
+ *   Size of the per-lcore cache. The per-lcore caches are only
+ *   allocated if it is not 0.
  */
-#define	MEMPOOL_HEADER_SIZE(mp, pgn)	(sizeof(*(mp)) + \
+#define	MEMPOOL_HEADER_SIZE(mp, pgn, cs)	(sizeof(*(mp)) + \
 	RTE_ALIGN_CEIL(((pgn) - RTE_DIM((mp)->elt_pa)) * \
-	sizeof ((mp)->elt_pa[0]), RTE_CACHE_LINE_SIZE))
+	sizeof ((mp)->elt_pa[0]), RTE_CACHE_LINE_SIZE) + \
+	((cs) == 0 ? 0 : sizeof(struct rte_mempool_cache) * RTE_MAX_LCORE))
 
 /**
  * Returns TRUE if whole mempool is allocated in one contiguous block of memory.
@@ -536,6 +694,39 @@ rte_mempool_create(const char *name, unsigned n, unsigned elt_size,
 		   rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
 		   int socket_id, unsigned flags);
 
+/**
+ * Creates a new mempool named *name* in memory, using the pool handler
+ * *ops_name* to store the objects that are not in a per-lcore cache.
+ *
+ * The built-in handlers are:
+ *  - RTE_MEMPOOL_OPS_RING_MP_MC, RTE_MEMPOOL_OPS_RING_SP_SC,
+ *    RTE_MEMPOOL_OPS_RING_MP_SC and RTE_MEMPOOL_OPS_RING_SP_MC: a ring
+ *    with the given producer/consumer synchronization. The single
+ *    producer/consumer variants avoid any atomic operation, but must then
+ *    only be accessed by one lcore at a time on that side.
+ *  - RTE_MEMPOOL_OPS_STACK: a spinlock-protected LIFO stack, which hands
+ *    out the most recently freed, thus most likely cache-hot, objects first.
+ *
+ * @param ops_name
+ *   Name of a registered pool handler. If NULL, a ring handler is chosen
+ *   according to MEMPOOL_F_SP_PUT and MEMPOOL_F_SC_GET, as done by
+ *   rte_mempool_create().
+ *
+ * See rte_mempool_create() for the other parameters.
+ *
+ * @return
+ *   The pointer to the new allocated mempool, on success. NULL on error
+ *   with rte_errno set appropriately. In addition to the values returned
+ *   by rte_mempool_create(), rte_errno can be ENOENT if no handler named
+ *   *ops_name* is registered.
+ */
+struct rte_mempool *
+rte_mempool_create_with_ops(const char *name, unsigned n, unsigned elt_size,
+		unsigned cache_size, unsigned private_data_size,
+		rte_mempool_ctor_t *mp_init, void *mp_init_arg,
+		rte_mempool_obj_ctor_t *obj_init, void *obj_init_arg,
+		int socket_id, unsigned flags, const char *ops_name);
+
 /**
  * Creates a new mempool named *name* in memory.
  *
@@ -737,6 +928,83 @@ rte_dom0_mempool_create(const char *name, unsigned n, unsigned elt_size,
  */
 void rte_mempool_dump(FILE *f, const struct rte_mempool *mp);
 
+/**
+ * Create a user-owned mempool cache.
+ *
+ * This can be used by non-EAL threads, which have no per-lcore cache, or
+ * to use a cache size different from the one of the mempool. The cache
+ * is not bound to a mempool: it is passed to rte_mempool_generic_get()
+ * and rte_mempool_generic_put(), and must be flushed with
+ * rte_mempool_cache_flush() before being used with another mempool.
+ * It must not be used by several threads at the same time.
+ *
+ * @param size
+ *   Size of the cache, between 1 and RTE_MEMPOOL_CACHE_MAX_SIZE.
+ * @param socket_id
+ *   The socket identifier where the cache memory is allocated, or
+ *   SOCKET_ID_ANY.
+ * @return
+ *   The pointer to the new cache on success. NULL on error with rte_errno
+ *   set appropriately. Possible rte_errno values include:
+ *    - EINVAL - invalid cache size
+ *    - ENOMEM - not enough memory to allocate the cache
+ */
+struct rte_mempool_cache *
+rte_mempool_cache_create(uint32_t size, int socket_id);
+
+/**
+ * Free a user-owned mempool cache. It must have been flushed before.
+ *
+ * @param cache
+ *   A pointer to the cache, created with rte_mempool_cache_create().
+ */
+void
+rte_mempool_cache_free(struct rte_mempool_cache *cache);
+
+/**
+ * Put all the objects of a cache back in the common pool of a mempool.
+ *
+ * @param cache
+ *   A pointer to the cache.
+ * @param mp
+ *   A pointer to the mempool the objects of the cache belong to.
+ */
+static inline void __attribute__((always_inline))
+rte_mempool_cache_flush(struct rte_mempool_cache *cache,
+			struct rte_mempool *mp)
+{
+	if (cache->len == 0)
+		return;
+	rte_mempool_ops_enqueue_bulk(mp, cache->objs, cache->len);
+	cache->len = 0;
+}
+
+/**
+ * Get the per-lcore cache of a mempool.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param lcore_id
+ *   The logical core id.
+ * @return
+ *   A pointer to the mempool cache, or NULL if the mempool has no cache
+ *   or if lcore_id is not an EAL lcore.
+ */
+static inline struct rte_mempool_cache * __attribute__((always_inline))
+rte_mempool_default_cache(struct rte_mempool *mp, unsigned lcore_id)
+{
+#if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
+	if (mp->cache_size == 0 || lcore_id >= RTE_MAX_LCORE)
+		return NULL;
+
+	return &mp->local_cache[lcore_id];
+#else
+	RTE_SET_USED(mp);
+	RTE_SET_USED(lcore_id);
+	return NULL;
+#endif
+}
+
 /**
  * @internal Put several objects back in the mempool; used internally.
  * @param mp
@@ -746,43 +1014,39 @@ void rte_mempool_dump(FILE *f, const struct rte_mempool *mp);
  * @param n
  *   The number of objects to store back in the mempool, must be strictly
  *   positive.
+ * @param cache
+ *   A pointer to a mempool cache structure. May be NULL if not needed.
  * @param is_mp
  *   Mono-producer (0) or multi-producers (1).
  */
 static inline void __attribute__((always_inline))
-__mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
-		    unsigned n, int is_mp)
+__mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
+		      unsigned n, struct rte_mempool_cache *cache, int is_mp)
 {
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	struct rte_mempool_cache *cache;
 	uint32_t index;
 	void **cache_objs;
-	unsigned lcore_id = rte_lcore_id();
-	uint32_t cache_size = mp->cache_size;
-	uint32_t flushthresh = mp->cache_flushthresh;
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
 	/* increment stat now, adding in mempool always success */
 	__MEMPOOL_STAT_ADD(mp, put, n);
 
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	/* cache is not enabled or single producer or non-EAL thread */
-	if (unlikely(cache_size == 0 || is_mp == 0 ||
-		     lcore_id >= RTE_MAX_LCORE))
-		goto ring_enqueue;
+	/* no cache (not enabled or non-EAL thread) or single producer */
+	if (unlikely(cache == NULL || is_mp == 0))
+		goto pool_enqueue;
 
-	/* Go straight to ring if put would overflow mem allocated for cache */
+	/* Go straight to pool if put would overflow mem allocated for cache */
 	if (unlikely(n > RTE_MEMPOOL_CACHE_MAX_SIZE))
-		goto ring_enqueue;
+		goto pool_enqueue;
 
-	cache = &mp->local_cache[lcore_id];
 	cache_objs = &cache->objs[cache->len];
 
 	/*
 	 * The cache follows the following algorithm
 	 *   1. Add the objects to the cache
 	 *   2. Anything greater than the cache min value (if it crosses the
-	 *   cache flush threshold) is flushed to the ring.
+	 *   cache flush threshold) is flushed to the common pool.
 	 */
 
 	/* Add elements back into the cache */
@@ -791,35 +1055,54 @@ __mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 
 	cache->len += n;
 
-	if (cache->len >= flushthresh) {
-		rte_ring_mp_enqueue_bulk(mp->ring, &cache->objs[cache_size],
-				cache->len - cache_size);
-		cache->len = cache_size;
+	if (cache->len >= cache->flushthresh) {
+		rte_mempool_ops_enqueue_bulk(mp, &cache->objs[cache->size],
+				cache->len - cache->size);
+		cache->len = cache->size;
 	}
 
 	return;
 
-ring_enqueue:
+pool_enqueue:
+#else
+	RTE_SET_USED(cache);
+	RTE_SET_USED(is_mp);
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
-	/* push remaining objects in ring */
+	/* push remaining objects in the common pool */
 #ifdef RTE_LIBRTE_MEMPOOL_DEBUG
-	if (is_mp) {
-		if (rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n) < 0)
-			rte_panic("cannot put objects in mempool\n");
-	}
-	else {
-		if (rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n) < 0)
-			rte_panic("cannot put objects in mempool\n");
-	}
+	if (rte_mempool_ops_enqueue_bulk(mp, obj_table, n) < 0)
+		rte_panic("cannot put objects in mempool\n");
 #else
-	if (is_mp)
-		rte_ring_mp_enqueue_bulk(mp->ring, obj_table, n);
-	else
-		rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n);
+	rte_mempool_ops_enqueue_bulk(mp, obj_table, n);
 #endif
 }
 
+/**
+ * Put several objects back in the mempool, using the given cache.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the mempool from the obj_table.
+ * @param cache
+ *   A pointer to a mempool cache structure, either returned by
+ *   rte_mempool_default_cache() or rte_mempool_cache_create(). May be
+ *   NULL to put the objects directly in the common pool.
+ * @param is_mp
+ *   Mono-producer (0) or multi-producers (1). The cache is only used in
+ *   multi-producers mode.
+ */
+static inline void __attribute__((always_inline))
+rte_mempool_generic_put(struct rte_mempool *mp, void * const *obj_table,
+			unsigned n, struct rte_mempool_cache *cache, int is_mp)
+{
+	__mempool_check_cookies(mp, obj_table, n, 0);
+	__mempool_generic_put(mp, obj_table, n, cache, is_mp);
+}
+
 
 /**
  * Put several objects back in the mempool (multi-producers safe).
@@ -835,8 +1118,10 @@ static inline void __attribute__((always_inline))
 rte_mempool_mp_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 			unsigned n)
 {
-	__mempool_check_cookies(mp, obj_table, n, 0);
-	__mempool_put_bulk(mp, obj_table, n, 1);
+	struct rte_mempool_cache *cache;
+
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	rte_mempool_generic_put(mp, obj_table, n, cache, 1);
 }
 
 /**
@@ -853,8 +1138,7 @@ static inline void
 rte_mempool_sp_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 			unsigned n)
 {
-	__mempool_check_cookies(mp, obj_table, n, 0);
-	__mempool_put_bulk(mp, obj_table, n, 0);
+	rte_mempool_generic_put(mp, obj_table, n, NULL, 0);
 }
 
 /**
@@ -875,8 +1159,11 @@ static inline void __attribute__((always_inline))
 rte_mempool_put_bulk(struct rte_mempool *mp, void * const *obj_table,
 		     unsigned n)
 {
-	__mempool_check_cookies(mp, obj_table, n, 0);
-	__mempool_put_bulk(mp, obj_table, n, !(mp->flags & MEMPOOL_F_SP_PUT));
+	struct rte_mempool_cache *cache;
+
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	rte_mempool_generic_put(mp, obj_table, n, cache,
+				!(mp->flags & MEMPOOL_F_SP_PUT));
 }
 
 /**
@@ -933,47 +1220,45 @@ rte_mempool_put(struct rte_mempool *mp, void *obj)
  *   A pointer to a table of void * pointers (objects).
  * @param n
  *   The number of objects to get, must be strictly positive.
+ * @param cache
+ *   A pointer to a mempool cache structure. May be NULL if not needed.
  * @param is_mc
  *   Mono-consumer (0) or multi-consumers (1).
  * @return
  *   - >=0: Success; number of objects supplied.
- *   - <0: Error; code of ring dequeue function.
+ *   - <0: Error; code of the pool handler dequeue function.
  */
 static inline int __attribute__((always_inline))
-__mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
-		   unsigned n, int is_mc)
+__mempool_generic_get(struct rte_mempool *mp, void **obj_table,
+		      unsigned n, struct rte_mempool_cache *cache, int is_mc)
 {
 	int ret;
 #if RTE_MEMPOOL_CACHE_MAX_SIZE > 0
-	struct rte_mempool_cache *cache;
 	uint32_t index, len;
 	void **cache_objs;
-	unsigned lcore_id = rte_lcore_id();
-	uint32_t cache_size = mp->cache_size;
 
-	/* cache is not enabled or single consumer */
-	if (unlikely(cache_size == 0 || is_mc == 0 ||
-		     n >= cache_size || lcore_id >= RTE_MAX_LCORE))
-		goto ring_dequeue;
+	/* no cache (not enabled or non-EAL thread) or single consumer */
+	if (unlikely(cache == NULL || is_mc == 0 || n >= cache->size))
+		goto pool_dequeue;
 
-	cache = &mp->local_cache[lcore_id];
 	cache_objs = cache->objs;
 
 	/* Can this be satisfied from the cache? */
 	if (cache->len < n) {
 		/* No. Backfill the cache first, and then fill from it */
-		uint32_t req = n + (cache_size - cache->len);
+		uint32_t req = n + (cache->size - cache->len);
 
 		/* How many do we require i.e. number to fill the cache + the request */
-		ret = rte_ring_mc_dequeue_bulk(mp->ring, &cache->objs[cache->len], req);
+		ret = rte_mempool_ops_dequeue_bulk(mp,
+				&cache->objs[cache->len], req);
 		if (unlikely(ret < 0)) {
 			/*
 			 * In the offchance that we are buffer constrained,
 			 * where we are not able to allocate cache + n, go to
-			 * the ring directly. If that fails, we are truly out of
-			 * buffers.
+			 * the common pool directly. If that fails, we are
+			 * truly out of buffers.
 			 */
-			goto ring_dequeue;
+			goto pool_dequeue;
 		}
 
 		cache->len += req;
@@ -989,14 +1274,14 @@ __mempool_get_bulk(struct rte_mempool *mp, void **obj_table,
 
 	return 0;
 
-ring_dequeue:
+pool_dequeue:
+#else
+	RTE_SET_USED(cache);
+	RTE_SET_USED(is_mc);
 #endif /* RTE_MEMPOOL_CACHE_MAX_SIZE > 0 */
 
-	/* get remaining objects from ring */
-	if (is_mc)
-		ret = rte_ring_mc_dequeue_bulk(mp->ring, obj_table, n);
-	else
-		ret = rte_ring_sc_dequeue_bulk(mp->ring, obj_table, n);
+	/* get remaining objects from the common pool */
+	ret = rte_mempool_ops_dequeue_bulk(mp, obj_table, n);
 
 	if (ret < 0)
 		__MEMPOOL_STAT_ADD(mp, get_fail, n);
@@ -1006,6 +1291,40 @@ ring_dequeue:
 	return ret;
 }
 
+/**
+ * Get several objects from the mempool, using the given cache.
+ *
+ * If a cache is given, objects will be retrieved first from it,
+ * subsequently from the common pool.
+ *
+ * @param mp
+ *   A pointer to the mempool structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to get from mempool to obj_table.
+ * @param cache
+ *   A pointer to a mempool cache structure, either returned by
+ *   rte_mempool_default_cache() or rte_mempool_cache_create(). May be
+ *   NULL to get the objects directly from the common pool.
+ * @param is_mc
+ *   Mono-consumer (0) or multi-consumers (1). The cache is only used in
+ *   multi-consumers mode.
+ * @return
+ *   - 0: Success; objects taken.
+ *   - -ENOENT: Not enough entries in the mempool; no object is retrieved.
+ */
+static inline int __attribute__((always_inline))
+rte_mempool_generic_get(struct rte_mempool *mp, void **obj_table, unsigned n,
+			struct rte_mempool_cache *cache, int is_mc)
+{
+	int ret;
+	ret = __mempool_generic_get(mp, obj_table, n, cache, is_mc);
+	if (ret == 0)
+		__mempool_check_cookies(mp, obj_table, n, 1);
+	return ret;
+}
+
 /**
  * Get several objects from the mempool (multi-consumers safe).
  *
@@ -1027,11 +1346,10 @@ ring_dequeue:
 static inline int __attribute__((always_inline))
 rte_mempool_mc_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 {
-	int ret;
-	ret = __mempool_get_bulk(mp, obj_table, n, 1);
-	if (ret == 0)
-		__mempool_check_cookies(mp, obj_table, n, 1);
-	return ret;
+	struct rte_mempool_cache *cache;
+
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	return rte_mempool_generic_get(mp, obj_table, n, cache, 1);
 }
 
 /**
@@ -1056,11 +1374,7 @@ rte_mempool_mc_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 static inline int __attribute__((always_inline))
 rte_mempool_sc_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 {
-	int ret;
-	ret = __mempool_get_bulk(mp, obj_table, n, 0);
-	if (ret == 0)
-		__mempool_check_cookies(mp, obj_table, n, 1);
-	return ret;
+	return rte_mempool_generic_get(mp, obj_table, n, NULL, 0);
 }
 
 /**
@@ -1088,12 +1402,11 @@ rte_mempool_sc_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 static inline int __attribute__((always_inline))
 rte_mempool_get_bulk(struct rte_mempool *mp, void **obj_table, unsigned n)
 {
-	int ret;
-	ret = __mempool_get_bulk(mp, obj_table, n,
-				 !(mp->flags & MEMPOOL_F_SC_GET));
-	if (ret == 0)
-		__mempool_check_cookies(mp, obj_table, n, 1);
-	return ret;
+	struct rte_mempool_cache *cache;
+
+	cache = rte_mempool_default_cache(mp, rte_lcore_id());
+	return rte_mempool_generic_get(mp, obj_table, n, cache,
+				       !(mp->flags & MEMPOOL_F_SC_GET));
 }
 
 /**
@@ -1291,7 +1604,8 @@ void rte_mempool_audit(const struct rte_mempool *mp);
  */
 static inline void *rte_mempool_get_priv(struct rte_mempool *mp)
 {
-	return (char *)mp + MEMPOOL_HEADER_SIZE(mp, mp->pg_num);
+	return (char *)mp +
+		MEMPOOL_HEADER_SIZE(mp, mp->pg_num, mp->cache_size);
 }
 
 /**
@@ -0,0 +1,156 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright(c) 2015 Intel Corporation. All rights reserved.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_errno.h>
+#include <rte_ring.h>
+#include <rte_mempool.h>
+
+/*
+ * Pool handlers storing objects in a ring, one per combination of
+ * producer/consumer synchronization. The multi-producer and
+ * multi-consumer ones still follow the MEMPOOL_F_SP_PUT and
+ * MEMPOOL_F_SC_GET flags of the mempool, through the ring flags.
+ */
+
+static int
+common_ring_mp_enqueue(struct rte_mempool *mp, void * const *obj_table,
+		unsigned n)
+{
+	return rte_ring_enqueue_bulk(mp->ring, obj_table, n);
+}
+
+static int
+common_ring_sp_enqueue(struct rte_mempool *mp, void * const *obj_table,
+		unsigned n)
+{
+	return rte_ring_sp_enqueue_bulk(mp->ring, obj_table, n);
+}
+
+static int
+common_ring_mc_dequeue(struct rte_mempool *mp, void **obj_table, unsigned n)
+{
+	return rte_ring_dequeue_bulk(mp->ring, obj_table, n);
+}
+
+static int
+common_ring_sc_dequeue(struct rte_mempool *mp, void **obj_table, unsigned n)
+{
+	return rte_ring_sc_dequeue_bulk(mp->ring, obj_table, n);
+}
+
+static unsigned
+common_ring_get_count(const struct rte_mempool *mp)
+{
+	return rte_ring_count(mp->ring);
+}
+
+static int
+common_ring_alloc(struct rte_mempool *mp)
+{
+	struct rte_mempool_ops *ops = rte_mempool_get_ops(mp->ops_index);
+	char rg_name[RTE_RING_NAMESIZE];
+	int rg_flags = 0;
+	int ret;
+
+	/* the ring flags follow the handler and the mempool flags */
+	if (ops->enqueue == common_ring_sp_enqueue ||
+			(mp->flags & MEMPOOL_F_SP_PUT))
+		rg_flags |= RING_F_SP_ENQ;
+	if (ops->dequeue == common_ring_sc_dequeue ||
+			(mp->flags & MEMPOOL_F_SC_GET))
+		rg_flags |= RING_F_SC_DEQ;
+
+	/* Ring functions will return appropriate errors if we are
+	 * running as a secondary process etc., so no checks made
+	 * in this function for that condition */
+	/*
+	 * Long names are truncated as in the memzone name of the mempool,
+	 * which is unique as well.
+	 */
+	ret = snprintf(rg_name, sizeof(rg_name), RTE_MEMPOOL_MZ_PREFIX "%.*s",
+		(int)(sizeof(rg_name) - sizeof(RTE_MEMPOOL_MZ_PREFIX)),
+		mp->name);
+	if (ret < 0 || ret >= (int)sizeof(rg_name))
+		return -ENAMETOOLONG;
+	mp->ring = rte_ring_create(rg_name, rte_align32pow2(mp->size + 1),
+		mp->socket_id, rg_flags);
+	if (mp->ring == NULL)
+		return -rte_errno;
+
+	mp->pool_data = mp->ring;
+	return 0;
+}
+
+static struct rte_mempool_ops ops_mp_mc = {
+	.name = RTE_MEMPOOL_OPS_RING_MP_MC,
+	.alloc = common_ring_alloc,
+	.free = NULL,
+	.enqueue = common_ring_mp_enqueue,
+	.dequeue = common_ring_mc_dequeue,
+	.get_count = common_ring_get_count,
+};
+
+static struct rte_mempool_ops ops_sp_sc = {
+	.name = RTE_MEMPOOL_OPS_RING_SP_SC,
+	.alloc = common_ring_alloc,
+	.free = NULL,
+	.enqueue = common_ring_sp_enqueue,
+	.dequeue = common_ring_sc_dequeue,
+	.get_count = common_ring_get_count,
+};
+
+static struct rte_mempool_ops ops_mp_sc = {
+	.name = RTE_MEMPOOL_OPS_RING_MP_SC,
+	.alloc = common_ring_alloc,
+	.free = NULL,
+	.enqueue = common_ring_mp_enqueue,
+	.dequeue = common_ring_sc_dequeue,
+	.get_count = common_ring_get_count,
+};
+
+static struct rte_mempool_ops ops_sp_mc = {
+	.name = RTE_MEMPOOL_OPS_RING_SP_MC,
+	.alloc = common_ring_alloc,
+	.free = NULL,
+	.enqueue = common_ring_sp_enqueue,
+	.dequeue = common_ring_mc_dequeue,
+	.get_count = common_ring_get_count,
+};
+
+MEMPOOL_REGISTER_OPS(ops_mp_mc);
+MEMPOOL_REGISTER_OPS(ops_sp_sc);
+MEMPOOL_REGISTER_OPS(ops_mp_sc);
+MEMPOOL_REGISTER_OPS(ops_sp_mc);
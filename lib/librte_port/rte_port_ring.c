@@ -101,6 +101,7 @@ struct rte_port_ring_writer {
 	struct rte_ring *ring;
 	uint32_t tx_burst_sz;
 	uint32_t tx_buf_count;
+	uint32_t zero_copy;
 };
 
 static void *
@@ -130,6 +131,9 @@ rte_port_ring_writer_create(void *params, int socket_id)
 	port->ring = conf->ring;
 	port->tx_burst_sz = conf->tx_burst_sz;
 	port->tx_buf_count = 0;
+	/* The ring slots can be written directly in these modes */
+	port->zero_copy = (conf->ring->prod.sync_type == RTE_RING_SYNC_ST) ||
+		(conf->ring->prod.sync_type == RTE_RING_SYNC_MT_HTS);
 
 	return port;
 }
@@ -148,6 +152,33 @@ send_burst(struct rte_port_ring_writer *p)
 	p->tx_buf_count = 0;
 }
 
+static inline void
+send_burst_zc(struct rte_port_ring_writer *p, struct rte_mbuf **pkts,
+	uint64_t pkts_mask)
+{
+	struct rte_ring_zc_data zcd;
+	uint32_t n_pkts = __builtin_popcountll(pkts_mask);
+	uint32_t nb_tx, i;
+
+	nb_tx = rte_ring_enqueue_zc_burst_start(p->ring, n_pkts, &zcd);
+
+	for (i = 0; pkts_mask; i++) {
+		uint32_t pkt_index = __builtin_ctzll(pkts_mask);
+		struct rte_mbuf *pkt = pkts[pkt_index];
+
+		if (i >= nb_tx)
+			rte_pktmbuf_free(pkt);
+		else if (i < zcd.n1)
+			zcd.ptr1[i] = pkt;
+		else
+			zcd.ptr2[i - zcd.n1] = pkt;
+		pkts_mask &= pkts_mask - 1;
+	}
+
+	if (nb_tx > 0)
+		rte_ring_enqueue_zc_finish(p->ring, nb_tx);
+}
+
 static int
 rte_port_ring_writer_tx(void *port, struct rte_mbuf *pkt)
 {
@@ -167,6 +198,13 @@ rte_port_ring_writer_tx_bulk(void *port,
 {
 	struct rte_port_ring_writer *p = (struct rte_port_ring_writer *) port;
 
+	/* Full burst with nothing buffered: write the ring slots directly */
+	if ((p->tx_buf_count == 0) && p->zero_copy &&
+		((uint32_t)__builtin_popcountll(pkts_mask) >= p->tx_burst_sz)) {
+		send_burst_zc(p, pkts, pkts_mask);
+		return 0;
+	}
+
 	if ((pkts_mask & (pkts_mask + 1)) == 0) {
 		uint64_t n_pkts = __builtin_popcountll(pkts_mask);
 		uint32_t i;
@@ -40,6 +40,8 @@
 #include <rte_eal_memconfig.h>
 #include <rte_errno.h>
 #include <rte_malloc.h>
+#include <rte_atomic.h>
+#include <rte_cycles.h>
 
 #include "rte_reorder.h"
 
@@ -71,6 +73,11 @@ struct rte_reorder_buffer {
 	char name[RTE_REORDER_NAMESIZE];
 	uint32_t min_seqn;  /**< Lowest seq. number that can be in the buffer */
 	unsigned int memsize; /**< memory area size of reorder buffer */
+	uint64_t timeout;   /**< TSC cycles before skipping a missing seq. number */
+	uint64_t wait_start; /**< TSC at which drain started waiting, or 0 */
+	rte_atomic64_t late;    /**< packets behind the window */
+	rte_atomic64_t dropped; /**< packets rejected, other than late ones */
+	uint64_t skipped;   /**< seq. numbers skipped by drain on timeout */
 	struct cir_buffer ready_buf; /**< temp buffer for dequeued entries */
 	struct cir_buffer order_buf; /**< buffer used to reorder entries */
 } __rte_cache_aligned;
@@ -188,11 +195,13 @@ void
 rte_reorder_reset(struct rte_reorder_buffer *b)
 {
 	char name[RTE_REORDER_NAMESIZE];
+	uint64_t timeout = b->timeout;
 
 	rte_reorder_free_mbufs(b);
 	snprintf(name, sizeof(name), "%s", b->name);
 	/* No error checking as current values should be valid */
 	rte_reorder_init(b, b->memsize, name, b->order_buf.size);
+	b->timeout = timeout;
 }
 
 static void
@@ -368,12 +377,144 @@ rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
 		order_buf->entries[position] = mbuf;
 	} else {
 		/* Put in handling for enqueue straight to output */
+		if ((int32_t)offset < 0)
+			rte_atomic64_inc(&b->late);
+		else
+			rte_atomic64_inc(&b->dropped);
 		rte_errno = ERANGE;
 		return -1;
 	}
 	return 0;
 }
 
+/* the order buffer entries are pointer sized, compare-and-set them as such */
+static inline int
+rte_reorder_entry_cmpset(struct rte_mbuf **entry, struct rte_mbuf *old,
+		struct rte_mbuf *new)
+{
+#ifdef RTE_ARCH_64
+	return rte_atomic64_cmpset((volatile uint64_t *)entry,
+			(uint64_t)(uintptr_t)old, (uint64_t)(uintptr_t)new);
+#else
+	return rte_atomic32_cmpset((volatile uint32_t *)entry,
+			(uint32_t)(uintptr_t)old, (uint32_t)(uintptr_t)new);
+#endif
+}
+
+static inline uint32_t
+rte_reorder_min_seqn(const struct rte_reorder_buffer *b)
+{
+	return *(const volatile uint32_t *)&b->min_seqn;
+}
+
+int
+rte_reorder_insert_mp(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf)
+{
+	struct cir_buffer *order_buf = &b->order_buf;
+	struct rte_mbuf **entry;
+	uint32_t offset;
+
+	/*
+	 * The window is only moved by the drain, so unlike the single
+	 * producer insert, early packets are not made room for. The entry of
+	 * a sequence number does not depend on the window position, as the
+	 * order buffer head always is min_seqn modulo the buffer size.
+	 */
+	offset = mbuf->seqn - rte_reorder_min_seqn(b);
+	if ((int32_t)offset < 0) {
+		rte_atomic64_inc(&b->late);
+		rte_errno = ERANGE;
+		return -1;
+	}
+	if (offset >= order_buf->size) {
+		rte_atomic64_inc(&b->dropped);
+		rte_errno = ENOSPC;
+		return -1;
+	}
+
+	entry = &order_buf->entries[mbuf->seqn & order_buf->mask];
+	if (!rte_reorder_entry_cmpset(entry, NULL, mbuf)) {
+		/* duplicate sequence number */
+		rte_atomic64_inc(&b->dropped);
+		rte_errno = EEXIST;
+		return -1;
+	}
+
+	/*
+	 * The drain may have skipped this sequence number between the window
+	 * check and the insertion: take the packet back, unless the drain
+	 * already found it.
+	 */
+	if (unlikely((int32_t)(mbuf->seqn - rte_reorder_min_seqn(b)) < 0) &&
+			rte_reorder_entry_cmpset(entry, mbuf, NULL)) {
+		rte_atomic64_inc(&b->late);
+		rte_errno = ERANGE;
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Called by drain when the next sequence number is missing. Once it has been
+ * waited for during the configured timeout, skips it along with the following
+ * missing ones, up to the first packet in the order buffer. Returns the
+ * number of sequence numbers skipped.
+ */
+static unsigned
+rte_reorder_skip_missing(struct rte_reorder_buffer *b)
+{
+	struct cir_buffer *order_buf = &b->order_buf,
+			*ready_buf = &b->ready_buf;
+	uint64_t now = rte_get_tsc_cycles();
+	unsigned int i, skip, head;
+
+	if (b->wait_start == 0) {
+		b->wait_start = now;
+		return 0;
+	}
+	if (now - b->wait_start < b->timeout)
+		return 0;
+
+	/* nothing to skip for if no packet is waiting behind the gap */
+	for (skip = 1; skip < order_buf->size; skip++)
+		if (order_buf->entries[(order_buf->head + skip) &
+				order_buf->mask] != NULL)
+			break;
+	if (skip == order_buf->size) {
+		b->wait_start = now;
+		return 0;
+	}
+
+	head = order_buf->head;
+	order_buf->head = (head + skip) & order_buf->mask;
+	b->min_seqn += skip;
+	b->skipped += skip;
+	b->wait_start = 0;
+
+	/*
+	 * A concurrent rte_reorder_insert_mp() may have checked the window
+	 * before it moved and inserted a skipped packet: return such packets
+	 * as late ones, through the ready buffer.
+	 */
+	rte_mb();
+	for (i = 0; i < skip; i++) {
+		struct rte_mbuf **entry =
+				&order_buf->entries[(head + i) & order_buf->mask];
+		struct rte_mbuf *m = *(struct rte_mbuf * const volatile *)entry;
+
+		if (m == NULL ||
+				((ready_buf->head + 1) & ready_buf->mask) ==
+				ready_buf->tail ||
+				!rte_reorder_entry_cmpset(entry, m, NULL))
+			continue;
+		rte_atomic64_inc(&b->late);
+		ready_buf->entries[ready_buf->head] = m;
+		ready_buf->head = (ready_buf->head + 1) & ready_buf->mask;
+	}
+
+	return skip;
+}
+
 unsigned int
 rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 		unsigned max_mbufs)
@@ -382,6 +523,7 @@ rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 
 	struct cir_buffer *order_buf = &b->order_buf,
 			*ready_buf = &b->ready_buf;
+	struct rte_mbuf *m;
 
 	/* Try to fetch requested number of mbufs from ready buffer */
 	while ((drain_cnt < max_mbufs) && (ready_buf->tail != ready_buf->head)) {
@@ -393,13 +535,58 @@ rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 	 * If requested number of buffers not fetched from ready buffer, fetch
 	 * remaining buffers from order buffer
 	 */
-	while ((drain_cnt < max_mbufs) &&
-			(order_buf->entries[order_buf->head] != NULL)) {
-		mbufs[drain_cnt++] = order_buf->entries[order_buf->head];
-		order_buf->entries[order_buf->head] = NULL;
+	while (drain_cnt < max_mbufs) {
+		struct rte_mbuf **entry = &order_buf->entries[order_buf->head];
+
+		m = *(struct rte_mbuf * const volatile *)entry;
+		if (m == NULL) {
+			/* optionally give up waiting for the missing packet */
+			if (b->timeout == 0 || rte_reorder_skip_missing(b) == 0)
+				break;
+			continue;
+		}
+
+		if (unlikely(m->seqn != b->min_seqn)) {
+			/* late packet inserted while the window moved */
+			if (rte_reorder_entry_cmpset(entry, m, NULL)) {
+				rte_atomic64_inc(&b->late);
+				mbufs[drain_cnt++] = m;
+			}
+			continue;
+		}
+
+		mbufs[drain_cnt++] = m;
+		*entry = NULL;
+		/* the entry is free before the window moves */
+		rte_compiler_barrier();
 		b->min_seqn++;
 		order_buf->head = (order_buf->head + 1) & order_buf->mask;
+		b->wait_start = 0;
 	}
 
 	return drain_cnt;
 }
+
+void
+rte_reorder_set_timeout(struct rte_reorder_buffer *b, uint64_t timeout)
+{
+	b->timeout = timeout;
+	b->wait_start = 0;
+}
+
+void
+rte_reorder_stats_get(struct rte_reorder_buffer *b,
+		struct rte_reorder_stats *stats)
+{
+	stats->late = rte_atomic64_read(&b->late);
+	stats->skipped = b->skipped;
+	stats->dropped = rte_atomic64_read(&b->dropped);
+}
+
+void
+rte_reorder_stats_reset(struct rte_reorder_buffer *b)
+{
+	rte_atomic64_clear(&b->late);
+	rte_atomic64_clear(&b->dropped);
+	b->skipped = 0;
+}
@@ -48,8 +48,22 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 struct rte_reorder_buffer;
 
+/**
+ * Reorder buffer statistics
+ */
+struct rte_reorder_stats {
+	uint64_t late;    /**< Packets rejected by insert, or returned out of
+			       order by drain, as their sequence number had
+			       already been drained or skipped */
+	uint64_t skipped; /**< Missing sequence numbers skipped by drain */
+	uint64_t dropped; /**< Packets rejected by insert for being too early
+			       or having a duplicate sequence number */
+};
+
 /**
  * Create a new reorder buffer instance
  *
@@ -152,13 +166,48 @@ rte_reorder_free(struct rte_reorder_buffer *b);
 int
 rte_reorder_insert(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf);
 
+/**
+ * Insert given mbuf in reorder buffer in its correct position, from any lcore
+ *
+ * Multi-producer safe version of rte_reorder_insert(): it can be called
+ * concurrently by several lcores, and concurrently with rte_reorder_drain()
+ * called by a single lcore, e.g. directly by the workers of a distributor.
+ * Each mbuf is atomically set in its entry, without any lock.
+ *
+ * Unlike rte_reorder_insert(), early mbufs are not made room for by moving
+ * the window, which is only moved by the drain: they are rejected, and
+ * the caller may retry the insertion later. The window can still move past
+ * missing mbufs with rte_reorder_set_timeout(). This function must not be
+ * mixed with rte_reorder_insert() on the same reorder buffer.
+ *
+ * @param b
+ *   Reorder buffer where the mbuf has to be inserted.
+ * @param mbuf
+ *   mbuf of packet that needs to be inserted in reorder buffer.
+ * @return
+ *   0 on success
+ *   -1 on error
+ *   On error case, rte_errno will be set appropriately:
+ *    - ERANGE - Late mbuf, whose sequence number has already been drained or
+ *      skipped.
+ *    - ENOSPC - Early mbuf beyond the current window, which may be inserted
+ *      after a drain.
+ *    - EEXIST - An mbuf with the same sequence number is already in the
+ *      buffer.
+ */
+int
+rte_reorder_insert_mp(struct rte_reorder_buffer *b, struct rte_mbuf *mbuf);
+
 /**
  * Fetch reordered buffers
  *
  * Returns a set of in-order buffers from the reorder buffer structure. Gaps
  * may be present in the sequence numbers of the mbuf if packets have been
  * delayed too long before reaching the reorder window, or have been previously
- * dropped by the system.
+ * dropped by the system, or were skipped after the timeout set with
+ * rte_reorder_set_timeout(). When used along with rte_reorder_insert_mp(),
+ * late mbufs that were inserted while the window moved past them are also
+ * returned, out of order.
  *
  * @param b
  *   Reorder buffer instance from which packets are to be drained
@@ -173,6 +222,45 @@ unsigned int
 rte_reorder_drain(struct rte_reorder_buffer *b, struct rte_mbuf **mbufs,
 		unsigned max_mbufs);
 
+/**
+ * Set the drain timeout of a reorder buffer
+ *
+ * When the next sequence number expected by rte_reorder_drain() is missing,
+ * the drain normally waits for it forever, or until an early mbuf moves the
+ * window. With a timeout set, once the drain has been waiting for this
+ * number of TSC cycles while other mbufs are in the buffer, the missing
+ * sequence numbers up to the next mbuf present are skipped, and the mbufs
+ * that arrive for them afterwards are treated as late ones.
+ *
+ * @param b
+ *   Reorder buffer instance
+ * @param timeout
+ *   Timeout in TSC cycles, or 0 to wait forever (default).
+ */
+void
+rte_reorder_set_timeout(struct rte_reorder_buffer *b, uint64_t timeout);
+
+/**
+ * Get the statistics of a reorder buffer
+ *
+ * @param b
+ *   Reorder buffer instance
+ * @param stats
+ *   Structure to be filled in with the statistics
+ */
+void
+rte_reorder_stats_get(struct rte_reorder_buffer *b,
+		struct rte_reorder_stats *stats);
+
+/**
+ * Reset the statistics of a reorder buffer
+ *
+ * @param b
+ *   Reorder buffer instance
+ */
+void
+rte_reorder_stats_reset(struct rte_reorder_buffer *b);
+
 #ifdef __cplusplus
 }
 #endif
@@ -99,12 +99,67 @@ EAL_REGISTER_TAILQ(rte_ring_tailq)
 /* true if x is a power of 2 */
 #define POWEROF2(x) ((((x)-1) & (x)) == 0)
 
+/* default maximum distance between head and tail in RTS mode */
+#define RTS_DEF_HTD_MAX(count) ((count) / 8)
+
+/* get the producers and consumers sync modes from the ring flags */
+static int
+get_sync_types(unsigned flags, enum rte_ring_sync_type *prod_st,
+	enum rte_ring_sync_type *cons_st)
+{
+	switch (flags & (RING_F_SP_ENQ | RING_F_MP_RTS_ENQ |
+			RING_F_MP_HTS_ENQ)) {
+	case 0:
+		*prod_st = RTE_RING_SYNC_MT;
+		break;
+	case RING_F_SP_ENQ:
+		*prod_st = RTE_RING_SYNC_ST;
+		break;
+	case RING_F_MP_RTS_ENQ:
+		*prod_st = RTE_RING_SYNC_MT_RTS;
+		break;
+	case RING_F_MP_HTS_ENQ:
+		*prod_st = RTE_RING_SYNC_MT_HTS;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	switch (flags & (RING_F_SC_DEQ | RING_F_MC_RTS_DEQ |
+			RING_F_MC_HTS_DEQ)) {
+	case 0:
+		*cons_st = RTE_RING_SYNC_MT;
+		break;
+	case RING_F_SC_DEQ:
+		*cons_st = RTE_RING_SYNC_ST;
+		break;
+	case RING_F_MC_RTS_DEQ:
+		*cons_st = RTE_RING_SYNC_MT_RTS;
+		break;
+	case RING_F_MC_HTS_DEQ:
+		*cons_st = RTE_RING_SYNC_MT_HTS;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
 /* return the size of memory occupied by a ring */
 ssize_t
-rte_ring_get_memsize(unsigned count)
+rte_ring_get_memsize_elem(unsigned esize, unsigned count)
 {
 	ssize_t sz;
 
+	/* the copy functions work on 4 bytes words */
+	if (esize == 0 || (esize & 0x3) != 0) {
+		RTE_LOG(ERR, RING,
+			"Requested object size is invalid, must be a non-zero "
+			"multiple of 4\n");
+		return -EINVAL;
+	}
+
 	/* count must be a power of 2 */
 	if ((!POWEROF2(count)) || (count > RTE_RING_SZ_MASK )) {
 		RTE_LOG(ERR, RING,
@@ -113,15 +168,23 @@ rte_ring_get_memsize(unsigned count)
 		return -EINVAL;
 	}
 
-	sz = sizeof(struct rte_ring) + count * sizeof(void *);
+	sz = sizeof(struct rte_ring) + (ssize_t)count * esize;
 	sz = RTE_ALIGN(sz, RTE_CACHE_LINE_SIZE);
 	return sz;
 }
 
+ssize_t
+rte_ring_get_memsize(unsigned count)
+{
+	return rte_ring_get_memsize_elem(sizeof(void *), count);
+}
+
 int
-rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
-	unsigned flags)
+rte_ring_init_elem(struct rte_ring *r, const char *name, unsigned esize,
+	unsigned count, unsigned flags)
 {
+	enum rte_ring_sync_type prod_st, cons_st;
+
 	/* compilation-time checks */
 	RTE_BUILD_BUG_ON((sizeof(struct rte_ring) &
 			  RTE_CACHE_LINE_MASK) != 0);
@@ -131,6 +194,15 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 #endif
 	RTE_BUILD_BUG_ON((offsetof(struct rte_ring, prod) &
 			  RTE_CACHE_LINE_MASK) != 0);
+	/* the RTS and HTS modes overlay the tail of the default one */
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring, prod.tail) !=
+			 offsetof(struct rte_ring, prod.rts_tail.val.pos));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring, prod.tail) !=
+			 offsetof(struct rte_ring, prod.hts.pos.tail));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring, cons.tail) !=
+			 offsetof(struct rte_ring, cons.rts_tail.val.pos));
+	RTE_BUILD_BUG_ON(offsetof(struct rte_ring, cons.tail) !=
+			 offsetof(struct rte_ring, cons.hts.pos.tail));
 #ifdef RTE_LIBRTE_RING_DEBUG
 	RTE_BUILD_BUG_ON((sizeof(struct rte_ring_debug_stats) &
 			  RTE_CACHE_LINE_MASK) != 0);
@@ -138,10 +210,21 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 			  RTE_CACHE_LINE_MASK) != 0);
 #endif
 
+	if (get_sync_types(flags, &prod_st, &cons_st) != 0) {
+		RTE_LOG(ERR, RING, "Conflicting synchronization flags\n");
+		return -EINVAL;
+	}
+
+	if (esize == 0 || (esize & 0x3) != 0) {
+		RTE_LOG(ERR, RING, "Invalid object size %u\n", esize);
+		return -EINVAL;
+	}
+
 	/* init the ring structure */
 	memset(r, 0, sizeof(*r));
 	snprintf(r->name, sizeof(r->name), "%s", name);
 	r->flags = flags;
+	r->esize = esize;
 	r->prod.watermark = count;
 	r->prod.sp_enqueue = !!(flags & RING_F_SP_ENQ);
 	r->cons.sc_dequeue = !!(flags & RING_F_SC_DEQ);
@@ -149,14 +232,25 @@ rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 	r->prod.mask = r->cons.mask = count-1;
 	r->prod.head = r->cons.head = 0;
 	r->prod.tail = r->cons.tail = 0;
+	r->prod.sync_type = prod_st;
+	r->cons.sync_type = cons_st;
+	r->prod.htd_max = r->cons.htd_max = RTS_DEF_HTD_MAX(count);
+	r->prod.rts_head.raw = r->cons.rts_head.raw = 0;
 
 	return 0;
 }
 
+int
+rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
+	unsigned flags)
+{
+	return rte_ring_init_elem(r, name, sizeof(void *), count, flags);
+}
+
 /* create the ring */
 struct rte_ring *
-rte_ring_create(const char *name, unsigned count, int socket_id,
-		unsigned flags)
+rte_ring_create_elem(const char *name, unsigned esize, unsigned count,
+		int socket_id, unsigned flags)
 {
 	char mz_name[RTE_MEMZONE_NAMESIZE];
 	struct rte_ring *r;
@@ -165,10 +259,17 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 	ssize_t ring_size;
 	int mz_flags = 0;
 	struct rte_ring_list* ring_list = NULL;
+	enum rte_ring_sync_type prod_st, cons_st;
 
 	ring_list = RTE_TAILQ_CAST(rte_ring_tailq.head, rte_ring_list);
 
-	ring_size = rte_ring_get_memsize(count);
+	if (get_sync_types(flags, &prod_st, &cons_st) != 0) {
+		RTE_LOG(ERR, RING, "Conflicting synchronization flags\n");
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	ring_size = rte_ring_get_memsize_elem(esize, count);
 	if (ring_size < 0) {
 		rte_errno = ring_size;
 		return NULL;
@@ -193,7 +294,7 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 		r = mz->addr;
 		/* no need to check return value here, we already checked the
 		 * arguments above */
-		rte_ring_init(r, name, count, flags);
+		rte_ring_init_elem(r, name, esize, count, flags);
 
 		te->data = (void *) r;
 
@@ -208,6 +309,14 @@ rte_ring_create(const char *name, unsigned count, int socket_id,
 	return r;
 }
 
+struct rte_ring *
+rte_ring_create(const char *name, unsigned count, int socket_id,
+		unsigned flags)
+{
+	return rte_ring_create_elem(name, sizeof(void *), count, socket_id,
+				    flags);
+}
+
 /*
  * change the high water mark. If *count* is 0, water marking is
  * disabled
@@ -226,6 +335,49 @@ rte_ring_set_water_mark(struct rte_ring *r, unsigned count)
 	return 0;
 }
 
+/* change the max distance between head and tail of the RTS producers */
+int
+rte_ring_set_prod_htd_max(struct rte_ring *r, uint32_t v)
+{
+	if (r->prod.sync_type != RTE_RING_SYNC_MT_RTS)
+		return -ENOTSUP;
+
+	if (v == 0 || v > r->prod.mask)
+		return -EINVAL;
+
+	r->prod.htd_max = v;
+	return 0;
+}
+
+/* change the max distance between head and tail of the RTS consumers */
+int
+rte_ring_set_cons_htd_max(struct rte_ring *r, uint32_t v)
+{
+	if (r->cons.sync_type != RTE_RING_SYNC_MT_RTS)
+		return -ENOTSUP;
+
+	if (v == 0 || v > r->cons.mask)
+		return -EINVAL;
+
+	r->cons.htd_max = v;
+	return 0;
+}
+
+static const char *
+sync_type_name(enum rte_ring_sync_type st)
+{
+	switch (st) {
+	case RTE_RING_SYNC_ST:
+		return "single";
+	case RTE_RING_SYNC_MT_RTS:
+		return "multi RTS";
+	case RTE_RING_SYNC_MT_HTS:
+		return "multi HTS";
+	default:
+		return "multi";
+	}
+}
+
 /* dump the status of the ring on the console */
 void
 rte_ring_dump(FILE *f, const struct rte_ring *r)
@@ -238,10 +390,17 @@ rte_ring_dump(FILE *f, const struct rte_ring *r)
 	fprintf(f, "ring <%s>@%p\n", r->name, r);
 	fprintf(f, "  flags=%x\n", r->flags);
 	fprintf(f, "  size=%"PRIu32"\n", r->prod.size);
+	fprintf(f, "  esize=%"PRIu32"\n", r->esize);
+	fprintf(f, "  prod=%s\n", sync_type_name(r->prod.sync_type));
+	fprintf(f, "  cons=%s\n", sync_type_name(r->cons.sync_type));
 	fprintf(f, "  ct=%"PRIu32"\n", r->cons.tail);
-	fprintf(f, "  ch=%"PRIu32"\n", r->cons.head);
+	fprintf(f, "  ch=%"PRIu32"\n",
+		r->cons.sync_type == RTE_RING_SYNC_MT_RTS ?
+		r->cons.rts_head.val.pos : r->cons.head);
 	fprintf(f, "  pt=%"PRIu32"\n", r->prod.tail);
-	fprintf(f, "  ph=%"PRIu32"\n", r->prod.head);
+	fprintf(f, "  ph=%"PRIu32"\n",
+		r->prod.sync_type == RTE_RING_SYNC_MT_RTS ?
+		r->prod.rts_head.val.pos : r->prod.head);
 	fprintf(f, "  used=%u\n", rte_ring_count(r));
 	fprintf(f, "  avail=%u\n", rte_ring_free_count(r));
 	if (r->prod.watermark == r->prod.size)
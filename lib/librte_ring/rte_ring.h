@@ -81,9 +81,13 @@
  * - Multi- or single-producer enqueue.
  * - Bulk dequeue.
  * - Bulk enqueue.
+ * - Selectable synchronization mode of the producers and of the consumers.
+ * - Zero-copy enqueue/dequeue in the ring slots (single or HTS modes).
  *
- * Note: the ring implementation is not preemptable. A lcore must not
- * be interrupted by another task that uses the same ring.
+ * Note: the default multi-producer/consumer implementation is not
+ * preemptable. A lcore must not be interrupted by another task that uses
+ * the same ring. When there are more threads than cores, use the RTS or
+ * HTS modes described in ``enum rte_ring_sync_type``.
  *
  */
 
@@ -93,6 +97,7 @@ extern "C" {
 
 #include <stdio.h>
 #include <stdint.h>
+#include <string.h>
 #include <sys/queue.h>
 #include <errno.h>
 #include <rte_common.h>
@@ -126,6 +131,59 @@ struct rte_ring_debug_stats {
 } __rte_cache_aligned;
 #endif
 
+/**
+ * Synchronization mode of the producers or of the consumers of a ring.
+ */
+enum rte_ring_sync_type {
+	/**
+	 * Multi-thread safe (default). A thread moves the head with a
+	 * compare and set, then waits for the threads which moved it before
+	 * to update the tail: if one of them is preempted, all the others
+	 * spin until it is scheduled again.
+	 */
+	RTE_RING_SYNC_MT = 0,
+	/** Single thread only. */
+	RTE_RING_SYNC_ST,
+	/**
+	 * Multi-thread safe, relaxed tail sync (RTS). The head and the tail
+	 * carry a counter of started and completed updates: the last thread
+	 * to complete moves the tail up to the head, so that no thread waits
+	 * for a given other one. The head can only get htd_max objects ahead
+	 * of the tail.
+	 */
+	RTE_RING_SYNC_MT_RTS,
+	/**
+	 * Multi-thread safe, head/tail sync (HTS). The head and the tail are
+	 * updated together: only one enqueue (or dequeue) is in progress at
+	 * a time, the others wait for it to complete before moving the head.
+	 */
+	RTE_RING_SYNC_MT_HTS,
+};
+
+/**
+ * @internal Head and tail of the HTS mode, updated with one atomic
+ * operation.
+ */
+union rte_ring_hts_pos {
+	uint64_t raw;
+	struct {
+		uint32_t head; /**< Head index. */
+		uint32_t tail; /**< Tail index. */
+	} pos;
+};
+
+/**
+ * @internal Index and update counter of the RTS mode, updated with one
+ * atomic operation.
+ */
+union rte_ring_rts_poscnt {
+	uint64_t raw;
+	struct {
+		uint32_t cnt; /**< Number of updates. */
+		uint32_t pos; /**< Index. */
+	} val;
+};
+
 #define RTE_RING_NAMESIZE 32 /**< The maximum length of a ring name. */
 #define RTE_RING_MZ_PREFIX "RG_"
 
@@ -143,10 +201,17 @@ struct rte_ring_debug_stats {
  * field. Thanks to this assumption, we can do subtractions between 2 index
  * values in a modulo-32bit base: that's why the overflow of the indexes is not
  * a problem.
+ *
+ * In the HTS mode, the head and the tail are modified together as
+ * the *hts* field. In the RTS mode, the tail and its update counter are
+ * the *rts_tail* field (which means *head* holds the counter, not the head)
+ * and the head is in *rts_head*. In all modes, *tail* is the index up to
+ * which the other side of the ring can go.
  */
 struct rte_ring {
 	char name[RTE_RING_NAMESIZE];    /**< Name of the ring. */
 	int flags;                       /**< Flags supplied at creation. */
+	uint32_t esize;                  /**< Size of the objects, in bytes. */
 
 	/** Ring producer status. */
 	struct prod {
@@ -154,8 +219,20 @@ struct rte_ring {
 		uint32_t sp_enqueue;     /**< True, if single producer. */
 		uint32_t size;           /**< Size of ring. */
 		uint32_t mask;           /**< Mask (size-1) of ring. */
-		volatile uint32_t head;  /**< Producer head. */
-		volatile uint32_t tail;  /**< Producer tail. */
+		union {
+			struct {
+				volatile uint32_t head; /**< Producer head. */
+				volatile uint32_t tail; /**< Producer tail. */
+			};
+			/** HTS mode: producer head and tail. */
+			volatile union rte_ring_hts_pos hts;
+			/** RTS mode: producer tail and update counter. */
+			volatile union rte_ring_rts_poscnt rts_tail;
+		};
+		enum rte_ring_sync_type sync_type; /**< Producers sync mode. */
+		uint32_t htd_max;        /**< RTS mode: max head-tail distance. */
+		/** RTS mode: producer head and update counter. */
+		volatile union rte_ring_rts_poscnt rts_head;
 	} prod __rte_cache_aligned;
 
 	/** Ring consumer status. */
@@ -163,8 +240,20 @@ struct rte_ring {
 		uint32_t sc_dequeue;     /**< True, if single consumer. */
 		uint32_t size;           /**< Size of the ring. */
 		uint32_t mask;           /**< Mask (size-1) of ring. */
-		volatile uint32_t head;  /**< Consumer head. */
-		volatile uint32_t tail;  /**< Consumer tail. */
+		enum rte_ring_sync_type sync_type; /**< Consumers sync mode. */
+		union {
+			struct {
+				volatile uint32_t head; /**< Consumer head. */
+				volatile uint32_t tail; /**< Consumer tail. */
+			};
+			/** HTS mode: consumer head and tail. */
+			volatile union rte_ring_hts_pos hts;
+			/** RTS mode: consumer tail and update counter. */
+			volatile union rte_ring_rts_poscnt rts_tail;
+		};
+		uint32_t htd_max;        /**< RTS mode: max head-tail distance. */
+		/** RTS mode: consumer head and update counter. */
+		volatile union rte_ring_rts_poscnt rts_head;
 #ifdef RTE_RING_SPLIT_PROD_CONS
 	} cons __rte_cache_aligned;
 #else
@@ -177,11 +266,17 @@ struct rte_ring {
 
 	void * ring[0] __rte_cache_aligned; /**< Memory space of ring starts here.
 	                                     * not volatile so need to be careful
-	                                     * about compiler re-ordering */
+	                                     * about compiler re-ordering.
+	                                     * Holds *size* objects of *esize*
+	                                     * bytes each. */
 };
 
 #define RING_F_SP_ENQ 0x0001 /**< The default enqueue is "single-producer". */
 #define RING_F_SC_DEQ 0x0002 /**< The default dequeue is "single-consumer". */
+#define RING_F_MP_RTS_ENQ 0x0008 /**< The default enqueue is "MP RTS". */
+#define RING_F_MC_RTS_DEQ 0x0010 /**< The default dequeue is "MC RTS". */
+#define RING_F_MP_HTS_ENQ 0x0020 /**< The default enqueue is "MP HTS". */
+#define RING_F_MC_HTS_DEQ 0x0040 /**< The default dequeue is "MC HTS". */
 #define RTE_RING_QUOT_EXCEED (1 << 31)  /**< Quota exceed for burst ops */
 #define RTE_RING_SZ_MASK  (unsigned)(0x0fffffff) /**< Ring size mask */
 
@@ -222,6 +317,22 @@ struct rte_ring {
  */
 ssize_t rte_ring_get_memsize(unsigned count);
 
+/**
+ * Calculate the memory size needed for a ring of objects of a given size
+ *
+ * Same as rte_ring_get_memsize(), for a ring created with
+ * rte_ring_create_elem() or initialized with rte_ring_init_elem().
+ *
+ * @param esize
+ *   The size of the objects in bytes (must be a multiple of 4).
+ * @param count
+ *   The number of elements in the ring (must be a power of 2).
+ * @return
+ *   - The memory size needed for the ring on success.
+ *   - -EINVAL if count is not a power of 2 or esize is not a multiple of 4.
+ */
+ssize_t rte_ring_get_memsize_elem(unsigned esize, unsigned count);
+
 /**
  * Initialize a ring structure.
  *
@@ -253,12 +364,43 @@ ssize_t rte_ring_get_memsize(unsigned count);
  *    - RING_F_SC_DEQ: If this flag is set, the default behavior when
  *      using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
  *      is "single-consumer". Otherwise, it is "multi-consumers".
+ *    - RING_F_MP_RTS_ENQ, RING_F_MP_HTS_ENQ: If one of these flags is set,
+ *      the default enqueue is "multi-producers" with the RTS or HTS
+ *      synchronization mode (see ``enum rte_ring_sync_type``).
+ *    - RING_F_MC_RTS_DEQ, RING_F_MC_HTS_DEQ: If one of these flags is set,
+ *      the default dequeue is "multi-consumers" with the RTS or HTS
+ *      synchronization mode.
+ *    At most one flag of each side can be set.
  * @return
  *   0 on success, or a negative value on error.
  */
 int rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 	unsigned flags);
 
+/**
+ * Initialize a ring structure holding objects of a given size.
+ *
+ * Same as rte_ring_init(), except that the ring stores objects of *esize*
+ * bytes instead of pointers. Such a ring is used with the ``*_elem()``
+ * enqueue and dequeue functions. The size of the memory area should be
+ * given by rte_ring_get_memsize_elem().
+ *
+ * @param r
+ *   The pointer to the ring structure followed by the objects table.
+ * @param name
+ *   The name of the ring.
+ * @param esize
+ *   The size of the objects in bytes (must be a multiple of 4).
+ * @param count
+ *   The number of elements in the ring (must be a power of 2).
+ * @param flags
+ *   Same as for rte_ring_init().
+ * @return
+ *   0 on success, or a negative value on error.
+ */
+int rte_ring_init_elem(struct rte_ring *r, const char *name, unsigned esize,
+	unsigned count, unsigned flags);
+
 /**
  * Create a new ring named *name* in memory.
  *
@@ -288,12 +430,19 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
  *    - RING_F_SC_DEQ: If this flag is set, the default behavior when
  *      using ``rte_ring_dequeue()`` or ``rte_ring_dequeue_bulk()``
  *      is "single-consumer". Otherwise, it is "multi-consumers".
+ *    - RING_F_MP_RTS_ENQ, RING_F_MP_HTS_ENQ: If one of these flags is set,
+ *      the default enqueue is "multi-producers" with the RTS or HTS
+ *      synchronization mode (see ``enum rte_ring_sync_type``).
+ *    - RING_F_MC_RTS_DEQ, RING_F_MC_HTS_DEQ: If one of these flags is set,
+ *      the default dequeue is "multi-consumers" with the RTS or HTS
+ *      synchronization mode.
+ *    At most one flag of each side can be set.
  * @return
  *   On success, the pointer to the new allocated ring. NULL on error with
  *    rte_errno set appropriately. Possible errno values include:
  *    - E_RTE_NO_CONFIG - function could not get pointer to rte_config structure
  *    - E_RTE_SECONDARY - function was called from a secondary process instance
- *    - EINVAL - count provided is not a power of 2
+ *    - EINVAL - count provided is not a power of 2, or flags conflict
  *    - ENOSPC - the maximum number of memzones has already been allocated
  *    - EEXIST - a memzone with the same name already exists
  *    - ENOMEM - no appropriate memory area found in which to create memzone
@@ -301,6 +450,37 @@ int rte_ring_init(struct rte_ring *r, const char *name, unsigned count,
 struct rte_ring *rte_ring_create(const char *name, unsigned count,
 				 int socket_id, unsigned flags);
 
+/**
+ * Create a new ring of objects of a given size named *name* in memory.
+ *
+ * Same as rte_ring_create(), except that the ring stores objects of
+ * *esize* bytes (for instance small structures) instead of pointers.
+ * The objects are copied in and out of the ring by the ``*_elem()``
+ * enqueue and dequeue functions, which must be given the same *esize*.
+ * The pointer functions must not be used on such a ring, unless *esize*
+ * is sizeof(void *).
+ *
+ * @param name
+ *   The name of the ring.
+ * @param esize
+ *   The size of the objects in bytes (must be a multiple of 4).
+ * @param count
+ *   The size of the ring (must be a power of 2).
+ * @param socket_id
+ *   The *socket_id* argument is the socket identifier in case of
+ *   NUMA. The value can be *SOCKET_ID_ANY* if there is no NUMA
+ *   constraint for the reserved zone.
+ * @param flags
+ *   Same as for rte_ring_create().
+ * @return
+ *   On success, the pointer to the new allocated ring. NULL on error with
+ *    rte_errno set appropriately, see rte_ring_create(). EINVAL is also
+ *    returned if esize is not a multiple of 4.
+ */
+struct rte_ring *rte_ring_create_elem(const char *name, unsigned esize,
+				      unsigned count, int socket_id,
+				      unsigned flags);
+
 /**
  * Change the high water mark.
  *
@@ -321,6 +501,45 @@ struct rte_ring *rte_ring_create(const char *name, unsigned count,
  */
 int rte_ring_set_water_mark(struct rte_ring *r, unsigned count);
 
+/**
+ * Change the maximum distance between the head and the tail of the
+ * producers of a ring in RTS mode.
+ *
+ * A producer moving the head further waits for the tail to catch up. A
+ * small value bounds the time the consumers wait for the objects of a
+ * preempted producer, a large one reduces the contention between the
+ * producers. The default is a eighth of the ring size.
+ *
+ * This function must not be called while the ring is in use.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param v
+ *   The new maximum distance, between 1 and the ring size minus 1.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid value.
+ *   - -ENOTSUP: The producers are not in RTS mode.
+ */
+int rte_ring_set_prod_htd_max(struct rte_ring *r, uint32_t v);
+
+/**
+ * Change the maximum distance between the head and the tail of the
+ * consumers of a ring in RTS mode.
+ *
+ * See rte_ring_set_prod_htd_max().
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param v
+ *   The new maximum distance, between 1 and the ring size minus 1.
+ * @return
+ *   - 0: Success.
+ *   - -EINVAL: Invalid value.
+ *   - -ENOTSUP: The consumers are not in RTS mode.
+ */
+int rte_ring_set_cons_htd_max(struct rte_ring *r, uint32_t v);
+
 /**
  * Dump the status of the ring to the console.
  *
@@ -331,57 +550,94 @@ int rte_ring_set_water_mark(struct rte_ring *r, unsigned count);
  */
 void rte_ring_dump(FILE *f, const struct rte_ring *r);
 
-/* the actual enqueue of pointers on the ring.
- * Placed here since identical code needed in both
- * single and multi producer enqueue functions */
-#define ENQUEUE_PTRS() do { \
-	const uint32_t size = r->prod.size; \
-	uint32_t idx = prod_head & mask; \
-	if (likely(idx + n < size)) { \
-		for (i = 0; i < (n & ((~(unsigned)0x3))); i+=4, idx+=4) { \
-			r->ring[idx] = obj_table[i]; \
-			r->ring[idx+1] = obj_table[i+1]; \
-			r->ring[idx+2] = obj_table[i+2]; \
-			r->ring[idx+3] = obj_table[i+3]; \
-		} \
-		switch (n & 0x3) { \
-			case 3: r->ring[idx++] = obj_table[i++]; \
-			case 2: r->ring[idx++] = obj_table[i++]; \
-			case 1: r->ring[idx++] = obj_table[i++]; \
-		} \
-	} else { \
-		for (i = 0; idx < size; i++, idx++)\
-			r->ring[idx] = obj_table[i]; \
-		for (idx = 0; i < n; i++, idx++) \
-			r->ring[idx] = obj_table[i]; \
-	} \
-} while(0)
-
-/* the actual copy of pointers on the ring to obj_table.
- * Placed here since identical code needed in both
- * single and multi consumer dequeue functions */
-#define DEQUEUE_PTRS() do { \
-	uint32_t idx = cons_head & mask; \
-	const uint32_t size = r->cons.size; \
-	if (likely(idx + n < size)) { \
-		for (i = 0; i < (n & (~(unsigned)0x3)); i+=4, idx+=4) {\
-			obj_table[i] = r->ring[idx]; \
-			obj_table[i+1] = r->ring[idx+1]; \
-			obj_table[i+2] = r->ring[idx+2]; \
-			obj_table[i+3] = r->ring[idx+3]; \
-		} \
-		switch (n & 0x3) { \
-			case 3: obj_table[i++] = r->ring[idx++]; \
-			case 2: obj_table[i++] = r->ring[idx++]; \
-			case 1: obj_table[i++] = r->ring[idx++]; \
-		} \
-	} else { \
-		for (i = 0; idx < size; i++, idx++) \
-			obj_table[i] = r->ring[idx]; \
-		for (idx = 0; i < n; i++, idx++) \
-			obj_table[i] = r->ring[idx]; \
-	} \
-} while (0)
+/**
+ * @internal Copy objects between a table and the ring storage.
+ *
+ * The size of the objects is a constant in the callers, so that the copy
+ * loops of the 4, 8 and 16 bytes objects (pointers included) are
+ * specialized.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_copy_elems(void *dst, const void *src, unsigned esize, unsigned n)
+{
+	char *d = dst;
+	const char *s = src;
+	unsigned i;
+
+	switch (esize) {
+	case 4:
+	case 8:
+		for (i = 0; i < (n & (~(unsigned)0x3)); i += 4) {
+			memcpy(d + i * esize, s + i * esize, esize);
+			memcpy(d + (i + 1) * esize, s + (i + 1) * esize, esize);
+			memcpy(d + (i + 2) * esize, s + (i + 2) * esize, esize);
+			memcpy(d + (i + 3) * esize, s + (i + 3) * esize, esize);
+		}
+		for (; i < n; i++)
+			memcpy(d + i * esize, s + i * esize, esize);
+		break;
+	case 16:
+		for (i = 0; i < (n & (~(unsigned)0x1)); i += 2) {
+			memcpy(d + i * 16, s + i * 16, 16);
+			memcpy(d + (i + 1) * 16, s + (i + 1) * 16, 16);
+		}
+		if (n & 0x1)
+			memcpy(d + i * 16, s + i * 16, 16);
+		break;
+	default:
+		memcpy(d, s, (size_t)n * esize);
+		break;
+	}
+}
+
+/* the actual enqueue of objects on the ring.
+ * Placed here since identical code needed in all
+ * producer enqueue functions */
+static inline void __attribute__((always_inline))
+__rte_ring_enqueue_elems(struct rte_ring *r, uint32_t prod_head,
+			 const void *obj_table, unsigned esize, unsigned n)
+{
+	const uint32_t size = r->prod.size;
+	uint32_t idx = prod_head & r->prod.mask;
+	char *ring = (char *)r->ring;
+	unsigned first;
+
+	if (likely(idx + n <= size)) {
+		__rte_ring_copy_elems(ring + (size_t)idx * esize, obj_table,
+				      esize, n);
+	} else {
+		first = size - idx;
+		__rte_ring_copy_elems(ring + (size_t)idx * esize, obj_table,
+				      esize, first);
+		__rte_ring_copy_elems(ring,
+				      (const char *)obj_table + first * esize,
+				      esize, n - first);
+	}
+}
+
+/* the actual copy of objects on the ring to obj_table.
+ * Placed here since identical code needed in all
+ * consumer dequeue functions */
+static inline void __attribute__((always_inline))
+__rte_ring_dequeue_elems(struct rte_ring *r, uint32_t cons_head,
+			 void *obj_table, unsigned esize, unsigned n)
+{
+	const uint32_t size = r->cons.size;
+	uint32_t idx = cons_head & r->cons.mask;
+	const char *ring = (const char *)r->ring;
+	unsigned first;
+
+	if (likely(idx + n <= size)) {
+		__rte_ring_copy_elems(obj_table, ring + (size_t)idx * esize,
+				      esize, n);
+	} else {
+		first = size - idx;
+		__rte_ring_copy_elems(obj_table, ring + (size_t)idx * esize,
+				      esize, first);
+		__rte_ring_copy_elems((char *)obj_table + first * esize, ring,
+				      esize, n - first);
+	}
+}
 
 /**
  * @internal Enqueue several objects on the ring (multi-producers safe).
@@ -392,7 +648,9 @@ void rte_ring_dump(FILE *f, const struct rte_ring *r);
  * @param r
  *   A pointer to the ring structure.
  * @param obj_table
- *   A pointer to a table of void * pointers (objects).
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, in bytes.
  * @param n
  *   The number of objects to add in the ring from the obj_table.
  * @param behavior
@@ -409,14 +667,15 @@ void rte_ring_dump(FILE *f, const struct rte_ring *r);
  *   - n: Actual number of objects enqueued.
  */
 static inline int __attribute__((always_inline))
-__rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
-			 unsigned n, enum rte_ring_queue_behavior behavior)
+__rte_ring_mp_do_enqueue(struct rte_ring *r, const void *obj_table,
+		unsigned esize, unsigned n,
+		enum rte_ring_queue_behavior behavior)
 {
 	uint32_t prod_head, prod_next;
 	uint32_t cons_tail, free_entries;
 	const unsigned max = n;
 	int success;
-	unsigned i, rep = 0;
+	unsigned rep = 0;
 	uint32_t mask = r->prod.mask;
 	int ret;
 
@@ -456,7 +715,7 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 	} while (unlikely(success == 0));
 
 	/* write entries in ring */
-	ENQUEUE_PTRS();
+	__rte_ring_enqueue_elems(r, prod_head, obj_table, esize, n);
 	rte_compiler_barrier();
 
 	/* if we exceed the watermark */
@@ -496,7 +755,9 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  * @param r
  *   A pointer to the ring structure.
  * @param obj_table
- *   A pointer to a table of void * pointers (objects).
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, in bytes.
  * @param n
  *   The number of objects to add in the ring from the obj_table.
  * @param behavior
@@ -513,12 +774,12 @@ __rte_ring_mp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  *   - n: Actual number of objects enqueued.
  */
 static inline int __attribute__((always_inline))
-__rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
-			 unsigned n, enum rte_ring_queue_behavior behavior)
+__rte_ring_sp_do_enqueue(struct rte_ring *r, const void *obj_table,
+		unsigned esize, unsigned n,
+		enum rte_ring_queue_behavior behavior)
 {
 	uint32_t prod_head, cons_tail;
 	uint32_t prod_next, free_entries;
-	unsigned i;
 	uint32_t mask = r->prod.mask;
 	int ret;
 
@@ -551,7 +812,7 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
 	r->prod.head = prod_next;
 
 	/* write entries in ring */
-	ENQUEUE_PTRS();
+	__rte_ring_enqueue_elems(r, prod_head, obj_table, esize, n);
 	rte_compiler_barrier();
 
 	/* if we exceed the watermark */
@@ -580,7 +841,9 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  * @param r
  *   A pointer to the ring structure.
  * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, in bytes.
  * @param n
  *   The number of objects to dequeue from the ring to the obj_table.
  * @param behavior
@@ -597,15 +860,15 @@ __rte_ring_sp_do_enqueue(struct rte_ring *r, void * const *obj_table,
  */
 
 static inline int __attribute__((always_inline))
-__rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
-		 unsigned n, enum rte_ring_queue_behavior behavior)
+__rte_ring_mc_do_dequeue(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n,
+		enum rte_ring_queue_behavior behavior)
 {
 	uint32_t cons_head, prod_tail;
 	uint32_t cons_next, entries;
 	const unsigned max = n;
 	int success;
-	unsigned i, rep = 0;
-	uint32_t mask = r->prod.mask;
+	unsigned rep = 0;
 
 	/* move cons.head atomically */
 	do {
@@ -642,7 +905,7 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
 	} while (unlikely(success == 0));
 
 	/* copy in table */
-	DEQUEUE_PTRS();
+	__rte_ring_dequeue_elems(r, cons_head, obj_table, esize, n);
 	rte_compiler_barrier();
 
 	/*
@@ -675,7 +938,9 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
  * @param r
  *   A pointer to the ring structure.
  * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, in bytes.
  * @param n
  *   The number of objects to dequeue from the ring to the obj_table.
  * @param behavior
@@ -691,13 +956,12 @@ __rte_ring_mc_do_dequeue(struct rte_ring *r, void **obj_table,
  *   - n: Actual number of objects dequeued.
  */
 static inline int __attribute__((always_inline))
-__rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
-		 unsigned n, enum rte_ring_queue_behavior behavior)
+__rte_ring_sc_do_dequeue(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n,
+		enum rte_ring_queue_behavior behavior)
 {
 	uint32_t cons_head, prod_tail;
 	uint32_t cons_next, entries;
-	unsigned i;
-	uint32_t mask = r->prod.mask;
 
 	cons_head = r->cons.head;
 	prod_tail = r->prod.tail;
@@ -726,7 +990,7 @@ __rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
 	r->cons.head = cons_next;
 
 	/* copy in table */
-	DEQUEUE_PTRS();
+	__rte_ring_dequeue_elems(r, cons_head, obj_table, esize, n);
 	rte_compiler_barrier();
 
 	__RING_STAT_ADD(r, deq_success, n);
@@ -735,133 +999,1282 @@ __rte_ring_sc_do_dequeue(struct rte_ring *r, void **obj_table,
 }
 
 /**
- * Enqueue several objects on the ring (multi-producers safe).
+ * @internal Wait for the head of the HTS mode to be equal to the tail,
+ * that is for the enqueue or dequeue in progress to complete.
  *
- * This function uses a "compare and set" instruction to move the
- * producer index atomically.
+ * The 64 bits reads may be split on 32 bits architectures, the compare
+ * and set done with the value read validates it.
  *
- * @param r
- *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
- * @param n
- *   The number of objects to add in the ring from the obj_table.
- * @return
- *   - 0: Success; objects enqueue.
- *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
- *     high water mark is exceeded.
- *   - -ENOBUFS: Not enough room in the ring to enqueue, no object is enqueued.
+ * @param ht
+ *   A pointer to the head and tail of the producers or of the consumers.
+ * @param p
+ *   The head and tail last read, updated with the ones read when done.
  */
-static inline int __attribute__((always_inline))
-rte_ring_mp_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
-			 unsigned n)
+static inline void __attribute__((always_inline))
+__rte_ring_hts_head_wait(const volatile union rte_ring_hts_pos *ht,
+			 union rte_ring_hts_pos *p)
 {
-	return __rte_ring_mp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+	unsigned rep = 0;
+
+	while (unlikely(p->pos.head != p->pos.tail)) {
+		rte_pause();
+
+		/* Set RTE_RING_PAUSE_REP_COUNT to avoid spin too long waiting
+		 * for other thread finish. It gives pre-empted thread a chance
+		 * to proceed and finish with ring operation. */
+		if (RTE_RING_PAUSE_REP_COUNT &&
+		    ++rep == RTE_RING_PAUSE_REP_COUNT) {
+			rep = 0;
+			sched_yield();
+		}
+		p->raw = ht->raw;
+	}
 }
 
 /**
- * Enqueue several objects on a ring (NOT multi-producers safe).
- *
- * @param r
- *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
- * @param n
- *   The number of objects to add in the ring from the obj_table.
- * @return
- *   - 0: Success; objects enqueued.
- *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
- *     high water mark is exceeded.
- *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ * @internal Wait for the head of the RTS mode to be close enough to the
+ * tail to be moved.
+ *
+ * @param tail
+ *   A pointer to the tail of the producers or of the consumers.
+ * @param head
+ *   A pointer to the head of the producers or of the consumers.
+ * @param htd_max
+ *   The maximum distance between the head and the tail.
+ * @param h
+ *   The head last read, updated with the one read when done.
  */
-static inline int __attribute__((always_inline))
-rte_ring_sp_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
-			 unsigned n)
+static inline void __attribute__((always_inline))
+__rte_ring_rts_head_wait(const volatile union rte_ring_rts_poscnt *tail,
+			 const volatile union rte_ring_rts_poscnt *head,
+			 uint32_t htd_max, union rte_ring_rts_poscnt *h)
 {
-	return __rte_ring_sp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+	while (unlikely(h->val.pos - tail->val.pos > htd_max)) {
+		rte_pause();
+		h->raw = head->raw;
+	}
 }
 
 /**
- * Enqueue several objects on a ring.
- *
- * This function calls the multi-producer or the single-producer
- * version depending on the default behavior that was specified at
- * ring creation time (see flags).
- *
- * @param r
- *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
- * @param n
- *   The number of objects to add in the ring from the obj_table.
- * @return
- *   - 0: Success; objects enqueued.
- *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
- *     high water mark is exceeded.
- *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ * @internal Complete an update of the RTS mode: increment the counter of
+ * completed updates and, if no other update is in progress, move the tail
+ * up to the head.
+ *
+ * @param tail
+ *   A pointer to the tail of the producers or of the consumers.
+ * @param head
+ *   A pointer to the head of the producers or of the consumers.
  */
-static inline int __attribute__((always_inline))
-rte_ring_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
-		      unsigned n)
+static inline void __attribute__((always_inline))
+__rte_ring_rts_update_tail(volatile union rte_ring_rts_poscnt *tail,
+			   const volatile union rte_ring_rts_poscnt *head)
 {
-	if (r->prod.sp_enqueue)
-		return rte_ring_sp_enqueue_bulk(r, obj_table, n);
-	else
-		return rte_ring_mp_enqueue_bulk(r, obj_table, n);
+	union rte_ring_rts_poscnt h, ot, nt;
+
+	do {
+		ot.raw = tail->raw;
+		h.raw = head->raw;
+
+		nt.raw = ot.raw;
+		if (++nt.val.cnt == h.val.cnt)
+			nt.val.pos = h.val.pos;
+	} while (unlikely(rte_atomic64_cmpset(&tail->raw, ot.raw,
+					      nt.raw) == 0));
 }
 
 /**
- * Enqueue one object on a ring (multi-producers safe).
+ * @internal Enqueue several objects on the ring (multi-producers safe,
+ * RTS mode).
  *
- * This function uses a "compare and set" instruction to move the
- * producer index atomically.
+ * The producers move the head with a "compare and set" of the head and
+ * of the number of enqueues started. The one completing the last enqueue
+ * in progress moves the tail, no producer waits for a given other one.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj
- *   A pointer to the object to be added.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, in bytes.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items a possible from ring
  * @return
- *   - 0: Success; objects enqueued.
+ *   Depend on the behavior value
+ *   if behavior = RTE_RING_QUEUE_FIXED
+ *   - 0: Success; objects enqueue.
  *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
  *     high water mark is exceeded.
- *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no object is enqueued.
+ *   if behavior = RTE_RING_QUEUE_VARIABLE
+ *   - n: Actual number of objects enqueued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_mp_enqueue(struct rte_ring *r, void *obj)
+__rte_ring_mp_rts_do_enqueue(struct rte_ring *r, const void *obj_table,
+		unsigned esize, unsigned n,
+		enum rte_ring_queue_behavior behavior)
 {
-	return rte_ring_mp_enqueue_bulk(r, &obj, 1);
+	union rte_ring_rts_poscnt oh, nh;
+	uint32_t prod_head, free_entries;
+	const unsigned max = n;
+	uint32_t mask = r->prod.mask;
+	int ret;
+
+	/* move prod.rts_head atomically */
+	do {
+		/* Reset n to the initial burst count */
+		n = max;
+
+		oh.raw = r->prod.rts_head.raw;
+		__rte_ring_rts_head_wait(&r->prod.rts_tail, &r->prod.rts_head,
+					 r->prod.htd_max, &oh);
+
+		prod_head = oh.val.pos;
+		free_entries = (mask + r->cons.tail - prod_head);
+
+		/* check that we have enough room in ring */
+		if (unlikely(n > free_entries)) {
+			if (behavior == RTE_RING_QUEUE_FIXED) {
+				__RING_STAT_ADD(r, enq_fail, n);
+				return -ENOBUFS;
+			}
+			else {
+				/* No free entry available */
+				if (unlikely(free_entries == 0)) {
+					__RING_STAT_ADD(r, enq_fail, n);
+					return 0;
+				}
+
+				n = free_entries;
+			}
+		}
+
+		nh.val.pos = prod_head + n;
+		nh.val.cnt = oh.val.cnt + 1;
+	} while (unlikely(rte_atomic64_cmpset(&r->prod.rts_head.raw, oh.raw,
+					      nh.raw) == 0));
+
+	/* write entries in ring */
+	__rte_ring_enqueue_elems(r, prod_head, obj_table, esize, n);
+	rte_compiler_barrier();
+
+	/* if we exceed the watermark */
+	if (unlikely(((mask + 1) - free_entries + n) > r->prod.watermark)) {
+		ret = (behavior == RTE_RING_QUEUE_FIXED) ? -EDQUOT :
+				(int)(n | RTE_RING_QUOT_EXCEED);
+		__RING_STAT_ADD(r, enq_quota, n);
+	}
+	else {
+		ret = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : n;
+		__RING_STAT_ADD(r, enq_success, n);
+	}
+
+	__rte_ring_rts_update_tail(&r->prod.rts_tail, &r->prod.rts_head);
+	return ret;
 }
 
 /**
- * Enqueue one object on a ring (NOT multi-producers safe).
+ * @internal Enqueue several objects on the ring (multi-producers safe,
+ * HTS mode).
+ *
+ * A producer moves the head only when no other enqueue is in progress,
+ * with a "compare and set" of both the head and the tail.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj
- *   A pointer to the object to be added.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, in bytes.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Enqueue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Enqueue as many items a possible from ring
  * @return
- *   - 0: Success; objects enqueued.
+ *   Depend on the behavior value
+ *   if behavior = RTE_RING_QUEUE_FIXED
+ *   - 0: Success; objects enqueue.
  *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
  *     high water mark is exceeded.
- *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no object is enqueued.
+ *   if behavior = RTE_RING_QUEUE_VARIABLE
+ *   - n: Actual number of objects enqueued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_sp_enqueue(struct rte_ring *r, void *obj)
+__rte_ring_mp_hts_do_enqueue(struct rte_ring *r, const void *obj_table,
+		unsigned esize, unsigned n,
+		enum rte_ring_queue_behavior behavior)
 {
-	return rte_ring_sp_enqueue_bulk(r, &obj, 1);
-}
+	union rte_ring_hts_pos op, np;
+	uint32_t prod_head, free_entries;
+	const unsigned max = n;
+	uint32_t mask = r->prod.mask;
+	int ret;
 
-/**
- * Enqueue one object on a ring.
+	/* move prod.hts atomically */
+	do {
+		/* Reset n to the initial burst count */
+		n = max;
+
+		op.raw = r->prod.hts.raw;
+		__rte_ring_hts_head_wait(&r->prod.hts, &op);
+
+		prod_head = op.pos.head;
+		free_entries = (mask + r->cons.tail - prod_head);
+
+		/* check that we have enough room in ring */
+		if (unlikely(n > free_entries)) {
+			if (behavior == RTE_RING_QUEUE_FIXED) {
+				__RING_STAT_ADD(r, enq_fail, n);
+				return -ENOBUFS;
+			}
+			else {
+				/* No free entry available */
+				if (unlikely(free_entries == 0)) {
+					__RING_STAT_ADD(r, enq_fail, n);
+					return 0;
+				}
+
+				n = free_entries;
+			}
+		}
+
+		np.pos.head = prod_head + n;
+		np.pos.tail = op.pos.tail;
+	} while (unlikely(rte_atomic64_cmpset(&r->prod.hts.raw, op.raw,
+					      np.raw) == 0));
+
+	/* write entries in ring */
+	__rte_ring_enqueue_elems(r, prod_head, obj_table, esize, n);
+	rte_compiler_barrier();
+
+	/* if we exceed the watermark */
+	if (unlikely(((mask + 1) - free_entries + n) > r->prod.watermark)) {
+		ret = (behavior == RTE_RING_QUEUE_FIXED) ? -EDQUOT :
+				(int)(n | RTE_RING_QUOT_EXCEED);
+		__RING_STAT_ADD(r, enq_quota, n);
+	}
+	else {
+		ret = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : n;
+		__RING_STAT_ADD(r, enq_success, n);
+	}
+
+	/* no other producer can move the head until then */
+	r->prod.tail = prod_head + n;
+	return ret;
+}
+
+/**
+ * @internal Dequeue several objects from a ring (multi-consumers safe,
+ * RTS mode).
+ *
+ * See __rte_ring_mp_rts_do_enqueue().
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, in bytes.
+ * @param n
+ *   The number of objects to pull from the ring.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Dequeue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Dequeue as many items a possible from ring
+ * @return
+ *   Depend on the behavior value
+ *   if behavior = RTE_RING_QUEUE_FIXED
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *     dequeued.
+ *   if behavior = RTE_RING_QUEUE_VARIABLE
+ *   - n: Actual number of objects dequeued.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_mc_rts_do_dequeue(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n,
+		enum rte_ring_queue_behavior behavior)
+{
+	union rte_ring_rts_poscnt oh, nh;
+	uint32_t cons_head, entries;
+	const unsigned max = n;
+
+	/* move cons.rts_head atomically */
+	do {
+		/* Restore n as it may change every loop */
+		n = max;
+
+		oh.raw = r->cons.rts_head.raw;
+		__rte_ring_rts_head_wait(&r->cons.rts_tail, &r->cons.rts_head,
+					 r->cons.htd_max, &oh);
+
+		cons_head = oh.val.pos;
+		entries = (r->prod.tail - cons_head);
+
+		/* Set the actual entries for dequeue */
+		if (n > entries) {
+			if (behavior == RTE_RING_QUEUE_FIXED) {
+				__RING_STAT_ADD(r, deq_fail, n);
+				return -ENOENT;
+			}
+			else {
+				if (unlikely(entries == 0)){
+					__RING_STAT_ADD(r, deq_fail, n);
+					return 0;
+				}
+
+				n = entries;
+			}
+		}
+
+		nh.val.pos = cons_head + n;
+		nh.val.cnt = oh.val.cnt + 1;
+	} while (unlikely(rte_atomic64_cmpset(&r->cons.rts_head.raw, oh.raw,
+					      nh.raw) == 0));
+
+	/* copy in table */
+	__rte_ring_dequeue_elems(r, cons_head, obj_table, esize, n);
+	rte_compiler_barrier();
+
+	__RING_STAT_ADD(r, deq_success, n);
+	__rte_ring_rts_update_tail(&r->cons.rts_tail, &r->cons.rts_head);
+
+	return behavior == RTE_RING_QUEUE_FIXED ? 0 : n;
+}
+
+/**
+ * @internal Dequeue several objects from a ring (multi-consumers safe,
+ * HTS mode).
+ *
+ * See __rte_ring_mp_hts_do_enqueue().
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, in bytes.
+ * @param n
+ *   The number of objects to pull from the ring.
+ * @param behavior
+ *   RTE_RING_QUEUE_FIXED:    Dequeue a fixed number of items from a ring
+ *   RTE_RING_QUEUE_VARIABLE: Dequeue as many items a possible from ring
+ * @return
+ *   Depend on the behavior value
+ *   if behavior = RTE_RING_QUEUE_FIXED
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *     dequeued.
+ *   if behavior = RTE_RING_QUEUE_VARIABLE
+ *   - n: Actual number of objects dequeued.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_mc_hts_do_dequeue(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n,
+		enum rte_ring_queue_behavior behavior)
+{
+	union rte_ring_hts_pos op, np;
+	uint32_t cons_head, entries;
+	const unsigned max = n;
+
+	/* move cons.hts atomically */
+	do {
+		/* Restore n as it may change every loop */
+		n = max;
+
+		op.raw = r->cons.hts.raw;
+		__rte_ring_hts_head_wait(&r->cons.hts, &op);
+
+		cons_head = op.pos.head;
+		entries = (r->prod.tail - cons_head);
+
+		/* Set the actual entries for dequeue */
+		if (n > entries) {
+			if (behavior == RTE_RING_QUEUE_FIXED) {
+				__RING_STAT_ADD(r, deq_fail, n);
+				return -ENOENT;
+			}
+			else {
+				if (unlikely(entries == 0)){
+					__RING_STAT_ADD(r, deq_fail, n);
+					return 0;
+				}
+
+				n = entries;
+			}
+		}
+
+		np.pos.head = cons_head + n;
+		np.pos.tail = op.pos.tail;
+	} while (unlikely(rte_atomic64_cmpset(&r->cons.hts.raw, op.raw,
+					      np.raw) == 0));
+
+	/* copy in table */
+	__rte_ring_dequeue_elems(r, cons_head, obj_table, esize, n);
+	rte_compiler_barrier();
+
+	__RING_STAT_ADD(r, deq_success, n);
+	/* no other consumer can move the head until then */
+	r->cons.tail = cons_head + n;
+
+	return behavior == RTE_RING_QUEUE_FIXED ? 0 : n;
+}
+
+/**
+ * @internal Enqueue several objects on a ring, with the synchronization
+ * mode of its producers.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_do_enqueue(struct rte_ring *r, const void *obj_table,
+		unsigned esize, unsigned n,
+		enum rte_ring_queue_behavior behavior)
+{
+	switch (r->prod.sync_type) {
+	case RTE_RING_SYNC_ST:
+		return __rte_ring_sp_do_enqueue(r, obj_table, esize, n,
+				behavior);
+	case RTE_RING_SYNC_MT_RTS:
+		return __rte_ring_mp_rts_do_enqueue(r, obj_table, esize, n,
+				behavior);
+	case RTE_RING_SYNC_MT_HTS:
+		return __rte_ring_mp_hts_do_enqueue(r, obj_table, esize, n,
+				behavior);
+	default:
+		return __rte_ring_mp_do_enqueue(r, obj_table, esize, n,
+				behavior);
+	}
+}
+
+/**
+ * @internal Dequeue several objects from a ring, with the synchronization
+ * mode of its consumers.
+ */
+static inline int __attribute__((always_inline))
+__rte_ring_do_dequeue(struct rte_ring *r, void *obj_table,
+		unsigned esize, unsigned n,
+		enum rte_ring_queue_behavior behavior)
+{
+	switch (r->cons.sync_type) {
+	case RTE_RING_SYNC_ST:
+		return __rte_ring_sc_do_dequeue(r, obj_table, esize, n,
+				behavior);
+	case RTE_RING_SYNC_MT_RTS:
+		return __rte_ring_mc_rts_do_dequeue(r, obj_table, esize, n,
+				behavior);
+	case RTE_RING_SYNC_MT_HTS:
+		return __rte_ring_mc_hts_do_dequeue(r, obj_table, esize, n,
+				behavior);
+	default:
+		return __rte_ring_mc_do_dequeue(r, obj_table, esize, n,
+				behavior);
+	}
+}
+
+/**
+ * Enqueue several objects on the ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueue.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+			 unsigned n)
+{
+	return __rte_ring_mp_do_enqueue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue several objects on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sp_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+			 unsigned n)
+{
+	return __rte_ring_sp_do_enqueue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue several objects on a ring.
+ *
+ * This function calls the multi-producer (in the synchronization mode
+ * selected) or the single-producer version depending on the default
+ * behavior that was specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+		      unsigned n)
+{
+	return __rte_ring_do_enqueue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue one object on a ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the object to be added.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_enqueue(struct rte_ring *r, void *obj)
+{
+	return rte_ring_mp_enqueue_bulk(r, &obj, 1);
+}
+
+/**
+ * Enqueue one object on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the object to be added.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sp_enqueue(struct rte_ring *r, void *obj)
+{
+	return rte_ring_sp_enqueue_bulk(r, &obj, 1);
+}
+
+/**
+ * Enqueue one object on a ring.
+ *
+ * This function calls the multi-producer or the single-producer
+ * version, depending on the default behaviour that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the object to be added.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue(struct rte_ring *r, void *obj)
+{
+	return rte_ring_enqueue_bulk(r, &obj, 1);
+}
+
+/**
+ * Dequeue several objects from a ring (multi-consumers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * consumer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_mc_do_dequeue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Dequeue several objects from a ring (NOT multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table,
+ *   must be strictly positive.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_sc_do_dequeue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Dequeue several objects from a ring.
+ *
+ * This function calls the multi-consumers or the single-consumer
+ * version, depending on the default behaviour that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue, no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_do_dequeue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Dequeue one object from a ring (multi-consumers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * consumer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_p
+ *   A pointer to a void * pointer (object) that will be filled.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mc_dequeue(struct rte_ring *r, void **obj_p)
+{
+	return rte_ring_mc_dequeue_bulk(r, obj_p, 1);
+}
+
+/**
+ * Dequeue one object from a ring (NOT multi-consumers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_p
+ *   A pointer to a void * pointer (object) that will be filled.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue, no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sc_dequeue(struct rte_ring *r, void **obj_p)
+{
+	return rte_ring_sc_dequeue_bulk(r, obj_p, 1);
+}
+
+/**
+ * Dequeue one object from a ring.
+ *
+ * This function calls the multi-consumers or the single-consumer
+ * version depending on the default behaviour that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_p
+ *   A pointer to a void * pointer (object) that will be filled.
+ * @return
+ *   - 0: Success, objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue, no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_dequeue(struct rte_ring *r, void **obj_p)
+{
+	return rte_ring_dequeue_bulk(r, obj_p, 1);
+}
+
+/**
+ * Enqueue several objects on the ring (multi-producers safe, RTS mode).
+ *
+ * The ring does not need to be created with RING_F_MP_RTS_ENQ, but all
+ * the producers must use the same synchronization mode.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_rts_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+			     unsigned n)
+{
+	return __rte_ring_mp_rts_do_enqueue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue several objects on the ring (multi-producers safe, HTS mode).
+ *
+ * The ring does not need to be created with RING_F_MP_HTS_ENQ, but all
+ * the producers must use the same synchronization mode.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_hts_enqueue_bulk(struct rte_ring *r, void * const *obj_table,
+			     unsigned n)
+{
+	return __rte_ring_mp_hts_do_enqueue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Dequeue several objects from a ring (multi-consumers safe, RTS mode).
+ *
+ * The ring does not need to be created with RING_F_MC_RTS_DEQ, but all
+ * the consumers must use the same synchronization mode.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mc_rts_dequeue_bulk(struct rte_ring *r, void **obj_table,
+			     unsigned n)
+{
+	return __rte_ring_mc_rts_do_dequeue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Dequeue several objects from a ring (multi-consumers safe, HTS mode).
+ *
+ * The ring does not need to be created with RING_F_MC_HTS_DEQ, but all
+ * the consumers must use the same synchronization mode.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - 0: Success; objects dequeued.
+ *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
+ *     dequeued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mc_hts_dequeue_bulk(struct rte_ring *r, void **obj_table,
+			     unsigned n)
+{
+	return __rte_ring_mc_hts_do_dequeue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Test if a ring is full.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   - 1: The ring is full.
+ *   - 0: The ring is not full.
+ */
+static inline int
+rte_ring_full(const struct rte_ring *r)
+{
+	uint32_t prod_tail = r->prod.tail;
+	uint32_t cons_tail = r->cons.tail;
+	return (((cons_tail - prod_tail - 1) & r->prod.mask) == 0);
+}
+
+/**
+ * Test if a ring is empty.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   - 1: The ring is empty.
+ *   - 0: The ring is not empty.
+ */
+static inline int
+rte_ring_empty(const struct rte_ring *r)
+{
+	uint32_t prod_tail = r->prod.tail;
+	uint32_t cons_tail = r->cons.tail;
+	return !!(cons_tail == prod_tail);
+}
+
+/**
+ * Return the number of entries in a ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   The number of entries in the ring.
+ */
+static inline unsigned
+rte_ring_count(const struct rte_ring *r)
+{
+	uint32_t prod_tail = r->prod.tail;
+	uint32_t cons_tail = r->cons.tail;
+	return ((prod_tail - cons_tail) & r->prod.mask);
+}
+
+/**
+ * Return the number of free entries in a ring.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @return
+ *   The number of free entries in the ring.
+ */
+static inline unsigned
+rte_ring_free_count(const struct rte_ring *r)
+{
+	uint32_t prod_tail = r->prod.tail;
+	uint32_t cons_tail = r->cons.tail;
+	return ((cons_tail - prod_tail - 1) & r->prod.mask);
+}
+
+/**
+ * Dump the status of all rings on the console
+ *
+ * @param f
+ *   A pointer to a file for output
+ */
+void rte_ring_list_dump(FILE *f);
+
+/**
+ * Search a ring from its name
  *
- * This function calls the multi-producer or the single-producer
+ * @param name
+ *   The name of the ring.
+ * @return
+ *   The pointer to the ring matching the name, or NULL if not found,
+ *   with rte_errno set appropriately. Possible rte_errno values include:
+ *    - ENOENT - required entry not available to return.
+ */
+struct rte_ring *rte_ring_lookup(const char *name);
+
+/**
+ * Enqueue several objects on the ring (multi-producers safe).
+ *
+ * This function uses a "compare and set" instruction to move the
+ * producer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mp_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+			 unsigned n)
+{
+	return __rte_ring_mp_do_enqueue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Enqueue several objects on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_sp_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+			 unsigned n)
+{
+	return __rte_ring_sp_do_enqueue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Enqueue several objects on a ring.
+ *
+ * This function calls the multi-producer (in the synchronization mode
+ * selected) or the single-producer version depending on the default
+ * behavior that was specified at ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+		      unsigned n)
+{
+	return __rte_ring_do_enqueue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Dequeue several objects from a ring (multi-consumers safe). When the request
+ * objects are more than the available objects, only dequeue the actual number
+ * of objects
+ *
+ * This function uses a "compare and set" instruction to move the
+ * consumer index atomically.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_mc_do_dequeue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Dequeue several objects from a ring (NOT multi-consumers safe).When the
+ * request objects are more than the available objects, only dequeue the
+ * actual number of objects
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_sc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_sc_do_dequeue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Dequeue multiple objects from a ring up to a maximum number.
+ *
+ * This function calls the multi-consumers or the single-consumer
  * version, depending on the default behaviour that was specified at
  * ring creation time (see flags).
  *
  * @param r
  *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - Number of objects dequeued
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
+{
+	return __rte_ring_do_dequeue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Enqueue several objects on the ring (multi-producers safe, RTS mode).
+ * When there is not enough room, only enqueue the objects that fit.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mp_rts_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+			      unsigned n)
+{
+	return __rte_ring_mp_rts_do_enqueue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Enqueue several objects on the ring (multi-producers safe, HTS mode).
+ * When there is not enough room, only enqueue the objects that fit.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects).
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - n: Actual number of objects enqueued.
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mp_hts_enqueue_burst(struct rte_ring *r, void * const *obj_table,
+			      unsigned n)
+{
+	return __rte_ring_mp_hts_do_enqueue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Dequeue several objects from a ring (multi-consumers safe, RTS mode).
+ * When the request objects are more than the available objects, only
+ * dequeue the actual number of objects.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mc_rts_dequeue_burst(struct rte_ring *r, void **obj_table,
+			      unsigned n)
+{
+	return __rte_ring_mc_rts_do_dequeue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/**
+ * Dequeue several objects from a ring (multi-consumers safe, HTS mode).
+ * When the request objects are more than the available objects, only
+ * dequeue the actual number of objects.
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of void * pointers (objects) that will be filled.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
+ */
+static inline unsigned __attribute__((always_inline))
+rte_ring_mc_hts_dequeue_burst(struct rte_ring *r, void **obj_table,
+			      unsigned n)
+{
+	return __rte_ring_mc_hts_do_dequeue(r, obj_table, sizeof(void *), n,
+			RTE_RING_QUEUE_VARIABLE);
+}
+
+/*
+ * Rings of objects of any size.
+ *
+ * The functions below are the same as the pointer ones, except that the
+ * objects are copied in and out of a ring created by rte_ring_create_elem()
+ * or initialized by rte_ring_init_elem(). *esize* must be the object size
+ * given at creation. It should be a constant so that the copy is inlined
+ * and specialized.
+ */
+
+/**
+ * Enqueue several objects of a given size on the ring (multi-producers
+ * safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+			      unsigned esize, unsigned n)
+{
+	return __rte_ring_mp_do_enqueue(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue several objects of a given size on a ring (NOT multi-producers
+ * safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_sp_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+			      unsigned esize, unsigned n)
+{
+	return __rte_ring_sp_do_enqueue(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue several objects of a given size on a ring.
+ *
+ * This function calls the multi-producer or the single-producer
+ * version depending on the default behavior that was specified at
+ * ring creation time (see flags).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue, no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue_bulk_elem(struct rte_ring *r, const void *obj_table,
+			   unsigned esize, unsigned n)
+{
+	return __rte_ring_do_enqueue(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED);
+}
+
+/**
+ * Enqueue one object of a given size on a ring (multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the object to be added.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_mp_enqueue_elem(struct rte_ring *r, const void *obj, unsigned esize)
+{
+	return rte_ring_mp_enqueue_bulk_elem(r, obj, esize, 1);
+}
+
+/**
+ * Enqueue one object of a given size on a ring (NOT multi-producers safe).
+ *
+ * @param r
+ *   A pointer to the ring structure.
  * @param obj
  *   A pointer to the object to be added.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
  * @return
  *   - 0: Success; objects enqueued.
  *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
@@ -869,24 +2282,43 @@ rte_ring_sp_enqueue(struct rte_ring *r, void *obj)
  *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_enqueue(struct rte_ring *r, void *obj)
+rte_ring_sp_enqueue_elem(struct rte_ring *r, const void *obj, unsigned esize)
 {
-	if (r->prod.sp_enqueue)
-		return rte_ring_sp_enqueue(r, obj);
-	else
-		return rte_ring_mp_enqueue(r, obj);
+	return rte_ring_sp_enqueue_bulk_elem(r, obj, esize, 1);
 }
 
 /**
- * Dequeue several objects from a ring (multi-consumers safe).
+ * Enqueue one object of a given size on a ring, with the default
+ * behavior of the ring.
  *
- * This function uses a "compare and set" instruction to move the
- * consumer index atomically.
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj
+ *   A pointer to the object to be added.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
+ * @return
+ *   - 0: Success; objects enqueued.
+ *   - -EDQUOT: Quota exceeded. The objects have been enqueued, but the
+ *     high water mark is exceeded.
+ *   - -ENOBUFS: Not enough room in the ring to enqueue; no object is enqueued.
+ */
+static inline int __attribute__((always_inline))
+rte_ring_enqueue_elem(struct rte_ring *r, const void *obj, unsigned esize)
+{
+	return rte_ring_enqueue_bulk_elem(r, obj, esize, 1);
+}
+
+/**
+ * Dequeue several objects of a given size from a ring (multi-consumers
+ * safe).
  *
  * @param r
  *   A pointer to the ring structure.
  * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
+ *   A pointer to a table of objects that will be filled.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
  * @param n
  *   The number of objects to dequeue from the ring to the obj_table.
  * @return
@@ -895,34 +2327,40 @@ rte_ring_enqueue(struct rte_ring *r, void *obj)
  *     dequeued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_mc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+rte_ring_mc_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
+			      unsigned esize, unsigned n)
 {
-	return __rte_ring_mc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+	return __rte_ring_mc_do_dequeue(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED);
 }
 
 /**
- * Dequeue several objects from a ring (NOT multi-consumers safe).
+ * Dequeue several objects of a given size from a ring (NOT multi-consumers
+ * safe).
  *
  * @param r
  *   A pointer to the ring structure.
  * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
+ *   A pointer to a table of objects that will be filled.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
  * @param n
- *   The number of objects to dequeue from the ring to the obj_table,
- *   must be strictly positive.
+ *   The number of objects to dequeue from the ring to the obj_table.
  * @return
  *   - 0: Success; objects dequeued.
  *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
  *     dequeued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_sc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+rte_ring_sc_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
+			      unsigned esize, unsigned n)
 {
-	return __rte_ring_sc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_FIXED);
+	return __rte_ring_sc_do_dequeue(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED);
 }
 
 /**
- * Dequeue several objects from a ring.
+ * Dequeue several objects of a given size from a ring.
  *
  * This function calls the multi-consumers or the single-consumer
  * version, depending on the default behaviour that was specified at
@@ -931,7 +2369,9 @@ rte_ring_sc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
  * @param r
  *   A pointer to the ring structure.
  * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
+ *   A pointer to a table of objects that will be filled.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
  * @param n
  *   The number of objects to dequeue from the ring to the obj_table.
  * @return
@@ -940,297 +2380,530 @@ rte_ring_sc_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
  *     dequeued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_dequeue_bulk(struct rte_ring *r, void **obj_table, unsigned n)
+rte_ring_dequeue_bulk_elem(struct rte_ring *r, void *obj_table,
+			   unsigned esize, unsigned n)
 {
-	if (r->cons.sc_dequeue)
-		return rte_ring_sc_dequeue_bulk(r, obj_table, n);
-	else
-		return rte_ring_mc_dequeue_bulk(r, obj_table, n);
+	return __rte_ring_do_dequeue(r, obj_table, esize, n,
+			RTE_RING_QUEUE_FIXED);
 }
 
 /**
- * Dequeue one object from a ring (multi-consumers safe).
- *
- * This function uses a "compare and set" instruction to move the
- * consumer index atomically.
+ * Dequeue one object of a given size from a ring (multi-consumers safe).
  *
  * @param r
  *   A pointer to the ring structure.
  * @param obj_p
- *   A pointer to a void * pointer (object) that will be filled.
+ *   A pointer to the object that will be filled.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
  * @return
  *   - 0: Success; objects dequeued.
  *   - -ENOENT: Not enough entries in the ring to dequeue; no object is
  *     dequeued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_mc_dequeue(struct rte_ring *r, void **obj_p)
+rte_ring_mc_dequeue_elem(struct rte_ring *r, void *obj_p, unsigned esize)
 {
-	return rte_ring_mc_dequeue_bulk(r, obj_p, 1);
+	return rte_ring_mc_dequeue_bulk_elem(r, obj_p, esize, 1);
 }
 
 /**
- * Dequeue one object from a ring (NOT multi-consumers safe).
+ * Dequeue one object of a given size from a ring (NOT multi-consumers safe).
  *
  * @param r
  *   A pointer to the ring structure.
  * @param obj_p
- *   A pointer to a void * pointer (object) that will be filled.
+ *   A pointer to the object that will be filled.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
  * @return
  *   - 0: Success; objects dequeued.
  *   - -ENOENT: Not enough entries in the ring to dequeue, no object is
  *     dequeued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_sc_dequeue(struct rte_ring *r, void **obj_p)
+rte_ring_sc_dequeue_elem(struct rte_ring *r, void *obj_p, unsigned esize)
 {
-	return rte_ring_sc_dequeue_bulk(r, obj_p, 1);
+	return rte_ring_sc_dequeue_bulk_elem(r, obj_p, esize, 1);
 }
 
 /**
- * Dequeue one object from a ring.
- *
- * This function calls the multi-consumers or the single-consumer
- * version depending on the default behaviour that was specified at
- * ring creation time (see flags).
+ * Dequeue one object of a given size from a ring, with the default
+ * behavior of the ring.
  *
  * @param r
  *   A pointer to the ring structure.
  * @param obj_p
- *   A pointer to a void * pointer (object) that will be filled.
+ *   A pointer to the object that will be filled.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
  * @return
  *   - 0: Success, objects dequeued.
  *   - -ENOENT: Not enough entries in the ring to dequeue, no object is
  *     dequeued.
  */
 static inline int __attribute__((always_inline))
-rte_ring_dequeue(struct rte_ring *r, void **obj_p)
+rte_ring_dequeue_elem(struct rte_ring *r, void *obj_p, unsigned esize)
 {
-	if (r->cons.sc_dequeue)
-		return rte_ring_sc_dequeue(r, obj_p);
-	else
-		return rte_ring_mc_dequeue(r, obj_p);
+	return rte_ring_dequeue_bulk_elem(r, obj_p, esize, 1);
 }
 
 /**
- * Test if a ring is full.
+ * Enqueue several objects of a given size on the ring (multi-producers
+ * safe). When there is not enough room, only enqueue the objects that fit.
  *
  * @param r
  *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
  * @return
- *   - 1: The ring is full.
- *   - 0: The ring is not full.
+ *   - n: Actual number of objects enqueued.
  */
-static inline int
-rte_ring_full(const struct rte_ring *r)
+static inline unsigned __attribute__((always_inline))
+rte_ring_mp_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+			       unsigned esize, unsigned n)
 {
-	uint32_t prod_tail = r->prod.tail;
-	uint32_t cons_tail = r->cons.tail;
-	return (((cons_tail - prod_tail - 1) & r->prod.mask) == 0);
+	return __rte_ring_mp_do_enqueue(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE);
 }
 
 /**
- * Test if a ring is empty.
+ * Enqueue several objects of a given size on a ring (NOT multi-producers
+ * safe). When there is not enough room, only enqueue the objects that fit.
  *
  * @param r
  *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
  * @return
- *   - 1: The ring is empty.
- *   - 0: The ring is not empty.
+ *   - n: Actual number of objects enqueued.
  */
-static inline int
-rte_ring_empty(const struct rte_ring *r)
+static inline unsigned __attribute__((always_inline))
+rte_ring_sp_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+			       unsigned esize, unsigned n)
 {
-	uint32_t prod_tail = r->prod.tail;
-	uint32_t cons_tail = r->cons.tail;
-	return !!(cons_tail == prod_tail);
+	return __rte_ring_sp_do_enqueue(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE);
 }
 
 /**
- * Return the number of entries in a ring.
+ * Enqueue several objects of a given size on a ring, with the default
+ * behavior of the ring. When there is not enough room, only enqueue the
+ * objects that fit.
  *
  * @param r
  *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
+ * @param n
+ *   The number of objects to add in the ring from the obj_table.
  * @return
- *   The number of entries in the ring.
+ *   - n: Actual number of objects enqueued.
  */
-static inline unsigned
-rte_ring_count(const struct rte_ring *r)
+static inline unsigned __attribute__((always_inline))
+rte_ring_enqueue_burst_elem(struct rte_ring *r, const void *obj_table,
+			    unsigned esize, unsigned n)
 {
-	uint32_t prod_tail = r->prod.tail;
-	uint32_t cons_tail = r->cons.tail;
-	return ((prod_tail - cons_tail) & r->prod.mask);
+	return __rte_ring_do_enqueue(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE);
 }
 
 /**
- * Return the number of free entries in a ring.
+ * Dequeue several objects of a given size from a ring (multi-consumers
+ * safe). When the request objects are more than the available objects,
+ * only dequeue the actual number of objects.
  *
  * @param r
  *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects that will be filled.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
  * @return
- *   The number of free entries in the ring.
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
  */
-static inline unsigned
-rte_ring_free_count(const struct rte_ring *r)
+static inline unsigned __attribute__((always_inline))
+rte_ring_mc_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
+			       unsigned esize, unsigned n)
 {
-	uint32_t prod_tail = r->prod.tail;
-	uint32_t cons_tail = r->cons.tail;
-	return ((cons_tail - prod_tail - 1) & r->prod.mask);
+	return __rte_ring_mc_do_dequeue(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE);
 }
 
 /**
- * Dump the status of all rings on the console
+ * Dequeue several objects of a given size from a ring (NOT multi-consumers
+ * safe). When the request objects are more than the available objects,
+ * only dequeue the actual number of objects.
  *
- * @param f
- *   A pointer to a file for output
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects that will be filled.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
+ * @return
+ *   - n: Actual number of objects dequeued, 0 if ring is empty
  */
-void rte_ring_list_dump(FILE *f);
+static inline unsigned __attribute__((always_inline))
+rte_ring_sc_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
+			       unsigned esize, unsigned n)
+{
+	return __rte_ring_sc_do_dequeue(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE);
+}
 
 /**
- * Search a ring from its name
+ * Dequeue several objects of a given size from a ring, with the default
+ * behavior of the ring. When the request objects are more than the
+ * available objects, only dequeue the actual number of objects.
  *
- * @param name
- *   The name of the ring.
+ * @param r
+ *   A pointer to the ring structure.
+ * @param obj_table
+ *   A pointer to a table of objects that will be filled.
+ * @param esize
+ *   The size of the objects, as given at the creation of the ring.
+ * @param n
+ *   The number of objects to dequeue from the ring to the obj_table.
  * @return
- *   The pointer to the ring matching the name, or NULL if not found,
- *   with rte_errno set appropriately. Possible rte_errno values include:
- *    - ENOENT - required entry not available to return.
+ *   - Number of objects dequeued
  */
-struct rte_ring *rte_ring_lookup(const char *name);
+static inline unsigned __attribute__((always_inline))
+rte_ring_dequeue_burst_elem(struct rte_ring *r, void *obj_table,
+			    unsigned esize, unsigned n)
+{
+	return __rte_ring_do_dequeue(r, obj_table, esize, n,
+			RTE_RING_QUEUE_VARIABLE);
+}
 
 /**
- * Enqueue several objects on the ring (multi-producers safe).
+ * Ring slots exposed by the zero-copy API, see
+ * rte_ring_enqueue_zc_burst_start() and rte_ring_dequeue_zc_burst_start().
  *
- * This function uses a "compare and set" instruction to move the
- * producer index atomically.
+ * The slots are contiguous, unless they wrap around the end of the ring:
+ * the first *n1* ones are at *ptr1* and the others at *ptr2*.
+ *
+ * The zero-copy API only applies to rings of pointers: on a ring created
+ * with rte_ring_create_elem() for objects of another size, no slot is
+ * reserved.
+ */
+struct rte_ring_zc_data {
+	void **ptr1;  /**< First slots. */
+	void **ptr2;  /**< Slots at the start of the ring, NULL if none. */
+	unsigned n1;  /**< Number of slots at ptr1. */
+};
+
+/**
+ * @internal Fill the slots description of the zero-copy API.
+ */
+static inline void __attribute__((always_inline))
+__rte_ring_get_zc_data(struct rte_ring *r, uint32_t head, unsigned n,
+		       struct rte_ring_zc_data *zcd)
+{
+	uint32_t idx = head & r->prod.mask;
+
+	zcd->ptr1 = &r->ring[idx];
+	if (likely(idx + n <= r->prod.size)) {
+		zcd->n1 = n;
+		zcd->ptr2 = NULL;
+	} else {
+		zcd->n1 = r->prod.size - idx;
+		zcd->ptr2 = &r->ring[0];
+	}
+}
+
+/**
+ * @internal Reserve slots to enqueue objects in place, moving the head of
+ * a single producer or of a HTS producer.
+ *
+ * @return
+ *   The number of slots reserved.
+ */
+static inline unsigned __attribute__((always_inline))
+__rte_ring_enqueue_zc_start(struct rte_ring *r, unsigned n,
+			    enum rte_ring_queue_behavior behavior,
+			    struct rte_ring_zc_data *zcd)
+{
+	union rte_ring_hts_pos op, np;
+	uint32_t prod_head, free_entries;
+	const unsigned max = n;
+	uint32_t mask = r->prod.mask;
+
+	/* the slots are only exposed as pointers */
+	if (unlikely(r->esize != sizeof(void *)))
+		return 0;
+
+	switch (r->prod.sync_type) {
+	case RTE_RING_SYNC_ST:
+		prod_head = r->prod.head;
+		free_entries = mask + r->cons.tail - prod_head;
+		if (unlikely(n > free_entries))
+			n = (behavior == RTE_RING_QUEUE_FIXED) ?
+				0 : free_entries;
+		r->prod.head = prod_head + n;
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		do {
+			/* Reset n to the initial burst count */
+			n = max;
+
+			op.raw = r->prod.hts.raw;
+			__rte_ring_hts_head_wait(&r->prod.hts, &op);
+
+			prod_head = op.pos.head;
+			free_entries = mask + r->cons.tail - prod_head;
+			if (unlikely(n > free_entries))
+				n = (behavior == RTE_RING_QUEUE_FIXED) ?
+					0 : free_entries;
+			if (unlikely(n == 0))
+				break;
+
+			np.pos.head = prod_head + n;
+			np.pos.tail = op.pos.tail;
+		} while (unlikely(rte_atomic64_cmpset(&r->prod.hts.raw,
+						      op.raw, np.raw) == 0));
+		break;
+	default:
+		/* the other modes cannot expose the slots */
+		return 0;
+	}
+
+	if (unlikely(n == 0)) {
+		__RING_STAT_ADD(r, enq_fail, max);
+		return 0;
+	}
+
+	__rte_ring_get_zc_data(r, prod_head, n, zcd);
+	return n;
+}
+
+/**
+ * @internal Reserve slots to dequeue objects in place, moving the head of
+ * a single consumer or of a HTS consumer.
+ *
+ * @return
+ *   The number of slots reserved.
+ */
+static inline unsigned __attribute__((always_inline))
+__rte_ring_dequeue_zc_start(struct rte_ring *r, unsigned n,
+			    enum rte_ring_queue_behavior behavior,
+			    struct rte_ring_zc_data *zcd)
+{
+	union rte_ring_hts_pos op, np;
+	uint32_t cons_head, entries;
+	const unsigned max = n;
+
+	/* the slots are only exposed as pointers */
+	if (unlikely(r->esize != sizeof(void *)))
+		return 0;
+
+	switch (r->cons.sync_type) {
+	case RTE_RING_SYNC_ST:
+		cons_head = r->cons.head;
+		entries = r->prod.tail - cons_head;
+		if (n > entries)
+			n = (behavior == RTE_RING_QUEUE_FIXED) ? 0 : entries;
+		r->cons.head = cons_head + n;
+		break;
+	case RTE_RING_SYNC_MT_HTS:
+		do {
+			/* Restore n as it may change every loop */
+			n = max;
+
+			op.raw = r->cons.hts.raw;
+			__rte_ring_hts_head_wait(&r->cons.hts, &op);
+
+			cons_head = op.pos.head;
+			entries = r->prod.tail - cons_head;
+			if (n > entries)
+				n = (behavior == RTE_RING_QUEUE_FIXED) ?
+					0 : entries;
+			if (unlikely(n == 0))
+				break;
+
+			np.pos.head = cons_head + n;
+			np.pos.tail = op.pos.tail;
+		} while (unlikely(rte_atomic64_cmpset(&r->cons.hts.raw,
+						      op.raw, np.raw) == 0));
+		break;
+	default:
+		/* the other modes cannot expose the slots */
+		return 0;
+	}
+
+	if (unlikely(n == 0)) {
+		__RING_STAT_ADD(r, deq_fail, max);
+		return 0;
+	}
+
+	__rte_ring_get_zc_data(r, cons_head, n, zcd);
+	return n;
+}
+
+/**
+ * Start to enqueue several objects on a ring, in place (zero-copy).
+ *
+ * Reserve *n* slots of the ring and return where they are: the caller
+ * writes the object pointers directly in them, then calls
+ * rte_ring_enqueue_zc_finish() to make them available to the consumers.
+ *
+ * Only a single producer or producers in HTS mode can use this API, for
+ * the other modes no slot is reserved. The ring is not available to the
+ * other producers until rte_ring_enqueue_zc_finish() is called. The high
+ * water mark is not checked.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
  * @param n
- *   The number of objects to add in the ring from the obj_table.
+ *   The number of slots to reserve.
+ * @param zcd
+ *   Filled with the reserved slots.
  * @return
- *   - n: Actual number of objects enqueued.
+ *   The number of slots reserved, either *n* or 0.
  */
 static inline unsigned __attribute__((always_inline))
-rte_ring_mp_enqueue_burst(struct rte_ring *r, void * const *obj_table,
-			 unsigned n)
+rte_ring_enqueue_zc_bulk_start(struct rte_ring *r, unsigned n,
+			       struct rte_ring_zc_data *zcd)
 {
-	return __rte_ring_mp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+	return __rte_ring_enqueue_zc_start(r, n, RTE_RING_QUEUE_FIXED, zcd);
 }
 
 /**
- * Enqueue several objects on a ring (NOT multi-producers safe).
+ * Start to enqueue up to *n* objects on a ring, in place (zero-copy).
+ *
+ * Same as rte_ring_enqueue_zc_bulk_start(), but reserve as many slots as
+ * available when there are less than *n*.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
  * @param n
- *   The number of objects to add in the ring from the obj_table.
+ *   The maximum number of slots to reserve.
+ * @param zcd
+ *   Filled with the reserved slots.
  * @return
- *   - n: Actual number of objects enqueued.
+ *   The number of slots reserved, between 0 and *n*.
  */
 static inline unsigned __attribute__((always_inline))
-rte_ring_sp_enqueue_burst(struct rte_ring *r, void * const *obj_table,
-			 unsigned n)
+rte_ring_enqueue_zc_burst_start(struct rte_ring *r, unsigned n,
+				struct rte_ring_zc_data *zcd)
 {
-	return __rte_ring_sp_do_enqueue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+	return __rte_ring_enqueue_zc_start(r, n, RTE_RING_QUEUE_VARIABLE, zcd);
 }
 
 /**
- * Enqueue several objects on a ring.
+ * Complete an enqueue started with rte_ring_enqueue_zc_bulk_start() or
+ * rte_ring_enqueue_zc_burst_start(), which returned a non-zero value.
  *
- * This function calls the multi-producer or the single-producer
- * version depending on the default behavior that was specified at
- * ring creation time (see flags).
+ * The first *n* reserved slots, which must have been written, are made
+ * available to the consumers. The other ones are released.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects).
  * @param n
- *   The number of objects to add in the ring from the obj_table.
- * @return
- *   - n: Actual number of objects enqueued.
+ *   The number of objects enqueued, at most the number of slots reserved.
  */
-static inline unsigned __attribute__((always_inline))
-rte_ring_enqueue_burst(struct rte_ring *r, void * const *obj_table,
-		      unsigned n)
+static inline void __attribute__((always_inline))
+rte_ring_enqueue_zc_finish(struct rte_ring *r, unsigned n)
 {
-	if (r->prod.sp_enqueue)
-		return rte_ring_sp_enqueue_burst(r, obj_table, n);
-	else
-		return rte_ring_mp_enqueue_burst(r, obj_table, n);
+	uint32_t prod_tail = r->prod.tail + n;
+
+	/* the slots are written before the objects are made available */
+	rte_compiler_barrier();
+	__RING_STAT_ADD(r, enq_success, n);
+
+	/* the head first, so that HTS producers still wait */
+	r->prod.head = prod_tail;
+	r->prod.tail = prod_tail;
 }
 
 /**
- * Dequeue several objects from a ring (multi-consumers safe). When the request
- * objects are more than the available objects, only dequeue the actual number
- * of objects
+ * Start to dequeue several objects from a ring, in place (zero-copy).
  *
- * This function uses a "compare and set" instruction to move the
- * consumer index atomically.
+ * Reserve *n* slots of the ring and return where they are: the caller
+ * reads the object pointers directly from them, then calls
+ * rte_ring_dequeue_zc_finish() with the number of objects it takes, the
+ * others remaining at the head of the ring.
+ *
+ * Only a single consumer or consumers in HTS mode can use this API, for
+ * the other modes no slot is reserved. The ring is not available to the
+ * other consumers until rte_ring_dequeue_zc_finish() is called.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
  * @param n
- *   The number of objects to dequeue from the ring to the obj_table.
+ *   The number of slots to reserve.
+ * @param zcd
+ *   Filled with the reserved slots.
  * @return
- *   - n: Actual number of objects dequeued, 0 if ring is empty
+ *   The number of slots reserved, either *n* or 0.
  */
 static inline unsigned __attribute__((always_inline))
-rte_ring_mc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
+rte_ring_dequeue_zc_bulk_start(struct rte_ring *r, unsigned n,
+			       struct rte_ring_zc_data *zcd)
 {
-	return __rte_ring_mc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+	return __rte_ring_dequeue_zc_start(r, n, RTE_RING_QUEUE_FIXED, zcd);
 }
 
 /**
- * Dequeue several objects from a ring (NOT multi-consumers safe).When the
- * request objects are more than the available objects, only dequeue the
- * actual number of objects
+ * Start to dequeue up to *n* objects from a ring, in place (zero-copy).
+ *
+ * Same as rte_ring_dequeue_zc_bulk_start(), but reserve as many slots as
+ * objects in the ring when there are less than *n*.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
  * @param n
- *   The number of objects to dequeue from the ring to the obj_table.
+ *   The maximum number of slots to reserve.
+ * @param zcd
+ *   Filled with the reserved slots.
  * @return
- *   - n: Actual number of objects dequeued, 0 if ring is empty
+ *   The number of slots reserved, between 0 and *n*.
  */
 static inline unsigned __attribute__((always_inline))
-rte_ring_sc_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
+rte_ring_dequeue_zc_burst_start(struct rte_ring *r, unsigned n,
+				struct rte_ring_zc_data *zcd)
 {
-	return __rte_ring_sc_do_dequeue(r, obj_table, n, RTE_RING_QUEUE_VARIABLE);
+	return __rte_ring_dequeue_zc_start(r, n, RTE_RING_QUEUE_VARIABLE, zcd);
 }
 
 /**
- * Dequeue multiple objects from a ring up to a maximum number.
+ * Complete a dequeue started with rte_ring_dequeue_zc_bulk_start() or
+ * rte_ring_dequeue_zc_burst_start(), which returned a non-zero value.
  *
- * This function calls the multi-consumers or the single-consumer
- * version, depending on the default behaviour that was specified at
- * ring creation time (see flags).
+ * The objects of the first *n* reserved slots are removed from the ring,
+ * the other ones are left at its head.
  *
  * @param r
  *   A pointer to the ring structure.
- * @param obj_table
- *   A pointer to a table of void * pointers (objects) that will be filled.
  * @param n
- *   The number of objects to dequeue from the ring to the obj_table.
- * @return
- *   - Number of objects dequeued
+ *   The number of objects dequeued, at most the number of slots reserved.
  */
-static inline unsigned __attribute__((always_inline))
-rte_ring_dequeue_burst(struct rte_ring *r, void **obj_table, unsigned n)
+static inline void __attribute__((always_inline))
+rte_ring_dequeue_zc_finish(struct rte_ring *r, unsigned n)
 {
-	if (r->cons.sc_dequeue)
-		return rte_ring_sc_dequeue_burst(r, obj_table, n);
-	else
-		return rte_ring_mc_dequeue_burst(r, obj_table, n);
+	uint32_t cons_tail = r->cons.tail + n;
+
+	/* the slots are read before they are given back to the producers */
+	rte_compiler_barrier();
+	__RING_STAT_ADD(r, deq_success, n);
+
+	/* the head first, so that HTS consumers still wait */
+	r->cons.head = cons_tail;
+	r->cons.tail = cons_tail;
 }
 
 #ifdef __cplusplus
@@ -39,6 +39,7 @@
 #include <rte_memory.h>
 #include <rte_malloc.h>
 #include <rte_cycles.h>
+#include <rte_atomic.h>
 #include <rte_prefetch.h>
 #include <rte_branch_prediction.h>
 #include <rte_mbuf.h>
@@ -96,7 +97,10 @@
 #error Number of grinders must be 8 when RTE_SCHED_OPTIMIZATIONS is set
 #endif
 
-#define RTE_SCHED_GRINDER_PCACHE_SIZE         (64 / RTE_SCHED_QUEUES_PER_PIPE)
+/* One bitmap slab (64 queues) holds up to 64 pipes when there is one queue per pipe */
+#define RTE_SCHED_GRINDER_PCACHE_SIZE         64
+
+#define RTE_SCHED_GRINDER_TCCACHE_SIZE        RTE_SCHED_TRAFFIC_CLASSES_MAX
 
 #define RTE_SCHED_PIPE_INVALID                UINT32_MAX
 
@@ -112,8 +116,8 @@ struct rte_sched_subport {
 
 	/* Traffic classes (TCs) */
 	uint64_t tc_time; /* time of next update */
-	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	uint32_t tc_period;
 
 	/* TC oversubscription */
@@ -137,11 +141,11 @@ struct rte_sched_pipe_profile {
 
 	/* Pipe traffic classes */
 	uint32_t tc_period;
-	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_credits_per_period[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	uint8_t tc_ov_weight;
 
 	/* Pipe queues */
-	uint8_t  wrr_cost[RTE_SCHED_QUEUES_PER_PIPE];
+	uint8_t  wrr_cost[RTE_SCHED_QUEUES_PER_PIPE_MAX];
 };
 
 struct rte_sched_pipe {
@@ -154,15 +158,32 @@ struct rte_sched_pipe {
 
 	/* Traffic classes (TCs) */
 	uint64_t tc_time; /* time of next update */
-	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-
-	/* Weighted Round Robin (WRR) */
-	uint8_t wrr_tokens[RTE_SCHED_QUEUES_PER_PIPE];
 
 	/* TC oversubscription */
 	uint32_t tc_ov_credits;
 	uint8_t tc_ov_period_id;
 	uint8_t reserved[3];
+
+	/* Weighted Round Robin (WRR) */
+	uint8_t wrr_tokens[RTE_SCHED_QUEUES_PER_PIPE_MAX];
+
+	/* Traffic class credits, kept last so that the ones of the default
+	 * pipe shape share the first cache line with the fields above */
+	uint32_t tc_credits[RTE_SCHED_TRAFFIC_CLASSES_MAX];
+} __rte_cache_aligned;
+
+struct rte_sched_arbiter {
+	/* Configuration, read-only after creation */
+	uint64_t time_cpu_cycles;     /* CPU time of arbiter creation */
+	double cycles_per_byte;       /* CPU cycles per byte */
+	uint32_t rate;
+	uint32_t tb_size;
+	uint32_t quantum;
+
+	/* Port time (measured in bytes since arbiter creation) up to which credits
+	 * were handed out to the shards. Written by all the shards, hence on its
+	 * own cache line. */
+	volatile uint64_t time __rte_cache_aligned;
 } __rte_cache_aligned;
 
 struct rte_sched_queue {
@@ -200,25 +221,25 @@ struct rte_sched_grinder {
 	struct rte_sched_pipe_profile *pipe_params;
 
 	/* TC cache */
-	uint8_t tccache_qmask[4];
-	uint32_t tccache_qindex[4];
+	uint8_t tccache_qmask[RTE_SCHED_GRINDER_TCCACHE_SIZE];
+	uint32_t tccache_qindex[RTE_SCHED_GRINDER_TCCACHE_SIZE];
 	uint32_t tccache_w;
 	uint32_t tccache_r;
 
 	/* Current TC */
 	uint32_t tc_index;
-	struct rte_sched_queue *queue[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	struct rte_mbuf **qbase[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
-	uint32_t qindex[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	struct rte_sched_queue *queue[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
+	struct rte_mbuf **qbase[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
+	uint32_t qindex[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
 	uint16_t qsize;
 	uint32_t qmask;
 	uint32_t qpos;
 	struct rte_mbuf *pkt;
 
 	/* WRR */
-	uint16_t wrr_tokens[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
-	uint16_t wrr_mask[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
-	uint8_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
+	uint16_t wrr_tokens[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
+	uint16_t wrr_mask[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
+	uint8_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
 };
 
 struct rte_sched_port {
@@ -228,13 +249,21 @@ struct rte_sched_port {
 	uint32_t rate;
 	uint32_t mtu;
 	uint32_t frame_overhead;
-	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_MAX];
 	uint32_t n_pipe_profiles;
-	uint32_t pipe_tc3_rate_max;
+	uint32_t pipe_tc_ov_rate_max;
 #ifdef RTE_SCHED_RED
-	struct rte_red_config red_config[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS];
+	struct rte_red_config red_config[RTE_SCHED_TRAFFIC_CLASSES_MAX][e_RTE_METER_COLORS];
 #endif
 
+	/* Pipe shape */
+	uint32_t n_traffic_classes;
+	uint32_t n_queues_per_tc;
+	uint32_t n_queues_per_tc_log2;
+	uint32_t n_queues_per_pipe;
+	uint32_t n_queues_per_pipe_log2;
+	uint32_t tc_ov_index; /* lowest priority TC, subject to oversubscription */
+
 	/* Timing */
 	uint64_t time_cpu_cycles;     /* Current CPU time measured in CPU cyles */
 	uint64_t time_cpu_bytes;      /* Current CPU time measured in bytes */
@@ -245,6 +274,11 @@ struct rte_sched_port {
 	uint32_t pipe_loop;
 	uint32_t pipe_exhaustion;
 
+	/* Port arbiter shared with the other shards of the same output port */
+	struct rte_sched_arbiter *arbiter;
+	uint32_t arbiter_credits;
+	uint32_t arbiter_exhaustion;
+
 	/* Bitmap */
 	struct rte_bitmap *bmp;
 	uint32_t grinder_base_bmp_pos[RTE_SCHED_PORT_N_GRINDERS] __rte_aligned_16;
@@ -256,7 +290,7 @@ struct rte_sched_port {
 	uint32_t n_pkts_out;
 
 	/* Queue base calculation */
-	uint32_t qsize_add[RTE_SCHED_QUEUES_PER_PIPE];
+	uint32_t qsize_add[RTE_SCHED_QUEUES_PER_PIPE_MAX];
 	uint32_t qsize_sum;
 
 	/* Large data structures */
@@ -286,7 +320,7 @@ enum rte_sched_port_array {
 static inline uint32_t
 rte_sched_port_queues_per_subport(struct rte_sched_port *port)
 {
-	return RTE_SCHED_QUEUES_PER_PIPE * port->n_pipes_per_subport;
+	return port->n_queues_per_pipe * port->n_pipes_per_subport;
 }
 
 #endif
@@ -294,18 +328,44 @@ rte_sched_port_queues_per_subport(struct rte_sched_port *port)
 static inline uint32_t
 rte_sched_port_queues_per_port(struct rte_sched_port *port)
 {
-	return RTE_SCHED_QUEUES_PER_PIPE * port->n_pipes_per_subport * port->n_subports_per_port;
+	return port->n_queues_per_pipe * port->n_pipes_per_subport * port->n_subports_per_port;
+}
+
+static inline uint32_t
+rte_sched_params_n_traffic_classes(struct rte_sched_port_params *params)
+{
+	return (params->n_traffic_classes != 0) ?
+		params->n_traffic_classes : RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE;
+}
+
+static inline uint32_t
+rte_sched_params_n_queues_per_tc(struct rte_sched_port_params *params)
+{
+	return (params->n_queues_per_traffic_class != 0) ?
+		params->n_queues_per_traffic_class : RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
 }
 
 static int
 rte_sched_port_check_params(struct rte_sched_port_params *params)
 {
-	uint32_t i, j;
+	uint32_t n_tcs, n_queues_per_tc, i, j;
 
 	if (params == NULL) {
 		return -1;
 	}
 
+	/* pipe shape: power of 2 number of TCs and queues per TC, no more than
+	 * RTE_SCHED_QUEUES_PER_PIPE_MAX queues per pipe */
+	n_tcs = rte_sched_params_n_traffic_classes(params);
+	n_queues_per_tc = rte_sched_params_n_queues_per_tc(params);
+	if ((!rte_is_power_of_2(n_tcs)) ||
+	    (n_tcs > RTE_SCHED_TRAFFIC_CLASSES_MAX) ||
+	    (!rte_is_power_of_2(n_queues_per_tc)) ||
+	    (n_queues_per_tc > RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX) ||
+	    (n_tcs * n_queues_per_tc > RTE_SCHED_QUEUES_PER_PIPE_MAX)) {
+		return -2;
+	}
+
 	/* socket */
 	if ((params->socket < 0) || (params->socket >= RTE_MAX_NUMA_NODES)) {
 		return -3;
@@ -332,7 +392,7 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 	}
 
 	/* qsize: non-zero, power of 2, no bigger than 32K (due to 16-bit read/write pointers) */
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
+	for (i = 0; i < n_tcs; i ++) {
 		uint16_t qsize = params->qsize[i];
 
 		if ((qsize == 0) || (!rte_is_power_of_2(qsize))) {
@@ -361,7 +421,7 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 		}
 
 		/* TC rate: non-zero, less than pipe rate */
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j ++) {
+		for (j = 0; j < n_tcs; j ++) {
 			if ((p->tc_rate[j] == 0) || (p->tc_rate[j] > p->tb_rate)) {
 				return -12;
 			}
@@ -373,14 +433,14 @@ rte_sched_port_check_params(struct rte_sched_port_params *params)
 		}
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-		/* TC3 oversubscription weight: non-zero */
+		/* Lowest priority TC oversubscription weight: non-zero */
 		if (p->tc_ov_weight == 0) {
 			return -14;
 		}
 #endif
 
 		/* Queue WRR weights: non-zero */
-		for (j = 0; j < RTE_SCHED_QUEUES_PER_PIPE; j ++) {
+		for (j = 0; j < n_tcs * n_queues_per_tc; j ++) {
 			if (p->wrr_weights[j] == 0) {
 				return -15;
 			}
@@ -396,7 +456,9 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 	uint32_t n_subports_per_port = params->n_subports_per_port;
 	uint32_t n_pipes_per_subport = params->n_pipes_per_subport;
 	uint32_t n_pipes_per_port = n_pipes_per_subport * n_subports_per_port;
-	uint32_t n_queues_per_port = RTE_SCHED_QUEUES_PER_PIPE * n_pipes_per_subport * n_subports_per_port;
+	uint32_t n_tcs = rte_sched_params_n_traffic_classes(params);
+	uint32_t n_queues_per_tc = rte_sched_params_n_queues_per_tc(params);
+	uint32_t n_queues_per_port = n_tcs * n_queues_per_tc * n_pipes_per_port;
 
 	uint32_t size_subport = n_subports_per_port * sizeof(struct rte_sched_subport);
 	uint32_t size_pipe = n_pipes_per_port * sizeof(struct rte_sched_pipe);
@@ -409,8 +471,8 @@ rte_sched_port_get_array_base(struct rte_sched_port_params *params, enum rte_sch
 	uint32_t base, i;
 
 	size_per_pipe_queue_array = 0;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
-		size_per_pipe_queue_array += RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS * params->qsize[i] * sizeof(struct rte_mbuf *);
+	for (i = 0; i < n_tcs; i ++) {
+		size_per_pipe_queue_array += n_queues_per_tc * params->qsize[i] * sizeof(struct rte_mbuf *);
 	}
 	size_queue_array = n_pipes_per_port * size_per_pipe_queue_array;
 
@@ -462,43 +524,61 @@ rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params)
 static void
 rte_sched_port_config_qsize(struct rte_sched_port *port)
 {
-	/* TC 0 */
+	uint32_t i;
+
+	/* Queues of the same pipe are stored back to back, in TC order */
 	port->qsize_add[0] = 0;
-	port->qsize_add[1] = port->qsize_add[0] + port->qsize[0];
-	port->qsize_add[2] = port->qsize_add[1] + port->qsize[0];
-	port->qsize_add[3] = port->qsize_add[2] + port->qsize[0];
+	for (i = 1; i < port->n_queues_per_pipe; i ++) {
+		uint32_t tc = (i - 1) >> port->n_queues_per_tc_log2;
+
+		port->qsize_add[i] = port->qsize_add[i - 1] + port->qsize[tc];
+	}
 
-	/* TC 1 */
-	port->qsize_add[4] = port->qsize_add[3] + port->qsize[0];
-	port->qsize_add[5] = port->qsize_add[4] + port->qsize[1];
-	port->qsize_add[6] = port->qsize_add[5] + port->qsize[1];
-	port->qsize_add[7] = port->qsize_add[6] + port->qsize[1];
+	port->qsize_sum = port->qsize_add[port->n_queues_per_pipe - 1] +
+		port->qsize[port->n_traffic_classes - 1];
+}
+
+static void
+rte_sched_log_u32_array(char *buf, size_t size, const uint32_t *a, uint32_t n)
+{
+	uint32_t i;
+	int len = 0;
 
-	/* TC 2 */
-	port->qsize_add[8] = port->qsize_add[7] + port->qsize[1];
-	port->qsize_add[9] = port->qsize_add[8] + port->qsize[2];
-	port->qsize_add[10] = port->qsize_add[9] + port->qsize[2];
-	port->qsize_add[11] = port->qsize_add[10] + port->qsize[2];
+	buf[0] = '\0';
+	for (i = 0; (i < n) && (len >= 0) && ((size_t) len < size); i ++) {
+		len += snprintf(buf + len, size - len, "%s%u", (i == 0) ? "" : ", ", a[i]);
+	}
+}
 
-	/* TC 3 */
-	port->qsize_add[12] = port->qsize_add[11] + port->qsize[2];
-	port->qsize_add[13] = port->qsize_add[12] + port->qsize[3];
-	port->qsize_add[14] = port->qsize_add[13] + port->qsize[3];
-	port->qsize_add[15] = port->qsize_add[14] + port->qsize[3];
+static void
+rte_sched_log_u8_array(char *buf, size_t size, const uint8_t *a, uint32_t n)
+{
+	uint32_t a32[RTE_SCHED_QUEUES_PER_PIPE_MAX];
+	uint32_t i;
 
-	port->qsize_sum = port->qsize_add[15] + port->qsize[3];
+	for (i = 0; i < n; i ++) {
+		a32[i] = a[i];
+	}
+	rte_sched_log_u32_array(buf, size, a32, n);
 }
 
 static void
 rte_sched_port_log_pipe_profile(struct rte_sched_port *port, uint32_t i)
 {
 	struct rte_sched_pipe_profile *p = port->pipe_profiles + i;
+	char tc_credits[RTE_SCHED_TRAFFIC_CLASSES_MAX * 12];
+	char wrr_cost[RTE_SCHED_QUEUES_PER_PIPE_MAX * 6];
+
+	rte_sched_log_u32_array(tc_credits, sizeof(tc_credits),
+		p->tc_credits_per_period, port->n_traffic_classes);
+	rte_sched_log_u8_array(wrr_cost, sizeof(wrr_cost),
+		p->wrr_cost, port->n_queues_per_pipe);
 
 	RTE_LOG(INFO, SCHED, "Low level config for pipe profile %u:\n"
 		"\tToken bucket: period = %u, credits per period = %u, size = %u\n"
-		"\tTraffic classes: period = %u, credits per period = [%u, %u, %u, %u]\n"
-		"\tTraffic class 3 oversubscription: weight = %hhu\n"
-		"\tWRR cost: [%hhu, %hhu, %hhu, %hhu], [%hhu, %hhu, %hhu, %hhu], [%hhu, %hhu, %hhu, %hhu], [%hhu, %hhu, %hhu, %hhu]\n",
+		"\tTraffic classes: period = %u, credits per period = [%s]\n"
+		"\tTraffic class %u oversubscription: weight = %hhu\n"
+		"\tWRR cost (%u queues per traffic class): [%s]\n",
 		i,
 
 		/* Token bucket */
@@ -508,19 +588,15 @@ rte_sched_port_log_pipe_profile(struct rte_sched_port *port, uint32_t i)
 
 		/* Traffic classes */
 		p->tc_period,
-		p->tc_credits_per_period[0],
-		p->tc_credits_per_period[1],
-		p->tc_credits_per_period[2],
-		p->tc_credits_per_period[3],
+		tc_credits,
 
-		/* Traffic class 3 oversubscription */
+		/* Lowest priority traffic class oversubscription */
+		port->tc_ov_index,
 		p->tc_ov_weight,
 
 		/* WRR */
-		p->wrr_cost[ 0], p->wrr_cost[ 1], p->wrr_cost[ 2], p->wrr_cost[ 3],
-		p->wrr_cost[ 4], p->wrr_cost[ 5], p->wrr_cost[ 6], p->wrr_cost[ 7],
-		p->wrr_cost[ 8], p->wrr_cost[ 9], p->wrr_cost[10], p->wrr_cost[11],
-		p->wrr_cost[12], p->wrr_cost[13], p->wrr_cost[14], p->wrr_cost[15]);
+		port->n_queues_per_tc,
+		wrr_cost);
 }
 
 static inline uint64_t
@@ -555,7 +631,7 @@ rte_sched_port_config_pipe_profile_table(struct rte_sched_port *port, struct rte
 
 		/* Traffic Classes */
 		dst->tc_period = (uint32_t) rte_sched_time_ms_to_bytes(src->tc_period, params->rate);
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j ++) {
+		for (j = 0; j < port->n_traffic_classes; j ++) {
 			dst->tc_credits_per_period[j] = (uint32_t) rte_sched_time_ms_to_bytes(src->tc_period, src->tc_rate[j]);
 		}
 #ifdef RTE_SCHED_SUBPORT_TC_OV
@@ -563,43 +639,34 @@ rte_sched_port_config_pipe_profile_table(struct rte_sched_port *port, struct rte
 #endif
 
 		/* WRR */
-		for (j = 0; j < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; j ++) {
-			uint32_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS];
-			uint32_t lcd, lcd1, lcd2;
+		for (j = 0; j < port->n_traffic_classes; j ++) {
+			uint32_t wrr_cost[RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX];
+			uint32_t lcd, k;
 			uint32_t qindex;
 
-			qindex = j * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
-
-			wrr_cost[0] = src->wrr_weights[qindex];
-			wrr_cost[1] = src->wrr_weights[qindex + 1];
-			wrr_cost[2] = src->wrr_weights[qindex + 2];
-			wrr_cost[3] = src->wrr_weights[qindex + 3];
+			qindex = j * port->n_queues_per_tc;
 
-			lcd1 = rte_get_lcd(wrr_cost[0], wrr_cost[1]);
-			lcd2 = rte_get_lcd(wrr_cost[2], wrr_cost[3]);
-			lcd = rte_get_lcd(lcd1, lcd2);
-
-			wrr_cost[0] = lcd / wrr_cost[0];
-			wrr_cost[1] = lcd / wrr_cost[1];
-			wrr_cost[2] = lcd / wrr_cost[2];
-			wrr_cost[3] = lcd / wrr_cost[3];
+			lcd = src->wrr_weights[qindex];
+			for (k = 1; k < port->n_queues_per_tc; k ++) {
+				lcd = rte_get_lcd(lcd, src->wrr_weights[qindex + k]);
+			}
 
-			dst->wrr_cost[qindex] = (uint8_t) wrr_cost[0];
-			dst->wrr_cost[qindex + 1] = (uint8_t) wrr_cost[1];
-			dst->wrr_cost[qindex + 2] = (uint8_t) wrr_cost[2];
-			dst->wrr_cost[qindex + 3] = (uint8_t) wrr_cost[3];
+			for (k = 0; k < port->n_queues_per_tc; k ++) {
+				wrr_cost[k] = lcd / src->wrr_weights[qindex + k];
+				dst->wrr_cost[qindex + k] = (uint8_t) wrr_cost[k];
+			}
 		}
 
 		rte_sched_port_log_pipe_profile(port, i);
 	}
 
-	port->pipe_tc3_rate_max = 0;
+	port->pipe_tc_ov_rate_max = 0;
 	for (i = 0; i < port->n_pipe_profiles; i ++) {
 		struct rte_sched_pipe_params *src = params->pipe_profiles + i;
-		uint32_t pipe_tc3_rate = src->tc_rate[3];
+		uint32_t pipe_tc_ov_rate = src->tc_rate[port->tc_ov_index];
 
-		if (port->pipe_tc3_rate_max < pipe_tc3_rate) {
-			port->pipe_tc3_rate_max = pipe_tc3_rate;
+		if (port->pipe_tc_ov_rate_max < pipe_tc_ov_rate) {
+			port->pipe_tc_ov_rate_max = pipe_tc_ov_rate;
 		}
 	}
 }
@@ -631,8 +698,16 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	memcpy(port->qsize, params->qsize, sizeof(params->qsize));
 	port->n_pipe_profiles = params->n_pipe_profiles;
 
+	/* Pipe shape */
+	port->n_traffic_classes = rte_sched_params_n_traffic_classes(params);
+	port->n_queues_per_tc = rte_sched_params_n_queues_per_tc(params);
+	port->n_queues_per_tc_log2 = __builtin_ctz(port->n_queues_per_tc);
+	port->n_queues_per_pipe = port->n_traffic_classes * port->n_queues_per_tc;
+	port->n_queues_per_pipe_log2 = __builtin_ctz(port->n_queues_per_pipe);
+	port->tc_ov_index = port->n_traffic_classes - 1;
+
 #ifdef RTE_SCHED_RED
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i++) {
+	for (i = 0; i < port->n_traffic_classes; i++) {
 		uint32_t j;
 
 		for (j = 0; j < e_RTE_METER_COLORS; j++) {
@@ -692,6 +767,66 @@ rte_sched_port_config(struct rte_sched_port_params *params)
 	return port;
 }
 
+struct rte_sched_arbiter *
+rte_sched_arbiter_create(struct rte_sched_arbiter_params *params)
+{
+	struct rte_sched_arbiter *arbiter;
+
+	/* Check user parameters */
+	if ((params == NULL) ||
+	    (params->rate == 0) ||
+	    (params->tb_size == 0) ||
+	    (params->quantum == 0)) {
+		return NULL;
+	}
+
+	arbiter = rte_zmalloc_socket("qos_arbiter", sizeof(struct rte_sched_arbiter),
+		RTE_CACHE_LINE_SIZE, params->socket);
+	if (arbiter == NULL) {
+		return NULL;
+	}
+
+	arbiter->rate = params->rate;
+	arbiter->tb_size = params->tb_size;
+	arbiter->quantum = params->quantum;
+	arbiter->cycles_per_byte = ((double) rte_get_tsc_hz()) / ((double) params->rate);
+	arbiter->time_cpu_cycles = rte_get_tsc_cycles();
+	arbiter->time = 0;
+
+	RTE_LOG(INFO, SCHED, "Arbiter %s: rate = %u, tb size = %u, quantum = %u\n",
+		(params->name != NULL) ? params->name : "", params->rate,
+		params->tb_size, params->quantum);
+
+	return arbiter;
+}
+
+void
+rte_sched_arbiter_free(struct rte_sched_arbiter *arbiter)
+{
+	rte_free(arbiter);
+}
+
+int
+rte_sched_port_arbiter_attach(struct rte_sched_port *port,
+	struct rte_sched_arbiter *arbiter)
+{
+	/* Check user parameters */
+	if (port == NULL) {
+		return -1;
+	}
+
+	if ((arbiter != NULL) && (arbiter->rate != port->rate)) {
+		return -2;
+	}
+
+	/* Credits are not given back, they are lost when detaching */
+	port->arbiter = arbiter;
+	port->arbiter_credits = 0;
+	port->arbiter_exhaustion = 0;
+
+	return 0;
+}
+
 void
 rte_sched_port_free(struct rte_sched_port *port)
 {
@@ -708,11 +843,15 @@ static void
 rte_sched_port_log_subport_config(struct rte_sched_port *port, uint32_t i)
 {
 	struct rte_sched_subport *s = port->subport + i;
+	char tc_credits[RTE_SCHED_TRAFFIC_CLASSES_MAX * 12];
+
+	rte_sched_log_u32_array(tc_credits, sizeof(tc_credits),
+		s->tc_credits_per_period, port->n_traffic_classes);
 
 	RTE_LOG(INFO, SCHED, "Low level config for subport %u:\n"
 		"\tToken bucket: period = %u, credits per period = %u, size = %u\n"
-		"\tTraffic classes: period = %u, credits per period = [%u, %u, %u, %u]\n"
-		"\tTraffic class 3 oversubscription: wm min = %u, wm max = %u\n",
+		"\tTraffic classes: period = %u, credits per period = [%s]\n"
+		"\tTraffic class %u oversubscription: wm min = %u, wm max = %u\n",
 		i,
 
 		/* Token bucket */
@@ -722,12 +861,10 @@ rte_sched_port_log_subport_config(struct rte_sched_port *port, uint32_t i)
 
 		/* Traffic classes */
 		s->tc_period,
-		s->tc_credits_per_period[0],
-		s->tc_credits_per_period[1],
-		s->tc_credits_per_period[2],
-		s->tc_credits_per_period[3],
+		tc_credits,
 
-		/* Traffic class 3 oversubscription */
+		/* Lowest priority traffic class oversubscription */
+		port->tc_ov_index,
 		s->tc_ov_wm_min,
 		s->tc_ov_wm_max);
 }
@@ -755,7 +892,7 @@ rte_sched_subport_config(struct rte_sched_port *port,
 		return -3;
 	}
 
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
+	for (i = 0; i < port->n_traffic_classes; i ++) {
 		if ((params->tc_rate[i] == 0) || (params->tc_rate[i] > params->tb_rate)) {
 			return -4;
 		}
@@ -783,18 +920,18 @@ rte_sched_subport_config(struct rte_sched_port *port,
 
 	/* Traffic Classes (TCs) */
 	s->tc_period = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, port->rate);
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
+	for (i = 0; i < port->n_traffic_classes; i ++) {
 		s->tc_credits_per_period[i] = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, params->tc_rate[i]);
 	}
 	s->tc_time = port->time + s->tc_period;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
+	for (i = 0; i < port->n_traffic_classes; i ++) {
 		s->tc_credits[i] = s->tc_credits_per_period[i];
 	}
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
 	/* TC oversubscription */
 	s->tc_ov_wm_min = port->mtu;
-	s->tc_ov_wm_max = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, port->pipe_tc3_rate_max);
+	s->tc_ov_wm_max = (uint32_t) rte_sched_time_ms_to_bytes(params->tc_period, port->pipe_tc_ov_rate_max);
 	s->tc_ov_wm = s->tc_ov_wm_max;
 	s->tc_ov_period_id = 0;
 	s->tc_ov = 0;
@@ -841,18 +978,19 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 		params = port->pipe_profiles + p->profile;
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-		double subport_tc3_rate = ((double) s->tc_credits_per_period[3]) / ((double) s->tc_period);
-		double pipe_tc3_rate = ((double) params->tc_credits_per_period[3]) / ((double) params->tc_period);
-		uint32_t tc3_ov = s->tc_ov;
+		uint32_t tc_ov_index = port->tc_ov_index;
+		double subport_tc_ov_rate = ((double) s->tc_credits_per_period[tc_ov_index]) / ((double) s->tc_period);
+		double pipe_tc_ov_rate = ((double) params->tc_credits_per_period[tc_ov_index]) / ((double) params->tc_period);
+		uint32_t tc_ov = s->tc_ov;
 
 		/* Unplug pipe from its subport */
 		s->tc_ov_n -= params->tc_ov_weight;
-		s->tc_ov_rate -= pipe_tc3_rate;
-		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+		s->tc_ov_rate -= pipe_tc_ov_rate;
+		s->tc_ov = s->tc_ov_rate > subport_tc_ov_rate;
 
-		if (s->tc_ov != tc3_ov) {
-			RTE_LOG(INFO, SCHED, "Subport %u TC3 oversubscription is OFF (%.4lf >= %.4lf)\n",
-				subport_id, subport_tc3_rate, s->tc_ov_rate);
+		if (s->tc_ov != tc_ov) {
+			RTE_LOG(INFO, SCHED, "Subport %u TC%u oversubscription is OFF (%.4lf >= %.4lf)\n",
+				subport_id, tc_ov_index, subport_tc_ov_rate, s->tc_ov_rate);
 		}
 #endif
 
@@ -874,24 +1012,25 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 
 	/* Traffic Classes (TCs) */
 	p->tc_time = port->time + params->tc_period;
-	for (i = 0; i < RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE; i ++) {
+	for (i = 0; i < port->n_traffic_classes; i ++) {
 		p->tc_credits[i] = params->tc_credits_per_period[i];
 	}
 
 #ifdef RTE_SCHED_SUBPORT_TC_OV
 	{
-		/* Subport TC3 oversubscription */
-		double subport_tc3_rate = ((double) s->tc_credits_per_period[3]) / ((double) s->tc_period);
-		double pipe_tc3_rate = ((double) params->tc_credits_per_period[3]) / ((double) params->tc_period);
-		uint32_t tc3_ov = s->tc_ov;
+		/* Subport lowest priority TC oversubscription */
+		uint32_t tc_ov_index = port->tc_ov_index;
+		double subport_tc_ov_rate = ((double) s->tc_credits_per_period[tc_ov_index]) / ((double) s->tc_period);
+		double pipe_tc_ov_rate = ((double) params->tc_credits_per_period[tc_ov_index]) / ((double) params->tc_period);
+		uint32_t tc_ov = s->tc_ov;
 
 		s->tc_ov_n += params->tc_ov_weight;
-		s->tc_ov_rate += pipe_tc3_rate;
-		s->tc_ov = s->tc_ov_rate > subport_tc3_rate;
+		s->tc_ov_rate += pipe_tc_ov_rate;
+		s->tc_ov = s->tc_ov_rate > subport_tc_ov_rate;
 
-		if (s->tc_ov != tc3_ov) {
-			RTE_LOG(INFO, SCHED, "Subport %u TC3 oversubscription is ON (%.4lf < %.4lf)\n",
-				subport_id, subport_tc3_rate, s->tc_ov_rate);
+		if (s->tc_ov != tc_ov) {
+			RTE_LOG(INFO, SCHED, "Subport %u TC%u oversubscription is ON (%.4lf < %.4lf)\n",
+				subport_id, tc_ov_index, subport_tc_ov_rate, s->tc_ov_rate);
 		}
 		p->tc_ov_period_id = s->tc_ov_period_id;
 		p->tc_ov_credits = s->tc_ov_wm;
@@ -958,13 +1097,12 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
 }
 
 static inline uint32_t
-rte_sched_port_qindex(struct rte_sched_port *port, uint32_t subport, uint32_t pipe, uint32_t traffic_class, uint32_t queue)
+rte_sched_port_qindex(struct rte_sched_port *port, uint32_t subport, uint32_t pipe, uint32_t pipe_queue)
 {
 	uint32_t result;
 
 	result = subport * port->n_pipes_per_subport + pipe;
-	result = result * RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE + traffic_class;
-	result = result * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + queue;
+	result = (result << port->n_queues_per_pipe_log2) + pipe_queue;
 
 	return result;
 }
@@ -972,20 +1110,59 @@ rte_sched_port_qindex(struct rte_sched_port *port, uint32_t subport, uint32_t pi
 static inline struct rte_mbuf **
 rte_sched_port_qbase(struct rte_sched_port *port, uint32_t qindex)
 {
-	uint32_t pindex = qindex >> 4;
-	uint32_t qpos = qindex & 0xF;
+	uint32_t pindex = qindex >> port->n_queues_per_pipe_log2;
+	uint32_t qpos = qindex & (port->n_queues_per_pipe - 1);
 
 	return (port->queue_array + pindex * port->qsize_sum + port->qsize_add[qpos]);
 }
 
+static inline uint32_t
+rte_sched_port_tc(struct rte_sched_port *port, uint32_t qindex)
+{
+	return (qindex & (port->n_queues_per_pipe - 1)) >> port->n_queues_per_tc_log2;
+}
+
 static inline uint16_t
 rte_sched_port_qsize(struct rte_sched_port *port, uint32_t qindex)
 {
-	uint32_t tc = (qindex >> 2) & 0x3;
+	uint32_t tc = rte_sched_port_tc(port, qindex);
 
 	return port->qsize[tc];
 }
 
+static inline uint32_t
+rte_sched_port_pkt_qindex(struct rte_sched_port *port, struct rte_mbuf *pkt)
+{
+	struct rte_sched_port_hierarchy *sched = (struct rte_sched_port_hierarchy *) &pkt->hash.sched;
+
+	return rte_sched_port_qindex(port, sched->subport, sched->pipe, sched->queue);
+}
+
+void
+rte_sched_port_pkt_write_path(struct rte_sched_port *port, struct rte_mbuf *pkt,
+	uint32_t subport, uint32_t pipe, uint32_t traffic_class, uint32_t queue,
+	enum rte_meter_color color)
+{
+	struct rte_sched_port_hierarchy *sched = (struct rte_sched_port_hierarchy *) &pkt->hash.sched;
+
+	sched->color = (uint32_t) color;
+	sched->subport = subport;
+	sched->pipe = pipe;
+	sched->queue = (traffic_class << port->n_queues_per_tc_log2) + queue;
+}
+
+void
+rte_sched_port_pkt_read_path(struct rte_sched_port *port, struct rte_mbuf *pkt,
+	uint32_t *subport, uint32_t *pipe, uint32_t *traffic_class, uint32_t *queue)
+{
+	struct rte_sched_port_hierarchy *sched = (struct rte_sched_port_hierarchy *) &pkt->hash.sched;
+
+	*subport = sched->subport;
+	*pipe = sched->pipe;
+	*traffic_class = sched->queue >> port->n_queues_per_tc_log2;
+	*queue = sched->queue & (port->n_queues_per_tc - 1);
+}
+
 #if RTE_SCHED_DEBUG
 
 static inline int
@@ -1014,7 +1191,7 @@ static inline void
 rte_sched_port_update_subport_stats(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf *pkt)
 {
 	struct rte_sched_subport *s = port->subport + (qindex / rte_sched_port_queues_per_subport(port));
-	uint32_t tc_index = (qindex >> 2) & 0x3;
+	uint32_t tc_index = rte_sched_port_tc(port, qindex);
 	uint32_t pkt_len = pkt->pkt_len;
 
 	s->stats.n_pkts_tc[tc_index] += 1;
@@ -1025,7 +1202,7 @@ static inline void
 rte_sched_port_update_subport_stats_on_drop(struct rte_sched_port *port, uint32_t qindex, struct rte_mbuf *pkt)
 {
 	struct rte_sched_subport *s = port->subport + (qindex / rte_sched_port_queues_per_subport(port));
-	uint32_t tc_index = (qindex >> 2) & 0x3;
+	uint32_t tc_index = rte_sched_port_tc(port, qindex);
 	uint32_t pkt_len = pkt->pkt_len;
 
 	s->stats.n_pkts_tc_dropped[tc_index] += 1;
@@ -1065,7 +1242,7 @@ rte_sched_port_red_drop(struct rte_sched_port *port, struct rte_mbuf *pkt, uint3
 	uint32_t tc_index;
 	enum rte_meter_color color;
 
-	tc_index = (qindex >> 2) & 0x3;
+	tc_index = rte_sched_port_tc(port, qindex);
 	color = rte_sched_port_pkt_read_color(pkt);
 	red_cfg = &port->red_config[tc_index][color];
 
@@ -1102,9 +1279,9 @@ debug_pipe_is_empty(struct rte_sched_port *port, uint32_t pindex)
 {
 	uint32_t qindex, i;
 
-	qindex = pindex << 4;
+	qindex = pindex << port->n_queues_per_pipe_log2;
 
-	for (i = 0; i < 16; i ++){
+	for (i = 0; i < port->n_queues_per_pipe; i ++){
 		uint32_t queue_empty = rte_sched_port_queue_is_empty(port, qindex + i);
 		uint32_t bmp_bit_clear = (rte_bitmap_get(port->bmp, qindex + i) == 0);
 
@@ -1155,11 +1332,9 @@ rte_sched_port_enqueue_qptrs_prefetch0(struct rte_sched_port *port, struct rte_m
 #ifdef RTE_SCHED_COLLECT_STATS
 	struct rte_sched_queue_extra *qe;
 #endif
-	uint32_t subport, pipe, traffic_class, queue, qindex;
-
-	rte_sched_port_pkt_read_tree_path(pkt, &subport, &pipe, &traffic_class, &queue);
+	uint32_t qindex;
 
-	qindex = rte_sched_port_qindex(port, subport, pipe, traffic_class, queue);
+	qindex = rte_sched_port_pkt_qindex(port, pkt);
 	q = port->queue + qindex;
 	rte_prefetch0(q);
 #ifdef RTE_SCHED_COLLECT_STATS
@@ -1234,13 +1409,11 @@ rte_sched_port_enqueue(struct rte_sched_port *port, struct rte_mbuf **pkts, uint
 	for (i = 0; i < n_pkts; i ++) {
 		struct rte_mbuf *pkt;
 		struct rte_mbuf **q_base;
-		uint32_t subport, pipe, traffic_class, queue, qindex;
+		uint32_t qindex;
 
 		pkt = pkts[i];
 
-		rte_sched_port_pkt_read_tree_path(pkt, &subport, &pipe, &traffic_class, &queue);
-
-		qindex = rte_sched_port_qindex(port, subport, pipe, traffic_class, queue);
+		qindex = rte_sched_port_pkt_qindex(port, pkt);
 
 		q_base = rte_sched_port_qbase(port, qindex);
 
@@ -1428,6 +1601,7 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_sched_pipe_profile *params = grinder->pipe_params;
 	uint64_t n_periods;
+	uint32_t i;
 
 	/* Subport TB */
 	n_periods = (port->time - subport->tb_time) / subport->tb_period;
@@ -1443,19 +1617,17 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 
 	/* Subport TCs */
 	if (unlikely(port->time >= subport->tc_time)) {
-		subport->tc_credits[0] = subport->tc_credits_per_period[0];
-		subport->tc_credits[1] = subport->tc_credits_per_period[1];
-		subport->tc_credits[2] = subport->tc_credits_per_period[2];
-		subport->tc_credits[3] = subport->tc_credits_per_period[3];
+		for (i = 0; i < port->n_traffic_classes; i ++) {
+			subport->tc_credits[i] = subport->tc_credits_per_period[i];
+		}
 		subport->tc_time = port->time + subport->tc_period;
 	}
 
 	/* Pipe TCs */
 	if (unlikely(port->time >= pipe->tc_time)) {
-		pipe->tc_credits[0] = params->tc_credits_per_period[0];
-		pipe->tc_credits[1] = params->tc_credits_per_period[1];
-		pipe->tc_credits[2] = params->tc_credits_per_period[2];
-		pipe->tc_credits[3] = params->tc_credits_per_period[3];
+		for (i = 0; i < port->n_traffic_classes; i ++) {
+			pipe->tc_credits[i] = params->tc_credits_per_period[i];
+		}
 		pipe->tc_time = port->time + params->tc_period;
 	}
 }
@@ -1467,23 +1639,26 @@ grinder_tc_ov_credits_update(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_subport *subport = grinder->subport;
-	uint32_t tc_ov_consumption[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE];
+	uint32_t tc_ov_index = port->tc_ov_index;
+	uint32_t tc_ov_consumption, tc_hp_consumption;
 	uint32_t tc_ov_consumption_max;
 	uint32_t tc_ov_wm = subport->tc_ov_wm;
+	uint32_t i;
 
 	if (subport->tc_ov == 0) {
 		return subport->tc_ov_wm_max;
 	}
 
-	tc_ov_consumption[0] = subport->tc_credits_per_period[0] - subport->tc_credits[0];
-	tc_ov_consumption[1] = subport->tc_credits_per_period[1] - subport->tc_credits[1];
-	tc_ov_consumption[2] = subport->tc_credits_per_period[2] - subport->tc_credits[2];
-	tc_ov_consumption[3] = subport->tc_credits_per_period[3] - subport->tc_credits[3];
+	/* Credits consumed by the higher priority TCs */
+	tc_hp_consumption = 0;
+	for (i = 0; i < tc_ov_index; i ++) {
+		tc_hp_consumption += subport->tc_credits_per_period[i] - subport->tc_credits[i];
+	}
 
-	tc_ov_consumption_max = subport->tc_credits_per_period[3] -
-		(tc_ov_consumption[0] + tc_ov_consumption[1] + tc_ov_consumption[2]);
+	tc_ov_consumption = subport->tc_credits_per_period[tc_ov_index] - subport->tc_credits[tc_ov_index];
+	tc_ov_consumption_max = subport->tc_credits_per_period[tc_ov_index] - tc_hp_consumption;
 
-	if (tc_ov_consumption[3] > (tc_ov_consumption_max - port->mtu)) {
+	if (tc_ov_consumption > (tc_ov_consumption_max - port->mtu)) {
 		tc_ov_wm  -= tc_ov_wm >> 7;
 		if (tc_ov_wm < subport->tc_ov_wm_min) {
 			tc_ov_wm = subport->tc_ov_wm_min;
@@ -1506,6 +1681,7 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	struct rte_sched_pipe_profile *params = grinder->pipe_params;
 	uint64_t n_periods;
+	uint32_t i;
 
 	/* Subport TB */
 	n_periods = (port->time - subport->tb_time) / subport->tb_period;
@@ -1523,10 +1699,9 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 	if (unlikely(port->time >= subport->tc_time)) {
 		subport->tc_ov_wm = grinder_tc_ov_credits_update(port, pos);
 
-		subport->tc_credits[0] = subport->tc_credits_per_period[0];
-		subport->tc_credits[1] = subport->tc_credits_per_period[1];
-		subport->tc_credits[2] = subport->tc_credits_per_period[2];
-		subport->tc_credits[3] = subport->tc_credits_per_period[3];
+		for (i = 0; i < port->n_traffic_classes; i ++) {
+			subport->tc_credits[i] = subport->tc_credits_per_period[i];
+		}
 
 		subport->tc_time = port->time + subport->tc_period;
 		subport->tc_ov_period_id ++;
@@ -1534,10 +1709,9 @@ grinder_credits_update(struct rte_sched_port *port, uint32_t pos)
 
 	/* Pipe TCs */
 	if (unlikely(port->time >= pipe->tc_time)) {
-		pipe->tc_credits[0] = params->tc_credits_per_period[0];
-		pipe->tc_credits[1] = params->tc_credits_per_period[1];
-		pipe->tc_credits[2] = params->tc_credits_per_period[2];
-		pipe->tc_credits[3] = params->tc_credits_per_period[3];
+		for (i = 0; i < port->n_traffic_classes; i ++) {
+			pipe->tc_credits[i] = params->tc_credits_per_period[i];
+		}
 		pipe->tc_time = port->time + params->tc_period;
 	}
 
@@ -1604,9 +1778,8 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 	uint32_t subport_tc_credits = subport->tc_credits[tc_index];
 	uint32_t pipe_tb_credits = pipe->tb_credits;
 	uint32_t pipe_tc_credits = pipe->tc_credits[tc_index];
-	uint32_t pipe_tc_ov_mask1[] = {UINT32_MAX, UINT32_MAX, UINT32_MAX, pipe->tc_ov_credits};
-	uint32_t pipe_tc_ov_mask2[] = {0, 0, 0, UINT32_MAX};
-	uint32_t pipe_tc_ov_credits = pipe_tc_ov_mask1[tc_index];
+	uint32_t pipe_tc_ov_mask = (tc_index == port->tc_ov_index) ? UINT32_MAX : 0;
+	uint32_t pipe_tc_ov_credits = pipe->tc_ov_credits | ~pipe_tc_ov_mask;
 	int enough_credits;
 
 	/* Check pipe and subport credits */
@@ -1625,7 +1798,7 @@ grinder_credits_check(struct rte_sched_port *port, uint32_t pos)
 	subport->tc_credits[tc_index] -= pkt_len;
 	pipe->tb_credits -= pkt_len;
 	pipe->tc_credits[tc_index] -= pkt_len;
-	pipe->tc_ov_credits -= pipe_tc_ov_mask2[tc_index] & pkt_len;
+	pipe->tc_ov_credits -= pipe_tc_ov_mask & pkt_len;
 
 	return 1;
 }
@@ -1650,6 +1823,9 @@ grinder_schedule(struct rte_sched_port *port, uint32_t pos)
 
 	/* Advance port time */
 	port->time += pkt_len;
+	if (port->arbiter != NULL) {
+		port->arbiter_credits -= pkt_len;
+	}
 
 	/* Send packet */
 	port->pkts_out[port->n_pkts_out ++] = pkt;
@@ -1711,62 +1887,48 @@ static inline void
 grinder_pcache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t bmp_pos, uint64_t bmp_slab)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint16_t w[4];
+	uint32_t qpp_log2 = port->n_queues_per_pipe_log2;
+	uint64_t pipe_mask = (1LLU << port->n_queues_per_pipe) - 1;
+	uint32_t bit;
 
 	grinder->pcache_w = 0;
 	grinder->pcache_r = 0;
 
-	w[0] = (uint16_t) bmp_slab;
-	w[1] = (uint16_t) (bmp_slab >> 16);
-	w[2] = (uint16_t) (bmp_slab >> 32);
-	w[3] = (uint16_t) (bmp_slab >> 48);
+	/* One entry per non-empty pipe of the slab, so the number of iterations
+	 * depends on the active pipes rather than on the pipe shape */
+	while (rte_bsf64(bmp_slab, &bit)) {
+		uint32_t offset = (bit >> qpp_log2) << qpp_log2;
 
-	grinder->pcache_qmask[grinder->pcache_w] = w[0];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos;
-	grinder->pcache_w += (w[0] != 0);
+		grinder->pcache_qmask[grinder->pcache_w] = (uint16_t) ((bmp_slab >> offset) & pipe_mask);
+		grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + offset;
+		grinder->pcache_w ++;
 
-	grinder->pcache_qmask[grinder->pcache_w] = w[1];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 16;
-	grinder->pcache_w += (w[1] != 0);
-
-	grinder->pcache_qmask[grinder->pcache_w] = w[2];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 32;
-	grinder->pcache_w += (w[2] != 0);
-
-	grinder->pcache_qmask[grinder->pcache_w] = w[3];
-	grinder->pcache_qindex[grinder->pcache_w] = bmp_pos + 48;
-	grinder->pcache_w += (w[3] != 0);
+		bmp_slab &= ~(pipe_mask << offset);
+	}
 }
 
 static inline void
 grinder_tccache_populate(struct rte_sched_port *port, uint32_t pos, uint32_t qindex, uint16_t qmask)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint8_t b[4];
+	uint32_t qptc_log2 = port->n_queues_per_tc_log2;
+	uint32_t tc_mask = (1 << port->n_queues_per_tc) - 1;
+	uint64_t slab = qmask;
+	uint32_t bit;
 
 	grinder->tccache_w = 0;
 	grinder->tccache_r = 0;
 
-	b[0] = (uint8_t) (qmask & 0xF);
-	b[1] = (uint8_t) ((qmask >> 4) & 0xF);
-	b[2] = (uint8_t) ((qmask >> 8) & 0xF);
-	b[3] = (uint8_t) ((qmask >> 12) & 0xF);
-
-	grinder->tccache_qmask[grinder->tccache_w] = b[0];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex;
-	grinder->tccache_w += (b[0] != 0);
-
-	grinder->tccache_qmask[grinder->tccache_w] = b[1];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 4;
-	grinder->tccache_w += (b[1] != 0);
+	/* Non-empty TCs of the pipe, in strict priority order */
+	while (rte_bsf64(slab, &bit)) {
+		uint32_t offset = (bit >> qptc_log2) << qptc_log2;
 
-	grinder->tccache_qmask[grinder->tccache_w] = b[2];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 8;
-	grinder->tccache_w += (b[2] != 0);
+		grinder->tccache_qmask[grinder->tccache_w] = (uint8_t) ((slab >> offset) & tc_mask);
+		grinder->tccache_qindex[grinder->tccache_w] = qindex + offset;
+		grinder->tccache_w ++;
 
-	grinder->tccache_qmask[grinder->tccache_w] = b[3];
-	grinder->tccache_qindex[grinder->tccache_w] = qindex + 12;
-	grinder->tccache_w += (b[3] != 0);
+		slab &= ~(((uint64_t) tc_mask) << offset);
+	}
 }
 
 static inline int
@@ -1774,7 +1936,7 @@ grinder_next_tc(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_mbuf **qbase;
-	uint32_t qindex;
+	uint32_t qindex, i;
 	uint16_t qsize;
 
 	if (grinder->tccache_r == grinder->tccache_w) {
@@ -1785,24 +1947,15 @@ grinder_next_tc(struct rte_sched_port *port, uint32_t pos)
 	qbase = rte_sched_port_qbase(port, qindex);
 	qsize = rte_sched_port_qsize(port, qindex);
 
-	grinder->tc_index = (qindex >> 2) & 0x3;
+	grinder->tc_index = rte_sched_port_tc(port, qindex);
 	grinder->qmask = grinder->tccache_qmask[grinder->tccache_r];
 	grinder->qsize = qsize;
 
-	grinder->qindex[0] = qindex;
-	grinder->qindex[1] = qindex + 1;
-	grinder->qindex[2] = qindex + 2;
-	grinder->qindex[3] = qindex + 3;
-
-	grinder->queue[0] = port->queue + qindex;
-	grinder->queue[1] = port->queue + qindex + 1;
-	grinder->queue[2] = port->queue + qindex + 2;
-	grinder->queue[3] = port->queue + qindex + 3;
-
-	grinder->qbase[0] = qbase;
-	grinder->qbase[1] = qbase + qsize;
-	grinder->qbase[2] = qbase + 2 * qsize;
-	grinder->qbase[3] = qbase + 3 * qsize;
+	for (i = 0; i < port->n_queues_per_tc; i ++) {
+		grinder->qindex[i] = qindex + i;
+		grinder->queue[i] = port->queue + qindex + i;
+		grinder->qbase[i] = qbase + i * qsize;
+	}
 
 	grinder->tccache_r ++;
 	return 1;
@@ -1848,7 +2001,7 @@ grinder_next_pipe(struct rte_sched_port *port, uint32_t pos)
 	}
 
 	/* Install new pipe in the grinder */
-	grinder->pindex = pipe_qindex >> 4;
+	grinder->pindex = pipe_qindex >> port->n_queues_per_pipe_log2;
 	grinder->subport = port->subport + (grinder->pindex / port->n_pipes_per_subport);
 	grinder->pipe = port->pipe + grinder->pindex;
 	grinder->pipe_params = NULL; /* to be set after the pipe structure is prefetched */
@@ -1893,24 +2046,20 @@ grinder_wrr_load(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_pipe_profile *pipe_params = grinder->pipe_params;
 	uint32_t tc_index = grinder->tc_index;
 	uint32_t qmask = grinder->qmask;
-	uint32_t qindex;
-
-	qindex = tc_index * 4;
+	uint32_t qindex, i;
 
-	grinder->wrr_tokens[0] = ((uint16_t) pipe->wrr_tokens[qindex]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[1] = ((uint16_t) pipe->wrr_tokens[qindex + 1]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[2] = ((uint16_t) pipe->wrr_tokens[qindex + 2]) << RTE_SCHED_WRR_SHIFT;
-	grinder->wrr_tokens[3] = ((uint16_t) pipe->wrr_tokens[qindex + 3]) << RTE_SCHED_WRR_SHIFT;
+	qindex = tc_index << port->n_queues_per_tc_log2;
 
-	grinder->wrr_mask[0] = (qmask & 0x1) * 0xFFFF;
-	grinder->wrr_mask[1] = ((qmask >> 1) & 0x1) * 0xFFFF;
-	grinder->wrr_mask[2] = ((qmask >> 2) & 0x1) * 0xFFFF;
-	grinder->wrr_mask[3] = ((qmask >> 3) & 0x1) * 0xFFFF;
+	/* Queues beyond the configured number per TC are masked out */
+	for (i = 0; i < RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX; i ++) {
+		grinder->wrr_tokens[i] = 0;
+		grinder->wrr_mask[i] = ((qmask >> i) & 0x1) * 0xFFFF;
+	}
 
-	grinder->wrr_cost[0] = pipe_params->wrr_cost[qindex];
-	grinder->wrr_cost[1] = pipe_params->wrr_cost[qindex + 1];
-	grinder->wrr_cost[2] = pipe_params->wrr_cost[qindex + 2];
-	grinder->wrr_cost[3] = pipe_params->wrr_cost[qindex + 3];
+	for (i = 0; i < port->n_queues_per_tc; i ++) {
+		grinder->wrr_tokens[i] = ((uint16_t) pipe->wrr_tokens[qindex + i]) << RTE_SCHED_WRR_SHIFT;
+		grinder->wrr_cost[i] = pipe_params->wrr_cost[qindex + i];
+	}
 }
 
 static inline void
@@ -1919,14 +2068,13 @@ grinder_wrr_store(struct rte_sched_port *port, uint32_t pos)
 	struct rte_sched_grinder *grinder = port->grinder + pos;
 	struct rte_sched_pipe *pipe = grinder->pipe;
 	uint32_t tc_index = grinder->tc_index;
-	uint32_t qindex;
+	uint32_t qindex, i;
 
-	qindex = tc_index * 4;
+	qindex = tc_index << port->n_queues_per_tc_log2;
 
-	pipe->wrr_tokens[qindex] = (uint8_t) ((grinder->wrr_tokens[0] & grinder->wrr_mask[0]) >> RTE_SCHED_WRR_SHIFT);
-	pipe->wrr_tokens[qindex + 1] = (uint8_t) ((grinder->wrr_tokens[1] & grinder->wrr_mask[1]) >> RTE_SCHED_WRR_SHIFT);
-	pipe->wrr_tokens[qindex + 2] = (uint8_t) ((grinder->wrr_tokens[2] & grinder->wrr_mask[2]) >> RTE_SCHED_WRR_SHIFT);
-	pipe->wrr_tokens[qindex + 3] = (uint8_t) ((grinder->wrr_tokens[3] & grinder->wrr_mask[3]) >> RTE_SCHED_WRR_SHIFT);
+	for (i = 0; i < port->n_queues_per_tc; i ++) {
+		pipe->wrr_tokens[qindex + i] = (uint8_t) ((grinder->wrr_tokens[i] & grinder->wrr_mask[i]) >> RTE_SCHED_WRR_SHIFT);
+	}
 }
 
 static inline void
@@ -1970,22 +2118,17 @@ static inline void
 grinder_prefetch_tc_queue_arrays(struct rte_sched_port *port, uint32_t pos)
 {
 	struct rte_sched_grinder *grinder = port->grinder + pos;
-	uint16_t qsize, qr[4];
+	uint16_t qsize = grinder->qsize;
+	uint32_t i;
 
-	qsize = grinder->qsize;
-	qr[0] = grinder->queue[0]->qr & (qsize - 1);
-	qr[1] = grinder->queue[1]->qr & (qsize - 1);
-	qr[2] = grinder->queue[2]->qr & (qsize - 1);
-	qr[3] = grinder->queue[3]->qr & (qsize - 1);
+	for (i = 0; i < port->n_queues_per_tc; i ++) {
+		uint16_t qr = grinder->queue[i]->qr & (qsize - 1);
 
-	rte_prefetch0(grinder->qbase[0] + qr[0]);
-	rte_prefetch0(grinder->qbase[1] + qr[1]);
+		rte_prefetch0(grinder->qbase[i] + qr);
+	}
 
 	grinder_wrr_load(port, pos);
 	grinder_wrr(port, pos);
-
-	rte_prefetch0(grinder->qbase[2] + qr[2]);
-	rte_prefetch0(grinder->qbase[3] + qr[3]);
 }
 
 static inline void
@@ -2007,6 +2150,58 @@ grinder_prefetch_mbuf(struct rte_sched_port *port, uint32_t pos)
 	}
 }
 
+/* The arbiter implements a token bucket shared by all the shards as a virtual
+ * clock: credits up to the current port time are available, taking n credits
+ * advances the arbiter time by n, and an idle period is accounted for by never
+ * letting the arbiter time lag more than the bucket size behind the port time.
+ * Taking credits is a single compare-and-set, whatever the number of shards. */
+static uint32_t
+rte_sched_arbiter_take(struct rte_sched_arbiter *arbiter, uint32_t n_credits)
+{
+	uint64_t cycles = rte_get_tsc_cycles() - arbiter->time_cpu_cycles;
+	uint64_t now = (uint64_t) (((double) cycles) / arbiter->cycles_per_byte);
+	uint64_t floor = (now > arbiter->tb_size) ? now - arbiter->tb_size : 0;
+
+	for ( ; ; ) {
+		uint64_t time = arbiter->time;
+		uint64_t base = RTE_MAX(time, floor);
+		uint64_t credits;
+
+		if (base >= now) {
+			return 0;
+		}
+
+		credits = RTE_MIN(now - base, (uint64_t) n_credits);
+		if (rte_atomic64_cmpset(&arbiter->time, time, base + credits)) {
+			return (uint32_t) credits;
+		}
+	}
+}
+
+static inline int
+rte_sched_port_arbiter_credits_check(struct rte_sched_port *port, uint32_t pos)
+{
+	struct rte_sched_grinder *grinder = port->grinder + pos;
+	uint32_t pkt_len = grinder->pkt->pkt_len + port->frame_overhead;
+
+	if (likely(pkt_len <= port->arbiter_credits)) {
+		return 1;
+	}
+
+	/* Top up the local credits to one quantum */
+	if (port->arbiter_credits < port->arbiter->quantum) {
+		port->arbiter_credits += rte_sched_arbiter_take(port->arbiter,
+			port->arbiter->quantum - port->arbiter_credits);
+	}
+
+	if (pkt_len <= port->arbiter_credits) {
+		return 1;
+	}
+
+	port->arbiter_exhaustion = 1;
+	return 0;
+}
+
 static inline uint32_t
 grinder_handle(struct rte_sched_port *port, uint32_t pos)
 {
@@ -2050,6 +2245,12 @@ grinder_handle(struct rte_sched_port *port, uint32_t pos)
 	{
 		uint32_t result = 0;
 
+		/* No port credits: keep the packet in the grinder until the next dequeue */
+		if ((port->arbiter != NULL) &&
+		    (!rte_sched_port_arbiter_credits_check(port, pos))) {
+			return 0;
+		}
+
 		result = grinder_schedule(port, pos);
 
 		/* Look for next packet within the same TC */
@@ -2119,10 +2320,12 @@ rte_sched_port_exceptions(struct rte_sched_port *port, int second_pass)
 
 	/* Check if any exception flag is set */
 	exceptions = (second_pass && port->busy_grinders == 0) ||
-		(port->pipe_exhaustion == 1);
+		(port->pipe_exhaustion == 1) ||
+		(port->arbiter_exhaustion == 1);
 
 	/* Clear exception flags */
 	port->pipe_exhaustion = 0;
+	port->arbiter_exhaustion = 0;
 
 	return exceptions;
 }
@@ -85,13 +85,25 @@ extern "C" {
 #include "rte_red.h"
 #endif
 
-/** Number of traffic classes per pipe (as well as subport). Cannot be changed. */
+/** Maximum number of traffic classes per pipe (as well as subport). */
+#define RTE_SCHED_TRAFFIC_CLASSES_MAX         16
+
+/** Maximum number of queues per pipe traffic class. */
+#define RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX 4
+
+/** Maximum number of queues per pipe. The product of the number of traffic
+classes per pipe and the number of queues per traffic class cannot exceed this. */
+#define RTE_SCHED_QUEUES_PER_PIPE_MAX         16
+
+/** Default number of traffic classes per pipe (as well as subport), used when
+the port parameter n_traffic_classes is left as zero. */
 #define RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE    4
 
-/** Number of queues per pipe traffic class. Cannot be changed. */
+/** Default number of queues per pipe traffic class, used when the port
+parameter n_queues_per_traffic_class is left as zero. */
 #define RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS    4
 
-/** Number of queues per pipe. */
+/** Default number of queues per pipe. */
 #define RTE_SCHED_QUEUES_PER_PIPE             \
 	(RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE *     \
 	RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS)
@@ -123,22 +135,22 @@ struct rte_sched_subport_params {
 	uint32_t tb_size;                /**< Subport token bucket size (measured in credits) */
 
 	/* Subport traffic classes */
-	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Subport traffic class rates (measured in bytes per second) */
+	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_MAX]; /**< Subport traffic class rates (measured in bytes per second) */
 	uint32_t tc_period;              /**< Enforcement period for traffic class rates (measured in milliseconds) */
 };
 
 /** Subport statistics */
 struct rte_sched_subport_stats {
 	/* Packets */
-	uint32_t n_pkts_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Number of packets successfully written to current
+	uint32_t n_pkts_tc[RTE_SCHED_TRAFFIC_CLASSES_MAX]; /**< Number of packets successfully written to current
 	                                      subport for each traffic class */
-	uint32_t n_pkts_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Number of packets dropped by the current
+	uint32_t n_pkts_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_MAX]; /**< Number of packets dropped by the current
 	                                      subport for each traffic class due to subport queues being full or congested*/
 
 	/* Bytes */
-	uint32_t n_bytes_tc[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Number of bytes successfully written to current
+	uint32_t n_bytes_tc[RTE_SCHED_TRAFFIC_CLASSES_MAX]; /**< Number of bytes successfully written to current
 	                                      subport for each traffic class*/
-	uint32_t n_bytes_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Number of bytes dropped by the current
+	uint32_t n_bytes_tc_dropped[RTE_SCHED_TRAFFIC_CLASSES_MAX]; /**< Number of bytes dropped by the current
                                           subport for each traffic class due to subport queues being full or congested */
 };
 
@@ -153,14 +165,14 @@ struct rte_sched_pipe_params {
 	uint32_t tb_size;                /**< Pipe token bucket size (measured in credits) */
 
 	/* Pipe traffic classes */
-	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Pipe traffic class rates (measured in bytes per second) */
+	uint32_t tc_rate[RTE_SCHED_TRAFFIC_CLASSES_MAX]; /**< Pipe traffic class rates (measured in bytes per second) */
 	uint32_t tc_period;              /**< Enforcement period for pipe traffic class rates (measured in milliseconds) */
 #ifdef RTE_SCHED_SUBPORT_TC_OV
-	uint8_t tc_ov_weight;            /**< Weight for the current pipe in the event of subport traffic class 3 oversubscription */
+	uint8_t tc_ov_weight;            /**< Weight for the current pipe in the event of subport oversubscription of the lowest priority traffic class */
 #endif
 
 	/* Pipe queues */
-	uint8_t  wrr_weights[RTE_SCHED_QUEUES_PER_PIPE]; /**< WRR weights for the queues of the current pipe */
+	uint8_t  wrr_weights[RTE_SCHED_QUEUES_PER_PIPE_MAX]; /**< WRR weights for the queues of the current pipe */
 };
 
 /** Queue statistics */
@@ -183,7 +195,7 @@ struct rte_sched_port_params {
 	uint32_t frame_overhead;         /**< Framing overhead per packet (measured in bytes) */
 	uint32_t n_subports_per_port;    /**< Number of subports for the current port scheduler instance*/
 	uint32_t n_pipes_per_subport;    /**< Number of pipes for each port scheduler subport */
-	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE]; /**< Packet queue size for each traffic class. All queues
+	uint16_t qsize[RTE_SCHED_TRAFFIC_CLASSES_MAX]; /**< Packet queue size for each traffic class. All queues
 	                                      within the same pipe traffic class have the same size. Queues from
 										  different pipes serving the same traffic class have the same size. */
 	struct rte_sched_pipe_params *pipe_profiles; /**< Pipe profile table defined for current port scheduler instance.
@@ -191,8 +203,30 @@ struct rte_sched_port_params {
 										  profiles from this table. */
 	uint32_t n_pipe_profiles;        /**< Number of profiles in the pipe profile table */
 #ifdef RTE_SCHED_RED
-	struct rte_red_params red_params[RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE][e_RTE_METER_COLORS]; /**< RED parameters */
+	struct rte_red_params red_params[RTE_SCHED_TRAFFIC_CLASSES_MAX][e_RTE_METER_COLORS]; /**< RED parameters */
 #endif
+
+	/* Pipe shape */
+	uint32_t n_traffic_classes;      /**< Number of strict priority traffic classes per pipe (power of 2, up to
+	                                      RTE_SCHED_TRAFFIC_CLASSES_MAX). Zero selects RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE. */
+	uint32_t n_queues_per_traffic_class; /**< Number of WRR queues per traffic class (power of 2, up to
+	                                      RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS_MAX). Zero selects
+	                                      RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS. */
+};
+
+/** Port arbiter configuration parameters. A port arbiter enforces the rate of one
+output port across several port scheduler instances (shards), each one handling a
+subset of the subports of that output port and being run by a different CPU core.
+All the shards share the port rate through credits handed out by the arbiter. */
+struct rte_sched_arbiter_params {
+	const char *name;                /**< Literal string to be associated to the current arbiter instance */
+	int socket;                      /**< CPU socket ID where the memory for the arbiter should be allocated */
+	uint32_t rate;                   /**< Output port rate (measured in bytes per second) */
+	uint32_t tb_size;                /**< Maximum number of credits (bytes) accumulated while the shards are
+	                                      idle, i.e. maximum burst size at port level */
+	uint32_t quantum;                /**< Number of credits (bytes) a shard takes from the arbiter at once.
+	                                      Should be a few MTUs: bigger values reduce the contention on the
+	                                      arbiter, smaller ones reduce the credits held by idle shards. */
 };
 
 /** Path through the scheduler hierarchy used by the scheduler enqueue operation to
@@ -200,8 +234,8 @@ identify the destination queue for the current packet. Stored in the field hash.
 of struct rte_mbuf of each packet, typically written by the classification stage and read by
 scheduler enqueue.*/
 struct rte_sched_port_hierarchy {
-	uint32_t queue:2;                /**< Queue ID (0 .. 3) */
-	uint32_t traffic_class:2;        /**< Traffic class ID (0 .. 3)*/
+	uint32_t queue:4;                /**< Queue ID within pipe, i.e. traffic class ID multiplied by the number
+	                                      of queues per traffic class plus queue ID within traffic class (0 .. 15) */
 	uint32_t pipe:20;                /**< Pipe ID */
 	uint32_t subport:6;              /**< Subport ID */
 	uint32_t color:2;                /**< Color */
@@ -280,6 +314,47 @@ rte_sched_pipe_config(struct rte_sched_port *port,
 uint32_t
 rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params);
 
+/**
+ * Port arbiter create
+ *
+ * @param params
+ *   Port arbiter configuration parameter structure
+ * @return
+ *   Handle to port arbiter instance upon success or NULL otherwise.
+ */
+struct rte_sched_arbiter *
+rte_sched_arbiter_create(struct rte_sched_arbiter_params *params);
+
+/**
+ * Port arbiter free. All the port scheduler instances attached to it have to be
+ * detached or freed first.
+ *
+ * @param arbiter
+ *   Handle to port arbiter instance
+ */
+void
+rte_sched_arbiter_free(struct rte_sched_arbiter *arbiter);
+
+/**
+ * Attach a port scheduler instance to a port arbiter, making it one of the shards
+ * of the output port: packets are only dequeued from the port scheduler instance
+ * when the arbiter has credits available, so that the aggregate rate of all the
+ * shards does not exceed the rate of the output port. The port scheduler instance
+ * has to be configured with the same rate as the arbiter. Each shard is run by a
+ * single CPU core, different shards can be run by different CPU cores.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param arbiter
+ *   Handle to port arbiter instance, NULL to detach the port scheduler instance
+ *   from its current arbiter
+ * @return
+ *   0 upon success, error code otherwise
+ */
+int
+rte_sched_port_arbiter_attach(struct rte_sched_port *port,
+	struct rte_sched_arbiter *arbiter);
+
 /*
  * Statistics
  *
@@ -296,8 +371,8 @@ rte_sched_port_get_memory_footprint(struct rte_sched_port_params *params);
  *   Pointer to pre-allocated subport statistics structure where the statistics
  *   counters should be stored
  * @param tc_ov
- *   Pointer to pre-allocated 4-entry array where the oversubscription status for
- *   each of the 4 subport traffic classes should be stored.
+ *   Pointer to pre-allocated variable where the oversubscription status of the
+ *   lowest priority subport traffic class should be stored.
  * @return
  *   0 upon success, error code otherwise
  */
@@ -335,7 +410,10 @@ rte_sched_queue_read_stats(struct rte_sched_port *port,
 
 /**
  * Scheduler hierarchy path write to packet descriptor. Typically called by the
- * packet classification stage.
+ * packet classification stage. Only valid for ports using the default pipe shape
+ * (RTE_SCHED_TRAFFIC_CLASSES_PER_PIPE traffic classes with
+ * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS queues each), see
+ * rte_sched_port_pkt_write_path() for ports configured with a different shape.
  *
  * @param pkt
  *   Packet descriptor handle
@@ -357,14 +435,15 @@ rte_sched_port_pkt_write(struct rte_mbuf *pkt,
 	sched->color = (uint32_t) color;
 	sched->subport = subport;
 	sched->pipe = pipe;
-	sched->traffic_class = traffic_class;
-	sched->queue = queue;
+	sched->queue = traffic_class * RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS + queue;
 }
 
 /**
  * Scheduler hierarchy path read from packet descriptor (struct rte_mbuf). Typically
  * called as part of the hierarchical scheduler enqueue operation. The subport,
  * pipe, traffic class and queue parameters need to be pre-allocated by the caller.
+ * Only valid for ports using the default pipe shape, see
+ * rte_sched_port_pkt_read_path() for ports configured with a different shape.
  *
  * @param pkt
  *   Packet descriptor handle
@@ -385,10 +464,55 @@ rte_sched_port_pkt_read_tree_path(struct rte_mbuf *pkt, uint32_t *subport, uint3
 
 	*subport = sched->subport;
 	*pipe = sched->pipe;
-	*traffic_class = sched->traffic_class;
-	*queue = sched->queue;
+	*traffic_class = sched->queue / RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
+	*queue = sched->queue % RTE_SCHED_QUEUES_PER_TRAFFIC_CLASS;
 }
 
+/**
+ * Scheduler hierarchy path write to packet descriptor using the pipe shape
+ * (number of traffic classes and queues per traffic class) of the given port.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param pkt
+ *   Packet descriptor handle
+ * @param subport
+ *   Subport ID
+ * @param pipe
+ *   Pipe ID within subport
+ * @param traffic_class
+ *   Traffic class ID within pipe (0 .. number of traffic classes - 1)
+ * @param queue
+ *   Queue ID within pipe traffic class (0 .. number of queues per traffic class - 1)
+ * @param color
+ *   Packet color
+ */
+void
+rte_sched_port_pkt_write_path(struct rte_sched_port *port, struct rte_mbuf *pkt,
+	uint32_t subport, uint32_t pipe, uint32_t traffic_class, uint32_t queue,
+	enum rte_meter_color color);
+
+/**
+ * Scheduler hierarchy path read from packet descriptor using the pipe shape
+ * (number of traffic classes and queues per traffic class) of the given port.
+ *
+ * @param port
+ *   Handle to port scheduler instance
+ * @param pkt
+ *   Packet descriptor handle
+ * @param subport
+ *   Subport ID
+ * @param pipe
+ *   Pipe ID within subport
+ * @param traffic_class
+ *   Traffic class ID within pipe
+ * @param queue
+ *   Queue ID within pipe traffic class
+ */
+void
+rte_sched_port_pkt_read_path(struct rte_sched_port *port, struct rte_mbuf *pkt,
+	uint32_t *subport, uint32_t *pipe, uint32_t *traffic_class, uint32_t *queue);
+
 static inline enum rte_meter_color
 rte_sched_port_pkt_read_color(struct rte_mbuf *pkt)
 {
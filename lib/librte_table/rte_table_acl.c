@@ -322,6 +322,16 @@ rte_table_acl_entry_add(
 	memcpy(rule_location, &acl_rule, acl->acl_params.rule_size);
 	acl->acl_rule_list[free_pos] = rule_location;
 
+	/* Append the rule to the current low level ACL table, if possible */
+	if (acl->ctx != NULL &&
+			rte_acl_add_delta_rules(acl->ctx, rule_location, 1) == 0) {
+		*key_found = 0;
+		*entry_ptr = &acl->memory[free_pos * acl->entry_size];
+		memcpy(*entry_ptr, entry, acl->entry_size);
+
+		return 0;
+	}
+
 	/* Build low level ACL table */
 	acl->name_id ^= 1;
 	acl->acl_params.name = acl->name[acl->name_id];
@@ -32,6 +32,7 @@
  */
 
 #include <string.h>
+#include <errno.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <inttypes.h>
@@ -51,59 +52,246 @@
 #include <rte_branch_prediction.h>
 #include <rte_spinlock.h>
 #include <rte_random.h>
+#include <rte_malloc.h>
+#include <rte_errno.h>
 
 #include "rte_timer.h"
 
 LIST_HEAD(rte_timer_list, rte_timer);
 
+#define TIMER_WHEEL_BITS   6
+#define TIMER_WHEEL_SLOTS  (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_MASK   (TIMER_WHEEL_SLOTS - 1)
+#define TIMER_WHEEL_LEVELS 8
+/* farthest tick that can be stored in the wheel, relative to next_tick */
+#define TIMER_WHEEL_MAX_DELTA \
+	((1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+/*
+ * Hierarchical timing wheel: level n has 64 slots of 64^n ticks each.
+ * A timer is stored in the lowest level that can hold its expiry tick,
+ * and moves down one level (cascade) each time the wheel reaches the
+ * slot it is stored in.
+ */
+struct timer_wheel {
+	uint64_t next_tick; /**< next tick to be processed */
+	uint64_t bitmap[TIMER_WHEEL_LEVELS]; /**< non empty slots per level */
+	struct rte_timer *slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];
+};
+
 struct priv_timer {
 	struct rte_timer pending_head;  /**< dummy timer instance to head up list */
 	rte_spinlock_t list_lock;       /**< lock to protect list access */
 
-	/** per-core variable that true if a timer was updated on this
-	 *  core since last reset of the variable */
-	int updated;
-
 	/** track the current depth of the skiplist */
 	unsigned curr_skiplist_depth;
 
 	unsigned prev_lcore;              /**< used for lcore round robin */
 
+	/** pending timers, when the timer wheel engine is used */
+	struct timer_wheel wheel;
+
 #ifdef RTE_LIBRTE_TIMER_DEBUG
 	/** per-lcore statistics */
 	struct rte_timer_debug_stats stats;
 #endif
 } __rte_cache_aligned;
 
-/** per-lcore private info for timers */
-static struct priv_timer priv_timer[RTE_MAX_LCORE];
+/** an independent set of per-lcore timer lists */
+struct rte_timer_data {
+	TAILQ_ENTRY(rte_timer_data) next; /**< next in list of instances */
+	char name[RTE_TIMER_DATA_NAMESIZE]; /**< name of the instance */
+
+	/** data structure holding the pending timers */
+	enum rte_timer_engine engine;
+	/** duration of a tick of the timer wheel, in timer cycles */
+	uint64_t wheel_res;
+
+	/** per-lcore private info for timers */
+	struct priv_timer priv_timer[RTE_MAX_LCORE];
+} __rte_cache_aligned;
+
+/** instance used by the rte_timer_*() functions */
+static struct rte_timer_data default_timer_data = {
+	.name = "default",
+	.engine = RTE_TIMER_ENGINE_SKIPLIST,
+	.wheel_res = 1,
+};
+
+TAILQ_HEAD(rte_timer_data_list, rte_timer_data);
+
+/** instances created with rte_timer_data_create() */
+static struct rte_timer_data_list timer_data_list =
+	TAILQ_HEAD_INITIALIZER(timer_data_list);
+static rte_spinlock_t timer_data_list_lock = RTE_SPINLOCK_INITIALIZER;
+
+/** per-thread variable that is true if the timer run by this thread was
+ *  updated by its callback since last reset of the variable */
+static RTE_DEFINE_PER_LCORE(int, timer_updated);
 
 /* when debug is enabled, store some statistics */
 #ifdef RTE_LIBRTE_TIMER_DEBUG
-#define __TIMER_STAT_ADD(name, n) do {					\
+#define __TIMER_STAT_ADD(priv_timer, name, n) do {			\
 		unsigned __lcore_id = rte_lcore_id();			\
 		if (__lcore_id < RTE_MAX_LCORE)				\
 			priv_timer[__lcore_id].stats.name += (n);	\
 	} while(0)
 #else
-#define __TIMER_STAT_ADD(name, n) do {} while(0)
+#define __TIMER_STAT_ADD(priv_timer, name, n) RTE_SET_USED(priv_timer)
 #endif
 
-/* Init the timer library. */
-void
-rte_timer_subsystem_init(void)
+static inline struct rte_timer_data *
+timer_data_get(struct rte_timer_data *timer_data)
 {
+	return timer_data == NULL ? &default_timer_data : timer_data;
+}
+
+static void
+timer_data_init(struct rte_timer_data *timer_data)
+{
+	struct priv_timer *priv_timer = timer_data->priv_timer;
 	unsigned lcore_id;
 
-	/* since priv_timer is static, it's zeroed by default, so only init some
-	 * fields.
-	 */
+	/* priv_timer is zeroed by default, so only init some fields. */
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id ++) {
 		rte_spinlock_init(&priv_timer[lcore_id].list_lock);
 		priv_timer[lcore_id].prev_lcore = lcore_id;
 	}
 }
 
+/* Init the timer library. */
+void
+rte_timer_subsystem_init(void)
+{
+	timer_data_init(&default_timer_data);
+}
+
+/* Create a new set of timer lists */
+struct rte_timer_data *
+rte_timer_data_create(const char *name)
+{
+	struct rte_timer_data *timer_data;
+
+	if (name == NULL || name[0] == '\0' ||
+			strlen(name) >= RTE_TIMER_DATA_NAMESIZE) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+
+	rte_spinlock_lock(&timer_data_list_lock);
+
+	if (strcmp(name, default_timer_data.name) == 0) {
+		timer_data = &default_timer_data;
+	} else {
+		TAILQ_FOREACH(timer_data, &timer_data_list, next)
+			if (strcmp(name, timer_data->name) == 0)
+				break;
+	}
+	if (timer_data != NULL) {
+		rte_spinlock_unlock(&timer_data_list_lock);
+		rte_errno = EEXIST;
+		return NULL;
+	}
+
+	timer_data = rte_zmalloc("TIMER_DATA", sizeof(*timer_data),
+			RTE_CACHE_LINE_SIZE);
+	if (timer_data == NULL) {
+		rte_spinlock_unlock(&timer_data_list_lock);
+		rte_errno = ENOMEM;
+		return NULL;
+	}
+	snprintf(timer_data->name, sizeof(timer_data->name), "%s", name);
+	timer_data->engine = RTE_TIMER_ENGINE_SKIPLIST;
+	timer_data->wheel_res = 1;
+	timer_data_init(timer_data);
+	TAILQ_INSERT_TAIL(&timer_data_list, timer_data, next);
+
+	rte_spinlock_unlock(&timer_data_list_lock);
+	return timer_data;
+}
+
+/* Look up a set of timer lists by name */
+struct rte_timer_data *
+rte_timer_data_find_existing(const char *name)
+{
+	struct rte_timer_data *timer_data;
+
+	if (name == NULL) {
+		rte_errno = EINVAL;
+		return NULL;
+	}
+	if (strcmp(name, default_timer_data.name) == 0)
+		return &default_timer_data;
+
+	rte_spinlock_lock(&timer_data_list_lock);
+	TAILQ_FOREACH(timer_data, &timer_data_list, next)
+		if (strcmp(name, timer_data->name) == 0)
+			break;
+	rte_spinlock_unlock(&timer_data_list_lock);
+
+	if (timer_data == NULL)
+		rte_errno = ENOENT;
+	return timer_data;
+}
+
+/* Free a set of timer lists */
+void
+rte_timer_data_free(struct rte_timer_data *timer_data)
+{
+	if (timer_data == NULL || timer_data == &default_timer_data)
+		return;
+
+	rte_spinlock_lock(&timer_data_list_lock);
+	TAILQ_REMOVE(&timer_data_list, timer_data, next);
+	rte_spinlock_unlock(&timer_data_list_lock);
+
+	rte_free(timer_data);
+}
+
+/* Select the data structure used to track pending timers */
+int
+rte_timer_data_set_engine(struct rte_timer_data *timer_data,
+		enum rte_timer_engine engine, uint64_t resolution)
+{
+	struct priv_timer *priv_timer;
+	unsigned lcore_id, lvl;
+	uint64_t cur_tick;
+
+	timer_data = timer_data_get(timer_data);
+	priv_timer = timer_data->priv_timer;
+
+	if (engine != RTE_TIMER_ENGINE_SKIPLIST &&
+			engine != RTE_TIMER_ENGINE_WHEEL)
+		return -EINVAL;
+	if (engine == RTE_TIMER_ENGINE_WHEEL && resolution == 0)
+		return -EINVAL;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (priv_timer[lcore_id].pending_head.sl_next[0] != NULL)
+			return -EBUSY;
+		for (lvl = 0; lvl < TIMER_WHEEL_LEVELS; lvl++)
+			if (priv_timer[lcore_id].wheel.bitmap[lvl] != 0)
+				return -EBUSY;
+	}
+
+	if (engine == RTE_TIMER_ENGINE_WHEEL) {
+		timer_data->wheel_res = resolution;
+		cur_tick = rte_get_timer_cycles() / resolution;
+		for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+			priv_timer[lcore_id].wheel.next_tick = cur_tick;
+	}
+	timer_data->engine = engine;
+
+	return 0;
+}
+
+int
+rte_timer_subsystem_set_engine(enum rte_timer_engine engine,
+		uint64_t resolution)
+{
+	return rte_timer_data_set_engine(NULL, engine, resolution);
+}
+
 /* Initialize the timer handle tim for use */
 void
 rte_timer_init(struct rte_timer *tim)
@@ -137,7 +325,7 @@ timer_set_config_state(struct rte_timer *tim,
 
 		/* timer is running on another core, exit */
 		if (prev_status.state == RTE_TIMER_RUNNING &&
-		    prev_status.owner != (uint16_t)lcore_id)
+		    prev_status.owner != (int16_t)lcore_id)
 			return -1;
 
 		/* timer is being configured on another core */
@@ -231,7 +419,7 @@ timer_get_skiplist_level(unsigned curr_depth)
  */
 static void
 timer_get_prev_entries(uint64_t time_val, unsigned tim_lcore,
-		struct rte_timer **prev)
+		struct rte_timer **prev, struct priv_timer *priv_timer)
 {
 	unsigned lvl = priv_timer[tim_lcore].curr_skiplist_depth;
 	prev[lvl] = &priv_timer[tim_lcore].pending_head;
@@ -250,13 +438,13 @@ timer_get_prev_entries(uint64_t time_val, unsigned tim_lcore,
  */
 static void
 timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
-		struct rte_timer **prev)
+		struct rte_timer **prev, struct priv_timer *priv_timer)
 {
 	int i;
 	/* to get a specific entry in the list, look for just lower than the time
 	 * values, and then increment on each level individually if necessary
 	 */
-	timer_get_prev_entries(tim->expire - 1, tim_lcore, prev);
+	timer_get_prev_entries(tim->expire - 1, tim_lcore, prev, priv_timer);
 	for (i = priv_timer[tim_lcore].curr_skiplist_depth - 1; i >= 0; i--) {
 		while (prev[i]->sl_next[i] != NULL &&
 				prev[i]->sl_next[i] != tim &&
@@ -265,27 +453,212 @@ timer_get_prev_entries_for_node(struct rte_timer *tim, unsigned tim_lcore,
 	}
 }
 
+static inline int
+timer_wheel_empty(const struct timer_wheel *w)
+{
+	unsigned lvl;
+
+	for (lvl = 0; lvl < TIMER_WHEEL_LEVELS; lvl++)
+		if (w->bitmap[lvl] != 0)
+			return 0;
+	return 1;
+}
+
+/*
+ * Wheel tick at which a timer expires, rounded up so that a timer never
+ * expires before its expiry time.
+ */
+static inline uint64_t
+timer_wheel_tick(const struct rte_timer *tim, uint64_t res)
+{
+	return (tim->expire + res - 1) / res;
+}
+
+/* store a timer in the wheel slot matching its expiry tick */
+static void
+timer_wheel_insert_tick(struct timer_wheel *w, struct rte_timer *tim,
+		uint64_t tick)
+{
+	uint64_t delta;
+	unsigned lvl, idx;
+
+	/* already expired, run it with the next tick */
+	if (tick < w->next_tick)
+		tick = w->next_tick;
+	delta = tick - w->next_tick;
+
+	for (lvl = 0; lvl < TIMER_WHEEL_LEVELS - 1; lvl++)
+		if (delta >> ((lvl + 1) * TIMER_WHEEL_BITS) == 0)
+			break;
+	/* beyond the wheel range, store it as far as possible; it is
+	 * inserted again when that tick is reached */
+	if (delta > TIMER_WHEEL_MAX_DELTA)
+		tick = w->next_tick + TIMER_WHEEL_MAX_DELTA;
+
+	idx = (tick >> (lvl * TIMER_WHEEL_BITS)) & TIMER_WHEEL_MASK;
+	tim->wheel.next = w->slots[lvl][idx];
+	if (tim->wheel.next != NULL)
+		tim->wheel.next->wheel.pprev = &tim->wheel.next;
+	tim->wheel.pprev = &w->slots[lvl][idx];
+	w->slots[lvl][idx] = tim;
+	w->bitmap[lvl] |= 1ULL << idx;
+}
+
+static inline void
+timer_wheel_insert(struct timer_wheel *w, struct rte_timer *tim, uint64_t res)
+{
+	timer_wheel_insert_tick(w, tim, timer_wheel_tick(tim, res));
+}
+
+/* append a timer to the list of expired timers ending at *tail */
+static inline void
+timer_wheel_append(struct rte_timer *tim, struct rte_timer ***tail)
+{
+	tim->wheel.next = NULL;
+	tim->wheel.pprev = *tail;
+	**tail = tim;
+	*tail = &tim->wheel.next;
+}
+
+/*
+ * Remove a timer from the slot or the list of expired timers it is
+ * linked in. Does nothing if the timer is not linked.
+ */
+static void
+timer_wheel_unlink(struct timer_wheel *w, struct rte_timer *tim)
+{
+	struct rte_timer **pprev = tim->wheel.pprev;
+	unsigned slot;
+
+	if (pprev == NULL)
+		return;
+
+	*pprev = tim->wheel.next;
+	if (tim->wheel.next != NULL)
+		tim->wheel.next->wheel.pprev = pprev;
+	tim->wheel.pprev = NULL;
+
+	/* the timer was the last one of a slot */
+	if (*pprev == NULL && pprev >= &w->slots[0][0] &&
+			pprev < &w->slots[0][0] +
+				TIMER_WHEEL_LEVELS * TIMER_WHEEL_SLOTS) {
+		slot = pprev - &w->slots[0][0];
+		w->bitmap[slot / TIMER_WHEEL_SLOTS] &=
+			~(1ULL << (slot % TIMER_WHEEL_SLOTS));
+	}
+}
+
+/*
+ * Move the timers of the upper level slots reached by next_tick down.
+ * Timers expiring no later than tick now are directly appended to the
+ * list of expired timers instead of going through the lower levels.
+ */
+static void
+timer_wheel_cascade(struct timer_wheel *w, uint64_t res, uint64_t now,
+		struct rte_timer ***tail)
+{
+	struct rte_timer *tim, *next;
+	uint64_t tick;
+	unsigned lvl, idx;
+
+	for (lvl = 1; lvl < TIMER_WHEEL_LEVELS; lvl++) {
+		idx = (w->next_tick >> (lvl * TIMER_WHEEL_BITS)) &
+			TIMER_WHEEL_MASK;
+		tim = w->slots[lvl][idx];
+		w->slots[lvl][idx] = NULL;
+		w->bitmap[lvl] &= ~(1ULL << idx);
+		for ( ; tim != NULL; tim = next) {
+			next = tim->wheel.next;
+			tick = timer_wheel_tick(tim, res);
+			if (tick <= now)
+				timer_wheel_append(tim, tail);
+			else
+				timer_wheel_insert_tick(w, tim, tick);
+		}
+		/* the next level is only reached when this one wraps */
+		if (idx != 0)
+			break;
+	}
+}
+
+/*
+ * Advance the wheel up to tick now, appending the timers of all the slots
+ * passed to the list ending at *tail. Empty slots are skipped using the
+ * level 0 bitmap rather than one tick at a time.
+ */
+static void
+timer_wheel_advance(struct timer_wheel *w, uint64_t res, uint64_t now,
+		struct rte_timer ***tail)
+{
+	struct rte_timer *tim;
+	uint64_t skip, bits;
+	unsigned idx;
+
+	while (w->next_tick <= now) {
+		idx = w->next_tick & TIMER_WHEEL_MASK;
+		if (idx == 0)
+			timer_wheel_cascade(w, res, now, tail);
+
+		tim = w->slots[0][idx];
+		if (tim != NULL) {
+			w->slots[0][idx] = NULL;
+			w->bitmap[0] &= ~(1ULL << idx);
+			**tail = tim;
+			tim->wheel.pprev = *tail;
+			while (tim->wheel.next != NULL)
+				tim = tim->wheel.next;
+			*tail = &tim->wheel.next;
+			w->next_tick++;
+			continue;
+		}
+
+		/* jump to the next non empty slot or to the end of the
+		 * level 0 round, where a cascade may be needed */
+		bits = w->bitmap[0] >> idx;
+		skip = bits != 0 ? (uint64_t)__builtin_ctzll(bits) :
+			(uint64_t)(TIMER_WHEEL_SLOTS - idx);
+		if (skip > now - w->next_tick + 1)
+			skip = now - w->next_tick + 1;
+		w->next_tick += skip;
+	}
+}
+
 /*
  * add in list, lock if needed
  * timer must be in config state
  * timer must not be in a list
  */
 static void
-timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
+timer_add(struct rte_timer_data *timer_data, struct rte_timer *tim,
+		unsigned tim_lcore, unsigned locked_lcore)
 {
-	unsigned lcore_id = rte_lcore_id();
+	struct priv_timer *priv_timer = timer_data->priv_timer;
 	unsigned lvl;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
-	/* if timer needs to be scheduled on another core, we need to
-	 * lock the list; if it is on local core, we need to lock if
-	 * we are not called from rte_timer_manage() */
-	if (tim_lcore != lcore_id || !local_is_locked)
+	/* we need to lock the list, unless we are called from
+	 * rte_timer_manage() on that same list */
+	if (tim_lcore != locked_lcore)
 		rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
 
+	if (timer_data->engine == RTE_TIMER_ENGINE_WHEEL) {
+		struct timer_wheel *w = &priv_timer[tim_lcore].wheel;
+		uint64_t res = timer_data->wheel_res;
+		uint64_t cur_tick;
+
+		/* don't make the manager catch up with an idle period */
+		if (timer_wheel_empty(w)) {
+			cur_tick = rte_get_timer_cycles() / res;
+			if (w->next_tick < cur_tick)
+				w->next_tick = cur_tick;
+		}
+		timer_wheel_insert(w, tim, res);
+		goto unlock;
+	}
+
 	/* find where exactly this element goes in the list of elements
 	 * for each depth. */
-	timer_get_prev_entries(tim->expire, tim_lcore, prev);
+	timer_get_prev_entries(tim->expire, tim_lcore, prev, priv_timer);
 
 	/* now assign it a new level and add at that level */
 	const unsigned tim_level = timer_get_skiplist_level(
@@ -307,7 +680,8 @@ timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
 	priv_timer[tim_lcore].pending_head.expire = priv_timer[tim_lcore].\
 			pending_head.sl_next[0]->expire;
 
-	if (tim_lcore != lcore_id || !local_is_locked)
+unlock:
+	if (tim_lcore != locked_lcore)
 		rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
 }
 
@@ -317,20 +691,24 @@ timer_add(struct rte_timer *tim, unsigned tim_lcore, int local_is_locked)
  * timer must be in a list
  */
 static void
-timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
-		int local_is_locked)
+timer_del(struct rte_timer_data *timer_data, struct rte_timer *tim,
+		union rte_timer_status prev_status, unsigned locked_lcore)
 {
-	unsigned lcore_id = rte_lcore_id();
+	struct priv_timer *priv_timer = timer_data->priv_timer;
 	unsigned prev_owner = prev_status.owner;
 	int i;
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH+1];
 
-	/* if timer needs is pending another core, we need to lock the
-	 * list; if it is on local core, we need to lock if we are not
-	 * called from rte_timer_manage() */
-	if (prev_owner != lcore_id || !local_is_locked)
+	/* we need to lock the list the timer is pending in, unless we are
+	 * called from rte_timer_manage() on that same list */
+	if (prev_owner != locked_lcore)
 		rte_spinlock_lock(&priv_timer[prev_owner].list_lock);
 
+	if (timer_data->engine == RTE_TIMER_ENGINE_WHEEL) {
+		timer_wheel_unlink(&priv_timer[prev_owner].wheel, tim);
+		goto unlock;
+	}
+
 	/* save the lowest list entry into the expire field of the dummy hdr.
 	 * NOTE: this is not atomic on 32-bit */
 	if (tim == priv_timer[prev_owner].pending_head.sl_next[0])
@@ -338,7 +716,7 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 				((tim->sl_next[0] == NULL) ? 0 : tim->sl_next[0]->expire);
 
 	/* adjust pointers from previous entries to point past this */
-	timer_get_prev_entries_for_node(tim, prev_owner, prev);
+	timer_get_prev_entries_for_node(tim, prev_owner, prev, priv_timer);
 	for (i = priv_timer[prev_owner].curr_skiplist_depth - 1; i >= 0; i--) {
 		if (prev[i]->sl_next[i] == tim)
 			prev[i]->sl_next[i] = tim->sl_next[i];
@@ -351,17 +729,19 @@ timer_del(struct rte_timer *tim, union rte_timer_status prev_status,
 		else
 			break;
 
-	if (prev_owner != lcore_id || !local_is_locked)
+unlock:
+	if (prev_owner != locked_lcore)
 		rte_spinlock_unlock(&priv_timer[prev_owner].list_lock);
 }
 
 /* Reset and start the timer associated with the timer handle (private func) */
 static int
-__rte_timer_reset(struct rte_timer *tim, uint64_t expire,
-		  uint64_t period, unsigned tim_lcore,
+__rte_timer_reset(struct rte_timer_data *timer_data, struct rte_timer *tim,
+		  uint64_t expire, uint64_t period, unsigned tim_lcore,
 		  rte_timer_cb_t fct, void *arg,
-		  int local_is_locked)
+		  unsigned locked_lcore)
 {
+	struct priv_timer *priv_timer = timer_data->priv_timer;
 	union rte_timer_status prev_status, status;
 	int ret;
 	unsigned lcore_id = rte_lcore_id();
@@ -386,16 +766,14 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 	if (ret < 0)
 		return -1;
 
-	__TIMER_STAT_ADD(reset, 1);
-	if (prev_status.state == RTE_TIMER_RUNNING &&
-	    lcore_id < RTE_MAX_LCORE) {
-		priv_timer[lcore_id].updated = 1;
-	}
+	__TIMER_STAT_ADD(priv_timer, reset, 1);
+	if (prev_status.state == RTE_TIMER_RUNNING)
+		RTE_PER_LCORE(timer_updated) = 1;
 
 	/* remove it from list */
 	if (prev_status.state == RTE_TIMER_PENDING) {
-		timer_del(tim, prev_status, local_is_locked);
-		__TIMER_STAT_ADD(pending, -1);
+		timer_del(timer_data, tim, prev_status, locked_lcore);
+		__TIMER_STAT_ADD(priv_timer, pending, -1);
 	}
 
 	tim->period = period;
@@ -403,8 +781,8 @@ __rte_timer_reset(struct rte_timer *tim, uint64_t expire,
 	tim->f = fct;
 	tim->arg = arg;
 
-	__TIMER_STAT_ADD(pending, 1);
-	timer_add(tim, tim_lcore, local_is_locked);
+	__TIMER_STAT_ADD(priv_timer, pending, 1);
+	timer_add(timer_data, tim, tim_lcore, locked_lcore);
 
 	/* update state: as we are in CONFIG state, only us can modify
 	 * the state so we don't need to use cmpset() here */
@@ -434,8 +812,33 @@ rte_timer_reset(struct rte_timer *tim, uint64_t ticks,
 	else
 		period = 0;
 
-	return __rte_timer_reset(tim,  cur_time + ticks, period, tim_lcore,
-			  fct, arg, 0);
+	return __rte_timer_reset(&default_timer_data, tim, cur_time + ticks,
+			period, tim_lcore, fct, arg, RTE_MAX_LCORE);
+}
+
+/* Reset and start a timer of a set of timer lists */
+int
+rte_timer_data_reset(struct rte_timer_data *timer_data, struct rte_timer *tim,
+		uint64_t ticks, enum rte_timer_type type, unsigned tim_lcore,
+		rte_timer_cb_t fct, void *arg)
+{
+	uint64_t cur_time = rte_get_timer_cycles();
+	uint64_t period;
+
+	/* the lists of an instance may be managed by another thread than
+	 * their lcore, so any list can be used */
+	if (unlikely(tim_lcore != (unsigned)LCORE_ID_ANY &&
+			tim_lcore >= RTE_MAX_LCORE))
+		return -1;
+
+	if (type == PERIODICAL)
+		period = ticks;
+	else
+		period = 0;
+
+	return __rte_timer_reset(timer_data_get(timer_data), tim,
+			cur_time + ticks, period, tim_lcore, fct, arg,
+			RTE_MAX_LCORE);
 }
 
 /* loop until rte_timer_reset() succeed */
@@ -449,12 +852,12 @@ rte_timer_reset_sync(struct rte_timer *tim, uint64_t ticks,
 		rte_pause();
 }
 
-/* Stop the timer associated with the timer handle tim */
-int
-rte_timer_stop(struct rte_timer *tim)
+/* Stop a timer (private func) */
+static int
+__rte_timer_stop(struct rte_timer_data *timer_data, struct rte_timer *tim)
 {
+	struct priv_timer *priv_timer = timer_data->priv_timer;
 	union rte_timer_status prev_status, status;
-	unsigned lcore_id = rte_lcore_id();
 	int ret;
 
 	/* wait that the timer is in correct status before update,
@@ -463,16 +866,14 @@ rte_timer_stop(struct rte_timer *tim)
 	if (ret < 0)
 		return -1;
 
-	__TIMER_STAT_ADD(stop, 1);
-	if (prev_status.state == RTE_TIMER_RUNNING &&
-	    lcore_id < RTE_MAX_LCORE) {
-		priv_timer[lcore_id].updated = 1;
-	}
+	__TIMER_STAT_ADD(priv_timer, stop, 1);
+	if (prev_status.state == RTE_TIMER_RUNNING)
+		RTE_PER_LCORE(timer_updated) = 1;
 
 	/* remove it from list */
 	if (prev_status.state == RTE_TIMER_PENDING) {
-		timer_del(tim, prev_status, 0);
-		__TIMER_STAT_ADD(pending, -1);
+		timer_del(timer_data, tim, prev_status, RTE_MAX_LCORE);
+		__TIMER_STAT_ADD(priv_timer, pending, -1);
 	}
 
 	/* mark timer as stopped */
@@ -484,6 +885,20 @@ rte_timer_stop(struct rte_timer *tim)
 	return 0;
 }
 
+/* Stop the timer associated with the timer handle tim */
+int
+rte_timer_stop(struct rte_timer *tim)
+{
+	return __rte_timer_stop(&default_timer_data, tim);
+}
+
+/* Stop a timer of a set of timer lists */
+int
+rte_timer_data_stop(struct rte_timer_data *timer_data, struct rte_timer *tim)
+{
+	return __rte_timer_stop(timer_data_get(timer_data), tim);
+}
+
 /* loop until rte_timer_stop() succeed */
 void
 rte_timer_stop_sync(struct rte_timer *tim)
@@ -499,22 +914,118 @@ rte_timer_pending(struct rte_timer *tim)
 	return tim->status.state == RTE_TIMER_PENDING;
 }
 
-/* must be called periodically, run all timer that expired */
-void rte_timer_manage(void)
+/*
+ * run the callback of an expired timer in running state, and reload it in
+ * the list of tim_lcore if it is periodic; called and returns with the list
+ * of tim_lcore locked
+ */
+static void
+timer_run(struct rte_timer_data *timer_data, struct rte_timer *tim,
+		unsigned tim_lcore, uint64_t cur_time)
 {
+	struct priv_timer *priv_timer = timer_data->priv_timer;
 	union rte_timer_status status;
+
+	rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
+
+	RTE_PER_LCORE(timer_updated) = 0;
+
+	/* execute callback function with list unlocked */
+	tim->f(tim, tim->arg);
+
+	rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
+	__TIMER_STAT_ADD(priv_timer, pending, -1);
+	/* the timer was stopped or reloaded by the callback
+	 * function, we have nothing to do here */
+	if (RTE_PER_LCORE(timer_updated) == 1)
+		return;
+
+	if (tim->period == 0) {
+		/* remove from done list and mark timer as stopped */
+		status.state = RTE_TIMER_STOP;
+		status.owner = RTE_TIMER_NO_OWNER;
+		rte_wmb();
+		tim->status.u32 = status.u32;
+	}
+	else {
+		/* keep it in list and mark timer as pending */
+		status.state = RTE_TIMER_PENDING;
+		__TIMER_STAT_ADD(priv_timer, pending, 1);
+		status.owner = (int16_t)tim_lcore;
+		rte_wmb();
+		tim->status.u32 = status.u32;
+		__rte_timer_reset(timer_data, tim, cur_time + tim->period,
+				tim->period, tim_lcore, tim->f, tim->arg,
+				tim_lcore);
+	}
+}
+
+/* timer_manage() for the timer wheel engine */
+static void
+timer_wheel_manage(struct rte_timer_data *timer_data, unsigned tim_lcore)
+{
+	struct priv_timer *priv_timer = timer_data->priv_timer;
+	struct timer_wheel *w = &priv_timer[tim_lcore].wheel;
+	struct rte_timer *expired = NULL, **tail = &expired;
+	struct rte_timer *tim;
+	uint64_t cur_time, now;
+
+	/* optimize for the cases where the wheel is empty, or where no tick
+	 * elapsed since the last call; as for the skiplist, a torn read of
+	 * next_tick on 32-bit only delays the processing to the next call */
+	if (timer_wheel_empty(w))
+		return;
+	cur_time = rte_get_timer_cycles();
+	now = cur_time / timer_data->wheel_res;
+	if (likely(w->next_tick > now))
+		return;
+
+	rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
+
+	/* collect all expired timers at once, so that timers reloaded by
+	 * the callbacks are only run by the next call */
+	timer_wheel_advance(w, timer_data->wheel_res, now, &tail);
+
+	/* the expired list may be modified by other lcores stopping or
+	 * resetting timers while the callbacks run unlocked, so always
+	 * take its first element */
+	while ((tim = expired) != NULL) {
+		timer_wheel_unlink(w, tim);
+
+		/* stored at the end of the wheel range, not expired yet */
+		if (unlikely(tim->expire > cur_time)) {
+			timer_wheel_insert(w, tim, timer_data->wheel_res);
+			continue;
+		}
+
+		/* this timer was not pending, continue */
+		if (timer_set_running_state(tim) < 0)
+			continue;
+
+		timer_run(timer_data, tim, tim_lcore, cur_time);
+	}
+
+	rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
+}
+
+/* run all expired timers of the list of tim_lcore on the current thread */
+static void
+timer_manage(struct rte_timer_data *timer_data, unsigned tim_lcore)
+{
+	struct priv_timer *priv_timer = timer_data->priv_timer;
 	struct rte_timer *tim, *next_tim;
-	unsigned lcore_id = rte_lcore_id();
 	struct rte_timer *prev[MAX_SKIPLIST_DEPTH + 1];
 	uint64_t cur_time;
 	int i, ret;
 
-	/* timer manager only runs on EAL thread with valid lcore_id */
-	assert(lcore_id < RTE_MAX_LCORE);
+	__TIMER_STAT_ADD(priv_timer, manage, 1);
+	if (timer_data->engine == RTE_TIMER_ENGINE_WHEEL) {
+		timer_wheel_manage(timer_data, tim_lcore);
+		return;
+	}
 
-	__TIMER_STAT_ADD(manage, 1);
 	/* optimize for the case where per-cpu list is empty */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL)
+	if (priv_timer[tim_lcore].pending_head.sl_next[0] == NULL)
 		return;
 	cur_time = rte_get_timer_cycles();
 
@@ -522,27 +1033,27 @@ void rte_timer_manage(void)
 	/* on 64-bit the value cached in the pending_head.expired will be updated
 	 * atomically, so we can consult that for a quick check here outside the
 	 * lock */
-	if (likely(priv_timer[lcore_id].pending_head.expire > cur_time))
+	if (likely(priv_timer[tim_lcore].pending_head.expire > cur_time))
 		return;
 #endif
 
 	/* browse ordered list, add expired timers in 'expired' list */
-	rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
+	rte_spinlock_lock(&priv_timer[tim_lcore].list_lock);
 
 	/* if nothing to do just unlock and return */
-	if (priv_timer[lcore_id].pending_head.sl_next[0] == NULL ||
-			priv_timer[lcore_id].pending_head.sl_next[0]->expire > cur_time)
+	if (priv_timer[tim_lcore].pending_head.sl_next[0] == NULL ||
+			priv_timer[tim_lcore].pending_head.sl_next[0]->expire > cur_time)
 		goto done;
 
 	/* save start of list of expired timers */
-	tim = priv_timer[lcore_id].pending_head.sl_next[0];
+	tim = priv_timer[tim_lcore].pending_head.sl_next[0];
 
 	/* break the existing list at current time point */
-	timer_get_prev_entries(cur_time, lcore_id, prev);
-	for (i = priv_timer[lcore_id].curr_skiplist_depth -1; i >= 0; i--) {
-		priv_timer[lcore_id].pending_head.sl_next[i] = prev[i]->sl_next[i];
+	timer_get_prev_entries(cur_time, tim_lcore, prev, priv_timer);
+	for (i = priv_timer[tim_lcore].curr_skiplist_depth -1; i >= 0; i--) {
+		priv_timer[tim_lcore].pending_head.sl_next[i] = prev[i]->sl_next[i];
 		if (prev[i]->sl_next[i] == NULL)
-			priv_timer[lcore_id].curr_skiplist_depth--;
+			priv_timer[tim_lcore].curr_skiplist_depth--;
 		prev[i] ->sl_next[i] = NULL;
 	}
 
@@ -556,55 +1067,75 @@ void rte_timer_manage(void)
 		if (ret < 0)
 			continue;
 
-		rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+		timer_run(timer_data, tim, tim_lcore, cur_time);
+	}
 
-		priv_timer[lcore_id].updated = 0;
+	/* update the next to expire timer value */
+	priv_timer[tim_lcore].pending_head.expire =
+			(priv_timer[tim_lcore].pending_head.sl_next[0] == NULL) ? 0 :
+					priv_timer[tim_lcore].pending_head.sl_next[0]->expire;
+done:
+	/* job finished, unlock the list lock */
+	rte_spinlock_unlock(&priv_timer[tim_lcore].list_lock);
+}
 
-		/* execute callback function with list unlocked */
-		tim->f(tim, tim->arg);
+/* must be called periodically, run all timer that expired */
+void rte_timer_manage(void)
+{
+	unsigned lcore_id = rte_lcore_id();
 
-		rte_spinlock_lock(&priv_timer[lcore_id].list_lock);
-		__TIMER_STAT_ADD(pending, -1);
-		/* the timer was stopped or reloaded by the callback
-		 * function, we have nothing to do here */
-		if (priv_timer[lcore_id].updated == 1)
-			continue;
+	/* timer manager only runs on EAL thread with valid lcore_id */
+	assert(lcore_id < RTE_MAX_LCORE);
 
-		if (tim->period == 0) {
-			/* remove from done list and mark timer as stopped */
-			status.state = RTE_TIMER_STOP;
-			status.owner = RTE_TIMER_NO_OWNER;
-			rte_wmb();
-			tim->status.u32 = status.u32;
-		}
-		else {
-			/* keep it in list and mark timer as pending */
-			status.state = RTE_TIMER_PENDING;
-			__TIMER_STAT_ADD(pending, 1);
-			status.owner = (int16_t)lcore_id;
-			rte_wmb();
-			tim->status.u32 = status.u32;
-			__rte_timer_reset(tim, cur_time + tim->period,
-					tim->period, lcore_id, tim->f, tim->arg, 1);
-		}
+	timer_manage(&default_timer_data, lcore_id);
+}
+
+/* run the expired timers of the list of the current lcore */
+void
+rte_timer_data_manage(struct rte_timer_data *timer_data)
+{
+	unsigned lcore_id = rte_lcore_id();
+
+	assert(lcore_id < RTE_MAX_LCORE);
+
+	timer_manage(timer_data_get(timer_data), lcore_id);
+}
+
+/* run the expired timers of the lists of several lcores */
+int
+rte_timer_data_manage_lcores(struct rte_timer_data *timer_data,
+		const unsigned *lcores, unsigned nb_lcores)
+{
+	unsigned i;
+
+	timer_data = timer_data_get(timer_data);
+
+	if (lcores == NULL) {
+		for (i = 0; i < RTE_MAX_LCORE; i++)
+			timer_manage(timer_data, i);
+		return 0;
 	}
 
-	/* update the next to expire timer value */
-	priv_timer[lcore_id].pending_head.expire =
-			(priv_timer[lcore_id].pending_head.sl_next[0] == NULL) ? 0 :
-					priv_timer[lcore_id].pending_head.sl_next[0]->expire;
-done:
-	/* job finished, unlock the list lock */
-	rte_spinlock_unlock(&priv_timer[lcore_id].list_lock);
+	for (i = 0; i < nb_lcores; i++)
+		if (lcores[i] >= RTE_MAX_LCORE)
+			return -EINVAL;
+	for (i = 0; i < nb_lcores; i++)
+		timer_manage(timer_data, lcores[i]);
+	return 0;
 }
 
 /* dump statistics about timers */
-void rte_timer_dump_stats(FILE *f)
+void
+rte_timer_data_dump_stats(struct rte_timer_data *timer_data, FILE *f)
 {
 #ifdef RTE_LIBRTE_TIMER_DEBUG
+	struct priv_timer *priv_timer;
 	struct rte_timer_debug_stats sum;
 	unsigned lcore_id;
 
+	timer_data = timer_data_get(timer_data);
+	priv_timer = timer_data->priv_timer;
+
 	memset(&sum, 0, sizeof(sum));
 	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
 		sum.reset += priv_timer[lcore_id].stats.reset;
@@ -612,12 +1143,19 @@ void rte_timer_dump_stats(FILE *f)
 		sum.manage += priv_timer[lcore_id].stats.manage;
 		sum.pending += priv_timer[lcore_id].stats.pending;
 	}
-	fprintf(f, "Timer statistics:\n");
+	fprintf(f, "Timer statistics (%s):\n", timer_data->name);
 	fprintf(f, "  reset = %"PRIu64"\n", sum.reset);
 	fprintf(f, "  stop = %"PRIu64"\n", sum.stop);
 	fprintf(f, "  manage = %"PRIu64"\n", sum.manage);
 	fprintf(f, "  pending = %"PRIu64"\n", sum.pending);
 #else
+	RTE_SET_USED(timer_data);
 	fprintf(f, "No timer statistics, RTE_LIBRTE_TIMER_DEBUG is disabled\n");
 #endif
 }
+
+/* dump statistics about timers */
+void rte_timer_dump_stats(FILE *f)
+{
+	rte_timer_data_dump_stats(NULL, f);
+}
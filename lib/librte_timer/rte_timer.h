@@ -78,6 +78,8 @@ extern "C" {
 
 #define RTE_TIMER_NO_OWNER -2 /**< Timer has no owner. */
 
+#define RTE_TIMER_DATA_NAMESIZE 32 /**< Max length of timer data name. */
+
 /**
  * Timer type: Periodic or single (one-shot).
  */
@@ -110,8 +112,21 @@ struct rte_timer_debug_stats {
 };
 #endif
 
+/**
+ * Data structure used to track the pending timers of each lcore.
+ */
+enum rte_timer_engine {
+	RTE_TIMER_ENGINE_SKIPLIST, /**< Skiplist ordered by expiry (default). */
+	RTE_TIMER_ENGINE_WHEEL,    /**< Hierarchical timing wheel. */
+};
+
 struct rte_timer;
 
+/**
+ * An independent set of per-lcore timer lists, see rte_timer_data_create().
+ */
+struct rte_timer_data;
+
 /**
  * Callback function type for timer expiry.
  */
@@ -125,7 +140,15 @@ typedef void (*rte_timer_cb_t)(struct rte_timer *, void *);
 struct rte_timer
 {
 	uint64_t expire;       /**< Time when timer expire. */
-	struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+	union {
+		/** Skiplist links, with the skiplist engine. */
+		struct rte_timer *sl_next[MAX_SKIPLIST_DEPTH];
+		/** Slot list links, with the timer wheel engine. */
+		struct {
+			struct rte_timer *next;   /**< Next timer in slot. */
+			struct rte_timer **pprev; /**< Link to this timer. */
+		} wheel;
+	};
 	volatile union rte_timer_status status; /**< Status of timer. */
 	uint64_t period;       /**< Period of timer (0 if not periodic). */
 	rte_timer_cb_t f;      /**< Callback function. */
@@ -165,6 +188,33 @@ struct rte_timer
  */
 void rte_timer_subsystem_init(void);
 
+/**
+ * Select the data structure used to track pending timers.
+ *
+ * By default, the pending timers of each lcore are kept in a skiplist
+ * ordered by expiry time, so that adding or removing a timer costs
+ * O(log n). The timer wheel engine instead hashes timers into the slots
+ * of a hierarchical timing wheel: adding or removing a timer costs O(1)
+ * whatever the number of pending timers, and rte_timer_manage() expires
+ * all the timers of a slot at once. In exchange, timers expire on a
+ * *resolution* boundary, i.e. up to *resolution* cycles after their
+ * expiry time.
+ *
+ * The engine can only be changed while no timer is pending on any lcore.
+ *
+ * @param engine
+ *   The engine to use for all lcores.
+ * @param resolution
+ *   With RTE_TIMER_ENGINE_WHEEL, the duration of a tick of the wheel in
+ *   timer cycles (see rte_get_timer_hz()). Ignored for the skiplist.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid engine or resolution.
+ *   - (-EBUSY): Timers are pending.
+ */
+int rte_timer_subsystem_set_engine(enum rte_timer_engine engine,
+		uint64_t resolution);
+
 /**
  * Initialize a timer handle.
  *
@@ -328,6 +378,159 @@ void rte_timer_manage(void);
  */
 void rte_timer_dump_stats(FILE *f);
 
+/**
+ * Create a new set of timer lists.
+ *
+ * The functions above all use a default set of per-lcore timer lists,
+ * named "default". Timer data instances provide independent sets of
+ * per-lcore lists, so that several users in the same application can
+ * manage their timers with different frequencies, engines or threads.
+ *
+ * A timer pending in an instance must be reset or stopped using the
+ * same instance. The functions taking an instance accept NULL to use the
+ * default one.
+ *
+ * @param name
+ *   The name of the instance.
+ * @return
+ *   The new instance on success, NULL on error with rte_errno set:
+ *   - EINVAL: invalid name.
+ *   - EEXIST: an instance with the same name already exists.
+ *   - ENOMEM: no memory available.
+ */
+struct rte_timer_data *rte_timer_data_create(const char *name);
+
+/**
+ * Look up a set of timer lists by name.
+ *
+ * @param name
+ *   The name of the instance, "default" for the default instance.
+ * @return
+ *   The instance, or NULL if not found with rte_errno set to ENOENT.
+ */
+struct rte_timer_data *rte_timer_data_find_existing(const char *name);
+
+/**
+ * Free a set of timer lists created by rte_timer_data_create().
+ *
+ * No timer must be pending in the instance.
+ *
+ * @param timer_data
+ *   The instance to free. The default instance cannot be freed.
+ */
+void rte_timer_data_free(struct rte_timer_data *timer_data);
+
+/**
+ * Select the data structure used to track the pending timers of an
+ * instance; see rte_timer_subsystem_set_engine().
+ *
+ * @param timer_data
+ *   The instance, or NULL for the default one.
+ * @param engine
+ *   The engine to use for all the lists of the instance.
+ * @param resolution
+ *   With RTE_TIMER_ENGINE_WHEEL, the duration of a tick of the wheel in
+ *   timer cycles. Ignored for the skiplist.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): Invalid engine or resolution.
+ *   - (-EBUSY): Timers are pending in the instance.
+ */
+int rte_timer_data_set_engine(struct rte_timer_data *timer_data,
+		enum rte_timer_engine engine, uint64_t resolution);
+
+/**
+ * Reset and start a timer in a set of timer lists.
+ *
+ * Same as rte_timer_reset(), except that *tim_lcore* only selects the
+ * list of the instance the timer is stored in: it does not need to be an
+ * enabled lcore, provided that the list is managed with
+ * rte_timer_data_manage_lcores().
+ *
+ * @param timer_data
+ *   The instance, or NULL for the default one.
+ * @param tim
+ *   The timer handle.
+ * @param ticks
+ *   The number of cycles (see rte_get_timer_hz()) before the callback
+ *   function is called.
+ * @param type
+ *   SINGLE or PERIODICAL, see rte_timer_reset().
+ * @param tim_lcore
+ *   The list of the instance where the timer is stored, lower than
+ *   RTE_MAX_LCORE, or LCORE_ID_ANY to select the enabled lcores in a
+ *   round-robin manner.
+ * @param fct
+ *   The callback function of the timer.
+ * @param arg
+ *   The user argument of the callback function.
+ * @return
+ *   - 0: Success; the timer is scheduled.
+ *   - (-1): Timer is in the RUNNING or CONFIG state, or invalid lcore.
+ */
+int rte_timer_data_reset(struct rte_timer_data *timer_data,
+		struct rte_timer *tim, uint64_t ticks, enum rte_timer_type type,
+		unsigned tim_lcore, rte_timer_cb_t fct, void *arg);
+
+/**
+ * Stop a timer of a set of timer lists, see rte_timer_stop().
+ *
+ * @param timer_data
+ *   The instance the timer was reset in, or NULL for the default one.
+ * @param tim
+ *   The timer handle.
+ * @return
+ *   - 0: Success; the timer is stopped.
+ *   - (-1): The timer is in the RUNNING or CONFIG state.
+ */
+int rte_timer_data_stop(struct rte_timer_data *timer_data,
+		struct rte_timer *tim);
+
+/**
+ * Run the expired timers of the list of the current lcore in a set of
+ * timer lists, see rte_timer_manage().
+ *
+ * @param timer_data
+ *   The instance, or NULL for the default one.
+ */
+void rte_timer_data_manage(struct rte_timer_data *timer_data);
+
+/**
+ * Run the expired timers of the lists of several lcores.
+ *
+ * This allows a single thread, which does not need to be an EAL thread,
+ * to run the expired timers of several lcores, so that these lcores do not
+ * need to call rte_timer_manage() themselves. The callbacks are executed
+ * by the calling thread; periodic timers stay in the list they expired
+ * from. The lists may still be managed by their own lcore too.
+ *
+ * Only one non-EAL thread may run timer callbacks, as all non-EAL threads
+ * share the same owner id in the timer status.
+ *
+ * @param timer_data
+ *   The instance, or NULL for the default one.
+ * @param lcores
+ *   The lcore ids of the lists to manage, or NULL for all the lists.
+ * @param nb_lcores
+ *   The number of entries in *lcores*.
+ * @return
+ *   - 0: Success.
+ *   - (-EINVAL): An lcore id is not lower than RTE_MAX_LCORE; no list
+ *     was managed.
+ */
+int rte_timer_data_manage_lcores(struct rte_timer_data *timer_data,
+		const unsigned *lcores, unsigned nb_lcores);
+
+/**
+ * Dump statistics about the timers of a set of timer lists.
+ *
+ * @param timer_data
+ *   The instance, or NULL for the default one.
+ * @param f
+ *   A pointer to a file for output
+ */
+void rte_timer_data_dump_stats(struct rte_timer_data *timer_data, FILE *f);
+
 #ifdef __cplusplus
 }
 #endif
@@ -88,9 +88,13 @@ struct vhost_virtqueue {
 	volatile uint16_t	last_used_idx_res;	/**< Used for multiple devices reserving buffers. */
 	eventfd_t		callfd;			/**< Used to notify the guest (trigger interrupt). */
 	eventfd_t		kickfd;			/**< Currently unused as polling mode is enabled. */
+	uint16_t		notify_threshold;	/**< Used entries to add before notifying the guest. */
+	volatile uint16_t	nb_unnotified;		/**< Used entries added since the guest was last notified. */
 	struct buf_vector	buf_vec[BUF_VECTOR_MAX];	/**< for scatter RX. */
 } __rte_cache_aligned;
 
+struct vhost_zcopy;
+
 /**
  * Device structure contains all configuration information relating to the device.
  */
@@ -103,6 +107,7 @@ struct virtio_net {
 #define IF_NAME_SZ (PATH_MAX > IFNAMSIZ ? PATH_MAX : IFNAMSIZ)
 	char			ifname[IF_NAME_SZ];	/**< Name of the tap device or socket path. */
 	void			*priv;		/**< private context */
+	struct vhost_zcopy	*zcopy;		/**< Zero copy dequeue state, NULL if disabled. */
 } __rte_cache_aligned;
 
 /**
@@ -184,6 +189,60 @@ uint64_t rte_vhost_feature_get(void);
 
 int rte_vhost_enable_guest_notification(struct virtio_net *dev, uint16_t queue_id, int enable);
 
+/**
+ * Enable or disable zero copy dequeue on a device.
+ *
+ * When enabled, rte_vhost_dequeue_burst() returns mbufs whose data buffer
+ * is the guest buffer itself instead of a copy of it. The descriptor is
+ * given back to the guest only once the application has freed the mbuf,
+ * in the order the mbufs were dequeued. If the device is removed or its
+ * memory changes before then, zero copy is disabled but the guest memory
+ * stays mapped until these mbufs are freed. Packets which are
+ * scattered in several descriptors, or whose buffer is not physically
+ * contiguous in host memory, are still copied. Guest memory which is not
+ * backed by hugepages is never used for zero copy.
+ *
+ * Enabling it locks the guest memory in place, so it should be done from
+ * the new_device() callback; it is disabled when the device is removed.
+ *
+ * @param dev
+ *  The virtio device.
+ * @param queue_id
+ *  Virtio queue index, only VIRTIO_TXQ is supported.
+ * @param enable
+ *  Non-zero to enable, zero to disable.
+ * @return
+ *  0 on success, -1 on error or if mbufs given to the application have
+ *  not been freed yet when disabling.
+ */
+int rte_vhost_enable_dequeue_zero_copy(struct virtio_net *dev,
+	uint16_t queue_id, int enable);
+
+/**
+ * Set how many used entries the enqueue path adds to the RX virtqueue
+ * before notifying the guest.
+ *
+ * By default the guest is notified after each rte_vhost_enqueue_burst()
+ * call, which costs a system call per burst. With a threshold, the
+ * notifications of several bursts are coalesced into one. The guest is
+ * still notified at once when its receive buffers run out. Calling
+ * rte_vhost_enqueue_burst() with no packets notifies the guest of the
+ * entries added since the last notification; applications using a
+ * threshold should do it when they have no more packets to send, so
+ * that the guest does not wait for the last packets.
+ *
+ * @param dev
+ *  The virtio device.
+ * @param queue_id
+ *  Virtio queue index, only VIRTIO_RXQ is supported.
+ * @param threshold
+ *  Number of used entries, 0 to notify the guest after each burst.
+ * @return
+ *  0 on success, -1 on error.
+ */
+int rte_vhost_set_notify_threshold(struct virtio_net *dev, uint16_t queue_id,
+	uint16_t threshold);
+
 /* Register vhost driver. dev_name could be different for multiple instance support. */
 int rte_vhost_driver_register(const char *dev_name);
 
@@ -196,7 +255,9 @@ int rte_vhost_driver_session_start(void);
  * This function adds buffers to the virtio devices RX virtqueue. Buffers can
  * be received from the physical port or from another virtual device. A packet
  * count is returned to indicate the number of packets that were succesfully
- * added to the RX queue.
+ * added to the RX queue. With no packets, it notifies the guest of the
+ * packets added since the last notification, see
+ * rte_vhost_set_notify_threshold().
  * @param queue_id
  *  virtio queue index in mq case
  * @return
@@ -208,7 +269,9 @@ uint16_t rte_vhost_enqueue_burst(struct virtio_net *dev, uint16_t queue_id,
 /**
  * This function gets guest buffers from the virtio device TX virtqueue,
  * construct host mbufs, copies guest buffer content to host mbufs and
- * store them in pkts to be processed.
+ * store them in pkts to be processed. With zero copy dequeue, the mbufs
+ * point to the guest buffers instead, see
+ * rte_vhost_enable_dequeue_zero_copy().
  * @param mbuf_pool
  *  mbuf_pool where host mbuf is allocated.
  * @param queue_id
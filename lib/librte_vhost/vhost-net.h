@@ -115,4 +115,77 @@ struct vhost_net_device_ops {
 
 
 struct vhost_net_device_ops const *get_virtio_net_callbacks(void);
+
+/*
+ * Host physical address of each page of a guest memory region, used to
+ * give guest buffers to devices doing DMA.
+ */
+struct vhost_zcopy_region {
+	uint64_t	host_address;	/* vhost virtual address of the first page */
+	uint64_t	nb_pages;
+	uint32_t	page_shift;	/* 0 if the region is not used for zero copy */
+	uint64_t	*page_hpa;
+};
+
+/* Guest buffer given to the application in an mbuf. */
+struct vhost_zcopy_mbuf {
+	struct rte_mbuf	*mbuf;
+	uint32_t	desc_idx;
+};
+
+/*
+ * Zero copy dequeue state of a device. An extra reference is taken on the
+ * mbufs given to the application, so that they are not returned to their
+ * pool when freed: their descriptors are given back to the guest once
+ * their reference count drops back to 1, in the order they were dequeued.
+ *
+ * When the device stops or its memory goes away while the application
+ * still holds some of these mbufs, the state is moved to a list of
+ * stopped ones which keeps the guest memory mapped until they are freed.
+ */
+struct vhost_zcopy {
+	uint32_t	pending_head;	/* next entry to fill */
+	uint32_t	pending_tail;	/* oldest mbuf not given back */
+	uint32_t	pending_mask;	/* ring size - 1 */
+	struct vhost_zcopy_mbuf	*pending;	/* one entry per descriptor */
+	uint32_t	nregions;
+	struct vhost_zcopy_region	regions[VHOST_MEMORY_MAX_NREGIONS];
+	/* Only used once stopped. */
+	struct virtio_memory	*mem;	/* guest memory the mbufs point to */
+	void	(*unmap)(struct virtio_memory *mem); /* NULL if not owned */
+	struct vhost_zcopy	*next;
+};
+
+/* Zero copy states still waiting for the application to free mbufs. */
+extern struct vhost_zcopy *volatile vhost_zcopy_stopped;
+
+/*
+ * Disable zero copy dequeue when the vrings stop. The buffers of the mbufs
+ * still used by the application are not given back to the guest.
+ */
+void vhost_zcopy_stop(struct virtio_net *dev);
+
+/*
+ * Release the guest memory of a device, calling unmap once no mbuf given
+ * to the application points to it anymore. Zero copy is stopped first.
+ */
+void vhost_release_memory(struct virtio_net *dev,
+	void (*unmap)(struct virtio_memory *mem));
+
+/* Unmap guest memory mapped as a single block, and free it. */
+void vhost_unmap_memory(struct virtio_memory *mem);
+
+/*
+ * Free the stopped zero copy states whose mbufs have all been freed,
+ * unmapping the guest memory they kept. Does nothing if another thread
+ * is already doing it.
+ */
+void vhost_zcopy_drain(void);
+
+/*
+ * Give back to the guest the buffers of the mbufs freed by the
+ * application, stopping at the first one still in use. Returns the
+ * number of buffers given back.
+ */
+uint32_t vhost_zcopy_reclaim(struct virtio_net *dev);
 #endif /* _VHOST_NET_CDEV_H_ */
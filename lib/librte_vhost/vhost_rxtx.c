@@ -42,6 +42,47 @@
 
 #define MAX_PKT_BURST 32
 
+/*
+ * Notify the guest of the used entries added to the RX queue since the
+ * last notification, if any. The count is atomically cleared, as other
+ * cores may be adding entries or flushing at the same time.
+ */
+static inline void __attribute__((always_inline))
+vhost_flush_notify(struct vhost_virtqueue *vq)
+{
+	uint16_t nb_unnotified;
+
+	do {
+		nb_unnotified = vq->nb_unnotified;
+		if (nb_unnotified == 0)
+			return;
+	} while (unlikely(rte_atomic16_cmpset(&vq->nb_unnotified,
+				nb_unnotified, 0) == 0));
+
+	/* Kick the guest if necessary. */
+	if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
+		eventfd_write((int)vq->callfd, 1);
+}
+
+/*
+ * Account for nb_used entries added to the RX used ring, and notify the
+ * guest once notify_threshold entries are pending, or at once if flush
+ * is set. Must be called once the used ring index is updated.
+ */
+static inline void __attribute__((always_inline))
+vhost_notify_guest(struct vhost_virtqueue *vq, uint32_t nb_used, int flush)
+{
+	uint16_t nb_unnotified;
+
+	do {
+		nb_unnotified = vq->nb_unnotified;
+	} while (unlikely(rte_atomic16_cmpset(&vq->nb_unnotified,
+				nb_unnotified, nb_unnotified + nb_used) == 0));
+
+	if (flush || nb_unnotified + nb_used >= vq->notify_threshold)
+		vhost_flush_notify(vq);
+}
+
 /**
  * This function adds buffers to the virtio devices RX virtqueue. Buffers can
  * be received from the physical port or from another virtio device. A packet
@@ -64,6 +105,7 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 	uint16_t avail_idx, res_cur_idx;
 	uint16_t res_base_idx, res_end_idx;
 	uint16_t free_entries;
+	uint32_t nb_req;
 	uint8_t success = 0;
 
 	LOG_DEBUG(VHOST_DATA, "(%"PRIu64") virtio_dev_rx()\n", dev->device_fh);
@@ -74,6 +116,7 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 
 	vq = dev->virtqueue[VIRTIO_RXQ];
 	count = (count > MAX_PKT_BURST) ? MAX_PKT_BURST : count;
+	nb_req = count;
 
 	/*
 	 * As many data cores may want access to available buffers,
@@ -88,8 +131,12 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 		if (unlikely(count > free_entries))
 			count = free_entries;
 
-		if (count == 0)
+		if (count == 0) {
+			/* The guest must make room, tell it. */
+			if (nb_req != 0)
+				vhost_flush_notify(vq);
 			return 0;
+		}
 
 		res_end_idx = res_base_idx + count;
 		/* vq->last_used_idx_res is atomically updated. */
@@ -178,9 +225,9 @@ virtio_dev_rx(struct virtio_net *dev, uint16_t queue_id,
 	*(volatile uint16_t *)&vq->used->idx += count;
 	vq->last_used_idx = res_end_idx;
 
-	/* Kick the guest if necessary. */
-	if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
-		eventfd_write((int)vq->callfd, 1);
+	/* Kick the guest once the other cores can fill the used ring. */
+	vhost_notify_guest(vq, count, count < nb_req);
+
 	return count;
 }
 
@@ -390,14 +437,48 @@ copy_from_mbuf_to_vring(struct virtio_net *dev, uint16_t res_base_idx,
 }
 
 /*
- * This function works for mergeable RX.
+ * Fill the buffer vector with the descriptors of the available entries
+ * [res_base_idx, res_end_idx).
+ */
+static inline void __attribute__((always_inline))
+fill_buf_vec(struct vhost_virtqueue *vq, uint16_t res_base_idx,
+	uint16_t res_end_idx)
+{
+	uint32_t vec_idx = 0;
+	uint16_t id;
+
+	for (id = res_base_idx; id != res_end_idx; id++) {
+		uint16_t wrapped_idx = id & (vq->size - 1);
+		uint32_t idx = vq->avail->ring[wrapped_idx];
+		uint8_t next_desc;
+
+		do {
+			next_desc = 0;
+			vq->buf_vec[vec_idx].buf_addr = vq->desc[idx].addr;
+			vq->buf_vec[vec_idx].buf_len = vq->desc[idx].len;
+			vq->buf_vec[vec_idx].desc_idx = idx;
+			vec_idx++;
+
+			if (vq->desc[idx].flags & VRING_DESC_F_NEXT) {
+				idx = vq->desc[idx].next;
+				next_desc = 1;
+			}
+		} while (next_desc);
+	}
+}
+
+/*
+ * This function works for mergeable RX. The available entries of the
+ * whole burst are reserved at once, and the used ring index is updated
+ * once for the whole burst.
  */
 static inline uint32_t __attribute__((always_inline))
 virtio_dev_merge_rx(struct virtio_net *dev, uint16_t queue_id,
 	struct rte_mbuf **pkts, uint32_t count)
 {
 	struct vhost_virtqueue *vq;
-	uint32_t pkt_idx = 0, entry_success = 0;
+	uint32_t pkt_idx, pkt_count, entry_success = 0;
+	uint16_t pkt_end_idx[MAX_PKT_BURST];
 	uint16_t avail_idx, res_cur_idx;
 	uint16_t res_base_idx, res_end_idx;
 	uint8_t success = 0;
@@ -406,6 +487,7 @@ virtio_dev_merge_rx(struct virtio_net *dev, uint16_t queue_id,
 		dev->device_fh);
 	if (unlikely(queue_id != VIRTIO_RXQ)) {
 		LOG_DEBUG(VHOST_DATA, "mq isn't supported in this version.\n");
+		return 0;
 	}
 
 	vq = dev->virtqueue[VIRTIO_RXQ];
@@ -414,115 +496,251 @@ virtio_dev_merge_rx(struct virtio_net *dev, uint16_t queue_id,
 	if (count == 0)
 		return 0;
 
-	for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
-		uint32_t secure_len = 0;
-		uint16_t need_cnt;
-		uint32_t vec_idx = 0;
-		uint32_t pkt_len = pkts[pkt_idx]->pkt_len + vq->vhost_hlen;
-		uint16_t i, id;
-
-		do {
-			/*
-			 * As many data cores may want access to available
-			 * buffers, they need to be reserved.
-			 */
-			res_base_idx = vq->last_used_idx_res;
-			res_cur_idx = res_base_idx;
-
-			do {
-				avail_idx = *((volatile uint16_t *)&vq->avail->idx);
-				if (unlikely(res_cur_idx == avail_idx)) {
-					LOG_DEBUG(VHOST_DATA,
-						"(%"PRIu64") Failed "
-						"to get enough desc from "
-						"vring\n",
-						dev->device_fh);
-					return pkt_idx;
-				} else {
-					uint16_t wrapped_idx =
-						(res_cur_idx) & (vq->size - 1);
-					uint32_t idx =
-						vq->avail->ring[wrapped_idx];
-					uint8_t next_desc;
-
-					do {
-						next_desc = 0;
-						secure_len += vq->desc[idx].len;
-						if (vq->desc[idx].flags &
-							VRING_DESC_F_NEXT) {
-							idx = vq->desc[idx].next;
-							next_desc = 1;
-						}
-					} while (next_desc);
-
-					res_cur_idx++;
-				}
-			} while (pkt_len > secure_len);
+	do {
+		/*
+		 * As many data cores may want access to available
+		 * buffers, they need to be reserved. Find how many
+		 * entries each packet needs and reserve them all.
+		 */
+		res_base_idx = vq->last_used_idx_res;
+		res_cur_idx = res_base_idx;
+		avail_idx = *((volatile uint16_t *)&vq->avail->idx);
 
-			/* vq->last_used_idx_res is atomically updated. */
-			success = rte_atomic16_cmpset(&vq->last_used_idx_res,
-							res_base_idx,
-							res_cur_idx);
-		} while (success == 0);
+		for (pkt_idx = 0; pkt_idx < count; pkt_idx++) {
+			uint32_t pkt_len = pkts[pkt_idx]->pkt_len +
+				vq->vhost_hlen;
+			uint32_t secure_len = 0;
+			uint16_t cur_idx = res_cur_idx;
+
+			while (secure_len < pkt_len && cur_idx != avail_idx) {
+				uint16_t wrapped_idx = cur_idx & (vq->size - 1);
+				uint32_t idx = vq->avail->ring[wrapped_idx];
+				uint8_t next_desc;
+
+				do {
+					next_desc = 0;
+					secure_len += vq->desc[idx].len;
+					if (vq->desc[idx].flags &
+						VRING_DESC_F_NEXT) {
+						idx = vq->desc[idx].next;
+						next_desc = 1;
+					}
+				} while (next_desc);
 
-		id = res_base_idx;
-		need_cnt = res_cur_idx - res_base_idx;
+				cur_idx++;
+			}
 
-		for (i = 0; i < need_cnt; i++, id++) {
-			uint16_t wrapped_idx = id & (vq->size - 1);
-			uint32_t idx = vq->avail->ring[wrapped_idx];
-			uint8_t next_desc;
-			do {
-				next_desc = 0;
-				vq->buf_vec[vec_idx].buf_addr =
-					vq->desc[idx].addr;
-				vq->buf_vec[vec_idx].buf_len =
-					vq->desc[idx].len;
-				vq->buf_vec[vec_idx].desc_idx = idx;
-				vec_idx++;
-
-				if (vq->desc[idx].flags & VRING_DESC_F_NEXT) {
-					idx = vq->desc[idx].next;
-					next_desc = 1;
-				}
-			} while (next_desc);
+			if (secure_len < pkt_len)
+				break;
+			res_cur_idx = cur_idx;
+			pkt_end_idx[pkt_idx] = cur_idx;
 		}
 
-		res_end_idx = res_cur_idx;
+		pkt_count = pkt_idx;
+		if (unlikely(pkt_count == 0)) {
+			LOG_DEBUG(VHOST_DATA,
+				"(%"PRIu64") Failed to get enough desc from "
+				"vring\n", dev->device_fh);
+			/* The guest must make room, tell it. */
+			vhost_flush_notify(vq);
+			return 0;
+		}
 
-		entry_success = copy_from_mbuf_to_vring(dev, res_base_idx,
-			res_end_idx, pkts[pkt_idx]);
+		/* vq->last_used_idx_res is atomically updated. */
+		success = rte_atomic16_cmpset(&vq->last_used_idx_res,
+						res_base_idx, res_cur_idx);
+	} while (unlikely(success == 0));
+	res_end_idx = res_cur_idx;
 
-		rte_compiler_barrier();
+	res_cur_idx = res_base_idx;
+	for (pkt_idx = 0; pkt_idx < pkt_count; pkt_idx++) {
+		fill_buf_vec(vq, res_cur_idx, pkt_end_idx[pkt_idx]);
 
 		/*
-		 * Wait until it's our turn to add our buffer
-		 * to the used ring.
+		 * Prefetch the first buffer of the next packet and its
+		 * data while this one is copied.
 		 */
-		while (unlikely(vq->last_used_idx != res_base_idx))
-			rte_pause();
+		if (pkt_idx + 1 < pkt_count) {
+			uint16_t wrapped_idx =
+				pkt_end_idx[pkt_idx] & (vq->size - 1);
+			uint32_t idx = vq->avail->ring[wrapped_idx];
 
-		*(volatile uint16_t *)&vq->used->idx += entry_success;
-		vq->last_used_idx = res_end_idx;
+			rte_prefetch0((void *)(uintptr_t)gpa_to_vva(dev,
+				vq->desc[idx].addr));
+			rte_prefetch0(rte_pktmbuf_mtod(pkts[pkt_idx + 1],
+				void *));
+		}
 
-		/* Kick the guest if necessary. */
-		if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
-			eventfd_write((int)vq->callfd, 1);
+		entry_success += copy_from_mbuf_to_vring(dev, res_cur_idx,
+			pkt_end_idx[pkt_idx], pkts[pkt_idx]);
+		res_cur_idx = pkt_end_idx[pkt_idx];
 	}
 
-	return count;
+	rte_compiler_barrier();
+
+	/*
+	 * Wait until it's our turn to add our buffers
+	 * to the used ring.
+	 */
+	while (unlikely(vq->last_used_idx != res_base_idx))
+		rte_pause();
+
+	*(volatile uint16_t *)&vq->used->idx += entry_success;
+	vq->last_used_idx = res_end_idx;
+
+	/* Kick the guest once the other cores can fill the used ring. */
+	vhost_notify_guest(vq, entry_success, pkt_count < count);
+
+	return pkt_count;
 }
 
 uint16_t
 rte_vhost_enqueue_burst(struct virtio_net *dev, uint16_t queue_id,
 	struct rte_mbuf **pkts, uint16_t count)
 {
+	if (unlikely(count == 0)) {
+		/* Flush the coalesced notifications. */
+		if (unlikely(queue_id != VIRTIO_RXQ))
+			return 0;
+		vhost_flush_notify(dev->virtqueue[VIRTIO_RXQ]);
+		return 0;
+	}
+
 	if (unlikely(dev->features & (1 << VIRTIO_NET_F_MRG_RXBUF)))
 		return virtio_dev_merge_rx(dev, queue_id, pkts, count);
 	else
 		return virtio_dev_rx(dev, queue_id, pkts, count);
 }
 
+uint32_t
+vhost_zcopy_reclaim(struct virtio_net *dev)
+{
+	struct vhost_virtqueue *vq = dev->virtqueue[VIRTIO_TXQ];
+	struct vhost_zcopy *zcopy = dev->zcopy;
+	struct vhost_zcopy_mbuf *zm;
+	uint32_t used_idx;
+	uint32_t nb_used = 0;
+
+	/*
+	 * Mbufs are usually freed in the order they were dequeued, so stop at
+	 * the first one still in use rather than looking at all of them.
+	 */
+	while (zcopy->pending_tail != zcopy->pending_head) {
+		zm = &zcopy->pending[zcopy->pending_tail & zcopy->pending_mask];
+		if (rte_mbuf_refcnt_read(zm->mbuf) != 1)
+			break;
+
+		/* The used ring does not need to follow the available one. */
+		used_idx = (vq->last_used_idx + nb_used) & (vq->size - 1);
+		vq->used->ring[used_idx].id = zm->desc_idx;
+		vq->used->ring[used_idx].len = 0;
+		nb_used++;
+
+		/* Give the mbuf its own buffer back before freeing it. */
+		rte_pktmbuf_detach(zm->mbuf);
+		rte_pktmbuf_free(zm->mbuf);
+		zcopy->pending_tail++;
+	}
+
+	if (nb_used == 0)
+		return 0;
+
+	vq->last_used_idx += nb_used;
+	rte_compiler_barrier();
+	vq->used->idx += nb_used;
+	/* Kick guest if required. */
+	if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
+		eventfd_write((int)vq->callfd, 1);
+	return nb_used;
+}
+
+/*
+ * Convert a guest buffer to vhost virtual and host physical addresses, or
+ * return RTE_BAD_PHYS_ADDR if it cannot be used for zero copy: its region
+ * is not backed by hugepages, or it is not physically contiguous.
+ */
+static inline phys_addr_t __attribute__((always_inline))
+zcopy_gpa_to_hpa(struct virtio_net *dev, uint64_t guest_pa, uint32_t len,
+	uint64_t *vhost_va)
+{
+	struct virtio_memory_regions *region;
+	struct vhost_zcopy_region *zregion;
+	uint64_t offset, first, last, i;
+	uint32_t regionidx;
+
+	for (regionidx = 0; regionidx < dev->mem->nregions; regionidx++) {
+		region = &dev->mem->regions[regionidx];
+		if ((guest_pa >= region->guest_phys_address) &&
+			(guest_pa <= region->guest_phys_address_end))
+			break;
+	}
+	if (unlikely(regionidx == dev->mem->nregions))
+		return RTE_BAD_PHYS_ADDR;
+
+	zregion = &dev->zcopy->regions[regionidx];
+	if (unlikely(zregion->page_shift == 0 ||
+			guest_pa + len > region->guest_phys_address_end))
+		return RTE_BAD_PHYS_ADDR;
+
+	*vhost_va = region->address_offset + guest_pa;
+	offset = *vhost_va - zregion->host_address;
+	first = offset >> zregion->page_shift;
+	last = (offset + len - 1) >> zregion->page_shift;
+	for (i = first; i < last; i++) {
+		if (zregion->page_hpa[i + 1] != zregion->page_hpa[i] +
+				(1ULL << zregion->page_shift))
+			return RTE_BAD_PHYS_ADDR;
+	}
+
+	return zregion->page_hpa[first] +
+		(offset & ((1ULL << zregion->page_shift) - 1));
+}
+
+/*
+ * Build an mbuf pointing to the guest buffer of a descriptor. Returns NULL
+ * if the packet must be copied instead.
+ */
+static inline struct rte_mbuf * __attribute__((always_inline))
+zcopy_desc_to_mbuf(struct virtio_net *dev, struct vring_desc *desc,
+	uint32_t desc_idx, struct rte_mempool *mbuf_pool)
+{
+	struct vhost_zcopy *zcopy = dev->zcopy;
+	struct rte_mbuf *m;
+	phys_addr_t hpa;
+	uint64_t vb_addr;
+
+	/* The whole packet must be in a single buffer. */
+	if (unlikely((desc->flags & VRING_DESC_F_NEXT) || desc->len == 0 ||
+			desc->len > UINT16_MAX))
+		return NULL;
+
+	hpa = zcopy_gpa_to_hpa(dev, desc->addr, desc->len, &vb_addr);
+	if (unlikely(hpa == RTE_BAD_PHYS_ADDR))
+		return NULL;
+
+	m = rte_pktmbuf_alloc(mbuf_pool);
+	if (unlikely(m == NULL))
+		return NULL;
+
+	m->buf_addr = (void *)(uintptr_t)vb_addr;
+	m->buf_physaddr = hpa;
+	m->buf_len = (uint16_t)desc->len;
+	m->data_off = 0;
+	m->data_len = (uint16_t)desc->len;
+	m->pkt_len = desc->len;
+
+	PRINT_PACKET(dev, (uintptr_t)m->buf_addr, desc->len, 0);
+
+	/* Keep the mbuf out of its pool when the application frees it. */
+	rte_mbuf_refcnt_update(m, 1);
+	zcopy->pending[zcopy->pending_head & zcopy->pending_mask].mbuf = m;
+	zcopy->pending[zcopy->pending_head & zcopy->pending_mask].desc_idx =
+		desc_idx;
+	zcopy->pending_head++;
+
+	return m;
+}
+
 uint16_t
 rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 	struct rte_mempool *mbuf_pool, struct rte_mbuf **pkts, uint16_t count)
@@ -534,7 +752,7 @@ rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 	uint32_t head[MAX_PKT_BURST];
 	uint32_t used_idx;
 	uint32_t i;
-	uint16_t free_entries, entry_success = 0;
+	uint16_t free_entries, entry_success = 0, used_count = 0;
 	uint16_t avail_idx;
 
 	if (unlikely(queue_id != VIRTIO_TXQ)) {
@@ -543,20 +761,33 @@ rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 	}
 
 	vq = dev->virtqueue[VIRTIO_TXQ];
+
+	/*
+	 * With zero copy, buffers are given back to the guest when their mbuf
+	 * is freed, so last_used_idx_res tracks the available ring and
+	 * last_used_idx the used ring. They are equal otherwise.
+	 */
+	if (dev->zcopy != NULL &&
+			dev->zcopy->pending_tail != dev->zcopy->pending_head)
+		vhost_zcopy_reclaim(dev);
+	/* Release what stopped devices kept for mbufs freed since then. */
+	if (unlikely(vhost_zcopy_stopped != NULL))
+		vhost_zcopy_drain();
+
 	avail_idx =  *((volatile uint16_t *)&vq->avail->idx);
 
 	/* If there are no available buffers then return. */
-	if (vq->last_used_idx == avail_idx)
+	if (vq->last_used_idx_res == avail_idx)
 		return 0;
 
 	LOG_DEBUG(VHOST_DATA, "%s (%"PRIu64")\n", __func__,
 		dev->device_fh);
 
 	/* Prefetch available ring to retrieve head indexes. */
-	rte_prefetch0(&vq->avail->ring[vq->last_used_idx & (vq->size - 1)]);
+	rte_prefetch0(&vq->avail->ring[vq->last_used_idx_res & (vq->size - 1)]);
 
 	/*get the number of free entries in the ring*/
-	free_entries = (avail_idx - vq->last_used_idx);
+	free_entries = (avail_idx - vq->last_used_idx_res);
 
 	free_entries = RTE_MIN(free_entries, count);
 	/* Limit to MAX_PKT_BURST. */
@@ -566,7 +797,8 @@ rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 			dev->device_fh, free_entries);
 	/* Retrieve all of the head indexes first to avoid caching issues. */
 	for (i = 0; i < free_entries; i++)
-		head[i] = vq->avail->ring[(vq->last_used_idx + i) & (vq->size - 1)];
+		head[i] = vq->avail->ring[(vq->last_used_idx_res + i) &
+			(vq->size - 1)];
 
 	/* Prefetch descriptor index. */
 	rte_prefetch0(&vq->desc[head[entry_success]]);
@@ -585,18 +817,28 @@ rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 		/* Discard first buffer as it is the virtio header */
 		desc = &vq->desc[desc->next];
 
+		if (entry_success < (free_entries - 1))
+			/* Prefetch descriptor index. */
+			rte_prefetch0(&vq->desc[head[entry_success+1]]);
+
+		if (dev->zcopy != NULL) {
+			m = zcopy_desc_to_mbuf(dev, desc, head[entry_success],
+				mbuf_pool);
+			if (likely(m != NULL)) {
+				pkts[entry_success] = m;
+				vq->last_used_idx_res++;
+				entry_success++;
+				continue;
+			}
+		}
+
 		/* Buffer address translation. */
 		vb_addr = gpa_to_vva(dev, desc->addr);
 		/* Prefetch buffer address. */
 		rte_prefetch0((void *)(uintptr_t)vb_addr);
 
 		used_idx = vq->last_used_idx & (vq->size - 1);
-
-		if (entry_success < (free_entries - 1)) {
-			/* Prefetch descriptor index. */
-			rte_prefetch0(&vq->desc[head[entry_success+1]]);
-			rte_prefetch0(&vq->used->ring[(used_idx + 1) & (vq->size - 1)]);
-		}
+		rte_prefetch0(&vq->used->ring[(used_idx + 1) & (vq->size - 1)]);
 
 		/* Update used index buffer information. */
 		vq->used->ring[used_idx].id = head[entry_success];
@@ -718,11 +960,16 @@ rte_vhost_dequeue_burst(struct virtio_net *dev, uint16_t queue_id,
 
 		pkts[entry_success] = m;
 		vq->last_used_idx++;
+		vq->last_used_idx_res++;
 		entry_success++;
+		used_count++;
 	}
 
+	if (used_count == 0)
+		return entry_success;
+
 	rte_compiler_barrier();
-	vq->used->idx += entry_success;
+	vq->used->idx += used_count;
 	/* Kick guest if required. */
 	if (!(vq->avail->flags & VRING_AVAIL_F_NO_INTERRUPT))
 		eventfd_write((int)vq->callfd, 1);
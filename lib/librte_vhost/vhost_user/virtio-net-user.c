@@ -70,17 +70,14 @@ get_blk_size(int fd)
 }
 
 static void
-free_mem_region(struct virtio_net *dev)
+free_mem_region(struct virtio_memory *mem)
 {
 	struct orig_region_map *region;
 	unsigned int idx;
 	uint64_t alignment;
 
-	if (!dev || !dev->mem)
-		return;
-
-	region = orig_region(dev->mem, dev->mem->nregions);
-	for (idx = 0; idx < dev->mem->nregions; idx++) {
+	region = orig_region(mem, mem->nregions);
+	for (idx = 0; idx < mem->nregions; idx++) {
 		if (region[idx].mapped_address) {
 			alignment = region[idx].blksz;
 			munmap((void *)(uintptr_t)
@@ -91,6 +88,7 @@ free_mem_region(struct virtio_net *dev)
 			close(region[idx].fd);
 		}
 	}
+	free(mem);
 }
 
 int
@@ -113,11 +111,7 @@ user_set_mem_table(struct vhost_device_ctx ctx, struct VhostUserMsg *pmsg)
 	if (dev->flags & VIRTIO_DEV_RUNNING)
 		notify_ops->destroy_device(dev);
 
-	if (dev->mem) {
-		free_mem_region(dev);
-		free(dev->mem);
-		dev->mem = NULL;
-	}
+	vhost_release_memory(dev, free_mem_region);
 
 	dev->mem = calloc(1,
 		sizeof(struct virtio_memory) +
@@ -280,6 +274,12 @@ user_get_vring_base(struct vhost_device_ctx ctx,
 	if (dev->flags & VIRTIO_DEV_RUNNING)
 		notify_ops->destroy_device(dev);
 
+	/* Give back the buffers of the mbufs freed by the application. */
+	if (dev->zcopy) {
+		vhost_zcopy_reclaim(dev);
+		vhost_zcopy_stop(dev);
+	}
+
 	/* Here we are safe to get the last used index */
 	ops->get_vring_base(ctx, state->index, state);
 
@@ -310,9 +310,6 @@ user_destroy_device(struct vhost_device_ctx ctx)
 	if (dev && (dev->flags & VIRTIO_DEV_RUNNING))
 		notify_ops->destroy_device(dev);
 
-	if (dev && dev->mem) {
-		free_mem_region(dev);
-		free(dev->mem);
-		dev->mem = NULL;
-	}
+	if (dev)
+		vhost_release_memory(dev, free_mem_region);
 }
@@ -35,7 +35,9 @@
 #include <linux/virtio_net.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
+#include <inttypes.h>
 #include <sys/mman.h>
 #include <unistd.h>
 
@@ -45,6 +47,8 @@
 #include <rte_log.h>
 #include <rte_string_fns.h>
 #include <rte_memory.h>
+#include <rte_mbuf.h>
+#include <rte_spinlock.h>
 #include <rte_virtio_net.h>
 
 #include "vhost-net.h"
@@ -178,11 +182,7 @@ static void
 cleanup_device(struct virtio_net *dev)
 {
 	/* Unmap QEMU memory file if mapped. */
-	if (dev->mem) {
-		munmap((void *)(uintptr_t)dev->mem->mapped_address,
-			(size_t)dev->mem->mapped_size);
-		free(dev->mem);
-	}
+	vhost_release_memory(dev, vhost_unmap_memory);
 
 	/* Close any event notifiers opened by device. */
 	if ((int)dev->virtqueue[VIRTIO_RXQ]->callfd >= 0)
@@ -716,6 +716,284 @@ int rte_vhost_enable_guest_notification(struct virtio_net *dev,
 	return 0;
 }
 
+/*
+ * Get the size of the pages backing a virtual address, from the
+ * KernelPageSize field of /proc/self/smaps. Returns 0 on error.
+ */
+static uint64_t
+get_page_size(uint64_t addr)
+{
+	char buf[BUFSIZ];
+	uint64_t start, end, page_size = 0;
+	int found = 0;
+	FILE *f;
+
+	f = fopen("/proc/self/smaps", "r");
+	if (f == NULL)
+		return 0;
+
+	while (fgets(buf, sizeof(buf), f) != NULL) {
+		/* a new mapping starts */
+		if (sscanf(buf, "%" SCNx64 "-%" SCNx64 " ", &start, &end) == 2) {
+			found = addr >= start && addr < end;
+			continue;
+		}
+		if (found && sscanf(buf, "KernelPageSize: %" SCNu64 " kB",
+				&page_size) == 1) {
+			page_size <<= 10;
+			break;
+		}
+	}
+
+	fclose(f);
+	return page_size;
+}
+
+/*
+ * Find the host physical address of each page of a guest memory region.
+ * Regions which are not backed by hugepages are left out, as the kernel
+ * may move their pages.
+ */
+static void
+zcopy_region_init(struct vhost_zcopy_region *zregion,
+	struct virtio_memory_regions *region)
+{
+	uint64_t start, end, page_size, i;
+	phys_addr_t hpa;
+	uintptr_t addr;
+
+	start = region->address_offset + region->guest_phys_address;
+	page_size = get_page_size(start);
+	if (page_size <= (uint64_t)getpagesize())
+		return;
+
+	zregion->host_address = RTE_ALIGN_FLOOR(start, page_size);
+	end = RTE_ALIGN_CEIL(start + region->memory_size, page_size);
+	zregion->nb_pages = (end - zregion->host_address) / page_size;
+	zregion->page_hpa = malloc(zregion->nb_pages * sizeof(uint64_t));
+	if (zregion->page_hpa == NULL)
+		return;
+
+	for (i = 0; i < zregion->nb_pages; i++) {
+		addr = zregion->host_address + i * page_size;
+		/* fault the page in so that it has a physical address */
+		*(volatile uint8_t *)addr;
+		hpa = rte_mem_virt2phy((void *)addr);
+		if (hpa == RTE_BAD_PHYS_ADDR) {
+			free(zregion->page_hpa);
+			zregion->page_hpa = NULL;
+			return;
+		}
+		zregion->page_hpa[i] = hpa;
+	}
+	zregion->page_shift = __builtin_ctzll(page_size);
+}
+
+struct vhost_zcopy *volatile vhost_zcopy_stopped;
+static rte_spinlock_t vhost_zcopy_lock = RTE_SPINLOCK_INITIALIZER;
+
+static void
+zcopy_destroy(struct vhost_zcopy *zcopy)
+{
+	uint32_t i;
+
+	for (i = 0; i < zcopy->nregions; i++)
+		free(zcopy->regions[i].page_hpa);
+	free(zcopy->pending);
+	free(zcopy);
+}
+
+/*
+ * Put back in their pool the mbufs of a stopped device freed by the
+ * application, in the order they were dequeued. Returns the number of
+ * mbufs still in use.
+ */
+static uint32_t
+zcopy_release_freed(struct vhost_zcopy *zcopy)
+{
+	struct vhost_zcopy_mbuf *zm;
+
+	while (zcopy->pending_tail != zcopy->pending_head) {
+		zm = &zcopy->pending[zcopy->pending_tail & zcopy->pending_mask];
+		if (rte_mbuf_refcnt_read(zm->mbuf) != 1)
+			break;
+		rte_pktmbuf_detach(zm->mbuf);
+		rte_pktmbuf_free(zm->mbuf);
+		zcopy->pending_tail++;
+	}
+	return zcopy->pending_head - zcopy->pending_tail;
+}
+
+/*
+ * Free the stopped zero copy states which are done. The last one using
+ * some guest memory unmaps it, so the memory given to an unfinished one
+ * is passed on to another one using it, if any.
+ */
+static void
+zcopy_drain_locked(void)
+{
+	struct vhost_zcopy *volatile *prev = &vhost_zcopy_stopped;
+	struct vhost_zcopy *zcopy, *other;
+
+	while ((zcopy = *prev) != NULL) {
+		if (zcopy_release_freed(zcopy) != 0) {
+			prev = &zcopy->next;
+			continue;
+		}
+		*prev = zcopy->next;
+
+		if (zcopy->unmap != NULL) {
+			for (other = vhost_zcopy_stopped; other != NULL;
+					other = other->next)
+				if (other->mem == zcopy->mem)
+					break;
+			if (other != NULL)
+				other->unmap = zcopy->unmap;
+			else
+				zcopy->unmap(zcopy->mem);
+		}
+		zcopy_destroy(zcopy);
+	}
+}
+
+void
+vhost_zcopy_drain(void)
+{
+	if (!rte_spinlock_trylock(&vhost_zcopy_lock))
+		return;
+	zcopy_drain_locked();
+	rte_spinlock_unlock(&vhost_zcopy_lock);
+}
+
+void
+vhost_zcopy_stop(struct virtio_net *dev)
+{
+	struct vhost_zcopy *zcopy = dev->zcopy;
+	uint32_t i;
+
+	if (zcopy == NULL)
+		return;
+	dev->zcopy = NULL;
+
+	zcopy_release_freed(zcopy);
+	if (zcopy->pending_tail == zcopy->pending_head) {
+		zcopy_destroy(zcopy);
+		return;
+	}
+
+	RTE_LOG(INFO, VHOST_CONFIG,
+		"(%"PRIu64") %u zero copy mbufs still in use, keeping guest "
+		"memory until they are freed\n", dev->device_fh,
+		zcopy->pending_head - zcopy->pending_tail);
+
+	/* The page addresses are only needed to dequeue. */
+	for (i = 0; i < zcopy->nregions; i++) {
+		free(zcopy->regions[i].page_hpa);
+		zcopy->regions[i].page_hpa = NULL;
+	}
+	zcopy->mem = dev->mem;
+	zcopy->unmap = NULL;
+
+	rte_spinlock_lock(&vhost_zcopy_lock);
+	zcopy->next = vhost_zcopy_stopped;
+	vhost_zcopy_stopped = zcopy;
+	rte_spinlock_unlock(&vhost_zcopy_lock);
+}
+
+void
+vhost_release_memory(struct virtio_net *dev,
+	void (*unmap)(struct virtio_memory *mem))
+{
+	struct vhost_zcopy *zcopy;
+
+	vhost_zcopy_stop(dev);
+	if (dev->mem == NULL)
+		return;
+
+	rte_spinlock_lock(&vhost_zcopy_lock);
+	/* Only the states with mbufs in use are left. */
+	zcopy_drain_locked();
+	for (zcopy = vhost_zcopy_stopped; zcopy != NULL; zcopy = zcopy->next)
+		if (zcopy->mem == dev->mem)
+			break;
+	if (zcopy != NULL)
+		zcopy->unmap = unmap;
+	else
+		unmap(dev->mem);
+	rte_spinlock_unlock(&vhost_zcopy_lock);
+
+	dev->mem = NULL;
+}
+
+void
+vhost_unmap_memory(struct virtio_memory *mem)
+{
+	if (mem->mapped_address)
+		munmap((void *)(uintptr_t)mem->mapped_address,
+			(size_t)mem->mapped_size);
+	free(mem);
+}
+
+int rte_vhost_enable_dequeue_zero_copy(struct virtio_net *dev,
+	uint16_t queue_id, int enable)
+{
+	struct vhost_zcopy *zcopy;
+	uint32_t i;
+
+	if (queue_id != VIRTIO_TXQ) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"zero copy is only supported on the TX queue.\n");
+		return -1;
+	}
+
+	if (!enable) {
+		if (dev->zcopy == NULL)
+			return 0;
+		vhost_zcopy_reclaim(dev);
+		if (dev->zcopy->pending_tail != dev->zcopy->pending_head)
+			return -1;
+		zcopy_destroy(dev->zcopy);
+		dev->zcopy = NULL;
+		return 0;
+	}
+
+	if (dev->zcopy != NULL)
+		return 0;
+	if (dev->mem == NULL || dev->virtqueue[VIRTIO_TXQ]->size == 0)
+		return -1;
+
+	zcopy = calloc(1, sizeof(*zcopy));
+	if (zcopy == NULL)
+		return -1;
+	zcopy->pending_mask = dev->virtqueue[VIRTIO_TXQ]->size - 1;
+	zcopy->pending = calloc(dev->virtqueue[VIRTIO_TXQ]->size,
+		sizeof(struct vhost_zcopy_mbuf));
+	if (zcopy->pending == NULL) {
+		free(zcopy);
+		return -1;
+	}
+
+	zcopy->nregions = dev->mem->nregions;
+	for (i = 0; i < zcopy->nregions; i++)
+		zcopy_region_init(&zcopy->regions[i], &dev->mem->regions[i]);
+
+	dev->zcopy = zcopy;
+	return 0;
+}
+
+int rte_vhost_set_notify_threshold(struct virtio_net *dev,
+	uint16_t queue_id, uint16_t threshold)
+{
+	if (queue_id != VIRTIO_RXQ) {
+		RTE_LOG(ERR, VHOST_CONFIG,
+			"notify threshold is only supported on the RX queue.\n");
+		return -1;
+	}
+
+	dev->virtqueue[queue_id]->notify_threshold = threshold;
+	return 0;
+}
+
 uint64_t rte_vhost_feature_get(void)
 {
 	return VHOST_FEATURES;